@@ -36,8 +36,10 @@
 
 #include "execute_task_solution_capability.h"
 
+#include <moveit/task_constructor/merge.h>
 #include <moveit/plan_execution/plan_execution.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/move_group/capability_names.h>
 #include <moveit/robot_state/conversions.h>
@@ -45,13 +47,17 @@
 #include <moveit/utils/moveit_error_code.h>
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
 namespace {
 
 // TODO: move to moveit::core::RobotModel
+// joint_set needs to be sorted and unique
 const moveit::core::JointModelGroup* findJointModelGroup(const moveit::core::RobotModel& model,
-                                                         const std::vector<std::string>& joints) {
-	std::set<std::string> joint_set(joints.begin(), joints.end());
-
+                                                         const std::vector<std::string>& joint_set) {
 	const std::vector<const moveit::core::JointModelGroup*>& jmgs = model.getJointModelGroups();
 
 	for (const moveit::core::JointModelGroup* jmg : jmgs) {
@@ -76,6 +82,30 @@ const moveit::core::JointModelGroup* findJointModelGroup(const moveit::core::Rob
 
 	return nullptr;
 }
+
+/// canonical, i.e. sorted and unique, set of joints actuated by trajectory
+std::vector<std::string> jointSet(const moveit_msgs::RobotTrajectory& trajectory) {
+	std::vector<std::string> joints;
+	joints.reserve(trajectory.joint_trajectory.joint_names.size() +
+	               trajectory.multi_dof_joint_trajectory.joint_names.size());
+	joints.insert(joints.end(), trajectory.joint_trajectory.joint_names.begin(),
+	              trajectory.joint_trajectory.joint_names.end());
+	joints.insert(joints.end(), trajectory.multi_dof_joint_trajectory.joint_names.begin(),
+	              trajectory.multi_dof_joint_trajectory.joint_names.end());
+	std::sort(joints.begin(), joints.end());
+	joints.erase(std::unique(joints.begin(), joints.end()), joints.end());
+	return joints;
+}
+
+/// scene diff to apply after successful execution of a sub trajectory
+::moveit_msgs::PlanningScene effectDiff(const ::moveit_msgs::PlanningScene& sub_scene_diff) {
+	::moveit_msgs::PlanningScene scene_diff = sub_scene_diff;
+	// Never modify joint state directly (only via robot trajectories)
+	scene_diff.robot_state.joint_state = sensor_msgs::JointState();
+	scene_diff.robot_state.multi_dof_joint_state = sensor_msgs::MultiDOFJointState();
+	scene_diff.robot_state.is_diff = true;  // silent empty JointState msg error
+	return scene_diff;
+}
 }  // namespace
 
 namespace move_group {
@@ -83,6 +113,28 @@ namespace move_group {
 ExecuteTaskSolutionCapability::ExecuteTaskSolutionCapability() : MoveGroupCapability("ExecuteTaskSolution") {}
 
 void ExecuteTaskSolutionCapability::initialize() {
+	// start executing the first sub trajectory while converting the remaining ones
+	node_handle_.param("execute_task_solution_pipelined", pipelined_, false);
+	// execute sub trajectories of the same group and controllers without stopping in between,
+	// unless they need to change the scene
+	node_handle_.param("execute_task_solution_blended", blended_, false);
+	node_handle_.param("execute_task_solution_blend_velocity_scaling", blend_velocity_scaling_, 1.0);
+	node_handle_.param("execute_task_solution_blend_acceleration_scaling", blend_acceleration_scaling_, 1.0);
+	// check solutions against the latest scene before starting to move
+	node_handle_.param("execute_task_solution_validate", validate_, false);
+
+	// pre-populate group lookup with the joint sets of all groups, as commonly used by trajectories
+	const moveit::core::RobotModel& model = *context_->planning_scene_monitor_->getRobotModel();
+	for (const moveit::core::JointModelGroup* jmg : model.getJointModelGroups()) {
+		std::vector<std::string> joints;
+		for (const moveit::core::JointModel* jm : jmg->getActiveJointModels())
+			if (!jm->getMimic())
+				joints.push_back(jm->getName());
+		std::sort(joints.begin(), joints.end());
+		if (!joints.empty() && !group_cache_.count(joints))
+			group_cache_.emplace(joints, ::findJointModelGroup(model, joints));
+	}
+
 	// configure the action server
 	as_.reset(new actionlib::SimpleActionServer<moveit_task_constructor_msgs::ExecuteTaskSolutionAction>(
 	    root_node_handle_, "execute_task_solution",
@@ -102,12 +154,36 @@ void ExecuteTaskSolutionCapability::execCallback(
 		return;
 	}
 
-	plan_execution::ExecutableMotionPlan plan;
-	if (!constructMotionPlan(goal->solution, plan))
+	// solutions passed via shared memory are deserialized directly from the mapped segment
+	moveit_task_constructor_msgs::Solution shared;
+	if (!goal->solution_handle.segment.empty() && !readSharedSolution(goal->solution_handle, shared)) {
 		result.error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
+		as_->setAborted(result, "Cannot read solution from shared memory '" + goal->solution_handle.segment + "'");
+		return;
+	}
+	const moveit_task_constructor_msgs::Solution& solution =
+	    goal->solution_handle.segment.empty() ? goal->solution : shared;
+
+	// validation needs the whole plan upfront, which defeats pipelining
+	if (pipelined_ && !validate_ && solution.sub_trajectory.size() > 1)
+		result.error_code = executePipelined(solution);
 	else {
-		ROS_INFO_NAMED("ExecuteTaskSolution", "Executing TaskSolution");
-		result.error_code = context_->plan_execution_->executeAndMonitor(plan);
+		plan_execution::ExecutableMotionPlan plan;
+		Effects effects;
+		size_t invalid = 0;
+		if (!constructMotionPlan(solution, plan, &effects))
+			result.error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
+		else if (validate_ && (invalid = validateMotionPlan(plan, effects)) < plan.plan_components_.size()) {
+			result.error_code.val = moveit_msgs::MoveItErrorCodes::MOTION_PLAN_INVALIDATED_BY_ENVIRONMENT_CHANGE;
+			const std::string response = "Sub trajectory " + plan.plan_components_[invalid].description_ +
+			                             " is invalid in the current planning scene";
+			ROS_ERROR_STREAM_NAMED("ExecuteTaskSolution", response);
+			as_->setAborted(result, response);
+			return;
+		} else {
+			ROS_INFO_NAMED("ExecuteTaskSolution", "Executing TaskSolution");
+			result.error_code = context_->plan_execution_->executeAndMonitor(plan);
+		}
 	}
 
 	const std::string response = moveit::core::MoveItErrorCode::toString(result.error_code);
@@ -119,24 +195,199 @@ void ExecuteTaskSolutionCapability::execCallback(
 		as_->setAborted(result, response);
 }
 
+moveit_msgs::MoveItErrorCodes
+ExecuteTaskSolutionCapability::executePipelined(const moveit_task_constructor_msgs::Solution& solution) {
+	moveit_msgs::MoveItErrorCodes error_code;
+	moveit::core::RobotState state = currentState();
+
+	// convert first component only, such that execution can start right away
+	plan_execution::ExecutableMotionPlan head;
+	if (!constructMotionPlan(solution, head, state, 0, 1)) {
+		error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
+		return error_code;
+	}
+
+	// convert and validate remaining components in the background, continuing from the state reached by head
+	plan_execution::ExecutableMotionPlan tail;
+	auto tail_valid = std::async(std::launch::async, [&]() {
+		return constructMotionPlan(solution, tail, state, 1, solution.sub_trajectory.size());
+	});
+
+	ROS_INFO_NAMED("ExecuteTaskSolution", "Executing TaskSolution (pipelined)");
+	error_code = context_->plan_execution_->executeAndMonitor(head);
+	const bool valid = tail_valid.get();
+	if (error_code.val != moveit_msgs::MoveItErrorCodes::SUCCESS)
+		return error_code;
+	if (!valid) {
+		ROS_ERROR_NAMED("ExecuteTaskSolution", "Aborting pipelined execution after first sub trajectory");
+		error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
+		return error_code;
+	}
+	return context_->plan_execution_->executeAndMonitor(tail);
+}
+
+bool ExecuteTaskSolutionCapability::readSharedSolution(const moveit_task_constructor_msgs::SolutionHandle& handle,
+                                                       moveit_task_constructor_msgs::Solution& solution) {
+	moveit::task_constructor::SolutionRingPtr& ring = rings_[handle.segment];
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (!ring) {
+			try {
+				ring = moveit::task_constructor::SolutionRing::open(handle.segment);
+			} catch (const std::runtime_error& e) {
+				ROS_ERROR_STREAM_NAMED("ExecuteTaskSolution", e.what());
+				return false;
+			}
+		}
+		if (ring->read(handle, solution))
+			return true;
+		if (ring->instance() == handle.instance) {
+			ROS_ERROR_NAMED("ExecuteTaskSolution", "Solution was overwritten in shared memory");
+			return false;
+		}
+		ring.reset();  // segment was re-created: map it again
+	}
+	return false;
+}
+
 void ExecuteTaskSolutionCapability::preemptCallback() {
 	if (context_->plan_execution_)
 		context_->plan_execution_->stop();
 }
 
-bool ExecuteTaskSolutionCapability::constructMotionPlan(const moveit_task_constructor_msgs::Solution& solution,
-                                                        plan_execution::ExecutableMotionPlan& plan) {
-	moveit::core::RobotModelConstPtr model = context_->planning_scene_monitor_->getRobotModel();
+const moveit::core::JointModelGroup*
+ExecuteTaskSolutionCapability::findJointModelGroup(const moveit::core::RobotModel& model,
+                                                   const std::vector<std::string>& joint_set) {
+	std::lock_guard<std::mutex> lock(group_cache_mutex_);
+	auto it = group_cache_.find(joint_set);
+	if (it == group_cache_.end())
+		it = group_cache_.emplace(joint_set, ::findJointModelGroup(model, joint_set)).first;
+	return it->second;
+}
 
-	moveit::core::RobotState state(model);
+bool ExecuteTaskSolutionCapability::blendTrajectory(plan_execution::ExecutableTrajectory& exec_traj) const {
+	// a path tolerance > 0 allows TOTG to round the corners at the former junctions
+	trajectory_processing::TimeOptimalTrajectoryGeneration totg(0.01);
+	if (!totg.computeTimeStamps(*exec_traj.trajectory_, blend_velocity_scaling_, blend_acceleration_scaling_)) {
+		ROS_ERROR_STREAM_NAMED("ExecuteTaskSolution", "Failed to re-time blended trajectory " << exec_traj.description_);
+		return false;
+	}
+	return true;
+}
+
+bool ExecuteTaskSolutionCapability::joinConcurrently(
+    std::vector<robot_trajectory::RobotTrajectoryConstPtr>& concurrent,
+    const plan_execution::ExecutableTrajectory& exec_traj, plan_execution::ExecutableTrajectory& target) {
+	std::vector<robot_trajectory::RobotTrajectoryConstPtr> trajectories(concurrent);
+	trajectories.push_back(exec_traj.trajectory_);
+	std::vector<const moveit::core::JointModelGroup*> groups;
+	groups.reserve(trajectories.size());
+	for (const auto& t : trajectories)
+		groups.push_back(t->getGroup());
+
+	robot_trajectory::RobotTrajectoryPtr merged;
+	try {
+		moveit::core::JointModelGroupPtr jmg = moveit::task_constructor::mergedGroup(groups);
+		moveit::core::JointModelGroup* raw = jmg.get();
+		trajectory_processing::TimeOptimalTrajectoryGeneration totg;
+		// all trajectories start from the first one's start state, as they don't share any joints
+		merged = moveit::task_constructor::merge(trajectories, trajectories.front()->getFirstWayPoint(), raw, totg);
+		// the trajectory only refers to the group: keep it alive
+		std::lock_guard<std::mutex> lock(group_cache_mutex_);
+		merged_groups_.insert(jmg);
+	} catch (const std::runtime_error& e) {
+		ROS_WARN_STREAM_NAMED("ExecuteTaskSolution",
+		                      "Cannot execute " << exec_traj.description_ << " concurrently: " << e.what());
+		return false;
+	}
+
+	// let MoveIt choose the controllers, unless specified for all trajectories
+	if (target.controller_names_.empty() || exec_traj.controller_names_.empty())
+		target.controller_names_.clear();
+	else
+		target.controller_names_.insert(target.controller_names_.end(), exec_traj.controller_names_.begin(),
+		                                exec_traj.controller_names_.end());
+	target.trajectory_ = merged;
+	target.description_ =
+	    target.description_.substr(0, target.description_.find_first_of("-+/")) + "+" + exec_traj.description_;
+	target.effect_on_success_ = exec_traj.effect_on_success_;
+	concurrent.swap(trajectories);
+	return true;
+}
+
+moveit::core::RobotState ExecuteTaskSolutionCapability::currentState() const {
+	planning_scene_monitor::LockedPlanningSceneRO scene(context_->planning_scene_monitor_);
+	return scene->getCurrentState();
+}
+
+size_t ExecuteTaskSolutionCapability::validateMotionPlan(const plan_execution::ExecutableMotionPlan& plan,
+                                                         const Effects& effects) const {
+	const size_t n = plan.plan_components_.size();
+	if (n == 0)
+		return n;
+
+	// scene of each component: latest monitored scene with effects of all preceding components applied
+	std::vector<planning_scene::PlanningScenePtr> scenes;
+	scenes.reserve(n);
 	{
 		planning_scene_monitor::LockedPlanningSceneRO scene(context_->planning_scene_monitor_);
-		state = scene->getCurrentState();
+		scenes.push_back(planning_scene::PlanningScene::clone(scene));
+	}
+	for (size_t i = 1; i < n; ++i) {
+		scenes.push_back(scenes.back()->diff());
+		::moveit_msgs::PlanningScene scene_diff = effectDiff(*effects[i - 1]);
+		if (!moveit::core::isEmpty(scene_diff))
+			scenes.back()->setPlanningSceneDiffMsg(scene_diff);
 	}
 
-	plan.plan_components_.reserve(solution.sub_trajectory.size());
-	for (size_t i = 0; i < solution.sub_trajectory.size(); ++i) {
+	// check components in parallel, skipping those after an already known invalid one
+	std::atomic<size_t> next{ 0 };
+	std::atomic<size_t> first_invalid{ n };
+	auto check = [&]() {
+		for (size_t i = next++; i < n; i = next++) {
+			const robot_trajectory::RobotTrajectoryPtr& trajectory = plan.plan_components_[i].trajectory_;
+			if (i > first_invalid || !trajectory || trajectory->empty() || scenes[i]->isPathValid(*trajectory))
+				continue;
+			size_t current = first_invalid;
+			while (i < current && !first_invalid.compare_exchange_weak(current, i)) {
+			}
+		}
+	};
+	std::vector<std::future<void>> workers;
+	const size_t num_workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), n);
+	for (size_t w = 1; w < num_workers; ++w)
+		workers.push_back(std::async(std::launch::async, check));
+	check();
+	for (auto& worker : workers)
+		worker.get();
+	return first_invalid;
+}
+
+bool ExecuteTaskSolutionCapability::constructMotionPlan(const moveit_task_constructor_msgs::Solution& solution,
+                                                        plan_execution::ExecutableMotionPlan& plan, Effects* effects) {
+	moveit::core::RobotState state = currentState();
+	return constructMotionPlan(solution, plan, state, 0, solution.sub_trajectory.size(), effects);
+}
+
+bool ExecuteTaskSolutionCapability::constructMotionPlan(const moveit_task_constructor_msgs::Solution& solution,
+                                                        plan_execution::ExecutableMotionPlan& plan,
+                                                        moveit::core::RobotState& state, size_t begin, size_t end,
+                                                        Effects* effects) {
+	moveit::core::RobotModelConstPtr model = context_->planning_scene_monitor_->getRobotModel();
+
+	plan.plan_components_.reserve(end - begin);
+	// whether the last component may be continued by the next sub trajectory, and whether it already was
+	bool extensible = false;
+	std::vector<bool> blended;
+	// trajectories executed in parallel by the last component, if it may be joined by further ones
+	std::vector<robot_trajectory::RobotTrajectoryConstPtr> concurrent;
+	blended.reserve(end - begin);
+	for (size_t i = begin; i < end; ++i) {
 		const moveit_task_constructor_msgs::SubTrajectory& sub_traj = solution.sub_trajectory[i];
+		// scene diffs might be stored in the scene table
+		const ::moveit_msgs::PlanningScene& sub_scene_diff =
+		    sub_traj.scene_diff_index > 0 && sub_traj.scene_diff_index <= solution.scene_table.size() ?
+		        solution.scene_table[sub_traj.scene_diff_index - 1] :
+		        sub_traj.scene_diff;
 
 		plan.plan_components_.emplace_back();
 		plan_execution::ExecutableTrajectory& exec_traj = plan.plan_components_.back();
@@ -147,9 +398,7 @@ bool ExecuteTaskSolutionCapability::constructMotionPlan(const moveit_task_constr
 
 		const moveit::core::JointModelGroup* group = nullptr;
 		{
-			std::vector<std::string> joint_names(sub_traj.trajectory.joint_trajectory.joint_names);
-			joint_names.insert(joint_names.end(), sub_traj.trajectory.multi_dof_joint_trajectory.joint_names.begin(),
-			                   sub_traj.trajectory.multi_dof_joint_trajectory.joint_names.end());
+			std::vector<std::string> joint_names = jointSet(sub_traj.trajectory);
 			if (!joint_names.empty()) {
 				group = findJointModelGroup(*model, joint_names);
 				if (!group) {
@@ -167,14 +416,10 @@ bool ExecuteTaskSolutionCapability::constructMotionPlan(const moveit_task_constr
 		exec_traj.controller_names_ = sub_traj.execution_info.controller_names;
 
 		/* TODO add action feedback and markers */
-		exec_traj.effect_on_success_ = [this,
-		                                &scene_diff = const_cast<::moveit_msgs::PlanningScene&>(sub_traj.scene_diff),
+		exec_traj.effect_on_success_ = [this, &sub_scene_diff,
 		                                description](const plan_execution::ExecutableMotionPlan* /*plan*/) {
-			// Never modify joint state directly (only via robot trajectories)
-			scene_diff.robot_state.joint_state = sensor_msgs::JointState();
-			scene_diff.robot_state.multi_dof_joint_state = sensor_msgs::MultiDOFJointState();
-			scene_diff.robot_state.is_diff = true;  // silent empty JointState msg error
-
+			// work on a copy: the msg may be shared between sub trajectories and read by concurrent conversion
+			::moveit_msgs::PlanningScene scene_diff = effectDiff(sub_scene_diff);
 			if (!moveit::core::isEmpty(scene_diff)) {
 				ROS_DEBUG_STREAM_NAMED("ExecuteTaskSolution", "apply effect of " << description);
 				return context_->planning_scene_monitor_->newPlanningSceneMessage(scene_diff);
@@ -182,14 +427,51 @@ bool ExecuteTaskSolutionCapability::constructMotionPlan(const moveit_task_constr
 			return true;
 		};
 
-		if (!moveit::core::isEmpty(sub_traj.scene_diff.robot_state) &&
-		    !moveit::core::robotStateMsgToRobotState(sub_traj.scene_diff.robot_state, state, true)) {
+		const bool has_effect = !moveit::core::isEmpty(effectDiff(sub_scene_diff));
+		const bool has_motion = group && !exec_traj.trajectory_->empty();
+		plan_execution::ExecutableTrajectory* prev =
+		    plan.plan_components_.size() > 1 ? &plan.plan_components_[plan.plan_components_.size() - 2] : nullptr;
+		if (has_motion && sub_traj.execution_info.concurrent && !concurrent.empty() &&
+		    joinConcurrently(concurrent, exec_traj, *prev)) {
+			plan.plan_components_.pop_back();
+			if (effects)
+				effects->back() = &sub_scene_diff;
+		} else if (has_motion && blended_ && extensible && prev->trajectory_->getGroup() == group &&
+		           prev->controller_names_ == exec_traj.controller_names_) {
+			// append to previous component, skipping the shared junction waypoint
+			prev->trajectory_->append(*exec_traj.trajectory_, 0.0, 1);
+			prev->description_ = prev->description_.substr(0, prev->description_.find_first_of("-+/")) + "-" + description;
+			prev->effect_on_success_ = exec_traj.effect_on_success_;
+			plan.plan_components_.pop_back();
+			blended.back() = true;
+			concurrent.clear();
+			if (effects)
+				effects->back() = &sub_scene_diff;
+		} else {
+			blended.push_back(false);
+			if (effects)
+				effects->push_back(&sub_scene_diff);
+			concurrent.clear();
+			if (has_motion)
+				concurrent.push_back(exec_traj.trajectory_);
+		}
+		// only the last merged sub trajectory may change the scene
+		extensible = has_motion && !has_effect;
+		if (has_effect)
+			concurrent.clear();
+
+		if (!moveit::core::isEmpty(sub_scene_diff.robot_state) &&
+		    !moveit::core::robotStateMsgToRobotState(sub_scene_diff.robot_state, state, true)) {
 			ROS_ERROR_STREAM_NAMED("ExecuteTaskSolution",
 			                       "invalid intermediate robot state in scene diff of SubTrajectory " << description);
 			return false;
 		}
 	}
 
+	for (size_t i = 0; i < blended.size(); ++i)
+		if (blended[i] && !blendTrajectory(plan.plan_components_[i]))
+			return false;
+
 	return true;
 }
 
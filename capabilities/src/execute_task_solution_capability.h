@@ -45,8 +45,16 @@
 #include <actionlib/server/simple_action_server.h>
 
 #include <moveit_task_constructor_msgs/ExecuteTaskSolutionAction.h>
+#include <moveit/task_constructor/solution_ring.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit_msgs/MoveItErrorCodes.h>
+#include <moveit_msgs/PlanningScene.h>
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace move_group {
 
@@ -58,13 +66,56 @@ public:
 	void initialize() override;
 
 private:
+	/// effect scene diffs of the plan components
+	using Effects = std::vector<const moveit_msgs::PlanningScene*>;
+
+	bool constructMotionPlan(const moveit_task_constructor_msgs::Solution& solution,
+	                         plan_execution::ExecutableMotionPlan& plan, Effects* effects = nullptr);
+	/// convert sub trajectories [begin, end) of solution, starting from (and updating) state
 	bool constructMotionPlan(const moveit_task_constructor_msgs::Solution& solution,
-	                         plan_execution::ExecutableMotionPlan& plan);
+	                         plan_execution::ExecutableMotionPlan& plan, moveit::core::RobotState& state, size_t begin,
+	                         size_t end, Effects* effects = nullptr);
+	/// collision-check all plan components in parallel against the latest monitored scene and their preceding effects
+	/// @return index of the first invalid component or the number of components if all are valid
+	size_t validateMotionPlan(const plan_execution::ExecutableMotionPlan& plan, const Effects& effects) const;
+	/// re-time trajectory of a component merged from several sub trajectories
+	bool blendTrajectory(plan_execution::ExecutableTrajectory& exec_traj) const;
+	/// replace target's trajectory by a parallel execution of concurrent trajectories and exec_traj, if possible
+	bool joinConcurrently(std::vector<robot_trajectory::RobotTrajectoryConstPtr>& concurrent,
+	                      const plan_execution::ExecutableTrajectory& exec_traj,
+	                      plan_execution::ExecutableTrajectory& target);
+	moveit::core::RobotState currentState() const;
+	/// cached lookup of the JointModelGroup to use for executing given (sorted, unique) joint set
+	const moveit::core::JointModelGroup* findJointModelGroup(const moveit::core::RobotModel& model,
+	                                                         const std::vector<std::string>& joint_set);
+
+	/// execute first sub trajectory while converting the remaining ones in the background
+	moveit_msgs::MoveItErrorCodes executePipelined(const moveit_task_constructor_msgs::Solution& solution);
+
+	/// retrieve the solution referred to by a shared-memory handle
+	bool readSharedSolution(const moveit_task_constructor_msgs::SolutionHandle& handle,
+	                        moveit_task_constructor_msgs::Solution& solution);
 
 	void execCallback(const moveit_task_constructor_msgs::ExecuteTaskSolutionGoalConstPtr& goal);
 	void preemptCallback();
 
 	std::unique_ptr<actionlib::SimpleActionServer<moveit_task_constructor_msgs::ExecuteTaskSolutionAction>> as_;
+	bool pipelined_ = false;
+
+	/// merge consecutive sub trajectories without intermediate effects into a single, re-timed trajectory
+	bool blended_ = false;
+	double blend_velocity_scaling_ = 1.0;
+	double blend_acceleration_scaling_ = 1.0;
+	/// collision-check solutions against the current scene before execution
+	bool validate_ = false;
+
+	std::map<std::vector<std::string>, const moveit::core::JointModelGroup*> group_cache_;
+	std::mutex group_cache_mutex_;
+	/// merged groups referenced by trajectories of concurrently executed sub trajectories
+	std::set<moveit::core::JointModelGroupPtr> merged_groups_;
+
+	/// shared-memory rings of planning nodes on this host, by segment name
+	std::map<std::string, moveit::task_constructor::SolutionRingPtr> rings_;
 };
 
 }  // namespace move_group
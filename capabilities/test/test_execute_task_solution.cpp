@@ -0,0 +1,171 @@
+#include <moveit/task_constructor/task.h>
+#include <moveit/task_constructor/stages/current_state.h>
+#include <moveit/task_constructor/stages/move_relative.h>
+#include <moveit/task_constructor/solvers/joint_interpolation.h>
+
+#include <moveit_task_constructor_msgs/ExecuteTaskSolutionAction.h>
+#include <moveit_msgs/ApplyPlanningScene.h>
+#include <actionlib/client/simple_action_client.h>
+#include <sensor_msgs/JointState.h>
+#include <ros/ros.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+
+using namespace moveit::task_constructor;
+
+// current position of a joint, as reported by the fake controllers
+double currentPosition(const std::string& joint) {
+	auto msg = ros::topic::waitForMessage<sensor_msgs::JointState>("joint_states", ros::Duration(10.0));
+	if (!msg)
+		throw std::runtime_error("no joint_states received");
+	auto it = std::find(msg->name.begin(), msg->name.end(), joint);
+	if (it == msg->name.end())
+		throw std::runtime_error("unknown joint " + joint);
+	return msg->position[it - msg->name.begin()];
+}
+
+// add or remove a box around the panda's hand in its ready pose to/from move_group's scene
+bool applyObstacle(int8_t operation) {
+	moveit_msgs::CollisionObject box;
+	box.id = "obstacle";
+	box.header.frame_id = "world";
+	box.operation = operation;
+	box.primitives.resize(1);
+	box.primitives[0].type = shape_msgs::SolidPrimitive::BOX;
+	box.primitives[0].dimensions = { 0.2, 0.2, 0.2 };
+	box.primitive_poses.resize(1);
+	box.primitive_poses[0].position.x = 0.3;
+	box.primitive_poses[0].position.z = 0.6;
+	box.primitive_poses[0].orientation.w = 1.0;
+
+	moveit_msgs::ApplyPlanningScene srv;
+	srv.request.scene.is_diff = true;
+	srv.request.scene.robot_state.is_diff = true;
+	srv.request.scene.world.collision_objects.push_back(box);
+	return ros::service::call("apply_planning_scene", srv) && srv.response.success;
+}
+
+// move_group is launched with blended execution and validation enabled
+struct ExecuteTaskSolution : public testing::Test
+{
+	Task t;
+	solvers::JointInterpolationPlannerPtr planner = std::make_shared<solvers::JointInterpolationPlanner>();
+
+	ExecuteTaskSolution() {
+		t.loadRobotModel();
+		t.add(std::make_unique<stages::CurrentState>("current"));
+	}
+
+	Stage* addMove(const std::string& group, const std::string& joint, double delta,
+	               const solvers::PlannerInterfacePtr& planner) {
+		auto move = std::make_unique<stages::MoveRelative>("move " + joint, planner);
+		move->setGroup(group);
+		move->setDirection(std::map<std::string, double>{ { joint, delta } });
+		Stage* stage = move.get();
+		t.add(std::move(move));
+		return stage;
+	}
+	Stage* addMove(const std::string& group, const std::string& joint, double delta) {
+		return addMove(group, joint, delta, planner);
+	}
+
+	// plan the task, returning the summed duration of the sub trajectories of its solution
+	double plan(moveit_task_constructor_msgs::Solution& msg) {
+		if (!t.plan(1) || t.solutions().empty())
+			throw std::runtime_error("planning failed");
+		t.solutions().front()->toMsg(msg);
+		double duration = 0.0;
+		for (const auto& sub : msg.sub_trajectory)
+			if (!sub.trajectory.joint_trajectory.points.empty())
+				duration += sub.trajectory.joint_trajectory.points.back().time_from_start.toSec();
+		return duration;
+	}
+
+	// execute the solution via move_group, measuring the wall time of execution
+	moveit::core::MoveItErrorCode execute(const moveit_task_constructor_msgs::Solution& msg, double& elapsed) {
+		auto start = std::chrono::steady_clock::now();
+		moveit::core::MoveItErrorCode result = t.execute(msg);
+		elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return result;
+	}
+};
+
+// consecutive motions of the same group are re-timed as a whole, without stopping at the junction
+TEST_F(ExecuteTaskSolution, blendedExecution) {
+	const double delta = currentPosition("panda_joint1") > 0.0 ? -0.5 : 0.5;
+	addMove("panda_arm", "panda_joint1", delta);
+	addMove("panda_arm", "panda_joint1", delta);
+
+	moveit_task_constructor_msgs::Solution msg;
+	const double planned = plan(msg);
+	const double start = currentPosition("panda_joint1");
+
+	double elapsed;
+	EXPECT_EQ(execute(msg, elapsed), moveit::core::MoveItErrorCode::SUCCESS);
+	EXPECT_NEAR(currentPosition("panda_joint1"), start + 2 * delta, 1e-2);
+	// executing both motions in sequence, with a stop in between, would take at least their planned duration
+	EXPECT_LT(elapsed, 0.9 * planned);
+}
+
+// a hand motion allowed to run concurrently is executed in parallel with the preceding arm motion
+TEST_F(ExecuteTaskSolution, concurrentExecution) {
+	const double arm_delta = currentPosition("panda_joint1") > 0.0 ? -0.5 : 0.5;
+	const double hand_delta = currentPosition("panda_finger_joint1") > 0.02 ? -0.03 : 0.03;
+	addMove("panda_arm", "panda_joint1", arm_delta);
+	// slow down the hand, such that sequential execution would take noticeably longer
+	auto slow = std::make_shared<solvers::JointInterpolationPlanner>();
+	slow->setProperty("max_velocity_scaling_factor", 0.1);
+	Stage* hand = addMove("hand", "panda_finger_joint1", hand_delta, slow);
+	TrajectoryExecutionInfo info;
+	info.concurrent = true;
+	hand->setTrajectoryExecutionInfo(info);
+
+	moveit_task_constructor_msgs::Solution msg;
+	const double planned = plan(msg);
+	const double arm_start = currentPosition("panda_joint1");
+	const double hand_start = currentPosition("panda_finger_joint1");
+
+	double elapsed;
+	EXPECT_EQ(execute(msg, elapsed), moveit::core::MoveItErrorCode::SUCCESS);
+	EXPECT_NEAR(currentPosition("panda_joint1"), arm_start + arm_delta, 1e-2);
+	EXPECT_NEAR(currentPosition("panda_finger_joint1"), hand_start + hand_delta, 1e-3);
+	EXPECT_LT(elapsed, 0.75 * planned);
+}
+
+// a solution colliding with an obstacle that appeared after planning is rejected before moving the robot
+TEST_F(ExecuteTaskSolution, validateBeforeExecution) {
+	const double delta = currentPosition("panda_joint1") > 0.0 ? -0.5 : 0.5;
+	addMove("panda_arm", "panda_joint1", delta);
+
+	moveit_task_constructor_msgs::Solution msg;
+	plan(msg);
+	const double start = currentPosition("panda_joint1");
+
+	ASSERT_TRUE(applyObstacle(moveit_msgs::CollisionObject::ADD));
+	double elapsed;
+	moveit::core::MoveItErrorCode result = execute(msg, elapsed);
+	EXPECT_TRUE(applyObstacle(moveit_msgs::CollisionObject::REMOVE));
+
+	EXPECT_EQ(result, moveit_msgs::MoveItErrorCodes::MOTION_PLAN_INVALIDATED_BY_ENVIRONMENT_CHANGE);
+	EXPECT_NEAR(currentPosition("panda_joint1"), start, 1e-3);
+}
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	ros::init(argc, argv, "test_execute_task_solution");
+	ros::AsyncSpinner spinner(1);
+	spinner.start();
+
+	// wait for move_group to come up
+	actionlib::SimpleActionClient<moveit_task_constructor_msgs::ExecuteTaskSolutionAction> ac("execute_task_solution");
+	if (!ac.waitForServer(ros::Duration(60.0))) {
+		ROS_ERROR("execute_task_solution action server not available");
+		return 1;
+	}
+	return RUN_ALL_TESTS();
+}
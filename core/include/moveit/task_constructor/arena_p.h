@@ -0,0 +1,210 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Memory arena and pool for cheap allocation of planning data
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+/** Monotonic arena, handing out memory from large blocks
+ *
+ * Individual deallocation is a no-op. Instead, all memory is released at once via release(),
+ * which keeps the allocated blocks for reuse in the next planning run.
+ * The arena is not thread-safe: accesses need to be serialized by the user.
+ */
+class MonotonicArena
+{
+	struct Block
+	{
+		std::unique_ptr<char[]> data;
+		std::size_t size;
+	};
+	std::vector<Block> blocks_;
+	std::size_t block_size_;
+	std::size_t current_ = 0;  // index of block currently used for allocation
+	std::size_t offset_ = 0;  // offset of first free byte in current block
+
+	static std::size_t aligned(std::uintptr_t address, std::size_t alignment) {
+		return (alignment - address % alignment) % alignment;
+	}
+
+public:
+	explicit MonotonicArena(std::size_t block_size = 64 * 1024) : block_size_(block_size) {}
+	MonotonicArena(const MonotonicArena&) = delete;
+	MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+	void* allocate(std::size_t bytes, std::size_t alignment) {
+		for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+			Block& block = blocks_[current_];
+			std::size_t start = offset_ + aligned(reinterpret_cast<std::uintptr_t>(block.data.get()) + offset_, alignment);
+			if (start + bytes <= block.size) {
+				offset_ = start + bytes;
+				return block.data.get() + start;
+			}
+		}
+		// no space left in existing blocks: allocate a new one (operator new[] aligns for any fundamental type)
+		std::size_t size = std::max(block_size_, bytes);
+		blocks_.push_back(Block{ std::unique_ptr<char[]>(new char[size]), size });
+		current_ = blocks_.size() - 1;
+		offset_ = bytes;
+		return blocks_.back().data.get();
+	}
+
+	/// release all memory handed out so far, keeping the blocks for reuse
+	void release() {
+		current_ = 0;
+		offset_ = 0;
+	}
+
+	/// number of bytes reserved by the arena
+	std::size_t capacity() const {
+		std::size_t result = 0;
+		for (const Block& block : blocks_)
+			result += block.size;
+		return result;
+	}
+};
+
+/// STL allocator drawing memory from a MonotonicArena
+template <typename T>
+class ArenaAllocator
+{
+	template <typename U>
+	friend class ArenaAllocator;
+	MonotonicArena* arena_;
+
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(MonotonicArena* arena) : arena_(arena) {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+	void deallocate(T* /* p */, std::size_t /* n */) {}  // memory is released in bulk
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const {
+		return arena_ == other.arena_;
+	}
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const {
+		return arena_ != other.arena_;
+	}
+};
+
+/** Thread-safe pool recycling freed memory blocks for later allocations of the same size
+ *
+ * Blocks are kept until the pool is destroyed, which happens only after all PoolAllocators
+ * (and thus all objects allocated via std::allocate_shared) referring to it have gone.
+ */
+class RecyclingPool
+{
+	std::mutex mutex_;
+	std::unordered_map<std::size_t, std::vector<void*>> free_;  // free blocks by size
+
+public:
+	RecyclingPool() = default;
+	RecyclingPool(const RecyclingPool&) = delete;
+	RecyclingPool& operator=(const RecyclingPool&) = delete;
+	~RecyclingPool() {
+		for (auto& blocks : free_)
+			for (void* block : blocks.second)
+				::operator delete(block);
+	}
+
+	void* allocate(std::size_t bytes) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto it = free_.find(bytes);
+			if (it != free_.end() && !it->second.empty()) {
+				void* block = it->second.back();
+				it->second.pop_back();
+				return block;
+			}
+		}
+		return ::operator new(bytes);
+	}
+	void deallocate(void* block, std::size_t bytes) noexcept {
+		try {
+			std::lock_guard<std::mutex> lock(mutex_);
+			free_[bytes].push_back(block);
+		} catch (...) {
+			::operator delete(block);
+		}
+	}
+};
+
+/// STL allocator drawing memory from a shared RecyclingPool
+template <typename T>
+class PoolAllocator
+{
+	template <typename U>
+	friend class PoolAllocator;
+	std::shared_ptr<RecyclingPool> pool_;
+
+public:
+	using value_type = T;
+
+	explicit PoolAllocator(std::shared_ptr<RecyclingPool> pool) : pool_(std::move(pool)) {}
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>& other) : pool_(other.pool_) {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(pool_->allocate(n * sizeof(T))); }
+	void deallocate(T* p, std::size_t n) noexcept { pool_->deallocate(p, n * sizeof(T)); }
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>& other) const {
+		return pool_ == other.pool_;
+	}
+	template <typename U>
+	bool operator!=(const PoolAllocator<U>& other) const {
+		return pool_ != other.pool_;
+	}
+};
+
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,126 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Backend interface for batched collision and distance queries
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/collision_detection/collision_common.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace planning_scene {
+MOVEIT_CLASS_FORWARD(PlanningScene);
+}
+namespace moveit {
+namespace core {
+MOVEIT_CLASS_FORWARD(RobotState);
+}
+}  // namespace moveit
+
+namespace moveit {
+namespace task_constructor {
+
+class ThreadPool;
+MOVEIT_CLASS_FORWARD(BatchCollisionChecker);
+
+/** Backend evaluating collision and distance queries for many robot states in a single call
+ *
+ * Stages, solvers, and cost terms submit their candidate states as a batch to the active() backend,
+ * which allows for parallel evaluation, e.g. on multiple cores or a GPU.
+ * Custom backends can be installed process-wide via setActive().
+ *
+ * All states need to have up-to-date link transforms.
+ */
+class BatchCollisionChecker
+{
+public:
+	using States = std::vector<const moveit::core::RobotState*>;
+
+	virtual ~BatchCollisionChecker() = default;
+
+	/** Check all states for collisions of given group (or the whole robot if empty) w.r.t. scene
+	 *
+	 * Returns a vector of flags, true indicating a collision of the corresponding state.
+	 * The optional pool provides threads available to the caller.
+	 */
+	virtual std::vector<bool> checkCollision(const planning_scene::PlanningScene& scene, const States& states,
+	                                         const std::string& group = "", ThreadPool* pool = nullptr) const = 0;
+
+	/** Compute robot distances for all states, w.r.t. the world (and robot) or only self distances
+	 *
+	 * The request's acm and group need to stay valid during the call.
+	 */
+	virtual std::vector<collision_detection::DistanceResult>
+	distance(const planning_scene::PlanningScene& scene, const States& states,
+	         const collision_detection::DistanceRequest& request, bool with_world = true,
+	         ThreadPool* pool = nullptr) const = 0;
+
+	/// process-wide backend, by default a sequential ThreadedCollisionChecker
+	static BatchCollisionCheckerPtr active();
+	/// install a custom backend, nullptr restores the default
+	static void setActive(const BatchCollisionCheckerPtr& checker);
+};
+
+/** CPU backend distributing states over worker threads, each using the scene's collision environment (e.g. FCL)
+ *
+ * The caller's pool is preferred. Without it, the checker's own pool of num_threads workers is used.
+ * With neither of them, states are evaluated sequentially.
+ */
+class ThreadedCollisionChecker : public BatchCollisionChecker
+{
+public:
+	explicit ThreadedCollisionChecker(size_t num_threads = 0);
+	~ThreadedCollisionChecker() override;
+
+	std::vector<bool> checkCollision(const planning_scene::PlanningScene& scene, const States& states,
+	                                 const std::string& group = "", ThreadPool* pool = nullptr) const override;
+
+	std::vector<collision_detection::DistanceResult> distance(const planning_scene::PlanningScene& scene,
+	                                                          const States& states,
+	                                                          const collision_detection::DistanceRequest& request,
+	                                                          bool with_world = true,
+	                                                          ThreadPool* pool = nullptr) const override;
+
+private:
+	void forEach(size_t count, const std::function<void(size_t)>& job, ThreadPool* pool) const;
+
+	std::unique_ptr<ThreadPool> pool_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
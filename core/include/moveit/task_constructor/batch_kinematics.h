@@ -0,0 +1,114 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Forward kinematics of a single link for many joint configurations at once
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <Eigen/Geometry>
+#include <vector>
+
+namespace moveit {
+namespace core {
+MOVEIT_CLASS_FORWARD(RobotModel);
+MOVEIT_CLASS_FORWARD(RobotState);
+MOVEIT_CLASS_FORWARD(JointModelGroup);
+MOVEIT_CLASS_FORWARD(JointModel);
+MOVEIT_CLASS_FORWARD(LinkModel);
+}  // namespace core
+}  // namespace moveit
+
+namespace moveit {
+namespace task_constructor {
+
+/** Batch forward kinematics of a link for many joint configurations
+ *
+ * Joint configurations are passed as a matrix with one row per variable of the group (in group order, as
+ * provided by RobotState::copyJointGroupPositions()) and one column per state.
+ * Transforms are computed in structure-of-arrays layout: each component is stored in a contiguous row,
+ * such that Eigen vectorizes all computations across states.
+ *
+ * Revolute, prismatic, and fixed joints are evaluated in batch, other joint types per state.
+ * Variables outside the group are taken from a reference state.
+ */
+class BatchForwardKinematics
+{
+public:
+	/// joint values: one row per group variable, one column per state
+	using Positions = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+	/// rows 0..8: rotation matrix (row-major), rows 9..11: translation
+	struct Transforms
+	{
+		using Data = Eigen::Array<double, 12, Eigen::Dynamic, Eigen::RowMajor>;
+		Data data;
+
+		Eigen::Index size() const { return data.cols(); }
+		Eigen::Isometry3d operator[](Eigen::Index i) const;
+		/// positions of a point, given in link frame, for all states
+		Eigen::Matrix3Xd transformPoint(const Eigen::Vector3d& point) const;
+	};
+
+	/// chain from the robot's root to link, group == nullptr refers to all variables of the robot
+	BatchForwardKinematics(const moveit::core::RobotModel& robot_model, const moveit::core::LinkModel* link,
+	                       const moveit::core::JointModelGroup* group = nullptr);
+
+	size_t variableCount() const { return variable_count_; }
+
+	/// gather group positions of given states into a matrix
+	Positions positions(const std::vector<const moveit::core::RobotState*>& states) const;
+
+	/** global transforms of link for all configurations
+	 *
+	 * The reference state provides all variables outside the group and needs up-to-date link transforms.
+	 */
+	void compute(const moveit::core::RobotState& reference, const Positions& positions, Transforms& result) const;
+
+private:
+	struct Segment
+	{
+		const moveit::core::LinkModel* link;
+		const moveit::core::JointModel* joint;
+		std::vector<int> rows;  // positions row of each joint variable, -1 if outside group
+	};
+
+	const moveit::core::LinkModel* link_;
+	const moveit::core::JointModelGroup* group_;
+	size_t variable_count_;
+	std::vector<Segment> chain_;  // from root to link
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -98,6 +98,7 @@ public:
 	PRIVATE_CLASS(SerialContainer)
 	SerialContainer(const std::string& name = "serial container");
 
+	void reset() override;
 	bool canCompute() const override;
 	void compute() override;
 
@@ -144,6 +145,7 @@ protected:
 /** Plan for different alternatives in parallel.
  *
  * Solution of all children are reported - sorted by cost.
+ * With multi-threaded planning, the children are computed concurrently.
  */
 class Alternatives : public ParallelContainerBase
 {
@@ -162,6 +164,10 @@ class FallbacksPrivate;
  * Try to find feasible solutions using first child. Only if this fails,
  * proceed to the next child trying an alternative planning strategy.
  * All solutions of the last active child are reported.
+ *
+ * For propagating Fallbacks, multi-threaded planning allows to speculatively feed a job to the subsequent
+ * children as well (see setSpeculation()). Their solutions are held back until all preceding children failed
+ * on the job and are discarded as soon as a preceding child succeeded.
  */
 class Fallbacks : public ParallelContainerBase
 {
@@ -174,6 +180,9 @@ public:
 	void reset() override;
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 
+	/// number of subsequent children computing the current job concurrently (requires multi-threaded planning)
+	void setSpeculation(uint32_t n) { setProperty("speculation", n); }
+
 protected:
 	Fallbacks(FallbacksPrivate* impl);
 	void onNewSolution(const SolutionBase& s) override;
@@ -185,13 +194,20 @@ private:
 };
 
 class MergerPrivate;
-/** Plan for different sub tasks in parallel and finally merge all sub solutions into a single trajectory */
+/** Plan for different sub tasks in parallel and finally merge all sub solutions into a single trajectory
+ *
+ * Combinations of child solutions are enumerated lazily and merged in order of their accumulated cost.
+ * With multi-threaded planning, several combinations are merged and validated concurrently.
+ */
 class Merger : public ParallelContainerBase
 {
 public:
 	PRIVATE_CLASS(Merger)
 	Merger(const std::string& name = "merger");
 
+	/// stop merging combinations of a source state after this many valid merged solutions (0: unbounded)
+	void setMaxSolutions(uint32_t n) { setProperty("max_solutions", n); }
+
 	void reset() override;
 	void init(const core::RobotModelConstPtr& robot_model) override;
 	bool canCompute() const override;
@@ -46,8 +46,12 @@
 #include <boost/bimap/unordered_set_of.hpp>
 #include <boost/bimap/unordered_multiset_of.hpp>
 
-#include <map>
+#include <unordered_map>
 #include <climits>
+#include <limits>
+#include <list>
+#include <memory>
+#include <queue>
 
 namespace moveit {
 namespace core {
@@ -149,10 +153,14 @@ protected:
 		child->setNextStarts(allowed ? pending_forward_ : InterfacePtr());
 	}
 
-	/// Set ENABLED/PRUNED status of a solution branch starting from target into the given direction
+	/** Set ENABLED/PRUNED status of a solution branch starting from target into the given direction
+	 *
+	 * If ignore_failures is set, failed solutions don't count as alternative paths keeping a state enabled,
+	 * e.g. for solutions invalidated by Task::replan().
+	 */
 	template <Interface::Direction dir>
 	void setStatus(const Stage* creator, const InterfaceState* source, const InterfaceState* target,
-	               InterfaceState::Status status);
+	               InterfaceState::Status status, bool ignore_failures = false);
 
 	/// Copy external_state to a child's interface and remember the link in internal_external map
 	template <Interface::Direction>
@@ -180,15 +188,61 @@ private:
 	             boost::bimaps::unordered_multiset_of<boost::bimaps::tagged<const InterfaceState*, EXTERNAL>>>
 	    internal_external_;
 
-	/* TODO: these interfaces don't need to be priority-sorted.
-	 * Introduce base class UnsortedInterface (which is a plain list) for this use case. */
-	// interface to receive children's sendBackward() states
+	// interface to receive children's sendBackward() states (not priority-sorted)
 	InterfacePtr pending_backward_;
-	// interface to receive children's sendForward() states
+	// interface to receive children's sendForward() states (not priority-sorted)
 	InterfacePtr pending_forward_;
 };
 PIMPL_FUNCTIONS(ContainerBase)
 
+/** Enumerate complete solution paths, combining incoming and outgoing partial paths, in order of increasing cost
+ *
+ * Instead of creating and sorting all incoming × outgoing combinations upfront,
+ * the next-best combination is generated on demand from a heap of candidates (k-shortest-path style).
+ * The partial paths are copied, such that enumeration can be continued later on.
+ */
+class BestFirstPaths
+{
+public:
+	using Paths = std::list<std::pair<SolutionSequence::container_type, InterfaceState::Priority>>;
+	using Path = Paths::value_type;
+
+	/// consider incoming / outgoing paths reaching the container's start / end, i.e. having the given depths
+	BestFirstPaths(const Paths& incoming, size_t in_depth, const Paths& outgoing, size_t out_depth,
+	               const SolutionBase& current, size_t id);
+
+	bool empty() const { return heap_.empty(); }
+	/// cost of the next-best path
+	double nextCost() const { return heap_.top().prio.cost(); }
+	/// creation order, breaking ties between equally good paths of different instances
+	size_t id() const { return id_; }
+
+	/// retrieve the next-best path as sequence of children's solutions
+	InterfaceState::Priority pop(SolutionSequence::container_type& solution);
+
+private:
+	struct Candidate
+	{
+		InterfaceState::Priority prio;
+		size_t in, out;  // indices into incoming_ and outgoing_
+
+		// order by cost, then in enumeration order of incoming and outgoing paths
+		bool operator>(const Candidate& other) const {
+			return std::make_tuple(prio.cost(), in, out) > std::make_tuple(other.prio.cost(), other.in, other.out);
+		}
+	};
+
+	static void collect(const Paths& paths, size_t depth, std::vector<Path>& result);
+	void push(size_t in, size_t out);
+
+	const SolutionBase* current_;
+	const InterfaceState::Priority current_prio_;
+	const size_t id_;
+	std::vector<Path> incoming_;
+	std::vector<Path> outgoing_;
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap_;
+};
+
 /* A solution of a SerialContainer needs to connect start to end via a full path.
  * The solution of a single child stage is usually disconnected to the container's start or end.
  * Only if all the children in the chain have found a coherent solution from start to end,
@@ -208,6 +262,12 @@ public:
 
 	void reset();
 
+	/// only lift complete solutions when requested via liftPendingSolutions(), instead of as soon as they are found
+	void setLiftOnRequest(bool enable) { lift_on_request_ = enable; }
+	bool hasPendingSolutions() const { return !pending_.empty(); }
+	/// lift (at most max) pending complete solutions in order of increasing cost, returning the number of lifted ones
+	size_t liftPendingSolutions(size_t max = std::numeric_limits<size_t>::max());
+
 protected:
 	// connect two neighbors
 	void connect(StagePrivate& stage1, StagePrivate& stage2);
@@ -215,6 +275,11 @@ protected:
 	// validate that child's interface matches mine (considering start or end only as determined by mask)
 	template <unsigned int mask>
 	void validateInterface(const StagePrivate& child, InterfaceFlags required) const;
+
+	bool lift_on_request_ = false;
+	// heap of not yet (fully) lifted complete paths, ordered by their next-best cost
+	std::vector<std::unique_ptr<BestFirstPaths>> pending_;
+	size_t next_paths_id_ = 0;
 };
 PIMPL_FUNCTIONS(SerialContainer)
 
@@ -233,11 +298,11 @@ public:
 protected:
 	void validateInterfaces(const StagePrivate& child, InterfaceFlags& external, bool first = false) const;
 
-private:
 	/// notify callback for new externally received interface states
 	template <typename Interface::Direction>
 	void propagateStateToAllChildren(Interface::iterator external, Interface::UpdateFlags updated);
 
+private:
 	// override to customize behavior on received interface states (default: propagateStateToAllChildren())
 	virtual void initializeExternalInterfaces();
 };
@@ -296,12 +361,22 @@ struct FallbacksPrivatePropagator : FallbacksPrivateCommon
 {
 	FallbacksPrivatePropagator(FallbacksPrivate&& old);
 	void reset() override;
+	void compute() override;
 	void onNewSolution(const SolutionBase& s) override;
 	bool nextJob() override;
 
+	/// feed job_ to current_ and - when speculating - to subsequent children
+	void feedJob();
+	/// lift solutions held back for current_
+	void releaseSpeculation();
+	/// retract job_ from children in [from, fed_end_) and discard their held back solutions
+	void dropSpeculation(container_type::const_iterator from);
+
 	Interface::Direction dir_;  // propagation direction
 	Interface::iterator job_;  // pointer to currently processed external state
 	bool job_has_solutions_;  // flag indicating whether the current job generated solutions
+	container_type::const_iterator fed_end_;  // end of children range [current_, fed_end_) fed with job_
+	std::vector<const SolutionBase*> speculative_;  // held back solutions of children after current_
 };
 
 /// Fallbacks implementation for CONNECT interface
@@ -334,9 +409,16 @@ class MergerPrivate : public ParallelContainerBasePrivate
 
 	moveit::core::JointModelGroupPtr jmg_merged_;
 	using ChildSolutionList = std::vector<const SubTrajectory*>;
-	using ChildSolutionMap = std::map<const Stage*, ChildSolutionList>;
-	// map from external source state (iterator) to all corresponding children's solutions
-	std::map<const InterfaceState*, ChildSolutionMap> source_state_to_solutions_;
+	// children's solutions of an external source state
+	struct SourceSolutions
+	{
+		std::vector<ChildSolutionList> children;  // indexed like children(), released once fully merged
+		size_t num_children = 0;  // number of children having provided a solution
+		size_t num_merged = 0;  // number of valid merged solutions
+	};
+	// index of external source states, entries of PRUNED states are dropped
+	std::unordered_map<const InterfaceState*, SourceSolutions> source_solutions_;
+	const InterfaceState* merging_ = nullptr;  // source state whose solutions are currently merged
 
 public:
 	using Spawner = std::function<void(SubTrajectory&&)>;
@@ -346,13 +428,20 @@ public:
 
 	void onNewPropagateSolution(const SolutionBase& s);
 	void onNewGeneratorSolution(const SolutionBase& s);
-	void mergeAnyCombination(const ChildSolutionMap& all_solutions, const SolutionBase& current,
-	                         const planning_scene::PlanningSceneConstPtr& start_scene, const Spawner& spawner);
-	void merge(const ChildSolutionList& sub_solutions, const planning_scene::PlanningSceneConstPtr& start_scene,
-	           const Spawner& spawner);
+	// combine the latest solution of child current with all solutions of the other children
+	void mergeAnyCombination(const std::vector<ChildSolutionList>& all_solutions, size_t current,
+	                         const planning_scene::PlanningSceneConstPtr& start_scene, const Spawner& spawner,
+	                         size_t& num_merged);
+	SubTrajectory merge(const ChildSolutionList& sub_solutions, const planning_scene::PlanningSceneConstPtr& start_scene,
+	                    moveit::core::JointModelGroup* jmg) const;
 
 	void sendForward(SubTrajectory&& t, const InterfaceState* from);
 	void sendBackward(SubTrajectory&& t, const InterfaceState* to);
+
+private:
+	void initializeExternalInterfaces() override;
+	// drop indexed solutions of a source state that became PRUNED
+	void onSourceStateUpdate(const InterfaceState& external);
 };
 PIMPL_FUNCTIONS(Merger)
 }  // namespace task_constructor
@@ -5,6 +5,9 @@
 #include <deque>
 #include <iostream>
 #include <algorithm>
+#include <cassert>
+#include <set>
+#include <unordered_map>
 
 /// ValueOrPointeeLess provides correct comparison for plain and pointer-like types
 template <typename T, typename = bool>
@@ -18,14 +21,110 @@ struct ValueOrPointeeLess<T, decltype(*std::declval<T>() < *std::declval<T>())>
 	bool operator()(const T& x, const T& y) const { return *x < *y; }
 };
 
+namespace detail {
+
+/** Default backend of ordered<T>: no extra index
+ *
+ * Insert positions are found via std::upper_bound on the list itself,
+ * i.e. using a logarithmic number of comparisons, but linear iterator traversal.
+ */
+template <typename Container, typename Compare>
+class LinearIndex
+{
+	Compare comp_;
+
+public:
+	using iterator = typename Container::iterator;
+
+	LinearIndex(const Compare& comp) : comp_(comp) {}
+
+	/// register node (not yet part of c) and return position in c to insert it before
+	iterator insert(iterator node, Container& c) { return std::upper_bound(c.begin(), c.end(), *node, comp_); }
+	/// unregister node before it is removed from the list
+	void erase(typename Container::const_iterator /* node */) {}
+	void clear() {}
+	/// rebuild index after sorting c
+	void rebuild(Container& /* c */) {}
+};
+
+/** Balanced-tree index on the list nodes, providing logarithmic insertion and update
+ *
+ * The index keeps the same order as the underlying list and requires two extra allocations per element.
+ */
+template <typename Container, typename Compare>
+class TreeIndex
+{
+public:
+	using iterator = typename Container::iterator;
+
+private:
+	struct NodeLess
+	{
+		const Compare& comp;
+		bool operator()(const iterator& x, const iterator& y) const { return comp(*x, *y); }
+	};
+	using Index = std::multiset<iterator, NodeLess>;
+	Index index_;
+	// map element address to its index entry, list nodes (and thus their addresses) are stable
+	std::unordered_map<const typename Container::value_type*, typename Index::iterator> handles_;
+
+public:
+	TreeIndex(const Compare& comp) : index_(NodeLess{ comp }) {}
+	// NodeLess refers to the owning container's comparator: disable copying
+	TreeIndex(const TreeIndex&) = delete;
+
+	iterator insert(iterator node, Container& c) {
+		// multiset::insert places equivalent items last, i.e. at their upper bound
+		auto pos = index_.insert(node);
+		handles_.emplace(&*node, pos);
+		auto next = std::next(pos);
+		return next == index_.end() ? c.end() : *next;
+	}
+	void erase(typename Container::const_iterator node) {
+		auto it = handles_.find(&*node);
+		assert(it != handles_.end());
+		index_.erase(it->second);
+		handles_.erase(it);
+	}
+	void clear() {
+		index_.clear();
+		handles_.clear();
+	}
+	void rebuild(Container& c) {
+		clear();
+		handles_.reserve(c.size());
+		for (auto it = c.begin(), end = c.end(); it != end; ++it)
+			handles_.emplace(&*it, index_.insert(index_.end(), it));  // hint: append to the end
+	}
+};
+}  // namespace detail
+
+/// Backend selection for ordered<T>
+namespace ordered_backend {
+/// lightweight default: std::list only, linear-time insertion
+struct list
+{
+	template <typename Container, typename Compare>
+	using index = detail::LinearIndex<Container, Compare>;
+};
+/// additional tree index: logarithmic insertion and update, but higher memory footprint
+struct indexed
+{
+	template <typename Container, typename Compare>
+	using index = detail::TreeIndex<Container, Compare>;
+};
+}  // namespace ordered_backend
+
 /**
  *  @brief ordered<ValueType> provides an adapter for a std::list to allow sorting.
  *
  *  In contrast to std::priority_queue, we use a std::list as the underlying container.
  *  This ensures, that existing iterators remain valid upon insertion and deletion.
- *  Sorted insertion has logarithmic complexity.
+ *  Sorted insertion requires a logarithmic number of comparisons but linear list traversal.
+ *  The ordered_backend::indexed backend additionally maintains a tree index, yielding
+ *  logarithmic insertion and update for large containers.
  */
-template <typename T, typename Compare = ValueOrPointeeLess<T>>
+template <typename T, typename Compare = ValueOrPointeeLess<T>, typename Backend = ordered_backend::list>
 class ordered
 {
 public:
@@ -49,20 +148,51 @@ public:
 protected:
 	container_type c;
 	Compare comp;
+	typename Backend::template index<container_type, Compare> index_{ comp };
+
+	// insert node of other into c at sorted position
+	iterator insertNode(iterator node, container_type& other) {
+		iterator at = index_.insert(node, c);
+		c.splice(at, other, node);
+		return node;
+	}
 
 public:
 	/// initialize empty container
 	explicit ordered() {}
+	// the index refers to our own comparator and list nodes: rebuild it on copy / move
+	ordered(const ordered& other) : c(other.c), comp(other.comp) { index_.rebuild(c); }
+	ordered(ordered&& other) : c(std::move(other.c)), comp(other.comp) {
+		other.clear();
+		index_.rebuild(c);
+	}
+	ordered& operator=(const ordered& other) {
+		c = other.c;
+		comp = other.comp;
+		index_.rebuild(c);
+		return *this;
+	}
+	ordered& operator=(ordered&& other) {
+		c = std::move(other.c);
+		comp = other.comp;
+		other.clear();
+		index_.rebuild(c);
+		return *this;
+	}
 
 	bool empty() const { return c.empty(); }
 	size_type size() const { return c.size(); }
 
-	void clear() { c.clear(); }
+	void clear() {
+		index_.clear();
+		c.clear();
+	}
 
 	reference top() { return c.front(); }
 	const_reference top() const { return c.front(); }
 	value_type pop() {
 		value_type result(top());
+		index_.erase(c.begin());
 		c.pop_front();
 		return result;
 	}
@@ -86,45 +216,55 @@ public:
 	const_reverse_iterator crend() const { return c.rend(); }
 
 	/// explicitly sort container, useful if many items have changed their value
-	void sort() { c.sort(comp); }
+	void sort() {
+		c.sort(comp);
+		index_.rebuild(c);
+	}
 
 	iterator insert(const value_type& item) {
-		iterator at = std::upper_bound(c.begin(), c.end(), item, comp);
-		return c.insert(at, item);
+		container_type temp;
+		temp.push_back(item);
+		return insertNode(temp.begin(), temp);
 	}
 	iterator insert(value_type&& item) {
-		iterator at = std::upper_bound(c.begin(), c.end(), item, comp);
-		return c.insert(at, std::move(item));
+		container_type temp;
+		temp.push_back(std::move(item));
+		return insertNode(temp.begin(), temp);
 	}
 	inline void push(const value_type& item) { insert(item); }
 	inline void push(value_type&& item) { insert(std::move(item)); }
 
-	iterator erase(const_iterator pos) { return c.erase(pos); }
+	iterator erase(const_iterator pos) {
+		index_.erase(pos);
+		return c.erase(pos);
+	}
 
 	/// update sort position of a single item after changes
 	iterator update(iterator& it) {
 		container_type temp;
+		index_.erase(it);
 		temp.splice(temp.end(), c, it);  // move it from c to temp
-		iterator at = std::upper_bound(c.begin(), c.end(), *it, comp);
-		c.splice(at, temp, it);
-		return it;
+		return insertNode(it, temp);
 	}
 
 	/// move element pos from this to other container, inserting before other_pos
 	iterator moveTo(iterator pos, container_type& other, iterator other_pos) {
+		index_.erase(pos);
 		other.splice(other_pos, c, pos);
 		return pos;
 	}
 	/// move element pos from other container into this one (sorted)
-	iterator moveFrom(iterator pos, container_type& other) {
-		iterator at = std::upper_bound(begin(), end(), *pos, comp);
-		c.splice(at, other, pos);
-		return pos;
-	}
+	iterator moveFrom(iterator pos, container_type& other) { return insertNode(pos, other); }
 
 	template <typename Predicate>
 	void remove_if(Predicate p) {
-		c.remove_if(p);
+		for (auto it = c.begin(), end = c.end(); it != end;) {
+			if (p(*it)) {
+				index_.erase(it);
+				it = c.erase(it);
+			} else
+				++it;
+		}
 	}
 };
 
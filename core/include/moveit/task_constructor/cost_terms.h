@@ -42,6 +42,11 @@
 #include <moveit/task_constructor/utils.h>
 #include <moveit_msgs/RobotState.h>
 
+#include <Eigen/Core>
+
+#include <atomic>
+#include <cstdint>
+
 namespace moveit {
 namespace task_constructor {
 
@@ -55,13 +60,31 @@ MOVEIT_CLASS_FORWARD(CostTerm);
 class CostTerm
 {
 public:
-	CostTerm() = default;
+	CostTerm() : id_{ nextId() } {}
 	CostTerm(std::nullptr_t) : CostTerm{} {}
+	// a copy is a distinct cost term, whose parameters might be changed independently
+	CostTerm(const CostTerm& /*other*/) : CostTerm{} {}
+	CostTerm& operator=(const CostTerm& /*other*/) {
+		modified();
+		return *this;
+	}
 	virtual ~CostTerm() = default;
 
 	virtual double operator()(const SubTrajectory& s, std::string& comment) const;
 	virtual double operator()(const SolutionSequence& s, std::string& comment) const;
 	virtual double operator()(const WrappedSolution& s, std::string& comment) const;
+
+	/// identity of this cost term, which (unlike its address) is never reused, see SolutionBase::computeCachedCost()
+	uint64_t id() const { return id_; }
+	/// counter changing with the parameters of this cost term (and of its nested cost terms)
+	virtual uint64_t version() const { return version_.load(std::memory_order_acquire); }
+	/// declare parameters as changed, invalidating cached results of this cost term
+	void modified() { version_.fetch_add(1, std::memory_order_acq_rel); }
+
+private:
+	static uint64_t nextId();
+	const uint64_t id_;
+	std::atomic<uint64_t> version_{ 0 };
 };
 
 /** base class for cost terms that only work on SubTrajectory solutions
@@ -108,6 +131,31 @@ private:
 	static auto signatureMatcher(const T& t) -> decltype(t(SubTrajectory{}, std::string{}), SubTrajectorySignature{});
 };
 
+/** Cost term evaluating all waypoints of a trajectory in a single call
+ *
+ * The callback receives the joint positions of all waypoints as a matrix (one row per waypoint)
+ * and their times from start. This allows for vectorized implementations, e.g. using NumPy in Python,
+ * instead of per-waypoint computations in the callback.
+ * If a group is given, only the variables of this group are passed, otherwise all robot variables.
+ * Solutions without trajectory are costed 0.
+ */
+class WaypointCostTerm : public TrajectoryCostTerm
+{
+public:
+	using Matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+	using Signature = std::function<double(const Matrix& positions, const Eigen::VectorXd& times, std::string& comment)>;
+
+	WaypointCostTerm(Signature term, std::string group = std::string())
+	  : term_{ std::move(term) }, group_{ std::move(group) } {}
+
+	using TrajectoryCostTerm::operator();
+	double operator()(const SubTrajectory& s, std::string& comment) const override;
+
+protected:
+	Signature term_;
+	std::string group_;
+};
+
 namespace cost {
 
 /// add a constant cost to each solution
@@ -123,6 +171,35 @@ public:
 	double cost;
 };
 
+/** Defer evaluation of an expensive cost term
+ *
+ * Solutions are costed by a cheap estimate first, which should be a lower bound of the exact cost.
+ * The exact cost term is only evaluated once a solution becomes part of a complete solution of the enclosing
+ * SerialContainer, i.e. when it competes in the container's ordered list of solutions.
+ * Solutions that are pruned or never connect to a complete solution skip the expensive evaluation.
+ */
+class Deferred : public CostTerm
+{
+public:
+	Deferred(CostTermConstPtr exact, CostTermConstPtr estimate = std::make_shared<CostTerm>())
+	  : exact{ std::move(exact) }, estimate{ std::move(estimate) } {}
+
+	// outside of stages, the estimate is used
+	double operator()(const SubTrajectory& s, std::string& comment) const override { return (*estimate)(s, comment); }
+	double operator()(const SolutionSequence& s, std::string& comment) const override {
+		return (*estimate)(s, comment);
+	}
+	double operator()(const WrappedSolution& s, std::string& comment) const override {
+		return (*estimate)(s, comment);
+	}
+	uint64_t version() const override {
+		return CostTerm::version() + (exact ? exact->version() : 0) + (estimate ? estimate->version() : 0);
+	}
+
+	CostTermConstPtr exact;
+	CostTermConstPtr estimate;
+};
+
 /// trajectory length with optional weighting for different joints
 class PathLength : public TrajectoryCostTerm
 {
@@ -184,6 +261,8 @@ public:
  * \arg group_property the name of the property which defines the group to look at
  * \arg interface compute distances using START or END interface of solution *only*, instead of averaging over
  * trajectory
+ *
+ * In trajectory mode, waypoints are evaluated concurrently if the task plans multi-threaded.
  * */
 class Clearance : public TrajectoryCostTerm
 {
@@ -196,12 +275,46 @@ public:
 
 	Mode mode;
 
+	/// check every k-th waypoint only (refining around the minimum found), 1 checks all waypoints
+	size_t waypoint_stride = 1;
+
 	std::function<double(double)> distance_to_cost;
 
 	using TrajectoryCostTerm::operator();
 	double operator()(const SubTrajectory& s, std::string& comment) const override;
 };
 
+/** weighted sum of cost terms, evaluated in a single pass over the trajectory
+ *
+ * PathLength and LinkMotion terms share a single traversal of the waypoints and the forward kinematics
+ * of their links. All other terms are evaluated individually on the solution.
+ * If any term yields infinite costs, the remaining terms are skipped and the composite cost is infinite.
+ */
+class Composite : public TrajectoryCostTerm
+{
+public:
+	struct Term
+	{
+		CostTermConstPtr term;
+		double weight;
+	};
+
+	Composite() = default;
+	Composite(std::vector<Term> t) : terms(std::move(t)) {}
+
+	Composite& add(CostTermConstPtr term, double weight = 1.0) {
+		terms.push_back(Term{ std::move(term), weight });
+		modified();
+		return *this;
+	}
+
+	using TrajectoryCostTerm::operator();
+	double operator()(const SubTrajectory& s, std::string& comment) const override;
+	uint64_t version() const override;
+
+	std::vector<Term> terms;
+};
+
 }  // namespace cost
 }  // namespace task_constructor
 }  // namespace moveit
@@ -0,0 +1,120 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Rolling planning statistics published as ROS diagnostics
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <diagnostic_msgs/DiagnosticStatus.h>
+#include <ros/publisher.h>
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+class ContainerBase;
+class Stage;
+
+/** Rolling statistics of a task's plan() calls, published on /diagnostics for diagnostic_aggregator
+ *
+ * Reports plans per second, time-to-first-solution percentiles, pruned states per second, and memory in use,
+ * as well as states created per second and the failure ratio of each stage.
+ * Statistics cover the plan() calls finished within the last window seconds.
+ */
+class PlanningDiagnostics
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// name identifies the task in the diagnostics, rate (Hz) limits publishing
+	PlanningDiagnostics(const std::string& name, double rate = 1.0, double window = 60.0);
+
+	/// start a plan() call, snapshotting the stages' counters
+	void planStarted(const ContainerBase& stages);
+	/// record the time to the first solution of the current plan() call (only its first call counts)
+	void firstSolution();
+	/// finish the current plan() call, recording the stages' counters since planStarted()
+	void planFinished(const ContainerBase& stages, bool success);
+
+	/// fill diagnostic status of the plan() calls within the window
+	void fillStatus(diagnostic_msgs::DiagnosticStatus& status, const ContainerBase& stages) const;
+	/// publish diagnostics, limited to the configured rate unless forced (requires ros::init())
+	void publish(const ContainerBase& stages, bool force = false);
+
+	size_t numPlans() const { return plans_.size(); }
+
+private:
+	struct Counts
+	{
+		size_t states = 0;
+		size_t solutions = 0;
+		size_t failures = 0;
+	};
+	struct Plan
+	{
+		Clock::time_point finished;
+		double time_to_first_solution;  // negative if no solution was found
+		bool success;
+		size_t pruned_states;
+		std::vector<std::pair<std::string, Counts>> stages;  // counters created during the plan() call
+	};
+
+	static Counts counts(const Stage& stage);
+	void trim(Clock::time_point now);
+
+	std::string name_;
+	Clock::duration period_;  // minimum time between published messages
+	Clock::duration window_;
+	Clock::time_point created_;
+	Clock::time_point last_published_;
+	ros::Publisher publisher_;
+
+	// current plan() call
+	Clock::time_point plan_start_;
+	double time_to_first_solution_ = -1.0;
+	std::unordered_map<const Stage*, Counts> start_counts_;
+
+	std::deque<Plan> plans_;  // finished plan() calls within window_, oldest first
+};
+MOVEIT_CLASS_FORWARD(PlanningDiagnostics);
+}  // namespace task_constructor
+}  // namespace moveit
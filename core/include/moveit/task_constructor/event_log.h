@@ -0,0 +1,150 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Compact binary log of planning events for offline analysis
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(EventLog);
+
+/** Low-overhead log of planning events, kept in a fixed-size ring buffer
+ *
+ * Recording an event only copies a 32-byte record into the ring, such that logging can stay enabled
+ * during production use. Once the ring is full, the oldest events are overwritten.
+ * Stages and solutions are referred to by their Introspection ids. Without introspection, stages are numbered
+ * in traversal order and solution ids are 0. Stage names are stored alongside the events by write().
+ *
+ * Written logs are decoded offline with read() and print(), e.g. via the decode_event_log tool.
+ */
+class EventLog
+{
+public:
+	enum Type : uint8_t
+	{
+		COMPUTE_BEGIN,  // stage starts compute()
+		COMPUTE_END,  // value: compute time (s)
+		STATE,  // new interface state, id: creating solution, detail: Interface::Direction, depth/value: priority
+		SOLUTION,  // id: solution, value: cost
+		FAILURE,  // id: failure (0 if not stored), value: cost
+		STATUS,  // changed state status (pruning), detail: InterfaceState::Status, depth/value: priority
+	};
+
+	struct Event
+	{
+		uint64_t time;  // nanoseconds since creation or clear() of the log
+		double value;
+		uint32_t stage;  // stage id
+		uint32_t id;
+		uint32_t depth;
+		uint8_t type;  // Type
+		uint8_t detail;
+		uint16_t thread;  // small, per-process id of the recording thread
+	};
+
+	/// content of a written log
+	struct Contents
+	{
+		std::map<uint32_t, std::string> stages;  // stage names by id
+		uint64_t recorded = 0;  // number of recorded events, including overwritten ones
+		std::vector<Event> events;  // oldest first
+	};
+
+	explicit EventLog(size_t capacity = 1 << 16);
+	EventLog(const EventLog&) = delete;
+	EventLog& operator=(const EventLog&) = delete;
+
+	/// maximum number of kept events
+	size_t capacity() const { return capacity_; }
+	/// number of events recorded since creation or clear(), including overwritten ones
+	uint64_t recorded() const { return head_.load(std::memory_order_relaxed); }
+
+	/// record an event, safe to call concurrently
+	void record(Type type, uint32_t stage, uint32_t id = 0, double value = 0.0, uint32_t depth = 0,
+	            uint8_t detail = 0) {
+		const uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+		ring_[index % capacity_] = Event{ now(), value, stage, id, depth, type, detail, threadId() };
+	}
+
+	/// name the stage with given id, used by the decoder
+	void setStageName(uint32_t stage, const std::string& name);
+	/// drop all events
+	void clear();
+
+	/// snapshot of kept events and stage names. Events recorded concurrently might be incomplete.
+	Contents contents() const;
+
+	/// write the log in binary form (native byte order)
+	void write(std::ostream& os) const;
+	/// write the log to path, throws std::runtime_error on failure
+	void write(const std::string& path) const;
+
+	/// decode a binary log, throws std::runtime_error if it is corrupt
+	static Contents read(std::istream& is);
+	/// read the log at path, throws std::runtime_error on failure
+	static Contents read(const std::string& path);
+	/// print decoded events as text, one line per event
+	static void print(std::ostream& os, const Contents& contents);
+
+private:
+	uint64_t now() const {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin_).count();
+	}
+	static uint16_t threadId();
+
+	const size_t capacity_;
+	std::unique_ptr<Event[]> ring_;
+	std::atomic<uint64_t> head_{ 0 };
+	std::chrono::steady_clock::time_point origin_;
+
+	mutable std::mutex mutex_;  // protects stage names
+	std::map<uint32_t, std::string> stage_names_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
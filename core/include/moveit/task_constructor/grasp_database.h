@@ -0,0 +1,121 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Memory-mapped database of precomputed, reachable grasps
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <Eigen/Geometry>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(GraspDatabase);
+
+/** Read-only, memory-mapped database of grasps known to be reachable, typically one file per object type
+ *
+ * Each entry records an object pose (w.r.t. the database's reference frame, e.g. the arm's base link),
+ * a grasp pose relative to the object, and the IK solution found for this combination.
+ * Entries are stored as an implicit KD-tree over the object positions, such that lookup() only visits
+ * entries recorded for nearby object poses without building any index at load time.
+ *
+ * The file comprises (in native byte order): a header, the null-terminated reference frame and joint names,
+ * the entry records in KD-tree order, and the joint positions of all entries.
+ */
+class GraspDatabase
+{
+public:
+	struct Entry
+	{
+		Eigen::Isometry3d object_pose;  // w.r.t. reference frame
+		Eigen::Isometry3d grasp_pose;  // w.r.t. object
+		std::vector<double> joint_positions;  // IK solution, ordered as joint names
+		uint32_t grasp_id = 0;  // identifies the same grasp recorded for different object poses
+		double cost = 0.0;
+	};
+
+	struct Match
+	{
+		size_t index;  // entry index
+		double distance;  // normalized pose distance in [0, 2]
+	};
+
+	/// write entries to path, throws std::runtime_error on failure
+	static void write(const std::string& path, const std::string& reference_frame,
+	                  const std::vector<std::string>& joint_names, std::vector<Entry> entries);
+
+	/// memory-map the file at path, throws std::runtime_error if it cannot be mapped or is corrupt
+	explicit GraspDatabase(const std::string& path);
+	GraspDatabase(const GraspDatabase&) = delete;
+	GraspDatabase& operator=(const GraspDatabase&) = delete;
+	~GraspDatabase();
+
+	/// number of entries
+	size_t size() const;
+	const std::string& referenceFrame() const { return reference_frame_; }
+	const std::vector<std::string>& jointNames() const { return joint_names_; }
+
+	Eigen::Isometry3d objectPose(size_t index) const;
+	Eigen::Isometry3d graspPose(size_t index) const;
+	const double* jointPositions(size_t index) const;
+	uint32_t graspId(size_t index) const;
+	double cost(size_t index) const;
+
+	/** find entries recorded for object poses near the given one (w.r.t. reference frame)
+	 *
+	 * Entries need to be within max_distance (m) and max_angle (rad) of object_pose.
+	 * Only the closest entry per grasp id is returned, sorted by increasing distance.
+	 */
+	std::vector<Match> lookup(const Eigen::Isometry3d& object_pose, double max_distance, double max_angle) const;
+
+private:
+	struct Header;
+	struct EntryRecord;
+
+	const EntryRecord& record(size_t index) const;
+
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	const Header* header_ = nullptr;
+	std::string reference_frame_;
+	std::vector<std::string> joint_names_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
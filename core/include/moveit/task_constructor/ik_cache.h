@@ -0,0 +1,119 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Cache for IK solutions, keyed by group, IK link, quantized target pose, and collision environment
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <Eigen/Geometry>
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace planning_scene {
+MOVEIT_CLASS_FORWARD(PlanningScene);
+}
+namespace moveit {
+namespace core {
+MOVEIT_CLASS_FORWARD(JointModelGroup);
+MOVEIT_CLASS_FORWARD(LinkModel);
+}  // namespace core
+}  // namespace moveit
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(IKCache);
+
+/** Cache of validated IK solutions for recurring target poses
+ *
+ * Target poses are quantized to the given tolerances. Thus, all poses within the same cell share their
+ * solutions. Together with the group and IK link, the key comprises a collision signature of the scene:
+ * world geometry, attached objects, allowed collision matrix, and all joint values outside the group.
+ * Entries are kept in an in-memory LRU cache and optionally persisted to a directory on disk,
+ * such that they survive Task::reset() and processes.
+ * The cache is thread-safe and can be shared by several stages and tasks.
+ */
+class IKCache
+{
+public:
+	using Key = std::size_t;
+	using Solutions = std::vector<std::vector<double>>;
+
+	explicit IKCache(double position_tolerance = 1e-3, double orientation_tolerance = 1e-3, size_t capacity = 1000,
+	                 const std::string& directory = "");
+
+	/// hash of the scene's parts affecting the validity of group configurations
+	static std::size_t collisionSignature(const planning_scene::PlanningScene& scene,
+	                                      const moveit::core::JointModelGroup* jmg);
+
+	/// key for IK of link w.r.t. (planning frame) target pose
+	Key computeKey(const moveit::core::JointModelGroup* jmg, const moveit::core::LinkModel* link,
+	               const Eigen::Isometry3d& target, std::size_t signature) const;
+
+	/// check whether a reached pose matches target within the quantization tolerances
+	bool matches(const Eigen::Isometry3d& reached, const Eigen::Isometry3d& target) const;
+
+	/// fetch cached solutions, returns false if not available
+	bool lookup(Key key, Solutions& solutions);
+	/// store (replace) solutions
+	void store(Key key, const Solutions& solutions);
+
+	/// number of entries kept in memory
+	size_t size() const;
+	/// clear in-memory entries (persisted ones are kept)
+	void clear();
+
+private:
+	using Entry = std::pair<Key, Solutions>;
+
+	void insert(Key key, const Solutions& solutions);
+	std::string path(Key key) const;
+
+	const double position_tolerance_;
+	const double orientation_tolerance_;
+	const size_t capacity_;
+	const std::string directory_;
+
+	mutable std::mutex mutex_;
+	std::list<Entry> entries_;  // most recently used first
+	std::unordered_map<Key, std::list<Entry>::iterator> index_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
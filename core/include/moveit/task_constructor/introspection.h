@@ -42,12 +42,18 @@
 #include <moveit_task_constructor_msgs/TaskDescription.h>
 #include <moveit_task_constructor_msgs/TaskStatistics.h>
 #include <moveit_task_constructor_msgs/Solution.h>
+#include <moveit_task_constructor_msgs/SolutionStream.h>
+#include <moveit_task_constructor_msgs/SolutionHandle.h>
 #include <moveit_task_constructor_msgs/GetSolution.h>
+#include <moveit_task_constructor_msgs/GetSolutions.h>
 
 #define DESCRIPTION_TOPIC "description"
 #define STATISTICS_TOPIC "statistics"
 #define SOLUTION_TOPIC "solution"
+#define SOLUTION_STREAM_TOPIC "solution_stream"
+#define SOLUTION_HANDLE_TOPIC "solution_handle"
 #define GET_SOLUTION_SERVICE "get_solution"
+#define GET_SOLUTIONS_SERVICE "get_solutions"
 
 namespace moveit {
 namespace task_constructor {
@@ -76,11 +82,29 @@ public:
 	fillTaskDescription(moveit_task_constructor_msgs::TaskDescription& msg);
 	/// publish detailed task description
 	void publishTaskDescription();
+	/// only publish descriptions of new stages and stages with changed properties (after an initial full one)
+	void enableIncrementalDescription(bool enable = true);
+	/// also send the YAML form of properties next to their binary encoding (the YAML form is slow for large msgs)
+	void enableHumanReadableProperties(bool enable = true);
 
 	/// fill task state message for publishing the current task state
 	moveit_task_constructor_msgs::TaskStatistics& fillTaskStatistics(moveit_task_constructor_msgs::TaskStatistics& msg);
-	/// publish the current state of task
-	void publishTaskState();
+	/// publish the current state of task, limited to the rate set via setStatisticsRate() unless forced
+	void publishTaskState(bool force = false);
+	/// limit publishing of task state to given rate (Hz), 0 disables rate limiting
+	void setStatisticsRate(double rate);
+	/// only publish statistics of changed stages and only failure ids added since the last message
+	void enableIncrementalStatistics(bool enable = true);
+
+	/** Publish from a dedicated thread, such that planning doesn't wait for serialization and transport
+	 *
+	 * All msgs are still filled by the calling thread, as immutable snapshots of the task and its solutions.
+	 * Only their serialization and transport is left to the publishing thread. Consecutive statistics msgs
+	 * still waiting in the bounded queue are coalesced into one. Configure the other publishing options
+	 * before enabling.
+	 */
+	void enableAsyncPublishing(bool enable = true);
+	bool asyncPublishingEnabled() const;
 
 	/// indicate that this task was reset
 	void reset();
@@ -88,9 +112,43 @@ public:
 	/// register the given solution, assigning a unique ID
 	void registerSolution(const SolutionBase& s);
 
+	/** Release ids of evicted solutions, such that the id registry stays bounded on long-running tasks
+	 *
+	 * Expired ids are still reported in statistics, but cannot be resolved via the get_solution services anymore.
+	 */
+	void enableSolutionExpiry(bool enable = true);
+	/// release the id and cached msg of an evicted solution, if expiry is enabled
+	void expireSolution(const SolutionBase& s);
+	/// drop cached msgs of all solutions, e.g. after Task::replan() updated their scenes
+	void clearSolutionMsgs();
+
 	/// publish the given solution
 	void publishSolution(const SolutionBase& s);
 
+	/** Publish solutions incrementally on SOLUTION_STREAM_TOPIC instead of SOLUTION_TOPIC
+	 *
+	 * Each sub trajectory and start scene is streamed only once. Later solutions refer to them by id,
+	 * and new start scenes are sent as diffs to a previously streamed scene if possible.
+	 * Subscribers joining late need to fetch earlier data via the get_solution service.
+	 */
+	void enableStreaming(bool enable = true);
+	bool streamingEnabled() const;
+	/** fill msg with the given solution, only including sub trajectories and scenes not streamed before
+	 *
+	 * Sub trajectories are listed in msg.sub_trajectory in the order their ids first appear in msg.sub_trajectory_id.
+	 */
+	void fillSolutionStream(moveit_task_constructor_msgs::SolutionStream& msg, const SolutionBase& s);
+
+	/** Additionally pass solutions via a shared-memory ring of given capacity (bytes), 0 disables
+	 *
+	 * Serialized solutions are written into a SolutionRing and only their handle is published on
+	 * SOLUTION_HANDLE_TOPIC. The full solution is published on SOLUTION_TOPIC only if there are subscribers
+	 * (and streaming is disabled).
+	 */
+	void enableSharedMemory(size_t capacity);
+	/// write solution into the shared-memory ring, returns false if disabled or exceeding its capacity
+	bool solutionHandle(const SolutionBase& s, moveit_task_constructor_msgs::SolutionHandle& handle);
+
 	/// publish all top-level solutions of task
 	void publishAllSolutions(bool wait = true);
 
@@ -98,6 +156,10 @@ public:
 	bool getSolution(moveit_task_constructor_msgs::GetSolution::Request& req,
 	                 moveit_task_constructor_msgs::GetSolution::Response& res);
 
+	/// get multiple solutions at once, served from a dedicated thread not blocked by planning
+	bool getSolutions(moveit_task_constructor_msgs::GetSolutions::Request& req,
+	                  moveit_task_constructor_msgs::GetSolutions::Response& res);
+
 	/// retrieve id of given stage
 	uint32_t stageId(const moveit::task_constructor::Stage* const s) const;
 
@@ -105,8 +167,17 @@ public:
 	uint32_t solutionId(const moveit::task_constructor::SolutionBase& s);
 
 private:
+	void fillStageDescription(const Stage& stage, moveit_task_constructor_msgs::StageDescription& desc);
+	/// fill msg with descriptions changed since the last published msg
+	void fillIncrementalTaskDescription(moveit_task_constructor_msgs::TaskDescription& msg);
 	void fillStageStatistics(const Stage& stage, moveit_task_constructor_msgs::StageStatistics& s);
+	/// fill msg with statistics changed since the last published msg
+	void fillIncrementalTaskStatistics(moveit_task_constructor_msgs::TaskStatistics& msg);
 	void fillSolution(moveit_task_constructor_msgs::Solution& msg, const SolutionBase& s);
+	/// retrieve (cached) Solution msg of given solution
+	moveit_task_constructor_msgs::SolutionConstPtr solutionMsg(const SolutionBase& s);
+	/// append s to msg like SolutionBase::appendTo(), but only convert sub trajectories not streamed before
+	void appendToStream(moveit_task_constructor_msgs::SolutionStream& msg, const SolutionBase& s, bool zero_ids);
 	/// retrieve or set id of given stage
 	uint32_t stageId(const moveit::task_constructor::Stage* const s);
 	/// retrieve solution with given id
@@ -0,0 +1,87 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Exclusively leased instances of kinematics solvers for concurrent IK
+*/
+
+#pragma once
+
+#include <moveit/kinematics_base/kinematics_base.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/macros/class_forward.h>
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(KinematicsPool);
+
+/** Pool of kinematics solver instances, leased exclusively for the duration of an IK query
+ *
+ * RobotState::setFromIK() always uses the single solver instance of a JointModelGroup, but most kinematics
+ * plugins (e.g. KDL, TRAC-IK) are not safe to call concurrently. The pool lazily allocates additional solver
+ * instances via the group's solver allocator, as many as there are concurrent queries for the group.
+ * The group's own instance is never handed out, as it might be used via RobotState::setFromIK() anytime.
+ * Instances live as long as the pool, usually owned by a stage.
+ */
+class KinematicsPool
+{
+public:
+	KinematicsPool();
+
+	/** solver instance of group, reserved for the caller until the returned pointer is released
+	 *
+	 * Returns nullptr if the group has no (single) solver or its solver cannot be allocated.
+	 */
+	kinematics::KinematicsBasePtr solver(const moveit::core::JointModelGroup* jmg);
+
+	/** RobotState::setFromIK() for a single pose, using a leased solver instance
+	 *
+	 * tip needs to be a tip frame of the solver or rigidly attached to one.
+	 * Otherwise, or if the group doesn't have a single solver, this resorts to RobotState::setFromIK().
+	 */
+	bool setFromIK(moveit::core::RobotState& state, const moveit::core::JointModelGroup* jmg,
+	               const Eigen::Isometry3d& pose, const std::string& tip, double timeout = 0.0,
+	               const moveit::core::GroupStateValidityCallbackFn& constraint =
+	                   moveit::core::GroupStateValidityCallbackFn(),
+	               const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions());
+
+	/// drop all idle instances (leased ones are dropped on release)
+	void clear();
+
+private:
+	struct Instances;
+	std::shared_ptr<Instances> instances_;  // shared with leases, which might outlive the pool
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -49,6 +49,12 @@ namespace task_constructor {
  *  Throws if there are any duplicate, active joints in the groups */
 moveit::core::JointModelGroup* merge(const std::vector<const moveit::core::JointModelGroup*>& groups);
 
+/** Retrieve the merged JointModelGroup of the given groups, sharing it with other users
+ *
+ *  Merged groups are cached per robot model and set of groups (independent of their order)
+ *  as long as they are in use. Throws like merge(). */
+moveit::core::JointModelGroupPtr mergedGroup(std::vector<const moveit::core::JointModelGroup*> groups);
+
 /** merge all sub trajectories into a single RobotTrajectory for parallel execution
  *
  * As the RobotTrajectory maintains a pointer to the underlying JointModelGroup
@@ -0,0 +1,87 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Hardware performance counters of stage computations (Linux perf_event)
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace moveit {
+namespace task_constructor {
+
+/// values of hardware / kernel counters, accumulated per stage
+struct PerfCounterValues
+{
+	uint64_t cycles = 0;
+	uint64_t instructions = 0;
+	uint64_t cache_misses = 0;
+	uint64_t context_switches = 0;
+
+	PerfCounterValues& operator+=(const PerfCounterValues& other) {
+		cycles += other.cycles;
+		instructions += other.instructions;
+		cache_misses += other.cache_misses;
+		context_switches += other.context_switches;
+		return *this;
+	}
+	PerfCounterValues operator-(const PerfCounterValues& other) const {
+		PerfCounterValues result;
+		result.cycles = cycles - other.cycles;
+		result.instructions = instructions - other.instructions;
+		result.cache_misses = cache_misses - other.cache_misses;
+		result.context_switches = context_switches - other.context_switches;
+		return result;
+	}
+	/// instructions per cycle: low values indicate memory-bound computations
+	double ipc() const { return cycles ? static_cast<double>(instructions) / cycles : 0.0; }
+};
+
+/** Counters of the calling thread, opened on first use and kept for the thread's lifetime
+ *
+ * Counting user-space cycles, instructions, and cache misses requires Linux perf_event support
+ * and sufficient permissions (see /proc/sys/kernel/perf_event_paranoid). Counters that cannot
+ * be opened, e.g. context switches under strict paranoia levels, are reported as zero.
+ */
+class PerfCounters
+{
+public:
+	/// whether the calling thread could open its counters
+	static bool available();
+	/// read current values of the calling thread's counters, returns false if unavailable
+	static bool read(PerfCounterValues& values);
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,149 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Record solver results of a planning run for offline replay
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/task_constructor/solution_cache.h>
+#include <moveit_msgs/PlanningScene.h>
+#include <moveit_task_constructor_msgs/SubTrajectory.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(PlanRecording);
+
+/** Recording of a Task::plan() run, replaying its solver results offline
+ *
+ * While RECORDing, every computation of a propagating stage (e.g. MoveTo, MoveRelative) is stored with
+ * its input, i.e. the stage's properties and start scene (see SolutionCache::computeKey()), its result,
+ * and its duration. Additionally, the scene spawned by the task's first generator is recorded as input scene.
+ *
+ * While REPLAYing, recorded computations return their recorded result instead of invoking the solver.
+ * With mocked timing, the recorded duration is slept instead, reproducing the live timeline.
+ * Without, planning time is dominated by scheduling and container overhead, which can thus be profiled
+ * separately from solver time. Computations without a recorded result (misses) invoke the solver.
+ * In RERUN mode, all computations invoke their solvers, e.g. to compare solver versions on recorded input.
+ * In RESUME mode, recorded computations are replayed without mocked timing, while all others are recorded.
+ * This allows resuming an interrupted plan from a checkpoint (see Task::checkpoint()).
+ *
+ * To replay a task offline, build the same stage tree, replacing its first generator
+ * by a FixedState of scene(), and pass the recording to Task::setPlanRecording().
+ */
+class PlanRecording
+{
+public:
+	enum Mode
+	{
+		RECORD,
+		REPLAY,
+		RERUN,
+		RESUME,
+	};
+
+	/// a recorded computation
+	struct Entry
+	{
+		std::string input;  // serialized input, verified on replay (see SolutionCache::Key)
+		std::string stage;  // name of the computing stage
+		double duration;  // compute time (s)
+		bool success;  // return value of compute()
+		moveit_task_constructor_msgs::SubTrajectory solution;  // trajectory, end scene diff, comment, and cost
+	};
+
+	explicit PlanRecording(Mode mode = RECORD) : mode_(mode) {}
+
+	Mode mode() const { return mode_; }
+	void setMode(Mode mode) { mode_ = mode; }
+	/// whether new computations are recorded
+	bool records() const { return mode_ == RECORD || mode_ == RESUME; }
+	/// whether recorded computations are replayed
+	bool replays() const { return mode_ == REPLAY || mode_ == RESUME; }
+
+	/// sleep for the recorded duration of replayed computations
+	void setMockTiming(bool mock) { mock_timing_ = mock; }
+	bool mockTiming() const { return mock_timing_; }
+
+	/// input scene of the recorded plan
+	const moveit_msgs::PlanningScene& scene() const { return scene_; }
+	void setScene(const moveit_msgs::PlanningScene& scene) {
+		scene_ = scene;
+		has_scene_ = true;
+	}
+	bool hasScene() const { return has_scene_; }
+
+	/// record a computation of stage, yielding solution and end scene (nullptr if none)
+	void record(const SolutionCache::Key& key, const std::string& stage, double duration, bool success,
+	            const planning_scene::PlanningSceneConstPtr& start, const planning_scene::PlanningScenePtr& end,
+	            const SubTrajectory& solution);
+	/** replay a recorded computation, deriving end from start. Returns false if not recorded.
+	 *
+	 * success is set to the recorded return value of compute().
+	 */
+	bool replay(const SolutionCache::Key& key, const planning_scene::PlanningSceneConstPtr& start,
+	            planning_scene::PlanningScenePtr& end, SubTrajectory& solution, bool& success);
+
+	/// number of recorded computations
+	size_t size() const;
+	/// number of computations not found while replaying
+	size_t misses() const;
+	/// accumulated recorded compute time (s) per stage name
+	std::map<std::string, double> solverTime() const;
+	void clear();
+
+	/// write recording to path, throws std::runtime_error on failure
+	void save(const std::string& path) const;
+	/// read recording from path, replacing the current one. Throws std::runtime_error on failure.
+	void load(const std::string& path);
+
+private:
+	Mode mode_;
+	bool mock_timing_ = true;
+	moveit_msgs::PlanningScene scene_;
+	bool has_scene_ = false;
+
+	mutable std::mutex mutex_;
+	std::unordered_map<uint64_t, Entry> entries_;  // by digest of their input
+	size_t misses_ = 0;
+};
+}  // namespace task_constructor
+}  // namespace moveit
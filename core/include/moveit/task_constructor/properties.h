@@ -44,6 +44,7 @@
 #include <set>
 #include <vector>
 #include <functional>
+#include <memory>
 #include <sstream>
 #include <ros/serialization.h>
 
@@ -106,14 +107,24 @@ public:
 
 	/// get current value (or default if not defined)
 	inline const boost::any& value() const { return value_.empty() ? default_ : value_; }
-	inline boost::any& value() { return value_.empty() ? default_ : value_; }
+	inline boost::any& value() {
+		serialized_valid_ = encoded_valid_ = false;  // value might be modified via the reference
+		touch();
+		return value_.empty() ? default_ : value_;
+	}
 	/// get default value
 	const boost::any& defaultValue() const { return default_; }
 
 	/// serialize value using registered functions
 	static std::string serialize(const boost::any& value);
 	static boost::any deserialize(const std::string& type_name, const std::string& wire);
-	std::string serialize() const { return serialize(value()); }
+	/// serialized current value, cached until the value changes
+	const std::string& serialize() const;
+	/// lossless encoding for transmission, e.g. to remote stages (ROS messages are serialized in binary)
+	static std::string encode(const boost::any& value);
+	static boost::any decode(const std::string& type_name, const std::string& wire);
+	/// encoded current value, cached until the value changes
+	const std::string& encode() const;
 
 	/// get description text
 	const std::string& description() const { return description_; }
@@ -125,21 +136,44 @@ public:
 
 	/// return true, if property initialized from given SourceId
 	bool initsFrom(SourceFlags source) const;
-	/// configure initialization from source using an arbitrary function
+	/** configure initialization from source using an arbitrary function
+	 *
+	 * As its dependencies are unknown, the function is evaluated on every PropertyMap::performInitFrom().
+	 */
 	Property& configureInitFrom(SourceFlags source, const InitializerFunction& f);
 	/// configure initialization from source using given other property name
 	Property& configureInitFrom(SourceFlags source, const std::string& name);
 
 private:
+	/// renew the generation of the owning PropertyMap
+	void touch();
+
 	std::string description_;
 	const type_info& type_info_;
 	boost::any default_;
 	boost::any value_;
+	/// cached serialize() result
+	mutable std::string serialized_;
+	mutable bool serialized_valid_ = false;
+	/// cached encode() result
+	mutable std::string encoded_;
+	mutable bool encoded_valid_ = false;
 
 	/// used for external initialization
 	SourceFlags source_flags_ = 0;
 	SourceFlags initialized_from_;
 	InitializerFunction initializer_;
+	/// initializer_ is an arbitrary function (instead of a lookup by name)
+	bool custom_initializer_ = false;
+
+	/// generation of the owning PropertyMap's storage: not copied, as copies are owned by another storage
+	struct Owner
+	{
+		uint64_t* generation = nullptr;
+		Owner() = default;
+		Owner(const Owner& /*unused*/) {}
+		Owner& operator=(const Owner& /*unused*/) { return *this; }
+	} owner_;
 };
 
 class Property::error : public std::runtime_error
@@ -199,7 +233,7 @@ public:
 
 protected:
 	static bool insert(const std::type_index& type_index, const std::string& type_name, SerializeFunction serialize,
-	                   DeserializeFunction deserialize);
+	                   DeserializeFunction deserialize, SerializeFunction encode, DeserializeFunction decode);
 };
 
 /// utility class to register serializer/deserializer functions for a property of type T
@@ -207,7 +241,7 @@ template <typename T>
 class PropertySerializer : protected PropertySerializerBase
 {
 public:
-	PropertySerializer() { insert(typeid(T), typeName<T>(), &serialize, &deserialize); }
+	PropertySerializer() { insert(typeid(T), typeName<T>(), &serialize, &deserialize, &encode, &decode); }
 
 	template <class Q = T>
 	static typename std::enable_if<ros::message_traits::IsMessage<Q>::value, std::string>::type typeName() {
@@ -246,6 +280,47 @@ private:
 	deserialize(const std::string& wire) {
 		return dummyDeserialize(wire);
 	}
+
+	/** Lossless encoding: binary ROS serialization for messages, verbatim strings, stream operators otherwise */
+	template <class Q = T>
+	static typename std::enable_if<ros::message_traits::IsMessage<Q>::value, std::string>::type
+	encode(const boost::any& value) {
+		const T& msg = boost::any_cast<const T&>(value);
+		std::string wire(ros::serialization::serializationLength(msg), '\0');
+		ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&wire[0]), wire.size());
+		ros::serialization::serialize(stream, msg);
+		return wire;
+	}
+	template <class Q = T>
+	static typename std::enable_if<ros::message_traits::IsMessage<Q>::value, boost::any>::type
+	decode(const std::string& wire) {
+		T msg;
+		ros::serialization::IStream stream(reinterpret_cast<uint8_t*>(const_cast<char*>(wire.data())), wire.size());
+		ros::serialization::deserialize(stream, msg);
+		return msg;
+	}
+	template <class Q = T>
+	static typename std::enable_if<std::is_same<Q, std::string>::value, std::string>::type
+	encode(const boost::any& value) {
+		return boost::any_cast<const std::string&>(value);
+	}
+	template <class Q = T>
+	static typename std::enable_if<std::is_same<Q, std::string>::value, boost::any>::type
+	decode(const std::string& wire) {
+		return wire;
+	}
+	template <class Q = T>
+	static typename std::enable_if<!ros::message_traits::IsMessage<Q>::value && !std::is_same<Q, std::string>::value,
+	                               std::string>::type
+	encode(const boost::any& value) {
+		return serialize(value);
+	}
+	template <class Q = T>
+	static typename std::enable_if<!ros::message_traits::IsMessage<Q>::value && !std::is_same<Q, std::string>::value,
+	                               boost::any>::type
+	decode(const std::string& wire) {
+		return deserialize(wire);
+	}
 };
 
 /** PropertyMap is map of (name, Property) pairs.
@@ -255,13 +330,52 @@ private:
  */
 class PropertyMap
 {
-	std::map<std::string, Property> props_;
+	using container_type = std::map<std::string, Property>;
+	struct Storage
+	{
+		container_type props;
+		/// content generation: renewed on each write access, including writes via held Property references
+		uint64_t generation = 0;
+	};
+	/// copy-on-write storage, shared between copies until first write access (nullptr if empty)
+	std::shared_ptr<Storage> props_;
+
+	/// generations involved in the last performInitFrom() call for a source
+	struct InitRecord
+	{
+		Property::SourceFlags source;
+		uint64_t other_generation;
+		uint64_t generation;  // own generation after initialization
+		bool custom;  // custom initializers involved: cannot skip
+	};
+	std::vector<InitRecord> init_records_;
+
+	/// read access to storage
+	const container_type& props() const;
+	/// write access to storage: clone shared storage first, renew generation
+	container_type& mutableProps();
+	/// insert a new property into (already detached) storage
+	container_type::iterator insert(container_type::iterator hint, const std::string& name, Property&& property);
 
 	/// implementation of declare methods
 	Property& declare(const std::string& name, const Property::type_info& type_info, const std::string& description,
 	                  const boost::any& default_value);
 
 public:
+	PropertyMap() = default;
+	PropertyMap(const PropertyMap& other) = default;
+	PropertyMap(PropertyMap&& other) noexcept;
+	PropertyMap& operator=(const PropertyMap& other) = default;
+	PropertyMap& operator=(PropertyMap&& other) noexcept;
+
+	/** generation of this map's content
+	 *
+	 * Generations are unique across all maps and renewed on each non-const access as well as on
+	 * modification of a contained Property. Thus, two maps with identical generation are guaranteed
+	 * to hold identical content (0 if empty).
+	 */
+	uint64_t generation() const { return props_ ? props_->generation : 0; }
+
 	/// declare a property for future use
 	template <typename T>
 	Property& declare(const std::string& name, const std::string& description = "") {
@@ -284,17 +398,21 @@ public:
 	/// check whether given property is declared
 	bool hasProperty(const std::string& name) const;
 
-	/// get the property with given name, throws Property::undeclared for unknown name
+	/** get the property with given name, throws Property::undeclared for unknown name
+	 *
+	 * Non-const access detaches shared storage. Thus, references and iterators obtained
+	 * via non-const methods are only valid until this map is copied.
+	 */
 	Property& property(const std::string& name);
-	const Property& property(const std::string& name) const { return const_cast<PropertyMap*>(this)->property(name); }
+	const Property& property(const std::string& name) const;
 
-	using iterator = std::map<std::string, Property>::iterator;
-	using const_iterator = std::map<std::string, Property>::const_iterator;
+	using iterator = container_type::iterator;
+	using const_iterator = container_type::const_iterator;
 
-	iterator begin() { return props_.begin(); }
-	iterator end() { return props_.end(); }
-	const_iterator begin() const { return props_.begin(); }
-	const_iterator end() const { return props_.end(); }
+	iterator begin() { return mutableProps().begin(); }
+	iterator end() { return mutableProps().end(); }
+	const_iterator begin() const { return props().begin(); }
+	const_iterator end() const { return props().end(); }
 
 	/// allow initialization from given source for listed properties - always using the same name
 	void configureInitFrom(Property::SourceFlags source, const std::set<std::string>& properties = {});
@@ -302,8 +420,9 @@ public:
 	/// set (and, if neccessary, declare) the value of a property
 	template <typename T>
 	void set(const std::string& name, const T& value) {
-		auto it = props_.find(name);
-		if (it == props_.end())  // name is not yet declared
+		auto& props = mutableProps();
+		auto it = props.find(name);
+		if (it == props.end())  // name is not yet declared
 			declare<T>(name, value, "");
 		else
 			it->second.setValue(value);
@@ -339,10 +458,63 @@ public:
 	/// reset all properties to their defaults
 	void reset();
 
-	/// perform initialization of still undefined properties using configured initializers
+	/** perform initialization of still undefined properties using configured initializers
+	 *
+	 * This is skipped if neither this map nor other changed since the last call for the same source
+	 * and all properties initializing from this source only look up other properties by name.
+	 */
 	void performInitFrom(Property::SourceFlags source, const PropertyMap& other);
 };
 
+/** Typed handle to a named property, caching the string-keyed lookup
+ *
+ * Declare a key once (e.g. as a stage member) and use it on hot paths instead of
+ * PropertyMap::get<T>(name): The resolved property is reused as long as the map's
+ * generation is unchanged, i.e. as long as the map isn't modified.
+ */
+template <typename T>
+class PropertyKey
+{
+	std::string name_;
+	/// immutable resolution result, replaced atomically: keys are shared by stages computed concurrently
+	struct Resolved
+	{
+		/// generation of the map the property was resolved in (unique across all maps)
+		uint64_t generation;
+		const Property* property;
+	};
+	mutable std::shared_ptr<const Resolved> resolved_;
+
+public:
+	explicit PropertyKey(std::string name) : name_(std::move(name)) {}
+
+	const std::string& name() const { return name_; }
+
+	/// resolve the key in given map, throws Property::undeclared for unknown name
+	const Property& property(const PropertyMap& map) const {
+		const uint64_t generation = map.generation();
+		std::shared_ptr<const Resolved> resolved = std::atomic_load(&resolved_);
+		if (!resolved || resolved->generation != generation || generation == 0) {
+			resolved = std::make_shared<const Resolved>(Resolved{ generation, &map.property(name_) });
+			std::atomic_store(&resolved_, resolved);
+		}
+		return *resolved->property;
+	}
+
+	/// Get typed value of property. Throws undeclared, undefined, or bad_any_cast.
+	const T& get(const PropertyMap& map) const {
+		const boost::any& value = property(map).value();
+		if (value.empty())
+			throw Property::undefined(name_);
+		return boost::any_cast<const T&>(value);
+	}
+	/// get typed value of property, using fallback if undefined. Throws bad_any_cast on type mismatch.
+	const T& get(const PropertyMap& map, const T& fallback) const {
+		const boost::any& value = property(map).value();
+		return (value.empty()) ? fallback : boost::any_cast<const T&>(value);
+	}
+};
+
 // boost::any needs a specialization to avoid infinite recursion
 template <>
 void PropertyMap::set<boost::any>(const std::string& name, const boost::any& value);
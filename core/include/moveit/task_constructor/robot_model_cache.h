@@ -0,0 +1,70 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Process-wide cache of robot models loaded from the parameter server
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+
+#include <string>
+
+namespace robot_model_loader {
+MOVEIT_CLASS_FORWARD(RobotModelLoader);
+}
+
+namespace moveit {
+namespace task_constructor {
+
+/** Process-wide cache of RobotModelLoaders, used by Task::loadRobotModel()
+ *
+ * Parsing URDF/SRDF and loading kinematics plugins is expensive. Hence, loaders are cached by
+ * parameter name and the hash of the URDF/SRDF content: As long as the robot description is unchanged,
+ * all tasks share the same loader and robot model. If the content changed, a new model is loaded.
+ * Cached loaders are kept alive until they are explicitly invalidated.
+ */
+class RobotModelCache
+{
+public:
+	/// retrieve (or load) the robot model loader for the given parameter, nullptr if loading failed
+	static robot_model_loader::RobotModelLoaderPtr load(const std::string& robot_description = "robot_description");
+
+	/// drop the cached loader of the given parameter, subsequent load() calls will reload the model
+	static void invalidate(const std::string& robot_description = "robot_description");
+	/// drop all cached loaders
+	static void clear();
+};
+}  // namespace task_constructor
+}  // namespace moveit
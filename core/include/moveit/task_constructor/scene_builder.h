@@ -0,0 +1,121 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Build planning scene diffs, sharing collision geometry at object granularity
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit_msgs/CollisionObject.h>
+#include <geometric_shapes/shapes.h>
+#include <Eigen/Geometry>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace planning_scene {
+MOVEIT_CLASS_FORWARD(PlanningScene);
+}
+
+namespace moveit {
+namespace task_constructor {
+
+/** Builder of a planning scene diff, modifying world objects without rebuilding the collision geometry of others
+ *
+ * A diff() shares the world objects of its parent, including their collision geometry, until an object is modified.
+ * Only then, the modified object is copied, while all other objects remain shared. However, adding an object from
+ * a CollisionObject msg constructs new shapes, which are unknown to the collision detector's geometry cache:
+ * stages adding the same objects over and over again thus rebuild their collision geometry for every diff.
+ *
+ * SceneBuilder adds objects with shapes shared via a ShapeCache and moves objects by their pose only,
+ * such that their collision geometry is reused across all diffs.
+ */
+class SceneBuilder
+{
+public:
+	/** Shapes constructed from CollisionObject msgs, keyed by object id
+	 *
+	 * Shapes are reconstructed only if an object's geometry (primitives, meshes, planes) changes.
+	 * The cache is thread-safe and should live as long as the stage using it.
+	 */
+	class ShapeCache
+	{
+	public:
+		/// shapes of the object's primitives, meshes, and planes (in this order)
+		std::vector<shapes::ShapeConstPtr> shapes(const moveit_msgs::CollisionObject& object);
+		void clear();
+		size_t size() const;
+
+	private:
+		struct Entry
+		{
+			std::vector<shape_msgs::SolidPrimitive> primitives;
+			std::vector<shape_msgs::Mesh> meshes;
+			std::vector<shape_msgs::Plane> planes;
+			std::vector<shapes::ShapeConstPtr> shapes;
+		};
+		mutable std::mutex mutex_;
+		std::unordered_map<std::string, Entry> entries_;
+	};
+
+	/// start a new diff of parent, sharing shapes via cache (nullptr: shapes are constructed for every object)
+	SceneBuilder(const planning_scene::PlanningSceneConstPtr& parent, ShapeCache* cache = nullptr);
+
+	const planning_scene::PlanningScenePtr& scene() const { return scene_; }
+
+	/// apply a CollisionObject msg (ADD, APPEND, REMOVE, MOVE), returns false on failure
+	bool processCollisionObject(const moveit_msgs::CollisionObject& object);
+	/// apply a batch of CollisionObject msgs (see coalesce()), returns false if any of them failed
+	bool processCollisionObjects(const std::vector<moveit_msgs::CollisionObject>& objects);
+
+	/** Coalesce a sequence of CollisionObject msgs into an equivalent one with fewer world updates
+	 *
+	 * ADD and REMOVE replace an object entirely: all previous operations on the same object are dropped.
+	 * The result preserves the relative order of the remaining operations.
+	 */
+	static std::vector<moveit_msgs::CollisionObject> coalesce(const std::vector<moveit_msgs::CollisionObject>& objects);
+	/// shift a world object by transform (w.r.t. the planning frame), keeping its shapes
+	void shiftObject(const std::string& id, const Eigen::Isometry3d& transform);
+
+private:
+	bool addObject(const moveit_msgs::CollisionObject& object);
+
+	planning_scene::PlanningScenePtr scene_;
+	ShapeCache* cache_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,230 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Strategies deciding which stages Task::plan() computes next
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+class ContainerBase;
+class Stage;
+class StagePrivate;
+
+MOVEIT_CLASS_FORWARD(Scheduler);
+
+/** Strategy deciding which stages to compute in each planning iteration of Task::plan()
+ *
+ * By default (no scheduler), the task traverses its stage hierarchy in each iteration,
+ * computing all children with pending work in child order.
+ */
+class Scheduler
+{
+public:
+	virtual ~Scheduler() = default;
+
+	/// called once per planning run, after the stage tree rooted at root was initialized
+	virtual void init(ContainerBase& root) = 0;
+	/// perform one planning iteration
+	virtual void compute(ContainerBase& root) = 0;
+	/// whether there is pending work left, defaults to root's canCompute()
+	virtual bool canCompute(const ContainerBase& root);
+};
+
+/// Default policy: recursive traversal of the stage hierarchy, computing all children in turn
+class TraversalScheduler : public Scheduler
+{
+public:
+	void init(ContainerBase& root) override;
+	void compute(ContainerBase& root) override;
+};
+
+/** Global, priority-driven scheduling of stages
+ *
+ * The stage hierarchy is flattened through SerialContainers and Alternatives, which just compute their
+ * children in turn. All other stages, including containers with their own scheduling logic
+ * (Fallbacks, Merger, wrappers), are considered atomic units of work.
+ * In each iteration, the unit with the most promising pending state is computed, i.e. the state
+ * with the best InterfaceState::Priority (deepest partial solution, lowest cost). Ties are resolved
+ * by the unit's mean compute time, preferring cheap work. Units without input states (generators)
+ * rank behind all pending states.
+ * With multi-threaded planning, the best units are computed concurrently, one per thread.
+ */
+class PriorityScheduler : public Scheduler
+{
+public:
+	void init(ContainerBase& root) override;
+	void compute(ContainerBase& root) override;
+
+	/// units of work considered for scheduling
+	const std::vector<StagePrivate*>& units() const { return units_; }
+
+private:
+	std::vector<StagePrivate*> units_;
+};
+
+/** Producer/consumer pipelining of units of work
+ *
+ * Units of work are collected as for PriorityScheduler. With multi-threaded planning, all threads
+ * continuously pick units with pending work, preferring downstream units to drain their input first.
+ * Thus, states spawned by generators are processed while the generators keep producing more states.
+ * A generator is paused (backpressure) while the interface fed by it holds queue_capacity or more states.
+ * An iteration ends when no unit has pending work anymore, or a new solution of the root stage was found.
+ * Pausing happens between compute() calls: a single call still spawns its whole batch.
+ * Without a thread pool, each unit with pending work is computed once per iteration, respecting backpressure.
+ */
+class PipelineScheduler : public Scheduler
+{
+public:
+	explicit PipelineScheduler(size_t queue_capacity = 8) : queue_capacity_(queue_capacity) {}
+
+	void init(ContainerBase& root) override;
+	void compute(ContainerBase& root) override;
+
+	const std::vector<StagePrivate*>& units() const { return units_; }
+	size_t queueCapacity() const { return queue_capacity_; }
+
+private:
+	size_t queue_capacity_;  // states fed downstream before pausing a generator, 0 = unbounded
+	std::vector<StagePrivate*> units_;
+
+	// whether unit has pending work and, if it is a generator, its output queue is not full
+	bool ready(StagePrivate* unit) const;
+};
+
+/** Demand-driven scheduling: compute a unit only if the units consuming its output need more input
+ *
+ * Units of work are collected as for PriorityScheduler. A unit feeding states into the interface of another
+ * unit (its consumer) has no demand while that consumer still has pending work. Such a unit is parked:
+ * it isn't computed and its own pending inputs stay queued until its consumers ran dry.
+ * Units feeding the enclosing containers (e.g. the task's solutions) always have demand.
+ * In each iteration, units are considered from last to first, such that downstream units drain their input
+ * before upstream units produce more. Thus, planning for few solutions doesn't produce (many) states that are
+ * never needed. If all units with pending work are parked (cyclic demand), all of them are computed.
+ * With multi-threaded planning, all units with demand are computed concurrently.
+ */
+class DemandScheduler : public Scheduler
+{
+public:
+	void init(ContainerBase& root) override;
+	void compute(ContainerBase& root) override;
+
+	const std::vector<StagePrivate*>& units() const { return units_; }
+
+private:
+	std::vector<StagePrivate*> units_;
+	// consumers of each unit's output, indexed like units_
+	std::vector<std::vector<StagePrivate*>> consumers_;
+
+	// whether unit has pending work and none of its consumers has
+	bool hasDemand(size_t unit) const;
+};
+
+/** Bandit-driven allocation of compute time across competing branches
+ *
+ * Units of work are collected as for PriorityScheduler and grouped into arms: all units within a branch
+ * of an Alternatives container (the innermost one) form one arm, all other units are arms of their own.
+ * In each iteration, the yield of each arm, i.e. the solutions of its root stage per second of compute,
+ * is drawn from its Gamma posterior (Thompson sampling) and the arm with the highest draw computes its most
+ * promising unit (as ranked by PriorityScheduler). Productive branches thus receive more and more compute time,
+ * while the Gamma(1, prior_time) prior keeps trying arms that received little compute time so far.
+ * With multi-threaded planning, the best arms are computed concurrently, one unit per thread.
+ */
+class BanditScheduler : public Scheduler
+{
+public:
+	struct Arm
+	{
+		const Stage* root;  // stage whose solutions count as yield
+		std::vector<StagePrivate*> units;
+
+		size_t solutions() const;
+		/// accumulated compute time of all units (s)
+		double computeTime() const;
+	};
+
+	explicit BanditScheduler(double prior_time = 0.01, uint32_t seed = std::mt19937::default_seed);
+
+	void init(ContainerBase& root) override;
+	void compute(ContainerBase& root) override;
+
+	const std::vector<Arm>& arms() const { return arms_; }
+
+private:
+	double prior_time_;  // pseudo compute time (s) of the prior, smaller values explore more optimistically
+	std::mt19937 rng_;
+	std::vector<Arm> arms_;
+};
+
+/** Flat execution schedule, compiled once from the stage hierarchy
+ *
+ * Units of work are collected as for PriorityScheduler into a contiguous array, which is computed in order,
+ * just as the default traversal would do. Instead of querying canCompute() of all stages in each iteration,
+ * the runnable flag of each unit is cached and only re-evaluated if states were added, removed, or updated
+ * in its input interfaces, or if the unit itself was computed in between. Units whose readiness doesn't
+ * only depend on their input interfaces (generators, non-transparent containers) are polled as usual.
+ * With multi-threaded planning, all runnable units are computed concurrently.
+ */
+class CompiledScheduler : public Scheduler
+{
+public:
+	struct Unit
+	{
+		StagePrivate* stage;
+		bool polled;  // readiness doesn't (only) depend on the input interfaces
+		bool runnable;  // cached result of stage->canCompute()
+		bool dirty;  // runnable needs to be re-evaluated
+	};
+
+	void init(ContainerBase& root) override;
+	void compute(ContainerBase& root) override;
+	bool canCompute(const ContainerBase& root) override;
+
+	const std::vector<Unit>& units() const { return units_; }
+
+private:
+	std::vector<Unit> units_;
+
+	// update cached runnable flag of unit if needed
+	bool runnable(Unit& unit);
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,123 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Cache for solutions of propagating stages, keyed by their inputs
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit_task_constructor_msgs/SubTrajectory.h>
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace planning_scene {
+MOVEIT_CLASS_FORWARD(PlanningScene);
+}
+
+namespace moveit {
+namespace task_constructor {
+
+class InterfaceState;
+class PropagatingEitherWay;
+class SubTrajectory;
+
+MOVEIT_CLASS_FORWARD(SolutionCache);
+
+/** Cache storing successful solutions of a stage, keyed by the stage's inputs
+ *
+ * The key comprises the start state's robot state, its world objects, and the allowed collision matrix,
+ * together with the stage's type, propagation direction, and properties, and the type and configuration
+ * of the stage's planners (see PropagatingEitherWay::planners()).
+ * Entries are kept in an in-memory LRU cache and optionally persisted to a directory on disk,
+ * such that they survive across tasks and processes.
+ * The cache is thread-safe and can be shared by several stages.
+ */
+class SolutionCache
+{
+public:
+	/** Serialized input of a computation, identified by a digest that is stable across builds and platforms
+	 *
+	 * Entries are found by digest, but only hit if their full input matches as well.
+	 */
+	struct Key
+	{
+		std::string input;
+		uint64_t digest = 0;
+
+		/// 64-bit FNV-1a hash: unlike std::hash, it is stable across standard libraries and platforms
+		static uint64_t digestOf(const std::string& input);
+	};
+
+	/// create cache holding up to capacity entries in memory, persisting to directory (if not empty)
+	explicit SolutionCache(size_t capacity = 1000, const std::string& directory = "");
+
+	/** compute the cache key for a stage's input
+	 *
+	 * Returns false if the stage's properties cannot be serialized, i.e. are unsuitable for caching.
+	 */
+	static bool computeKey(const PropagatingEitherWay& stage, int direction, const InterfaceState& state, Key& key);
+
+	/// restore a cached solution, deriving the end scene from start. Returns false if not available.
+	bool lookup(const Key& key, const planning_scene::PlanningSceneConstPtr& start,
+	            planning_scene::PlanningScenePtr& end, SubTrajectory& solution);
+	/// store a successful solution, yielding end from start
+	void store(const Key& key, const planning_scene::PlanningSceneConstPtr& start,
+	           const planning_scene::PlanningSceneConstPtr& end, const SubTrajectory& solution);
+
+	/// number of entries kept in memory
+	size_t size() const;
+	/// clear in-memory entries (persisted ones are kept)
+	void clear();
+
+private:
+	using Entry = std::pair<Key, moveit_task_constructor_msgs::SubTrajectory>;
+
+	bool find(const Key& key, moveit_task_constructor_msgs::SubTrajectory& msg);
+	void insert(const Key& key, const moveit_task_constructor_msgs::SubTrajectory& msg);
+	std::string path(const Key& key) const;
+
+	const size_t capacity_;
+	const std::string directory_;
+
+	mutable std::mutex mutex_;
+	std::list<Entry> entries_;  // most recently used first
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;  // by digest
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,114 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Compact, memory-mappable binary file of solutions
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit_task_constructor_msgs/Solution.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(SolutionFile);
+
+/** Read-only, memory-mapped library of solutions, e.g. precomputed by Task::saveSolutions()
+ *
+ * The file comprises (in native byte order):
+ * - a cost/comment index with one record per solution
+ * - a table of sub trajectories, referring to ranges of the waypoint arrays
+ * - the waypoint data as structure of arrays: times, positions, velocities, accelerations, and efforts
+ * - a table of deduplicated, ROS-serialized blobs: scenes, joint names, execution infos, comments, etc.
+ *
+ * Opening a file only maps it into memory. Waypoint data is accessed in place via trajectory(),
+ * while solution() reconstructs the full message for execution.
+ */
+class SolutionFile
+{
+public:
+	/// view of a sub trajectory's waypoint arrays within the mapped file, nullptr for missing data
+	struct TrajectoryView
+	{
+		size_t num_waypoints;
+		size_t num_joints;
+		const double* times;  // time from start of this sub trajectory
+		const double* positions;  // num_waypoints x num_joints
+		const double* velocities;
+		const double* accelerations;
+		const double* efforts;
+	};
+
+	/// write solutions to path, throws std::runtime_error on failure
+	static void write(const std::string& path, const std::vector<moveit_task_constructor_msgs::Solution>& solutions);
+
+	/// memory-map the file at path, throws std::runtime_error if it cannot be mapped or is corrupt
+	explicit SolutionFile(const std::string& path);
+	SolutionFile(const SolutionFile&) = delete;
+	SolutionFile& operator=(const SolutionFile&) = delete;
+	~SolutionFile();
+
+	/// number of solutions
+	size_t size() const;
+	double cost(size_t solution) const;
+	std::string comment(size_t solution) const;
+
+	size_t numSubTrajectories(size_t solution) const;
+	TrajectoryView trajectory(size_t solution, size_t sub_trajectory) const;
+
+	/// reconstruct the full solution message, e.g. for Task::execute()
+	moveit_task_constructor_msgs::Solution solution(size_t solution) const;
+
+private:
+	struct Header;
+	struct SolutionRecord;
+	struct SubRecord;
+	struct BlobRecord;
+
+	const SolutionRecord& solutionRecord(size_t solution) const;
+	const SubRecord& subRecord(size_t solution, size_t sub_trajectory) const;
+	template <typename Msg>
+	void readBlob(uint32_t index, Msg& msg) const;
+
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	const Header* header_ = nullptr;
+};
+}  // namespace task_constructor
+}  // namespace moveit
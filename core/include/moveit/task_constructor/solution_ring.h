@@ -0,0 +1,98 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Shared-memory ring of serialized solutions
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit_task_constructor_msgs/Solution.h>
+#include <moveit_task_constructor_msgs/SolutionHandle.h>
+
+#include <cstdint>
+#include <string>
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(SolutionRing);
+
+/** Ring buffer of ROS-serialized Solution messages in POSIX shared memory
+ *
+ * A single writer, e.g. Introspection, appends blobs and passes only their SolutionHandle to consumers
+ * on the same host. Consumers map the segment read-only and deserialize directly from the mapped memory.
+ * Old blobs are overwritten once the ring wraps around; read() detects this and fails instead.
+ */
+class SolutionRing
+{
+public:
+	/// create (or replace) the segment name with given capacity (bytes), throws std::runtime_error on failure
+	static SolutionRingPtr create(const std::string& name, size_t capacity);
+	/// map an existing segment read-only, throws std::runtime_error if it doesn't exist or is corrupt
+	static SolutionRingPtr open(const std::string& name);
+
+	SolutionRing(const SolutionRing&) = delete;
+	SolutionRing& operator=(const SolutionRing&) = delete;
+	~SolutionRing();
+
+	const std::string& name() const { return name_; }
+	size_t capacity() const;
+	/// random id of this ring, see SolutionHandle::instance
+	uint64_t instance() const;
+
+	/// append msg to the ring, returns false if it exceeds the capacity
+	bool write(const moveit_task_constructor_msgs::Solution& msg, moveit_task_constructor_msgs::SolutionHandle& handle);
+	/** deserialize the blob referred to by handle, returns false if it was overwritten meanwhile
+	 *
+	 * Also fails for handles of another ring instance, e.g. after the writer re-created the segment.
+	 * Consumers should open() the segment again in this case.
+	 */
+	bool read(const moveit_task_constructor_msgs::SolutionHandle& handle,
+	          moveit_task_constructor_msgs::Solution& msg) const;
+
+private:
+	struct Header;
+
+	SolutionRing(const std::string& name, bool owner);
+	void map(int fd, size_t size, bool writable);
+
+	std::string name_;
+	bool owner_;  // unlink segment on destruction
+	uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	Header* header_ = nullptr;
+};
+}  // namespace task_constructor
+}  // namespace moveit
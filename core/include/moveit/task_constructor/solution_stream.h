@@ -0,0 +1,85 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Thread-safe queue streaming solutions of a planning task to a consumer
+*/
+
+#pragma once
+
+#include <moveit/task_constructor/storage.h>
+#include <moveit/macros/class_forward.h>
+
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+
+namespace moveit {
+namespace task_constructor {
+
+MOVEIT_CLASS_FORWARD(SolutionStream);
+
+/** Blocking queue of solutions, fed by Task::plan() as soon as new top-level solutions are found
+ *
+ * Solutions are yielded in order of their discovery (not sorted by cost).
+ * The stream is closed when planning finished. Remaining solutions can still be consumed afterwards.
+ * All methods are thread-safe.
+ */
+class SolutionStream
+{
+public:
+	/// append a solution, waking up a waiting consumer (ignored once closed)
+	void push(const SolutionBaseConstPtr& solution);
+	/// mark the end of the stream
+	void close();
+	bool closed() const;
+
+	/** wait (up to timeout seconds) for the next solution
+	 *
+	 * Returns nullptr if the timeout expired or the stream was closed and all solutions were consumed.
+	 */
+	SolutionBaseConstPtr next(double timeout = std::numeric_limits<double>::infinity());
+	/// take the next solution without blocking (nullptr if none is pending)
+	SolutionBaseConstPtr tryNext();
+	/// number of pending solutions
+	size_t size() const;
+
+private:
+	mutable std::mutex mutex_;
+	std::condition_variable cond_;  // signals new solutions or closing
+	std::deque<SolutionBaseConstPtr> queue_;
+	bool closed_ = false;
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -58,6 +58,8 @@ public:
 	void setIKFrame(const std::string& link) { setIKFrame(Eigen::Isometry3d::Identity(), link); }
 
 	void setStepSize(double step_size) { setProperty("step_size", step_size); }
+	/// enable adaptive step sizes between step_size and max_step_size (disabled if max_step_size <= step_size)
+	void setMaxStepSize(double max_step_size) { setProperty("max_step_size", max_step_size); }
 	void setPrecision(const moveit::core::CartesianPrecision& precision) { setProperty("precision", precision); }
 	template <typename T = float>
 	void setJumpThreshold(double) {
@@ -39,6 +39,7 @@
 #pragma once
 
 #include <moveit/task_constructor/solvers/planner_interface.h>
+#include <functional>
 #include <vector>
 
 namespace moveit {
@@ -54,6 +55,11 @@ MOVEIT_CLASS_FORWARD(MultiPlanner);
  * This is (slightly) different from the Fallbacks container, as the MultiPlanner directly applies its planners to each
  * individual planning job. In contrast, the Fallbacks container first runs the active child to exhaustion before
  * switching to the next child, which possibly applies a different planning strategy.
+ *
+ * In racing mode, all planners are launched concurrently instead and the first successful result is returned.
+ * Optionally, further results arriving within a grace period are considered too, choosing the shortest trajectory.
+ * Remaining requests are cancelled cooperatively (see PlannerCancellation) and their results are discarded.
+ * Hence, child planners need to support concurrent use in this mode.
  */
 class MultiPlanner : public PlannerInterface, public std::vector<solvers::PlannerInterfacePtr>
 {
@@ -61,8 +67,17 @@ public:
 	using PlannerList = std::vector<solvers::PlannerInterfacePtr>;
 	using PlannerList::PlannerList;  // inherit all std::vector constructors
 
+	bool appendIdentity(std::string& buffer) const override;
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 
+	/// run all planners concurrently, waiting grace_period (s) after the first success for better (shorter) results
+	void setRacing(bool racing, double grace_period = 0.0) {
+		racing_ = racing;
+		grace_period_ = grace_period;
+	}
+	bool racing() const { return racing_; }
+	double gracePeriod() const { return grace_period_; }
+
 	Result plan(const planning_scene::PlanningSceneConstPtr& from, const planning_scene::PlanningSceneConstPtr& to,
 	            const moveit::core::JointModelGroup* jmg, double timeout, robot_trajectory::RobotTrajectoryPtr& result,
 	            const moveit_msgs::Constraints& path_constraints = moveit_msgs::Constraints()) override;
@@ -71,6 +86,13 @@ public:
 	            const Eigen::Isometry3d& offset, const Eigen::Isometry3d& target,
 	            const moveit::core::JointModelGroup* jmg, double timeout, robot_trajectory::RobotTrajectoryPtr& result,
 	            const moveit_msgs::Constraints& path_constraints = moveit_msgs::Constraints()) override;
+
+private:
+	using Request = std::function<Result(PlannerInterface&, double, robot_trajectory::RobotTrajectoryPtr&)>;
+	Result race(const Request& request, double timeout, robot_trajectory::RobotTrajectoryPtr& result);
+
+	bool racing_ = false;
+	double grace_period_ = 0.0;
 };
 }  // namespace solvers
 }  // namespace task_constructor
@@ -0,0 +1,116 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Library of previously planned paths, reused by PipelinePlanner
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace planning_scene {
+MOVEIT_CLASS_FORWARD(PlanningScene);
+}
+namespace robot_trajectory {
+MOVEIT_CLASS_FORWARD(RobotTrajectory);
+}
+namespace moveit {
+namespace core {
+class JointModelGroup;
+class RobotState;
+}  // namespace core
+}  // namespace moveit
+
+namespace moveit {
+namespace task_constructor {
+namespace solvers {
+
+MOVEIT_CLASS_FORWARD(PathLibrary);
+
+/** Library of successfully planned paths, keyed by the regions of their start and goal states
+ *
+ * A region is a cell of the JointModelGroup's joint space, quantizing joint positions to the given resolution.
+ * Retrieving a path for a new query between the same regions (in either direction) replaces the end points
+ * of the stored path by the actual start and goal states and validates this repaired path densely
+ * in the query's scene. Only the most recent path is kept per pair of regions.
+ * The library is thread-safe, can be shared by several planners, and can be persisted to a file.
+ */
+class PathLibrary
+{
+public:
+	explicit PathLibrary(double resolution = 0.1) : resolution_(resolution) {}
+
+	double resolution() const { return resolution_; }
+
+	/** retrieve a repaired path from from to to, validated in scene with waypoints at most max_step apart
+	 *
+	 * Returns nullptr if there is no stored path between the regions of from and to or if the repaired one is invalid.
+	 * The returned path has no timing.
+	 */
+	robot_trajectory::RobotTrajectoryPtr retrieve(const planning_scene::PlanningSceneConstPtr& scene,
+	                                              const moveit::core::RobotState& from,
+	                                              const moveit::core::RobotState& to,
+	                                              const moveit::core::JointModelGroup* jmg, double max_step = 0.1) const;
+	/// store the path of trajectory, which needs to refer to a JointModelGroup
+	void store(const robot_trajectory::RobotTrajectory& trajectory);
+
+	/// number of stored paths
+	size_t size() const;
+	void clear();
+
+	/// write library to path, throws std::runtime_error on failure
+	void save(const std::string& path) const;
+	/// read library from path, replacing the current one. Throws std::runtime_error on failure.
+	void load(const std::string& path);
+
+private:
+	using Key = std::size_t;
+	Key key(const std::string& group, const std::vector<double>& start, const std::vector<double>& goal) const;
+	void insert(const std::string& group, trajectory_msgs::JointTrajectory&& path);
+
+	const double resolution_;
+	mutable std::mutex mutex_;
+	// joint_names of the stored trajectories are the variable names of their group, points hold positions only
+	std::unordered_map<Key, std::pair<std::string, trajectory_msgs::JointTrajectory>> paths_;
+};
+}  // namespace solvers
+}  // namespace task_constructor
+}  // namespace moveit
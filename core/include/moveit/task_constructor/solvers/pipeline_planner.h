@@ -39,8 +39,15 @@
 #pragma once
 
 #include <moveit/task_constructor/solvers/planner_interface.h>
+#include <moveit/task_constructor/solvers/path_library.h>
 #include <moveit_msgs/MotionPlanRequest.h>
 #include <moveit/macros/class_forward.h>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace planning_pipeline {
 MOVEIT_CLASS_FORWARD(PlanningPipeline);
@@ -72,12 +79,75 @@ public:
 
 	static planning_pipeline::PlanningPipelinePtr create(const Specification& spec);
 
+	/** Pool of PlanningPipeline instances sharing a common specification
+	 *
+	 * A PlanningPipeline doesn't support concurrent planning requests. Hence, each request checks out
+	 * an idle pipeline instance, returning it when done. New instances are created lazily, up to maxSize().
+	 * If all of them are busy, further requests wait until an instance is returned.
+	 */
+	class Pool : public std::enable_shared_from_this<Pool>
+	{
+	public:
+		/// checked-out pipeline, automatically returned to the pool on destruction
+		using Lease = std::unique_ptr<planning_pipeline::PlanningPipeline,
+		                              std::function<void(planning_pipeline::PlanningPipeline*)>>;
+
+		/// pool creating new instances from spec
+		Pool(const Specification& spec);
+		/// pool of fixed size 1, wrapping the given pipeline
+		Pool(const planning_pipeline::PlanningPipelinePtr& pipeline);
+
+		/// check out an idle pipeline instance, waiting if maxSize() instances are busy
+		Lease acquire();
+
+		/// raise the maximum number of instances (never shrinks)
+		void reserve(size_t max_size);
+		size_t maxSize() const;
+		/// number of instances created so far
+		size_t size() const;
+
+		/// configure publishing for all existing and future instances
+		void setPublishing(bool display_motion_plans, bool publish_planning_requests);
+
+		const moveit::core::RobotModelConstPtr& getRobotModel() const { return model_; }
+
+	private:
+		void release(planning_pipeline::PlanningPipeline* pipeline);
+
+		Specification spec_;
+		moveit::core::RobotModelConstPtr model_;
+		bool fixed_ = false;  // don't create new instances?
+
+		mutable std::mutex mutex_;
+		std::condition_variable cv_;
+		std::vector<planning_pipeline::PlanningPipelinePtr> instances_;
+		std::vector<planning_pipeline::PlanningPipeline*> idle_;
+		size_t max_size_ = 1;
+		size_t creating_ = 0;  // instances currently being created (outside the lock)
+		bool display_motion_plans_ = false;
+		bool publish_planning_requests_ = false;
+	};
+	using PoolPtr = std::shared_ptr<Pool>;
+
+	/// retrieve pipeline pool for given spec, shared per robot model and pipeline
+	static PoolPtr createPool(const Specification& spec);
+
 	PipelinePlanner(const std::string& pipeline = "ompl");
 
 	PipelinePlanner(const planning_pipeline::PlanningPipelinePtr& planning_pipeline);
 
 	void setPlannerId(const std::string& planner) { setProperty("planner", planner); }
 
+	/** Reuse paths planned before between the same start and goal regions (see PathLibrary)
+	 *
+	 * Joint-space queries without path constraints first try to repair a path stored in the library,
+	 * invoking the planning pipeline only if that fails. All successfully planned paths are stored.
+	 * nullptr (default) disables experience reuse.
+	 */
+	void setPathLibrary(const PathLibraryPtr& library) { path_library_ = library; }
+	const PathLibraryPtr& pathLibrary() const { return path_library_; }
+
+	bool appendIdentity(std::string& buffer) const override;
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 
 	Result plan(const planning_scene::PlanningSceneConstPtr& from, const planning_scene::PlanningSceneConstPtr& to,
@@ -95,6 +165,8 @@ protected:
 
 	std::string pipeline_name_;
 	planning_pipeline::PlanningPipelinePtr planner_;
+	PoolPtr pool_;
+	PathLibraryPtr path_library_;
 };
 }  // namespace solvers
 }  // namespace task_constructor
@@ -41,8 +41,12 @@
 #include <moveit/macros/class_forward.h>
 #include <moveit_msgs/Constraints.h>
 #include <moveit/task_constructor/properties.h>
+#include <moveit/task_constructor/trace.h>
 #include <Eigen/Geometry>
 
+#include <atomic>
+#include <chrono>
+
 namespace planning_scene {
 MOVEIT_CLASS_FORWARD(PlanningScene);
 }
@@ -92,6 +96,21 @@ public:
 	void setTimeParameterization(const trajectory_processing::TimeParameterizationPtr& tp) {
 		properties_.set("time_parameterization", tp);
 	}
+	/// postpone time parameterization until a solution is published or executed
+	void setDeferTimeParameterization(bool defer) { properties_.set("defer_time_parameterization", defer); }
+
+	/** Apply the time_parameterization property to a planned trajectory
+	 *
+	 * If defer_time_parameterization is enabled, the trajectory is kept path-only
+	 * and only registered for finalizeTimeParameterization().
+	 */
+	void applyTimeParameterization(const robot_trajectory::RobotTrajectoryPtr& trajectory) const;
+
+	/** Append the planner's type and configuration to buffer, identifying its results (see SolutionCache)
+	 *
+	 * Returns false if the configuration cannot be serialized.
+	 */
+	virtual bool appendIdentity(std::string& buffer) const;
 
 	virtual void init(const moveit::core::RobotModelConstPtr& robot_model) = 0;
 
@@ -108,6 +127,77 @@ public:
 	                    robot_trajectory::RobotTrajectoryPtr& result,
 	                    const moveit_msgs::Constraints& path_constraints = moveit_msgs::Constraints()) = 0;
 };
+
+/** Run the deferred time parameterization of a trajectory, if any
+ *
+ * As the path-only trajectory might be read concurrently, it is not modified.
+ * Instead, a time-parameterized copy is returned (nullptr if time parameterization wasn't pending),
+ * which is computed only once: subsequent calls return the same copy.
+ * See SubTrajectory::finalizeTimeParameterization().
+ */
+robot_trajectory::RobotTrajectoryConstPtr
+finalizeTimeParameterization(const robot_trajectory::RobotTrajectory& trajectory);
+
+/// duration of a trajectory: estimated from path length and velocity limits if time parameterization is deferred
+double trajectoryDuration(const robot_trajectory::RobotTrajectory& trajectory);
+
+/** RAII helper accumulating the time spent in planner calls of the current thread
+ *
+ * Planners instantiate it at the beginning of plan(). Nested scopes, e.g. of MultiPlanner, are counted only once.
+ * If tracing is enabled, the call is recorded in the Tracer's timeline as well.
+ */
+class PlannerTimer
+{
+public:
+	PlannerTimer();
+	~PlannerTimer();
+	PlannerTimer(const PlannerTimer&) = delete;
+	PlannerTimer& operator=(const PlannerTimer&) = delete;
+
+	/// accumulated time (s) of all finished planner calls in the current thread
+	static double elapsed();
+
+private:
+	Tracer::Scope trace_;
+};
+
+/** RAII helper installing a cooperative cancellation flag for planner calls of the current thread
+ *
+ * Meta planners, e.g. a racing MultiPlanner, cancel requests whose results are not needed anymore.
+ * Task::preempt() cancels all planner calls of the preempted task.
+ * Optionally, a cancellation also expires at a deadline (see Task::setStageTimeShare()).
+ * Cancellations nest: a request is cancelled if any enclosing flag is set or deadline passed.
+ * Long-running planners may poll cancelled() to abort early and should limit their timeout to remainingTime().
+ */
+class PlannerCancellation
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// install flag (nullptr: none) for the current thread, nested into the current thread's cancellation
+	explicit PlannerCancellation(const std::atomic<bool>* flag, Clock::time_point deadline = Clock::time_point::max());
+	explicit PlannerCancellation(const std::atomic<bool>& flag) : PlannerCancellation(&flag) {}
+	/// forward the cancellation of another thread (which must outlive this one) to the current thread
+	explicit PlannerCancellation(const PlannerCancellation* enclosing);
+	~PlannerCancellation();
+	PlannerCancellation(const PlannerCancellation&) = delete;
+	PlannerCancellation& operator=(const PlannerCancellation&) = delete;
+
+	/// innermost cancellation of the current thread (nullptr if none)
+	static const PlannerCancellation* current();
+	/// was the current thread's planning request cancelled?
+	static bool cancelled();
+	/// is this or any enclosing flag set or deadline passed?
+	bool isCancelled() const;
+	/// time (s) until the earliest deadline of the current thread (infinity if none)
+	static double remainingTime();
+
+private:
+	const std::atomic<bool>* flag_;
+	Clock::time_point deadline_;
+	const PlannerCancellation* enclosing_;
+	const PlannerCancellation* previous_;  // restored on destruction
+};
 }  // namespace solvers
 }  // namespace task_constructor
 }  // namespace moveit
@@ -42,7 +42,13 @@
 #include "trajectory_execution_info.h"
 #include "utils.h"
 #include <moveit/macros/class_forward.h>
+#include <moveit/task_constructor/perf_counters.h>
 #include <moveit/task_constructor/storage.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
 #include <vector>
 #include <list>
 
@@ -87,6 +93,9 @@ enum InterfaceFlag
 
 using InterfaceFlags = utils::Flags<InterfaceFlag>;
 
+/// immutable copy of a stage's solutions, ordered by cost (see Stage::solutionSnapshot())
+using SolutionSnapshot = std::shared_ptr<const std::vector<SolutionBaseConstPtr>>;
+
 /** invert interface such that
  * - new end can connect to old start
  * - new start can connect to old end
@@ -139,7 +148,64 @@ private:
 };
 std::ostream& operator<<(std::ostream& os, const InitStageException& e);
 
+/** Statistics of the durations of a stage's compute() calls
+ *
+ * Besides count, min, max, and mean, durations are collected in a histogram with logarithmic bins:
+ * bin i counts durations in [2^i, 2^(i+1)) microseconds (bin 0 also covers shorter ones), which allows
+ * for estimating quantiles. Additionally, the fraction of time spent within planners is accumulated.
+ */
+class ComputeTimeStatistics
+{
+public:
+	static constexpr std::size_t NUM_BINS = 32;
+	using Histogram = std::array<uint32_t, NUM_BINS>;
+
+	/// record a compute() call of given duration (s), of which planner_time (s) was spent in planners
+	void add(double duration, double planner_time = 0.0);
+	void reset() { *this = ComputeTimeStatistics(); }
+
+	std::size_t count() const { return count_; }
+	double min() const { return count_ ? min_ : 0.0; }
+	double max() const { return max_; }
+	double mean() const { return count_ ? sum_ / count_ : 0.0; }
+	double total() const { return sum_; }
+	double totalPlannerTime() const { return planner_time_; }
+	/// estimate quantile q in [0, 1] of durations from the histogram
+	double quantile(double q) const;
+	const Histogram& histogram() const { return histogram_; }
+
+private:
+	std::size_t count_ = 0;
+	double min_ = std::numeric_limits<double>::infinity();
+	double max_ = 0.0;
+	double sum_ = 0.0;
+	double planner_time_ = 0.0;
+	Histogram histogram_{};
+};
+
+/** Approximate memory (bytes) held by a stage's states and solutions
+ *
+ * Sizes are estimated from robot model dimensions, waypoint counts, and object shapes,
+ * ignoring allocator overhead. Scenes shared by several states of a stage are counted once.
+ */
+struct MemoryUsage
+{
+	std::size_t states = 0;  // InterfaceStates created by the stage
+	std::size_t scenes = 0;  // planning scenes (diffs) of these states
+	std::size_t trajectories = 0;  // robot trajectories of successful solutions
+	std::size_t markers = 0;  // markers of successful solutions
+	std::size_t failures = 0;  // trajectories and markers of stored failures
+
+	std::size_t total() const { return states + scenes + trajectories + markers + failures; }
+};
+
+namespace solvers {
+MOVEIT_CLASS_FORWARD(PlannerInterface);
+}
+
 MOVEIT_CLASS_FORWARD(CostTerm);
+MOVEIT_CLASS_FORWARD(SolutionCache);
+MOVEIT_CLASS_FORWARD(PlanRecording);
 class LambdaCostTerm;
 class ContainerBase;
 class StagePrivate;
@@ -203,6 +269,33 @@ public:
 	/// marker namespace of solution markers
 	const std::string& markerNS() { return properties().get<std::string>("marker_ns"); }
 
+	/** Limit the number of stored solutions, keeping the best ones (0 = unbounded, default)
+	 *
+	 * New solutions not improving on the stored ones are dropped. Stored solutions
+	 * displaced by better ones are evicted to failures(), such that parent containers don't consider them anymore.
+	 */
+	void setMaxStoredSolutions(uint32_t max_solutions) { setProperty("max_stored_solutions", max_solutions); }
+
+	/** Drop solutions whose new state duplicates a state sent before with lower or equal cost
+	 *
+	 * States are equivalent if all joint positions and object poses differ by at most tolerance,
+	 * and if the same collision objects and attached bodies are present. Dropped duplicates are stored
+	 * as failures, such that downstream stages don't process equivalent states several times.
+	 * 0 (default) disables deduplication.
+	 */
+	void setDeduplicationTolerance(double tolerance) { setProperty("deduplication_tolerance", tolerance); }
+
+	/** Drop waypoints of this stage's trajectories when publishing or executing them
+	 *
+	 * Waypoints are dropped if their interpolation from the kept ones deviates by at most joint_tolerance (rad)
+	 * per joint and by at most cartesian_tolerance (m) for the end-effector tips, see compressTrajectory().
+	 * Costs are still computed from the original trajectories. 0 (default) disables the corresponding check.
+	 */
+	void setTrajectoryCompression(double joint_tolerance, double cartesian_tolerance = 0.0) {
+		setProperty("compression_joint_tolerance", joint_tolerance);
+		setProperty("compression_cartesian_tolerance", cartesian_tolerance);
+	}
+
 	/// Set and get info to use when executing the stage's trajectory
 	void setTrajectoryExecutionInfo(TrajectoryExecutionInfo trajectory_execution_info) {
 		setProperty("trajectory_execution_info", trajectory_execution_info);
@@ -236,7 +329,26 @@ public:
 
 	const ordered<SolutionBaseConstPtr>& solutions() const;
 	const std::list<SolutionBaseConstPtr>& failures() const;
+	/** Publish an immutable snapshot of solutions() after each change (default: disabled)
+	 *
+	 * Other threads can read snapshots while planning continues, without locking the planner.
+	 * Each change copies the list of solutions, and snapshots keep their solutions alive.
+	 */
+	void enableSolutionSnapshots(bool enable = true);
+	/// latest snapshot of solutions(), safe to call concurrently to planning (nullptr if disabled)
+	SolutionSnapshot solutionSnapshot() const;
 	size_t numFailures() const;
+	/** number of failures per comment, aggregated while recording them (empty comment for silent failures)
+	 *
+	 * The number of distinct comments is bounded: further ones are counted with an empty comment.
+	 */
+	const std::map<std::string, size_t>& failureCounts() const;
+	/// number of solutions dropped or evicted to respect max_stored_solutions
+	size_t numEvictedSolutions() const;
+	/// number of compute() calls cancelled for exceeding the timeout (see Task::setStageWatchdog())
+	size_t numTimeouts() const;
+	/// hardware counters accumulated over compute() calls since the last reset() (see Task::setHardwareCounters())
+	const PerfCounterValues& hardwareCounters() const;
 	/// Call to increase number of failures w/o storing a (failure) trajectory
 	void silentFailure();
 	/// Should we generate failure solutions? Note: Always report a failure!
@@ -256,6 +368,10 @@ public:
 	[[noreturn]] void reportPropertyError(const Property::error& e);
 
 	double getTotalComputeTime() const;
+	/// statistics of individual compute() calls since the last reset()
+	const ComputeTimeStatistics& computeTimeStatistics() const;
+	/// estimate memory currently held by this stage (excluding children), linear in its number of states and solutions
+	MemoryUsage memoryUsage() const;
 
 protected:
 	/// Stage can only be instantiated through derived classes
@@ -263,6 +379,15 @@ protected:
 	/// Stage cannot be copied
 	Stage(const Stage&) = delete;
 
+	/// number of jobs runConcurrently() processes in parallel (1 for single-threaded planning)
+	size_t concurrency() const;
+	/** Run independent jobs on the task's thread pool and wait for their completion
+	 *
+	 * In single-threaded planning, the jobs are run sequentially in the calling thread.
+	 * Jobs must not access interfaces or solutions of the stage, which is not synchronized.
+	 */
+	void runConcurrently(std::vector<std::function<void()>>&& jobs) const;
+
 protected:
 	StagePrivate* pimpl_;
 };
@@ -301,11 +426,39 @@ public:
 	};
 	void restrictDirection(Direction dir);
 
+	/** Enable caching of solutions for identical inputs (opt-in)
+	 *
+	 * Only suitable for stages computing their solutions via compute(), depending on their properties,
+	 * planners(), and input scene only, e.g. MoveTo or MoveRelative.
+	 */
+	void setSolutionCache(const SolutionCachePtr& cache);
+	/// planners used by compute(), whose configuration is part of the SolutionCache key
+	virtual std::vector<solvers::PlannerInterfaceConstPtr> planners() const { return {}; }
+	/// record or replay computations (nullptr = disabled), usually configured via Task::setPlanRecording()
+	void setPlanRecording(const PlanRecordingPtr& recording);
+
+	/** Maximal number of pending states fetched by a single compute() call (default: 1)
+	 *
+	 * Batches of several states are passed to computeForwardBatch() / computeBackwardBatch().
+	 * As properties initialized from the INTERFACE may differ per state, stages configured
+	 * to do so always compute a single state at a time.
+	 */
+	void setMaxBatchSize(uint32_t n) { setProperty("max_batch_size", n); }
+
 	// Default implementations, using generic compute().
 	// Override if you want to use different code for FORWARD and BACKWARD directions.
 	virtual void computeForward(const InterfaceState& from);
 	virtual void computeBackward(const InterfaceState& to);
 
+	/** Compute a batch of (at least two) pending states, if max_batch_size > 1
+	 *
+	 * Override to amortize setup shared by all states of the batch.
+	 * By default, the states are computed individually via computeForward() / computeBackward(),
+	 * concurrently in multi-threaded planning.
+	 */
+	virtual void computeForwardBatch(const std::vector<const InterfaceState*>& from);
+	virtual void computeBackwardBatch(const std::vector<const InterfaceState*>& to);
+
 protected:
 	// constructor for use in derived classes
 	PropagatingEitherWay(PropagatingEitherWayPrivate* impl);
@@ -338,8 +491,9 @@ public:
 	PropagatingForward(const std::string& name = "propagating forward");
 
 private:
-	// restrict access to backward method to provide compile-time check
+	// restrict access to backward methods to provide compile-time check
 	void computeBackward(const InterfaceState& to) override;
+	void computeBackwardBatch(const std::vector<const InterfaceState*>& to) override;
 	using PropagatingEitherWay::sendBackward;
 };
 
@@ -351,8 +505,9 @@ public:
 	PropagatingBackward(const std::string& name = "propagating backward");
 
 private:
-	// restrict access to forward method to provide compile-time check
+	// restrict access to forward methods to provide compile-time check
 	void computeForward(const InterfaceState& from) override;
+	void computeForwardBatch(const std::vector<const InterfaceState*>& from) override;
 	using PropagatingEitherWay::sendForward;
 };
 
@@ -365,6 +520,11 @@ public:
 
 	virtual bool canCompute() const = 0;
 	virtual void compute() = 0;
+	/** Apply a change of the planning scene to the scene(s) to be spawned (see Task::replan())
+	 *
+	 * The default does nothing, which suits generators observing the scene themselves, e.g. CurrentState.
+	 */
+	virtual void applySceneDiff(const moveit_msgs::PlanningScene& /*diff*/) {}
 	void spawn(InterfaceState&& from, InterfaceState&& to, SubTrajectory&& trajectory);
 	void spawn(InterfaceState&& state, SubTrajectory&& trajectory);
 	void spawn(InterfaceState&& state, double cost) {
@@ -391,7 +551,13 @@ public:
 	PRIVATE_CLASS(MonitoringGenerator)
 	MonitoringGenerator(const std::string& name = "monitoring generator", Stage* monitored = nullptr);
 	void setMonitoredStage(Stage* monitored);
+	/** Buffer monitored solutions and pass them to onNewSolutions() as a group, right before the next compute()
+	 *
+	 * This allows to share setup work among all solutions arriving between two compute() calls.
+	 */
+	void setBatchedMonitoring(bool batched);
 
+	void reset() override;
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 
 protected:
@@ -399,6 +565,8 @@ protected:
 
 	/// called by monitored stage when a new solution was generated
 	virtual void onNewSolution(const SolutionBase& s) = 0;
+	/// called with all buffered solutions in batched mode, calls onNewSolution() for each of them by default
+	virtual void onNewSolutions(const std::vector<const SolutionBase*>& solutions);
 };
 
 class ConnectingPrivate;
@@ -410,8 +578,26 @@ public:
 
 	void reset() override;
 
+	/// number of best pending pairs computed concurrently (requires multi-threaded planning)
+	void setMaxConcurrentPairs(uint32_t n) { setProperty("max_concurrent_pairs", n); }
+	/** Among the n best pending pairs (by priority), compute the one with the closest robot states first
+	 *
+	 * Close states are usually connected quickly. n = 1 (default) strictly follows priority order.
+	 */
+	void setNearestCandidates(uint32_t n) { setProperty("nearest_candidates", n); }
+
 	virtual void compute(const InterfaceState& from, const InterfaceState& to) = 0;
 
+	/** Compute a pair concurrently to other pairs, if max_concurrent_pairs > 1
+	 *
+	 * The returned function finishes the computation (e.g. calling connect()). These functions are called
+	 * sequentially in order of the pairs' priorities, after all concurrent computations of a batch are done.
+	 * The default implementation defers the whole (non thread-safe) compute() to the returned function.
+	 */
+	virtual std::function<void()> computeConcurrently(const InterfaceState& from, const InterfaceState& to) {
+		return [this, &from, &to] { compute(from, to); };
+	}
+
 protected:
 	virtual bool compatible(const InterfaceState& from_state, const InterfaceState& to_state) const;
 
@@ -39,15 +39,27 @@
 #pragma once
 
 #include <moveit/task_constructor/stage.h>
+#include <moveit/task_constructor/arena_p.h>
 #include <moveit/task_constructor/storage.h>
 #include <moveit/task_constructor/cost_terms.h>
 #include <moveit/task_constructor/cost_queue.h>
+#include <moveit/task_constructor/event_log.h>
+#include <moveit/task_constructor/solvers/planner_interface.h>
+#include <moveit/task_constructor/perf_counters.h>
+#include <moveit/task_constructor/trace.h>
+#include <moveit/task_constructor/watchdog.h>
 
 #include <ros/console.h>
 #include <fmt/core.h>
 
 #include <ostream>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // define pimpl() functions accessing correctly casted pimpl_ pointer
 #define PIMPL_FUNCTIONS(Class)                                                                       \
@@ -65,6 +77,51 @@ public:
 };
 
 class ContainerBase;
+class ThreadPool;
+
+/// deadline-driven planning: the task's deadline and the share of the remaining time granted to a stage computation
+struct PlanningDeadline
+{
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point deadline = Clock::time_point::max();
+	double stage_share = 0.0;  // 0: disabled
+
+	/// deadline of a stage computation starting now
+	Clock::time_point stageDeadline() const {
+		if (stage_share <= 0.0 || deadline == Clock::time_point::max())
+			return Clock::time_point::max();
+		const auto now = Clock::now();
+		if (now >= deadline)
+			return deadline;
+		return now + std::chrono::duration_cast<Clock::duration>((deadline - now) * std::min(stage_share, 1.0));
+	}
+};
+
+/** Coalesce priority updates of interface states made by the current thread
+ *
+ * While a scope is active, update() only records the new priority of a state. When the outermost scope
+ * of the thread ends, each recorded state is updated once, reordering its interface and notifying its listeners
+ * only once, even if a compute() call produced many solutions updating the same states (e.g. ComputeIK).
+ * The status of a state is not deferred: deferred updates keep the status of the state valid at their application.
+ */
+class PriorityUpdateScope
+{
+public:
+	/// updates are applied holding mutex (if not nullptr)
+	explicit PriorityUpdateScope(std::recursive_mutex* mutex);
+	~PriorityUpdateScope();
+	PriorityUpdateScope(const PriorityUpdateScope&) = delete;
+	PriorityUpdateScope& operator=(const PriorityUpdateScope&) = delete;
+
+	/// update state's priority (ignoring its status), deferred if a scope is active on this thread
+	static void update(const InterfaceState& state, const InterfaceState::Priority& priority);
+	/// priority of state, including deferred updates
+	static InterfaceState::Priority priority(const InterfaceState& state);
+
+private:
+	std::recursive_mutex* mutex_;
+};
+
 class StagePrivate
 {
 	friend class Stage;
@@ -148,7 +205,73 @@ public:
 	void spawn(InterfaceState&& state, const SolutionBasePtr& solution);
 	void connect(const InterfaceState& from, const InterfaceState& to, const SolutionBasePtr& solution);
 
+	// second half of the above methods, once the solution's cost is known
+	void completeSendForward(const InterfaceState& from, InterfaceState&& to, const SolutionBasePtr& solution);
+	void completeSendBackward(InterfaceState&& from, const InterfaceState& to, const SolutionBasePtr& solution);
+	void completeSpawn(InterfaceState&& from, InterfaceState&& to, const SolutionBasePtr& solution);
+	void completeConnect(const InterfaceState& from, const InterfaceState& to, const SolutionBasePtr& solution);
+
+	/// evaluate costs of solutions created during compute() concurrently (see Task::setConcurrentCosts())
+	void setConcurrentCosts(bool enable) { concurrent_costs_ = enable; }
+	/// compute costs of all pending solutions on the thread pool and complete their sending
+	void evaluatePendingCosts();
+	/// defer cost evaluation of new solutions (if enabled) while in scope, stopping on any exit
+	class DeferCostsScope
+	{
+	public:
+		explicit DeferCostsScope(StagePrivate& stage) : stage_(stage) { stage_.defer_costs_ = stage_.concurrent_costs_; }
+		~DeferCostsScope() { stage_.defer_costs_ = false; }
+		DeferCostsScope(const DeferCostsScope&) = delete;
+		DeferCostsScope& operator=(const DeferCostsScope&) = delete;
+
+	private:
+		StagePrivate& stage_;
+	};
+
 	bool storeSolution(const SolutionBasePtr& solution, const InterfaceState* from, const InterfaceState* to);
+	/// publish a copy of solutions_ for concurrent readers, if snapshots are enabled
+	void publishSnapshot();
+	/// move worst solutions exceeding max_solutions to failures_
+	void evictSolutions(size_t max_solutions);
+	/// move given stored solution to failures_
+	void evictSolution(ordered<SolutionBaseConstPtr>::iterator it, const char* comment);
+	/// mark a stored solution as failure (e.g. due to an infinite deferred cost), pruning the states it connects
+	void rejectSolution(const SolutionBase& solution, const std::string& comment);
+	/// check whether a similar stored solution has lower or equal cost, evicting similar ones of higher cost
+	bool isNearDuplicate(const SolutionBase& solution, const InterfaceState& end);
+	/// check whether an equivalent state with lower or equal cost was sent in dir before (see deduplication_tolerance)
+	bool isDuplicate(const InterfaceState& state, Interface::Direction dir, double cost) const;
+	/// remember a sent state for deduplication
+	void registerSentState(const InterfaceState& state, Interface::Direction dir, double cost);
+	/// store a newly created state in states_, bounding its scene diff depth
+	InterfaceState& storeState(InterfaceState&& state);
+	/// store the state created for a failure solution, dropping its scene for compact failures
+	InterfaceState& storeFailureState(InterfaceState&& state, const SolutionBase& solution) {
+		InterfaceState& stored = storeState(std::move(state));
+		if (compact_failures_ && solution.isFailure())
+			stored.evictScene();
+		return stored;
+	}
+	/// move stored solutions that became invalid to failures_, marking them as failures with given comment
+	template <typename Predicate>
+	size_t invalidateSolutions(const Predicate& invalid, const std::string& comment) {
+		std::vector<SolutionBaseConstPtr> invalidated;
+		solutions_.remove_if([&](const SolutionBaseConstPtr& solution) {
+			if (!invalid(*solution))
+				return false;
+			invalidated.push_back(solution);
+			solution_handles_.erase(solution.get());
+			return true;
+		});
+		if (!invalidated.empty())
+			publishSnapshot();
+		for (const auto& solution : invalidated) {
+			// solutions are kept alive, because interface states still refer to them
+			std::const_pointer_cast<SolutionBase>(solution)->markAsFailure(comment);
+			failures_.push_back(solution);
+		}
+		return invalidated.size();
+	}
 	void newSolution(const SolutionBasePtr& solution);
 	bool storeFailures() const { return introspection_ != nullptr; }
 	void runCompute() {
@@ -156,24 +279,192 @@ public:
 
 		if (preempted())
 			throw PreemptStageException();
+		// allow long-running planner calls to abort on preemption
+		solvers::PlannerCancellation cancellation(preempt_requested_, planning_deadline_ ?
+		                                                                  planning_deadline_->stageDeadline() :
+		                                                                  PlanningDeadline::Clock::time_point::max());
 
+		Tracer::Scope trace("compute", "stage", me());
+		const double planner_start_time = solvers::PlannerTimer::elapsed();
 		auto compute_start_time = std::chrono::steady_clock::now();
-		try {
-			compute();
-		} catch (const Property::error& e) {
-			me()->reportPropertyError(e);
+		// enforce the stage's timeout, if watched (see Task::setStageWatchdog())
+		const double budget = watchdog_ ? timeoutBudget() : 0.0;
+		Watchdog::Scope watch(budget > 0.0 ? watchdog_ : nullptr,
+		                      compute_start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		                                               std::chrono::duration<double>(budget)),
+		                      name());
+		solvers::PlannerCancellation timeout_cancellation(&watch.expired());
+		PerfCounterValues counters_start;
+		const bool count_hardware = hardware_counters_ && PerfCounters::read(counters_start);
+		logEvent(EventLog::COMPUTE_BEGIN);
+		{
+			// apply priority updates caused by new solutions once per state
+			PriorityUpdateScope coalesce_priorities(planning_mutex_);
+			{
+				DeferCostsScope defer_costs(*this);
+				try {
+					compute();
+				} catch (const Property::error& e) {
+					me()->reportPropertyError(e);
+				}
+			}
+			evaluatePendingCosts();
+		}
+		PerfCounterValues counters_stop;
+		if (count_hardware && PerfCounters::read(counters_stop)) {
+			const PerfCounterValues counters = counters_stop - counters_start;
+			hardware_counter_values_ += counters;
+			trace.setCounters(counters);
 		}
 		auto compute_stop_time = std::chrono::steady_clock::now();
-		total_compute_time_ += compute_stop_time - compute_start_time;
+		const std::chrono::duration<double> duration = compute_stop_time - compute_start_time;
+		total_compute_time_ += duration;
+		logEvent(EventLog::COMPUTE_END, 0, duration.count());
+		compute_time_stats_.add(duration.count(), solvers::PlannerTimer::elapsed() - planner_start_time);
+		if (watch.expired())
+			onComputeTimeout(budget);
+	}
+	/// finite timeout of a single compute() call (0 if none), enforced by the watchdog
+	double timeoutBudget() const;
+	/// count a compute() call exceeding its timeout as a failure
+	void onComputeTimeout(double budget);
+	/// watch compute() calls exceeding the stage's timeout (nullptr = disabled)
+	void setWatchdog(Watchdog* watchdog) { watchdog_ = watchdog; }
+	/// number of compute() calls cancelled by the watchdog
+	size_t numTimeouts() const { return num_timeouts_; }
+	/// measure hardware counters of compute() calls (see Task::setHardwareCounters())
+	void setHardwareCounters(bool enable) { hardware_counters_ = enable; }
+	/// record events of this stage into log, using given stage id (nullptr = disabled)
+	void setEventLog(EventLog* log, uint32_t id) {
+		event_log_ = log;
+		event_log_id_ = id;
 	}
+	void logEvent(EventLog::Type type, uint32_t id = 0, double value = 0.0, uint32_t depth = 0,
+	              uint8_t detail = 0) const {
+		if (event_log_)
+			event_log_->record(type, event_log_id_, id, value, depth, detail);
+	}
+	/// log a new interface state sent in given direction, created by solution
+	void logState(const InterfaceState& state, Interface::Direction dir, const SolutionBase& solution);
+	const PerfCounterValues& hardwareCounters() const { return hardware_counter_values_; }
 
 	/** compute cost for solution through configured CostTerm */
 	void computeCost(const InterfaceState& from, const InterfaceState& to, SolutionBase& solution);
+	/** Evaluate deferred (exact) costs of solution and its nested sub solutions (see cost::Deferred)
+	 *
+	 * Solutions with changed costs are re-sorted in their creator's list of solutions.
+	 * Solutions with infinite exact costs (or containing such sub solutions) are rejected as failures.
+	 * Returns true if any cost was changed.
+	 */
+	static bool resolveDeferredCosts(SolutionBase& solution);
 
 	void setPreemptRequestedMember(const std::atomic<bool>* preempt_requested) {
 		preempt_requested_ = preempt_requested;
 	}
 	bool preempted() const { return preempt_requested_ != nullptr && *preempt_requested_; }
+	/// whether the task's planning deadline has passed
+	bool deadlineExceeded() const {
+		return planning_deadline_ && PlanningDeadline::Clock::now() >= planning_deadline_->deadline;
+	}
+	void setPlanningDeadlineMember(const PlanningDeadline* deadline) { planning_deadline_ = deadline; }
+
+	/// while set, reset() only clears per-request data, keeping the structure established by init()
+	void setKeepStructure(bool keep) { keep_structure_ = keep; }
+	bool keepStructure() const { return keep_structure_; }
+
+	/// configure thread pool and mutex used for multi-threaded planning (nullptr for single-threaded planning)
+	void setThreadPool(ThreadPool* pool, std::recursive_mutex* planning_mutex) {
+		thread_pool_ = pool;
+		planning_mutex_ = planning_mutex;
+	}
+	inline ThreadPool* threadPool() const { return thread_pool_; }
+	/// configure a separate pool for solver work, e.g. runConcurrently() (nullptr: use threadPool())
+	void setSolverPool(ThreadPool* pool) { solver_pool_ = pool; }
+	inline ThreadPool* solverPool() const { return solver_pool_ ? solver_pool_ : thread_pool_; }
+
+	/// estimate cost-to-go of states arriving at our interfaces (nullptr = disabled)
+	void setCostToGo(const Interface::CostToGo& cost_to_go) {
+		if (starts_)
+			starts_->setCostToGo(cost_to_go, Interface::FORWARD);
+		if (ends_)
+			ends_->setCostToGo(cost_to_go, Interface::BACKWARD);
+	}
+	/// prune states arriving at our interfaces if they exceed the cost bound (nullptr = disabled)
+	void setCostBound(const std::atomic<double>* bound) {
+		if (starts_)
+			starts_->setCostBound(bound);
+		if (ends_)
+			ends_->setCostBound(bound);
+	}
+	/// limit the number of enabled states of our interfaces (0 = unlimited, see Interface::setBeamWidth())
+	void setBeamWidth(size_t width) {
+		if (starts_)
+			starts_->setBeamWidth(width);
+		if (ends_)
+			ends_->setBeamWidth(width);
+	}
+	/// defer adding states to our interfaces to drainInterfaces() (see Interface::setInboxEnabled())
+	void setInboxEnabled(bool enable) {
+		if (starts_)
+			starts_->setInboxEnabled(enable);
+		if (ends_)
+			ends_->setInboxEnabled(enable);
+	}
+	/// move states pushed to our interfaces' inboxes into the interfaces, returns true if there were any
+	bool drainInterfaces() {
+		size_t drained = 0;
+		if (starts_)
+			drained += starts_->drain();
+		if (ends_)
+			drained += ends_->drain();
+		return drained > 0;
+	}
+	/// limit depth of scene diff chains of created states (0 = unbounded)
+	void setMaxSceneDiffDepth(size_t depth) { max_scene_diff_depth_ = depth; }
+	/// limit number of stored failures (0 = unbounded) and strip their trajectories and scenes if compact
+	void setFailureStorage(size_t max_failures, bool compact) {
+		max_stored_failures_ = max_failures;
+		compact_failures_ = compact;
+	}
+	/// drop near-duplicate solutions within tolerance (0 = disabled), see Task::setSolutionDiversity()
+	void setSolutionDiversity(double tolerance, SolutionDistance distance) {
+		diversity_tolerance_ = tolerance;
+		diversity_distance_ = distance;
+	}
+	/// maximum depth of scene diff chains of states created so far
+	size_t sceneDiffDepth() const { return scene_diff_depth_; }
+	/// number of states created by this stage
+	size_t numStates() const { return states_.size(); }
+	/// states created by this stage
+	const std::list<InterfaceState, ArenaAllocator<InterfaceState>>& states() const { return states_; }
+	/** Release scene of a PRUNED state and the trajectories of its attached sub trajectories
+	 *
+	 * The state and its solutions remain as tombstones, keeping priority, cost, and comment for introspection.
+	 * Returns the estimated number of freed bytes.
+	 */
+	static std::size_t evict(InterfaceState& state);
+
+	/// configure the task's pool used to allocate solutions (nullptr for default allocation)
+	void setSolutionPool(const std::shared_ptr<RecyclingPool>& pool) { solution_pool_ = pool; }
+
+	/// create a new solution, allocated from the solution pool if available
+	template <typename T, typename... Args>
+	std::shared_ptr<T> makeSolution(Args&&... args) const {
+		if (solution_pool_)
+			return std::allocate_shared<T>(PoolAllocator<T>(solution_pool_), std::forward<Args>(args)...);
+		return std::make_shared<T>(std::forward<Args>(args)...);
+	}
+
+	/** Lock the task's planning mutex (if any)
+	 *
+	 * In multi-threaded planning mode, all accesses to interfaces and solution bookkeeping
+	 * need to be serialized. Only the actual planning work of a stage runs concurrently.
+	 * In single-threaded mode, the returned lock is empty.
+	 */
+	inline std::unique_lock<std::recursive_mutex> lockPlanning() const {
+		return planning_mutex_ ? std::unique_lock<std::recursive_mutex>(*planning_mutex_) :
+		                         std::unique_lock<std::recursive_mutex>();
+	}
 
 protected:
 	StagePrivate& operator=(StagePrivate&& other);
@@ -193,14 +484,44 @@ protected:
 
 	// The total compute time
 	std::chrono::duration<double> total_compute_time_;
+	// statistics of individual compute() calls
+	ComputeTimeStatistics compute_time_stats_;
 
 	// functions called for each new solution
 	std::list<Stage::SolutionCallback> solution_cbs_;
 
-	std::list<InterfaceState> states_;  // storage for created states
+	// storage for created states, allocated from an arena that is released in bulk on reset()
+	MonotonicArena states_arena_;
+	std::list<InterfaceState, ArenaAllocator<InterfaceState>> states_;
 	ordered<SolutionBaseConstPtr> solutions_;
+	// positions of stored solutions in solutions_, to update or remove them without searching
+	std::unordered_map<const SolutionBase*, ordered<SolutionBaseConstPtr>::iterator> solution_handles_;
+	bool snapshots_ = false;  // publish snapshot_ after each change of solutions_
+	SolutionSnapshot snapshot_;  // accessed via std::atomic_load/store only
 	std::list<SolutionBaseConstPtr> failures_;
+
+	// states sent to neighboring stages, indexed by their deduplication key
+	struct SentState
+	{
+		const InterfaceState* state;
+		double cost;  // cost of the solution creating the state
+	};
+	std::unordered_multimap<size_t, SentState> sent_states_;
 	std::size_t num_failures_ = 0;  // num of failures if not stored
+	std::map<std::string, std::size_t> failure_counts_;  // num of failures per comment
+	/// maximum number of distinct comments in failure_counts_
+	static constexpr std::size_t MAX_FAILURE_COMMENTS = 64;
+	/// count a failure with given comment
+	void countFailure(const std::string& comment) {
+		++num_failures_;
+		auto it = failure_counts_.find(comment);
+		if (it == failure_counts_.end())
+			it = failure_counts_.emplace(failure_counts_.size() < MAX_FAILURE_COMMENTS ? comment : "", 0).first;
+		++it->second;
+	}
+	std::size_t num_evicted_ = 0;  // num of solutions dropped or evicted due to max_stored_solutions or diversity
+	std::size_t num_timeouts_ = 0;  // num of compute() calls exceeding the timeout
+	PerfCounterValues hardware_counter_values_;  // accumulated over compute() calls
 
 private:
 	// !! items write-accessed only by ContainerBasePrivate to maintain hierarchy !!
@@ -215,6 +536,36 @@ private:
 	Introspection* introspection_;  // task's introspection instance
 
 	const std::atomic<bool>* preempt_requested_;
+	const PlanningDeadline* planning_deadline_;  // task's deadline
+
+	Watchdog* watchdog_ = nullptr;  // task's watchdog enforcing timeouts of compute()
+	bool hardware_counters_ = false;  // measure hardware counters of compute()
+	EventLog* event_log_ = nullptr;  // task's event log
+	uint32_t event_log_id_ = 0;  // id of this stage in event_log_
+	bool concurrent_costs_ = false;  // defer cost evaluation of new solutions to the end of compute()
+	bool defer_costs_ = false;  // compute() is running with concurrent_costs_
+
+	// solution created during compute(), awaiting its cost before being sent
+	struct PendingCost
+	{
+		SolutionBasePtr solution;
+		const InterfaceState* from;
+		const InterfaceState* to;
+		std::function<void()> send;  // complete sending once the cost is known
+	};
+	std::vector<PendingCost> pending_costs_;
+	ThreadPool* thread_pool_;  // task's thread pool for multi-threaded planning
+	ThreadPool* solver_pool_ = nullptr;  // task's thread pool for solver work, if separate
+	std::recursive_mutex* planning_mutex_;  // task's mutex serializing bookkeeping in multi-threaded planning
+	std::shared_ptr<RecyclingPool> solution_pool_;  // task's pool for solution allocation
+
+	size_t max_scene_diff_depth_ = 0;  // flatten scenes of created states beyond this diff depth
+	size_t max_stored_failures_ = 0;  // only count further failures beyond this number (0 = unbounded)
+	bool compact_failures_ = false;  // store failures without trajectories and end scenes
+	double diversity_tolerance_ = 0.0;  // drop near-duplicate solutions (0 = disabled)
+	SolutionDistance diversity_distance_ = SolutionDistance::END_STATE;
+	size_t scene_diff_depth_ = 0;  // maximum diff depth of created states' scenes
+	bool keep_structure_ = false;  // soft reset: keep interfaces, push connections, and initialized properties
 };
 PIMPL_FUNCTIONS(Stage)
 std::ostream& operator<<(std::ostream& os, const StagePrivate& stage);
@@ -259,6 +610,8 @@ class PropagatingEitherWayPrivate : public ComputeBasePrivate
 public:
 	PropagatingEitherWay::Direction configured_dir_;
 	InterfaceFlags required_interface_;
+	SolutionCachePtr solution_cache_;  // optional cache of solutions for identical inputs
+	PlanRecordingPtr plan_recording_;  // optional recording of computations for offline replay
 
 	inline PropagatingEitherWayPrivate(PropagatingEitherWay* me, PropagatingEitherWay::Direction configured_dir_,
 	                                   const std::string& name);
@@ -277,6 +630,9 @@ public:
 
 	bool hasEndState() const;
 	const InterfaceState& fetchEndState();
+
+	// number of pending states to fetch per compute(), considering max_batch_size
+	size_t batchSize() const;
 };
 PIMPL_FUNCTIONS(PropagatingEitherWay)
 
@@ -313,11 +669,18 @@ public:
 	Stage* monitored_;
 	Stage::SolutionCallbackList::const_iterator cb_;
 	bool registered_;
+	bool batched_ = false;
+	std::vector<const SolutionBase*> buffered_;  // monitored solutions awaiting onNewSolutions() in batched mode
 
 	inline MonitoringGeneratorPrivate(MonitoringGenerator* me, const std::string& name);
 
+	bool canCompute() const override;
+	void compute() override;
+
 private:
 	void solutionCB(const SolutionBase& s);
+	// pass buffered solutions to onNewSolutions(), returns true if there were any
+	bool flush();
 };
 PIMPL_FUNCTIONS(MonitoringGenerator)
 
@@ -340,6 +703,7 @@ public:
 	struct StatePair : std::pair<Interface::const_iterator, Interface::const_iterator>
 	{
 		using std::pair<Interface::const_iterator, Interface::const_iterator>::pair;  // inherit base constructors
+		bool enabled() const { return first->priority().enabled() && second->priority().enabled(); }
 		bool operator<(const StatePair& rhs) const {
 			return less(first->priority(), second->priority(), rhs.first->priority(), rhs.second->priority());
 		}
@@ -369,6 +733,13 @@ public:
 
 	PendingPairsPrinter pendingPairsPrinter() const { return PendingPairsPrinter(this); }
 
+	/// add an explicit pending pair, parking it while one of its states is disabled
+	void addPendingPair(const StatePair& pair);
+	/// park listed pairs of disabled states and restore parked pairs of (re-)enabled states
+	void updatePendingPairs();
+	/// connect a pair of known states again, e.g. after Task::replan() invalidated their solution
+	void retryPair(const InterfaceState& from, const InterfaceState& to);
+
 private:
 	// Create a pair of Interface states for pending list, such that the order (start, end) is maintained
 	template <Interface::Direction other>
@@ -378,8 +749,63 @@ private:
 	template <Interface::Direction other>
 	void newState(Interface::iterator it, Interface::UpdateFlags updated);
 
-	// ordered list of pending state pairs
-	ordered<StatePair> pending;
+	enum PairStatus : uint8_t
+	{
+		UNKNOWN,  // compatibility not yet checked
+		INCOMPATIBLE,
+		PENDING,  // compatible, but not yet computed
+		DONE,
+	};
+	// register a new state of starts_ (dir = BACKWARD) or ends_ (dir = FORWARD)
+	template <Interface::Direction dir>
+	void addState(Interface::const_iterator it);
+	// status of a pair of known (start, end) states, checking compatibility on first access
+	PairStatus pairStatus(size_t start, size_t end) const;
+	PairStatus pairStatus(const StatePair& pair) const;
+	void setPairStatus(size_t start, size_t end, PairStatus status) const;
+	void setPairStatus(const StatePair& pair, PairStatus status) {
+		setPairStatus(state_ids_.at(&*pair.first), state_ids_.at(&*pair.second), status);
+	}
+	// check if pred holds for any state forming a pending pair with state (located at opposite<dir>() end of pairs)
+	template <Interface::Direction dir, typename Predicate>
+	bool anyPendingOpposite(const InterfaceState& state, Predicate pred) const;
+	// find the best pending pair of enabled states, listed indicates whether it was found in the pending list
+	// With candidates > 1, the pair with the closest robot states among the best candidates is chosen.
+	bool bestPendingPair(StatePair& best, bool& listed, size_t candidates = 1) const;
+	// call visit(pair) for pending pairs of enabled states of the interfaces in order of priority, while it returns true
+	template <typename Visitor>
+	void visitPendingPairs(Visitor visit) const;
+	// add the pairs of start, beginning with end (or only this pair if single), to frontier_
+	void pushPairs(Interface::const_iterator start, Interface::const_iterator end, bool single) const;
+
+	// hash of a state's collision objects and attached bodies (ignoring their poses), cached for known states
+	size_t sceneSignature(const InterfaceState& state) const;
+
+	// Pending pairs are enumerated lazily from both (priority-sorted) interfaces, only keeping their status.
+	std::unordered_map<const InterfaceState*, size_t> state_ids_;  // index of states in start_states_ / end_states_
+	std::vector<Interface::const_iterator> start_states_;
+	std::vector<Interface::const_iterator> end_states_;
+	mutable std::vector<std::vector<PairStatus>> pair_status_;  // indexed by start and end id
+	mutable std::vector<size_t> open_pairs_;  // number of UNKNOWN or PENDING pairs per start id
+
+	// Best-first enumeration of pairs, kept across calls of visitPendingPairs() to skip finished pairs only once.
+	// It holds a cursor per start, walking through the ends. Rebuilt when the interfaces changed otherwise than
+	// by new start states, as the cursors rely on the order of states.
+	struct PairCursor
+	{
+		InterfaceState::Priority prio;
+		Interface::const_iterator start;
+		Interface::const_iterator end;
+		bool single;  // don't advance to subsequent ends
+	};
+	mutable std::vector<PairCursor> frontier_;  // heap, best cursor on top
+	mutable std::pair<size_t, size_t> frontier_changes_{ SIZE_MAX, SIZE_MAX };  // changes of starts_ / ends_ covered
+	std::unordered_map<const InterfaceState*, size_t> scene_signatures_;
+
+	// ordered list of explicitly added pending pairs, whose states are not part of our interfaces
+	// Only pairs of enabled states are kept here, others are parked until both their states become enabled again.
+	ordered<StatePair, ValueOrPointeeLess<StatePair>, ordered_backend::indexed> pending;
+	std::vector<StatePair> parked_;
 };
 PIMPL_FUNCTIONS(Connecting)
 
@@ -45,9 +45,11 @@
 #include "stages/fixed_cartesian_poses.h"
 #include "stages/fixed_state.h"
 #include "stages/generate_grasp_pose.h"
+#include "stages/generate_grasp_pose_from_database.h"
 #include "stages/generate_place_pose.h"
 #include "stages/generate_pose.h"
 #include "stages/modify_planning_scene.h"
 #include "stages/move_relative.h"
 #include "stages/move_to.h"
 #include "stages/predicate_filter.h"
+#include "stages/remote_stage.h"
@@ -38,18 +38,26 @@
 
 #include <moveit/task_constructor/container.h>
 #include <moveit/task_constructor/cost_queue.h>
+#include <moveit/task_constructor/ik_cache.h>
 #include <geometry_msgs/PoseStamped.h>
+#include <moveit_msgs/Constraints.h>
+#include <moveit_msgs/RobotState.h>
 #include <Eigen/Geometry>
+#include <deque>
+#include <vector>
 
 namespace moveit {
 namespace core {
 MOVEIT_CLASS_FORWARD(RobotState);
 MOVEIT_CLASS_FORWARD(JointModelGroup);
+MOVEIT_CLASS_FORWARD(LinkModel);
 }  // namespace core
 }  // namespace moveit
 
 namespace moveit {
 namespace task_constructor {
+MOVEIT_CLASS_FORWARD(KinematicsPool);
+
 namespace stages {
 
 /** Wrapper for any pose generator stage to compute IK poses for a Cartesian pose.
@@ -110,8 +118,74 @@ public:
 	void setIgnoreCollisions(bool flag) { setProperty("ignore_collisions", flag); }
 	void setMinSolutionDistance(double distance) { setProperty("min_solution_distance", distance); }
 
+	/** spread the seeds of multi-solution IK over the group's joint space
+	 *
+	 * Instead of plain random restarts, which often converge to already found solutions again,
+	 * seeds are stratified over the range of each joint (Latin hypercube sampling).
+	 * In multi-threaded planning, the seeds are searched concurrently, each thread using its own IK solver instance.
+	 */
+	void setDiverseSeeds(bool flag) { setProperty("diverse_seeds", flag); }
+
+	/** keep the IK solutions of the last n solved targets (0 disables caching)
+	 *
+	 * IK searches of subsequent targets are seeded with the cached solutions of the nearest targets first,
+	 * which speeds up IK for similar targets, e.g. grasp poses rotated about the object.
+	 */
+	void setSeedCacheSize(uint32_t n) { setProperty("seed_cache_size", n); }
+
+	/** process up to n upstream solutions per compute() call
+	 *
+	 * Within a batch, eef, group, and ik frame are only resolved once (as long as they don't change)
+	 * and the IK searches run concurrently in multi-threaded planning, each thread using its own IK solver instance.
+	 */
+	void setMaxBatchSize(uint32_t n) { setProperty("max_batch_size", n); }
+
+	/** use a cache of validated IK solutions for recurring targets (nullptr disables caching)
+	 *
+	 * Cached solutions of a matching target are validated again and reported without calling the IK solver
+	 * if they provide enough solutions. The cache is kept across reset(), and can be shared by several stages.
+	 */
+	void setIKCache(const IKCachePtr& cache) { ik_cache_ = cache; }
+	const IKCachePtr& ikCache() const { return ik_cache_; }
+
 protected:
 	ordered<const SolutionBase*> upstream_solutions_;
+
+	// previously found IK solution, used to seed IK of nearby targets
+	struct IKSeed
+	{
+		const moveit::core::JointModelGroup* jmg;
+		const moveit::core::LinkModel* link;
+		Eigen::Isometry3d target_pose;  // pose of link
+		std::vector<double> joint_positions;
+	};
+	std::deque<IKSeed> seed_cache_;
+
+	// links placed at the target pose for the early end-effector collision check, cached for the last IK link
+	struct EEFCollisionBundle
+	{
+		const moveit::core::LinkModel* link = nullptr;  // IK link
+		const moveit::core::LinkModel* parent = nullptr;  // rigidly connected parent of link, placed at target pose
+		std::vector<const moveit::core::LinkModel*> links;  // links moving along with parent
+		std::vector<std::string> disabled_links;  // (not placed) parent links excluded from collision checking
+	};
+	EEFCollisionBundle eef_bundle_;
+
+	IKCachePtr ik_cache_;  // optional cache of solutions for recurring targets, not cleared on reset()
+	KinematicsPoolPtr kinematics_pool_;  // solver instances of concurrent IK searches, kept across reset()
+	const EEFCollisionBundle& eefCollisionBundle(const moveit::core::LinkModel* link);
+
+	// typed handles of properties accessed in compute()
+	const PropertyKey<bool> ignore_collisions_{ "ignore_collisions" };
+	const PropertyKey<geometry_msgs::PoseStamped> target_pose_{ "target_pose" };
+	const PropertyKey<std::string> default_pose_{ "default_pose" };
+	const PropertyKey<double> min_solution_distance_{ "min_solution_distance" };
+	const PropertyKey<moveit_msgs::Constraints> constraints_{ "constraints" };
+	const PropertyKey<uint32_t> max_ik_solutions_{ "max_ik_solutions" };
+	const PropertyKey<uint32_t> max_batch_size_{ "max_batch_size" };
+	const PropertyKey<uint32_t> seed_cache_size_{ "seed_cache_size" };
+	const PropertyKey<bool> diverse_seeds_{ "diverse_seeds" };
+	const PropertyKey<moveit_msgs::RobotState> ik_seed_{ "ik_seed" };
 };
 }  // namespace stages
 }  // namespace task_constructor
@@ -60,6 +60,10 @@ namespace stages {
  * specified order. Each planner only plan for joints within the corresponding planning group.
  * Finally, an attempt is made to merge the sub trajectories of individual planning results.
  * If this fails, the sequential planning result is returned.
+ *
+ * If the groups are disjoint and plan_groups_concurrently is enabled, all group segments are planned
+ * concurrently from the start state (on the task's thread pool) and assembled sequentially afterwards.
+ * Segments that turn out invalid from their intermediate start state are replanned sequentially.
  */
 class Connect : public Connecting
 {
@@ -80,10 +84,14 @@ public:
 	void setPathConstraints(moveit_msgs::Constraints path_constraints) {
 		setProperty("path_constraints", std::move(path_constraints));
 	}
+	/// plan the segments of disjoint groups concurrently (planners shared between groups need to be thread-safe)
+	void setPlanGroupsConcurrently(bool enable) { setProperty("plan_groups_concurrently", enable); }
 
 	void reset() override;
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 	void compute(const InterfaceState& from, const InterfaceState& to) override;
+	/// plan concurrently, but serialize storage of the solution (planners need to be thread-safe)
+	std::function<void()> computeConcurrently(const InterfaceState& from, const InterfaceState& to) override;
 
 protected:
 	SolutionSequencePtr makeSequential(const std::vector<robot_trajectory::RobotTrajectoryConstPtr>& sub_trajectories,
@@ -92,12 +100,21 @@ protected:
 	SubTrajectoryPtr merge(const std::vector<robot_trajectory::RobotTrajectoryConstPtr>& sub_trajectories,
 	                       const std::vector<planning_scene::PlanningSceneConstPtr>& intermediate_scenes,
 	                       const moveit::core::RobotState& state);
+	/// plan all group segments from the start state concurrently, returning their trajectories (null on failure)
+	std::vector<robot_trajectory::RobotTrajectoryPtr> planGroupsConcurrently(const InterfaceState& from,
+	                                                                        const InterfaceState& to);
 
 protected:
 	GroupPlannerVector planner_;
 	moveit::core::JointModelGroupPtr merged_jmg_;
 	std::list<SubTrajectory> subsolutions_;
 	std::list<InterfaceState> states_;
+
+	// typed handles of properties accessed in compute()
+	const PropertyKey<MergeMode> merge_mode_{ "merge_mode" };
+	const PropertyKey<double> max_distance_{ "max_distance" };
+	const PropertyKey<moveit_msgs::Constraints> path_constraints_{ "path_constraints" };
+	const PropertyKey<bool> plan_groups_concurrently_{ "plan_groups_concurrently" };
 };
 }  // namespace stages
 }  // namespace task_constructor
@@ -40,17 +40,35 @@
 #pragma once
 
 #include <moveit/task_constructor/stage.h>
+#include <moveit/macros/class_forward.h>
+
+namespace planning_scene_monitor {
+MOVEIT_CLASS_FORWARD(PlanningSceneMonitor);
+}
 
 namespace moveit {
 namespace task_constructor {
 namespace stages {
 
-/** Fetch the current PlanningScene state via get_planning_scene service */
+/** Fetch the current PlanningScene state via get_planning_scene service
+ *
+ * If a PlanningSceneMonitor is provided, the scene is copied from the monitor instead,
+ * avoiding the service round trip on every plan.
+ */
 class CurrentState : public Generator
 {
 public:
 	CurrentState(const std::string& name = "current state");
 
+	/** Copy the scene from the given (running) monitor instead of calling get_planning_scene
+	 *
+	 * The monitor can be shared by many tasks. The scene is copied under the monitor's read lock,
+	 * yielding a consistent snapshot. The monitor needs to use the task's robot model.
+	 */
+	void setPlanningSceneMonitor(const planning_scene_monitor::PlanningSceneMonitorPtr& monitor) {
+		monitor_ = monitor;
+	}
+
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 	bool canCompute() const override;
 	void compute() override;
@@ -58,6 +76,7 @@ public:
 protected:
 	moveit::core::RobotModelConstPtr robot_model_;
 	planning_scene::PlanningScenePtr scene_;
+	planning_scene_monitor::PlanningSceneMonitorPtr monitor_;  // nullptr: use get_planning_scene service
 };
 }  // namespace stages
 }  // namespace task_constructor
@@ -40,6 +40,7 @@
 
 #include <moveit/task_constructor/storage.h>
 #include <moveit/task_constructor/stage.h>
+#include <moveit/task_constructor/scene_builder.h>
 #include <geometry_msgs/Vector3.h>
 #include <moveit/collision_detection/collision_common.h>
 
@@ -57,9 +58,16 @@ public:
 
 	void setDirection(const geometry_msgs::Vector3& dir) { setProperty("direction", dir); }
 	void setMaxPenetration(double penetration) { setProperty("max_penetration", penetration); }
+	/** Correct all colliding objects based on a single collision query, verifying the result once
+	 *
+	 * By default, collisions are fixed iteratively, checking the whole scene again after each round of corrections.
+	 * Scenes with many slightly penetrating objects require fewer collision checks in single-pass mode, but
+	 * objects pushed into other objects are not corrected again.
+	 */
+	void setSinglePass(bool single_pass) { setProperty("single_pass", single_pass); }
 
 private:
-	SubTrajectory fixCollisions(planning_scene::PlanningScene& scene) const;
+	SubTrajectory fixCollisions(SceneBuilder& builder) const;
 };
 }  // namespace stages
 }  // namespace task_constructor
@@ -52,6 +52,7 @@ public:
 	void setState(const planning_scene::PlanningScenePtr& scene);
 
 	void setIgnoreCollisions(bool ignore) { setProperty("ignore_collisions", ignore); }
+	void applySceneDiff(const moveit_msgs::PlanningScene& diff) override;
 
 	void reset() override;
 	bool canCompute() const override;
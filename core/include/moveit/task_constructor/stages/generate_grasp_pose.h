@@ -39,6 +39,8 @@
 #pragma once
 
 #include <moveit/task_constructor/stages/generate_pose.h>
+#include <Eigen/Geometry>
+#include <functional>
 
 namespace moveit {
 namespace task_constructor {
@@ -47,6 +49,9 @@ namespace stages {
 class GenerateGraspPose : public GeneratePose
 {
 public:
+	/// predicate to accept a grasp candidate, given as pose of the grasp frame w.r.t. the planning frame
+	using CandidateFilter = std::function<bool(const planning_scene::PlanningScene&, const Eigen::Isometry3d&)>;
+
 	GenerateGraspPose(const std::string& name = "generate grasp pose");
 
 	void init(const core::RobotModelConstPtr& robot_model) override;
@@ -57,6 +62,17 @@ public:
 	void setAngleDelta(double delta) { setProperty("angle_delta", delta); }
 	void setRotationAxis(const Eigen::Vector3d& axis) { setProperty("rotation_axis", axis); }
 
+	/// reject objects farther than max_reach away from the base of the end-effector's parent group
+	void setMaxReach(double max_reach) { setProperty("max_reach", max_reach); }
+	/** pre-filter grasp candidates before any InterfaceState is spawned
+	 *
+	 * Rejected candidates are only counted as failures, such that downstream stages (e.g. ComputeIK)
+	 * don't waste time on them.
+	 */
+	void setCandidateFilter(const CandidateFilter& filter) { setProperty("candidate_filter", filter); }
+	/// disable generation of markers for (many) grasp candidates
+	void setGenerateMarkers(bool flag) { setProperty("generate_markers", flag); }
+
 	void setPreGraspPose(const std::string& pregrasp) { properties().set("pregrasp", pregrasp); }
 	void setPreGraspPose(const moveit_msgs::RobotState& pregrasp) { properties().set("pregrasp", pregrasp); }
 	void setGraspPose(const std::string& grasp) { properties().set("grasp", grasp); }
@@ -64,6 +80,10 @@ public:
 
 protected:
 	void onNewSolution(const SolutionBase& s) override;
+	void onNewSolutions(const std::vector<const SolutionBase*>& solutions) override;
+
+	/// pop next upstream solution and return its scene with the pregrasp posture applied (nullptr on failure)
+	planning_scene::PlanningScenePtr nextPreGraspScene();
 };
 }  // namespace stages
 }  // namespace task_constructor
@@ -0,0 +1,78 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:    Generator Stage for precomputed grasp poses from a grasp database
+*/
+
+#pragma once
+
+#include <moveit/task_constructor/stages/generate_grasp_pose.h>
+#include <moveit/task_constructor/grasp_database.h>
+
+namespace moveit {
+namespace task_constructor {
+namespace stages {
+
+/** Spawn grasps from a GraspDatabase that are known to be reachable for the current object pose
+ *
+ * Instead of sampling grasps about an axis, database entries recorded for object poses close to the current one
+ * (w.r.t. the database's reference frame) are looked up. Each spawned state provides the grasp as "target_pose"
+ * and the recorded IK solution as "ik_seed", which ComputeIK tries before any other seed.
+ * The sampling properties inherited from GenerateGraspPose (angle_delta, rotation_axis) are unused.
+ */
+class GenerateGraspPoseFromDatabase : public GenerateGraspPose
+{
+public:
+	GenerateGraspPoseFromDatabase(const std::string& name = "generate grasp pose from database");
+
+	void init(const core::RobotModelConstPtr& robot_model) override;
+	void compute() override;
+
+	/// path of the grasp database file for the object's type
+	void setDatabase(const std::string& path) { setProperty("database", path); }
+	/// maximum position (m) and orientation (rad) distance between current and recorded object pose
+	void setMaxDistance(double distance) { setProperty("max_distance", distance); }
+	void setMaxAngle(double angle) { setProperty("max_angle", angle); }
+	/// spawn at most this number of closest grasps per upstream solution (0 = unlimited)
+	void setMaxCandidates(uint32_t max_candidates) { setProperty("max_candidates", max_candidates); }
+
+	const GraspDatabaseConstPtr& database() const { return database_; }
+
+private:
+	GraspDatabaseConstPtr database_;
+	std::string database_path_;  // path database_ was loaded from
+};
+}  // namespace stages
+}  // namespace task_constructor
+}  // namespace moveit
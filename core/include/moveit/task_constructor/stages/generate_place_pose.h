@@ -57,8 +57,19 @@ public:
 
 	void setObject(const std::string& object) { setProperty("object", object); }
 
+	/** batch mode: additionally sample n placements per nominal one on a disc around the nominal position
+	 *
+	 * Placements are sampled in the world's xy plane, i.e. on a horizontal support surface.
+	 * Placements where the object (checked by its shape only) collides with world objects are rejected.
+	 * Remaining placements are spawned in order of cost, which penalizes horizontal clearance below "clearance".
+	 */
+	void setSampleCount(uint32_t n) { setProperty("sample_count", n); }
+	void setSampleRadius(double radius) { setProperty("sample_radius", radius); }
+	void setClearance(double clearance) { setProperty("clearance", clearance); }
+
 protected:
 	void onNewSolution(const SolutionBase& s) override;
+	void onNewSolutions(const std::vector<const SolutionBase*>& solutions) override;
 };
 }  // namespace stages
 }  // namespace task_constructor
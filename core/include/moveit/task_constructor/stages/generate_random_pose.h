@@ -40,6 +40,7 @@
 
 #include <moveit/task_constructor/stages/generate_pose.h>
 
+#include <memory>
 #include <random>
 
 namespace moveit {
@@ -51,6 +52,7 @@ class GenerateRandomPose : public GeneratePose
 public:
 	GenerateRandomPose(const std::string& name = "generate random pose");
 
+	void reset() override;
 	bool canCompute() const override;
 	void compute() override;
 
@@ -91,6 +93,23 @@ public:
 	/** Limit the number of generated solutions */
 	void setMaxSolutions(size_t max_solutions) { setProperty("max_solutions", max_solutions); }
 
+	/** Sample from a low-discrepancy (Halton) sequence instead of pseudo-random numbers
+	 *
+	 * Quasi-random samples cover the sampling region more evenly, thus requiring fewer spawned poses.
+	 * Each sampler configured via sampleDimension<>() corresponds to one dimension of the sequence.
+	 */
+	void setQuasiRandom(bool flag) { setProperty("quasi_random", flag); }
+
+	/** Spawn a single pose per compute() call, resuming the sampling around the current seed pose with the next call
+	 *
+	 * Thus, the scheduler can interleave sampling with downstream stages, which receive the first poses sooner.
+	 * The timeout then limits the accumulated compute time spent on sampling around a seed pose.
+	 */
+	void setResumable(bool flag) { setProperty("resumable", flag); }
+
+	/** Seed the stage's random number engine to obtain reproducible samples */
+	void setSeed(std::mt19937::result_type seed) { engine_.seed(seed); }
+
 private:
 	/** Allocate the sampler function for the specified random distribution */
 	template <template <class Realtype = double> class RandomNumberDistribution>
@@ -99,7 +118,35 @@ private:
 		throw 0;  // suppress -Wreturn-type
 	}
 
+	/// progress of sampling around the seed pose of an upstream solution, kept across compute() calls
+	struct Sampling
+	{
+		const SolutionBase* source;
+		planning_scene::PlanningScenePtr scene;
+		geometry_msgs::PoseStamped seed_pose;
+		size_t max_solutions;
+		double timeout;
+		size_t spawned = 1;  // including the seed pose
+		double elapsed = 0.0;  // compute time spent on sampling (s)
+
+		bool pending() const { return spawned < max_solutions && elapsed < timeout; }
+	};
+
+	/// fetch the next upstream solution and spawn its seed pose
+	void startSampling();
+	/// spawn the next sampled pose
+	void sampleStep();
+	void spawnTargetPose(const geometry_msgs::PoseStamped& target_pose);
+
+	/** Draw a sample of the given dimension, mapping a uniform sample in (0,1) via inverse_cdf and scaling by width */
+	double sampleUnit(size_t dimension, double (*inverse_cdf)(double), double width);
+
 	std::vector<std::pair<PoseDimension, PoseDimensionSampler>> pose_dimension_samplers_;
+
+	std::mt19937 engine_{ std::random_device{}() };  // per-stage engine, such that stages can sample concurrently
+	bool quasi_random_ = false;
+	size_t sample_index_ = 0;  // index into Halton sequence
+	std::unique_ptr<Sampling> sampling_;  // nullptr: no sampling in progress
 };
 template <>
 GenerateRandomPose::PoseDimensionSampler
@@ -41,6 +41,7 @@
 #include <moveit/task_constructor/stage.h>
 #include <moveit/task_constructor/properties.h>
 #include <moveit/task_constructor/type_traits.h>
+#include <moveit/task_constructor/scene_builder.h>
 #include <moveit_msgs/CollisionObject.h>
 #include <map>
 
@@ -49,6 +50,9 @@ namespace core {
 MOVEIT_CLASS_FORWARD(JointModelGroup);
 }
 }  // namespace moveit
+namespace collision_detection {
+MOVEIT_CLASS_FORWARD(AllowedCollisionMatrix);
+}
 
 namespace moveit {
 namespace task_constructor {
@@ -69,6 +73,7 @@ public:
 	using ApplyCallback = std::function<void(const planning_scene::PlanningScenePtr&, const PropertyMap&)>;
 	ModifyPlanningScene(const std::string& name = "modify planning scene");
 
+	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 	void computeForward(const InterfaceState& from) override;
 	void computeBackward(const InterfaceState& to) override;
 
@@ -148,15 +153,27 @@ protected:
 	};
 	std::list<CollisionMatrixPairs> collision_matrix_edits_;
 	ApplyCallback callback_;
+	// shapes of added objects, shared by all created scenes
+	SceneBuilder::ShapeCache shape_cache_;
+
+	// collision_objects_ compiled into a single batch of world updates for each direction
+	struct Batch
+	{
+		bool valid = false;
+		std::vector<moveit_msgs::CollisionObject> objects;  // coalesced operations
+		std::string error;  // reason why the operations cannot be applied in this direction
+	};
+	Batch batches_[2];  // forward, backward
 
 protected:
 	// apply stored modifications to scene
 	std::pair<InterfaceState, SubTrajectory> apply(const InterfaceState& from, bool invert);
-	void processCollisionObject(planning_scene::PlanningScene& scene, const moveit_msgs::CollisionObject& object,
-	                            bool invert);
+	// compile collision_objects_ into a batch for forward (invert = false) or backward propagation
+	const Batch& batch(bool invert);
 	void attachObjects(planning_scene::PlanningScene& scene, const std::pair<std::string, std::pair<Names, bool>>& pair,
 	                   bool invert);
-	void allowCollisions(planning_scene::PlanningScene& scene, const CollisionMatrixPairs& pairs, bool invert);
+	void allowCollisions(collision_detection::AllowedCollisionMatrix& acm, const CollisionMatrixPairs& pairs,
+	                     bool invert);
 };
 
 inline void ModifyPlanningScene::attachObject(const std::string& object, const std::string& link) {
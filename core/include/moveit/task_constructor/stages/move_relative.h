@@ -40,6 +40,7 @@
 
 #include <moveit/task_constructor/stage.h>
 #include <moveit/task_constructor/solvers/planner_interface.h>
+#include <moveit/robot_state/cartesian_interpolator.h>
 #include <moveit_msgs/Constraints.h>
 #include <geometry_msgs/TwistStamped.h>
 #include <geometry_msgs/Vector3Stamped.h>
@@ -61,6 +62,7 @@ public:
 	             const solvers::PlannerInterfacePtr& planner = solvers::PlannerInterfacePtr());
 
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
+	std::vector<solvers::PlannerInterfaceConstPtr> planners() const override { return { planner_ }; }
 
 	void setGroup(const std::string& group) { setProperty("group", group); }
 	/// setters for IK frame
@@ -86,6 +88,16 @@ public:
 		setProperty("path_constraints", std::move(path_constraints));
 	}
 
+	/** Plan Cartesian moves up to distance (m, or rad for pure rotations) by integrating the Jacobian (0 = disabled)
+	 *
+	 * Short approach and retreat moves don't need full IK at each step. If the integrated path deviates from
+	 * the straight line by more than precision or isn't valid, the configured planner is used instead.
+	 */
+	void setFastPathDistance(double distance) { setProperty("fast_path_distance", distance); }
+	void setFastPathPrecision(const moveit::core::CartesianPrecision& precision) {
+		setProperty("fast_path_precision", precision);
+	}
+
 	/// perform twist motion on specified link
 	void setDirection(const geometry_msgs::TwistStamped& twist) { setProperty("direction", twist); }
 	/// translate link along given direction
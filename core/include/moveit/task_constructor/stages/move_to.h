@@ -43,11 +43,15 @@
 #include <moveit_msgs/Constraints.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/PointStamped.h>
+#include <Eigen/Geometry>
+#include <memory>
+#include <mutex>
 
 namespace moveit {
 namespace core {
 class RobotState;
-}
+class JointModelGroup;
+}  // namespace core
 }  // namespace moveit
 namespace moveit {
 namespace task_constructor {
@@ -60,6 +64,7 @@ public:
 	       const solvers::PlannerInterfacePtr& planner = solvers::PlannerInterfacePtr());
 
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
+	std::vector<solvers::PlannerInterfaceConstPtr> planners() const override { return { planner_ }; }
 
 	void setGroup(const std::string& group) { setProperty("group", group); }
 	/// setters for IK frame
@@ -100,8 +105,37 @@ protected:
 	bool getPointGoal(const boost::any& goal, const Eigen::Isometry3d& ik_pose,
 	                  const planning_scene::PlanningScenePtr& scene, Eigen::Isometry3d& target_eigen);
 
+
+	/// goal property resolved for a group, reused as long as the stage's properties don't change
+	struct ResolvedGoal
+	{
+		enum Type
+		{
+			JOINTS,  // joint-space target: variables and their positions
+			POSE,  // Cartesian target: pose w.r.t. frame
+			POINT,  // Cartesian target: point (pose's translation) w.r.t. frame, keeping link orientation
+			INVALID
+		};
+		Type type = INVALID;
+		uint64_t generation = 0;  // generation of the property map the goal was resolved from
+		const moveit::core::JointModelGroup* jmg = nullptr;
+		std::vector<int> variables;
+		std::vector<double> positions;
+		std::string frame;
+		Eigen::Isometry3d pose;
+	};
+	/// resolve goal, reusing the previous result if neither properties nor group changed
+	std::shared_ptr<const ResolvedGoal> resolveGoal(const boost::any& goal, const core::JointModelGroup* jmg);
+
 protected:
 	solvers::PlannerInterfacePtr planner_;
+
+	std::mutex resolved_goal_mutex_;  // compute() might run concurrently
+	std::shared_ptr<const ResolvedGoal> resolved_goal_;
+
+	// typed handles of properties accessed in compute()
+	const PropertyKey<std::string> group_{ "group" };
+	const PropertyKey<moveit_msgs::Constraints> path_constraints_{ "path_constraints" };
 };
 }  // namespace stages
 }  // namespace task_constructor
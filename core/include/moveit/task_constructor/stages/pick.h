@@ -64,6 +64,11 @@ namespace stages {
  *
  * The end effector postures corresponding to pre-grasp and grasp as well as
  * the end effector's Cartesian pose needs to be provided by an external grasp stage.
+ *
+ * With parallel_motions enabled, each compute() first runs the grasp stage and then plans
+ * the approach and lift motions for the resulting grasp candidates concurrently on the task's thread pool.
+ * This only applies when the container is computed as a whole (TraversalScheduler):
+ * other schedulers compute the children individually.
  */
 class PickPlaceBase : public SerialContainer
 {
@@ -76,9 +81,11 @@ public:
 	PickPlaceBase(Stage::pointer&& grasp_stage, const std::string& name, bool forward);
 
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
+	void compute() override;
 
 	void setEndEffector(const std::string& eef) { properties().set<std::string>("eef", eef); }
 	void setObject(const std::string& object) { properties().set<std::string>("object", object); }
+	void setParallelMotions(bool parallel) { properties().set<bool>("parallel_motions", parallel); }
 
 	solvers::CartesianPathPtr cartesianSolver() { return cartesian_solver_; }
 
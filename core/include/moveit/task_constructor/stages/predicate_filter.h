@@ -52,20 +52,42 @@ namespace stages {
  * All solutions of the wrapped class are passed to predicate.
  * Solutions are accepted if predicate(s) == true.
  * Rejected solutions are forwarded as failures with an optional comment
+ *
+ * Alternatively, a batch_predicate can be specified, which judges all solutions
+ * generated by a single compute() call of the child at once.
+ * If concurrent evaluation is enabled, the (thread-safe!) predicate is evaluated
+ * on the task's thread pool for all solutions generated by a compute() call.
+ * In both cases, solutions are forwarded in cost order once all results are available.
  */
 class PredicateFilter : public WrapperBase
 {
 public:
 	using Predicate = std::function<bool(const SolutionBase&, std::string&)>;
+	/// judge many solutions at once, comments are initialized with the solutions' comments
+	using BatchPredicate =
+	    std::function<std::vector<bool>(const std::vector<const SolutionBase*>&, std::vector<std::string>&)>;
 
 	PredicateFilter(const std::string& name, Stage::pointer&& child = Stage::pointer());
 
+	void reset() override;
 	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
 
+	bool canCompute() const override;
+	void compute() override;
+
 	void onNewSolution(const SolutionBase& s) override;
 
 	void setPredicate(const Predicate& p) { setProperty("predicate", p); }
+	void setBatchPredicate(const BatchPredicate& p) { setProperty("batch_predicate", p); }
 	void setIgnoreFilter(bool ignore) { setProperty("ignore_filter", ignore); }
+	void setConcurrent(bool concurrent) { setProperty("concurrent", concurrent); }
+
+private:
+	/// evaluate all pending solutions and forward them in cost order
+	void evaluatePending();
+
+	// child solutions awaiting evaluation
+	std::vector<const SolutionBase*> pending_;
 };
 }  // namespace stages
 }  // namespace task_constructor
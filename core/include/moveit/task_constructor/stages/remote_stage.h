@@ -0,0 +1,132 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Wrapper distributing the computation of its child stage to remote worker nodes
+ */
+
+#pragma once
+
+#include <moveit/task_constructor/container.h>
+#include <moveit_task_constructor_msgs/ComputeStageAction.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+namespace stages {
+
+/** Wrapper to compute the solutions of its child stage on remote worker nodes
+ *
+ * Incoming interface states of the wrapped propagating or connecting stage are serialized
+ * (planning scene and properties) and sent in batches to RemoteStageServer instances via the
+ * ROS action ComputeStage. Each worker processes one batch at a time. Returned trajectories
+ * are turned into solutions of the local child and lifted as usual.
+ *
+ * The local child is only used to define the interface, cost term, and property forwarding.
+ * The remote workers need to run an equivalently configured stage.
+ * Property values are transmitted via Property::encode(), i.e. their types need to be registered
+ * (by declaring them) in the worker process too.
+ * While no worker is connected, the stage cannot compute.
+ */
+class RemoteStage : public WrapperBase
+{
+public:
+	RemoteStage(const std::string& name = "remote", Stage::pointer&& child = Stage::pointer());
+	~RemoteStage() override;
+
+	void reset() override;
+	void init(const moveit::core::RobotModelConstPtr& robot_model) override;
+	bool canCompute() const override;
+	void compute() override;
+	void onNewSolution(const SolutionBase& s) override;
+
+	/// action names of worker nodes
+	void setWorkers(const std::vector<std::string>& workers) { setProperty("workers", workers); }
+	/// maximum number of states (or state pairs) sent in a single goal
+	void setBatchSize(uint32_t batch_size) { setProperty("batch_size", batch_size); }
+
+private:
+	struct Worker;
+	using Batch = std::vector<const InterfaceState*>;
+
+	uint8_t mode() const;
+	bool collectInputs(Batch& batch, uint32_t max_size);
+	bool collectResults();
+	void processResult(const Batch& batch, const moveit_task_constructor_msgs::ComputeStageResult& result);
+	void processFailure(const Batch& batch, const std::string& comment);
+
+	moveit::core::RobotModelConstPtr robot_model_;
+	std::vector<std::string> worker_names_;
+	std::vector<std::unique_ptr<Worker>> workers_;
+	// (start, end) pairs already sent for connecting stages
+	std::set<std::pair<const InterfaceState*, const InterfaceState*>> sent_pairs_;
+	// no worker connected during last canCompute() (already reported)
+	mutable bool disconnected_ = false;
+};
+
+/** Server side of RemoteStage, computing goals with a local stage
+ *
+ * The stage is initialized for the interface requested by each goal.
+ * Only primitive stages (yielding SubTrajectory solutions) are supported.
+ */
+class RemoteStageServer
+{
+public:
+	RemoteStageServer(const std::string& action_name, Stage::pointer&& stage,
+	                  const moveit::core::RobotModelConstPtr& robot_model);
+	~RemoteStageServer();
+
+	/// compute a single goal, independent of any ROS communication
+	moveit_task_constructor_msgs::ComputeStageResult compute(const moveit_task_constructor_msgs::ComputeStageGoal& goal);
+
+	Stage* stage() { return stage_.get(); }
+
+private:
+	struct Server;
+
+	void prepare(InterfaceFlags flags);
+	/// append solutions originating from given input state (all for nullptr) to result
+	void collect(uint32_t input, const InterfaceState* state, bool forward,
+	             moveit_task_constructor_msgs::ComputeStageResult& result);
+
+	Stage::pointer stage_;
+	moveit::core::RobotModelConstPtr robot_model_;
+	InterfacePtr prev_ends_;
+	InterfacePtr next_starts_;
+	std::unique_ptr<Server> server_;
+};
+}  // namespace stages
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,105 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Aggregated statistics of many tasks, published on a single topic
+*/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit_task_constructor_msgs/FleetStatistics.h>
+#include <ros/publisher.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define FLEET_STATISTICS_TOPIC "/moveit_task_constructor/fleet_statistics"
+
+namespace moveit {
+namespace task_constructor {
+
+class Task;
+
+/** Publish compact summaries of all tasks sharing this aggregator on a single, global topic
+ *
+ * Instead of subscribing to the statistics topic of each task's Introspection, monitoring tools only need to
+ * subscribe to FLEET_STATISTICS_TOPIC. Tasks update their summary (see Task::setStatisticsAggregator())
+ * at most at the aggregator's rate and all summaries are published as a single message, again limited to that rate.
+ * Thus, the monitoring overhead per task stays constant, independent of the number of tasks.
+ */
+class StatisticsAggregator
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// rate (Hz) limits updates and publishing, <= 0 disables rate limiting
+	explicit StatisticsAggregator(double rate = 1.0, const std::string& topic = FLEET_STATISTICS_TOPIC);
+
+	/// start a plan() call of task
+	void planStarted(const Task& task);
+	/// update the summary of task, limited to the configured rate unless forced, and publish if due
+	void update(const Task& task, bool force = false);
+	/// finish a plan() call of task, publishing its final summary
+	void planFinished(const Task& task);
+	/// stop reporting task, e.g. on its destruction
+	void remove(const Task& task);
+
+	/// fill msg with the latest summaries of all tasks
+	void fill(moveit_task_constructor_msgs::FleetStatistics& msg) const;
+	/// publish all summaries, limited to the configured rate unless forced (requires ros::init())
+	void publish(bool force = false);
+
+private:
+	struct Entry
+	{
+		moveit_task_constructor_msgs::TaskSummary summary;
+		Clock::time_point plan_start;
+		Clock::time_point last_update;
+	};
+	Entry& entry(const Task& task);
+	static void summarize(const Task& task, moveit_task_constructor_msgs::TaskSummary& summary);
+
+	Clock::duration period_;  // minimum time between updates of a task and between published messages
+	Clock::time_point last_published_;
+	ros::Publisher publisher_;
+
+	mutable std::mutex mutex_;
+	std::unordered_map<const Task*, Entry> entries_;
+};
+
+MOVEIT_CLASS_FORWARD(StatisticsAggregator);
+}  // namespace task_constructor
+}  // namespace moveit
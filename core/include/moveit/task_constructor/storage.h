@@ -46,11 +46,17 @@
 #include <moveit_task_constructor_msgs/Solution.h>
 #include <visualization_msgs/MarkerArray.h>
 
+#include <Eigen/Core>
+#include <boost/container/small_vector.hpp>
+#include <array>
+#include <atomic>
 #include <list>
+#include <set>
 #include <vector>
 #include <deque>
 #include <cassert>
 #include <functional>
+#include <mutex>
 
 namespace planning_scene {
 MOVEIT_CLASS_FORWARD(PlanningScene);
@@ -60,6 +66,12 @@ namespace robot_trajectory {
 MOVEIT_CLASS_FORWARD(RobotTrajectory);
 }
 
+namespace moveit {
+namespace core {
+MOVEIT_CLASS_FORWARD(JointModelGroup);
+}
+}  // namespace moveit
+
 namespace moveit {
 namespace task_constructor {
 
@@ -76,14 +88,15 @@ MOVEIT_CLASS_FORWARD(Introspection);
 class InterfaceState
 {
 	friend class SolutionBase;  // addIncoming() / addOutgoing() should be called only by SolutionBase
-	friend class Interface;  // allow Interface to set owner_ and priority_
+	friend class Interface;  // allow Interface to set owner_, position_ and priority_
 	friend class ContainerBasePrivate;  // allow setting priority_ for pruning
 
 public:
 	enum Status
 	{
 		ENABLED,  // state is actively considered during planning
-		ARMED,  // disabled state in a Connecting interface that will become re-enabled with a new opposite state
+		ARMED,  // disabled state in a Connecting interface that will become re-enabled with a new opposite state,
+		        // or a state parked outside the beam of its interface (see Interface::setBeamWidth())
 		PRUNED,  // disabled state on a pruned solution branch
 	};
 	static const char* colorForStatus(unsigned int s) { return STATUS_COLOR_[s]; }
@@ -91,24 +104,31 @@ public:
 	/** InterfaceStates are ordered according to two values:
 	 *  Depth of interlinked trajectory parts and accumulated trajectory costs along that path.
 	 *  Preference ordering considers high-depth first and within same depth, minimal cost paths.
+	 *  An optional estimate of the remaining cost-to-go (see Interface::setCostToGo()) turns the latter
+	 *  into A*-style ordering by cost + estimate.
 	 */
-	struct Priority : std::tuple<Status, unsigned int, double>
+	struct Priority : std::tuple<Status, unsigned int, double, double>
 	{
-		Priority(unsigned int depth, double cost, Status status)
-		  : std::tuple<Status, unsigned int, double>(status, depth, cost) {}
+		Priority(unsigned int depth, double cost, Status status, double estimate = 0.0)
+		  : std::tuple<Status, unsigned int, double, double>(status, depth, cost, estimate) {}
 		Priority(unsigned int depth, double cost) : Priority(depth, cost, std::isfinite(cost) ? ENABLED : PRUNED) {}
-		// Constructor copying depth and cost, but modifying its status
-		Priority(const Priority& other, Status status) : Priority(other.depth(), other.cost(), status) {}
+		// Constructor copying depth, cost, and estimate, but modifying its status
+		Priority(const Priority& other, Status status)
+		  : Priority(other.depth(), other.cost(), status, other.estimate()) {}
 
 		inline Status status() const { return std::get<0>(*this); }
 		inline bool enabled() const { return std::get<0>(*this) == ENABLED; }
 
 		inline unsigned int depth() const { return std::get<1>(*this); }
 		inline double cost() const { return std::get<2>(*this); }
+		/// estimated remaining cost-to-go
+		inline double estimate() const { return std::get<3>(*this); }
+		Priority withEstimate(double estimate) const { return Priority(depth(), cost(), status(), estimate); }
 
 		// add priorities
 		Priority operator+(const Priority& other) const {
-			return Priority(depth() + other.depth(), cost() + other.cost(), std::min(status(), other.status()));
+			return Priority(depth() + other.depth(), cost() + other.cost(), std::min(status(), other.status()),
+			                estimate() + other.estimate());
 		}
 		// comparison operators
 		bool operator<(const Priority& rhs) const;
@@ -116,7 +136,9 @@ public:
 		inline bool operator<=(const Priority& rhs) const { return !(rhs < *this); }
 		inline bool operator>=(const Priority& rhs) const { return !(*this < rhs); }
 	};
-	using Solutions = std::deque<SolutionBase*>;
+	/// number of incoming/outgoing trajectories stored without heap allocation (usually there are one or two)
+	static constexpr size_t INLINE_SOLUTIONS = 2;
+	using Solutions = boost::container::small_vector<SolutionBase*, INLINE_SOLUTIONS>;
 
 	/// create an InterfaceState from a planning scene
 	InterfaceState(const planning_scene::PlanningScenePtr& ps);
@@ -147,6 +169,29 @@ public:
 	void updateStatus(Status status);
 
 	Interface* owner() const { return owner_; }
+	/// whether the state is ARMED because it didn't fit into the beam of its interface
+	bool beamParked() const { return beam_parked_; }
+
+	/// number of parent scenes in scene()'s diff chain
+	size_t sceneDiffDepth() const;
+	/// replace scene() by a flattened copy if its diff chain is deeper than max_depth (0 = unbounded)
+	bool boundSceneDiffDepth(size_t max_depth);
+
+	/** scene() as full message or as diff to its parent scene, converted on first access and cached
+	 *
+	 * Thus, solutions sharing a state reuse its messages when being published (nullptr if evicted).
+	 */
+	std::shared_ptr<const moveit_msgs::PlanningScene> sceneMsg(bool diff = false) const;
+
+	/// apply a scene diff on top of scene(), e.g. to reflect world changes in a kept solution (see Task::replan())
+	void applySceneDiff(const moveit_msgs::PlanningScene& diff);
+
+	/// release the scene of a PRUNED state to save memory (see Task::setMemoryBudget()), only a tombstone remains
+	void evictScene() {
+		scene_.reset();
+		clearSceneMsgs();
+	}
+	bool evicted() const { return !scene_; }
 
 private:
 	// these methods should be only called by SolutionBase::set[Start|End]State()
@@ -154,10 +199,13 @@ private:
 	inline void addOutgoing(SolutionBase* t) { outgoing_trajectories_.push_back(t); }
 	// Set new priority without updating the owning interface (USE WITH CARE)
 	inline void setPriority(const Priority& prio) { priority_ = prio; }
+	void clearSceneMsgs() const;
 
 private:
 	static const char* STATUS_COLOR_[];
 	planning_scene::PlanningSceneConstPtr scene_;
+	// lazily converted full and diff messages of scene_, accessed atomically
+	mutable std::array<std::shared_ptr<const moveit_msgs::PlanningScene>, 2> scene_msgs_;
 	PropertyMap properties_;
 	/// trajectories which are *timewise before* this state
 	Solutions incoming_trajectories_;
@@ -167,12 +215,18 @@ private:
 	// members needed for priority scheduling in Interface list
 	Priority priority_;
 	Interface* owner_ = nullptr;  // allow update of priority
+	std::list<InterfaceState*>::iterator position_;  // position in owner_'s list, valid only if owner_ is set
+	size_t status_walk_ = 0;  // last setStatus() traversal that updated this state
+	InterfaceState* inbox_next_ = nullptr;  // link in owner's inbox while awaiting Interface::drain()
+	bool beam_parked_ = false;  // ARMED by owner_'s beam, see Interface::setBeamWidth()
 };
 
-/** Interface provides a cost-sorted list of InterfaceStates available as input for a stage. */
-class Interface : public ordered<InterfaceState*>
+/** Interface provides a cost-sorted list of InterfaceStates available as input for a stage.
+ *
+ * As interfaces might hold thousands of states, they use an indexed backend for logarithmic insertion. */
+class Interface : public ordered<InterfaceState*, ValueOrPointeeLess<InterfaceState*>, ordered_backend::indexed>
 {
-	using base_type = ordered<InterfaceState*>;
+	using base_type = ordered<InterfaceState*, ValueOrPointeeLess<InterfaceState*>, ordered_backend::indexed>;
 
 public:
 	// iterators providing convinient access to stored InterfaceState
@@ -210,6 +264,8 @@ public:
 	};
 	using UpdateFlags = utils::Flags<Update>;
 	using NotifyFunction = std::function<void(iterator, UpdateFlags)>;
+	/// heuristic estimating the remaining cost of a state propagated in given direction, e.g. towards the task's end
+	using CostToGo = std::function<double(const InterfaceState&, Direction)>;
 
 	class DisableNotify
 	{
@@ -224,21 +280,107 @@ public:
 
 	Interface(const NotifyFunction& notify = NotifyFunction());
 
-	/// add a new InterfaceState
+	/// add a new InterfaceState (deferred to the next drain() if the inbox is enabled)
 	void add(InterfaceState& state);
 
+	/** Decouple producers from consumers of states
+	 *
+	 * With the inbox enabled, add() merely pushes the state onto a lock-free stack, which is safe to call
+	 * from any thread. The consumer moves them into the sorted list via drain(), running notify callbacks
+	 * in its own thread.
+	 */
+	void setInboxEnabled(bool enable) { inbox_enabled_ = enable; }
+	bool inboxEnabled() const { return inbox_enabled_; }
+	bool inboxEmpty() const { return inbox_.load(std::memory_order_acquire) == nullptr; }
+	/// move states from the inbox into the interface (in the order they were added), returns their number
+	size_t drain();
+
 	/// remove a state from the interface and return it as a one-element list
 	container_type remove(iterator it);
+	/// remove all states, releasing all beam slots
+	void clear();
 
 	/// update state's priority (and call notify_ if it really has changed)
 	void updatePriority(InterfaceState* state, const InterfaceState::Priority& priority);
 	inline bool notifyEnabled() const { return static_cast<bool>(notify_); }
 
+	/** estimate cost-to-go of added states (propagated in direction dir) for A*-style ordering
+	 *
+	 * The estimate is computed once per added state and kept across priority updates.
+	 */
+	void setCostToGo(const CostToGo& cost_to_go, Direction dir) {
+		cost_to_go_ = cost_to_go;
+		cost_to_go_dir_ = dir;
+	}
+
+	/// prune added states whose cost plus estimate exceeds bound (nullptr = disabled), see Task::setCostPruningSlack()
+	void setCostBound(const std::atomic<double>* bound) { cost_bound_ = bound; }
+	/// whether state cannot become part of a solution within the cost bound anymore
+	bool exceedsCostBound(const InterfaceState& state) const {
+		return cost_bound_ && state.priority().cost() + state.priority().estimate() > cost_bound_->load();
+	}
+
+	/** Beam search: keep at most width states ENABLED, parking the remaining ones as ARMED (0 = unlimited)
+	 *
+	 * A slot of the beam is held by each enabled state and by each fetched state that was extended successfully.
+	 * Slots are released when a state gets disabled or a fetched state turns out to be a dead end
+	 * (see releaseBeamSlot()). Parked states are re-enabled in priority order to fill released slots.
+	 * The beam relies on priority order and is only meaningful for sorted interfaces.
+	 */
+	void setBeamWidth(size_t width);
+	size_t beamWidth() const { return beam_width_; }
+	/// release the slot held by a fetched state that couldn't be extended
+	void releaseBeamSlot();
+	/// forget slots of fetched states and refill the beam from parked states, returns the number of re-enabled states
+	size_t widenBeam();
+
+	/// whether states are kept sorted by priority (otherwise, they are kept in insertion order)
+	bool sorted() const { return sorted_; }
+
+	/// whether states were added, removed, or updated since the last call, see CompiledScheduler
+	bool testAndClearModified() { return modified_.exchange(false, std::memory_order_acq_rel); }
+	/// number of changes (added, removed, or updated states) so far, allowing to validate data derived from the list
+	size_t changes() const { return changes_.load(std::memory_order_acquire); }
+
+protected:
+	bool sorted_ = true;
+
 private:
 	NotifyFunction notify_;
+	CostToGo cost_to_go_;
+	Direction cost_to_go_dir_ = FORWARD;
+	const std::atomic<double>* cost_bound_ = nullptr;
+	size_t beam_width_ = 0;
+	size_t beam_slots_ = 0;  // slots held by enabled and successfully fetched states
+	bool beam_balancing_ = false;  // guard against recursion from balanceBeam()
+	// priority order of states, independent of the list order
+	struct PriorityLess
+	{
+		bool operator()(const InterfaceState* a, const InterfaceState* b) const;
+	};
+	// boundary of the beam, tracked while a beam width is set: worst enabled and best parked states
+	std::set<InterfaceState*, PriorityLess> enabled_states_;
+	std::set<InterfaceState*, PriorityLess> parked_states_;
+	bool inbox_enabled_ = false;
+	std::atomic<InterfaceState*> inbox_{ nullptr };  // stack of states linked via InterfaceState::inbox_next_
+	std::atomic<bool> modified_{ true };  // set on any change of the state list
+	std::atomic<size_t> changes_{ 0 };  // counts changes of the state list
+
+	void markModified() {
+		modified_.store(true, std::memory_order_release);
+		changes_.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	// insert state into the sorted list and notify
+	void addNow(InterfaceState& state);
+	// park worst enabled states or re-enable best parked states until the beam is filled exactly
+	void balanceBeam();
+	// (un)register state in enabled_states_ / parked_states_, according to its current priority
+	void trackBeam(InterfaceState* state);
+	void untrackBeam(InterfaceState* state);
 
 	// restrict access to some functions to ensure consistency
-	// (we need to set/unset InterfaceState::owner_)
+	// (we need to set/unset InterfaceState::owner_ and position_)
 	using base_type::erase;
 	using base_type::insert;
 	using base_type::moveFrom;
@@ -246,6 +388,17 @@ private:
 	using base_type::remove_if;
 };
 
+/** Interface keeping its states in insertion order
+ *
+ * Adding, removing, and updating states takes constant time, as they are never re-sorted.
+ * This suits interfaces that merely collect states, but are never consumed in priority order.
+ */
+class UnsortedInterface : public Interface
+{
+public:
+	UnsortedInterface(const NotifyFunction& notify = NotifyFunction()) : Interface(notify) { sorted_ = false; }
+};
+
 std::ostream& operator<<(std::ostream& os, const InterfaceState::Priority& prio);
 std::ostream& operator<<(std::ostream& os, const Interface& interface);
 std::ostream& operator<<(std::ostream& os, Interface::Direction dir);
@@ -269,6 +422,7 @@ class SolutionBase
 {
 	friend ContainerBasePrivate;
 	friend TmpSolutionContext;
+	friend Introspection;  // allow setting introspection_id_
 
 public:
 	virtual ~SolutionBase() = default;
@@ -304,14 +458,54 @@ public:
 	void markAsFailure(const std::string& msg = std::string());
 	inline bool isFailure() const { return !std::isfinite(cost_); }
 
-	const std::string& comment() const { return comment_; }
-	void setComment(const std::string& comment) { comment_ = comment; }
+	/// comment, including details of a pending comment generator
+	const std::string& comment() const {
+		generateComment();
+		return comment_;
+	}
+	/// comment without details that weren't generated yet (see setCommentGenerator())
+	const std::string& commentSummary() const { return comment_; }
+	void setComment(const std::string& comment) {
+		comment_ = comment;
+		comment_generator_ = nullptr;
+	}
 
-	auto& markers() { return markers_; }
-	const auto& markers() const { return markers_; }
+	using CommentGenerator = std::function<std::string()>;
+	/** append details to the comment, generated only when comment() is accessed first
+	 *
+	 * Detailed comments, e.g. listing colliding links, are wasted effort for failures that are never stored.
+	 * Failure statistics only consider the commentSummary().
+	 */
+	void setCommentGenerator(CommentGenerator&& generator) { comment_generator_ = std::move(generator); }
+
+	using Markers = std::deque<visualization_msgs::Marker>;
+	using MarkerGenerator = std::function<void(Markers& markers)>;
+
+	/// markers of this solution, invoking pending marker generators first
+	Markers& markers() {
+		generateMarkers();
+		return markers_;
+	}
+	const Markers& markers() const {
+		generateMarkers();
+		return markers_;
+	}
+	/// markers generated so far, without invoking pending marker generators
+	const Markers& generatedMarkers() const { return markers_; }
+	/** Defer generation of (expensive) markers until markers() are accessed, e.g. for introspection
+	 *
+	 * The generator must capture all required data by value, as it might be called after planning.
+	 */
+	void addMarkerGenerator(MarkerGenerator&& generator) { marker_generators_.push_back(std::move(generator)); }
+	/// drop pending marker generators, e.g. to keep failures small
+	void clearMarkerGenerators() { marker_generators_.clear(); }
 
-	/// convert solution to message
-	void toMsg(moveit_task_constructor_msgs::Solution& solution, Introspection* introspection = nullptr) const;
+	/** convert solution to message
+	 *
+	 * If deduplicate_scenes is true, identical scene diffs of sub trajectories are stored only once in scene_table.
+	 */
+	void toMsg(moveit_task_constructor_msgs::Solution& solution, Introspection* introspection = nullptr,
+	           bool deduplicate_scenes = false) const;
 	/// append this solution to Solution msg
 	virtual void appendTo(moveit_task_constructor_msgs::Solution& solution,
 	                      Introspection* introspection = nullptr) const = 0;
@@ -319,6 +513,18 @@ public:
 
 	/// required to dispatch to type-specific CostTerm methods via vtable
 	virtual double computeCost(const CostTerm& cost, std::string& comment) const = 0;
+	/** computeCost(), memoizing the result per cost term
+	 *
+	 * Used to evaluate (stored) sub solutions, which are shared by many sequences or wrappers.
+	 * The cached result is owned by the solution. Thus, it is discarded together with all solutions on reset().
+	 * Results are keyed by CostTerm::id() and only reused while CostTerm::version() is unchanged.
+	 * Concurrent calls are safe, but might evaluate the cost term more than once.
+	 */
+	double computeCachedCost(const CostTerm& cost, std::string& comment) const;
+
+	/// exact cost term whose evaluation was deferred, see cost::Deferred
+	const std::shared_ptr<const CostTerm>& deferredCostTerm() const { return deferred_cost_term_; }
+	void setDeferredCostTerm(const std::shared_ptr<const CostTerm>& term) { deferred_cost_term_ = term; }
 
 	/// order solutions by their cost
 	bool operator<(const SolutionBase& other) const { return this->cost_ < other.cost_; }
@@ -334,8 +540,41 @@ private:
 	double cost_;
 	// comment for this solution, e.g. explanation of failure
 	std::string comment_;
+
+	// results of computeCachedCost()
+	struct CachedCost
+	{
+		uint64_t term;  // CostTerm::id()
+		uint64_t version;  // CostTerm::version() the result was computed for
+		double cost;
+		std::string comment;
+	};
+	// replaced as a whole (copy on write) via std::atomic_load/compare_exchange, allowing concurrent evaluation
+	mutable std::shared_ptr<const std::vector<CachedCost>> cost_cache_;
+	// exact cost term to evaluate once the solution becomes part of a complete solution
+	std::shared_ptr<const CostTerm> deferred_cost_term_;
 	// markers for this solution, e.g. target frame or collision indicators
-	std::deque<visualization_msgs::Marker> markers_;
+	mutable Markers markers_;
+	// functions generating further markers on first access
+	mutable std::vector<MarkerGenerator> marker_generators_;
+	void generateMarkers() const;
+	// function generating details of the comment on first access
+	mutable CommentGenerator comment_generator_;
+	void generateComment() const;
+	// guards lazy generation, as solutions might be accessed concurrently by planning and introspection threads
+	struct GenerationMutex
+	{
+		std::mutex mutex;
+		GenerationMutex() = default;
+		GenerationMutex(const GenerationMutex& /*unused*/) {}  // copies are guarded on their own
+		GenerationMutex& operator=(const GenerationMutex& /*unused*/) { return *this; }
+	};
+	mutable GenerationMutex generation_mutex_;
+
+	// id assigned by Introspection::solutionId(), 0 if not registered
+	mutable uint32_t introspection_id_ = 0;
+	// id was released by Introspection::expireSolution()
+	mutable bool introspection_expired_ = false;
 
 	// begin and end InterfaceState of this solution/trajectory
 	const InterfaceState* start_ = nullptr;
@@ -347,13 +586,54 @@ MOVEIT_CLASS_FORWARD(SolutionBase);
 class SubTrajectory : public SolutionBase
 {
 public:
+	/// contiguous joint values and times of all waypoints of a trajectory
+	struct Waypoints
+	{
+		using Matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+		/// trajectory's group defining the columns of positions, nullptr for all robot variables
+		const moveit::core::JointModelGroup* group;
+		/// one row per waypoint, one column per group variable (in group order)
+		Matrix positions;
+		/// time from start of each waypoint
+		Eigen::VectorXd times;
+	};
+
 	SubTrajectory(
 	    const robot_trajectory::RobotTrajectoryConstPtr& trajectory = robot_trajectory::RobotTrajectoryConstPtr(),
 	    double cost = 0.0, std::string comment = "")
 	  : SolutionBase(nullptr, cost, std::move(comment)), trajectory_(trajectory) {}
 
-	robot_trajectory::RobotTrajectoryConstPtr trajectory() const { return trajectory_; }
-	void setTrajectory(const robot_trajectory::RobotTrajectoryPtr& t) { trajectory_ = t; }
+	robot_trajectory::RobotTrajectoryConstPtr trajectory() const { return std::atomic_load(&trajectory_); }
+	/** trajectory to publish or execute, compressed as configured by Stage::setTrajectoryCompression() of the creator
+	 *
+	 * The compressed copy is cached until the trajectory is replaced, e.g. when its timing is finalized.
+	 */
+	robot_trajectory::RobotTrajectoryConstPtr compressedTrajectory() const;
+	void setTrajectory(const robot_trajectory::RobotTrajectoryPtr& t) {
+		std::atomic_store(&trajectory_, robot_trajectory::RobotTrajectoryConstPtr(t));
+		std::atomic_store(&waypoints_, std::shared_ptr<const Waypoints>());
+		std::atomic_store(&compressed_, std::shared_ptr<const Compressed>());
+	}
+	/** Replace a trajectory with deferred time parameterization by its time-parameterized copy
+	 *
+	 * Called before the trajectory is published or executed (see solvers::finalizeTimeParameterization()).
+	 * The former trajectory is never modified: concurrent readers holding it are not affected.
+	 */
+	void finalizeTimeParameterization() const;
+	/** waypoints of the trajectory as contiguous matrix, built on first access and cached (nullptr without trajectory)
+	 *
+	 * Times refer to the trajectory's timing at construction time: the cache is dropped when timing is finalized.
+	 */
+	std::shared_ptr<const Waypoints> waypoints() const;
+	/// release trajectory and markers of a solution on a pruned branch, keeping cost and comment
+	void evict() {
+		std::atomic_store(&trajectory_, robot_trajectory::RobotTrajectoryConstPtr());
+		std::atomic_store(&waypoints_, std::shared_ptr<const Waypoints>());
+		std::atomic_store(&compressed_, std::shared_ptr<const Compressed>());
+		clearMarkerGenerators();
+		markers().clear();
+	}
 
 	void appendTo(moveit_task_constructor_msgs::Solution& msg, Introspection* introspection = nullptr) const override;
 
@@ -366,8 +646,21 @@ public:
 	}
 
 private:
-	// actual trajectory, might be empty
-	robot_trajectory::RobotTrajectoryConstPtr trajectory_;
+	// actual trajectory, might be empty; accessed atomically, as finalizeTimeParameterization() replaces it
+	mutable robot_trajectory::RobotTrajectoryConstPtr trajectory_;
+	// lazily built view of trajectory_'s waypoints, accessed atomically
+	mutable std::shared_ptr<const Waypoints> waypoints_;
+
+	// compressed copy of a trajectory for the given tolerances
+	struct Compressed
+	{
+		const robot_trajectory::RobotTrajectory* source;
+		double joint_tolerance;
+		double cartesian_tolerance;
+		robot_trajectory::RobotTrajectoryConstPtr trajectory;
+	};
+	// lazily computed compressedTrajectory() of trajectory_, accessed atomically
+	mutable std::shared_ptr<const Compressed> compressed_;
 };
 MOVEIT_CLASS_FORWARD(SubTrajectory);
 
@@ -385,6 +678,8 @@ public:
 	SolutionSequence(container_type&& subsolutions, double cost = 0.0, Stage* creator = nullptr)
 	  : SolutionBase(creator, cost), subsolutions_(std::move(subsolutions)) {}
 
+	/// reserve space for n subsolutions, e.g. the number of children of a SerialContainer
+	void reserve(size_t n) { subsolutions_.reserve(n); }
 	void push_back(const SolutionBase& solution);
 
 	/// append all subsolutions to solution
@@ -414,9 +709,9 @@ class WrappedSolution : public SolutionBase
 {
 public:
 	explicit WrappedSolution(Stage* creator, const SolutionBase* wrapped, double cost, std::string comment)
-	  : SolutionBase(creator, cost, std::move(comment)), wrapped_(wrapped) {}
+	  : SolutionBase(creator, cost, std::move(comment)), wrapped_(wrapped), innermost_(innermostOf(wrapped)) {}
 	explicit WrappedSolution(Stage* creator, const SolutionBase* wrapped, double cost)
-	  : SolutionBase(creator, cost), wrapped_(wrapped) {}
+	  : SolutionBase(creator, cost), wrapped_(wrapped), innermost_(innermostOf(wrapped)) {}
 	explicit WrappedSolution(Stage* creator, const SolutionBase* wrapped)
 	  : WrappedSolution(creator, wrapped, wrapped->cost()) {}
 	void appendTo(moveit_task_constructor_msgs::Solution& solution,
@@ -425,11 +720,66 @@ public:
 	double computeCost(const CostTerm& cost, std::string& comment) const override;
 
 	const SolutionBase* wrapped() const { return wrapped_; }
+	/** first solution down the chain of wrapped solutions that is not a WrappedSolution itself
+	 *
+	 * Wrappers only re-cost or re-comment a solution. Thus, traversals of the actual solution content
+	 * can skip the whole chain of wrappers (added by nested containers) in a single step.
+	 */
+	const SolutionBase* innermost() const { return innermost_; }
 
 private:
+	static const SolutionBase* innermostOf(const SolutionBase* wrapped) {
+		const auto* w = dynamic_cast<const WrappedSolution*>(wrapped);
+		return w ? w->innermost_ : wrapped;
+	}
+
 	const SolutionBase* wrapped_;
+	const SolutionBase* innermost_;  // shortcut through nested wrappers
+};
+
+/// collect the SubTrajectories of solution in execution order
+void flatten(const SolutionBase& solution, std::vector<const SubTrajectory*>& result);
+
+/// measure to identify near-duplicate solutions, see Task::setSolutionDiversity()
+enum class SolutionDistance
+{
+	END_STATE,  // joint positions and object poses of the end states
+	TRAJECTORY,  // end states and all waypoints, compared at corresponding relative positions
 };
 
+/** All waypoints of a solution, stored in contiguous buffers
+ *
+ * Waypoints of all sub trajectories are concatenated in execution order, their times being offset
+ * to refer to the start of the whole solution. Waypoints duplicated at the junction of sub trajectories are skipped.
+ * Positions and velocities are stored waypoint by waypoint, each comprising all variable_names.
+ */
+struct FlatTrajectory
+{
+	std::vector<std::string> variable_names;
+	std::vector<double> times;  // time from start [s], one entry per waypoint
+	std::vector<double> positions;  // times.size() x variable_names.size()
+	std::vector<double> velocities;  // times.size() x variable_names.size(), zero if unknown
+
+	size_t size() const { return times.size(); }
+	const double* positionsAt(size_t waypoint) const { return positions.data() + waypoint * variable_names.size(); }
+	const double* velocitiesAt(size_t waypoint) const { return velocities.data() + waypoint * variable_names.size(); }
+};
+
+/// export all waypoints of solution in a single pass, finalizing deferred time parameterizations
+FlatTrajectory flattenTrajectory(const SolutionBase& solution);
+/// concatenate all sub trajectories of solution into a single RobotTrajectory (nullptr if there are none)
+robot_trajectory::RobotTrajectoryPtr concatenateTrajectories(const SolutionBase& solution);
+
+/** Lossy copy of trajectory, dropping waypoints that can be interpolated from the kept ones
+ *
+ * A dropped waypoint deviates from the interpolation of its kept neighbours by at most joint_tolerance
+ * for every active joint and by at most cartesian_tolerance for the positions of the group's end-effector tips.
+ * Non-positive tolerances disable the corresponding check.
+ * Kept waypoints are chosen by Douglas-Peucker simplification, splitting at the most deviating waypoint.
+ */
+robot_trajectory::RobotTrajectoryPtr compressTrajectory(const robot_trajectory::RobotTrajectory& trajectory,
+                                                        double joint_tolerance, double cartesian_tolerance = 0.0);
+
 /// Trait to retrieve the end (FORWARD) or start (BACKWARD) state of a given solution
 template <Interface::Direction dir>
 const InterfaceState* state(const SolutionBase& solution);
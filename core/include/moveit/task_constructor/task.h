@@ -42,11 +42,19 @@
 #include "container.h"
 
 #include <moveit/task_constructor/introspection.h>
+#include <moveit/task_constructor/diagnostics.h>
+#include <moveit/task_constructor/event_log.h>
+#include <moveit/task_constructor/scheduler.h>
+#include <moveit/task_constructor/solution_file.h>
+#include <moveit/task_constructor/solution_stream.h>
+#include <moveit/task_constructor/statistics_aggregator.h>
+#include <moveit/task_constructor/thread_pool.h>
 #include <moveit_task_constructor_msgs/Solution.h>
 
 #include <moveit/macros/class_forward.h>
 
 #include <moveit_msgs/MoveItErrorCodes.h>
+#include <moveit_msgs/PlanningScene.h>
 #include <moveit/utils/moveit_error_code.h>
 
 namespace moveit {
@@ -56,6 +64,10 @@ MOVEIT_CLASS_FORWARD(RobotState);
 }  // namespace core
 }  // namespace moveit
 
+namespace plan_execution {
+class PlanExecution;
+}
+
 namespace moveit {
 namespace task_constructor {
 
@@ -64,6 +76,7 @@ MOVEIT_CLASS_FORWARD(ContainerBase);
 MOVEIT_CLASS_FORWARD(Task);
 
 class TaskPrivate;
+class ThreadPool;
 /** A Task is the root of a tree of stages.
  *
  * Actually a tasks wraps a single container (by default a SerialContainer),
@@ -91,7 +104,7 @@ public:
 	const moveit::core::RobotModelConstPtr& getRobotModel() const;
 	/// setting the robot model also resets the task
 	void setRobotModel(const moveit::core::RobotModelConstPtr& robot_model);
-	/// load robot model from given parameter
+	/// load robot model from given parameter, sharing models via the process-wide RobotModelCache
 	void loadRobotModel(const std::string& robot_description = "robot_description");
 
 	void add(Stage::pointer&& stage);
@@ -114,24 +127,313 @@ public:
 	using WrapperBase::removeSolutionCallback;
 	using WrapperBase::SolutionCallback;
 
+	/** Create a stream yielding all top-level solutions of the next plan() call as soon as they are found
+	 *
+	 * In contrast to solution callbacks, the stream is consumed outside the planning thread(s).
+	 * It is closed when plan() returns. Streamed solutions remain valid until the task is reset.
+	 */
+	SolutionStreamPtr streamSolutions();
+
 	using WrapperBase::setTimeout;
 	using WrapperBase::timeout;
 
 	using WrapperBase::pruning;
 	using WrapperBase::setPruning;
 
+	/** Set number of threads used for planning
+	 *
+	 * With more than one thread, children of a SerialContainer having pending work are computed concurrently.
+	 * Interface and solution bookkeeping is serialized, but the actual planning work
+	 * (e.g. of propagating and connecting stages) overlaps. Generators are never computed concurrently.
+	 * Defaults to 1, i.e. single-threaded planning.
+	 */
+	void setNumThreads(size_t num_threads);
+	size_t numThreads() const;
+
+	/** Plan using an external thread pool, e.g. shared between several tasks
+	 *
+	 * The pool's workers (and the thread calling plan()) are used instead of a task-owned pool,
+	 * i.e. numThreads() is ignored. Jobs of all tasks sharing the pool are processed in FIFO order.
+	 * Pass nullptr to return to a task-owned pool.
+	 */
+	void setThreadPool(const std::shared_ptr<ThreadPool>& pool);
+
+	/** Configure placement and scheduling of the workers of the task-owned pool (see ThreadPool::Options)
+	 *
+	 * E.g. restrict planning to CPUs not used by real-time control threads, or lower its scheduling priority.
+	 * Shared pools (see setThreadPool()) are configured on their construction instead.
+	 * Takes effect with the next init().
+	 */
+	void setThreadOptions(const ThreadPool::Options& options);
+	const ThreadPool::Options& threadOptions() const;
+
+	/** Run solver work, i.e. Stage::runConcurrently() jobs like IK, collision, or cost evaluation, on a separate pool
+	 *
+	 * The stage pool (see setNumThreads() and setThreadPool()) then only computes stages, while solver calls run
+	 * on the given pool, e.g. with workers pinned to dedicated CPUs to stay cache-local.
+	 * The pool can be shared between tasks. nullptr (default) runs solver work on the stage pool.
+	 * Takes effect with the next init().
+	 */
+	void setSolverThreadPool(const std::shared_ptr<ThreadPool>& pool);
+	const std::shared_ptr<ThreadPool>& solverThreadPool() const;
+
+	/** Set the strategy deciding which stages to compute in each planning iteration
+	 *
+	 * nullptr (default) traverses the stage hierarchy, computing all children with pending work in turn.
+	 * PriorityScheduler computes the most promising work first.
+	 * PipelineScheduler overlaps generators with the downstream stages consuming their states.
+	 * DemandScheduler parks stages whose output isn't needed downstream (yet).
+	 * CompiledScheduler follows the default order, but caches which stages have pending work.
+	 */
+	void setScheduler(const SchedulerPtr& scheduler);
+	const SchedulerPtr& scheduler() const;
+
+	/** Enable deadline-driven planning, granting each stage computation a share of the remaining time
+	 *
+	 * With a finite timeout(), planner calls of a stage computation are limited to the given share (0..1]
+	 * of the time remaining until the task's deadline and are cancelled when it expires.
+	 * Thus, a slow stage cannot consume the whole budget, and plan() returns the best solutions found in time.
+	 * Defaults to 0, i.e. planner timeouts are not adapted to the task's timeout.
+	 */
+	void setStageTimeShare(double share);
+	double stageTimeShare() const;
+
+	/** Enforce the timeout property of all compute stages by a watchdog thread
+	 *
+	 * A compute() call exceeding its stage's timeout is cancelled cooperatively (see solvers::PlannerCancellation)
+	 * and counted as a failure (see Stage::numTimeouts()). Calls that don't poll for cancellation are reported only.
+	 * Disabled by default. Takes effect with the next init().
+	 */
+	void setStageWatchdog(bool enable);
+	bool stageWatchdog() const;
+
+	/** Measure hardware performance counters (cycles, instructions, cache misses, context switches) of compute stages
+	 *
+	 * Counters are accumulated per stage (see Stage::hardwareCounters()), published with the stage statistics, and
+	 * attached to compute events of the trace (see setTraceFile()). They require Linux perf_event support and
+	 * permissions: if unavailable, they remain zero. Disabled by default. Takes effect with the next init().
+	 */
+	void setHardwareCounters(bool enable);
+	bool hardwareCounters() const;
+
+	/** Evaluate costs of the solutions created by a compute() call concurrently on the task's thread pool
+	 *
+	 * New solutions of compute stages are held back until the end of compute(), when their costs are computed
+	 * concurrently. Then, they are sent in their order of creation. Cost terms need to be thread-safe.
+	 * Disabled by default. Takes effect with the next init().
+	 */
+	void setConcurrentCosts(bool enable);
+	bool concurrentCosts() const;
+
+	/** Publish rolling statistics of plan() calls on /diagnostics (see PlanningDiagnostics)
+	 *
+	 * Publishing is limited to rate (Hz) and statistics cover the plan() calls of the last window seconds.
+	 * A rate <= 0 disables diagnostics.
+	 */
+	void enableDiagnostics(double rate = 1.0, double window = 60.0);
+	/// diagnostics instance, nullptr if disabled
+	const PlanningDiagnostics* diagnostics() const;
+
+	/** Report a compact summary of this task to the given aggregator, usually shared by many tasks
+	 *
+	 * The aggregator publishes the summaries of all its tasks on a single topic (see StatisticsAggregator).
+	 * nullptr disables reporting.
+	 */
+	void setStatisticsAggregator(const StatisticsAggregatorPtr& aggregator);
+	const StatisticsAggregatorPtr& statisticsAggregator() const;
+
+	/** Record solver results of all propagating stages, or replay them offline (see PlanRecording)
+	 *
+	 * When recording, plan() also records the scene spawned by the first generator as input scene.
+	 * nullptr (default) disables recording. Takes effect with the next init().
+	 */
+	void setPlanRecording(const PlanRecordingPtr& recording);
+	const PlanRecordingPtr& planRecording() const;
+
+	/** Save the computations performed so far, e.g. before interrupting a long-running plan
+	 *
+	 * Requires a plan recording in RECORD or RESUME mode. Throws std::runtime_error on failure.
+	 */
+	void checkpoint(const std::string& path);
+	/** Resume planning from a checkpoint with the next plan()
+	 *
+	 * Resets the task and installs a plan recording in RESUME mode: computations of propagating stages
+	 * recorded in the checkpoint return their results immediately, all others are computed and recorded,
+	 * such that further checkpoints comprise them too. Throws std::runtime_error if path cannot be read.
+	 */
+	void resume(const std::string& path);
+
+	/** Limit the depth of planning scene diff chains of all InterfaceStates
+	 *
+	 * Propagated states usually hold a diff of their predecessor's scene. Long pipelines thus build deep
+	 * diff chains slowing down scene queries. Scenes exceeding the given depth are flattened into a standalone copy.
+	 * Defaults to 0, i.e. unbounded.
+	 */
+	void setMaxSceneDiffDepth(size_t depth);
+	size_t maxSceneDiffDepth() const;
+
+	/** Configure storage of failed solutions, which are kept for introspection only
+	 *
+	 * Beyond max_failures (0 = unbounded) stored failures per stage, further failures are only counted.
+	 * Compact failures drop their trajectories, the planning scenes of states created only for them,
+	 * and all but a few markers, keeping creator, states, cost, and comment.
+	 * Defaults to unbounded, complete failures.
+	 */
+	void setFailureStorage(size_t max_failures, bool compact = true);
+	size_t maxStoredFailures() const;
+	bool compactFailures() const;
+
+	/** Drop near-duplicate top-level solutions, e.g. grasps differing by a single angle_delta step only
+	 *
+	 * Solutions are near-duplicates, if their end states are equivalent within tolerance
+	 * (see Stage::setDeduplicationTolerance()) and - for SolutionDistance::TRAJECTORY - if all their waypoints
+	 * deviate by at most tolerance per joint. Of several near-duplicates, only the cheapest one is kept,
+	 * the others are stored as failures and not published. Defaults to 0, i.e. disabled.
+	 */
+	void setSolutionDiversity(double tolerance, SolutionDistance distance = SolutionDistance::END_STATE);
+	double solutionDiversity() const;
+
+	/** Bound the approximate memory (see Stage::memoryUsage()) held by all stages during plan()
+	 *
+	 * When exceeded, scenes and trajectories of PRUNED states, which cannot become part of a solution anymore,
+	 * are evicted, starting with the lowest-priority ones. Their tombstones remain for introspection.
+	 * Defaults to 0, i.e. unbounded.
+	 */
+	void setMemoryBudget(size_t bytes);
+	size_t memoryBudget() const;
+
+	/** Evict scenes and trajectories of states PRUNED for longer than the given time during plan()
+	 *
+	 * Like with setMemoryBudget(), the tombstones of evicted states remain for introspection.
+	 * States are checked periodically, thus their age is measured from the first check seeing them pruned.
+	 * States re-enabled meanwhile are kept. Defaults to 0, i.e. disabled.
+	 */
+	void setPrunedStateExpiry(double seconds);
+	double prunedStateExpiry() const;
+
+	/** Order InterfaceStates A*-style, by accumulated cost plus an estimate of the remaining cost
+	 *
+	 * The heuristic is evaluated once per state entering a stage's interface. States propagated FORWARD
+	 * need to reach the task's end, BACKWARD ones its start, e.g. estimated by the joint-space distance
+	 * to the states of the opposite interface. To retain optimality, the estimate should not exceed the actual cost.
+	 * Connecting stages rank state pairs by the sum of both estimates. Empty by default.
+	 */
+	void setCostToGoHeuristic(const Interface::CostToGo& heuristic);
+	const Interface::CostToGo& costToGoHeuristic() const;
+
+	/** Branch-and-bound: prune states that cannot lead to a solution within slack of the best one found so far
+	 *
+	 * Once a solution with cost C is found, states whose accumulated cost plus the estimated cost-to-go
+	 * (see setCostToGoHeuristic()) exceeds C + slack are marked PRUNED. The bound tightens with every better solution.
+	 * This requires non-negative costs and an estimate not exceeding the actual cost.
+	 * Defaults to infinity, i.e. disabled. Takes effect with the next init().
+	 */
+	void setCostPruningSlack(double slack);
+	double costPruningSlack() const;
+
+	/** Beam search: keep at most width states ENABLED in the interfaces of each propagating stage
+	 *
+	 * Remaining states are parked as ARMED and re-enabled in priority order when states of the beam fail
+	 * (see Interface::setBeamWidth()). If planning runs out of enabled states, all beams are refilled,
+	 * so a solution is still found if one exists. Defaults to 0, i.e. unlimited. Takes effect with the next init().
+	 */
+	void setBeamWidth(size_t width);
+	size_t beamWidth() const;
+
+	/** Hand over new states to consuming stages via lock-free inboxes
+	 *
+	 * Producing stages only push new states onto their successors' inboxes. The successors' notify callbacks,
+	 * e.g. enumerating pairs in Connecting stages or propagating states into containers' children, are deferred
+	 * to the planning thread, which drains all inboxes before each iteration of plan().
+	 * Intended for multi-threaded planning (see setNumThreads()). Disabled by default.
+	 */
+	void setInterfaceInbox(bool enable);
+	bool interfaceInbox() const;
+
+	/** Record a timeline of planning events (see Tracer) during plan() and write it to the given file
+	 *
+	 * The Chrome trace JSON can be inspected with chrome://tracing or https://ui.perfetto.dev.
+	 * The tracer is shared process-wide, so only one task should trace at a time. An empty filename disables tracing.
+	 */
+	void setTraceFile(const std::string& filename);
+	const std::string& traceFile() const;
+
+	/** Record planning events (see EventLog) into a ring buffer keeping the given number of events
+	 *
+	 * Compute calls, new states, solutions, failures, and pruning are recorded with little overhead, such that the
+	 * log can stay enabled in production to analyze slow or failing plans after the fact.
+	 * The log is kept across reset() and plan() calls. 0 disables logging. Takes effect with the next init().
+	 */
+	void setEventLogCapacity(size_t capacity);
+	size_t eventLogCapacity() const;
+	/// the task's event log, e.g. to write() it on demand. nullptr if disabled.
+	EventLogPtr eventLog() const;
+	/// write the event log to the given file whenever plan() fails to find a solution, empty = never
+	void setEventLogFile(const std::string& filename);
+	const std::string& eventLogFile() const;
+
 	/// reset all stages
 	void reset() final;
+	/** Reset for another planning request with the same task structure
+	 *
+	 * Only per-request data (solutions, states, pending work) are cleared. Resolved interfaces, push connections,
+	 * initialized properties and solvers are kept, such that the next plan() doesn't need to init() again.
+	 * After modifying stages or their properties, a full reset() is required instead.
+	 */
+	void softReset();
 	/// initialize all stages with given scene
 	void init();
 
 	/// reset, init scene (if not yet done), and init all stages, then start planning
 	moveit::core::MoveItErrorCode plan(size_t max_solutions = 0);
+	/** Replan after a small change of the planning scene, e.g. a moved object
+	 *
+	 * scene_diff is applied to the generator(s) spawning the task's start state (see Generator::applySceneDiff()).
+	 * The solutions of all stages are validated against the world changes of scene_diff, which get applied
+	 * on top of the start scene of each sub trajectory. Solutions attaching, detaching, or moving a changed object
+	 * are invalid. Invalid solutions are moved to failures(): states they created are pruned,
+	 * while states they consumed are planned again by their stage. All other states and solutions are kept,
+	 * with their scenes updated to the changed world. Planning only continues if fewer than max_solutions remain
+	 * (or none if max_solutions is 0). If the robot state changed (i.e. scene_diff.robot_state is not an empty diff),
+	 * all states are affected and the task is reset and planned from scratch.
+	 */
+	moveit::core::MoveItErrorCode replan(const moveit_msgs::PlanningScene& scene_diff, size_t max_solutions = 0);
 	/// interrupt current planning
 	void preempt();
 	void resetPreemptRequest();
 	/// execute solution, return the result
 	moveit::core::MoveItErrorCode execute(const SolutionBase& s);
+	/// execute solution message, e.g. loaded via loadSolutions()
+	moveit::core::MoveItErrorCode execute(const moveit_task_constructor_msgs::Solution& solution);
+	/** execute solution in-process, e.g. within move_group, with the given executor
+	 *
+	 * The solution's trajectories are passed without any message conversion.
+	 * The solution needs to stay alive until execution finished.
+	 */
+	moveit::core::MoveItErrorCode execute(const SolutionBase& s, plan_execution::PlanExecution& executor);
+
+	/** Save (up to max_solutions) solutions to a compact binary file, see SolutionFile
+	 *
+	 * Throws std::runtime_error if the file cannot be written.
+	 */
+	void saveSolutions(const std::string& path, size_t max_solutions = 0) const;
+	/// memory-map a solution file written by saveSolutions(), allowing to replay solutions without planning
+	static SolutionFilePtr loadSolutions(const std::string& path);
+
+	/** Sub solutions all future solutions will start with
+	 *
+	 * Starting from the unique start state of a serial task, follow the sub trajectories of propagating stages,
+	 * which are unique for their start state. The prefix ends before the first stage of another kind,
+	 * e.g. a Connect stage, a generator, or a container, as these might yield alternatives later on.
+	 */
+	std::vector<const SolutionBase*> stablePrefix() const;
+
+	/** Plan and execute, starting execution of the stable prefix while planning continues
+	 *
+	 * As soon as stablePrefix() comprises a robot motion, it is sent for execution.
+	 * Once planning succeeded, the remainder of the best solution is executed after the prefix.
+	 */
+	moveit::core::MoveItErrorCode planAndExecute(size_t max_solutions = 0);
 
 	/// print current task state (number of found solutions and propagated states) to std::cout
 	void printState(std::ostream& os = std::cout) const;
@@ -142,6 +444,11 @@ public:
 	size_t numSolutions() const { return solutions().size(); }
 	const ordered<SolutionBaseConstPtr>& solutions() const { return stages()->solutions(); }
 	const std::list<SolutionBaseConstPtr>& failures() const { return stages()->failures(); }
+	/** Immutable snapshot of the top-level solutions, which can be read from other threads during plan()
+	 *
+	 * The snapshot keeps its solutions alive, but doesn't reflect later changes. nullptr before init().
+	 */
+	SolutionSnapshot solutionSnapshot() const { return stages()->solutionSnapshot(); }
 
 	/// publish all top-level solutions
 	void publishAllSolutions(bool wait = true);
@@ -0,0 +1,121 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Serialized description of a task's stage tree
+*/
+
+#pragma once
+
+#include <moveit/task_constructor/stage.h>
+
+#include <boost/any.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+class ContainerBase;
+class Task;
+
+/** Compact, binary description of a task: stage types, names, manually set properties, and hierarchy
+ *
+ * A description is captured from a configured task via describe() and instantiated again via build(),
+ * e.g. as the builder of a TaskTemplate: TaskTemplate([desc](Task& t) { desc.build(t); }).
+ * Stages are created by name from a registry of stage types. Containers and all default-constructible
+ * stages of this package are registered out of the box. Stages requiring constructor arguments
+ * (e.g. solvers of MoveTo or Connect) need a custom factory capturing them.
+ *
+ * Property values are decoded once upon load() and assigned to each new stage in a single pass.
+ * Only manually set values are described, not those initialized from a parent or the interface.
+ * Values of types without registered serializer (e.g. solvers or callbacks) are not described.
+ * If the described task was initialized, the propagation direction resolved for auto-directed
+ * stages is stored as well and restricted upon build(), pinning the result of interface resolution.
+ */
+class TaskDescription
+{
+public:
+	/// create a new stage of a registered type
+	using Factory = std::function<Stage::pointer()>;
+
+	/// register (or replace) the factory for the stage type with given name and C++ type
+	static void registerStageType(const std::string& type, const std::type_index& type_index, Factory factory);
+	template <typename T>
+	static void registerStageType(const std::string& type) {
+		registerStageType(type, typeid(T), [] { return std::make_unique<T>(); });
+	}
+
+	/// describe the stages of task, throws std::runtime_error for unregistered stage types
+	static TaskDescription describe(const Task& task);
+
+	/// write description to path, throws std::runtime_error on failure
+	void save(const std::string& path) const;
+	/// read description from path, throws std::runtime_error if it cannot be read or is corrupt
+	static TaskDescription load(const std::string& path);
+
+	/// populate an empty task with the described stages, throws std::runtime_error for unregistered stage types
+	void build(Task& task) const;
+
+	/// number of described stages (excluding the task itself)
+	size_t numStages() const { return nodes_.empty() ? 0 : nodes_.size() - 1; }
+
+private:
+	struct Value
+	{
+		std::string name;
+		std::string type;
+		std::string wire;
+		boost::any value;  // decoded wire
+	};
+	struct Node
+	{
+		std::string type;  // registered stage type, empty for the task's wrapped container
+		std::string name;
+		uint8_t direction;  // resolved PropagatingEitherWay::Direction
+		uint32_t num_children;
+		std::vector<Value> properties;
+	};
+
+	static void describe(const Stage& stage, const std::string& type, std::vector<Node>& nodes);
+	std::vector<Node>::const_iterator build(ContainerBase& container, std::vector<Node>::const_iterator node) const;
+
+	/// stages in pre-order, starting with the task itself
+	std::vector<Node> nodes_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
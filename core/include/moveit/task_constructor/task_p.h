@@ -40,6 +40,14 @@
 
 #include <moveit/task_constructor/container_p.h>
 #include <moveit/task_constructor/task.h>
+#include <moveit/task_constructor/thread_pool.h>
+#include <moveit/task_constructor/watchdog.h>
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
 
 namespace robot_model_loader {
 MOVEIT_CLASS_FORWARD(RobotModelLoader);
@@ -64,10 +72,84 @@ private:
 	robot_model_loader::RobotModelLoaderPtr robot_model_loader_;
 	moveit::core::RobotModelConstPtr robot_model_;
 	std::atomic<bool> preempt_requested_;
+	bool initialized_;  // init() succeeded since last reset()
+	bool reuse_structure_;  // softReset() was called: next plan() skips init()
+	PlanningDeadline planning_deadline_;  // deadline of the current plan() call and stage time share
+	bool stage_watchdog_;  // enforce stage timeouts
+	std::unique_ptr<Watchdog> watchdog_;  // created by init() if stage_watchdog_ is set
+	bool hardware_counters_;  // measure hardware counters of compute stages
+	bool concurrent_costs_;  // evaluate costs of new solutions concurrently
+	PlanningDiagnosticsPtr diagnostics_;  // rolling statistics of plan() calls, nullptr if disabled
+	StatisticsAggregatorPtr statistics_aggregator_;  // fleet-level summary, shared with other tasks
+	PlanRecordingPtr plan_recording_;  // record or replay solver results
+
+	/// record the scene spawned by the first generator as input scene of plan_recording_
+	void recordInputScene();
+
+	// multi-threaded planning
+	size_t num_threads_;
+	std::shared_ptr<ThreadPool> thread_pool_;
+	bool shared_thread_pool_;  // thread_pool_ was provided via setThreadPool()
+	ThreadPool::Options thread_options_;  // options of the task-owned thread pool
+	std::shared_ptr<ThreadPool> solver_pool_;  // pool for solver work, nullptr: use thread_pool_
+	std::recursive_mutex planning_mutex_;
+	std::shared_ptr<RecyclingPool> solution_pool_;  // memory pool for solutions of all stages
+	SchedulerPtr scheduler_;  // nullptr: traverse stage hierarchy
+
+	size_t max_scene_diff_depth_;
+	std::string trace_file_;  // file to write a timeline of plan() to
+	size_t event_log_capacity_;  // 0 = disabled
+	EventLogPtr event_log_;  // created by init() if event_log_capacity_ is set
+	std::string event_log_file_;  // file to write the event log to if plan() fails
+
+	/// write event_log_ to event_log_file_, if both are set
+	void writeEventLog() const;
+	size_t memory_budget_;  // bytes, 0 = unbounded
+	Interface::CostToGo cost_to_go_;  // A* heuristic for all interfaces
+	double cost_pruning_slack_;  // infinity: no branch-and-bound pruning
+	std::atomic<double> cost_bound_;  // best solution cost + slack
+	double pruned_cost_bound_;  // cost_bound_ as of the last pruneByCost()
+
+	/// mark enabled states of all stages PRUNED that exceed cost_bound_
+	void pruneByCost();
+	void resetCostBound() {
+		cost_bound_ = std::numeric_limits<double>::infinity();
+		pruned_cost_bound_ = std::numeric_limits<double>::infinity();
+	}
+	size_t beam_width_;  // 0: unlimited
+
+	/// refill the beams of all stages with parked states, returns true if any state was re-enabled
+	bool widenBeams();
+	bool interface_inbox_;  // defer state handoff via Interface inboxes
+
+	/// drain the interface inboxes of all stages until no more states are handed over
+	void drainInboxes();
+	/// lift pending solutions of the root pipeline, as many as needed to reach max_solutions (0 = all)
+	void liftPendingSolutions(size_t max_solutions);
+	size_t max_stored_failures_;  // per stage, 0 = unbounded
+	bool compact_failures_;
+	double solution_diversity_;  // tolerance to drop near-duplicate top-level solutions, 0 = disabled
+	SolutionDistance solution_distance_;
+
+	/// evict PRUNED states of all stages until the memory budget is met
+	void enforceMemoryBudget();
+	double pruned_state_expiry_;  // seconds, 0 = disabled
+	// first time each currently PRUNED, non-evicted state was seen by evictExpiredStates()
+	std::unordered_map<const InterfaceState*, std::chrono::steady_clock::time_point> pruned_since_;
+
+	/// evict PRUNED states of all stages that were pruned for longer than pruned_state_expiry_
+	void evictExpiredStates();
 
 	// introspection and monitoring
 	std::unique_ptr<Introspection> introspection_;
 	std::list<Task::TaskCallback> task_cbs_;  // functions to monitor task's planning progress
+	std::list<std::weak_ptr<SolutionStream>> solution_streams_;  // consumers of new solutions
+	std::mutex solution_streams_mutex_;
+
+	/// push solution to all solution streams
+	void streamSolution(const SolutionBase& solution);
+	/// close and forget all solution streams
+	void closeSolutionStreams();
 };
 PIMPL_FUNCTIONS(Task)
 }  // namespace task_constructor
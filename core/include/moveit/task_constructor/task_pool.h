@@ -0,0 +1,118 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Pool planning several tasks concurrently, sharing robot model and threads
+*/
+
+#pragma once
+
+#include <moveit/task_constructor/task.h>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+/** Plan several tasks concurrently, e.g. for several work cells served by a single planning server
+ *
+ * Expensive resources are shared between all tasks:
+ * - the robot model (loaded once), and thus cached planning pipelines and merged JointModelGroups
+ * - an optional thread pool used for the multi-threaded planning of all tasks
+ *
+ * Submitted tasks are planned by num_planners planner threads in FIFO order.
+ * Jobs of concurrent tasks are interleaved fairly in the shared thread pool's FIFO queue,
+ * such that a large task cannot starve smaller ones.
+ * Submitted tasks must stay alive until their planning finished.
+ */
+class TaskPool
+{
+public:
+	/** Create a pool planning up to num_planners tasks concurrently
+	 *
+	 * If robot_model is nullptr, it is loaded from robot_description once.
+	 * With num_workers > 0, all tasks share a thread pool of this size for multi-threaded planning.
+	 */
+	TaskPool(size_t num_planners, size_t num_workers = 0, const moveit::core::RobotModelConstPtr& robot_model = nullptr,
+	         const std::string& robot_description = "robot_description");
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+	/// preempt and wait for all running tasks, tasks still queued are not planned anymore
+	~TaskPool();
+
+	/** Queue a task for planning
+	 *
+	 * The task is configured to use the shared robot model and thread pool.
+	 * The returned future yields the result of task.plan(max_solutions).
+	 */
+	std::future<moveit::core::MoveItErrorCode> submit(const TaskPtr& task, size_t max_solutions = 0);
+
+	/// submit all tasks and wait for their results
+	std::vector<moveit::core::MoveItErrorCode> planAll(const std::vector<TaskPtr>& tasks, size_t max_solutions = 0);
+
+	/// preempt all running tasks and discard queued ones
+	void preempt();
+
+	/// number of queued or running tasks
+	size_t pending() const;
+
+	const moveit::core::RobotModelConstPtr& getRobotModel() const { return robot_model_; }
+
+private:
+	struct Entry
+	{
+		TaskPtr task;
+		size_t max_solutions;
+		std::promise<moveit::core::MoveItErrorCode> result;
+	};
+
+	void plannerLoop();
+
+	moveit::core::RobotModelConstPtr robot_model_;
+	std::shared_ptr<ThreadPool> thread_pool_;  // shared by all tasks, nullptr: single-threaded tasks
+
+	std::vector<std::thread> planners_;
+	std::deque<Entry> queue_;
+	std::vector<TaskPtr> running_;
+	mutable std::mutex mutex_;
+	std::condition_variable cond_;
+	bool stop_ = false;
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,94 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Template to quickly instantiate structurally identical tasks
+*/
+
+#pragma once
+
+#include <moveit/task_constructor/task.h>
+
+#include <boost/any.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+/** Template to instantiate many structurally identical tasks, differing in property values only
+ *
+ * The stage tree is described by a builder function, which is called for each new instance.
+ * Immutable, expensive pieces are shared between all instances: the robot model (loaded once),
+ * solvers captured by the builder, planning pipelines, and merged JointModelGroups (which are cached anyway).
+ * Per-instance differences are given as property overrides, addressing stages by their path.
+ */
+class TaskTemplate
+{
+public:
+	/// populate the given task with stages
+	using Builder = std::function<void(Task& task)>;
+
+	/// value overriding a property of the stage at the given path (empty path: task itself)
+	struct Override
+	{
+		std::string stage;
+		std::string property;
+		boost::any value;
+	};
+	using Overrides = std::vector<Override>;
+
+	/** Create a template from a builder
+	 *
+	 * If robot_model is nullptr, it is loaded from robot_description once, upon the first instantiation.
+	 */
+	TaskTemplate(Builder builder, const moveit::core::RobotModelConstPtr& robot_model = nullptr,
+	             const std::string& ns = "", bool introspection = true);
+
+	/** Instantiate a new task named name, applying the given property overrides
+	 *
+	 * Throws std::runtime_error for unknown stage paths and Property::error for invalid property overrides.
+	 */
+	Task instantiate(const std::string& name, const Overrides& overrides = {});
+
+	const moveit::core::RobotModelConstPtr& getRobotModel() const { return robot_model_; }
+
+private:
+	Builder builder_;
+	moveit::core::RobotModelConstPtr robot_model_;
+	std::string ns_;
+	bool introspection_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
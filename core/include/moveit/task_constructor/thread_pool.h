@@ -0,0 +1,132 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Pool of worker threads used to run stage computations concurrently
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+/** Simple pool of worker threads processing batches of jobs
+ *
+ * Jobs are submitted as a batch via run(), which blocks until all jobs of this batch are finished.
+ * While waiting, the calling thread helps processing queued jobs of its own batch. Thus, nested calls
+ * to run() (e.g. from nested containers) cannot deadlock, even if all workers are busy.
+ * Jobs of other batches are never picked up, as the caller might hold locks or be in the middle of a
+ * computation, which unrelated jobs must not interfere with.
+ */
+class ThreadPool
+{
+public:
+	using Job = std::function<void()>;
+
+	/** Placement and scheduling of the worker threads (Linux only)
+	 *
+	 * The calling thread helping in run() is not affected.
+	 * Settings that cannot be applied (e.g. due to missing permissions) are reported as warnings.
+	 */
+	struct Options
+	{
+		enum Policy
+		{
+			DEFAULT,  // SCHED_OTHER
+			BATCH,  // SCHED_BATCH: CPU-bound work, preempting interactive threads less often
+			IDLE,  // SCHED_IDLE: only run on otherwise idle CPUs
+		};
+
+		/// restrict workers to these CPUs, e.g. to keep them off the cores of real-time threads. Empty: all CPUs.
+		std::vector<unsigned int> cpus;
+		/// pin worker i to cpus[i % cpus.size()], keeping its caches warm, instead of letting it migrate among cpus
+		bool pin = false;
+		Policy policy = DEFAULT;
+		/// nice value of the workers (DEFAULT and BATCH policy), higher values yield to other threads
+		int nice = 0;
+
+		bool operator==(const Options& other) const {
+			return cpus == other.cpus && pin == other.pin && policy == other.policy && nice == other.nice;
+		}
+		bool operator!=(const Options& other) const { return !(*this == other); }
+	};
+
+	/// create a pool with given number of worker threads (in addition to the calling thread)
+	explicit ThreadPool(size_t num_workers) : ThreadPool(num_workers, Options()) {}
+	ThreadPool(size_t num_workers, const Options& options);
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	/// number of worker threads
+	size_t size() const { return workers_.size(); }
+	const Options& options() const { return options_; }
+
+	/** run all jobs concurrently and wait for their completion
+	 *
+	 * If any job throws, the first captured exception is rethrown after all jobs finished.
+	 */
+	void run(std::vector<Job>&& jobs);
+
+private:
+	struct Batch
+	{
+		size_t pending = 0;  // number of unfinished jobs
+		std::exception_ptr error;  // first exception thrown by any job
+	};
+	using QueueItem = std::pair<Job, std::shared_ptr<Batch>>;
+
+	void workerLoop(size_t index);
+	/// apply options_ to the calling worker thread
+	void configureWorker(size_t index) const;
+	// remove and execute given job of queue_, lock must be held upon call (and is held again on return)
+	void execute(std::unique_lock<std::mutex>& lock, std::deque<QueueItem>::iterator it);
+
+	const Options options_;
+	std::vector<std::thread> workers_;
+	std::deque<QueueItem> queue_;
+	std::mutex mutex_;
+	std::condition_variable cond_;  // signals new jobs, finished batches, or stop request
+	bool stop_ = false;
+};
+}  // namespace task_constructor
+}  // namespace moveit
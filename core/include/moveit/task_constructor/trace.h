@@ -0,0 +1,110 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Opt-in recording of a planning timeline in Chrome trace format
+*/
+
+#pragma once
+
+#include <moveit/task_constructor/perf_counters.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace moveit {
+namespace task_constructor {
+
+class Stage;
+
+/** Recorder of timeline events, e.g. stage computations and planner calls, of all threads
+ *
+ * Recording is disabled by default and has negligible overhead then.
+ * Recorded events can be written as Chrome trace JSON, which can be viewed with chrome://tracing or Perfetto.
+ */
+class Tracer
+{
+public:
+	/// process-wide tracer instance
+	static Tracer& instance();
+
+	/// start recording, discarding previously recorded events
+	void start();
+	/// stop recording, keeping recorded events
+	void stop();
+	bool enabled() const;
+
+	/// write recorded events as Chrome trace JSON
+	void write(std::ostream& os) const;
+	/// write recorded events to file, returns false on failure
+	bool write(const std::string& filename) const;
+
+	/// RAII helper recording a complete event for its lifetime, optionally tagged with a stage
+	class Scope
+	{
+	public:
+		Scope(const char* name, const char* category, const Stage* stage = nullptr);
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		/// attach hardware counters measured within this scope to the event
+		void setCounters(const PerfCounterValues& counters) {
+			counters_ = counters;
+			has_counters_ = true;
+		}
+
+	private:
+		const char* name_;
+		const char* category_;
+		const Stage* stage_;
+		bool active_;
+		bool has_counters_ = false;
+		PerfCounterValues counters_;
+		std::chrono::steady_clock::time_point begin_;
+	};
+
+private:
+	Tracer();
+	~Tracer();
+	void record(const char* name, const char* category, const Stage* stage,
+	            std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end,
+	            const PerfCounterValues* counters = nullptr);
+
+	class Impl;
+	Impl* impl_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,99 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Watchdog thread enforcing time budgets of stage computations
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace moveit {
+namespace task_constructor {
+
+/** Single thread tracking the deadlines of running computations
+ *
+ * When a watched computation exceeds its deadline, the watchdog sets its expiry flag, which can be
+ * polled via a solvers::PlannerCancellation, and logs the overrun. Cancellation is cooperative:
+ * computations that never poll (e.g. a hanging IK plugin) keep running, but are reported.
+ */
+class Watchdog
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	Watchdog();
+	Watchdog(const Watchdog&) = delete;
+	Watchdog& operator=(const Watchdog&) = delete;
+	~Watchdog();
+
+	/// registration of a computation for the duration of its lifetime
+	class Scope
+	{
+	public:
+		/// watch a computation named name until the deadline (nullptr watchdog: no-op)
+		Scope(Watchdog* watchdog, Clock::time_point deadline, const std::string& name);
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+
+		/// flag set by the watchdog when the deadline has passed
+		const std::atomic<bool>& expired() const { return expired_; }
+
+	private:
+		Watchdog* watchdog_;
+		std::multimap<Clock::time_point, Scope*>::iterator entry_;
+		std::string name_;
+		std::atomic<bool> expired_{ false };
+
+		friend class Watchdog;
+	};
+
+private:
+	void loop();
+
+	std::multimap<Clock::time_point, Scope*> deadlines_;  // watched computations, earliest first
+	std::mutex mutex_;
+	std::condition_variable cond_;  // signals new earliest deadline or stop request
+	bool stop_ = false;
+	std::thread thread_;
+};
+}  // namespace task_constructor
+}  // namespace moveit
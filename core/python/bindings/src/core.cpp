@@ -36,14 +36,26 @@
 #include "utils.h"
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+#include <pybind11/eigen.h>
 #include <moveit/python/task_constructor/properties.h>
 #include <moveit/task_constructor/container_p.h>
+#include <moveit/task_constructor/robot_model_cache.h>
 #include <moveit/task_constructor/task.h>
 
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_state/conversions.h>
 #include <moveit/planning_scene_interface/planning_scene_interface.h>
 #include <moveit/move_group_interface/move_group_interface.h>
 
+#include <ros/serialization.h>
+
+#include <map>
+#include <mutex>
+#include <thread>
+
 namespace py = pybind11;
 using namespace py::literals;
 using namespace moveit::task_constructor;
@@ -53,6 +65,38 @@ namespace python {
 
 namespace {
 
+/** Run fn in a detached C++ thread (without holding the GIL) and pass its outcome to done(result, error)
+ *
+ * owner is kept alive until done was called. Used by the asyncio wrappers of the Python module.
+ */
+template <typename Result>
+void runDetached(py::object owner, std::function<Result()> fn, py::function done) {
+	std::thread([owner = std::move(owner), fn = std::move(fn), done = std::move(done)]() mutable {
+		Result result{};
+		std::string error;
+		try {
+			result = fn();
+		} catch (const std::exception& e) {
+			error = e.what();
+			if (error.empty())
+				error = "unknown error";
+		}
+
+		py::gil_scoped_acquire gil;
+		try {
+			if (error.empty())
+				done(py::cast(result), py::none());
+			else
+				done(py::none(), py::str(error));
+		} catch (py::error_already_set& e) {
+			e.discard_as_unraisable("moveit.task_constructor async callback");
+		}
+		// release Python objects while holding the GIL
+		owner = py::object();
+		done = py::function();
+	}).detach();
+}
+
 py::list getForwardedProperties(const Stage& self) {
 	py::list l;
 	for (const std::string& value : self.forwardedProperties())
@@ -76,6 +120,283 @@ void setForwardedProperties(Stage& self, const py::object& names) {
 	self.setForwardedProperties(s);
 }
 
+using Trajectories = std::vector<const robot_trajectory::RobotTrajectory*>;
+
+// collect the (non-empty) trajectories of a solution in temporal order
+void collectTrajectories(const SolutionBase& solution, Trajectories& result) {
+	if (const auto* sub = dynamic_cast<const SubTrajectory*>(&solution)) {
+		sub->finalizeTimeParameterization();  // timestamps are required
+		if (sub->trajectory() && !sub->trajectory()->empty())
+			result.push_back(sub->trajectory().get());
+	} else if (const auto* seq = dynamic_cast<const SolutionSequence*>(&solution)) {
+		for (const SolutionBase* s : seq->solutions())
+			collectTrajectories(*s, result);
+	} else if (const auto* wrapped = dynamic_cast<const WrappedSolution*>(&solution))
+		collectTrajectories(*wrapped->innermost(), result);
+}
+
+const moveit::core::JointModelGroup* findGroup(const Trajectories& trajectories, const std::string& group) {
+	if (group.empty() || trajectories.empty())
+		return nullptr;
+	const moveit::core::JointModelGroup* jmg = trajectories.front()->getRobotModel()->getJointModelGroup(group);
+	if (!jmg)
+		throw py::value_error("Unknown joint model group: " + group);
+	return jmg;
+}
+
+// joint positions of all waypoints as a (waypoints x variables) array, copied once from the trajectories
+py::array_t<double> positions(const SolutionBase& self, const std::string& group) {
+	Trajectories trajectories;
+	collectTrajectories(self, trajectories);
+	const moveit::core::JointModelGroup* jmg = findGroup(trajectories, group);
+
+	size_t rows = 0;
+	for (const auto* t : trajectories)
+		rows += t->getWayPointCount();
+	size_t cols = jmg ? jmg->getVariableCount() :
+	                    trajectories.empty() ? 0 : trajectories.front()->getRobotModel()->getVariableCount();
+
+	py::array_t<double> result({ rows, cols });
+	double* data = result.mutable_data();
+	for (const auto* t : trajectories) {
+		for (size_t i = 0, end = t->getWayPointCount(); i != end; ++i, data += cols) {
+			const moveit::core::RobotState& state = t->getWayPoint(i);
+			if (jmg)
+				state.copyJointGroupPositions(jmg, data);
+			else
+				std::copy_n(state.getVariablePositions(), cols, data);
+		}
+	}
+	return result;
+}
+
+// time from start of each waypoint, accumulated across all trajectories
+py::array_t<double> times(const SolutionBase& self) {
+	Trajectories trajectories;
+	collectTrajectories(self, trajectories);
+
+	size_t rows = 0;
+	for (const auto* t : trajectories)
+		rows += t->getWayPointCount();
+
+	py::array_t<double> result(rows);
+	double* data = result.mutable_data();
+	double offset = 0.0;
+	for (const auto* t : trajectories) {
+		for (size_t i = 0, end = t->getWayPointCount(); i != end; ++i)
+			*data++ = (offset += t->getWayPointDurationFromPrevious(i));
+	}
+	return result;
+}
+
+std::vector<std::string> variableNames(const SolutionBase& self, const std::string& group) {
+	Trajectories trajectories;
+	collectTrajectories(self, trajectories);
+	if (const moveit::core::JointModelGroup* jmg = findGroup(trajectories, group))
+		return jmg->getVariableNames();
+	return trajectories.empty() ? std::vector<std::string>() :
+	                              trajectories.front()->getRobotModel()->getVariableNames();
+}
+
+/* Pickling support: InterfaceStates and solutions are encoded in binary via ros::serialization.
+   Robot models are not pickled, but looked up by name when unpickling: among the models pickled
+   before in this process (also inherited by forked workers) or loaded from robot_description. */
+constexpr uint8_t PICKLE_VERSION = 1;
+
+std::mutex pickled_models_mutex;
+std::map<std::string, std::weak_ptr<const moveit::core::RobotModel>> pickled_models;
+
+void rememberModel(const moveit::core::RobotModelConstPtr& model) {
+	std::lock_guard<std::mutex> lock(pickled_models_mutex);
+	pickled_models[model->getName()] = model;
+}
+
+moveit::core::RobotModelConstPtr findModel(const std::string& name) {
+	{
+		std::lock_guard<std::mutex> lock(pickled_models_mutex);
+		auto it = pickled_models.find(name);
+		if (it != pickled_models.end())
+			if (auto model = it->second.lock())
+				return model;
+	}
+	auto loader = RobotModelCache::load();
+	if (loader && loader->getModel() && loader->getModel()->getName() == name) {
+		rememberModel(loader->getModel());
+		return loader->getModel();
+	}
+	throw std::runtime_error("Cannot unpickle: unknown robot model '" + name + "'");
+}
+
+template <typename T>
+void append(const T& value, std::string& buffer) {
+	const uint32_t length = ros::serialization::serializationLength(value);
+	const size_t offset = buffer.size();
+	buffer.resize(offset + length);
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[offset]), length);
+	ros::serialization::serialize(stream, value);
+}
+
+void encodeState(const InterfaceState& state, std::string& buffer) {
+	const auto& model = state.scene()->getRobotModel();
+	rememberModel(model);
+	append(model->getName(), buffer);
+
+	moveit_msgs::PlanningScene scene;
+	state.scene()->getPlanningSceneMsg(scene);
+	append(scene, buffer);
+
+	std::vector<std::string> properties;  // triples of name, type, and encoded value
+	for (const auto& pair : state.properties()) {
+		const boost::any& value = pair.second.value();
+		if (value.empty())
+			continue;
+		properties.insert(properties.end(), { pair.first, pair.second.typeName(), Property::encode(value) });
+	}
+	append(properties, buffer);
+}
+
+std::unique_ptr<InterfaceState> decodeState(ros::serialization::IStream& stream) {
+	std::string model_name;
+	ros::serialization::deserialize(stream, model_name);
+	moveit_msgs::PlanningScene msg;
+	ros::serialization::deserialize(stream, msg);
+	std::vector<std::string> properties;
+	ros::serialization::deserialize(stream, properties);
+
+	auto scene = std::make_shared<planning_scene::PlanningScene>(findModel(model_name));
+	scene->setPlanningSceneMsg(msg);
+	auto state = std::make_unique<InterfaceState>(scene);
+	for (size_t i = 0; i + 2 < properties.size(); i += 3) {
+		boost::any value = Property::decode(properties[i + 1], properties[i + 2]);
+		if (!value.empty())
+			state->properties().set(properties[i], value);
+	}
+	return state;
+}
+
+py::bytes pickleState(const InterfaceState& self) {
+	std::string buffer;
+	append(PICKLE_VERSION, buffer);
+	encodeState(self, buffer);
+	return py::bytes(buffer);
+}
+
+std::unique_ptr<InterfaceState> unpickleState(const py::bytes& data) {
+	std::string buffer = data;
+	try {
+		ros::serialization::IStream stream(reinterpret_cast<uint8_t*>(&buffer[0]), buffer.size());
+		uint8_t version;
+		ros::serialization::deserialize(stream, version);
+		if (version != PICKLE_VERSION)
+			throw std::runtime_error("Cannot unpickle InterfaceState: unsupported version");
+		return decodeState(stream);
+	} catch (const ros::Exception& e) {
+		throw std::runtime_error(std::string("Cannot unpickle InterfaceState: ") + e.what());
+	}
+}
+
+// SubTrajectory restored from a pickled solution, owning its start and end states
+class DetachedSubTrajectory : public SubTrajectory
+{
+	std::unique_ptr<InterfaceState> start_state_;
+	std::unique_ptr<InterfaceState> end_state_;
+
+public:
+	DetachedSubTrajectory(const robot_trajectory::RobotTrajectoryConstPtr& trajectory, double cost, std::string comment,
+	                      std::unique_ptr<InterfaceState> start, std::unique_ptr<InterfaceState> end)
+	  : SubTrajectory(trajectory, cost, std::move(comment)), start_state_(std::move(start)), end_state_(std::move(end)) {
+		if (start_state_)
+			setStartState(*start_state_);
+		if (end_state_)
+			setEndState(*end_state_);
+	}
+};
+
+/* Solutions are pickled as a single SubTrajectory: the trajectories of sequences are concatenated.
+   Start and end states are included, markers and the creating stage are not. */
+py::tuple reduceSolution(const SolutionBase& self) {
+	std::string buffer;
+	append(PICKLE_VERSION, buffer);
+	append(self.cost(), buffer);
+	append(self.comment(), buffer);
+	for (const InterfaceState* state : { self.start(), self.end() }) {
+		append(static_cast<uint8_t>(state != nullptr), buffer);
+		if (state)
+			encodeState(*state, buffer);
+	}
+
+	Trajectories trajectories;
+	collectTrajectories(self, trajectories);
+	append(static_cast<uint8_t>(!trajectories.empty()), buffer);
+	if (!trajectories.empty()) {
+		const robot_trajectory::RobotTrajectory* trajectory = trajectories.front();
+		robot_trajectory::RobotTrajectory concatenated(trajectory->getRobotModel(),
+		                                                static_cast<const moveit::core::JointModelGroup*>(nullptr));
+		if (trajectories.size() > 1) {
+			for (const auto* t : trajectories)
+				concatenated.append(*t, t->getWayPointDurationFromPrevious(0));
+			trajectory = &concatenated;
+		}
+		rememberModel(trajectory->getRobotModel());
+		append(trajectory->getRobotModel()->getName(), buffer);
+		append(trajectory->getGroupName(), buffer);
+		moveit_msgs::RobotState reference;
+		moveit::core::robotStateToRobotStateMsg(trajectory->getFirstWayPoint(), reference);
+		append(reference, buffer);
+		moveit_msgs::RobotTrajectory msg;
+		trajectory->getRobotTrajectoryMsg(msg);
+		append(msg, buffer);
+	}
+	return py::make_tuple(py::module::import("pymoveit_mtc").attr("core").attr("_unpickleSolution"),
+	                      py::make_tuple(py::bytes(buffer)));
+}
+
+std::shared_ptr<SubTrajectory> unpickleSolution(const py::bytes& data) {
+	std::string buffer = data;
+	try {
+		ros::serialization::IStream stream(reinterpret_cast<uint8_t*>(&buffer[0]), buffer.size());
+		uint8_t version;
+		ros::serialization::deserialize(stream, version);
+		if (version != PICKLE_VERSION)
+			throw std::runtime_error("Cannot unpickle Solution: unsupported version");
+		double cost;
+		std::string comment;
+		ros::serialization::deserialize(stream, cost);
+		ros::serialization::deserialize(stream, comment);
+		std::unique_ptr<InterfaceState> states[2];
+		for (auto& state : states) {
+			uint8_t present;
+			ros::serialization::deserialize(stream, present);
+			if (present)
+				state = decodeState(stream);
+		}
+
+		robot_trajectory::RobotTrajectoryPtr trajectory;
+		uint8_t has_trajectory;
+		ros::serialization::deserialize(stream, has_trajectory);
+		if (has_trajectory) {
+			std::string model_name, group;
+			moveit_msgs::RobotState reference_msg;
+			moveit_msgs::RobotTrajectory msg;
+			ros::serialization::deserialize(stream, model_name);
+			ros::serialization::deserialize(stream, group);
+			ros::serialization::deserialize(stream, reference_msg);
+			ros::serialization::deserialize(stream, msg);
+
+			auto model = findModel(model_name);
+			moveit::core::RobotState reference(model);
+			reference.setToDefaultValues();
+			moveit::core::robotStateMsgToRobotState(reference_msg, reference);
+			trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(model, group);
+			trajectory->setRobotTrajectoryMsg(reference, msg);
+		}
+		return std::make_shared<DetachedSubTrajectory>(trajectory, cost, std::move(comment), std::move(states[0]),
+		                                               std::move(states[1]));
+	} catch (const ros::Exception& e) {
+		throw std::runtime_error(std::string("Cannot unpickle Solution: ") + e.what());
+	}
+}
+
 }  // anonymous namespace
 
 void export_core(pybind11::module& m) {
@@ -114,7 +435,18 @@ void export_core(pybind11::module& m) {
 		        self.toMsg(msg);
 		        return msg;
 	        },
-	        "Convert to the ROS message ``Solution``");
+	        "Convert to the ROS message ``Solution``")
+	    .def("positions", &positions, "group"_a = std::string(), R"(
+			Joint positions of all waypoints as a NumPy array of shape (waypoints, variables).
+			For sequences, the waypoints of all sub trajectories are concatenated.
+			If ``group`` is given, only the variables of that joint model group are returned.)")
+	    .def("times", &times, "Time from start of all waypoints as a NumPy array")
+	    .def("variableNames", &variableNames, "group"_a = std::string(),
+	         "Names of the variables (columns) returned by ``positions()``")
+	    .def("__reduce__", &reduceSolution, R"(
+			Pickle as a ``SubTrajectory``, comprising cost, comment, start and end states, and the
+			(concatenated) trajectory. Robot models are looked up by name when unpickling.)");
+	m.def("_unpickleSolution", &unpickleSolution, "data"_a);
 
 	py::classh<SubTrajectory, SolutionBase>(m, "SubTrajectory",
 	                                        "Solution trajectory connecting two InterfaceStates of a stage")
@@ -130,6 +462,37 @@ void export_core(pybind11::module& m) {
 	        "__iter__", [](Solutions& self) { return py::make_iterator(self.begin(), self.end()); },
 	        py::keep_alive<0, 1>());
 
+	py::classh<SolutionStream>(m, "SolutionStream", "Queue yielding solutions of a planning task as soon as they are found")
+	    .def("next", &SolutionStream::next, "timeout"_a = std::numeric_limits<double>::infinity(),
+	         py::call_guard<py::gil_scoped_release>(), R"(
+			Wait (up to ``timeout`` seconds) for the next solution.
+			Returns ``None`` if the timeout expired or the stream was closed and drained.)")
+	    .def(
+	        "_forwardDetached",
+	        [](const py::object& self, py::function callback) {
+		        auto stream = self.cast<SolutionStreamPtr>();
+		        std::thread([self, stream, callback = std::move(callback)]() mutable {
+			        // pass all solutions, followed by None when the stream is closed and drained
+			        for (;;) {
+				        SolutionBaseConstPtr solution = stream->next();
+				        py::gil_scoped_acquire gil;
+				        try {
+					        callback(solution ? py::cast(solution) : py::none());
+				        } catch (py::error_already_set& e) {
+					        e.discard_as_unraisable("moveit.task_constructor SolutionStream callback");
+				        }
+				        if (!solution) {
+					        self = py::object();
+					        callback = py::function();
+					        return;
+				        }
+			        }
+		        }).detach();
+	        },
+	        "callback"_a, "Pass solutions to ``callback`` from a C++ thread, used by ``Task.solutionsAsync()``")
+	    .def_property_readonly("closed", &SolutionStream::closed, "bool: True if planning finished (read-only)")
+	    .def("__len__", &SolutionStream::size);
+
 	py::classh<InterfaceState>(m, "InterfaceState",
 	                           "Describes a potential start or goal state of a Stage. "
 	                           "It comprises a PlanningScene as well as a PropertyMap.")
@@ -137,7 +500,8 @@ void export_core(pybind11::module& m) {
 	    .def_property_readonly("properties", py::overload_cast<>(&InterfaceState::properties),
 	                           "PropertyMap: PropertyMap of the state (read-only).")
 	    .def_property_readonly("scene", &InterfaceState::scene,
-	                           "PlanningScene: PlanningScene of the state (read-only).");
+	                           "PlanningScene: PlanningScene of the state (read-only).")
+	    .def(py::pickle(&pickleState, &unpickleState));
 
 	py::classh<moveit::core::MoveItErrorCode>(m, "MoveItErrorCode", "Encapsulates moveit error code message")
 	    .def_readonly("val", &moveit::core::MoveItErrorCode::val, ":moveit_msgs:`MoveItErrorCodes`: error code")
@@ -172,12 +536,56 @@ void export_core(pybind11::module& m) {
 
 	py::classh<cost::Clearance, TrajectoryCostTerm>(m, "Clearance", "Computes inverse distance to collision objects")
 	    .def(py::init<bool, bool, std::string, TrajectoryCostTerm::Mode>(), "with_world"_a = true,
-	         "cumulative"_a = false, "group_property"_a = "group", "mode"_a = TrajectoryCostTerm::Mode::AUTO);
+	         "cumulative"_a = false, "group_property"_a = "group", "mode"_a = TrajectoryCostTerm::Mode::AUTO)
+	    .def_property(
+	        "waypoint_stride", [](const cost::Clearance& self) { return self.waypoint_stride; },
+	        [](cost::Clearance& self, size_t stride) {
+		        self.waypoint_stride = stride;
+		        self.modified();
+	        },
+	        "int: check every k-th waypoint only, refining around the minimum");
+	py::classh<cost::Composite, TrajectoryCostTerm>(
+	    m, "Composite", "Weighted sum of cost terms, evaluated in a single pass over the trajectory's waypoints")
+	    .def(py::init<>())
+	    .def(
+	        "add",
+	        [](cost::Composite& self, const CostTermConstPtr& term, double weight) { self.add(term, weight); },
+	        "term"_a, "weight"_a = 1.0, "Add a cost term with given weight");
+
+	py::classh<WaypointCostTerm, TrajectoryCostTerm>(m, "WaypointCostTerm", R"(
+			Computes costs from all waypoints of a trajectory in a single call of ``term(positions, times)``,
+			passing a (waypoints x variables) array of joint positions and an array of times from start.
+			``term`` returns the cost or a tuple (cost, comment).)")
+	    .def(py::init([](const py::function& term, const std::string& group) {
+		         // planning runs without the GIL: reacquire it for calling and releasing the Python function
+		         std::shared_ptr<py::function> fn(new py::function(term), [](py::function* f) {
+			         py::gil_scoped_acquire gil;
+			         delete f;
+		         });
+		         return std::make_shared<WaypointCostTerm>(
+		             [fn](const WaypointCostTerm::Matrix& positions, const Eigen::VectorXd& times, std::string& comment) {
+			             py::gil_scoped_acquire gil;
+			             py::object result = (*fn)(positions, times);
+			             if (py::isinstance<py::tuple>(result)) {
+				             auto t = result.cast<py::tuple>();
+				             comment = t[1].cast<std::string>();
+				             return t[0].cast<double>();
+			             }
+			             return result.cast<double>();
+		             },
+		             group);
+	         }),
+	         "term"_a, "group"_a = std::string());
 
 	auto stage =
 	    properties::class_<Stage, PyStage<>>(m, "Stage", "Abstract base class of all stages.")
 	        .property<double>("timeout", "float: Maximally allowed time [s] per computation step")
 	        .property<std::string>("marker_ns", "str: Namespace for any markers that are associated to the stage")
+	        .property<uint32_t>("max_stored_solutions", "int: Maximal number of stored solutions (0 = unbounded)")
+	        .property<double>("compression_joint_tolerance",
+	                          "float: Max joint deviation of waypoints dropped when publishing or executing (0 = off)")
+	        .property<double>("compression_cartesian_tolerance",
+	                          "float: Max tip deviation of waypoints dropped when publishing or executing (0 = off)")
 	        .def_property("forwarded_properties", getForwardedProperties, setForwardedProperties,
 	                      "list: set of properties forwarded from input to output InterfaceState")
 	        .def_property("name", &Stage::name, &Stage::setName, "str: name of the stage displayed e.g. in rviz")
@@ -185,6 +593,22 @@ void export_core(pybind11::module& m) {
 	                               "PropertyMap: PropertyMap of the stage (read-only)")
 	        .def_property_readonly("solutions", &Stage::solutions, "Successful Solutions of the stage (read-only)")
 	        .def_property_readonly("failures", &Stage::failures, "Solutions: Failed Solutions of the stage (read-only)")
+	        .def_property_readonly("failure_counts", &Stage::failureCounts,
+	                               "dict: number of failures per comment, also counting those not stored (read-only)")
+	        .def_property_readonly("num_timeouts", &Stage::numTimeouts,
+	                               "int: number of computations cancelled for exceeding the timeout (read-only)")
+	        .def_property_readonly(
+	            "hardware_counters",
+	            [](const Stage& self) {
+		            const PerfCounterValues& c = self.hardwareCounters();
+		            py::dict result;
+		            result["cycles"] = c.cycles;
+		            result["instructions"] = c.instructions;
+		            result["cache_misses"] = c.cache_misses;
+		            result["context_switches"] = c.context_switches;
+		            return result;
+	            },
+	            "dict: hardware counters accumulated over computations (read-only)")
 	        .def<void (Stage::*)(const CostTermConstPtr&)>("setCostTerm", &Stage::setCostTerm,
 	                                                       "Specify a CostTerm for calculation of stage costs")
 	        .def(
@@ -313,6 +737,9 @@ void export_core(pybind11::module& m) {
 			)")
 	    .def(py::init<const std::string&>(), "name"_a = std::string("generator"))
 	    .def("setMonitoredStage", &MonitoringGenerator::setMonitoredStage, "Set the monitored ``Stage``", "stage"_a)
+	    .def("setBatchedMonitoring", &MonitoringGenerator::setBatchedMonitoring,
+	         "Buffer monitored solutions and pass them to ``onNewSolution()`` right before the next ``compute()``",
+	         "batched"_a)
 	    .def("_onNewSolution", &PubMonitoringGenerator::onNewSolution);
 
 	py::classh<ContainerBase, Stage>(m, "ContainerBase", R"(
@@ -462,11 +889,54 @@ void export_core(pybind11::module& m) {
 	        "setCostTerm", [](Task& self, const LambdaCostTerm::SubTrajectoryShortSignature& f) { self.setCostTerm(f); },
 	        "Specify a function to calculate trajectory costs")
 	    .def("reset", &Task::reset, "Reset task (and all its stages)")
+	    .def("softReset", &Task::softReset,
+	         "Clear solutions for another planning request, keeping the initialized task structure")
 	    .def("init", py::overload_cast<>(&Task::init), "Initialize the task (and all its stages)")
-	    .def("plan", &Task::plan, "max_solutions"_a = 0, R"(
+	    .def_property("num_threads", &Task::numThreads, &Task::setNumThreads,
+	                  "int: number of threads used for planning (1 = sequential)")
+	    .def("streamSolutions", &Task::streamSolutions,
+	     "Create a ``SolutionStream`` yielding solutions of the next ``plan()`` call as soon as they are found")
+	    .def_property("stage_time_share", &Task::stageTimeShare, &Task::setStageTimeShare,
+	                  "float: share of the remaining time granted to each stage computation (0 = disabled)")
+	    .def_property("stage_watchdog", &Task::stageWatchdog, &Task::setStageWatchdog,
+	                  "bool: cancel stage computations exceeding their timeout")
+	    .def_property("hardware_counters", &Task::hardwareCounters, &Task::setHardwareCounters,
+	                  "bool: measure hardware performance counters of stage computations")
+	    .def_property("concurrent_costs", &Task::concurrentCosts, &Task::setConcurrentCosts,
+	                  "bool: evaluate costs of new solutions concurrently on the thread pool")
+	    .def("enableDiagnostics", &Task::enableDiagnostics, "rate"_a = 1.0, "window"_a = 60.0,
+	         "Publish rolling planning statistics on /diagnostics (rate <= 0 disables)")
+	    // Planning and execution don't touch Python objects except from within Python-defined stages
+	    // and cost terms, whose trampolines and function wrappers reacquire the GIL themselves.
+	    // Releasing it here allows other Python threads (and worker threads) to run meanwhile.
+	    .def("plan", &Task::plan, "max_solutions"_a = 0, py::call_guard<py::gil_scoped_release>(), R"(
 			Reset, init, and plan. Planning is limited to ``max_allowed_solutions``.
 			Returns if planning was successful.)")
+	    .def("planAndExecute", &Task::planAndExecute, "max_solutions"_a = 0,
+	         py::call_guard<py::gil_scoped_release>(), R"(
+			Plan and execute the best solution, starting execution of the stable solution prefix
+			while planning continues. Returns the execution result.)")
+	    .def(
+	        "_planDetached",
+	        [](const py::object& self, size_t max_solutions, py::function done) {
+		        Task* task = self.cast<Task*>();
+		        runDetached<moveit::core::MoveItErrorCode>(
+		            self, [task, max_solutions] { return task->plan(max_solutions); }, std::move(done));
+	        },
+	        "max_solutions"_a, "done"_a, "Plan in a C++ thread, calling ``done(result, error)``. Use ``planAsync()``.")
+	    .def(
+	        "_executeDetached",
+	        [](const py::object& self, const SolutionBasePtr& solution, py::function done) {
+		        Task* task = self.cast<Task*>();
+		        runDetached<moveit::core::MoveItErrorCode>(
+		            self, [task, solution] { return task->execute(*solution); }, std::move(done));
+	        },
+	        "solution"_a, "done"_a,
+	        "Execute in a C++ thread, calling ``done(result, error)``. Use ``executeAsync()``.")
 	    .def("preempt", &Task::preempt, "Interrupt current planning (or execution)")
+	    .def("publishAllSolutions", &Task::publishAllSolutions, "wait"_a = true,
+	         py::call_guard<py::gil_scoped_release>(),
+	         "Publish all solutions, optionally waiting for the user to continue")
 	    .def(
 	        "publish",
 	        [](Task& self, const SolutionBasePtr& solution) { self.introspection().publishSolution(*solution); },
@@ -494,7 +964,7 @@ void export_core(pybind11::module& m) {
 		        }
 		        ROS_INFO("Executed successfully");
 	        },
-	        "solution"_a, "Send given solution to ``move_group`` node for execution");
+	        "solution"_a, py::call_guard<py::gil_scoped_release>(), "Send given solution to ``move_group`` node for execution");
 }
 }  // namespace python
 }  // namespace moveit
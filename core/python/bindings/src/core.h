@@ -38,6 +38,7 @@
 #include <moveit/task_constructor/container.h>
 #include <moveit/task_constructor/cost_queue.h>
 #include <moveit/task_constructor/cost_terms.h>
+#include <moveit/task_constructor/solution_stream.h>
 #include <moveit/utils/moveit_error_code.h>
 #include <pybind11/smart_holder.h>
 
@@ -51,6 +52,48 @@ namespace solvers {
 class PlannerInterface;
 }
 
+/** Python override of a pure virtual method, resolved upon the first call and reused afterwards
+ *
+ * PYBIND11_OVERRIDE_PURE looks up the override (creating a bound method) on every call.
+ * Hot methods, called for every compute() of a stage, cache the unbound override function instead.
+ * Reassigning the method of an instance or its class after the first call is not noticed.
+ */
+class CachedOverride
+{
+	pybind11::handle self_;  // borrowed: the Python instance outlives its C++ trampoline
+	pybind11::object function_;
+
+public:
+	CachedOverride() = default;
+	CachedOverride(const CachedOverride&) = delete;
+	CachedOverride& operator=(const CachedOverride&) = delete;
+	~CachedOverride() {
+		if (function_) {
+			pybind11::gil_scoped_acquire gil;
+			function_ = pybind11::object();
+		}
+	}
+
+	template <typename Return, typename Base, typename... Args>
+	Return call(const Base* self, const char* name, Args&&... args) {
+		pybind11::gil_scoped_acquire gil;
+		if (!function_) {
+			pybind11::function override = pybind11::get_override(self, name);
+			if (!override)
+				pybind11::pybind11_fail("Tried to call pure virtual function \"" +
+				                        pybind11::type_id<Base>() + "::" + name + "\"");
+			if (PyMethod_Check(override.ptr())) {  // keep unbound function only: no reference cycle via self
+				self_ = PyMethod_GET_SELF(override.ptr());
+				function_ = pybind11::reinterpret_borrow<pybind11::object>(PyMethod_GET_FUNCTION(override.ptr()));
+			} else
+				function_ = std::move(override);
+		}
+		pybind11::object result =
+		    self_ ? function_(self_, std::forward<Args>(args)...) : function_(std::forward<Args>(args)...);
+		return pybind11::detail::cast_safe<Return>(std::move(result));
+	}
+};
+
 template <class Stage = moveit::task_constructor::Stage>
 class PyStage : public Stage, public pybind11::trampoline_self_life_support
 {
@@ -68,8 +111,14 @@ class PyGenerator : public PyStage<Generator>
 {
 public:
 	using PyStage<Generator>::PyStage;
-	bool canCompute() const override { PYBIND11_OVERRIDE_PURE(bool, Generator, canCompute, ); }
-	void compute() override { PYBIND11_OVERRIDE_PURE(void, Generator, compute, ); }
+	bool canCompute() const override {
+		return can_compute_.call<bool>(static_cast<const Generator*>(this), "canCompute");
+	}
+	void compute() override { compute_.call<void>(static_cast<const Generator*>(this), "compute"); }
+
+private:
+	mutable CachedOverride can_compute_;
+	CachedOverride compute_;
 };
 
 template <class MonitoringGenerator = moveit::task_constructor::MonitoringGenerator>
@@ -79,8 +128,11 @@ public:
 	using PyGenerator<MonitoringGenerator>::PyGenerator;
 	void onNewSolution(const SolutionBase& s) override {
 		// pass solution as pointer to trigger passing by reference
-		PYBIND11_OVERRIDE_PURE(void, MonitoringGenerator, onNewSolution, &s);
+		on_new_solution_.call<void>(static_cast<const MonitoringGenerator*>(this), "onNewSolution", &s);
 	}
+
+private:
+	CachedOverride on_new_solution_;
 };
 
 // Helper class to expose protected member function onNewSolution
@@ -98,12 +150,16 @@ public:
 	using PyStage<PropagatingEitherWay>::PyStage;
 	void computeForward(const InterfaceState& from_state) override {
 		// pass InterfaceState as pointer to trigger passing by reference
-		PYBIND11_OVERRIDE_PURE(void, PropagatingEitherWay, computeForward, &from_state);
+		compute_forward_.call<void>(static_cast<const PropagatingEitherWay*>(this), "computeForward", &from_state);
 	}
 	void computeBackward(const InterfaceState& to_state) override {
 		// pass InterfaceState as pointer to trigger passing by reference
-		PYBIND11_OVERRIDE_PURE(void, PropagatingEitherWay, computeBackward, &to_state);
+		compute_backward_.call<void>(static_cast<const PropagatingEitherWay*>(this), "computeBackward", &to_state);
 	}
+
+private:
+	CachedOverride compute_forward_;
+	CachedOverride compute_backward_;
 };
 
 }  // namespace task_constructor
@@ -114,6 +170,7 @@ PYBIND11_SMART_HOLDER_TYPE_CASTERS(moveit::task_constructor::solvers::PlannerInt
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(moveit::task_constructor::SolutionBase)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(moveit::task_constructor::SubTrajectory)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(ordered<moveit::task_constructor::SolutionBaseConstPtr>)
+PYBIND11_SMART_HOLDER_TYPE_CASTERS(moveit::task_constructor::SolutionStream)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(moveit::task_constructor::InterfaceState)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(moveit::core::MoveItErrorCode)
 
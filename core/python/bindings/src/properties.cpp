@@ -194,6 +194,30 @@ void export_properties(py::module& m) {
 		.def("__setitem__", [](PropertyMap& self, const std::string& key, const py::object& value)
 		     { self.set(key, PropertyConverterRegistry::fromPython(value)); })
 		.def("reset", &PropertyMap::reset, "Reset all properties to their default values")
+		.def("snapshot", [](const PropertyMap& self, const py::list& names) {
+				// convert all values in a single call, e.g. once per compute() of a Python stage
+				py::dict result;
+				if (names.empty()) {  // all defined properties having a Python conversion
+					for (const auto& pair : self) {
+						const boost::any& value = pair.second.value();
+						if (value.empty())
+							continue;
+						try {
+							result[py::str(pair.first)] = PropertyConverterRegistry::toPython(value);
+						} catch (const py::type_error&) {
+						}
+					}
+				} else {
+					for (auto& item : names) {
+						std::string key = item.cast<std::string>();
+						result[py::str(key)] = PropertyConverterRegistry::toPython(self.get(key));
+					}
+				}
+				return result;
+			}, R"(
+			Retrieve the values of listed (or all convertible, defined) properties as a dict.
+			This is cheaper than repeated ``map[key]`` lookups, e.g. in compute() of a Python stage.)",
+			"names"_a = py::list())
 		.def("update", [](PropertyMap& self, const py::dict& values) {
 				for (auto it = values.begin(), end = values.end(); it != end; ++it) {
 					self.set(it->first.cast<std::string>(),
@@ -60,6 +60,8 @@ void export_solvers(py::module& m) {
 	    .property<double>("max_velocity_scaling_factor", "float: Reduce the maximum velocity by scaling between (0,1]")
 	    .property<double>("max_acceleration_scaling_factor",
 	                      "float: Reduce the maximum acceleration by scaling between (0,1]")
+	    .property<bool>("defer_time_parameterization",
+	                    "bool: Keep trajectories path-only until their solution is published or executed")
 	    .def_property_readonly("properties", py::overload_cast<>(&PlannerInterface::properties),
 	                           py::return_value_policy::reference_internal, "Properties of the planner");
 
@@ -84,6 +86,7 @@ void export_solvers(py::module& m) {
 	    .property<double>("goal_orientation_tolerance", "float: Tolerance for reaching orientation goals")
 	    .property<bool>("display_motion_plans", "bool: Publish generated solutions via a topic")
 	    .property<bool>("publish_planning_requests", "bool: Publish motion planning requests via a topic")
+	    .property<uint>("max_pipelines", "int: Max number of pipeline instances serving concurrent requests")
 	    .def(py::init<const std::string&>(), "pipeline"_a = std::string("ompl"));
 
 	properties::class_<JointInterpolationPlanner, PlannerInterface>(
@@ -98,6 +101,8 @@ void export_solvers(py::module& m) {
 				jointPlanner.max_step = 0.1
 		)")
 	    .property<double>("max_step", "float: Limit any (single) joint change between two waypoints to this amount")
+	    .property<bool>("bisection", "bool: Validate waypoints in bisection order to detect collisions early")
+	    .property<uint32_t>("collision_batch_size", "int: Number of waypoints collision-checked in a single batch")
 	    .def(py::init<>());
 
 	const moveit::core::CartesianPrecision default_precision;
@@ -130,6 +135,8 @@ void export_solvers(py::module& m) {
 	    .property<double>("step_size", "float: Limit the Cartesian displacement between consecutive waypoints "
 	                                   "In contrast to joint-space interpolation, the Cartesian planner can also "
 	                                   "succeed when only a fraction of the linear path was feasible.")
+	    .property<double>("max_step_size", "float: If larger than step_size, adapt the step size within this range "
+	                                       "to the achieved precision, taking large steps on well-conditioned segments.")
 	    .property<moveit::core::CartesianPrecision>("precision", "Cartesian interpolation precision")
 	    .property<double>("min_fraction", "float: Fraction of overall distance required to succeed.")
 	    .def(py::init<>());
@@ -153,6 +160,14 @@ void export_solvers(py::module& m) {
 	        "Insert one or more planners")
 	    .def(
 	        "clear", [](MultiPlanner& self) { self.clear(); }, "Remove all planners")
+	    .def_property(
+	        "racing", &MultiPlanner::racing,
+	        [](MultiPlanner& self, bool racing) { self.setRacing(racing, self.gracePeriod()); },
+	        "bool: Run all planners concurrently, returning the first success")
+	    .def_property(
+	        "grace_period", &MultiPlanner::gracePeriod,
+	        [](MultiPlanner& self, double grace_period) { self.setRacing(self.racing(), grace_period); },
+	        "float: In racing mode, wait this long (s) after the first success for shorter trajectories")
 	    .def(py::init<>());
 }
 }  // namespace python
@@ -51,11 +51,13 @@ PYBIND11_SMART_HOLDER_TYPE_CASTERS(ModifyPlanningScene)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(CurrentState)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(FixedState)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(ComputeIK)
+PYBIND11_SMART_HOLDER_TYPE_CASTERS(RemoteStage)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(MoveTo)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(MoveRelative)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(Connect)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(FixCollisionObjects)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(GenerateGraspPose)
+PYBIND11_SMART_HOLDER_TYPE_CASTERS(GenerateGraspPoseFromDatabase)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(GeneratePlacePose)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(GeneratePose)
 PYBIND11_SMART_HOLDER_TYPE_CASTERS(Pick)
@@ -192,6 +194,18 @@ void export_stages(pybind11::module& m) {
 			kinematic solutions thats should be generated.
 		)")
 	    .property<uint32_t>("max_ik_solutions", "uint: max number of solutions to return")
+	    .property<uint32_t>("seed_cache_size", R"(
+			int: Number of previous IK solutions kept
+			to seed IK of nearby targets (0 disables caching).
+		)")
+	    .property<uint32_t>("max_batch_size", R"(
+			int: Maximum number of upstream solutions processed
+			(concurrently in multi-threaded planning) per compute() call.
+		)")
+	    .property<bool>("diverse_seeds", R"(
+			bool: Spread IK seeds over the group's joint space
+			and search them concurrently (if max_ik_solutions > 1).
+		)")
 	    .property<bool>("ignore_collisions", R"(
 			bool: Specify if collisions with other members of
 			the planning scene are allowed.
@@ -218,6 +232,15 @@ void export_stages(pybind11::module& m) {
 	    // methods of base class py::class_ need to be called last!
 	    .def(py::init<const std::string&, Stage::pointer&&>(), "name"_a, "stage"_a);
 
+	properties::class_<RemoteStage, Stage>(m, "RemoteStage", R"(
+			Wrapper computing its propagating or connecting child stage on remote worker nodes.
+			Incoming interface states are sent in batches via the ``ComputeStage`` action
+			to workers running an equivalently configured stage.
+		)")
+	    .property<std::vector<std::string>>("workers", "list: Action names of worker nodes")
+	    .property<uint32_t>("batch_size", "int: Max number of inputs sent in a single goal")
+	    .def(py::init<const std::string&, Stage::pointer&&>(), "name"_a, "stage"_a);
+
 	properties::class_<MoveTo, PropagatingEitherWay, PyMoveTo<>>(m, "MoveTo", R"(
 			Compute a trajectory between the robot state from the
 			interface state of the preceeding stage and a specified
@@ -347,6 +370,9 @@ void export_stages(pybind11::module& m) {
 	    .property<double>("max_penetration", R"(
 			float: Cutoff length up to which collision objects get fixed.
 		)")
+	    .property<bool>("single_pass", R"(
+			bool: Correct all objects from a single collision query, verifying the result once.
+		)")
 	    .def(py::init<const std::string&>(), "name"_a = std::string("fix collisions"));
 
 	properties::class_<GeneratePlacePose, MonitoringGenerator>(m, "GeneratePlacePose", R"(
@@ -367,6 +393,12 @@ void export_stages(pybind11::module& m) {
 
 			.. _PoseStamped: https://docs.ros.org/en/api/geometry_msgs/html/msg/PoseStamped.html
 		)")
+		.property<uint32_t>("sample_count", R"(
+			int: Number of placements additionally sampled around each nominal one (0 disables batch sampling).
+			Sampled placements colliding with the world are rejected, the others are sorted by clearance.
+		)")
+		.property<double>("sample_radius", "float: Radius of the horizontal disc placements are sampled from")
+		.property<double>("clearance", "float: Desired horizontal clearance of sampled placements to world objects")
 		.def(py::init<const std::string&>(), "name"_a = std::string("Generate Place Pose"));
 
 
@@ -385,11 +417,24 @@ void export_stages(pybind11::module& m) {
 		)")
 	    .property<std::string>("pregrasp", "str: Name of the pre-grasp pose")
 	    .property<std::string>("grasp", "str: Name of the grasp pose")
+	    .property<double>("max_reach", "float: Reject objects farther away from the arm's base (0 = disabled)")
+	    .property<bool>("generate_markers", "bool: Generate markers for grasp candidates")
 	    .property<double>("angle_delta", R"(
 			float: Angular step distance in rad with which positions around the object are sampled.
 		)")
 	    .def(py::init<const std::string&>(), "name"_a = std::string("Generate Grasp Pose"));
 
+	properties::class_<GenerateGraspPoseFromDatabase, GenerateGraspPose>(m, "GenerateGraspPoseFromDatabase", R"(
+			Spawns grasps from a precomputed grasp database, which are known to be reachable for
+			object poses close to the current one. Each grasp carries its recorded IK solution
+			as ``ik_seed``, which is tried first by a subsequent ComputeIK stage.
+		)")
+	    .property<std::string>("database", "str: Path of the grasp database of the object's type")
+	    .property<double>("max_distance", "float: Max position distance (m) to a recorded object pose")
+	    .property<double>("max_angle", "float: Max orientation distance (rad) to a recorded object pose")
+	    .property<uint32_t>("max_candidates", "int: Max number of closest grasps spawned (0 = unlimited)")
+	    .def(py::init<const std::string&>(), "name"_a = std::string("Generate Grasp Pose From Database"));
+
 	properties::class_<GeneratePose, MonitoringGenerator>(m, "GeneratePose", R"(
 			Monitoring generator stage which can be used to generate a pose, based on solutions provided
 			by the monitored stage.
@@ -429,6 +474,7 @@ void export_stages(pybind11::module& m) {
 	    .property<std::string>("eef_frame", "str: Name of the end effector frame")
 	    .property<std::string>("eef_group", "str: Joint model group of the end effector")
 	    .property<std::string>("eef_parent_group", "str: Joint model group of the eef's parent")
+	    .property<bool>("parallel_motions", "bool: Plan approach and lift motions concurrently")
 	    .def(py::init<Stage::pointer&&, const std::string&>(), "grasp_generator"_a,
 	         "name"_a = std::string("pick"))
 	    .def("setApproachMotion", &Pick::setApproachMotion, R"(
@@ -472,6 +518,7 @@ void export_stages(pybind11::module& m) {
 	    .property<std::string>("eef_frame", "str: Name of the end effector frame")
 	    .property<std::string>("eef_group", "str: Joint model group of the end effector")
 	    .property<std::string>("eef_parent_group", "str: Joint model group of the eef's parent")
+	    .property<bool>("parallel_motions", "bool: Plan retract and place motions concurrently")
     	.def("setRetractMotion", &Place::setRetractMotion, R"(
 			The retract motion towards the final state is represented
 			by a Twist_ message. Additionally specify the minimum and
@@ -1,3 +1,59 @@
 from pymoveit_mtc.core import *
+import asyncio as _asyncio
 
 __doc__ = "Provides wrappers for :doc:`core C++ classes <pymoveit_mtc.core>`."
+
+
+def _resolve(future, result, error):
+    if future.cancelled():
+        return
+    if error is not None:
+        future.set_exception(RuntimeError(error))
+    else:
+        future.set_result(result)
+
+
+async def _runDetached(start, *args):
+    """Run start(*args, done) - calling done(result, error) from a C++ thread - as an awaitable"""
+    loop = _asyncio.get_running_loop()
+    future = loop.create_future()
+    start(*args, lambda result, error: loop.call_soon_threadsafe(_resolve, future, result, error))
+    return await future
+
+
+async def _planAsync(self, max_solutions=0):
+    """Awaitable variant of ``plan()``, planning in a C++ thread without blocking the event loop"""
+    return await _runDetached(self._planDetached, max_solutions)
+
+
+async def _executeAsync(self, solution):
+    """Awaitable variant of executing ``solution``, returning a ``MoveItErrorCode``"""
+    return await _runDetached(self._executeDetached, solution)
+
+
+async def _solutionsAsync(self, max_solutions=0):
+    """Plan in a C++ thread, asynchronously yielding solutions as soon as they are found
+
+    Leaving the iteration early preempts planning.
+    """
+    loop = _asyncio.get_running_loop()
+    queue = _asyncio.Queue()
+    stream = self.streamSolutions()
+    stream._forwardDetached(lambda solution: loop.call_soon_threadsafe(queue.put_nowait, solution))
+    planning = _asyncio.ensure_future(self.planAsync(max_solutions))
+    try:
+        while True:
+            solution = await queue.get()
+            if solution is None:
+                break
+            yield solution
+        await planning  # propagate planning errors
+    finally:
+        if not planning.done():
+            self.preempt()
+            await _asyncio.wait([planning])
+
+
+Task.planAsync = _planAsync
+Task.executeAsync = _executeAsync
+Task.solutionsAsync = _solutionsAsync
@@ -0,0 +1,180 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""Measure the overhead of crossing between Python and C++ in the MTC bindings.
+
+Requires a robot_description on the parameter server, e.g. provided by:
+    roslaunch moveit_resources_fanuc_moveit_config test_environment.launch
+Then run:
+    rosrun moveit_task_constructor_core benchmark_bindings.py [--scale 0.1]
+"""
+
+import argparse
+import timeit
+from py_binding_tools import roscpp_init
+from moveit.task_constructor import core, stages
+from moveit.core.planning_scene import PlanningScene
+from geometry_msgs.msg import PoseStamped
+
+
+class PyGenerator(core.Generator):
+    """Mockup generator spawning a fixed number of states with increasing cost."""
+
+    def __init__(self, num, name="generator"):
+        core.Generator.__init__(self, name)
+        self.num_solutions = num
+        self.reset()
+
+    def init(self, robot_model):
+        self.ps = PlanningScene(robot_model)
+
+    def reset(self):
+        core.Generator.reset(self)
+        self.remaining = self.num_solutions
+
+    def canCompute(self):
+        return self.remaining > 0
+
+    def compute(self):
+        self.remaining -= 1
+        self.spawn(core.InterfaceState(self.ps), self.remaining)
+
+
+class PyMonitoringGenerator(core.MonitoringGenerator):
+    """Mockup generator spawning a state for each solution of the monitored stage."""
+
+    def __init__(self, name="monitoring generator"):
+        core.MonitoringGenerator.__init__(self, name)
+        self.reset()
+
+    def reset(self):
+        core.MonitoringGenerator.reset(self)
+        self.pending = []
+
+    def onNewSolution(self, sol):
+        self.pending.append(sol)
+
+    def canCompute(self):
+        return bool(self.pending)
+
+    def compute(self):
+        self.spawn(core.InterfaceState(self.pending.pop().end.scene), 0.0)
+
+
+class Benchmark:
+    def __init__(self, scale, repeat):
+        self.scale = scale
+        self.repeat = repeat
+
+    def run(self, name, stmt, number, items=1):
+        """Report the best time of stmt() per item over repeated runs."""
+        number = max(1, int(number * self.scale))
+        best = min(timeit.repeat(stmt, number=number, repeat=self.repeat))
+        print(f"{name:<40} {1e6 * best / (number * items):10.3f} us/item")
+
+    def task(self, *children):
+        task = core.Task()
+        task.enableIntrospection(False)
+        task.loadRobotModel()
+        task.add(*children)
+        return task
+
+    def plan(self, name, task, num):
+        """Report planning time per solution, reusing the task's initialized structure."""
+        task.plan()
+
+        def replan():
+            task.softReset()
+            task.plan()
+
+        self.run(name, replan, 10, num)
+
+    def construction(self):
+        def construct():
+            self.task(
+                stages.CurrentState(), stages.ModifyPlanningScene(), stages.ModifyPlanningScene()
+            )
+
+        self.run("task construction (3 stages)", construct, 100)
+
+    def properties(self):
+        props = core.PropertyMap()
+        pose = PoseStamped()
+        props["double"] = 0.0
+        props["string"] = ""
+        props["pose"] = pose
+
+        def assign(name, value):
+            props[name] = value
+
+        self.run("property set (float)", lambda: assign("double", 3.14), 100000)
+        self.run("property get (float)", lambda: props["double"], 100000)
+        self.run("property set (str)", lambda: assign("string", "anything"), 100000)
+        self.run("property get (str)", lambda: props["string"], 100000)
+        self.run("property set (PoseStamped)", lambda: assign("pose", pose), 10000)
+        self.run("property get (PoseStamped)", lambda: props["pose"], 10000)
+
+        stage = stages.ModifyPlanningScene()
+
+        def set_timeout():
+            stage.timeout = 1.0
+
+        self.run("stage property set (attribute)", set_timeout, 100000)
+        self.run("stage property get (attribute)", lambda: stage.timeout, 100000)
+
+    def trampolines(self):
+        num = 1000
+        # each solution requires a canCompute() and a compute() call into Python
+        self.plan("Generator trampolines (per solution)", self.task(PyGenerator(num)), num)
+
+        task = self.task(PyGenerator(num, "current"), PyMonitoringGenerator())
+        task["monitoring generator"].setMonitoredStage(task["current"])
+        self.plan("MonitoringGenerator (per solution)", task, num)
+
+    def cost_terms(self):
+        num = 1000
+        reference = self.task(PyGenerator(num), stages.ModifyPlanningScene())
+        self.plan("plan without cost term (per solution)", reference, num)
+
+        forward = stages.ModifyPlanningScene()
+        forward.setCostTerm(lambda sub: 1.0)
+        task = self.task(PyGenerator(num), forward)
+        self.plan("plan with LambdaCostTerm (per solution)", task, num)
+
+    def solutions(self):
+        num = 1000
+        task = self.task(PyGenerator(num), stages.ModifyPlanningScene())
+        task.plan()
+        solutions = task.solutions
+
+        def iterate():
+            for s in solutions:
+                s.cost
+
+        self.run("solution list access", lambda: task.solutions, 10000)
+        self.run("solution iteration (per solution)", iterate, 100, num)
+        self.run("solution indexing", lambda: solutions[0], 100000)
+        self.run("solution end state scene", lambda: solutions[0].end.scene, 10000)
+        self.run("Solution.toMsg()", lambda: solutions[0].toMsg(), 1000)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter
+    )
+    parser.add_argument("--scale", type=float, default=1.0, help="scale number of iterations")
+    parser.add_argument(
+        "--repeat", type=int, default=3, help="number of repetitions, best is reported"
+    )
+    parser.add_argument(
+        "benchmarks",
+        nargs="*",
+        default=["construction", "properties", "trampolines", "cost_terms", "solutions"],
+        help="benchmarks to run (default: all)",
+    )
+    args = parser.parse_args()
+
+    roscpp_init("benchmark_bindings")
+    benchmark = Benchmark(args.scale, args.repeat)
+    for name in args.benchmarks:
+        getattr(benchmark, name)()
@@ -1,5 +1,7 @@
 #! /usr/bin/env python3
 
+import asyncio
+import pickle
 import unittest
 import rostest
 from py_binding_tools import roscpp_init
@@ -32,6 +34,42 @@ class Test(unittest.TestCase):
         self.assertEqual(len(task.solutions), 1)
         task.execute(task.solutions[0])
 
+    def test_SolutionArrays(self):
+        moveTo = stages.MoveTo("moveTo", core.JointInterpolationPlanner())
+        moveTo.group = self.PLANNING_GROUP
+        moveTo.setGoal("all-zeros")
+
+        task = core.Task()
+        task.add(stages.CurrentState("current"), moveTo)
+        self.assertTrue(task.plan())
+
+        solution = task.solutions[0]
+        positions = solution.positions(self.PLANNING_GROUP)
+        times = solution.times()
+        names = solution.variableNames(self.PLANNING_GROUP)
+        self.assertEqual(positions.shape, (len(times), len(names)))
+        self.assertTrue((times[1:] >= times[:-1]).all())
+        self.assertTrue((abs(positions[-1]) < 1e-6).all())  # all-zeros goal
+        self.assertEqual(len(solution.toMsg().sub_trajectory), 2)
+
+    def test_Pickle(self):
+        moveTo = stages.MoveTo("moveTo", core.JointInterpolationPlanner())
+        moveTo.group = self.PLANNING_GROUP
+        moveTo.setGoal("all-zeros")
+
+        task = core.Task()
+        task.add(stages.CurrentState("current"), moveTo)
+        self.assertTrue(task.plan())
+
+        solution = task.solutions[0]
+        copy = pickle.loads(pickle.dumps(solution))
+        self.assertIsInstance(copy, core.SubTrajectory)
+        self.assertEqual(copy.cost, solution.cost)
+        self.assertTrue((copy.positions() == solution.positions()).all())
+
+        state = pickle.loads(pickle.dumps(solution.end))
+        self.assertIsNotNone(state.scene)
+
     def test_Merger(self):
         cartesian = core.CartesianPath()
 
@@ -55,6 +93,53 @@ class Test(unittest.TestCase):
         task.init()
         self.assertFalse(task.plan())
 
+    def _createAlternativesTask(self, deltas):
+        task = core.Task()
+        task.add(stages.CurrentState("current"))
+        alternatives = core.Alternatives("alternatives")
+        for delta in deltas:
+            moveRel = stages.MoveRelative("moveRel {}".format(delta), core.JointInterpolationPlanner())
+            moveRel.group = self.PLANNING_GROUP
+            moveRel.setDirection({"joint_1": delta})
+            alternatives.insert(moveRel)
+        task.add(alternatives)
+        return task
+
+    def test_PlanAsync(self):
+        # a single event loop plans several tasks concurrently
+        tasks = [self._createAlternativesTask([0.1]), self._createAlternativesTask([0.1, 0.2])]
+
+        async def planAll():
+            return await asyncio.gather(*(task.planAsync() for task in tasks))
+
+        self.assertTrue(all(asyncio.run(planAll())))
+        self.assertEqual([len(task.solutions) for task in tasks], [1, 2])
+
+        # errors of the planning thread are raised by the awaitable
+        moveTo = stages.MoveTo("moveTo", core.JointInterpolationPlanner())  # lacking a group
+        task = core.Task()
+        task.add(stages.CurrentState("current"), moveTo)
+        with self.assertRaises(RuntimeError):
+            asyncio.run(task.planAsync())
+
+    def test_SolutionsAsync(self):
+        async def collect(task, limit=None):
+            solutions = []
+            async for solution in task.solutionsAsync():
+                solutions.append(solution)
+                if len(solutions) == limit:
+                    break
+            return solutions
+
+        task = self._createAlternativesTask([0.1, 0.2, 0.3])
+        solutions = asyncio.run(collect(task))
+        self.assertEqual(len(solutions), 3)
+        self.assertEqual(sorted(s.cost for s in solutions), sorted(s.cost for s in task.solutions))
+
+        # leaving the iteration early preempts and waits for planning
+        task = self._createAlternativesTask([0.1, 0.2, 0.3])
+        self.assertEqual(len(asyncio.run(collect(task, limit=1))), 1)
+
 
 if __name__ == "__main__":
     rostest.rosrun("mtc", "base", Test)
@@ -120,6 +120,13 @@ class TestTrampolines(unittest.TestCase):
         task = self.create(PyGenerator())
         self.plan(task, expected_solutions=PyGenerator.max_calls)
 
+    @unittest.skipIf(len(pybind11_versions()) > 1, incompatible_pybind11_msg)
+    def test_generator_threaded(self):
+        # planning releases the GIL, Python stages need to reacquire it from worker threads
+        task = self.create(PyGenerator())
+        task.num_threads = 2
+        self.plan(task, expected_solutions=PyGenerator.max_calls)
+
     @unittest.skipIf(len(pybind11_versions()) > 1, incompatible_pybind11_msg)
     def test_monitoring_generator(self):
         task = self.create(
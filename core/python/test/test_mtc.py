@@ -72,6 +72,12 @@ class TestPropertyMap(unittest.TestCase):
         self.assertEqual(self.props["double"], 2.72)
         self.assertEqual(self.props["bool"], True)
 
+    def test_snapshot(self):
+        self.props["double"] = 3.14
+        self.props["bool"] = True
+        self.assertEqual(self.props.snapshot(), {"double": 3.14, "bool": True})
+        self.assertEqual(self.props.snapshot(["double"]), {"double": 3.14})
+
     def test_expose(self):
         self.props["double"] = 3.14
 
@@ -0,0 +1,121 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Backend interface for batched collision and distance queries
+*/
+
+#include <moveit/task_constructor/batch_collision.h>
+#include <moveit/task_constructor/thread_pool.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+std::mutex ACTIVE_MUTEX;
+BatchCollisionCheckerPtr& activeChecker() {
+	static BatchCollisionCheckerPtr checker = std::make_shared<ThreadedCollisionChecker>();
+	return checker;
+}
+}  // namespace
+
+BatchCollisionCheckerPtr BatchCollisionChecker::active() {
+	std::lock_guard<std::mutex> lock(ACTIVE_MUTEX);
+	return activeChecker();
+}
+
+void BatchCollisionChecker::setActive(const BatchCollisionCheckerPtr& checker) {
+	std::lock_guard<std::mutex> lock(ACTIVE_MUTEX);
+	activeChecker() = checker ? checker : std::make_shared<ThreadedCollisionChecker>();
+}
+
+ThreadedCollisionChecker::ThreadedCollisionChecker(size_t num_threads) {
+	if (num_threads > 0)
+		pool_ = std::make_unique<ThreadPool>(num_threads);
+}
+
+ThreadedCollisionChecker::~ThreadedCollisionChecker() = default;
+
+void ThreadedCollisionChecker::forEach(size_t count, const std::function<void(size_t)>& job, ThreadPool* pool) const {
+	if (!pool)
+		pool = pool_.get();
+	if (!pool || count < 2) {
+		for (size_t i = 0; i < count; ++i)
+			job(i);
+		return;
+	}
+	// one chunk per thread (including the calling one)
+	const size_t num_chunks = std::min(count, pool->size() + 1);
+	std::vector<ThreadPool::Job> jobs;
+	jobs.reserve(num_chunks);
+	for (size_t c = 0; c < num_chunks; ++c)
+		jobs.emplace_back([&job, count, c, num_chunks] {
+			for (size_t i = c * count / num_chunks, end = (c + 1) * count / num_chunks; i < end; ++i)
+				job(i);
+		});
+	pool->run(std::move(jobs));
+}
+
+std::vector<bool> ThreadedCollisionChecker::checkCollision(const planning_scene::PlanningScene& scene,
+                                                           const States& states, const std::string& group,
+                                                           ThreadPool* pool) const {
+	// std::vector<bool> is not safe for concurrent writes
+	std::vector<char> colliding(states.size(), false);
+	forEach(
+	    states.size(), [&](size_t i) { colliding[i] = scene.isStateColliding(*states[i], group); }, pool);
+	return std::vector<bool>(colliding.begin(), colliding.end());
+}
+
+std::vector<collision_detection::DistanceResult>
+ThreadedCollisionChecker::distance(const planning_scene::PlanningScene& scene, const States& states,
+                                   const collision_detection::DistanceRequest& request, bool with_world,
+                                   ThreadPool* pool) const {
+	std::vector<collision_detection::DistanceResult> results(states.size());
+	const auto& env = scene.getCollisionEnv();
+	forEach(
+	    states.size(),
+	    [&](size_t i) {
+		    if (with_world)
+			    env->distanceRobot(request, results[i], *states[i]);
+		    else
+			    env->distanceSelf(request, results[i], *states[i]);
+	    },
+	    pool);
+	return results;
+}
+}  // namespace task_constructor
+}  // namespace moveit
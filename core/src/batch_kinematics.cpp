@@ -0,0 +1,220 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Forward kinematics of a single link for many joint configurations at once
+*/
+
+#include <moveit/task_constructor/batch_kinematics.h>
+
+#include <moveit/robot_model/prismatic_joint_model.h>
+#include <moveit/robot_model/revolute_joint_model.h>
+#include <moveit/robot_state/robot_state.h>
+
+#include <algorithm>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+using Data = BatchForwardKinematics::Transforms::Data;
+using Row = Eigen::Array<double, 1, Eigen::Dynamic>;
+using Rotations = Eigen::Array<double, 9, Eigen::Dynamic, Eigen::RowMajor>;
+
+// data = data * constant
+void multiply(Data& data, const Eigen::Isometry3d& constant) {
+	const Rotations r = data.topRows<9>();
+	const Eigen::Matrix3d& c = constant.linear();
+	const Eigen::Vector3d& t = constant.translation();
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j)
+			data.row(3 * i + j) = r.row(3 * i) * c(0, j) + r.row(3 * i + 1) * c(1, j) + r.row(3 * i + 2) * c(2, j);
+		data.row(9 + i) += r.row(3 * i) * t(0) + r.row(3 * i + 1) * t(1) + r.row(3 * i + 2) * t(2);
+	}
+}
+
+// data = data * rotation(axis, angles)
+void rotate(Data& data, const Eigen::Vector3d& axis, const Row& angles) {
+	const Row c = angles.cos();
+	const Row s = angles.sin();
+	const Row v = 1.0 - c;
+	const double x = axis.x(), y = axis.y(), z = axis.z();
+
+	// Rodrigues' formula, row-major
+	Rotations m(9, angles.size());
+	m.row(0) = c + x * x * v;
+	m.row(1) = x * y * v - z * s;
+	m.row(2) = x * z * v + y * s;
+	m.row(3) = y * x * v + z * s;
+	m.row(4) = c + y * y * v;
+	m.row(5) = y * z * v - x * s;
+	m.row(6) = z * x * v - y * s;
+	m.row(7) = z * y * v + x * s;
+	m.row(8) = c + z * z * v;
+
+	const Rotations r = data.topRows<9>();
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			data.row(3 * i + j) =
+			    r.row(3 * i) * m.row(j) + r.row(3 * i + 1) * m.row(3 + j) + r.row(3 * i + 2) * m.row(6 + j);
+}
+
+// data = data * translation(axis * distances)
+void translate(Data& data, const Eigen::Vector3d& axis, const Row& distances) {
+	for (int i = 0; i < 3; ++i)
+		data.row(9 + i) +=
+		    (data.row(3 * i) * axis(0) + data.row(3 * i + 1) * axis(1) + data.row(3 * i + 2) * axis(2)) * distances;
+}
+
+void set(Data& data, Eigen::Index col, const Eigen::Isometry3d& pose) {
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j)
+			data(3 * i + j, col) = pose.linear()(i, j);
+		data(9 + i, col) = pose.translation()(i);
+	}
+}
+}  // namespace
+
+Eigen::Isometry3d BatchForwardKinematics::Transforms::operator[](Eigen::Index col) const {
+	Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j)
+			pose.linear()(i, j) = data(3 * i + j, col);
+		pose.translation()(i) = data(9 + i, col);
+	}
+	return pose;
+}
+
+Eigen::Matrix3Xd BatchForwardKinematics::Transforms::transformPoint(const Eigen::Vector3d& point) const {
+	Eigen::Matrix3Xd result(3, size());
+	for (int i = 0; i < 3; ++i)
+		result.row(i) = (data.row(3 * i) * point(0) + data.row(3 * i + 1) * point(1) + data.row(3 * i + 2) * point(2) +
+		                 data.row(9 + i))
+		                    .matrix();
+	return result;
+}
+
+BatchForwardKinematics::BatchForwardKinematics(const moveit::core::RobotModel& robot_model,
+                                               const moveit::core::LinkModel* link,
+                                               const moveit::core::JointModelGroup* group)
+  : link_(link), group_(group), variable_count_(group ? group->getVariableCount() : robot_model.getVariableCount()) {
+	const std::vector<int>* group_indices = group ? &group->getVariableIndexList() : nullptr;
+
+	for (const moveit::core::LinkModel* l = link; l; l = l->getParentLinkModel()) {
+		Segment segment{ l, l->getParentJointModel(), {} };
+		for (size_t v = 0; v < segment.joint->getVariableCount(); ++v) {
+			const int index = segment.joint->getFirstVariableIndex() + v;
+			if (!group_indices)
+				segment.rows.push_back(index);
+			else {
+				auto it = std::find(group_indices->begin(), group_indices->end(), index);
+				segment.rows.push_back(it == group_indices->end() ? -1 : it - group_indices->begin());
+			}
+		}
+		chain_.push_back(std::move(segment));
+	}
+	std::reverse(chain_.begin(), chain_.end());
+}
+
+BatchForwardKinematics::Positions
+BatchForwardKinematics::positions(const std::vector<const moveit::core::RobotState*>& states) const {
+	Positions result(variable_count_, states.size());
+	std::vector<double> values;
+	for (size_t i = 0; i < states.size(); ++i) {
+		if (group_)
+			states[i]->copyJointGroupPositions(group_, values);
+		else
+			values.assign(states[i]->getVariablePositions(),
+			              states[i]->getVariablePositions() + states[i]->getVariableCount());
+		result.col(i) = Eigen::Map<const Eigen::VectorXd>(values.data(), values.size());
+	}
+	return result;
+}
+
+void BatchForwardKinematics::compute(const moveit::core::RobotState& reference, const Positions& positions,
+                                     Transforms& result) const {
+	assert(positions.rows() == static_cast<Eigen::Index>(variable_count_));
+	const Eigen::Index n = positions.cols();
+
+	auto depends = [](const Segment& s) {
+		return std::any_of(s.rows.begin(), s.rows.end(), [](int r) { return r >= 0; });
+	};
+	auto first = std::find_if(chain_.begin(), chain_.end(), depends);
+
+	// start from the (constant) pose of the last link not depending on the group
+	Eigen::Isometry3d pending = Eigen::Isometry3d::Identity();
+	if (first == chain_.end())
+		pending = reference.getGlobalLinkTransform(link_);
+	else if (first->link->getParentLinkModel())
+		pending = reference.getGlobalLinkTransform(first->link->getParentLinkModel());
+
+	result.data.resize(12, n);
+	for (int i = 0; i < 12; ++i)
+		result.data.row(i).setConstant(i % 4 == 0 && i < 9 ? 1.0 : 0.0);
+
+	for (auto it = first; it != chain_.end(); ++it) {
+		const moveit::core::JointModel* joint = it->joint;
+		pending = pending * it->link->getJointOriginTransform();
+		if (!depends(*it)) {  // constant joint transform, accumulated with constant origins
+			Eigen::Isometry3d transform;
+			joint->computeTransform(reference.getJointPositions(joint), transform);
+			pending = pending * transform;
+			continue;
+		}
+
+		multiply(result.data, pending);
+		pending.setIdentity();
+
+		if (joint->getType() == moveit::core::JointModel::REVOLUTE) {
+			rotate(result.data, static_cast<const moveit::core::RevoluteJointModel*>(joint)->getAxis(),
+			       positions.row(it->rows[0]).array());
+		} else if (joint->getType() == moveit::core::JointModel::PRISMATIC) {
+			translate(result.data, static_cast<const moveit::core::PrismaticJointModel*>(joint)->getAxis(),
+			          positions.row(it->rows[0]).array());
+		} else {  // generic joint type: evaluate per state
+			std::vector<double> values(reference.getJointPositions(joint),
+			                           reference.getJointPositions(joint) + joint->getVariableCount());
+			Eigen::Isometry3d transform;
+			for (Eigen::Index i = 0; i < n; ++i) {
+				for (size_t v = 0; v < values.size(); ++v)
+					if (it->rows[v] >= 0)
+						values[v] = positions(it->rows[v], i);
+				joint->computeTransform(values.data(), transform);
+				set(result.data, i, result[i] * transform);
+			}
+		}
+	}
+	multiply(result.data, pending);
+}
+}  // namespace task_constructor
+}  // namespace moveit
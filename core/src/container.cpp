@@ -37,6 +37,7 @@
 #include <moveit/task_constructor/container_p.h>
 #include <moveit/task_constructor/introspection.h>
 #include <moveit/task_constructor/merge.h>
+#include <moveit/task_constructor/thread_pool.h>
 #include <moveit/task_constructor/fmt_p.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
@@ -46,8 +47,12 @@
 #include <memory>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <boost/range/adaptor/reversed.hpp>
 #include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
 
 using namespace std::placeholders;
 using namespace trajectory_processing;
@@ -86,8 +91,8 @@ printChildrenInterfaces(const ContainerBasePrivate& container, bool success, con
 ContainerBasePrivate::ContainerBasePrivate(ContainerBase* me, const std::string& name)
   : StagePrivate(me, name)
   , required_interface_(UNKNOWN)
-  , pending_backward_(new Interface)
-  , pending_forward_(new Interface) {}
+  , pending_backward_(new UnsortedInterface)
+  , pending_forward_(new UnsortedInterface) {}
 
 ContainerBasePrivate& ContainerBasePrivate::operator=(ContainerBasePrivate&& other) {
 	assert(internal_external_.empty() && other.internal_external_.empty());
@@ -163,70 +168,104 @@ void ContainerBasePrivate::compute() {
 	static_cast<ContainerBase*>(me_)->compute();
 }
 
+namespace {
+// stamps of setStatus() traversals, shared by both directions
+std::atomic<size_t> LAST_STATUS_WALK{ 0 };
+}  // namespace
+
 template <Interface::Direction dir>
-void ContainerBasePrivate::setStatus(const Stage* creator, const InterfaceState* source, const InterfaceState* target,
-                                     InterfaceState::Status status) {
-	if (status != InterfaceState::Status::ENABLED && creator) {
-		if (const auto* conn = dynamic_cast<const Connecting*>(creator)) {
-			auto cimpl = conn->pimpl();
-			// if creator is a Connecting stage and target has enabled opposite states (other than source)
-			if (cimpl->hasPendingOpposites<dir>(source, target))
-				return;  // don't prune
-		}
-	}
-	if (target->priority().status() == status)
-		return;  // nothing changing
-
-	// Skip disabling the state, if there are alternative enabled solutions
-	if (status != InterfaceState::ENABLED) {
-		auto solution_is_enabled = [](auto&& solution) {
-			return state<opposite<dir>()>(*solution)->priority().enabled();
-		};
-		const auto& alternatives = trajectories<opposite<dir>()>(*target);
-		auto alternative_path = std::find_if(alternatives.cbegin(), alternatives.cend(), solution_is_enabled);
-		if (alternative_path != alternatives.cend())
-			return;
-	}
+void ContainerBasePrivate::setStatus(const Stage* first_creator, const InterfaceState* first_source,
+                                     const InterfaceState* first_target, InterfaceState::Status first_status,
+                                     bool ignore_failures) {
+	Tracer::Scope trace("setStatus", "pruning", me());
+	struct Visit
+	{
+		const Stage* creator;
+		const InterfaceState* source;
+		const InterfaceState* target;
+		InterfaceState::Status status;
+	};
+	// depth-first traversal of the solution tree, visiting successors in the same order as a recursive walk
+	std::vector<Visit> pending{ { first_creator, first_source, first_target, first_status } };
+	const size_t walk = ++LAST_STATUS_WALK;
+
+	while (!pending.empty()) {
+		const Visit visit = pending.back();
+		pending.pop_back();
+		const InterfaceState* target = visit.target;
+		InterfaceState::Status status = visit.status;
+
+		// states reachable via several paths need to be updated only once
+		if (target->status_walk_ == walk)
+			continue;
 
-	// actually enable/disable the state
-	const_cast<InterfaceState*>(target)->updateStatus(status);
-
-	// if possible (i.e. if target has an external counterpart), escalate setStatus to external interface
-	if (parent() && trajectories<dir>(*target).empty()) {
-		// TODO: This was coded with SerialContainer in mind. Not sure, it works for ParallelContainers
-		auto external{ internalToExternalMap().find(target) };
-		if (external != internalToExternalMap().end()) {  // do we have an external state?
-			// only escalate if there is no other *enabled* internal state connected to the same external one
-			// all internal states linked to external
-			auto internals{ externalToInternalMap().equal_range(external->get<EXTERNAL>()) };
-			auto is_enabled = [](const auto& ext_int_pair) { return ext_int_pair.second->priority().enabled(); };
-			auto other_path{ std::find_if(internals.first, internals.second, is_enabled) };
-			if (other_path == internals.second)
-				parent()->pimpl()->setStatus<dir>(nullptr, nullptr, external->get<EXTERNAL>(), status);
-			return;
+		if (status != InterfaceState::Status::ENABLED && visit.creator) {
+			if (const auto* conn = dynamic_cast<const Connecting*>(visit.creator)) {
+				auto cimpl = conn->pimpl();
+				// if creator is a Connecting stage and target has enabled opposite states (other than source)
+				if (cimpl->hasPendingOpposites<dir>(visit.source, target))
+					continue;  // don't prune
+			}
+		}
+		if (target->priority().status() == status)
+			continue;  // nothing changing
+
+		// Skip disabling the state, if there are alternative enabled solutions
+		if (status != InterfaceState::ENABLED) {
+			auto solution_is_enabled = [ignore_failures](auto&& solution) {
+				return !(ignore_failures && solution->isFailure()) &&
+				       state<opposite<dir>()>(*solution)->priority().enabled();
+			};
+			const auto& alternatives = trajectories<opposite<dir>()>(*target);
+			auto alternative_path = std::find_if(alternatives.cbegin(), alternatives.cend(), solution_is_enabled);
+			if (alternative_path != alternatives.cend())
+				continue;
 		}
-	}
 
-	// To break symmetry between both ends of a partial solution sequence that gets disabled,
-	// we mark the first state with ARMED and all other states down the tree with PRUNED.
-	// This allows us to re-enable the ARMED state, but not the PRUNED states,
-	// when new states arrive in a Connecting stage.
-	// For details, https://github.com/moveit/moveit_task_constructor/pull/309#issuecomment-974636202
-	if (status == InterfaceState::Status::ARMED)
-		status = InterfaceState::Status::PRUNED;  // only the first state is marked as ARMED
+		// actually enable/disable the state
+		const_cast<InterfaceState*>(target)->updateStatus(status);
+		const_cast<InterfaceState*>(target)->status_walk_ = walk;
+		logEvent(EventLog::STATUS, 0, target->priority().cost(), target->priority().depth(), status);
+
+		// if possible (i.e. if target has an external counterpart), escalate setStatus to external interface
+		if (parent() && trajectories<dir>(*target).empty()) {
+			// TODO: This was coded with SerialContainer in mind. Not sure, it works for ParallelContainers
+			auto external{ internalToExternalMap().find(target) };
+			if (external != internalToExternalMap().end()) {  // do we have an external state?
+				// only escalate if there is no other *enabled* internal state connected to the same external one
+				// all internal states linked to external
+				auto internals{ externalToInternalMap().equal_range(external->get<EXTERNAL>()) };
+				auto is_enabled = [](const auto& ext_int_pair) { return ext_int_pair.second->priority().enabled(); };
+				auto other_path{ std::find_if(internals.first, internals.second, is_enabled) };
+				if (other_path == internals.second)
+					parent()->pimpl()->setStatus<dir>(nullptr, nullptr, external->get<EXTERNAL>(), status,
+					                                  ignore_failures);
+				continue;
+			}
+		}
 
-	// traverse solution tree
-	for (const SolutionBase* successor : trajectories<dir>(*target))
-		setStatus<dir>(successor->creator(), target, state<dir>(*successor), status);
+		// To break symmetry between both ends of a partial solution sequence that gets disabled,
+		// we mark the first state with ARMED and all other states down the tree with PRUNED.
+		// This allows us to re-enable the ARMED state, but not the PRUNED states,
+		// when new states arrive in a Connecting stage.
+		// For details, https://github.com/moveit/moveit_task_constructor/pull/309#issuecomment-974636202
+		if (status == InterfaceState::Status::ARMED)
+			status = InterfaceState::Status::PRUNED;  // only the first state is marked as ARMED
+
+		// traverse solution tree: push successors in reverse order to pop them in original order
+		const auto& successors = trajectories<dir>(*target);
+		for (auto it = successors.crbegin(); it != successors.crend(); ++it)
+			pending.push_back(Visit{ (*it)->creator(), target, state<dir>(**it), status });
+	}
 }
 
-// recursively update state priorities along solution path
+// recursively update state priorities along solution path, coalesced within compute() (see PriorityUpdateScope)
 template <Interface::Direction dir>
 inline void updateStatePrios(const InterfaceState& s, const InterfaceState::Priority& prio) {
 	InterfaceState::Priority priority(prio, s.priority().status());
-	if (s.priority() == priority)
+	if (PriorityUpdateScope::priority(s) == priority)
 		return;
-	const_cast<InterfaceState&>(s).updatePriority(priority);
+	PriorityUpdateScope::update(s, priority);
 	for (const SolutionBase* successor : trajectories<dir>(s))
 		updateStatePrios<dir>(*state<dir>(*successor), prio);
 }
@@ -274,8 +313,9 @@ void ContainerBasePrivate::copyState(Interface::iterator external, const Interfa
 			assert(false);  // Expecting either STATUS or PRIORITY updates, not both!
 		return;
 	}
-	// create a clone of external state within target interface (child's starts() or ends())
-	auto internal = states_.insert(states_.end(), InterfaceState(*external));
+	// create a clone of external state within target interface (child's starts() or ends()),
+	// sharing scene and (copy-on-write) properties with the external state
+	auto internal = states_.emplace(states_.end(), *external);
 	target->add(*internal);
 	// and remember the mapping between them
 	internalToExternalMap().insert(std::make_pair(&*internal, &*external));
@@ -291,6 +331,7 @@ void ContainerBasePrivate::copyState(Interface::Direction dir, Interface::iterat
 
 void ContainerBasePrivate::liftSolution(const SolutionBasePtr& solution, const InterfaceState* internal_from,
                                         const InterfaceState* internal_to) {
+	auto lock = lockPlanning();
 	computeCost(*internal_from, *internal_to, *solution);
 
 	// map internal to external states
@@ -299,7 +340,7 @@ void ContainerBasePrivate::liftSolution(const SolutionBasePtr& solution, const I
 		if (it != internalToExternalMap().end())
 			return const_cast<InterfaceState*>(it->second);
 
-		InterfaceState* external = &*states_.insert(states_.end(), InterfaceState(*internal));
+		InterfaceState* external = &*states_.emplace(states_.end(), *internal);
 		internalToExternalMap().insert(std::make_pair(internal, external));
 		created = true;
 		return external;
@@ -416,9 +457,11 @@ void ContainerBase::reset() {
 	impl->internalToExternalMap().clear();
 
 	// interfaces depend on children which might change
-	impl->required_interface_ = UNKNOWN;
-	impl->starts_.reset();
-	impl->ends_.reset();
+	if (!impl->keepStructure()) {
+		impl->required_interface_ = UNKNOWN;
+		impl->starts_.reset();
+		impl->ends_.reset();
+	}
 
 	Stage::reset();
 }
@@ -481,10 +524,32 @@ struct SolutionCollector
 {
 	SolutionCollector(size_t max_depth, const SolutionBase& start) : max_depth(max_depth) {
 		trace.reserve(max_depth);
+		collect(start);
+	}
+
+	/// (re)collect all paths, e.g. after their costs have changed
+	void collect(const SolutionBase& start) {
+		solutions.clear();
 		traverse(start, InterfaceState::Priority(0, 0.0));
 		assert(trace.empty());
 	}
 
+	/// resolve deferred costs of all sub solutions of paths reaching the given depth
+	bool resolveDeferredCosts(size_t depth) {
+		bool changed = false;
+		for (auto& path : solutions)
+			if (path.second.depth() == depth)
+				for (const SolutionBase* s : path.first)
+					changed |= StagePrivate::resolveDeferredCosts(const_cast<SolutionBase&>(*s));
+		return changed;
+	}
+
+	/// does any path reach the given depth?
+	bool reaches(size_t depth) const {
+		return std::any_of(solutions.begin(), solutions.end(),
+		                   [depth](const auto& path) { return path.second.depth() == depth; });
+	}
+
 	void traverse(const SolutionBase& start, const InterfaceState::Priority& prio) {
 		const InterfaceState::Solutions& next = trajectories<dir>(*state<dir>(start));
 		if (next.empty()) {  // when reaching the end, add the trace to solutions
@@ -508,6 +573,56 @@ struct SolutionCollector
 	SolutionSequence::container_type trace;
 };
 
+namespace {
+// heap order of pending paths: next-best cost first, ties broken by creation order
+bool laterPaths(const std::unique_ptr<BestFirstPaths>& a, const std::unique_ptr<BestFirstPaths>& b) {
+	return std::make_pair(a->nextCost(), a->id()) > std::make_pair(b->nextCost(), b->id());
+}
+}  // namespace
+
+BestFirstPaths::BestFirstPaths(const Paths& incoming, size_t in_depth, const Paths& outgoing, size_t out_depth,
+                               const SolutionBase& current, size_t id)
+  : current_(&current), current_prio_(1u, current.cost()), id_(id) {
+	collect(incoming, in_depth, incoming_);
+	collect(outgoing, out_depth, outgoing_);
+	if (!incoming_.empty() && !outgoing_.empty())
+		push(0, 0);
+}
+
+void BestFirstPaths::collect(const Paths& paths, size_t depth, std::vector<Path>& result) {
+	for (const Path& path : paths)
+		if (path.second.depth() == depth)
+			result.push_back(path);
+	std::stable_sort(result.begin(), result.end(),
+	                 [](const Path& a, const Path& b) { return a.second.cost() < b.second.cost(); });
+}
+
+void BestFirstPaths::push(size_t in, size_t out) {
+	heap_.push(Candidate{ incoming_[in].second + current_prio_ + outgoing_[out].second, in, out });
+}
+
+InterfaceState::Priority BestFirstPaths::pop(SolutionSequence::container_type& solution) {
+	const Candidate best = heap_.top();
+	heap_.pop();
+	// successors of (i, j) are (i, j+1) and - for j == 0 only - (i+1, 0): each pair is reached exactly once
+	if (best.out + 1 < outgoing_.size())
+		push(best.in, best.out + 1);
+	if (best.out == 0 && best.in + 1 < incoming_.size())
+		push(best.in + 1, 0);
+
+	const auto& in = incoming_[best.in].first;
+	const auto& out = outgoing_[best.out].first;
+	solution.clear();
+	solution.reserve(in.size() + 1 + out.size());
+	// insert incoming solutions in reverse order
+	solution.insert(solution.end(), in.rbegin(), in.rend());
+	// insert current solution
+	solution.push_back(current_);
+	// insert outgoing solutions in normal order
+	solution.insert(solution.end(), out.begin(), out.end());
+	return best.prio;
+}
+
 void SerialContainer::onNewSolution(const SolutionBase& current) {
 	ROS_DEBUG_STREAM_NAMED("SerialContainer", fmt::format("'{}' received solution of child stage '{}'", this->name(),
 	                                                      current.creator()->name()));
@@ -531,27 +646,26 @@ void SerialContainer::onNewSolution(const SolutionBase& current) {
 	SolutionCollector<Interface::BACKWARD> incoming(num_before, current);
 	SolutionCollector<Interface::FORWARD> outgoing(num_after, current);
 
-	// collect (and sort) all solutions spanning from start to end of this container
-	ordered<SolutionSequencePtr> sorted;
+	// solutions becoming part of complete solutions need their exact costs (see cost::Deferred)
+	if (incoming.reaches(num_before) && outgoing.reaches(num_after)) {
+		Tracer::Scope trace("resolveDeferredCosts", "cost", me());
+		bool changed = StagePrivate::resolveDeferredCosts(const_cast<SolutionBase&>(current));
+		changed |= incoming.resolveDeferredCosts(num_before);
+		changed |= outgoing.resolveDeferredCosts(num_after);
+		if (current.isFailure())  // ruled out by its exact cost
+			return;
+		if (changed) {  // recollect paths with updated costs, skipping failures
+			incoming.collect(current);
+			outgoing.collect(current);
+		}
+	}
+
+	// update state priorities along all partial solution paths
 	for (auto& in : incoming.solutions) {
 		for (auto& out : outgoing.solutions) {
 			InterfaceState::Priority prio = in.second + InterfaceState::Priority(1u, current.cost()) + out.second;
 			assert(prio.enabled());
-			// found a complete solution path connecting start to end?
-			if (prio.depth() == children.size()) {
-				SolutionSequence::container_type solution;
-				solution.reserve(children.size());
-				// insert incoming solutions in reverse order
-				solution.insert(solution.end(), in.first.rbegin(), in.first.rend());
-				// insert current solution
-				solution.push_back(&current);
-				// insert outgoing solutions in normal order
-				solution.insert(solution.end(), out.first.begin(), out.first.end());
-				// store solution in sorted list
-				sorted.insert(std::make_shared<SolutionSequence>(std::move(solution), prio.cost(), this));
-			}
 			if (prio.depth() > 1) {
-				// update state priorities along the whole partial solution path
 				updateStatePrios<Interface::BACKWARD>(*current.start(), prio);
 				updateStatePrios<Interface::FORWARD>(*current.end(), prio);
 			}
@@ -559,9 +673,21 @@ void SerialContainer::onNewSolution(const SolutionBase& current) {
 	}
 	// printChildrenInterfaces(*this->pimpl(), true, *current.creator());
 
-	// finally, store + announce new solutions to external interface
-	for (const auto& solution : sorted)
-		impl->liftSolution(solution, solution->internalStart(), solution->internalEnd());
+	// finally, queue solutions spanning from start to end of this container, to be lifted best first
+	auto paths = std::make_unique<BestFirstPaths>(incoming.solutions, num_before, outgoing.solutions, num_after, current,
+	                                              impl->next_paths_id_++);
+	if (!paths->empty()) {
+		impl->pending_.push_back(std::move(paths));
+		std::push_heap(impl->pending_.begin(), impl->pending_.end(), laterPaths);
+	}
+	// ... immediately, unless our owner requests them explicitly (see Task::plan())
+	if (!impl->lift_on_request_)
+		impl->liftPendingSolutions();
+}
+
+void SerialContainer::reset() {
+	ContainerBase::reset();
+	pimpl()->reset();
 }
 
 SerialContainer::SerialContainer(SerialContainerPrivate* impl) : ContainerBase(impl) {}
@@ -570,6 +696,35 @@ SerialContainer::SerialContainer(const std::string& name) : SerialContainer(new
 SerialContainerPrivate::SerialContainerPrivate(SerialContainer* me, const std::string& name)
   : ContainerBasePrivate(me, name) {}
 
+void SerialContainerPrivate::reset() {
+	pending_.clear();
+	next_paths_id_ = 0;
+}
+
+size_t SerialContainerPrivate::liftPendingSolutions(size_t max) {
+	size_t lifted = 0;
+	SolutionSequence::container_type solution;
+	while (lifted < max && !pending_.empty()) {
+		std::pop_heap(pending_.begin(), pending_.end(), laterPaths);
+		BestFirstPaths& paths = *pending_.back();
+		const InterfaceState::Priority prio = paths.pop(solution);
+		if (paths.empty())
+			pending_.pop_back();
+		else
+			std::push_heap(pending_.begin(), pending_.end(), laterPaths);
+
+		// solutions might have been invalidated while pending (e.g. by Task::replan())
+		if (std::any_of(solution.begin(), solution.end(), [](const SolutionBase* s) { return s->isFailure(); }))
+			continue;
+
+		assert(prio.depth() == children().size());
+		auto sequence = makeSolution<SolutionSequence>(std::move(solution), prio.cost(), me());
+		liftSolution(sequence, sequence->internalStart(), sequence->internalEnd());
+		++lifted;
+	}
+	return lifted;
+}
+
 void SerialContainerPrivate::connect(StagePrivate& stage1, StagePrivate& stage2) {
 	InterfaceFlags flags1 = stage1.requiredInterface();
 	InterfaceFlags flags2 = stage2.requiredInterface();
@@ -703,7 +858,23 @@ bool SerialContainer::canCompute() const {
 }
 
 void SerialContainer::compute() {
-	for (const auto& stage : pimpl()->children()) {
+	auto impl = pimpl();
+	if (ThreadPool* pool = impl->threadPool()) {
+		// multi-threaded planning: compute all children with pending work concurrently
+		std::vector<ThreadPool::Job> jobs;
+		{
+			auto lock = impl->lockPlanning();
+			for (const auto& stage : impl->children()) {
+				StagePrivate* child = stage->pimpl();
+				if (child->canCompute())
+					jobs.emplace_back([child] { child->runCompute(); });
+			}
+		}
+		pool->run(std::move(jobs));
+		return;
+	}
+
+	for (const auto& stage : impl->children()) {
 		if (stage->pimpl()->canCompute())
 			stage->pimpl()->runCompute();
 	}
@@ -796,20 +967,21 @@ ParallelContainerBase::ParallelContainerBase(const std::string& name)
   : ParallelContainerBase(new ParallelContainerBasePrivate(this, name)) {}
 
 void ParallelContainerBase::liftSolution(const SolutionBase& solution, double cost, std::string comment) {
-	pimpl()->liftSolution(std::make_shared<WrappedSolution>(this, &solution, cost, std::move(comment)), solution.start(),
-	                      solution.end());
+	auto impl = pimpl();
+	impl->liftSolution(impl->makeSolution<WrappedSolution>(this, &solution, cost, std::move(comment)), solution.start(),
+	                   solution.end());
 }
 
 void ParallelContainerBase::spawn(InterfaceState&& state, SubTrajectory&& t) {
-	pimpl()->StagePrivate::spawn(std::move(state), std::make_shared<SubTrajectory>(std::move(t)));
+	pimpl()->StagePrivate::spawn(std::move(state), pimpl()->makeSolution<SubTrajectory>(std::move(t)));
 }
 
 void ParallelContainerBase::sendForward(const InterfaceState& from, InterfaceState&& to, SubTrajectory&& t) {
-	pimpl()->StagePrivate::sendForward(from, std::move(to), std::make_shared<SubTrajectory>(std::move(t)));
+	pimpl()->StagePrivate::sendForward(from, std::move(to), pimpl()->makeSolution<SubTrajectory>(std::move(t)));
 }
 
 void ParallelContainerBase::sendBackward(InterfaceState&& from, const InterfaceState& to, SubTrajectory&& t) {
-	pimpl()->StagePrivate::sendBackward(std::move(from), to, std::make_shared<SubTrajectory>(std::move(t)));
+	pimpl()->StagePrivate::sendBackward(std::move(from), to, pimpl()->makeSolution<SubTrajectory>(std::move(t)));
 }
 
 WrapperBasePrivate::WrapperBasePrivate(WrapperBase* me, const std::string& name)
@@ -850,7 +1022,23 @@ bool Alternatives::canCompute() const {
 }
 
 void Alternatives::compute() {
-	for (const auto& stage : pimpl()->children()) {
+	auto impl = pimpl();
+	if (ThreadPool* pool = impl->threadPool()) {
+		// multi-threaded planning: compute all branches concurrently, solutions are lifted under the planning lock
+		std::vector<ThreadPool::Job> jobs;
+		{
+			auto lock = impl->lockPlanning();
+			for (const auto& stage : impl->children()) {
+				StagePrivate* child = stage->pimpl();
+				if (child->canCompute())
+					jobs.emplace_back([child] { child->runCompute(); });
+			}
+		}
+		pool->run(std::move(jobs));
+		return;
+	}
+
+	for (const auto& stage : impl->children()) {
 		stage->pimpl()->runCompute();
 	}
 }
@@ -861,7 +1049,10 @@ void Alternatives::onNewSolution(const SolutionBase& s) {
 
 Fallbacks::Fallbacks(const std::string& name) : Fallbacks(new FallbacksPrivate(this, name)) {}
 
-Fallbacks::Fallbacks(FallbacksPrivate* impl) : ParallelContainerBase(impl) {}
+Fallbacks::Fallbacks(FallbacksPrivate* impl) : ParallelContainerBase(impl) {
+	properties().declare<uint32_t>("speculation", 0u,
+	                               "number of subsequent children computing the current job concurrently");
+}
 
 void Fallbacks::reset() {
 	ParallelContainerBase::reset();
@@ -994,24 +1185,94 @@ void FallbacksPrivatePropagator::reset() {
 	FallbacksPrivateCommon::reset();
 	job_ = pullInterface(dir_)->end();  // indicate fresh start
 	job_has_solutions_ = false;
+	fed_end_ = children().begin();
+	speculative_.clear();
+}
+
+void FallbacksPrivatePropagator::compute() {
+	ThreadPool* pool = threadPool();
+	if (!pool || std::next(current_) == fed_end_) {
+		FallbacksPrivateCommon::compute();
+		return;
+	}
+
+	// speculative mode: compute all fed children concurrently
+	std::vector<ThreadPool::Job> jobs;
+	{
+		auto lock = lockPlanning();
+		for (auto it = current_; it != fed_end_; ++it) {
+			StagePrivate* child = (*it)->pimpl();
+			if (child->canCompute())
+				jobs.emplace_back([child] { child->runCompute(); });
+		}
+	}
+	pool->run(std::move(jobs));
 }
 
 void FallbacksPrivatePropagator::onNewSolution(const SolutionBase& s) {
+	auto lock = lockPlanning();
+	if (current_ != children().end() && s.creator() != current_->get()) {
+		speculative_.push_back(&s);  // hold back until all preceding children failed
+		return;
+	}
 	job_has_solutions_ = true;
 	FallbacksPrivateCommon::onNewSolution(s);
 }
 
+void FallbacksPrivatePropagator::feedJob() {
+	auto target = std::next(current_);
+	if (threadPool()) {
+		const auto remaining = std::distance(target, children().cend());
+		std::advance(target, std::min<std::ptrdiff_t>(remaining, properties().get<uint32_t>("speculation")));
+	}
+	for (; fed_end_ != target; ++fed_end_)
+		copyState(dir_, job_, (*fed_end_)->pimpl()->pullInterface(dir_), Interface::UpdateFlags());
+}
+
+void FallbacksPrivatePropagator::releaseSpeculation() {
+	const Stage* current = current_->get();
+	auto end = std::stable_partition(speculative_.begin(), speculative_.end(),
+	                                 [current](const SolutionBase* s) { return s->creator() != current; });
+	std::vector<const SolutionBase*> released(end, speculative_.end());
+	speculative_.erase(end, speculative_.end());
+	for (const SolutionBase* s : released)
+		onNewSolution(*s);
+}
+
+void FallbacksPrivatePropagator::dropSpeculation(container_type::const_iterator from) {
+	for (; from != fed_end_; ++from) {
+		// remove the copy of job_ if the child didn't fetch it yet
+		const InterfacePtr& interface = (*from)->pimpl()->pullInterface(dir_);
+		auto it = std::find_if(interface->begin(), interface->end(), [this](const InterfaceState* state) {
+			auto external = internalToExternalMap().find(state);
+			return external != internalToExternalMap().end() && external->second == &*job_;
+		});
+		if (it != interface->end())
+			interface->remove(it);
+	}
+	speculative_.clear();
+}
+
 bool FallbacksPrivatePropagator::nextJob() {
 	assert(current_ != children().end() && !(*current_)->pimpl()->canCompute());
 	const auto jobs = pullInterface(dir_);
 
 	if (job_ != jobs->end()) {  // current job exists, but is exhausted on current child
-		if (!job_has_solutions_)  // job didn't produce solutions -> feed to next child
+		const bool solved = job_has_solutions_;
+		job_has_solutions_ = false;
+		if (!solved) {  // job didn't produce solutions -> feed to next child
 			nextChild();
-		else
+			if (current_ != children().end()) {
+				// the child might have been fed speculatively already
+				releaseSpeculation();
+				feedJob();
+				return (*current_)->pimpl()->canCompute() || nextJob();
+			}
+		} else {
+			dropSpeculation(std::next(current_));
 			current_ = children().end();  // indicate that this job is exhausted on all children
+		}
 	}
-	job_has_solutions_ = false;
 
 	if (current_ == children().end()) {  // all children processed the job_
 		if (job_ != jobs->end()) {
@@ -1030,7 +1291,8 @@ bool FallbacksPrivatePropagator::nextJob() {
 	}
 
 	// When arriving here, we have a valid job_ and a current_ child to feed it. Let's do that.
-	copyState(dir_, job_, (*current_)->pimpl()->pullInterface(dir_), Interface::UpdateFlags());
+	fed_end_ = current_;
+	feedJob();
 	return true;
 }
 
@@ -1051,7 +1313,11 @@ template <Interface::Direction dir>
 void FallbacksPrivateConnect::propagateStateUpdate(Interface::iterator external, Interface::UpdateFlags updated) {
 	copyState<dir>(external, children().front()->pimpl()->pullInterface(dir), updated);
 	// As we use the Interface* from the first child for all children (we just populate their pending lists)
-	// there is no need to explicitly propagate state updates to other children.
+	// there is no need to explicitly propagate state updates to other children. Only their pending lists,
+	// holding states of the first child, need to follow the changed priorities.
+	if (updated)
+		for (auto it = std::next(children().begin()), end = children().end(); it != end; ++it)
+			static_cast<ConnectingPrivate*>(const_cast<StagePrivate*>((*it)->pimpl()))->updatePendingPairs();
 }
 
 bool FallbacksPrivateConnect::canCompute() const {
@@ -1089,13 +1355,36 @@ void FallbacksPrivateConnect::onNewFailure(const Stage& child, const InterfaceSt
 		auto first_con = static_cast<const ConnectingPrivate*>(children().front()->pimpl());
 		auto from_it = findIteratorFor(from, *first_con->starts());
 		auto to_it = findIteratorFor(to, *first_con->ends());
-		next_con->pending.insert(std::make_pair(from_it, to_it));
+		next_con->addPendingPair(ConnectingPrivate::StatePair(from_it, to_it));
 	} else  // or report failure to parent
 		parent()->pimpl()->onNewFailure(*me(), from, to);
 }
 
 MergerPrivate::MergerPrivate(Merger* me, const std::string& name) : ParallelContainerBasePrivate(me, name) {}
 
+void MergerPrivate::initializeExternalInterfaces() {
+	// as ParallelContainerBasePrivate, but additionally drop solutions of pruned source states
+	if (requiredInterface() & READS_START)
+		starts() = std::make_shared<Interface>([this](Interface::iterator external, Interface::UpdateFlags updated) {
+			this->propagateStateToAllChildren<Interface::FORWARD>(external, updated);
+			if (updated.testFlag(Interface::STATUS))
+				onSourceStateUpdate(*external);
+		});
+	if (requiredInterface() & READS_END)
+		ends() = std::make_shared<Interface>([this](Interface::iterator external, Interface::UpdateFlags updated) {
+			this->propagateStateToAllChildren<Interface::BACKWARD>(external, updated);
+			if (updated.testFlag(Interface::STATUS))
+				onSourceStateUpdate(*external);
+		});
+}
+
+void MergerPrivate::onSourceStateUpdate(const InterfaceState& external) {
+	// children won't propagate a pruned state anymore (ARMED states might be re-enabled though)
+	// the entry of a state being merged is still in use: it is checked again after merging
+	if (external.priority().status() == InterfaceState::Status::PRUNED && &external != merging_)
+		source_solutions_.erase(&external);
+}
+
 void MergerPrivate::resolveInterface(InterfaceFlags expected) {
 	ParallelContainerBasePrivate::resolveInterface(expected);
 	switch (requiredInterface()) {
@@ -1116,13 +1405,15 @@ void MergerPrivate::resolveInterface(InterfaceFlags expected) {
 Merger::Merger(const std::string& name) : Merger(new MergerPrivate(this, name)) {
 	properties().declare<TimeParameterizationPtr>("time_parameterization",
 	                                              std::make_shared<TimeOptimalTrajectoryGeneration>());
+	properties().declare<uint32_t>("max_solutions", 0u,
+	                               "maximum number of valid merged solutions per source state (0: unbounded)");
 }
 
 void Merger::reset() {
 	ParallelContainerBase::reset();
 	auto impl = pimpl();
 	impl->jmg_merged_.reset();
-	impl->source_state_to_solutions_.clear();
+	impl->source_solutions_.clear();
 }
 
 void Merger::init(const core::RobotModelConstPtr& robot_model) {
@@ -1180,25 +1471,39 @@ void MergerPrivate::onNewPropagateSolution(const SolutionBase& s) {
 	assert(source_it != internalToExternalMap().end());
 	const InterfaceState* external_source_state = &*source_it->second;
 
-	// retrieve (or create if necessary) the ChildSolutionMap for the given external source state
-	ChildSolutionMap& all_solutions =
-	    source_state_to_solutions_.insert(std::make_pair(external_source_state, ChildSolutionMap())).first->second;
-
-	// retrieve (or create if necessary) the ChildSolutionList corresponding to the child
-	ChildSolutionList& child_solutions =
-	    all_solutions.insert(std::make_pair(s.creator(), ChildSolutionList())).first->second;
-	// insert the new child solution into the list
+	SourceSolutions& entry = source_solutions_[external_source_state];
+	const uint32_t max_solutions = me_->properties().get<uint32_t>("max_solutions");
+	if (max_solutions && entry.num_merged >= max_solutions)
+		return;  // already found enough merged solutions for this source state
+	if (entry.children.empty())
+		entry.children.resize(children().size());
+
+	// insert the new child solution into the list of its creator
+	const auto creator = std::find_if(children().begin(), children().end(),
+	                                  [&s](const Stage::pointer& child) { return child.get() == s.creator(); });
+	assert(creator != children().end());
+	const size_t current = std::distance(children().begin(), creator);
+	ChildSolutionList& child_solutions = entry.children[current];
+	if (child_solutions.empty())
+		++entry.num_children;
 	child_solutions.push_back(trajectory);
 
 	// do we have solutions for all children?
-	if (all_solutions.size() < children().size())
+	if (entry.num_children < children().size())
 		return;
-	assert(all_solutions.size() == children().size());
 
 	// combine the new solution with all solutions from other children
 	auto spawner = dir == PROPAGATE_FORWARDS ? &MergerPrivate::sendForward : &MergerPrivate::sendBackward;
-	mergeAnyCombination(all_solutions, s, external_source_state->scene(),
-	                    std::bind(spawner, this, std::placeholders::_1, external_source_state));
+	merging_ = external_source_state;  // spawned failures might prune the source state
+	mergeAnyCombination(entry.children, current, external_source_state->scene(),
+	                    std::bind(spawner, this, std::placeholders::_1, external_source_state), entry.num_merged);
+	merging_ = nullptr;
+
+	if (external_source_state->priority().status() == InterfaceState::Status::PRUNED)
+		source_solutions_.erase(external_source_state);
+	else if (max_solutions && entry.num_merged >= max_solutions)
+		// once fully merged, only the number of merged solutions needs to be kept
+		std::vector<ChildSolutionList>().swap(entry.children);
 }
 
 void MergerPrivate::sendForward(SubTrajectory&& t, const InterfaceState* from) {
@@ -1206,7 +1511,7 @@ void MergerPrivate::sendForward(SubTrajectory&& t, const InterfaceState* from) {
 	planning_scene::PlanningScenePtr to = from->scene()->diff();
 	if (t.trajectory() && !t.trajectory()->empty())
 		to->setCurrentState(t.trajectory()->getLastWayPoint());
-	StagePrivate::sendForward(*from, InterfaceState(to), std::make_shared<SubTrajectory>(std::move(t)));
+	StagePrivate::sendForward(*from, InterfaceState(to), makeSolution<SubTrajectory>(std::move(t)));
 }
 
 void MergerPrivate::sendBackward(SubTrajectory&& t, const InterfaceState* to) {
@@ -1214,59 +1519,134 @@ void MergerPrivate::sendBackward(SubTrajectory&& t, const InterfaceState* to) {
 	planning_scene::PlanningScenePtr from = to->scene()->diff();
 	if (t.trajectory() && !t.trajectory()->empty())
 		from->setCurrentState(t.trajectory()->getFirstWayPoint());
-	StagePrivate::sendBackward(InterfaceState(from), *to, std::make_shared<SubTrajectory>(std::move(t)));
+	StagePrivate::sendBackward(InterfaceState(from), *to, makeSolution<SubTrajectory>(std::move(t)));
 }
 
 void MergerPrivate::onNewGeneratorSolution(const SolutionBase& /* s */) {
 	// TODO: implement in similar fashion as onNewPropagateSolution(), but also merge start/end states
 }
 
-void MergerPrivate::mergeAnyCombination(const ChildSolutionMap& all_solutions, const SolutionBase& current,
+void MergerPrivate::mergeAnyCombination(const std::vector<ChildSolutionList>& all_solutions, size_t current,
                                         const planning_scene::PlanningSceneConstPtr& start_scene,
-                                        const Spawner& spawner) {
-	std::vector<size_t> indices;  // which solution index was considered last for i-th child?
-	indices.reserve(children().size());
-
-	ChildSolutionList sub_solutions;
-	sub_solutions.reserve(children().size());
-
-	// initialize vector of sub solutions
-	for (const auto& pair : all_solutions) {
-		// all children, except current solution's creator, start with zero index
-		indices.push_back(pair.first != current.creator() ? 0 : pair.second.size() - 1);
-		sub_solutions.push_back(pair.second[indices.back()]);
+                                        const Spawner& spawner, size_t& num_merged) {
+	const uint32_t max_solutions = me_->properties().get<uint32_t>("max_solutions");
+	if (max_solutions && num_merged >= max_solutions)
+		return;  // already found enough merged solutions for this source state
+
+	// Enumerate combinations lazily in best-first order: sort each child's solutions by cost
+	// and expand combinations (tuples of indices into these lists) from a heap ordered by accumulated cost.
+	// Only current's latest solution is considered for its child.
+	const size_t num_children = all_solutions.size();
+	std::vector<ChildSolutionList> sorted(num_children);
+	for (size_t child = 0; child < num_children; ++child) {
+		if (child == current) {
+			sorted[child].push_back(all_solutions[child].back());
+			continue;
+		}
+		sorted[child] = all_solutions[child];
+		std::stable_sort(sorted[child].begin(), sorted[child].end(),
+		                 [](const SubTrajectory* a, const SubTrajectory* b) { return a->cost() < b->cost(); });
 	}
-	while (true) {
-		merge(sub_solutions, start_scene, spawner);
-
-		// compose next combination
-		size_t child = 0;
-		for (auto it = all_solutions.cbegin(), end = all_solutions.cend(); it != end; ++it, ++child) {
-			if (it->first == current.creator())
-				continue;  // skip current solution's child
-			if (++indices[child] >= it->second.size()) {
-				indices[child] = 0;  // start over with zero
-				sub_solutions[child] = it->second[indices[child]];
-				continue;  // and continue with next child
-			}
-			// otherwise, a new solution combination is available
-			sub_solutions[child] = it->second[indices[child]];
-			break;
+
+	struct Combination
+	{
+		double cost;
+		std::vector<size_t> indices;
+		size_t first;  // successors only advance children >= first, generating each combination once
+	};
+	auto worse = [](const Combination& a, const Combination& b) {
+		return a.cost > b.cost || (a.cost == b.cost && a.indices > b.indices);
+	};
+	auto push = [&sorted, num_children](auto& queue, std::vector<size_t>&& indices, size_t first) {
+		double cost = 0.0;
+		for (size_t child = 0; child < num_children; ++child)
+			cost += sorted[child][indices[child]]->cost();
+		queue.push(Combination{ cost, std::move(indices), first });
+	};
+	std::priority_queue<Combination, std::vector<Combination>, decltype(worse)> queue(worse);
+	push(queue, std::vector<size_t>(num_children, 0), 0);
+
+	// pop the next best combination, pushing its successors
+	auto next = [&queue, &sorted, &push, num_children]() {
+		Combination c = queue.top();
+		queue.pop();
+		for (size_t child = c.first; child < num_children; ++child) {
+			if (c.indices[child] + 1 >= sorted[child].size())
+				continue;
+			std::vector<size_t> indices = c.indices;
+			++indices[child];
+			push(queue, std::move(indices), child);
+		}
+		ChildSolutionList sub_solutions;
+		sub_solutions.reserve(num_children);
+		for (size_t child = 0; child < num_children; ++child)
+			sub_solutions.push_back(sorted[child][c.indices[child]]);
+		return sub_solutions;
+	};
+
+	moveit::core::JointModelGroup* jmg;
+	try {
+		if (!jmg_merged_) {  // share merged group with other stages merging the same groups
+			std::vector<const moveit::core::JointModelGroup*> groups;
+			groups.reserve(num_children);
+			for (const ChildSolutionList& solutions : sorted)
+				groups.push_back(solutions.front()->trajectory()->getGroup());
+			jmg_merged_ = mergedGroup(groups);
+		}
+		jmg = jmg_merged_.get();
+	} catch (const std::runtime_error& e) {
+		SubTrajectory t;
+		t.markAsFailure();
+		t.setComment(e.what());
+		spawner(std::move(t));
+		return;
+	}
+
+	// merge batches of combinations concurrently, spawning results in cost order
+	ThreadPool* pool = solverPool();
+	const size_t batch_size = pool ? pool->size() + 1 : 1;
+	std::vector<ChildSolutionList> batch;
+	std::vector<SubTrajectory> results;
+	while (!queue.empty()) {
+		// don't merge more combinations than required to reach max_solutions
+		const size_t size = max_solutions ? std::min<size_t>(batch_size, max_solutions - num_merged) : batch_size;
+		batch.clear();
+		while (batch.size() < size && !queue.empty())
+			batch.push_back(next());
+
+		results.clear();
+		results.resize(batch.size());
+		if (results.size() == 1)
+			results.front() = merge(batch.front(), start_scene, jmg);
+		else {
+			std::vector<ThreadPool::Job> jobs;
+			jobs.reserve(results.size());
+			for (size_t i = 0; i < batch.size(); ++i)
+				jobs.emplace_back([this, &results, &batch, &start_scene, jmg, i] {
+					results[i] = merge(batch[i], start_scene, jmg);
+				});
+			pool->run(std::move(jobs));
+		}
+
+		for (SubTrajectory& t : results) {
+			if (!t.isFailure())
+				++num_merged;
+			spawner(std::move(t));
+			if (max_solutions && num_merged >= max_solutions)
+				return;  // stop early
 		}
-		if (child == children().size())  // all combinations exhausted?
-			break;
 	}
 }
 
-void MergerPrivate::merge(const ChildSolutionList& sub_solutions,
-                          const planning_scene::PlanningSceneConstPtr& start_scene, const Spawner& spawner) {
+SubTrajectory MergerPrivate::merge(const ChildSolutionList& sub_solutions,
+                                   const planning_scene::PlanningSceneConstPtr& start_scene,
+                                   moveit::core::JointModelGroup* jmg) const {
 	// transform vector of SubTrajectories into vector of RobotTrajectories
 	std::vector<robot_trajectory::RobotTrajectoryConstPtr> sub_trajectories;
 	sub_trajectories.reserve(sub_solutions.size());
 	for (const auto& sub : sub_solutions)
 		sub_trajectories.push_back(sub->trajectory());
 
-	moveit::core::JointModelGroup* jmg = jmg_merged_.get();
 	robot_trajectory::RobotTrajectoryPtr merged;
 	try {
 		auto timing = me_->properties().get<TimeParameterizationPtr>("time_parameterization");
@@ -1275,11 +1655,8 @@ void MergerPrivate::merge(const ChildSolutionList& sub_solutions,
 		SubTrajectory t;
 		t.markAsFailure();
 		t.setComment(e.what());
-		spawner(std::move(t));
-		return;
+		return t;
 	}
-	if (jmg_merged_.get() != jmg)
-		jmg_merged_.reset(jmg);
 
 	assert(merged);
 	SubTrajectory t(merged);
@@ -1305,7 +1682,7 @@ void MergerPrivate::merge(const ChildSolutionList& sub_solutions,
 		}
 		t.setCost(costs);
 	}
-	spawner(std::move(t));
+	return t;
 }
 }  // namespace task_constructor
 }  // namespace moveit
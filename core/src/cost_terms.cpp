@@ -35,21 +35,112 @@
 /* Authors: Michael Goerner */
 
 #include <moveit/task_constructor/cost_terms.h>
+#include <moveit/task_constructor/batch_collision.h>
+#include <moveit/task_constructor/batch_kinematics.h>
 #include <moveit/task_constructor/stage.h>
+#include <moveit/task_constructor/stage_p.h>
+#include <moveit/task_constructor/thread_pool.h>
 #include <moveit/task_constructor/fmt_p.h>
+#include <moveit/task_constructor/solvers/planner_interface.h>
 
 #include <moveit/collision_detection/collision_common.h>
+#include <moveit/robot_model/revolute_joint_model.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_state/conversions.h>
 
 #include <Eigen/Geometry>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 namespace moveit {
 namespace task_constructor {
 
+namespace {
+// waypoint data of a solution's (non-empty) trajectory, shared by several cost terms
+class TrajectoryPass
+{
+	const robot_trajectory::RobotTrajectory& trajectory_;
+	std::shared_ptr<const SubTrajectory::Waypoints> waypoints_;
+	BatchForwardKinematics::Positions positions_;
+	std::map<const moveit::core::LinkModel*, BatchForwardKinematics::Transforms> transforms_;
+
+public:
+	TrajectoryPass(const SubTrajectory& s) : trajectory_{ *s.trajectory() }, waypoints_{ s.waypoints() } {}
+
+	const robot_trajectory::RobotTrajectory& trajectory() const { return trajectory_; }
+
+	/// global transforms of link for all waypoints, computed once in a single batch
+	const BatchForwardKinematics::Transforms& transforms(const moveit::core::LinkModel* link) {
+		auto it = transforms_.find(link);
+		if (it != transforms_.end())
+			return it->second;
+
+		const moveit::core::RobotState& first = trajectory_.getWayPoint(0);
+		const BatchForwardKinematics fk{ *first.getRobotModel(), link, trajectory_.getGroup() };
+		// the solution's cached joint values (of the trajectory's group), one column per waypoint
+		if (positions_.size() == 0)
+			positions_ = waypoints_->positions.transpose();
+		auto& result = transforms_[link];
+		fk.compute(first, positions_, result);
+		return result;
+	}
+};
+
+// Cartesian path length of a frame along a non-empty trajectory
+double linkMotion(const std::string& link_name, TrajectoryPass& pass, std::string& comment) {
+	const auto& first{ pass.trajectory().getWayPoint(0) };
+	if (!first.knowsFrameTransform(link_name)) {
+		comment = fmt::format("LinkMotionCost: frame '{}' unknown in trajectory", link_name);
+		return std::numeric_limits<double>::infinity();
+	}
+
+	// resolve frame once into its rigidly connected robot link and a fixed offset
+	const moveit::core::LinkModel* link{ first.getRigidlyConnectedParentLinkModel(link_name) };
+	const Eigen::Vector3d offset{ first.getGlobalLinkTransform(link).inverse() *
+	                              first.getFrameTransform(link_name).translation() };
+
+	// frame positions of all waypoints, computed from the trajectory's joint values in a single batch
+	const Eigen::Matrix3Xd positions{ pass.transforms(link).transformPoint(offset) };
+	const Eigen::Index num_waypoints{ positions.cols() };
+	return (positions.rightCols(num_waypoints - 1) - positions.leftCols(num_waypoints - 1)).colwise().norm().sum();
+}
+
+// PathLength's joint weights resolved to joint models
+std::map<const moveit::core::JointModel*, double> resolveWeights(const std::map<std::string, double>& joints,
+                                                                 const moveit::core::RobotState& state) {
+	std::map<const moveit::core::JointModel*, double> weights;
+	for (auto& joint_weight : joints) {
+		const moveit::core::JointModel* jm = state.getJointModel(joint_weight.first);
+		if (jm)
+			weights.emplace(jm, joint_weight.second);
+	}
+	return weights;
+}
+
+// joint-space distance between consecutive waypoints, see PathLength
+double waypointDistance(const moveit::core::RobotState& last, const moveit::core::RobotState& curr, bool all_joints,
+                        const std::map<const moveit::core::JointModel*, double>& weights) {
+	if (all_joints)
+		return last.distance(curr);
+	double distance{ 0.0 };
+	for (const auto& item : weights)
+		distance += item.second * last.distance(curr, item.first);
+	return distance;
+}
+}  // namespace
+
+uint64_t CostTerm::nextId() {
+	static std::atomic<uint64_t> last_id{ 0 };
+	return ++last_id;
+}
+
 double CostTerm::operator()(const SubTrajectory& s, std::string& /*comment*/) const {
 	return s.cost();
 }
@@ -66,7 +157,7 @@ double TrajectoryCostTerm::operator()(const SolutionSequence& s, std::string& co
 	double cost{ 0.0 };
 	std::string subcomment;
 	for (auto& solution : s.solutions()) {
-		cost += solution->computeCost((*this), subcomment);
+		cost += solution->computeCachedCost((*this), subcomment);
 		if (!subcomment.empty()) {
 			if (!comment.empty())
 				comment.append(", ");
@@ -79,7 +170,8 @@ double TrajectoryCostTerm::operator()(const SolutionSequence& s, std::string& co
 }
 
 double TrajectoryCostTerm::operator()(const WrappedSolution& s, std::string& comment) const {
-	return s.wrapped()->computeCost(*this, comment);
+	// wrappers don't contribute trajectory costs: evaluate the innermost solution directly
+	return s.innermost()->computeCachedCost(*this, comment);
 }
 
 LambdaCostTerm::LambdaCostTerm(const SubTrajectorySignature& term)
@@ -93,6 +185,40 @@ double LambdaCostTerm::operator()(const SubTrajectory& s, std::string& comment)
 	return term_(s, comment);
 }
 
+double WaypointCostTerm::operator()(const SubTrajectory& s, std::string& comment) const {
+	assert(bool{ term_ });
+	const auto& trajectory = s.trajectory();
+	if (!trajectory || trajectory->empty())
+		return 0.0;
+
+	const moveit::core::JointModelGroup* jmg = nullptr;
+	if (!group_.empty() && !(jmg = trajectory->getRobotModel()->getJointModelGroup(group_))) {
+		comment = fmt::format("WaypointCostTerm: unknown group '{}'", group_);
+		return std::numeric_limits<double>::infinity();
+	}
+
+	// the solution caches the waypoints of the trajectory's group
+	if (jmg == trajectory->getGroup()) {
+		const auto waypoints = s.waypoints();
+		return term_(waypoints->positions, waypoints->times, comment);
+	}
+
+	const size_t rows = trajectory->getWayPointCount();
+	const size_t cols = jmg ? jmg->getVariableCount() : trajectory->getRobotModel()->getVariableCount();
+	Matrix positions(rows, cols);
+	Eigen::VectorXd times(rows);
+	double time = 0.0;
+	for (size_t i = 0; i != rows; ++i) {
+		const moveit::core::RobotState& state = trajectory->getWayPoint(i);
+		if (jmg)
+			state.copyJointGroupPositions(jmg, positions.row(i).data());
+		else
+			std::copy_n(state.getVariablePositions(), cols, positions.row(i).data());
+		times[i] = (time += trajectory->getWayPointDurationFromPrevious(i));
+	}
+	return term_(positions, times, comment);
+}
+
 namespace cost {
 
 double Constant::operator()(const SubTrajectory& /*s*/, std::string& /*comment*/) const {
@@ -118,26 +244,11 @@ double PathLength::operator()(const SubTrajectory& s, std::string& /*comment*/)
 	if (traj == nullptr || traj->getWayPointCount() == 0)
 		return 0.0;
 
-	std::map<const moveit::core::JointModel*, double> weights;
-	const auto& first_waypoint = traj->getWayPoint(0);
-	for (auto& joint_weight : joints) {
-		const moveit::core::JointModel* jm = first_waypoint.getJointModel(joint_weight.first);
-		if (jm)
-			weights.emplace(jm, joint_weight.second);
-	}
+	const auto weights = resolveWeights(joints, traj->getWayPoint(0));
 
 	double path_length{ 0.0 };
-	for (size_t i = 1; i < traj->getWayPointCount(); ++i) {
-		auto& last = traj->getWayPoint(i - 1);
-		auto& curr = traj->getWayPoint(i);
-		if (joints.empty()) {
-			path_length += last.distance(curr);
-		} else {
-			for (const auto& item : weights) {
-				path_length += item.second * last.distance(curr, item.first);
-			}
-		}
-	}
+	for (size_t i = 1; i < traj->getWayPointCount(); ++i)
+		path_length += waypointDistance(traj->getWayPoint(i - 1), traj->getWayPoint(i), joints.empty(), weights);
 	return path_length;
 }
 
@@ -185,16 +296,51 @@ double DistanceToReference::operator()(const SubTrajectory& s, std::string& /*co
 	if (mode == Mode::START_INTERFACE || mode == Mode::END_INTERFACE || (mode == Mode::AUTO && (traj == nullptr))) {
 		return distance(state->scene()->getCurrentState());
 	} else {
+		// joints to consider with their weights, see RobotState::distance()
+		std::vector<std::pair<const moveit::core::JointModel*, double>> joints;
+		if (weights.empty()) {
+			for (const moveit::core::JointModel* jm : ref_state.getRobotModel()->getActiveJointModels())
+				joints.emplace_back(jm, jm->getDistanceFactor());
+		} else
+			joints.assign(w.begin(), w.end());
+
+		// accumulate distances joint-wise, reading single-variable joint values of all waypoints
+		// from the solution's cached matrix if the joint belongs to the trajectory's group
+		const size_t num_waypoints = traj->getWayPointCount();
+		const auto waypoints = s.waypoints();
+		Eigen::ArrayXd values(num_waypoints);
 		double accumulated = 0.0;
-		for (size_t i = 0; i < traj->getWayPointCount(); ++i)
-			accumulated += distance(traj->getWayPoint(i));
-		accumulated /= traj->getWayPointCount();
+		for (const auto& item : joints) {
+			const moveit::core::JointModel* jm = item.first;
+			const auto type = jm->getType();
+			if (jm->getVariableCount() != 1 ||
+			    (type != moveit::core::JointModel::REVOLUTE && type != moveit::core::JointModel::PRISMATIC)) {
+				for (size_t i = 0; i < num_waypoints; ++i)
+					accumulated += item.second * ref_state.distance(traj->getWayPoint(i), jm);
+				continue;
+			}
+			const int index = jm->getFirstVariableIndex();
+			const int column = waypoints->group ? waypoints->group->getVariableGroupIndex(jm->getName()) : index;
+			if (column >= 0)
+				values = waypoints->positions.col(column);
+			else
+				for (size_t i = 0; i < num_waypoints; ++i)
+					values[i] = traj->getWayPoint(i).getVariablePosition(index);
+			Eigen::ArrayXd d = (values - ref_state.getVariablePosition(index)).abs();
+			if (type == moveit::core::JointModel::REVOLUTE &&
+			    static_cast<const moveit::core::RevoluteJointModel*>(jm)->isContinuous()) {
+				d -= 2.0 * M_PI * (d / (2.0 * M_PI)).floor();
+				d = d.min(2.0 * M_PI - d);
+			}
+			accumulated += item.second * d.sum();
+		}
+		accumulated /= num_waypoints;
 		return accumulated;
 	}
 }
 
 double TrajectoryDuration::operator()(const SubTrajectory& s, std::string& /*comment*/) const {
-	return s.trajectory() ? s.trajectory()->getDuration() : 0.0;
+	return s.trajectory() ? solvers::trajectoryDuration(*s.trajectory()) : 0.0;
 }
 
 LinkMotion::LinkMotion(std::string link) : link_name{ std::move(link) } {}
@@ -205,19 +351,8 @@ double LinkMotion::operator()(const SubTrajectory& s, std::string& comment) cons
 	if (traj == nullptr || traj->getWayPointCount() == 0)
 		return 0.0;
 
-	if (!traj->getWayPoint(0).knowsFrameTransform(link_name)) {
-		comment = fmt::format("LinkMotionCost: frame '{}' unknown in trajectory", link_name);
-		return std::numeric_limits<double>::infinity();
-	}
-
-	double distance{ 0.0 };
-	Eigen::Vector3d position{ traj->getWayPoint(0).getFrameTransform(link_name).translation() };
-	for (size_t i{ 1 }; i < traj->getWayPointCount(); ++i) {
-		const auto& new_position{ traj->getWayPoint(i).getFrameTransform(link_name).translation() };
-		distance += (new_position - position).norm();
-		position = new_position;
-	}
-	return distance;
+	TrajectoryPass pass{ s };
+	return linkMotion(link_name, pass, comment);
 }
 
 Clearance::Clearance(bool with_world, bool cumulative, std::string group_property, Mode mode)
@@ -248,28 +383,21 @@ double Clearance::operator()(const SubTrajectory& s, std::string& comment) const
 	request.enableGroup(state->scene()->getRobotModel());
 	request.acm = &state->scene()->getAllowedCollisionMatrix();
 
-	// compute relevant distance data for state & robot
-	auto check_distance{ [=](const InterfaceState* state, const moveit::core::RobotState& robot) {
-		collision_detection::DistanceResult result;
-		if (with_world)
-			state->scene()->getCollisionEnv()->distanceRobot(request, result, robot);
-		else
-			state->scene()->getCollisionEnv()->distanceSelf(request, result, robot);
+	const BatchCollisionCheckerPtr checker = BatchCollisionChecker::active();
 
-		if (result.minimum_distance.distance <= 0) {
-			return result.minimum_distance;
-		}
+	// reduce distance data of a state to its minimum (or cumulative) distance
+	auto summarize{ [this](const collision_detection::DistanceResult& result) {
+		collision_detection::DistanceResultsData minimum = result.minimum_distance;
+		if (minimum.distance <= 0 || !cumulative)
+			return minimum;
 
-		if (cumulative) {
-			double distance{ 0.0 };
-			for (const auto& distance_of_pair : result.distances) {
-				assert(distance_of_pair.second.size() == 1);
-				distance += distance_of_pair.second[0].distance;
-			}
-			result.minimum_distance.distance = distance;
+		double distance{ 0.0 };
+		for (const auto& distance_of_pair : result.distances) {
+			assert(distance_of_pair.second.size() == 1);
+			distance += distance_of_pair.second[0].distance;
 		}
-
-		return result.minimum_distance;
+		minimum.distance = distance;
+		return minimum;
 	} };
 
 	auto collision_comment = [=](const auto& distance) {
@@ -281,7 +409,8 @@ double Clearance::operator()(const SubTrajectory& s, std::string& comment) const
 
 	if (mode == Mode::START_INTERFACE || mode == Mode::END_INTERFACE ||
 	    (mode == Mode::AUTO && s.trajectory() == nullptr)) {
-		auto distance_data{ check_distance(state, state->scene()->getCurrentState()) };
+		auto distance_data{ summarize(
+		    checker->distance(*state->scene(), { &state->scene()->getCurrentState() }, request, with_world).front()) };
 		if (distance_data.distance < 0) {
 			comment = collision_comment(distance_data);
 			return std::numeric_limits<double>::infinity();
@@ -293,20 +422,128 @@ double Clearance::operator()(const SubTrajectory& s, std::string& comment) const
 		else
 			comment = fmt::format(PREFIX + "cumulative distance {}", distance);
 	} else {  // check trajectory
-		for (size_t i = 0; i < s.trajectory()->getWayPointCount(); ++i) {
-			auto distance_data = check_distance(state, s.trajectory()->getWayPoint(i));
+		const auto& trajectory{ *s.trajectory() };
+		const size_t num_waypoints = trajectory.getWayPointCount();
+		std::vector<collision_detection::DistanceResultsData> results(num_waypoints);
+
+		// evaluate given waypoints as a batch, allowing the backend to use the task's thread pool (if any)
+		ThreadPool* pool = s.creator() ? s.creator()->pimpl()->solverPool() : nullptr;
+		auto check_waypoints = [&](const std::vector<size_t>& indices) {
+			BatchCollisionChecker::States states;
+			states.reserve(indices.size());
+			for (size_t i : indices)
+				states.push_back(&trajectory.getWayPoint(i));
+			auto distances = checker->distance(*state->scene(), states, request, with_world, pool);
+			for (size_t k = 0; k < indices.size(); ++k)
+				results[indices[k]] = summarize(distances[k]);
+		};
+
+		// check every stride-th waypoint (and the last one)
+		const size_t stride = std::max<size_t>(1, waypoint_stride);
+		std::vector<size_t> indices;
+		for (size_t i = 0; i < num_waypoints; i += stride)
+			indices.push_back(i);
+		if (!indices.empty() && indices.back() != num_waypoints - 1)
+			indices.push_back(num_waypoints - 1);
+		check_waypoints(indices);
+
+		if (stride > 1 && !indices.empty()) {
+			// refine around the sampled minimum
+			const size_t best = *std::min_element(indices.begin(), indices.end(), [&results](size_t a, size_t b) {
+				return results[a].distance < results[b].distance;
+			});
+			std::vector<size_t> refined;
+			for (size_t i = best > stride ? best - stride + 1 : 0; i < std::min(num_waypoints, best + stride); ++i)
+				if (i % stride != 0 && i != num_waypoints - 1)
+					refined.push_back(i);
+			check_waypoints(refined);
+			indices.insert(indices.end(), refined.begin(), refined.end());
+			std::sort(indices.begin(), indices.end());
+		}
+
+		for (size_t i : indices) {
+			const auto& distance_data = results[i];
 			if (distance_data.distance < 0) {
 				comment = collision_comment(distance_data);
 				return std::numeric_limits<double>::infinity();
 			}
 			distance += distance_data.distance;
 		}
-		distance /= s.trajectory()->getWayPointCount();
+		distance /= indices.size();
 		comment = fmt::format(PREFIX + "average{} distance: {}", (cumulative ? " cumulative" : ""), distance);
 	}
 
 	return distance_to_cost(distance);
 }
+
+uint64_t Composite::version() const {
+	uint64_t version = CostTerm::version();
+	for (const Term& t : terms)
+		version += t.term->version();
+	return version;
+}
+
+double Composite::operator()(const SubTrajectory& s, std::string& comment) const {
+	std::vector<double> costs(terms.size(), 0.0);
+	std::vector<bool> evaluated(terms.size(), false);
+	std::string subcomment;
+	auto append_comment = [&comment, &subcomment]() {
+		if (subcomment.empty())
+			return;
+		if (!comment.empty())
+			comment.append(", ");
+		comment.append(subcomment);
+		subcomment.clear();
+	};
+
+	const auto& traj = s.trajectory();
+	if (traj && traj->getWayPointCount() > 0) {
+		TrajectoryPass pass{ s };
+
+		struct PathTerm
+		{
+			size_t index;
+			bool all_joints;
+			std::map<const moveit::core::JointModel*, double> weights;
+		};
+		std::vector<PathTerm> path_terms;
+		for (size_t t = 0; t < terms.size(); ++t) {
+			const CostTerm& term = *terms[t].term;
+			// exact type match: derived classes might override the evaluation
+			if (typeid(term) == typeid(PathLength)) {
+				const auto& joints = static_cast<const PathLength&>(term).joints;
+				path_terms.push_back(PathTerm{ t, joints.empty(), resolveWeights(joints, traj->getWayPoint(0)) });
+				evaluated[t] = true;
+			} else if (typeid(term) == typeid(LinkMotion)) {
+				costs[t] = linkMotion(static_cast<const LinkMotion&>(term).link_name, pass, subcomment);
+				evaluated[t] = true;
+				append_comment();
+			}
+		}
+
+		// accumulate all path lengths in a single traversal of the waypoints
+		if (!path_terms.empty()) {
+			for (size_t i = 1; i < traj->getWayPointCount(); ++i) {
+				const auto& last = traj->getWayPoint(i - 1);
+				const auto& curr = traj->getWayPoint(i);
+				for (const PathTerm& term : path_terms)
+					costs[term.index] += waypointDistance(last, curr, term.all_joints, term.weights);
+			}
+		}
+	}
+
+	double cost{ 0.0 };
+	for (size_t t = 0; t < terms.size(); ++t) {
+		if (!evaluated[t]) {
+			costs[t] = (*terms[t].term)(s, subcomment);
+			append_comment();
+		}
+		if (std::isinf(costs[t]))
+			return std::numeric_limits<double>::infinity();
+		cost += terms[t].weight * costs[t];
+	}
+	return cost;
+}
 }  // namespace cost
 }  // namespace task_constructor
 }  // namespace moveit
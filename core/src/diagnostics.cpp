@@ -0,0 +1,228 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Rolling planning statistics published as ROS diagnostics
+*/
+
+#include <moveit/task_constructor/diagnostics.h>
+#include <moveit/task_constructor/container.h>
+#include <moveit/task_constructor/stage_p.h>
+
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <ros/node_handle.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+template <typename Duration>
+PlanningDiagnostics::Clock::duration toDuration(Duration d) {
+	return std::chrono::duration_cast<PlanningDiagnostics::Clock::duration>(d);
+}
+
+void addValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& key, double value) {
+	diagnostic_msgs::KeyValue kv;
+	kv.key = key;
+	kv.value = fmt::format("{:.4g}", value);
+	status.values.push_back(std::move(kv));
+}
+
+// nearest-rank percentile of sorted values
+double percentile(const std::vector<double>& sorted, double p) {
+	if (sorted.empty())
+		return 0.0;
+	size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+	return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+}  // namespace
+
+PlanningDiagnostics::PlanningDiagnostics(const std::string& name, double rate, double window)
+  : name_(name)
+  , period_(rate > 0.0 ? toDuration(std::chrono::duration<double>(1.0 / rate)) : Clock::duration::zero())
+  , window_(toDuration(std::chrono::duration<double>(window)))
+  , created_(Clock::now()) {
+	// only publish if ros::init() was called
+	if (ros::isInitialized())
+		publisher_ = ros::NodeHandle().advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+}
+
+PlanningDiagnostics::Counts PlanningDiagnostics::counts(const Stage& stage) {
+	Counts result;
+	result.states = stage.pimpl()->numStates();
+	result.solutions = stage.solutions().size();
+	result.failures = stage.numFailures();
+	return result;
+}
+
+void PlanningDiagnostics::planStarted(const ContainerBase& stages) {
+	plan_start_ = Clock::now();
+	time_to_first_solution_ = -1.0;
+	start_counts_.clear();
+	stages.traverseRecursively([this](const Stage& stage, unsigned int /*depth*/) {
+		start_counts_.emplace(&stage, counts(stage));
+		return true;
+	});
+}
+
+void PlanningDiagnostics::firstSolution() {
+	if (time_to_first_solution_ < 0.0)
+		time_to_first_solution_ = std::chrono::duration<double>(Clock::now() - plan_start_).count();
+}
+
+void PlanningDiagnostics::planFinished(const ContainerBase& stages, bool success) {
+	Plan plan;
+	plan.finished = Clock::now();
+	plan.time_to_first_solution = success ? time_to_first_solution_ : -1.0;
+	plan.success = success;
+	plan.pruned_states = 0;
+	stages.traverseRecursively([this, &plan](const Stage& stage, unsigned int /*depth*/) {
+		for (const InterfaceConstPtr& interface : { stage.pimpl()->starts(), stage.pimpl()->ends() }) {
+			if (!interface)
+				continue;
+			for (const InterfaceState* state : *interface)
+				plan.pruned_states += state->priority().status() == InterfaceState::Status::PRUNED;
+		}
+		// counters are reset by init(): count from zero for stages unknown at planStarted()
+		Counts start;
+		auto it = start_counts_.find(&stage);
+		if (it != start_counts_.end())
+			start = it->second;
+		Counts now = counts(stage);
+		Counts delta;
+		delta.states = now.states >= start.states ? now.states - start.states : now.states;
+		delta.solutions = now.solutions >= start.solutions ? now.solutions - start.solutions : now.solutions;
+		delta.failures = now.failures >= start.failures ? now.failures - start.failures : now.failures;
+		plan.stages.emplace_back(stage.name(), delta);
+		return true;
+	});
+	// a successful plan without recorded first solution found it before the first compute()
+	if (success && plan.time_to_first_solution < 0.0)
+		plan.time_to_first_solution = std::chrono::duration<double>(plan.finished - plan_start_).count();
+	start_counts_.clear();
+
+	plans_.push_back(std::move(plan));
+	trim(plans_.back().finished);
+}
+
+void PlanningDiagnostics::trim(Clock::time_point now) {
+	while (!plans_.empty() && now - plans_.front().finished > window_)
+		plans_.pop_front();
+}
+
+void PlanningDiagnostics::fillStatus(diagnostic_msgs::DiagnosticStatus& status, const ContainerBase& stages) const {
+	const auto now = Clock::now();
+	// rates refer to the window, or the lifetime of this instance if shorter
+	const double span = std::max(std::chrono::duration<double>(std::min(window_, now - created_)).count(), 1e-3);
+
+	size_t num_plans = 0;
+	size_t num_successes = 0;
+	size_t pruned_states = 0;
+	std::vector<double> first_solution_times;
+	std::map<std::string, Counts> stage_counts;  // aggregated by stage name
+	std::vector<std::string> stage_order;
+	for (const Plan& plan : plans_) {
+		if (now - plan.finished > window_)
+			continue;
+		++num_plans;
+		num_successes += plan.success;
+		pruned_states += plan.pruned_states;
+		if (plan.time_to_first_solution >= 0.0)
+			first_solution_times.push_back(plan.time_to_first_solution);
+		for (const auto& stage : plan.stages) {
+			auto inserted = stage_counts.emplace(stage.first, Counts());
+			if (inserted.second)
+				stage_order.push_back(stage.first);
+			Counts& counts = inserted.first->second;
+			counts.states += stage.second.states;
+			counts.solutions += stage.second.solutions;
+			counts.failures += stage.second.failures;
+		}
+	}
+	std::sort(first_solution_times.begin(), first_solution_times.end());
+
+	size_t memory = 0;
+	stages.traverseRecursively([&memory](const Stage& stage, unsigned int /*depth*/) {
+		memory += stage.memoryUsage().total();
+		return true;
+	});
+
+	const double window = std::chrono::duration<double>(window_).count();
+	status.name = "moveit_task_constructor: " + name_;
+	status.hardware_id = name_;
+	status.values.clear();
+	if (num_plans > 0 && num_successes == 0) {
+		status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+		status.message = fmt::format("all {} plan() calls of the last {}s failed", num_plans, window);
+	} else {
+		status.level = diagnostic_msgs::DiagnosticStatus::OK;
+		status.message = fmt::format("{} of {} plan() calls of the last {}s succeeded", num_successes, num_plans, window);
+	}
+
+	addValue(status, "plans/s", num_plans / span);
+	addValue(status, "success ratio", num_plans ? static_cast<double>(num_successes) / num_plans : 0.0);
+	addValue(status, "time to first solution p50 [s]", percentile(first_solution_times, 0.5));
+	addValue(status, "time to first solution p95 [s]", percentile(first_solution_times, 0.95));
+	addValue(status, "time to first solution max [s]",
+	         first_solution_times.empty() ? 0.0 : first_solution_times.back());
+	addValue(status, "pruned states/s", pruned_states / span);
+	addValue(status, "memory [bytes]", memory);
+	for (const std::string& name : stage_order) {
+		const Counts& counts = stage_counts[name];
+		addValue(status, name + ": states/s", counts.states / span);
+		const size_t attempts = counts.solutions + counts.failures;
+		addValue(status, name + ": failure ratio", attempts ? static_cast<double>(counts.failures) / attempts : 0.0);
+	}
+}
+
+void PlanningDiagnostics::publish(const ContainerBase& stages, bool force) {
+	if (!publisher_)
+		return;
+	const auto now = Clock::now();
+	if (!force && now - last_published_ < period_)
+		return;
+	last_published_ = now;
+
+	diagnostic_msgs::DiagnosticArray msg;
+	msg.header.stamp = ros::Time::now();
+	msg.status.resize(1);
+	fillStatus(msg.status.front(), stages);
+	publisher_.publish(msg);
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,178 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Compact binary log of planning events for offline analysis
+*/
+
+#include <moveit/task_constructor/event_log.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+constexpr char MAGIC[8] = { 'M', 'T', 'C', 'E', 'V', 'L', 'G', '\0' };
+constexpr uint32_t VERSION = 1;
+
+static_assert(sizeof(EventLog::Event) == 32, "keep events compact");
+
+template <typename T>
+void put(std::ostream& os, const T& value) {
+	os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T get(std::istream& is) {
+	T value;
+	if (!is.read(reinterpret_cast<char*>(&value), sizeof(T)))
+		throw std::runtime_error("EventLog: truncated log");
+	return value;
+}
+
+const char* typeName(uint8_t type) {
+	static const char* const NAMES[] = { "COMPUTE_BEGIN", "COMPUTE_END", "STATE", "SOLUTION", "FAILURE", "STATUS" };
+	return type < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[type] : "UNKNOWN";
+}
+}  // namespace
+
+EventLog::EventLog(size_t capacity)
+  : capacity_(std::max<size_t>(capacity, 1))
+  , ring_(new Event[capacity_])
+  , origin_(std::chrono::steady_clock::now()) {}
+
+uint16_t EventLog::threadId() {
+	static std::atomic<uint16_t> next{ 0 };
+	thread_local const uint16_t id = next++;
+	return id;
+}
+
+void EventLog::setStageName(uint32_t stage, const std::string& name) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	stage_names_[stage] = name;
+}
+
+void EventLog::clear() {
+	origin_ = std::chrono::steady_clock::now();
+	head_ = 0;
+}
+
+EventLog::Contents EventLog::contents() const {
+	Contents result;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		result.stages = stage_names_;
+	}
+	result.recorded = recorded();
+	const uint64_t first = result.recorded > capacity_ ? result.recorded - capacity_ : 0;
+	result.events.reserve(result.recorded - first);
+	for (uint64_t i = first; i < result.recorded; ++i)
+		result.events.push_back(ring_[i % capacity_]);
+	return result;
+}
+
+void EventLog::write(std::ostream& os) const {
+	const Contents c = contents();
+	os.write(MAGIC, sizeof(MAGIC));
+	put(os, VERSION);
+	put(os, static_cast<uint32_t>(c.stages.size()));
+	for (const auto& stage : c.stages) {
+		put(os, stage.first);
+		put(os, static_cast<uint32_t>(stage.second.size()));
+		os.write(stage.second.data(), stage.second.size());
+	}
+	put(os, c.recorded);
+	put(os, static_cast<uint64_t>(c.events.size()));
+	os.write(reinterpret_cast<const char*>(c.events.data()), c.events.size() * sizeof(Event));
+}
+
+void EventLog::write(const std::string& path) const {
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		throw std::runtime_error("EventLog: cannot open '" + path + "' for writing");
+	write(file);
+	if (!file)
+		throw std::runtime_error("EventLog: failed to write '" + path + "'");
+}
+
+EventLog::Contents EventLog::read(std::istream& is) {
+	char magic[sizeof(MAGIC)];
+	if (!is.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+		throw std::runtime_error("EventLog: not an event log");
+	if (get<uint32_t>(is) != VERSION)
+		throw std::runtime_error("EventLog: unsupported version");
+
+	Contents c;
+	for (uint32_t i = 0, n = get<uint32_t>(is); i < n; ++i) {
+		const uint32_t id = get<uint32_t>(is);
+		std::string name(get<uint32_t>(is), '\0');
+		if (!is.read(&name[0], name.size()))
+			throw std::runtime_error("EventLog: truncated log");
+		c.stages.emplace(id, std::move(name));
+	}
+	c.recorded = get<uint64_t>(is);
+	const uint64_t num_events = get<uint64_t>(is);
+	if (num_events > c.recorded)
+		throw std::runtime_error("EventLog: corrupt log");
+	c.events.resize(num_events);
+	if (!is.read(reinterpret_cast<char*>(c.events.data()), num_events * sizeof(Event)))
+		throw std::runtime_error("EventLog: truncated log");
+	return c;
+}
+
+EventLog::Contents EventLog::read(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		throw std::runtime_error("EventLog: cannot open '" + path + "'");
+	return read(file);
+}
+
+void EventLog::print(std::ostream& os, const Contents& contents) {
+	if (contents.recorded > contents.events.size())
+		os << "# " << contents.recorded - contents.events.size() << " older events were overwritten\n";
+	os << "# time (ms)  thread  event  stage  id  depth  value  detail\n";
+	for (const Event& e : contents.events) {
+		auto name = contents.stages.find(e.stage);
+		os << std::fixed << std::setprecision(3) << e.time * 1e-6 << ' ' << e.thread << ' ' << typeName(e.type) << " '"
+		   << (name != contents.stages.end() ? name->second : std::string()) << "'[" << e.stage << "] " << e.id << ' '
+		   << e.depth << ' ' << std::setprecision(6) << e.value << ' ' << static_cast<int>(e.detail) << '\n';
+	}
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,302 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Memory-mapped database of precomputed, reachable grasps
+*/
+
+#include <moveit/task_constructor/grasp_database.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+constexpr char MAGIC[8] = { 'M', 'T', 'C', 'G', 'R', 'S', 'P', '\0' };
+constexpr uint32_t VERSION = 1;
+}  // namespace
+
+struct GraspDatabase::Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t num_joints;
+	uint64_t num_entries;
+	// byte offsets of sections
+	uint64_t names;
+	uint64_t names_size;
+	uint64_t entries;
+	uint64_t joints;
+	uint64_t file_size;
+};
+
+struct GraspDatabase::EntryRecord
+{
+	double object_position[3];
+	double object_orientation[4];  // quaternion x, y, z, w
+	double grasp_position[3];
+	double grasp_orientation[4];
+	double cost;
+	uint32_t grasp_id;
+	uint32_t reserved;
+};
+
+namespace {
+void toArrays(const Eigen::Isometry3d& pose, double* position, double* orientation) {
+	Eigen::Map<Eigen::Vector3d>{ position } = pose.translation();
+	const Eigen::Quaterniond q(pose.linear());
+	orientation[0] = q.x();
+	orientation[1] = q.y();
+	orientation[2] = q.z();
+	orientation[3] = q.w();
+}
+
+Eigen::Isometry3d fromArrays(const double* position, const double* orientation) {
+	Eigen::Isometry3d pose(Eigen::Quaterniond(orientation[3], orientation[0], orientation[1], orientation[2]));
+	pose.translation() = Eigen::Map<const Eigen::Vector3d>(position);
+	return pose;
+}
+
+// sort range [first, last) into an implicit KD-tree: median at the center, splitting along axis = depth % 3
+template <typename Iterator>
+void buildTree(Iterator first, Iterator last, size_t depth) {
+	if (last - first < 2)
+		return;
+	const size_t axis = depth % 3;
+	Iterator mid = first + (last - first) / 2;
+	std::nth_element(first, mid, last, [axis](const auto& a, const auto& b) {
+		return a.object_pose.translation()[axis] < b.object_pose.translation()[axis];
+	});
+	buildTree(first, mid, depth + 1);
+	buildTree(mid + 1, last, depth + 1);
+}
+}  // namespace
+
+void GraspDatabase::write(const std::string& path, const std::string& reference_frame,
+                          const std::vector<std::string>& joint_names, std::vector<Entry> entries) {
+	static_assert(sizeof(Header) % 8 == 0 && sizeof(EntryRecord) % 8 == 0,
+	              "records need to keep the joints section aligned");
+	for (const Entry& e : entries)
+		if (e.joint_positions.size() != joint_names.size())
+			throw std::runtime_error("GraspDatabase: joint positions don't match joint names");
+
+	buildTree(entries.begin(), entries.end(), 0);
+
+	std::string names = reference_frame + '\0';
+	for (const std::string& name : joint_names)
+		names.append(name).push_back('\0');
+	names.resize((names.size() + 7) & ~size_t(7), '\0');  // keep entries aligned
+
+	std::vector<EntryRecord> records;
+	std::vector<double> joints;
+	records.reserve(entries.size());
+	joints.reserve(entries.size() * joint_names.size());
+	for (const Entry& e : entries) {
+		EntryRecord r{};
+		toArrays(e.object_pose, r.object_position, r.object_orientation);
+		toArrays(e.grasp_pose, r.grasp_position, r.grasp_orientation);
+		r.cost = e.cost;
+		r.grasp_id = e.grasp_id;
+		records.push_back(r);
+		joints.insert(joints.end(), e.joint_positions.begin(), e.joint_positions.end());
+	}
+
+	Header header{};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.num_joints = joint_names.size();
+	header.num_entries = records.size();
+	header.names = sizeof(Header);
+	header.names_size = names.size();
+	header.entries = header.names + names.size();
+	header.joints = header.entries + records.size() * sizeof(EntryRecord);
+	header.file_size = header.joints + joints.size() * sizeof(double);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("GraspDatabase: cannot open '" + path + "' for writing");
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(names.data(), static_cast<std::streamsize>(names.size()));
+	file.write(reinterpret_cast<const char*>(records.data()),
+	           static_cast<std::streamsize>(records.size() * sizeof(EntryRecord)));
+	file.write(reinterpret_cast<const char*>(joints.data()), static_cast<std::streamsize>(joints.size() * sizeof(double)));
+	if (!file)
+		throw std::runtime_error("GraspDatabase: failed to write '" + path + "'");
+}
+
+GraspDatabase::GraspDatabase(const std::string& path) {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("GraspDatabase: cannot open '" + path + "'");
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+		::close(fd);
+		throw std::runtime_error("GraspDatabase: '" + path + "' is not a grasp database");
+	}
+	size_ = st.st_size;
+	void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);  // the mapping stays valid
+	if (data == MAP_FAILED)
+		throw std::runtime_error("GraspDatabase: cannot map '" + path + "'");
+	data_ = static_cast<const uint8_t*>(data);
+	header_ = reinterpret_cast<const Header*>(data_);
+
+	const Header& h = *header_;
+	bool valid = std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.version == VERSION && h.file_size == size_ &&
+	             h.names == sizeof(Header) && h.entries == h.names + h.names_size &&
+	             h.joints == h.entries + h.num_entries * sizeof(EntryRecord) &&
+	             h.file_size == h.joints + h.num_entries * h.num_joints * sizeof(double);
+	if (valid) {  // split names section into reference frame and joint names
+		const char* name = reinterpret_cast<const char*>(data_ + h.names);
+		const char* end = name + h.names_size;
+		std::vector<std::string> names;
+		while (name < end && *name && names.size() <= h.num_joints) {
+			const char* terminator = static_cast<const char*>(std::memchr(name, '\0', end - name));
+			if (!terminator)
+				break;
+			names.emplace_back(name, terminator);
+			name = terminator + 1;
+		}
+		valid = names.size() == h.num_joints + 1;
+		if (valid) {
+			reference_frame_ = std::move(names.front());
+			joint_names_.assign(std::make_move_iterator(names.begin() + 1), std::make_move_iterator(names.end()));
+		}
+	}
+	if (!valid) {
+		::munmap(const_cast<uint8_t*>(data_), size_);
+		throw std::runtime_error("GraspDatabase: '" + path + "' is corrupt or has an unsupported version");
+	}
+}
+
+GraspDatabase::~GraspDatabase() {
+	::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+size_t GraspDatabase::size() const {
+	return header_->num_entries;
+}
+
+const GraspDatabase::EntryRecord& GraspDatabase::record(size_t index) const {
+	if (index >= header_->num_entries)
+		throw std::out_of_range("GraspDatabase: invalid entry index");
+	return reinterpret_cast<const EntryRecord*>(data_ + header_->entries)[index];
+}
+
+Eigen::Isometry3d GraspDatabase::objectPose(size_t index) const {
+	const EntryRecord& r = record(index);
+	return fromArrays(r.object_position, r.object_orientation);
+}
+
+Eigen::Isometry3d GraspDatabase::graspPose(size_t index) const {
+	const EntryRecord& r = record(index);
+	return fromArrays(r.grasp_position, r.grasp_orientation);
+}
+
+const double* GraspDatabase::jointPositions(size_t index) const {
+	record(index);  // validate index
+	return reinterpret_cast<const double*>(data_ + header_->joints) + index * header_->num_joints;
+}
+
+uint32_t GraspDatabase::graspId(size_t index) const {
+	return record(index).grasp_id;
+}
+
+double GraspDatabase::cost(size_t index) const {
+	return record(index).cost;
+}
+
+std::vector<GraspDatabase::Match> GraspDatabase::lookup(const Eigen::Isometry3d& object_pose, double max_distance,
+                                                        double max_angle) const {
+	const EntryRecord* records = reinterpret_cast<const EntryRecord*>(data_ + header_->entries);
+	const Eigen::Vector3d position = object_pose.translation();
+	const Eigen::Quaterniond orientation(object_pose.linear());
+	const double max_distance_sq = max_distance * max_distance;
+
+	std::unordered_map<uint32_t, Match> best;  // closest match per grasp id
+	auto visit = [&](size_t first, size_t last, size_t depth, auto& self) -> void {
+		if (first >= last)
+			return;
+		const size_t mid = first + (last - first) / 2;
+		const EntryRecord& r = records[mid];
+		const Eigen::Vector3d delta = Eigen::Map<const Eigen::Vector3d>(r.object_position) - position;
+		const double distance_sq = delta.squaredNorm();
+		if (distance_sq <= max_distance_sq) {
+			const Eigen::Quaterniond q(r.object_orientation[3], r.object_orientation[0], r.object_orientation[1],
+			                           r.object_orientation[2]);
+			const double angle = 2.0 * std::acos(std::min(1.0, std::abs(q.dot(orientation))));
+			if (angle <= max_angle) {
+				const double distance = (max_distance > 0.0 ? std::sqrt(distance_sq) / max_distance : 0.0) +
+				                        (max_angle > 0.0 ? angle / max_angle : 0.0);
+				auto inserted = best.emplace(r.grasp_id, Match{ mid, distance });
+				if (!inserted.second && distance < inserted.first->second.distance)
+					inserted.first->second = Match{ mid, distance };
+			}
+		}
+		// descend into the half containing the query first, into the other one only if within reach
+		const size_t axis = depth % 3;
+		const double offset = -delta[axis];  // query - median along split axis
+		if (offset < 0.0) {
+			self(first, mid, depth + 1, self);
+			if (-offset <= max_distance)
+				self(mid + 1, last, depth + 1, self);
+		} else {
+			self(mid + 1, last, depth + 1, self);
+			if (offset <= max_distance)
+				self(first, mid, depth + 1, self);
+		}
+	};
+	visit(0, header_->num_entries, 0, visit);
+
+	std::vector<Match> matches;
+	matches.reserve(best.size());
+	for (const auto& pair : best)
+		matches.push_back(pair.second);
+	std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+		return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+	});
+	return matches;
+}
+}  // namespace task_constructor
+}  // namespace moveit
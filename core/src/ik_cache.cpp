@@ -0,0 +1,199 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Cache for IK solutions, keyed by group, IK link, quantized target pose, and collision environment
+*/
+
+#include <moveit/task_constructor/ik_cache.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit_msgs/PlanningSceneComponents.h>
+
+#include <ros/console.h>
+#include <ros/serialization.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+template <typename T>
+void append(std::string& buffer, const T& value) {
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+}  // namespace
+
+IKCache::IKCache(double position_tolerance, double orientation_tolerance, size_t capacity, const std::string& directory)
+  : position_tolerance_(std::max(position_tolerance, std::numeric_limits<double>::epsilon()))
+  , orientation_tolerance_(std::max(orientation_tolerance, std::numeric_limits<double>::epsilon()))
+  , capacity_(std::max<size_t>(1, capacity))
+  , directory_(directory) {}
+
+std::size_t IKCache::collisionSignature(const planning_scene::PlanningScene& scene,
+                                        const moveit::core::JointModelGroup* jmg) {
+	moveit_msgs::PlanningSceneComponents components;
+	components.components = moveit_msgs::PlanningSceneComponents::ROBOT_STATE_ATTACHED_OBJECTS |
+	                        moveit_msgs::PlanningSceneComponents::WORLD_OBJECT_GEOMETRY |
+	                        moveit_msgs::PlanningSceneComponents::ALLOWED_COLLISION_MATRIX;
+	moveit_msgs::PlanningScene msg;
+	scene.getPlanningSceneMsg(msg, components);
+
+	std::string buffer(ros::serialization::serializationLength(msg), '\0');
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[0]), buffer.size());
+	ros::serialization::serialize(stream, msg);
+
+	// joint values outside the group
+	const moveit::core::RobotState& state = scene.getCurrentState();
+	const std::vector<int>& group_variables = jmg->getVariableIndexList();
+	for (size_t i = 0; i < state.getVariableCount(); ++i)
+		if (std::find(group_variables.begin(), group_variables.end(), static_cast<int>(i)) == group_variables.end())
+			append(buffer, state.getVariablePosition(i));
+
+	return std::hash<std::string>()(buffer);
+}
+
+IKCache::Key IKCache::computeKey(const moveit::core::JointModelGroup* jmg, const moveit::core::LinkModel* link,
+                                 const Eigen::Isometry3d& target, std::size_t signature) const {
+	std::string buffer = jmg->getName();
+	buffer += '\0';
+	buffer += link->getName();
+	buffer += '\0';
+	append(buffer, signature);
+
+	for (int i = 0; i < 3; ++i)
+		append(buffer, static_cast<int64_t>(std::floor(target.translation()[i] / position_tolerance_)));
+	Eigen::Quaterniond q(target.linear());
+	if (q.w() < 0)  // canonical sign
+		q.coeffs() = -q.coeffs();
+	for (int i = 0; i < 4; ++i)
+		append(buffer, static_cast<int64_t>(std::floor(q.coeffs()[i] / orientation_tolerance_)));
+
+	return std::hash<std::string>()(buffer);
+}
+
+bool IKCache::matches(const Eigen::Isometry3d& reached, const Eigen::Isometry3d& target) const {
+	// maximum deviations within a quantization cell
+	if ((reached.translation() - target.translation()).norm() > std::sqrt(3.0) * position_tolerance_)
+		return false;
+	const double angle = Eigen::AngleAxisd(reached.linear().transpose() * target.linear()).angle();
+	return angle <= 4.0 * orientation_tolerance_;
+}
+
+bool IKCache::lookup(Key key, Solutions& solutions) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = index_.find(key);
+		if (it != index_.end()) {
+			entries_.splice(entries_.begin(), entries_, it->second);  // mark as most recently used
+			solutions = it->second->second;
+			return true;
+		}
+	}
+	if (directory_.empty())
+		return false;
+
+	// fall back to persisted entry: one solution per line
+	std::ifstream file(path(key));
+	if (!file)
+		return false;
+	solutions.clear();
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream iss(line);
+		solutions.emplace_back(std::istream_iterator<double>(iss), std::istream_iterator<double>());
+		if (!iss.eof()) {
+			ROS_WARN_STREAM_NAMED("IKCache", "Ignoring corrupt cache entry " << path(key));
+			return false;
+		}
+	}
+	insert(key, solutions);
+	return true;
+}
+
+void IKCache::store(Key key, const Solutions& solutions) {
+	insert(key, solutions);
+
+	if (directory_.empty())
+		return;
+	std::ofstream file(path(key), std::ios::trunc);
+	file << std::setprecision(std::numeric_limits<double>::max_digits10);
+	for (const auto& solution : solutions) {
+		for (size_t i = 0; i < solution.size(); ++i)
+			file << (i ? " " : "") << solution[i];
+		file << '\n';
+	}
+	if (!file)
+		ROS_WARN_STREAM_NAMED("IKCache", "Failed to write cache entry " << path(key));
+}
+
+size_t IKCache::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return entries_.size();
+}
+
+void IKCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+	index_.clear();
+}
+
+void IKCache::insert(Key key, const Solutions& solutions) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = index_.find(key);
+	if (it != index_.end()) {
+		it->second->second = solutions;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return;
+	}
+	entries_.emplace_front(key, solutions);
+	index_.emplace(key, entries_.begin());
+	if (entries_.size() > capacity_) {  // evict least recently used entry
+		index_.erase(entries_.back().first);
+		entries_.pop_back();
+	}
+}
+
+std::string IKCache::path(Key key) const {
+	std::ostringstream oss;
+	oss << directory_ << '/' << std::hex << key << ".ik";
+	return oss.str();
+}
+}  // namespace task_constructor
+}  // namespace moveit
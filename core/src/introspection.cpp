@@ -39,15 +39,28 @@
 #include <moveit/task_constructor/introspection.h>
 #include <moveit/task_constructor/task.h>
 #include <moveit/task_constructor/storage.h>
+#include <moveit/task_constructor/solution_ring.h>
+#include <moveit/task_constructor/trace.h>
 #include <moveit_task_constructor_msgs/Property.h>
 
 #include <ros/node_handle.h>
 #include <ros/publisher.h>
 #include <ros/service.h>
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
 #include <moveit/planning_scene/planning_scene.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <sstream>
-#include <boost/bimap.hpp>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/make_shared.hpp>
 
 namespace ros {
 namespace names {
@@ -72,6 +85,26 @@ std::string getTaskId(const TaskPrivate* task) {
 	oss << our_hostname << "_" << getpid() << "_" << reinterpret_cast<std::size_t>(task);
 	return oss.str();
 }
+
+// merge a newer TaskStatistics msg into a not yet published one
+void mergeStatistics(moveit_task_constructor_msgs::TaskStatistics& pending,
+                     moveit_task_constructor_msgs::TaskStatistics&& next) {
+	if (!next.incremental) {  // complete msg supersedes everything
+		pending = std::move(next);
+		return;
+	}
+	for (auto& stat : next.stages) {
+		auto it = std::find_if(pending.stages.begin(), pending.stages.end(),
+		                       [&stat](const moveit_task_constructor_msgs::StageStatistics& s) { return s.id == stat.id; });
+		if (it == pending.stages.end()) {
+			pending.stages.push_back(std::move(stat));
+			continue;
+		}
+		// incremental msgs only list new failures, everything else is complete
+		stat.failed.insert(stat.failed.begin(), it->failed.begin(), it->failed.end());
+		*it = std::move(stat);
+	}
+}
 }  // namespace
 
 class IntrospectionPrivate
@@ -80,7 +113,9 @@ public:
 	IntrospectionPrivate(const TaskPrivate* task, Introspection* self)
 	  : nh_(std::string("~/") + task->ns())  // topics + services are advertised in private namespace
 	  , task_(task)
-	  , task_id_(getTaskId(task)) {
+	  , task_id_(getTaskId(task))
+	  , service_nh_(nh_)
+	  , service_spinner_(1, &service_queue_) {
 		task_description_publisher_ =
 		    nh_.advertise<moveit_task_constructor_msgs::TaskDescription>(DESCRIPTION_TOPIC, 2, true);
 		// send reset message as early as possible to give subscribers time to see it
@@ -93,15 +128,94 @@ public:
 		get_solution_service_ =
 		    nh_.advertiseService(std::string(GET_SOLUTION_SERVICE "_") + task_id_, &Introspection::getSolution, self);
 
+		// GetSolutions is served from its own thread, such that clients don't need to wait for planning
+		service_nh_.setCallbackQueue(&service_queue_);
+		get_solutions_service_ = service_nh_.advertiseService(std::string(GET_SOLUTIONS_SERVICE "_") + task_id_,
+		                                                      &Introspection::getSolutions, self);
+		service_spinner_.start();
+
 		resetMaps();
 	}
-	~IntrospectionPrivate() { indicateReset(); }
+	~IntrospectionPrivate() {
+		stopPublisher();
+		service_spinner_.stop();
+		indicateReset();
+	}
 
 	void indicateReset() {
 		// send empty task description message to indicate reset
-		::moveit_task_constructor_msgs::TaskDescription msg;
-		msg.task_id = task_id_;
-		task_description_publisher_.publish(msg);
+		auto msg = boost::make_shared<moveit_task_constructor_msgs::TaskDescription>();
+		msg->task_id = task_id_;
+		if (asyncPublishing()) {
+			std::lock_guard<std::mutex> lock(queue_mutex_);
+			// queued msgs are outdated now
+			queue_.clear();
+			queued_statistics_.reset();
+			queue_.push_back(PublishJob{ [this, msg] { task_description_publisher_.publish(msg); }, false });
+			queue_cv_.notify_all();
+		} else
+			task_description_publisher_.publish(msg);
+	}
+
+	bool asyncPublishing() const { return publisher_thread_.joinable(); }
+
+	void startPublisher() {
+		if (asyncPublishing())
+			return;
+		stop_publisher_ = false;
+		publisher_thread_ = std::thread(&IntrospectionPrivate::runPublisher, this);
+	}
+
+	/// stop the publishing thread after publishing all queued msgs
+	void stopPublisher() {
+		if (!asyncPublishing())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex_);
+			stop_publisher_ = true;
+		}
+		queue_cv_.notify_all();
+		publisher_thread_.join();
+	}
+
+	void runPublisher() {
+		std::unique_lock<std::mutex> lock(queue_mutex_);
+		while (true) {
+			queue_cv_.wait(lock, [this] { return stop_publisher_ || !queue_.empty(); });
+			if (queue_.empty())
+				return;  // stopped and drained
+
+			PublishJob job = std::move(queue_.front());
+			queue_.pop_front();
+			if (job.statistics)
+				queued_statistics_.reset();  // don't coalesce into a msg being published
+			queue_cv_.notify_all();  // signal free slot
+
+			lock.unlock();
+			job.publish();
+			lock.lock();
+		}
+	}
+
+	/// queue a job for the publishing thread, waiting for a free slot if the queue is full
+	void enqueue(std::function<void()>&& publish) {
+		std::unique_lock<std::mutex> lock(queue_mutex_);
+		queue_cv_.wait(lock, [this] { return queue_.size() < MAX_QUEUED_JOBS; });
+		queue_.push_back(PublishJob{ std::move(publish), false });
+		queue_cv_.notify_all();
+	}
+
+	/// queue a statistics msg, coalescing it with a still queued one
+	void enqueue(moveit_task_constructor_msgs::TaskStatisticsPtr&& msg) {
+		std::unique_lock<std::mutex> lock(queue_mutex_);
+		if (queued_statistics_) {
+			mergeStatistics(*queued_statistics_, std::move(*msg));
+			return;
+		}
+		queue_cv_.wait(lock, [this] { return queue_.size() < MAX_QUEUED_JOBS; });
+		queued_statistics_ = msg;
+		queue_.push_back(PublishJob{ [this, msg] { task_statistics_publisher_.publish(msg); }, true });
+		queue_cv_.notify_all();
 	}
 
 	void resetMaps() {
@@ -109,7 +223,16 @@ public:
 		stage_to_id_map_.clear();
 		stage_to_id_map_[task_] = 0;  // root is task having ID = 0
 
-		id_solution_bimap_.clear();
+		// ids are not reused across resets, such that stale ids of solutions never alias new ones
+		first_solution_id_ += solutions_by_id_.size();
+		solutions_by_id_.clear();
+		solution_msgs_.clear();
+
+		streamed_trajectories_.clear();
+		streamed_scenes_.clear();
+
+		published_statistics_.clear();
+		published_descriptions_.clear();
 	}
 
 	ros::NodeHandle nh_;
@@ -122,12 +245,86 @@ public:
 	ros::Publisher task_statistics_publisher_;
 	/// publish new solutions
 	ros::Publisher solution_publisher_;
+	/// publish new solutions incrementally, only valid if streaming is enabled
+	ros::Publisher solution_stream_publisher_;
+	/// shared-memory transport of solutions, only valid if enabled
+	SolutionRingPtr solution_ring_;
+	ros::Publisher solution_handle_publisher_;
 	/// services to provide an individual Solution
 	ros::ServiceServer get_solution_service_;
 
+	/// service to provide multiple solutions, processed by service_spinner_
+	ros::NodeHandle service_nh_;
+	ros::CallbackQueue service_queue_;
+	ros::AsyncSpinner service_spinner_;
+	ros::ServiceServer get_solutions_service_;
+	/// protect solution and stage maps from concurrent access by service threads
+	std::recursive_mutex mutex_;
+
 	/// mapping from stages to their id
 	std::map<const StagePrivate*, moveit_task_constructor_msgs::StageStatistics::_id_type> stage_to_id_map_;
-	boost::bimap<uint32_t, const SolutionBase*> id_solution_bimap_;
+	/// registered solutions, indexed by id - first_solution_id_, nullptr for expired ids
+	std::deque<const SolutionBase*> solutions_by_id_;
+	/// id of solutions_by_id_.front(), leading expired ids are released
+	uint32_t first_solution_id_ = 1;
+	/// release ids of evicted solutions
+	bool expire_solutions_ = false;
+
+	/// Solution msgs already created, indexed by solution id
+	struct CachedSolution
+	{
+		moveit_task_constructor_msgs::SolutionConstPtr msg;
+		double cost;  // cost at creation time, to detect invalidated solutions
+	};
+	std::unordered_map<uint32_t, CachedSolution> solution_msgs_;
+
+	/// minimum period between two published TaskStatistics messages
+	std::chrono::steady_clock::duration statistics_period_ = std::chrono::steady_clock::duration::zero();
+	std::chrono::steady_clock::time_point last_statistics_;
+	bool incremental_statistics_ = false;
+
+	/// state of a stage as reported by the last published (incremental) TaskStatistics message
+	struct PublishedStatistics
+	{
+		moveit_task_constructor_msgs::StageStatistics::_solved_type solved;
+		std::size_t num_failures;  // number of failure ids already sent
+		uint32_t num_failed;
+		double total_compute_time;
+		uint32_t scene_diff_depth;
+		std::size_t memory;  // total memory usage
+	};
+	std::map<uint32_t, PublishedStatistics> published_statistics_;
+
+	bool incremental_description_ = false;
+	bool human_readable_properties_ = true;
+	/// state of a stage as reported by the last published TaskDescription message
+	struct PublishedDescription
+	{
+		uint64_t properties_generation;
+		std::string name;
+		uint32_t flags;
+	};
+	std::map<uint32_t, PublishedDescription> published_descriptions_;
+
+	/// ids of sub trajectories already sent via solution_stream_publisher_
+	std::unordered_set<uint32_t> streamed_trajectories_;
+	/// start scenes already sent via solution_stream_publisher_ with their id
+	std::map<planning_scene::PlanningSceneConstPtr, uint32_t> streamed_scenes_;
+
+	/// asynchronous publishing, thread only running if enabled
+	struct PublishJob
+	{
+		std::function<void()> publish;
+		bool statistics;  // publishing queued_statistics_
+	};
+	static constexpr std::size_t MAX_QUEUED_JOBS = 100;
+	std::thread publisher_thread_;
+	std::mutex queue_mutex_;
+	std::condition_variable queue_cv_;  // signals new jobs, free slots, and stopping
+	std::deque<PublishJob> queue_;
+	bool stop_publisher_ = false;
+	/// statistics msg still waiting in queue_, newer msgs are merged into it
+	moveit_task_constructor_msgs::TaskStatisticsPtr queued_statistics_;
 };
 
 Introspection::Introspection(const TaskPrivate* task) : impl(new IntrospectionPrivate(task, this)) {}
@@ -137,16 +334,75 @@ Introspection::~Introspection() {
 }
 
 void Introspection::publishTaskDescription() {
-	::moveit_task_constructor_msgs::TaskDescription msg;
-	impl->task_description_publisher_.publish(fillTaskDescription(msg));
+	auto msg = boost::make_shared<moveit_task_constructor_msgs::TaskDescription>();
+	if (impl->incremental_description_ && !impl->published_descriptions_.empty()) {
+		fillIncrementalTaskDescription(*msg);
+		if (msg->stages.empty())
+			return;  // nothing changed (and an empty description would indicate a reset)
+	} else
+		fillTaskDescription(*msg);
+	if (impl->asyncPublishing())
+		impl->enqueue([this, msg] { impl->task_description_publisher_.publish(msg); });
+	else
+		impl->task_description_publisher_.publish(msg);
+}
+
+void Introspection::enableIncrementalDescription(bool enable) {
+	impl->incremental_description_ = enable;
 }
 
-void Introspection::publishTaskState() {
-	::moveit_task_constructor_msgs::TaskStatistics msg;
-	impl->task_statistics_publisher_.publish(fillTaskStatistics(msg));
+void Introspection::enableHumanReadableProperties(bool enable) {
+	impl->human_readable_properties_ = enable;
+}
+
+void Introspection::publishTaskState(bool force) {
+	const auto now = std::chrono::steady_clock::now();
+	if (!force && now - impl->last_statistics_ < impl->statistics_period_)
+		return;
+	impl->last_statistics_ = now;
+
+	Tracer::Scope trace("publishTaskState", "introspection");
+	auto msg = boost::make_shared<moveit_task_constructor_msgs::TaskStatistics>();
+	if (impl->incremental_statistics_)
+		fillIncrementalTaskStatistics(*msg);
+	else
+		fillTaskStatistics(*msg);
+	if (impl->asyncPublishing())
+		impl->enqueue(std::move(msg));
+	else
+		impl->task_statistics_publisher_.publish(msg);
+}
+
+void Introspection::setStatisticsRate(double rate) {
+	using namespace std::chrono;
+	impl->statistics_period_ =
+	    rate > 0.0 ? duration_cast<steady_clock::duration>(duration<double>(1.0 / rate)) : steady_clock::duration::zero();
+}
+
+void Introspection::enableIncrementalStatistics(bool enable) {
+	if (enable == impl->incremental_statistics_)
+		return;
+	impl->incremental_statistics_ = enable;
+	impl->published_statistics_.clear();
+	// incremental messages must not be dropped
+	impl->task_statistics_publisher_.shutdown();
+	impl->task_statistics_publisher_ =
+	    impl->nh_.advertise<moveit_task_constructor_msgs::TaskStatistics>(STATISTICS_TOPIC, enable ? 100 : 1, true);
+}
+
+void Introspection::enableAsyncPublishing(bool enable) {
+	if (enable)
+		impl->startPublisher();
+	else
+		impl->stopPublisher();
+}
+
+bool Introspection::asyncPublishingEnabled() const {
+	return impl->asyncPublishing();
 }
 
 void Introspection::reset() {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
 	impl->indicateReset();
 	impl->resetMaps();
 }
@@ -155,15 +411,163 @@ void Introspection::registerSolution(const SolutionBase& s) {
 	solutionId(s);
 }
 
+moveit_task_constructor_msgs::SolutionConstPtr Introspection::solutionMsg(const SolutionBase& s) {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	const uint32_t id = solutionId(s);
+	if (s.introspection_expired_) {  // don't cache msgs of expired solutions
+		auto msg = boost::make_shared<moveit_task_constructor_msgs::Solution>();
+		s.toMsg(*msg, this, true);
+		msg->task_id = impl->task_id_;
+		return msg;
+	}
+	auto& cached = impl->solution_msgs_[id];
+	// rebuild if cost changed, e.g. because the solution got invalidated by Task::replan()
+	if (!cached.msg || cached.cost != s.cost()) {
+		auto msg = boost::make_shared<moveit_task_constructor_msgs::Solution>();
+		s.toMsg(*msg, this, true);
+		msg->task_id = impl->task_id_;
+		cached.msg = msg;
+		cached.cost = s.cost();
+	}
+	return cached.msg;
+}
+
 void Introspection::fillSolution(moveit_task_constructor_msgs::Solution& msg, const SolutionBase& s) {
-	s.toMsg(msg, this);
+	msg = *solutionMsg(s);
+}
+
+void Introspection::fillSolutionStream(moveit_task_constructor_msgs::SolutionStream& msg, const SolutionBase& s) {
 	msg.task_id = impl->task_id_;
+	appendToStream(msg, s, false);
+
+	const planning_scene::PlanningSceneConstPtr& scene = s.start()->scene();
+	auto it = impl->streamed_scenes_.find(scene);
+	if (it != impl->streamed_scenes_.end()) {
+		msg.start_scene_id = it->second;
+		return;
+	}
+	msg.start_scene_id = impl->streamed_scenes_.emplace(scene, impl->streamed_scenes_.size() + 1).first->second;
+
+	auto base = scene->getParent() ? impl->streamed_scenes_.find(scene->getParent()) : impl->streamed_scenes_.end();
+	msg.start_scene_base_id = base != impl->streamed_scenes_.end() ? base->second : 0;
+	msg.start_scene = *s.start()->sceneMsg(msg.start_scene_base_id != 0);
+}
+
+void Introspection::appendToStream(moveit_task_constructor_msgs::SolutionStream& msg, const SolutionBase& s,
+                                   bool zero_ids) {
+	if (const auto* sequence = dynamic_cast<const SolutionSequence*>(&s)) {
+		moveit_task_constructor_msgs::SubSolution sub_msg;
+		sequence->fillInfo(sub_msg.info, this);
+		for (const SolutionBase* sub : sequence->solutions())
+			if (sub->creator() != sequence->creator())
+				sub_msg.sub_solution_id.push_back(solutionId(*sub));
+		msg.sub_solution.push_back(std::move(sub_msg));
+		// trajectories of sub solutions created by the sequence's own stage are published without ids
+		for (const SolutionBase* sub : sequence->solutions())
+			appendToStream(msg, *sub, zero_ids || sub->creator() == sequence->creator());
+	} else if (const auto* wrapped = dynamic_cast<const WrappedSolution*>(&s)) {
+		appendToStream(msg, *wrapped->innermost(), zero_ids);
+		// prepend infos of the whole chain of wrappers, as WrappedSolution::appendTo() does
+		std::vector<moveit_task_constructor_msgs::SubSolution> chain;
+		for (const SolutionBase* w = wrapped; w != wrapped->innermost();) {
+			const SolutionBase* inner = static_cast<const WrappedSolution*>(w)->wrapped();
+			chain.emplace_back();
+			w->fillInfo(chain.back().info, this);
+			chain.back().sub_solution_id.push_back(solutionId(*inner));
+			w = inner;
+		}
+		msg.sub_solution.insert(msg.sub_solution.begin(), std::make_move_iterator(chain.begin()),
+		                        std::make_move_iterator(chain.end()));
+	} else {
+		const uint32_t id = solutionId(s);
+		msg.sub_trajectory_id.push_back(id);
+		if (!impl->streamed_trajectories_.insert(id).second)
+			return;  // streamed before: skip the expensive conversion
+
+		moveit_task_constructor_msgs::Solution full;
+		s.appendTo(full, this);
+		for (auto& t : full.sub_trajectory) {
+			if (zero_ids)
+				t.info.id = 0;
+			msg.sub_trajectory.push_back(std::move(t));
+		}
+	}
 }
 
 void Introspection::publishSolution(const SolutionBase& s) {
-	moveit_task_constructor_msgs::Solution msg;
-	fillSolution(msg, s);
-	impl->solution_publisher_.publish(msg);
+	Tracer::Scope trace("publishSolution", "introspection", s.creator());
+	// Build all msgs on the calling thread: planning keeps modifying solutions (costs, scenes, timing)
+	// and only the immutable msgs are handed over to the publishing thread.
+	auto handle = boost::make_shared<moveit_task_constructor_msgs::SolutionHandle>();
+	if (!solutionHandle(s, *handle))
+		handle.reset();
+	moveit_task_constructor_msgs::SolutionStreamPtr stream_msg;
+	moveit_task_constructor_msgs::SolutionConstPtr msg;
+	if (impl->solution_stream_publisher_) {  // the stream replaces the full msg
+		stream_msg = boost::make_shared<moveit_task_constructor_msgs::SolutionStream>();
+		fillSolutionStream(*stream_msg, s);
+	} else if (!handle || impl->solution_publisher_.getNumSubscribers() > 0)
+		msg = solutionMsg(s);  // remote consumers still need the full message
+
+	auto publish = [this, handle, msg, stream_msg] {
+		if (handle)
+			impl->solution_handle_publisher_.publish(handle);
+		if (msg)
+			impl->solution_publisher_.publish(msg);
+		if (stream_msg)
+			impl->solution_stream_publisher_.publish(stream_msg);
+	};
+	if (impl->asyncPublishing())
+		impl->enqueue(std::move(publish));  // queued msgs are dropped on reset
+	else
+		publish();
+}
+
+void Introspection::enableStreaming(bool enable) {
+	if (enable && !impl->solution_stream_publisher_) {
+		// not latched and with a deep queue: every message is required to decode the subsequent ones
+		impl->solution_stream_publisher_ =
+		    impl->nh_.advertise<moveit_task_constructor_msgs::SolutionStream>(SOLUTION_STREAM_TOPIC, 100);
+	} else if (!enable && impl->solution_stream_publisher_) {
+		impl->solution_stream_publisher_.shutdown();
+		impl->solution_stream_publisher_ = ros::Publisher();
+	}
+	impl->streamed_trajectories_.clear();
+	impl->streamed_scenes_.clear();
+}
+
+bool Introspection::streamingEnabled() const {
+	return static_cast<bool>(impl->solution_stream_publisher_);
+}
+
+void Introspection::enableSharedMemory(size_t capacity) {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	impl->solution_ring_.reset();
+	impl->solution_handle_publisher_.shutdown();
+	impl->solution_handle_publisher_ = ros::Publisher();
+	if (capacity == 0)
+		return;
+
+	try {
+		impl->solution_ring_ = SolutionRing::create("mtc_solutions_" + impl->task_id_, capacity);
+	} catch (const std::runtime_error& e) {
+		ROS_ERROR_STREAM_NAMED(LOGGER, e.what());
+		return;
+	}
+	// handles are tiny, thus don't drop any
+	impl->solution_handle_publisher_ =
+	    impl->nh_.advertise<moveit_task_constructor_msgs::SolutionHandle>(SOLUTION_HANDLE_TOPIC, 100);
+}
+
+bool Introspection::solutionHandle(const SolutionBase& s, moveit_task_constructor_msgs::SolutionHandle& handle) {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);  // the ring supports a single writer only
+	if (!impl->solution_ring_)
+		return false;
+	if (impl->solution_ring_->write(*solutionMsg(s), handle))
+		return true;
+	ROS_WARN_STREAM_NAMED(LOGGER, "solution exceeds shared-memory capacity of " << impl->solution_ring_->capacity()
+	                                                                            << " bytes");
+	return false;
 }
 
 void Introspection::publishAllSolutions(bool wait) {
@@ -180,14 +584,15 @@ void Introspection::publishAllSolutions(bool wait) {
 }
 
 const SolutionBase* Introspection::solutionFromId(uint id) const {
-	auto it = impl->id_solution_bimap_.left.find(id);
-	if (it == impl->id_solution_bimap_.left.end())
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	if (id < impl->first_solution_id_ || id - impl->first_solution_id_ >= impl->solutions_by_id_.size())
 		return nullptr;
-	return it->second;
+	return impl->solutions_by_id_[id - impl->first_solution_id_];
 }
 
 bool Introspection::getSolution(moveit_task_constructor_msgs::GetSolution::Request& req,
                                 moveit_task_constructor_msgs::GetSolution::Response& res) {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
 	const SolutionBase* solution = solutionFromId(req.solution_id);
 	if (!solution)
 		return false;
@@ -196,10 +601,26 @@ bool Introspection::getSolution(moveit_task_constructor_msgs::GetSolution::Reque
 	return true;
 }
 
+bool Introspection::getSolutions(moveit_task_constructor_msgs::GetSolutions::Request& req,
+                                 moveit_task_constructor_msgs::GetSolutions::Response& res) {
+	// keep solutions alive while creating messages: Task::reset() needs to acquire the lock first
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	res.solutions.resize(req.solution_ids.size());
+	auto msg = res.solutions.begin();
+	for (uint32_t id : req.solution_ids) {
+		if (const SolutionBase* solution = solutionFromId(id))
+			fillSolution(*msg, *solution);
+		++msg;
+	}
+	return true;
+}
+
 uint32_t Introspection::stageId(const Stage* const s) {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
 	return impl->stage_to_id_map_.insert(std::make_pair(s->pimpl(), impl->stage_to_id_map_.size())).first->second;
 }
 uint32_t Introspection::stageId(const Stage* const s) const {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
 	auto it = impl->stage_to_id_map_.find(s->pimpl());
 	if (it == impl->stage_to_id_map_.end())
 		throw std::runtime_error("unregistered stage: " + s->name());
@@ -207,12 +628,89 @@ uint32_t Introspection::stageId(const Stage* const s) const {
 }
 
 uint32_t Introspection::solutionId(const SolutionBase& s) {
-	auto result = impl->id_solution_bimap_.left.insert(std::make_pair(1 + impl->id_solution_bimap_.size(), &s));
-	if (result.second)  // new entry
-		ROS_DEBUG_STREAM_NAMED(LOGGER, "new solution #" << result.first->first << " (" << s.creator()->name()
-		                                                << "): " << s.cost() << " " << s.comment());
-	return result.first->first;
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	if (s.introspection_expired_)
+		return s.introspection_id_;  // keep reporting the id, but it doesn't resolve anymore
+	if (solutionFromId(s.introspection_id_) == &s)
+		return s.introspection_id_;
+
+	s.introspection_id_ = impl->first_solution_id_ + impl->solutions_by_id_.size();
+	impl->solutions_by_id_.push_back(&s);
+	ROS_DEBUG_STREAM_NAMED(LOGGER, "new solution #" << s.introspection_id_ << " (" << s.creator()->name()
+	                                                << "): " << s.cost() << " " << s.comment());
+	return s.introspection_id_;
+}
+
+void Introspection::enableSolutionExpiry(bool enable) {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	impl->expire_solutions_ = enable;
+}
+
+void Introspection::clearSolutionMsgs() {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	impl->solution_msgs_.clear();
+	impl->streamed_trajectories_.clear();
+}
+
+void Introspection::expireSolution(const SolutionBase& s) {
+	std::lock_guard<std::recursive_mutex> lock(impl->mutex_);
+	if (!impl->expire_solutions_ || s.introspection_expired_)
+		return;
+	const uint32_t id = s.introspection_id_;
+	if (solutionFromId(id) != &s) {  // never registered: don't assign an id anymore
+		s.introspection_id_ = 0;
+		s.introspection_expired_ = true;
+		return;
+	}
+	s.introspection_expired_ = true;
+	impl->solutions_by_id_[id - impl->first_solution_id_] = nullptr;
+	impl->solution_msgs_.erase(id);
+	impl->streamed_trajectories_.erase(id);
+
+	// release leading expired ids, keeping the registry bounded by the live solutions
+	while (!impl->solutions_by_id_.empty() && !impl->solutions_by_id_.front()) {
+		impl->solutions_by_id_.pop_front();
+		++impl->first_solution_id_;
+	}
+}
+
+namespace {
+void fillComputeTimeStatistics(const ComputeTimeStatistics& stats, moveit_task_constructor_msgs::StageStatistics& s) {
+	s.num_computes = stats.count();
+	s.min_compute_time = stats.min();
+	s.mean_compute_time = stats.mean();
+	s.p95_compute_time = stats.quantile(0.95);
+	s.max_compute_time = stats.max();
+	s.total_planner_time = stats.totalPlannerTime();
+	// strip trailing empty bins
+	const auto& histogram = stats.histogram();
+	auto end = std::find_if(histogram.rbegin(), histogram.rend(), [](uint32_t n) { return n != 0; }).base();
+	s.compute_time_histogram.assign(histogram.begin(), end);
+}
+
+void fillHardwareCounters(const PerfCounterValues& counters, moveit_task_constructor_msgs::StageStatistics& s) {
+	s.hw_cycles = counters.cycles;
+	s.hw_instructions = counters.instructions;
+	s.hw_cache_misses = counters.cache_misses;
+	s.hw_context_switches = counters.context_switches;
+}
+
+void fillFailureCounts(const Stage& stage, moveit_task_constructor_msgs::StageStatistics& s) {
+	for (const auto& entry : stage.failureCounts()) {
+		s.failure_comments.push_back(entry.first);
+		s.failure_counts.push_back(entry.second);
+	}
+	s.num_timeouts = stage.numTimeouts();
+}
+
+void fillMemoryUsage(const MemoryUsage& usage, moveit_task_constructor_msgs::StageStatistics& s) {
+	s.memory_states = usage.states;
+	s.memory_scenes = usage.scenes;
+	s.memory_trajectories = usage.trajectories;
+	s.memory_markers = usage.markers;
+	s.memory_failures = usage.failures;
 }
+}  // namespace
 
 void Introspection::fillStageStatistics(const Stage& stage, moveit_task_constructor_msgs::StageStatistics& s) {
 	// successful solutions
@@ -224,7 +722,102 @@ void Introspection::fillStageStatistics(const Stage& stage, moveit_task_construc
 		s.failed.push_back(solutionId(*solution));
 
 	s.total_compute_time = stage.getTotalComputeTime();
+	fillComputeTimeStatistics(stage.computeTimeStatistics(), s);
+	fillHardwareCounters(stage.hardwareCounters(), s);
+	fillMemoryUsage(stage.memoryUsage(), s);
 	s.num_failed = stage.numFailures();
+	fillFailureCounts(stage, s);
+	s.scene_diff_depth = stage.pimpl()->sceneDiffDepth();
+}
+
+void Introspection::fillIncrementalTaskStatistics(moveit_task_constructor_msgs::TaskStatistics& msg) {
+	ContainerBase::StageCallback stage_processor = [this, &msg](const Stage& stage, unsigned int /*depth*/) -> bool {
+		const uint32_t id = stageId(&stage);
+		auto inserted = impl->published_statistics_.emplace(id, IntrospectionPrivate::PublishedStatistics());
+		auto& published = inserted.first->second;
+		const bool is_new = inserted.second;
+
+		const auto& solutions = stage.solutions();
+		const auto& failures = stage.failures();
+		const double compute_time = stage.getTotalComputeTime();
+		const uint32_t num_failed = stage.numFailures();
+		const uint32_t depth = stage.pimpl()->sceneDiffDepth();
+		const MemoryUsage memory = stage.memoryUsage();
+
+		// skip unchanged stages
+		bool solved_changed = is_new || solutions.size() != published.solved.size();
+		if (!solved_changed) {
+			auto it = published.solved.cbegin();
+			for (const auto& solution : solutions)
+				if ((solved_changed = solutionId(*solution) != *it++))
+					break;
+		}
+		if (!is_new && !solved_changed && failures.size() == published.num_failures &&
+		    num_failed == published.num_failed && compute_time == published.total_compute_time &&
+		    depth == published.scene_diff_depth && memory.total() == published.memory)
+			return true;
+
+		moveit_task_constructor_msgs::StageStatistics stat;
+		stat.id = id;
+		// successful solutions are always sent completely, as their cost order might have changed
+		for (const auto& solution : solutions)
+			stat.solved.push_back(solutionId(*solution));
+		// failures are only appended: send new ones only
+		auto it = failures.cbegin();
+		std::advance(it, std::min(published.num_failures, failures.size()));
+		for (; it != failures.cend(); ++it)
+			stat.failed.push_back(solutionId(**it));
+		stat.num_failed = num_failed;
+		fillFailureCounts(stage, stat);
+		stat.total_compute_time = compute_time;
+		fillComputeTimeStatistics(stage.computeTimeStatistics(), stat);
+		fillHardwareCounters(stage.hardwareCounters(), stat);
+		fillMemoryUsage(memory, stat);
+		stat.scene_diff_depth = depth;
+
+		published.solved = stat.solved;
+		published.num_failures = failures.size();
+		published.num_failed = num_failed;
+		published.total_compute_time = compute_time;
+		published.scene_diff_depth = depth;
+		published.memory = memory.total();
+
+		msg.stages.push_back(std::move(stat));
+		return true;
+	};
+
+	// the first message after a reset lists all stages completely
+	msg.incremental = !impl->published_statistics_.empty();
+	msg.stages.clear();
+	impl->task_->stages()->traverseRecursively(stage_processor);
+
+	msg.task_id = impl->task_id_;
+}
+
+void Introspection::fillStageDescription(const Stage& stage, moveit_task_constructor_msgs::StageDescription& desc) {
+	desc.id = stageId(&stage);
+	desc.name = stage.name();
+	desc.flags = stage.pimpl()->interfaceFlags();
+
+	// fill stage properties, whose serialization is cached until they change
+	for (const auto& pair : stage.properties()) {
+		moveit_task_constructor_msgs::Property p;
+		p.name = pair.first;
+		p.description = pair.second.description();
+		p.type = pair.second.typeName();
+		const std::string& wire = pair.second.encode();
+		p.value_binary.assign(wire.begin(), wire.end());
+		if (impl->human_readable_properties_ || wire.empty())
+			p.value = pair.second.serialize();
+		desc.properties.push_back(std::move(p));
+	}
+
+	auto it = impl->stage_to_id_map_.find(stage.pimpl()->parent()->pimpl());
+	assert(it != impl->stage_to_id_map_.cend());
+	desc.parent_id = it->second;
+
+	impl->published_descriptions_[desc.id] =
+	    IntrospectionPrivate::PublishedDescription{ stage.properties().generation(), desc.name, desc.flags };
 }
 
 moveit_task_constructor_msgs::TaskDescription&
@@ -232,29 +825,14 @@ Introspection::fillTaskDescription(moveit_task_constructor_msgs::TaskDescription
 	ContainerBase::StageCallback stage_processor = [this, &msg](const Stage& stage, unsigned int /*depth*/) -> bool {
 		// this method is called for each child stage of a given parent
 		moveit_task_constructor_msgs::StageDescription desc;
-		desc.id = stageId(&stage);
-		desc.name = stage.name();
-		desc.flags = stage.pimpl()->interfaceFlags();
-
-		// fill stage properties
-		for (const auto& pair : stage.properties()) {
-			moveit_task_constructor_msgs::Property p;
-			p.name = pair.first;
-			p.description = pair.second.description();
-			p.type = pair.second.typeName();
-			p.value = pair.second.serialize();
-			desc.properties.push_back(p);
-		}
-
-		auto it = impl->stage_to_id_map_.find(stage.pimpl()->parent()->pimpl());
-		assert(it != impl->stage_to_id_map_.cend());
-		desc.parent_id = it->second;
+		fillStageDescription(stage, desc);
 
 		// finally store in msg
 		msg.stages.push_back(std::move(desc));
 		return true;
 	};
 
+	msg.incremental = false;
 	msg.stages.clear();
 	impl->task_->stages()->traverseRecursively(stage_processor);
 
@@ -262,6 +840,27 @@ Introspection::fillTaskDescription(moveit_task_constructor_msgs::TaskDescription
 	return msg;
 }
 
+void Introspection::fillIncrementalTaskDescription(moveit_task_constructor_msgs::TaskDescription& msg) {
+	ContainerBase::StageCallback stage_processor = [this, &msg](const Stage& stage, unsigned int /*depth*/) -> bool {
+		// skip unchanged stages: equal generations guarantee equal properties
+		auto it = impl->published_descriptions_.find(stageId(&stage));
+		if (it != impl->published_descriptions_.end() &&
+		    it->second.properties_generation == stage.properties().generation() && it->second.name == stage.name() &&
+		    it->second.flags == stage.pimpl()->interfaceFlags())
+			return true;
+
+		moveit_task_constructor_msgs::StageDescription desc;
+		fillStageDescription(stage, desc);
+		msg.stages.push_back(std::move(desc));
+		return true;
+	};
+
+	msg.incremental = true;
+	msg.stages.clear();
+	impl->task_->stages()->traverseRecursively(stage_processor);
+	msg.task_id = impl->task_id_;
+}
+
 moveit_task_constructor_msgs::TaskStatistics&
 Introspection::fillTaskStatistics(moveit_task_constructor_msgs::TaskStatistics& msg) {
 	ContainerBase::StageCallback stage_processor = [this, &msg](const Stage& stage, unsigned int /*depth*/) -> bool {
@@ -0,0 +1,186 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Exclusively leased instances of kinematics solvers for concurrent IK
+*/
+
+#include <moveit/task_constructor/kinematics_pool.h>
+
+#include <moveit/robot_model/joint_model_group.h>
+#include <tf2_eigen/tf2_eigen.h>
+
+#include <limits>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+struct Entry
+{
+	// the group's own solver, which dies with the robot model, invalidating the entry
+	std::weak_ptr<kinematics::KinematicsBase> origin;
+	std::vector<kinematics::KinematicsBasePtr> idle;
+};
+
+bool sameOwner(const std::weak_ptr<kinematics::KinematicsBase>& a, const std::weak_ptr<kinematics::KinematicsBase>& b) {
+	return !a.owner_before(b) && !b.owner_before(a);
+}
+
+std::string stripSlash(const std::string& frame) {
+	return !frame.empty() && frame[0] == '/' ? frame.substr(1) : frame;
+}
+}  // namespace
+
+struct KinematicsPool::Instances
+{
+	std::map<const moveit::core::JointModelGroup*, Entry> entries;
+	std::mutex mutex;
+};
+
+KinematicsPool::KinematicsPool() : instances_(std::make_shared<Instances>()) {}
+
+kinematics::KinematicsBasePtr KinematicsPool::solver(const moveit::core::JointModelGroup* jmg) {
+	const kinematics::KinematicsBasePtr& origin = jmg->getSolverInstance();
+	const auto& allocator = jmg->getSolverAllocators().first;
+	if (!origin || !allocator)
+		return nullptr;  // no solver or one solver per subgroup
+
+	kinematics::KinematicsBasePtr instance;
+	{
+		std::lock_guard<std::mutex> lock(instances_->mutex);
+		Entry& entry = instances_->entries[jmg];
+		// new or outdated entry, e.g. a group of a reloaded model at the same address
+		if (entry.origin.lock() != origin) {
+			entry.origin = origin;
+			entry.idle.clear();
+		}
+		if (!entry.idle.empty()) {
+			instance = std::move(entry.idle.back());
+			entry.idle.pop_back();
+		} else {  // plugin loading isn't necessarily thread-safe: allocate while holding the lock
+			instance = allocator(jmg);
+		}
+	}
+	if (!instance)
+		return nullptr;
+
+	// return the instance to the pool on release, unless the pool or the group's entry is gone meanwhile
+	std::weak_ptr<Instances> pool = instances_;
+	std::weak_ptr<kinematics::KinematicsBase> owner = origin;
+	kinematics::KinematicsBase* raw = instance.get();
+	return kinematics::KinematicsBasePtr(raw, [pool, owner, jmg, instance](kinematics::KinematicsBase* /*unused*/) {
+		auto instances = pool.lock();
+		if (!instances)
+			return;
+		std::lock_guard<std::mutex> lock(instances->mutex);
+		auto it = instances->entries.find(jmg);
+		if (it != instances->entries.end() && sameOwner(it->second.origin, owner))
+			it->second.idle.push_back(instance);
+	});
+}
+
+bool KinematicsPool::setFromIK(moveit::core::RobotState& state, const moveit::core::JointModelGroup* jmg,
+                               const Eigen::Isometry3d& pose, const std::string& tip, double timeout,
+                               const moveit::core::GroupStateValidityCallbackFn& constraint,
+                               const kinematics::KinematicsQueryOptions& options) {
+	kinematics::KinematicsBasePtr solver = this->solver(jmg);  // leased until return
+	if (!solver || solver->getTipFrames().size() != 1)
+		return state.setFromIK(jmg, pose, tip, timeout, constraint, options);
+
+	// express target pose w.r.t. the solver's base frame
+	Eigen::Isometry3d target = pose;
+	const std::string base_frame = stripSlash(solver->getBaseFrame());
+	if (base_frame != state.getRobotModel()->getModelFrame()) {
+		const moveit::core::LinkModel* base = state.getRobotModel()->getLinkModel(base_frame);
+		if (!base)
+			return state.setFromIK(jmg, pose, tip, timeout, constraint, options);
+		state.updateLinkTransforms();
+		target = state.getGlobalLinkTransform(base).inverse() * target;
+	}
+
+	// IK is solved for the solver's tip frame: account for a fixed offset of tip to it
+	const std::string& solver_tip = stripSlash(solver->getTipFrame());
+	if (tip != solver_tip) {
+		const moveit::core::LinkModel* link = state.getRobotModel()->getLinkModel(tip);
+		if (!link || moveit::core::RobotModel::getRigidlyConnectedParentLinkModel(link)->getName() != solver_tip)
+			return state.setFromIK(jmg, pose, tip, timeout, constraint, options);
+		state.updateLinkTransforms();
+		const Eigen::Isometry3d& tip_pose = state.getGlobalLinkTransform(state.getRobotModel()->getLinkModel(solver_tip));
+		target = target * (tip_pose.inverse() * state.getGlobalLinkTransform(link)).inverse();
+	}
+
+	// the solver orders joints differently than the group
+	const std::vector<unsigned int>& bijection = jmg->getKinematicsSolverJointBijection();
+	std::vector<double> positions;
+	state.copyJointGroupPositions(jmg, positions);
+	std::vector<double> seed(bijection.size());
+	for (size_t i = 0; i < bijection.size(); ++i)
+		seed[i] = positions[bijection[i]];
+
+	auto to_group = [&bijection, &positions](const std::vector<double>& solution) {
+		for (size_t i = 0; i < bijection.size(); ++i)
+			positions[bijection[i]] = solution[i];
+	};
+	kinematics::KinematicsBase::IKCallbackFn callback;
+	if (constraint)
+		callback = [&](const geometry_msgs::Pose& /*pose*/, const std::vector<double>& solution,
+		               moveit_msgs::MoveItErrorCodes& error_code) {
+			to_group(solution);
+			error_code.val = constraint(&state, jmg, positions.data()) ? moveit_msgs::MoveItErrorCodes::SUCCESS :
+			                                                             moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+		};
+
+	if (timeout < std::numeric_limits<double>::epsilon())
+		timeout = jmg->getDefaultIKTimeout();
+
+	std::vector<double> solution;
+	moveit_msgs::MoveItErrorCodes error_code;
+	if (!solver->searchPositionIK(tf2::toMsg(target), seed, timeout, solution, callback, error_code, options))
+		return false;
+
+	to_group(solution);
+	state.setJointGroupPositions(jmg, positions);
+	state.update();
+	return true;
+}
+
+void KinematicsPool::clear() {
+	std::lock_guard<std::mutex> lock(instances_->mutex);
+	instances_->entries.clear();
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -39,6 +39,8 @@
 
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <map>
+#include <mutex>
 
 namespace {
 std::vector<const moveit::core::JointModel*>
@@ -103,6 +105,31 @@ moveit::core::JointModelGroup* merge(const std::vector<const moveit::core::Joint
 	return new moveit::core::JointModelGroup(merged_group_name, dummy_srdf, joints, robot_model);
 }
 
+moveit::core::JointModelGroupPtr mergedGroup(std::vector<const moveit::core::JointModelGroup*> groups) {
+	// canonical order
+	std::sort(groups.begin(), groups.end(),
+	          [](const auto* a, const auto* b) { return a->getName() < b->getName(); });
+
+	using Key = std::pair<const moveit::core::RobotModel*, std::vector<const moveit::core::JointModelGroup*>>;
+	static std::map<Key, std::weak_ptr<moveit::core::JointModelGroup>> cache;
+	static std::mutex mutex;
+
+	Key key(groups.empty() ? nullptr : &groups[0]->getParentModel(), groups);
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = cache.find(key);
+	if (it != cache.end()) {
+		if (auto jmg = it->second.lock())
+			return jmg;
+	}
+
+	moveit::core::JointModelGroupPtr jmg(merge(groups));  // throws on failure
+	// drop expired entries (of destroyed robot models) before adding a new one
+	for (auto entry = cache.begin(); entry != cache.end();)
+		entry = entry->second.expired() ? cache.erase(entry) : std::next(entry);
+	cache[key] = jmg;
+	return jmg;
+}
+
 robot_trajectory::RobotTrajectoryPtr
 merge(const std::vector<robot_trajectory::RobotTrajectoryConstPtr>& sub_trajectories,
       const moveit::core::RobotState& base_state, moveit::core::JointModelGroup*& merged_group,
@@ -121,7 +148,6 @@ merge(const std::vector<robot_trajectory::RobotTrajectoryConstPtr>& sub_trajecto
 
 	// sanity checks: all sub solutions must share the same robot model and use disjoint joint sets
 	const moveit::core::RobotModelConstPtr& robot_model = base_state.getRobotModel();
-	unsigned int max_num_vars = 0;  // maximum number of joint variables across sub groups
 	for (const robot_trajectory::RobotTrajectoryConstPtr& sub : sub_trajectories) {
 		if (sub->getRobotModel() != robot_model)
 			throw std::runtime_error("subsolutions refer to multiple robot models");
@@ -133,36 +159,37 @@ merge(const std::vector<robot_trajectory::RobotTrajectoryConstPtr>& sub_trajecto
 			if (std::find(merged_joints->cbegin(), merged_joints->cend(), jm) == merged_joints->cend())
 				throw std::runtime_error("subsolutions refers to unknown joint: " + jm->getName());
 		}
-		max_num_vars = std::max(max_num_vars, jmg->getVariableCount());
 	}
 
 	// do the actual trajectory merging
 	auto merged_traj = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model, merged_group);
-	std::vector<double> values;
-	values.reserve(max_num_vars);
+
+	// copy variables directly via their (robot model) indices
+	std::vector<const std::vector<int>*> indices;
+	indices.reserve(sub_trajectories.size());
+	size_t num_waypoints = 0;
+	for (const robot_trajectory::RobotTrajectoryConstPtr& sub : sub_trajectories) {
+		indices.push_back(&sub->getGroup()->getVariableIndexList());
+		num_waypoints = std::max(num_waypoints, sub->getWayPointCount());
+	}
 
 	auto merged_state = std::make_shared<moveit::core::RobotState>(base_state);
-	while (true) {
-		bool finished = true;
-		size_t index = merged_traj->getWayPointCount();
-
-		for (const robot_trajectory::RobotTrajectoryConstPtr& sub : sub_trajectories) {
-			if (index >= sub->getWayPointCount())
-				continue;  // no more waypoints in this sub solution
-
-			finished = false;  // there was a waypoint, continue while loop
-			const moveit::core::RobotState& sub_state = sub->getWayPoint(index);
-			sub_state.copyJointGroupPositions(sub->getGroup(), values);
-			merged_state->setJointGroupPositions(sub->getGroup(), values);
+	for (size_t index = 0; index < num_waypoints; ++index) {
+		for (size_t s = 0; s < sub_trajectories.size(); ++s) {
+			const robot_trajectory::RobotTrajectory& sub = *sub_trajectories[s];
+			if (index >= sub.getWayPointCount())
+				continue;  // no more waypoints in this sub solution: keep its final positions
+
+			const double* positions = sub.getWayPoint(index).getVariablePositions();
+			for (int i : *indices[s])
+				merged_state->setVariablePosition(i, positions[i]);
 		}
-		if (finished)
-			break;
-
 		merged_state->update();
 		// add waypoint without timing
 		merged_traj->addSuffixWayPoint(merged_state, 0.0);
-		// create new RobotState for next waypoint
-		merged_state = std::make_shared<moveit::core::RobotState>(*merged_state);
+		// the trajectory owns its waypoints: continue with a copy
+		if (index + 1 < num_waypoints)
+			merged_state = std::make_shared<moveit::core::RobotState>(*merged_state);
 	}
 
 	// add timing
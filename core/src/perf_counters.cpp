@@ -0,0 +1,169 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Hardware performance counters of stage computations (Linux perf_event)
+*/
+
+#include <moveit/task_constructor/perf_counters.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <array>
+#include <cstring>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+#ifdef __linux__
+// counter group of a single thread, led by the cycle counter
+class ThreadCounters
+{
+	enum Counter
+	{
+		CYCLES,
+		INSTRUCTIONS,
+		CACHE_MISSES,
+		CONTEXT_SWITCHES,
+		NUM_COUNTERS
+	};
+	std::array<int, NUM_COUNTERS> fds_;
+	std::array<Counter, NUM_COUNTERS> order_;  // counters in order of opening, i.e. their position in a group read
+	size_t num_open_ = 0;
+
+	static int open(uint32_t type, uint64_t config, bool exclude_kernel, int group_fd) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = group_fd < 0;  // the group is enabled at once via its leader
+		attr.exclude_kernel = exclude_kernel;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+	}
+	void add(Counter counter, uint32_t type, uint64_t config, bool exclude_kernel) {
+		int fd = open(type, config, exclude_kernel, num_open_ ? fds_[CYCLES] : -1);
+		fds_[counter] = fd;
+		if (fd >= 0)
+			order_[num_open_++] = counter;
+	}
+
+public:
+	ThreadCounters() {
+		fds_.fill(-1);
+		add(CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true);
+		if (!num_open_)
+			return;
+		add(INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, true);
+		add(CACHE_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, true);
+		// context switches happen in the kernel: they are not counted when excluding it
+		add(CONTEXT_SWITCHES, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false);
+		ioctl(fds_[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds_[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+	~ThreadCounters() {
+		for (int fd : fds_)
+			if (fd >= 0)
+				close(fd);
+	}
+	ThreadCounters(const ThreadCounters&) = delete;
+	ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+	bool valid() const { return num_open_ > 0; }
+
+	bool read(PerfCounterValues& values) const {
+		if (!valid())
+			return false;
+		struct
+		{
+			uint64_t nr;
+			uint64_t values[NUM_COUNTERS];
+		} data;
+		ssize_t size = ::read(fds_[CYCLES], &data, sizeof(data));
+		if (size < static_cast<ssize_t>(sizeof(uint64_t) * (1 + num_open_)) || data.nr != num_open_)
+			return false;
+
+		values = PerfCounterValues();
+		for (size_t i = 0; i < num_open_; ++i) {
+			switch (order_[i]) {
+				case CYCLES:
+					values.cycles = data.values[i];
+					break;
+				case INSTRUCTIONS:
+					values.instructions = data.values[i];
+					break;
+				case CACHE_MISSES:
+					values.cache_misses = data.values[i];
+					break;
+				case CONTEXT_SWITCHES:
+					values.context_switches = data.values[i];
+					break;
+				default:
+					break;
+			}
+		}
+		return true;
+	}
+};
+#else
+// perf_event is Linux-specific
+struct ThreadCounters
+{
+	bool valid() const { return false; }
+	bool read(PerfCounterValues& /* values */) const { return false; }
+};
+#endif
+
+const ThreadCounters& threadCounters() {
+	thread_local ThreadCounters counters;
+	return counters;
+}
+}  // namespace
+
+bool PerfCounters::available() {
+	return threadCounters().valid();
+}
+
+bool PerfCounters::read(PerfCounterValues& values) {
+	return threadCounters().read(values);
+}
+}  // namespace task_constructor
+}  // namespace moveit
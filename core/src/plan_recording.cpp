@@ -0,0 +1,216 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Record solver results of a planning run for offline replay
+*/
+
+#include <moveit/task_constructor/plan_recording.h>
+#include <moveit/task_constructor/storage.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+#include <ros/serialization.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+constexpr char MAGIC[8] = { 'M', 'T', 'C', 'R', 'E', 'C', '\0', '\0' };
+constexpr uint32_t VERSION = 2;
+
+template <typename T>
+void append(const T& value, std::string& buffer) {
+	const uint32_t length = ros::serialization::serializationLength(value);
+	const size_t offset = buffer.size();
+	buffer.resize(offset + length);
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[offset]), length);
+	ros::serialization::serialize(stream, value);
+}
+}  // namespace
+
+void PlanRecording::record(const SolutionCache::Key& key, const std::string& stage, double duration, bool success,
+                           const planning_scene::PlanningSceneConstPtr& start,
+                           const planning_scene::PlanningScenePtr& end, const SubTrajectory& solution) {
+	Entry entry{ key.input, stage, duration, success, moveit_task_constructor_msgs::SubTrajectory() };
+	auto& msg = entry.solution;
+	if (solution.trajectory())
+		solution.trajectory()->getRobotTrajectoryMsg(msg.trajectory);
+	if (end) {
+		if (end->getParent() == start) {
+			end->getPlanningSceneDiffMsg(msg.scene_diff);
+			msg.scene_diff.is_diff = true;
+		} else
+			end->getPlanningSceneMsg(msg.scene_diff);
+	}
+	msg.info.comment = solution.comment();
+	msg.info.cost = solution.cost();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_[key.digest] = std::move(entry);
+}
+
+bool PlanRecording::replay(const SolutionCache::Key& key, const planning_scene::PlanningSceneConstPtr& start,
+                           planning_scene::PlanningScenePtr& end, SubTrajectory& solution, bool& success) {
+	Entry entry;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = entries_.find(key.digest);
+		if (it == entries_.end() || it->second.input != key.input) {
+			++misses_;
+			return false;
+		}
+		entry = it->second;
+	}
+	if (mock_timing_ && mode_ != RESUME)
+		std::this_thread::sleep_for(std::chrono::duration<double>(entry.duration));
+
+	const auto& msg = entry.solution;
+	end = start->diff();
+	end->usePlanningSceneMsg(msg.scene_diff);  // full scene msg, if end wasn't derived from start
+	end->getCurrentStateNonConst().update();
+
+	robot_trajectory::RobotTrajectoryPtr trajectory;
+	if (!msg.trajectory.joint_trajectory.points.empty() || !msg.trajectory.multi_dof_joint_trajectory.points.empty()) {
+		trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(start->getRobotModel(), nullptr);
+		trajectory->setRobotTrajectoryMsg(start->getCurrentState(), msg.trajectory);
+	}
+	solution = SubTrajectory(trajectory, 0.0, msg.info.comment);
+	if (!std::isfinite(msg.info.cost))
+		solution.markAsFailure();
+	success = entry.success;
+	return true;
+}
+
+size_t PlanRecording::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return entries_.size();
+}
+
+size_t PlanRecording::misses() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return misses_;
+}
+
+std::map<std::string, double> PlanRecording::solverTime() const {
+	std::map<std::string, double> result;
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (const auto& pair : entries_)
+		result[pair.second.stage] += pair.second.duration;
+	return result;
+}
+
+void PlanRecording::clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+	misses_ = 0;
+	scene_ = moveit_msgs::PlanningScene();
+	has_scene_ = false;
+}
+
+void PlanRecording::save(const std::string& path) const {
+	std::string buffer(MAGIC, sizeof(MAGIC));
+	append(VERSION, buffer);
+	append(static_cast<uint8_t>(has_scene_), buffer);
+	append(scene_, buffer);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		append(static_cast<uint64_t>(entries_.size()), buffer);
+		for (const auto& pair : entries_) {
+			append(pair.second.input, buffer);
+			append(pair.second.stage, buffer);
+			append(pair.second.duration, buffer);
+			append(static_cast<uint8_t>(pair.second.success), buffer);
+			append(pair.second.solution, buffer);
+		}
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.write(buffer.data(), buffer.size()))
+		throw std::runtime_error("failed to write plan recording " + path);
+}
+
+void PlanRecording::load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		throw std::runtime_error("failed to open plan recording " + path);
+	std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (buffer.size() < sizeof(MAGIC) || std::memcmp(buffer.data(), MAGIC, sizeof(MAGIC)) != 0)
+		throw std::runtime_error("not a plan recording: " + path);
+
+	std::unordered_map<uint64_t, Entry> entries;
+	moveit_msgs::PlanningScene scene;
+	uint8_t has_scene;
+	try {
+		ros::serialization::IStream stream(buffer.data() + sizeof(MAGIC), buffer.size() - sizeof(MAGIC));
+		uint32_t version;
+		ros::serialization::deserialize(stream, version);
+		if (version != VERSION)
+			throw std::runtime_error("unsupported plan recording version " + std::to_string(version) + ": " + path);
+		ros::serialization::deserialize(stream, has_scene);
+		ros::serialization::deserialize(stream, scene);
+		uint64_t count;
+		ros::serialization::deserialize(stream, count);
+		for (uint64_t i = 0; i < count; ++i) {
+			uint8_t success;
+			Entry entry;
+			ros::serialization::deserialize(stream, entry.input);
+			ros::serialization::deserialize(stream, entry.stage);
+			ros::serialization::deserialize(stream, entry.duration);
+			ros::serialization::deserialize(stream, success);
+			ros::serialization::deserialize(stream, entry.solution);
+			entry.success = success;
+			const uint64_t digest = SolutionCache::Key::digestOf(entry.input);
+			entries.emplace(digest, std::move(entry));
+		}
+	} catch (const ros::Exception& e) {
+		throw std::runtime_error("corrupt plan recording " + path + ": " + e.what());
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_ = std::move(entries);
+	misses_ = 0;
+	scene_ = std::move(scene);
+	has_scene_ = has_scene;
+}
+}  // namespace task_constructor
+}  // namespace moveit
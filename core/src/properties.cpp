@@ -38,6 +38,8 @@
 
 #include <moveit/task_constructor/properties.h>
 #include <moveit/task_constructor/fmt_p.h>
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <ros/console.h>
 
@@ -53,6 +55,8 @@ class PropertyTypeRegistry
 		std::string name_;
 		PropertySerializerBase::SerializeFunction serialize_;
 		PropertySerializerBase::DeserializeFunction deserialize_;
+		PropertySerializerBase::SerializeFunction encode_;
+		PropertySerializerBase::DeserializeFunction decode_;
 	};
 	Entry dummy_;
 
@@ -65,10 +69,13 @@ class PropertyTypeRegistry
 
 public:
 	PropertyTypeRegistry()
-	  : dummy_{ "", PropertySerializerBase::dummySerialize, PropertySerializerBase::dummyDeserialize } {}
+	  : dummy_{ "", PropertySerializerBase::dummySerialize, PropertySerializerBase::dummyDeserialize,
+		        PropertySerializerBase::dummySerialize, PropertySerializerBase::dummyDeserialize } {}
 	inline bool insert(const std::type_index& type_index, const std::string& type_name,
 	                   PropertySerializerBase::SerializeFunction serialize,
-	                   PropertySerializerBase::DeserializeFunction deserialize);
+	                   PropertySerializerBase::DeserializeFunction deserialize,
+	                   PropertySerializerBase::SerializeFunction encode,
+	                   PropertySerializerBase::DeserializeFunction decode);
 
 	const Entry& entry(const std::type_index& type_index) const {
 		auto it = types_.find(type_index);
@@ -90,11 +97,14 @@ static PropertyTypeRegistry REGISTRY_SINGLETON;
 
 bool PropertyTypeRegistry::insert(const std::type_index& type_index, const std::string& type_name,
                                   PropertySerializerBase::SerializeFunction serialize,
-                                  PropertySerializerBase::DeserializeFunction deserialize) {
+                                  PropertySerializerBase::DeserializeFunction deserialize,
+                                  PropertySerializerBase::SerializeFunction encode,
+                                  PropertySerializerBase::DeserializeFunction decode) {
 	if (type_index == std::type_index(typeid(boost::any)))
 		return false;
 
-	auto it_inserted = types_.insert(std::make_pair(type_index, Entry{ type_name, serialize, deserialize }));
+	auto it_inserted =
+	    types_.insert(std::make_pair(type_index, Entry{ type_name, serialize, deserialize, encode, decode }));
 	if (!it_inserted.second)
 		return false;  // was already registered before
 
@@ -106,8 +116,10 @@ bool PropertyTypeRegistry::insert(const std::type_index& type_index, const std::
 
 bool PropertySerializerBase::insert(const std::type_index& type_index, const std::string& type_name,
                                     PropertySerializerBase::SerializeFunction serialize,
-                                    PropertySerializerBase::DeserializeFunction deserialize) {
-	return REGISTRY_SINGLETON.insert(type_index, type_name, serialize, deserialize);
+                                    PropertySerializerBase::DeserializeFunction deserialize,
+                                    PropertySerializerBase::SerializeFunction encode,
+                                    PropertySerializerBase::DeserializeFunction decode) {
+	return REGISTRY_SINGLETON.insert(type_index, type_name, serialize, deserialize, encode, decode);
 }
 
 Property::Property(const type_info& type_info, const std::string& description, const boost::any& default_value)
@@ -119,6 +131,18 @@ Property::Property(const type_info& type_info, const std::string& description, c
 
 Property::Property() : Property(typeid(boost::any), "", boost::any()) {}
 
+namespace {
+uint64_t nextGeneration() {
+	static std::atomic<uint64_t> last_generation{ 0 };
+	return ++last_generation;
+}
+}  // namespace
+
+void Property::touch() {
+	if (owner_.generation)
+		*owner_.generation = nextGeneration();
+}
+
 void Property::setValue(const boost::any& value) {
 	setCurrentValue(value);
 	default_ = value_;
@@ -130,7 +154,9 @@ void Property::setCurrentValue(const boost::any& value) {
 		throw Property::type_error(value.type().name(), type_info_.name());
 
 	value_ = value;
+	serialized_valid_ = encoded_valid_ = false;
 	initialized_from_ = 1;  // manually initialized TODO: use enums
+	touch();
 }
 
 void Property::setDefaultValue(const boost::any& value) {
@@ -138,13 +164,25 @@ void Property::setDefaultValue(const boost::any& value) {
 		throw Property::type_error(value.type().name(), type_info_.name());
 
 	default_ = value;
+	serialized_valid_ = encoded_valid_ = false;
+	touch();
 }
 
 void Property::reset() {
 	if (initialized_from_ == 0)  // TODO: use enum
 		return;  // keep manually set values
 	boost::any().swap(value_);
+	serialized_valid_ = encoded_valid_ = false;
 	initialized_from_ = -1;  // set to max value
+	touch();
+}
+
+const std::string& Property::serialize() const {
+	if (!serialized_valid_) {
+		serialized_ = serialize(value());
+		serialized_valid_ = true;
+	}
+	return serialized_;
 }
 
 std::string Property::serialize(const boost::any& value) {
@@ -160,6 +198,24 @@ boost::any Property::deserialize(const std::string& type_name, const std::string
 		return REGISTRY_SINGLETON.entry(type_name).deserialize_(wire);
 }
 
+std::string Property::encode(const boost::any& value) {
+	if (value.empty())
+		return "";
+	return REGISTRY_SINGLETON.entry(value.type()).encode_(value);
+}
+
+const std::string& Property::encode() const {
+	if (!encoded_valid_) {
+		encoded_ = encode(value());
+		encoded_valid_ = true;
+	}
+	return encoded_;
+}
+
+boost::any Property::decode(const std::string& type_name, const std::string& wire) {
+	return REGISTRY_SINGLETON.entry(type_name).decode_(wire);
+}
+
 std::string Property::typeName() const {
 	if (value().empty())
 		return typeName(type_info_);
@@ -184,31 +240,86 @@ Property& Property::configureInitFrom(SourceFlags source, const Property::Initia
 
 	source_flags_ = f ? source : SourceFlags();
 	initializer_ = f;
+	custom_initializer_ = static_cast<bool>(f);
+	touch();
 	return *this;
 }
 
 Property& Property::configureInitFrom(SourceFlags source, const std::string& name) {
-	return configureInitFrom(source, [name](const PropertyMap& other) { return fromName(other, name); });
+	configureInitFrom(source, [name](const PropertyMap& other) { return fromName(other, name); });
+	custom_initializer_ = false;  // only depends on other's generation
+	return *this;
+}
+
+const PropertyMap::container_type& PropertyMap::props() const {
+	static const container_type EMPTY;
+	if (!props_)
+		return EMPTY;
+	return props_->props;
+}
+
+PropertyMap::PropertyMap(PropertyMap&& other) noexcept
+  : props_(std::move(other.props_)), init_records_(std::move(other.init_records_)) {
+	other.init_records_.clear();
+}
+
+PropertyMap& PropertyMap::operator=(PropertyMap&& other) noexcept {
+	if (this != &other) {
+		props_ = std::move(other.props_);
+		init_records_ = std::move(other.init_records_);
+		other.init_records_.clear();
+	}
+	return *this;
+}
+
+PropertyMap::container_type& PropertyMap::mutableProps() {
+	if (!props_)
+		props_ = std::make_shared<Storage>();
+	else if (props_.use_count() > 1) {  // copy on write
+		props_ = std::make_shared<Storage>(*props_);
+		for (auto& pair : props_->props)
+			pair.second.owner_.generation = &props_->generation;
+	}
+	// references returned by non-const access might be used for writing at any time
+	props_->generation = nextGeneration();
+	return props_->props;
+}
+
+PropertyMap::container_type::iterator PropertyMap::insert(container_type::iterator hint, const std::string& name,
+                                                          Property&& property) {
+	auto it = props_->props.emplace_hint(hint, name, std::move(property));
+	it->second.owner_.generation = &props_->generation;
+	return it;
 }
 
 Property& PropertyMap::declare(const std::string& name, const Property::type_info& type_info,
                                const std::string& description, const boost::any& default_value) {
-	auto it_inserted = props_.insert(std::make_pair(name, Property(type_info, description, default_value)));
+	auto& props = mutableProps();
+	auto it = props.lower_bound(name);
+	if (it == props.end() || it->first != name)
+		return insert(it, name, Property(type_info, description, default_value))->second;
+
 	// if name was already declared, the new declaration should match in type (except it was boost::any)
-	if (!it_inserted.second && it_inserted.first->second.type_info_ != typeid(boost::any) &&
-	    type_info != it_inserted.first->second.type_info_)
-		throw Property::type_error(type_info.name(), it_inserted.first->second.type_info_.name());
-	return it_inserted.first->second;
+	if (it->second.type_info_ != typeid(boost::any) && type_info != it->second.type_info_)
+		throw Property::type_error(type_info.name(), it->second.type_info_.name());
+	return it->second;
 }
 
 bool PropertyMap::hasProperty(const std::string& name) const {
-	auto it = props_.find(name);
-	return it != props_.end();
+	return props().count(name) > 0;
 }
 
 Property& PropertyMap::property(const std::string& name) {
-	auto it = props_.find(name);
-	if (it == props_.end())
+	auto& props = mutableProps();
+	auto it = props.find(name);
+	if (it == props.end())
+		throw Property::undeclared(name);
+	return it->second;
+}
+
+const Property& PropertyMap::property(const std::string& name) const {
+	auto it = props().find(name);
+	if (it == props().end())
 		throw Property::undeclared(name);
 	return it->second;
 }
@@ -224,10 +335,10 @@ void PropertyMap::exposeTo(PropertyMap& other, const std::string& name, const st
 }
 
 void PropertyMap::configureInitFrom(Property::SourceFlags source, const std::set<std::string>& properties) {
-	for (auto& pair : props_) {
+	for (auto& pair : mutableProps()) {
 		if (properties.empty() || properties.count(pair.first))
 			try {
-				pair.second.configureInitFrom(source, std::bind(&fromName, std::placeholders::_1, pair.first));
+				pair.second.configureInitFrom(source, pair.first);
 			} catch (Property::error& e) {
 				e.setName(pair.first);
 				throw;
@@ -237,11 +348,12 @@ void PropertyMap::configureInitFrom(Property::SourceFlags source, const std::set
 
 template <>
 void PropertyMap::set<boost::any>(const std::string& name, const boost::any& value) {
-	auto range = props_.equal_range(name);
+	auto& props = mutableProps();
+	auto range = props.equal_range(name);
 	if (range.first == range.second) {  // name is not yet declared
 		if (value.empty())
 			throw Property::undeclared(name, "trying to set undeclared property '" + name + "' with NULL value");
-		auto it = props_.insert(range.first, std::make_pair(name, Property(value.type(), "", boost::any())));
+		auto it = insert(range.first, name, Property(value.type(), "", boost::any()));
 		it->second.setValue(value);
 	} else
 		range.first->second.setValue(value);
@@ -265,13 +377,27 @@ size_t PropertyMap::countDefined(const std::vector<std::string>& list) const {
 }
 
 void PropertyMap::reset() {
-	for (auto& pair : props_)
+	if (!props_)
+		return;
+	for (auto& pair : mutableProps())
 		pair.second.reset();
 }
 
 void PropertyMap::performInitFrom(Property::SourceFlags source, const PropertyMap& other) {
-	for (auto& pair : props_) {
-		Property& p = pair.second;
+	auto record = std::find_if(init_records_.begin(), init_records_.end(),
+	                           [source](const InitRecord& r) { return r.source == source; });
+	// nothing changed since last initialization from this source?
+	if (record != init_records_.end() && !record->custom && record->other_generation == other.generation() &&
+	    record->generation == generation())
+		return;
+
+	// collect updates first: shared storage is only detached if there is something to write
+	std::vector<std::pair<std::string, boost::any>> updates;
+	bool custom = false;
+	for (const auto& pair : props()) {
+		const Property& p = pair.second;
+		// custom initializers might depend on anything: never skip them
+		custom = custom || (p.custom_initializer_ && p.initsFrom(source));
 
 		// don't override value previously set by higher-priority source
 		// MANUAL > CURRENT > PARENT > INTERFACE
@@ -292,9 +418,19 @@ void PropertyMap::performInitFrom(Property::SourceFlags source, const PropertyMa
 
 		ROS_DEBUG_STREAM_NAMED(LOGNAME, fmt::format("{}: {} -> {}: {}", pair.first, p.initialized_from_, source,
 		                                            Property::serialize(value)));
-		p.setCurrentValue(value);
+		updates.emplace_back(pair.first, std::move(value));
+	}
+	for (auto& update : updates) {
+		Property& p = property(update.first);
+		p.setCurrentValue(update.second);
 		p.initialized_from_ = source;
 	}
+
+	if (record == init_records_.end())
+		record = init_records_.insert(record, InitRecord{ source, 0, 0, false });
+	record->other_generation = other.generation();
+	record->generation = generation();
+	record->custom = custom;
 }
 
 boost::any fromName(const PropertyMap& other, const std::string& other_name) {
@@ -0,0 +1,110 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Process-wide cache of robot models loaded from the parameter server
+*/
+
+#include <moveit/task_constructor/robot_model_cache.h>
+
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <ros/node_handle.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+struct Entry
+{
+	size_t hash;  // hash of URDF + SRDF content
+	robot_model_loader::RobotModelLoaderPtr loader;
+};
+
+struct Cache
+{
+	std::map<std::string, Entry> entries;
+	std::mutex mutex;
+};
+
+Cache& cache() {
+	static Cache cache;
+	return cache;
+}
+
+// hash of the URDF and SRDF content currently found on the parameter server
+size_t contentHash(const std::string& robot_description) {
+	ros::NodeHandle nh("~");
+	std::string urdf, srdf, key;
+	// resolve parameter names like rdf_loader does
+	if (nh.searchParam(robot_description, key))
+		nh.getParam(key, urdf);
+	if (nh.searchParam(robot_description + "_semantic", key))
+		nh.getParam(key, srdf);
+	return std::hash<std::string>()(urdf + '\0' + srdf);
+}
+}  // namespace
+
+robot_model_loader::RobotModelLoaderPtr RobotModelCache::load(const std::string& robot_description) {
+	const size_t hash = contentHash(robot_description);
+
+	Cache& c = cache();
+	// loading is serialized: plugin loading isn't thread-safe anyway
+	std::lock_guard<std::mutex> lock(c.mutex);
+	auto it = c.entries.find(robot_description);
+	if (it != c.entries.end() && it->second.hash == hash)
+		return it->second.loader;
+
+	auto loader = std::make_shared<robot_model_loader::RobotModelLoader>(robot_description);
+	if (!loader->getModel())
+		return nullptr;  // don't cache failures
+	c.entries[robot_description] = Entry{ hash, loader };
+	return loader;
+}
+
+void RobotModelCache::invalidate(const std::string& robot_description) {
+	Cache& c = cache();
+	std::lock_guard<std::mutex> lock(c.mutex);
+	c.entries.erase(robot_description);
+}
+
+void RobotModelCache::clear() {
+	Cache& c = cache();
+	std::lock_guard<std::mutex> lock(c.mutex);
+	c.entries.clear();
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,179 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Build planning scene diffs, sharing collision geometry at object granularity
+*/
+
+#include <moveit/task_constructor/scene_builder.h>
+#include <moveit/task_constructor/moveit_compat.h>
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <geometric_shapes/shape_operations.h>
+#include <tf2_eigen/tf2_eigen.h>
+#include <ros/console.h>
+
+#include <algorithm>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+// convert pose msg, accepting the zero quaternion as identity (like PlanningScene does)
+Eigen::Isometry3d toIsometry(const geometry_msgs::Pose& msg) {
+	Eigen::Translation3d translation(msg.position.x, msg.position.y, msg.position.z);
+	Eigen::Quaterniond quaternion(msg.orientation.w, msg.orientation.x, msg.orientation.y, msg.orientation.z);
+	if (quaternion.squaredNorm() < 1e-12)
+		return Eigen::Isometry3d(translation);
+	return translation * quaternion.normalized();
+}
+
+template <typename Msg>
+void appendShapes(const std::vector<Msg>& msgs, std::vector<shapes::ShapeConstPtr>& shapes) {
+	for (const Msg& msg : msgs)
+		shapes.emplace_back(shapes::constructShapeFromMsg(msg));
+}
+}  // namespace
+
+std::vector<shapes::ShapeConstPtr> SceneBuilder::ShapeCache::shapes(const moveit_msgs::CollisionObject& object) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	Entry& entry = entries_[object.id];
+	if (entry.shapes.empty() || entry.primitives != object.primitives || entry.meshes != object.meshes ||
+	    entry.planes != object.planes) {
+		entry.primitives = object.primitives;
+		entry.meshes = object.meshes;
+		entry.planes = object.planes;
+		entry.shapes.clear();
+		appendShapes(object.primitives, entry.shapes);
+		appendShapes(object.meshes, entry.shapes);
+		appendShapes(object.planes, entry.shapes);
+	}
+	return entry.shapes;
+}
+
+void SceneBuilder::ShapeCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+}
+
+size_t SceneBuilder::ShapeCache::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return entries_.size();
+}
+
+SceneBuilder::SceneBuilder(const planning_scene::PlanningSceneConstPtr& parent, ShapeCache* cache)
+  : scene_(parent->diff()), cache_(cache) {}
+
+bool SceneBuilder::processCollisionObject(const moveit_msgs::CollisionObject& object) {
+	if (cache_ && object.operation == moveit_msgs::CollisionObject::ADD)
+		return addObject(object);
+	return scene_->processCollisionObjectMsg(object);
+}
+
+bool SceneBuilder::processCollisionObjects(const std::vector<moveit_msgs::CollisionObject>& objects) {
+	bool success = true;
+	for (const moveit_msgs::CollisionObject& object : objects)
+		success &= processCollisionObject(object);
+	return success;
+}
+
+std::vector<moveit_msgs::CollisionObject>
+SceneBuilder::coalesce(const std::vector<moveit_msgs::CollisionObject>& objects) {
+	// find the last replacing operation of each object
+	std::unordered_map<std::string, size_t> last_replacement;
+	for (size_t i = 0; i < objects.size(); ++i) {
+		const auto op = objects[i].operation;
+		if (op == moveit_msgs::CollisionObject::ADD || op == moveit_msgs::CollisionObject::REMOVE)
+			last_replacement[objects[i].id] = i;
+	}
+
+	std::vector<moveit_msgs::CollisionObject> result;
+	result.reserve(objects.size());
+	for (size_t i = 0; i < objects.size(); ++i) {
+		auto it = last_replacement.find(objects[i].id);
+		if (it == last_replacement.end() || i >= it->second)
+			result.push_back(objects[i]);
+	}
+	return result;
+}
+
+bool SceneBuilder::addObject(const moveit_msgs::CollisionObject& object) {
+#if MOVEIT_VERSION_GE(1, 1, 6)  // object poses
+	// leave corner cases to PlanningScene: invalid msgs, unknown frames, and ids of attached objects
+	if (object.id.empty() || object.primitives.size() != object.primitive_poses.size() ||
+	    object.meshes.size() != object.mesh_poses.size() || object.planes.size() != object.plane_poses.size() ||
+	    object.subframe_names.size() != object.subframe_poses.size() ||
+	    !scene_->knowsFrameTransform(object.header.frame_id) || scene_->getCurrentState().hasAttachedBody(object.id))
+		return scene_->processCollisionObjectMsg(object);
+
+	std::vector<shapes::ShapeConstPtr> shapes = cache_->shapes(object);
+	EigenSTL::vector_Isometry3d shape_poses;
+	shape_poses.reserve(shapes.size());
+	for (const auto* poses : { &object.primitive_poses, &object.mesh_poses, &object.plane_poses })
+		for (const geometry_msgs::Pose& pose : *poses)
+			shape_poses.push_back(toIsometry(pose));
+
+	const Eigen::Isometry3d pose = scene_->getFrameTransform(object.header.frame_id) * toIsometry(object.pose);
+	const collision_detection::WorldPtr& world = scene_->getWorldNonConst();
+	auto existing = world->getObject(object.id);
+	if (existing && existing->shapes_ == shapes && existing->shape_poses_.size() == shape_poses.size() &&
+	    std::equal(shape_poses.begin(), shape_poses.end(), existing->shape_poses_.begin(),
+	               [](const Eigen::Isometry3d& a, const Eigen::Isometry3d& b) { return a.isApprox(b, 1e-12); }))
+		// re-adding the same geometry: a single pose update suffices
+		world->setObjectPose(object.id, pose);
+	else {
+		world->removeObject(object.id);  // ADD replaces an existing object
+		world->addToObject(object.id, pose, shapes, shape_poses);
+	}
+
+	if (!object.subframe_names.empty()) {
+		moveit::core::FixedTransformsMap subframes;
+		for (size_t i = 0; i < object.subframe_names.size(); ++i)
+			subframes[object.subframe_names[i]] = toIsometry(object.subframe_poses[i]);
+		world->setSubframesOfObject(object.id, subframes);
+	}
+	if (!object.type.key.empty() || !object.type.db.empty())
+		scene_->setObjectType(object.id, object.type);
+	return true;
+#else
+	return scene_->processCollisionObjectMsg(object);
+#endif
+}
+
+void SceneBuilder::shiftObject(const std::string& id, const Eigen::Isometry3d& transform) {
+	// only the object's pose changes: shapes and their collision geometry are kept
+	if (!scene_->getWorldNonConst()->moveObject(id, transform))
+		ROS_WARN_STREAM_NAMED("SceneBuilder", "cannot move unknown object " << id);
+}
+}  // namespace task_constructor
+}  // namespace moveit
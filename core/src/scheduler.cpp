@@ -0,0 +1,457 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Strategies deciding which stages Task::plan() computes next
+*/
+
+#include <moveit/task_constructor/scheduler.h>
+#include <moveit/task_constructor/container_p.h>
+#include <moveit/task_constructor/thread_pool.h>
+
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace moveit {
+namespace task_constructor {
+
+bool Scheduler::canCompute(const ContainerBase& root) {
+	return root.pimpl()->canCompute();
+}
+
+void TraversalScheduler::init(ContainerBase& /*root*/) {}
+
+void TraversalScheduler::compute(ContainerBase& root) {
+	root.pimpl()->runCompute();
+}
+
+namespace {
+// containers whose compute() merely computes all children in turn
+bool isTransparent(const Stage& stage) {
+	return dynamic_cast<const SerialContainer*>(&stage) || dynamic_cast<const Alternatives*>(&stage);
+}
+
+void collectUnits(ContainerBase& container, std::vector<StagePrivate*>& units) {
+	for (const auto& child : container.pimpl()->children()) {
+		if (isTransparent(*child))
+			collectUnits(static_cast<ContainerBase&>(*child), units);
+		else
+			units.push_back(child->pimpl());
+	}
+}
+
+struct Candidate
+{
+	StagePrivate* stage;
+	bool has_input;  // is there a pending (enabled) input state?
+	InterfaceState::Priority priority;
+	double expected_time;
+
+	bool operator<(const Candidate& other) const {
+		if (has_input != other.has_input)
+			return has_input;
+		if (has_input && priority != other.priority)
+			return priority < other.priority;
+		return expected_time < other.expected_time;
+	}
+};
+
+Candidate evaluate(StagePrivate* stage) {
+	Candidate c{ stage, false, InterfaceState::Priority(0, 0.0), stage->me()->computeTimeStatistics().mean() };
+	for (const InterfacePtr& interface : { stage->starts(), stage->ends() }) {
+		if (!interface || interface->empty())
+			continue;
+		const InterfaceState::Priority& p = interface->front()->priority();
+		if (!p.enabled())
+			continue;
+		if (!c.has_input || p < c.priority) {
+			c.has_input = true;
+			c.priority = p;
+		}
+	}
+	return c;
+}
+}  // namespace
+
+void PriorityScheduler::init(ContainerBase& root) {
+	units_.clear();
+	if (isTransparent(root))
+		collectUnits(root, units_);
+	else
+		units_.push_back(root.pimpl());
+}
+
+void PriorityScheduler::compute(ContainerBase& root) {
+	StagePrivate* root_impl = root.pimpl();
+	ThreadPool* pool = root_impl->threadPool();
+
+	std::vector<Candidate> candidates;
+	{
+		auto lock = root_impl->lockPlanning();
+		for (StagePrivate* unit : units_)
+			if (unit->canCompute())
+				candidates.push_back(evaluate(unit));
+	}
+	if (candidates.empty())
+		return;
+
+	if (!pool) {
+		std::iter_swap(candidates.begin(), std::min_element(candidates.begin(), candidates.end()));
+		candidates.front().stage->runCompute();
+		return;
+	}
+
+	// multi-threaded: compute the best units concurrently, using the calling thread too
+	const size_t num = std::min(candidates.size(), pool->size() + 1);
+	std::partial_sort(candidates.begin(), candidates.begin() + num, candidates.end());
+	std::vector<ThreadPool::Job> jobs;
+	jobs.reserve(num);
+	for (size_t i = 0; i < num; ++i) {
+		StagePrivate* stage = candidates[i].stage;
+		jobs.emplace_back([stage] { stage->runCompute(); });
+	}
+	pool->run(std::move(jobs));
+}
+
+void PipelineScheduler::init(ContainerBase& root) {
+	units_.clear();
+	if (isTransparent(root))
+		collectUnits(root, units_);
+	else
+		units_.push_back(root.pimpl());
+}
+
+bool PipelineScheduler::ready(StagePrivate* unit) const {
+	if (!unit->canCompute())
+		return false;
+	if (!queue_capacity_ || unit->interfaceFlags() != InterfaceFlags(GENERATE))
+		return true;
+	// backpressure: don't produce more states than downstream stages can consume
+	for (const InterfacePtr& queue : { unit->nextStarts(), unit->prevEnds() })
+		if (queue && queue->size() >= queue_capacity_)
+			return false;
+	return true;
+}
+
+void PipelineScheduler::compute(ContainerBase& root) {
+	StagePrivate* root_impl = root.pimpl();
+	ThreadPool* pool = root_impl->threadPool();
+
+	if (!pool) {
+		for (StagePrivate* unit : units_)
+			if (ready(unit))
+				unit->runCompute();
+		return;
+	}
+
+	// state shared by all workers of this iteration
+	struct Pipeline
+	{
+		std::mutex mutex;
+		std::condition_variable cond;  // signals finished computations
+		std::vector<bool> busy;  // units must not be computed concurrently
+		size_t active = 0;  // number of running computations
+		bool done = false;
+	} pipeline;
+	pipeline.busy.resize(units_.size(), false);
+	const size_t solutions = root.solutions().size();
+	// a task's root pipeline only queues its complete solutions (see SerialContainerPrivate::setLiftOnRequest())
+	const auto* serial = dynamic_cast<const SerialContainerPrivate*>(root_impl);
+	auto found_solution = [&root, serial, solutions] {
+		return root.solutions().size() > solutions || (serial && serial->hasPendingSolutions());
+	};
+
+	auto worker = [this, root_impl, &found_solution, &pipeline] {
+		std::unique_lock<std::mutex> lock(pipeline.mutex);
+		while (!pipeline.done) {
+			// prefer downstream units: drain queues before producing more states
+			size_t next = units_.size();
+			{
+				auto planning_lock = root_impl->lockPlanning();
+				if (root_impl->preempted() || root_impl->deadlineExceeded() || found_solution()) {
+					pipeline.done = true;
+					break;
+				}
+				for (size_t i = units_.size(); i-- > 0;)
+					if (!pipeline.busy[i] && ready(units_[i])) {
+						next = i;
+						break;
+					}
+			}
+			if (next != units_.size()) {
+				pipeline.busy[next] = true;
+				++pipeline.active;
+				lock.unlock();
+				units_[next]->runCompute();
+				lock.lock();
+				pipeline.busy[next] = false;
+				--pipeline.active;
+				pipeline.cond.notify_all();
+			} else if (pipeline.active == 0) {
+				pipeline.done = true;  // no pending work left
+			} else {
+				// running computations might spawn new states anytime: poll for them
+				pipeline.cond.wait_for(lock, std::chrono::milliseconds(1));
+			}
+		}
+		pipeline.cond.notify_all();
+	};
+
+	// The workers occupy all threads of the pool. Batches run by the computed units (e.g. concurrent Connecting
+	// pairs) are still processed by their calling thread, as ThreadPool::run() only helps with its own batch.
+	std::vector<ThreadPool::Job> jobs(pool->size() + 1, worker);
+	pool->run(std::move(jobs));
+}
+
+void DemandScheduler::init(ContainerBase& root) {
+	units_.clear();
+	if (isTransparent(root))
+		collectUnits(root, units_);
+	else
+		units_.push_back(root.pimpl());
+
+	// a unit consumes the states written into its own start or end interface
+	consumers_.assign(units_.size(), {});
+	for (size_t i = 0; i < units_.size(); ++i) {
+		for (const InterfacePtr& output : { units_[i]->nextStarts(), units_[i]->prevEnds() }) {
+			if (!output)
+				continue;
+			for (StagePrivate* consumer : units_)
+				if (consumer != units_[i] && (consumer->starts() == output || consumer->ends() == output))
+					consumers_[i].push_back(consumer);
+		}
+	}
+}
+
+bool DemandScheduler::hasDemand(size_t unit) const {
+	if (!units_[unit]->canCompute())
+		return false;
+	return std::none_of(consumers_[unit].begin(), consumers_[unit].end(),
+	                    [](const StagePrivate* consumer) { return consumer->canCompute(); });
+}
+
+void DemandScheduler::compute(ContainerBase& root) {
+	StagePrivate* root_impl = root.pimpl();
+
+	if (ThreadPool* pool = root_impl->threadPool()) {
+		std::vector<StagePrivate*> ready;
+		std::vector<StagePrivate*> pending;
+		{
+			auto lock = root_impl->lockPlanning();
+			for (size_t i = units_.size(); i-- > 0;) {
+				if (hasDemand(i))
+					ready.push_back(units_[i]);
+				else if (units_[i]->canCompute())
+					pending.push_back(units_[i]);
+			}
+		}
+		if (ready.empty())
+			ready.swap(pending);  // only parked units left: don't stall
+
+		std::vector<ThreadPool::Job> jobs;
+		jobs.reserve(ready.size());
+		for (StagePrivate* stage : ready)
+			jobs.emplace_back([stage] { stage->runCompute(); });
+		pool->run(std::move(jobs));
+		return;
+	}
+
+	// downstream first, re-evaluating demand after each computation
+	bool computed = false;
+	for (size_t i = units_.size(); i-- > 0;)
+		if (hasDemand(i)) {
+			units_[i]->runCompute();
+			computed = true;
+		}
+	if (computed)
+		return;
+	for (StagePrivate* unit : units_)
+		if (unit->canCompute())
+			unit->runCompute();
+}
+
+namespace {
+BanditScheduler::Arm& findArm(std::vector<BanditScheduler::Arm>& arms, const Stage* root) {
+	auto it = std::find_if(arms.begin(), arms.end(), [root](const auto& arm) { return arm.root == root; });
+	if (it != arms.end())
+		return *it;
+	arms.push_back(BanditScheduler::Arm{ root, {} });
+	return arms.back();
+}
+
+// branch is the child of the innermost enclosing Alternatives (nullptr outside of Alternatives)
+void collectArms(ContainerBase& container, const Stage* branch, std::vector<BanditScheduler::Arm>& arms) {
+	const bool alternatives = dynamic_cast<const Alternatives*>(&container);
+	for (const auto& child : container.pimpl()->children()) {
+		const Stage* root = alternatives ? child.get() : branch;
+		if (isTransparent(*child))
+			collectArms(static_cast<ContainerBase&>(*child), root, arms);
+		else
+			findArm(arms, root ? root : child.get()).units.push_back(child->pimpl());
+	}
+}
+}  // namespace
+
+size_t BanditScheduler::Arm::solutions() const {
+	return root->solutions().size();
+}
+
+double BanditScheduler::Arm::computeTime() const {
+	double time = 0.0;
+	for (const StagePrivate* unit : units)
+		time += unit->me()->getTotalComputeTime();
+	return time;
+}
+
+BanditScheduler::BanditScheduler(double prior_time, uint32_t seed) : prior_time_(prior_time), rng_(seed) {}
+
+void BanditScheduler::init(ContainerBase& root) {
+	arms_.clear();
+	if (isTransparent(root))
+		collectArms(root, nullptr, arms_);
+	else
+		arms_.push_back(Arm{ &root, { root.pimpl() } });
+}
+
+void BanditScheduler::compute(ContainerBase& root) {
+	StagePrivate* root_impl = root.pimpl();
+	ThreadPool* pool = root_impl->threadPool();
+
+	// draw the yield of all arms with pending work, remembering their most promising unit
+	std::vector<std::pair<double, StagePrivate*>> draws;
+	{
+		auto lock = root_impl->lockPlanning();
+		for (const Arm& arm : arms_) {
+			boost::optional<Candidate> best;
+			for (StagePrivate* unit : arm.units)
+				if (unit->canCompute()) {
+					Candidate c = evaluate(unit);
+					if (!best || c < *best)
+						best = c;
+				}
+			if (!best)
+				continue;
+			std::gamma_distribution<double> yield(1.0 + arm.solutions(), 1.0 / (prior_time_ + arm.computeTime()));
+			draws.emplace_back(yield(rng_), best->stage);
+		}
+	}
+	if (draws.empty())
+		return;
+
+	auto higher = [](const auto& a, const auto& b) { return a.first > b.first; };
+	if (!pool) {
+		std::min_element(draws.begin(), draws.end(), higher)->second->runCompute();
+		return;
+	}
+
+	// multi-threaded: compute the best arms concurrently, using the calling thread too
+	const size_t num = std::min(draws.size(), pool->size() + 1);
+	std::partial_sort(draws.begin(), draws.begin() + num, draws.end(), higher);
+	std::vector<ThreadPool::Job> jobs;
+	jobs.reserve(num);
+	for (size_t i = 0; i < num; ++i) {
+		StagePrivate* stage = draws[i].second;
+		jobs.emplace_back([stage] { stage->runCompute(); });
+	}
+	pool->run(std::move(jobs));
+}
+
+void CompiledScheduler::init(ContainerBase& root) {
+	std::vector<StagePrivate*> stages;
+	if (isTransparent(root))
+		collectUnits(root, stages);
+	else
+		stages.push_back(root.pimpl());
+
+	units_.clear();
+	units_.reserve(stages.size());
+	for (StagePrivate* stage : stages) {
+		// only propagating and connecting stages are solely driven by their input states
+		const bool driven = dynamic_cast<PropagatingEitherWayPrivate*>(stage) || dynamic_cast<ConnectingPrivate*>(stage);
+		units_.push_back(Unit{ stage, !driven, false, true });
+	}
+}
+
+bool CompiledScheduler::runnable(Unit& unit) {
+	bool modified = unit.dirty;
+	// clear both flags: don't short-circuit
+	for (const InterfacePtr& input : { unit.stage->starts(), unit.stage->ends() })
+		if (input && input->testAndClearModified())
+			modified = true;
+	if (modified || unit.polled) {
+		unit.runnable = unit.stage->canCompute();
+		unit.dirty = false;
+	}
+	return unit.runnable;
+}
+
+bool CompiledScheduler::canCompute(const ContainerBase& root) {
+	auto lock = root.pimpl()->lockPlanning();
+	bool result = false;
+	for (Unit& unit : units_)
+		result |= runnable(unit);
+	return result;
+}
+
+void CompiledScheduler::compute(ContainerBase& root) {
+	StagePrivate* root_impl = root.pimpl();
+
+	if (ThreadPool* pool = root_impl->threadPool()) {
+		std::vector<Unit*> ready;
+		{
+			auto lock = root_impl->lockPlanning();
+			for (Unit& unit : units_)
+				if (runnable(unit))
+					ready.push_back(&unit);
+		}
+		std::vector<ThreadPool::Job> jobs;
+		jobs.reserve(ready.size());
+		for (Unit* unit : ready)
+			jobs.emplace_back([unit] { unit->stage->runCompute(); });
+		pool->run(std::move(jobs));
+		for (Unit* unit : ready)
+			unit->dirty = true;
+		return;
+	}
+
+	for (Unit& unit : units_)
+		if (runnable(unit)) {
+			unit.stage->runCompute();
+			unit.dirty = true;  // computing might have consumed all pending work
+		}
+}
+}  // namespace task_constructor
+}  // namespace moveit
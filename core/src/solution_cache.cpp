@@ -0,0 +1,251 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Cache for solutions of propagating stages, keyed by their inputs
+*/
+
+#include <moveit/task_constructor/solution_cache.h>
+#include <moveit/task_constructor/stage.h>
+#include <moveit/task_constructor/solvers/planner_interface.h>
+#include <moveit/task_constructor/storage.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit_msgs/PlanningSceneComponents.h>
+
+#include <ros/console.h>
+#include <ros/serialization.h>
+#include <boost/core/demangle.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <typeinfo>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+// generic Stage properties that don't affect computed solutions
+const std::set<std::string> IGNORED_PROPERTIES = { "marker_ns", "trajectory_execution_info", "forwarded_properties" };
+// version of persisted entries
+constexpr uint32_t VERSION = 2;
+
+template <typename T>
+void appendSerialized(const T& value, std::string& buffer) {
+	const uint32_t length = ros::serialization::serializationLength(value);
+	const size_t offset = buffer.size();
+	buffer.resize(offset + length);
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[offset]), length);
+	ros::serialization::serialize(stream, value);
+}
+}  // namespace
+
+uint64_t SolutionCache::Key::digestOf(const std::string& input) {
+	uint64_t hash = 14695981039346656037ull;
+	for (const char c : input) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+SolutionCache::SolutionCache(size_t capacity, const std::string& directory)
+  : capacity_(std::max<size_t>(1, capacity)), directory_(directory) {}
+
+bool SolutionCache::computeKey(const PropagatingEitherWay& stage, int direction, const InterfaceState& state,
+                               Key& key) {
+	// demangled class name: a stable type tag, unlike typeid().name()
+	std::string buffer = boost::core::demangle(typeid(stage).name());
+	buffer += '\0';
+	buffer += std::to_string(direction);
+	buffer += '\0';
+
+	// stage properties
+	for (const auto& pair : stage.properties()) {
+		if (IGNORED_PROPERTIES.count(pair.first))
+			continue;
+		const boost::any& value = pair.second.value();
+		std::string serialized = Property::serialize(value);
+		if (!value.empty() && serialized.empty()) {
+			ROS_DEBUG_STREAM_NAMED("SolutionCache", "Cannot serialize property '"
+			                                            << pair.first << "' of stage '" << stage.name()
+			                                            << "': disabling cache");
+			return false;
+		}
+		buffer += pair.first;
+		buffer += '\0';
+		buffer += serialized;
+		buffer += '\0';
+	}
+
+	// planners and their configuration
+	for (const solvers::PlannerInterfaceConstPtr& planner : stage.planners())
+		if (planner && !planner->appendIdentity(buffer)) {
+			ROS_DEBUG_STREAM_NAMED("SolutionCache",
+			                       "Cannot serialize planner of stage '" << stage.name() << "': disabling cache");
+			return false;
+		}
+
+	// relevant parts of the start scene
+	moveit_msgs::PlanningSceneComponents components;
+	components.components = moveit_msgs::PlanningSceneComponents::ROBOT_STATE |
+	                        moveit_msgs::PlanningSceneComponents::ROBOT_STATE_ATTACHED_OBJECTS |
+	                        moveit_msgs::PlanningSceneComponents::WORLD_OBJECT_GEOMETRY |
+	                        moveit_msgs::PlanningSceneComponents::ALLOWED_COLLISION_MATRIX;
+	moveit_msgs::PlanningScene scene;
+	state.scene()->getPlanningSceneMsg(scene, components);
+	appendSerialized(scene, buffer);
+
+	key.digest = Key::digestOf(buffer);
+	key.input = std::move(buffer);
+	return true;
+}
+
+bool SolutionCache::lookup(const Key& key, const planning_scene::PlanningSceneConstPtr& start,
+                           planning_scene::PlanningScenePtr& end, SubTrajectory& solution) {
+	moveit_task_constructor_msgs::SubTrajectory msg;
+	if (!find(key, msg))
+		return false;
+
+	end = start->diff();
+	end->usePlanningSceneMsg(msg.scene_diff);  // full scene msg, if end wasn't derived from start
+	end->getCurrentStateNonConst().update();
+
+	robot_trajectory::RobotTrajectoryPtr trajectory;
+	if (!msg.trajectory.joint_trajectory.points.empty() || !msg.trajectory.multi_dof_joint_trajectory.points.empty()) {
+		trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(start->getRobotModel(), nullptr);
+		trajectory->setRobotTrajectoryMsg(start->getCurrentState(), msg.trajectory);
+	}
+	solution = SubTrajectory(trajectory, 0.0, msg.info.comment);
+	return true;
+}
+
+void SolutionCache::store(const Key& key, const planning_scene::PlanningSceneConstPtr& start,
+                          const planning_scene::PlanningSceneConstPtr& end, const SubTrajectory& solution) {
+	moveit_task_constructor_msgs::SubTrajectory msg;
+	if (solution.trajectory())
+		solution.trajectory()->getRobotTrajectoryMsg(msg.trajectory);
+	if (end->getParent() == start) {
+		end->getPlanningSceneDiffMsg(msg.scene_diff);
+		msg.scene_diff.is_diff = true;
+	} else
+		end->getPlanningSceneMsg(msg.scene_diff);
+	msg.info.comment = solution.comment();
+	insert(key, msg);
+
+	if (directory_.empty())
+		return;
+	std::string buffer;
+	appendSerialized(VERSION, buffer);
+	appendSerialized(key.input, buffer);
+	appendSerialized(msg, buffer);
+	std::ofstream file(path(key), std::ios::binary | std::ios::trunc);
+	if (!file.write(buffer.data(), buffer.size()))
+		ROS_WARN_STREAM_NAMED("SolutionCache", "Failed to write cache entry " << path(key));
+}
+
+size_t SolutionCache::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return entries_.size();
+}
+
+void SolutionCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+	index_.clear();
+}
+
+bool SolutionCache::find(const Key& key, moveit_task_constructor_msgs::SubTrajectory& msg) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = index_.find(key.digest);
+		if (it != index_.end() && it->second->first.input == key.input) {
+			entries_.splice(entries_.begin(), entries_, it->second);  // mark as most recently used
+			msg = it->second->second;
+			return true;
+		}
+	}
+	if (directory_.empty())
+		return false;
+
+	// fall back to persisted entry
+	std::ifstream file(path(key), std::ios::binary);
+	if (!file)
+		return false;
+	std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	try {
+		ros::serialization::IStream stream(buffer.data(), buffer.size());
+		uint32_t version;
+		std::string input;
+		ros::serialization::deserialize(stream, version);
+		if (version != VERSION)
+			return false;
+		ros::serialization::deserialize(stream, input);
+		if (input != key.input)
+			return false;  // digest collision
+		ros::serialization::deserialize(stream, msg);
+	} catch (const ros::Exception& e) {
+		ROS_WARN_STREAM_NAMED("SolutionCache", "Ignoring corrupt cache entry " << path(key) << ": " << e.what());
+		return false;
+	}
+	insert(key, msg);
+	return true;
+}
+
+void SolutionCache::insert(const Key& key, const moveit_task_constructor_msgs::SubTrajectory& msg) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = index_.find(key.digest);
+	if (it != index_.end()) {  // replace entry, even if its input differs
+		it->second->first = key;
+		it->second->second = msg;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return;
+	}
+	entries_.emplace_front(key, msg);
+	index_.emplace(key.digest, entries_.begin());
+	if (entries_.size() > capacity_) {  // evict least recently used entry
+		index_.erase(entries_.back().first.digest);
+		entries_.pop_back();
+	}
+}
+
+std::string SolutionCache::path(const Key& key) const {
+	std::ostringstream oss;
+	oss << directory_ << '/' << std::hex << std::setfill('0') << std::setw(16) << key.digest << ".msg";
+	return oss.str();
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,386 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Compact, memory-mappable binary file of solutions
+*/
+
+#include <moveit/task_constructor/solution_file.h>
+
+#include <ros/serialization.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+constexpr char MAGIC[8] = { 'M', 'T', 'C', 'S', 'O', 'L', 'N', '\0' };
+constexpr uint32_t VERSION = 1;
+constexpr uint64_t NONE = std::numeric_limits<uint64_t>::max();  // missing waypoint array
+}  // namespace
+
+struct SolutionFile::Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t num_solutions;
+	uint64_t num_subs;
+	uint64_t num_blobs;
+	uint64_t num_doubles;
+	// byte offsets of sections
+	uint64_t solutions;
+	uint64_t subs;
+	uint64_t blobs;
+	uint64_t doubles;
+	uint64_t blob_data;
+	uint64_t file_size;
+};
+
+// blob references are 1-based indices into the blob table, 0 denotes a missing blob
+struct SolutionFile::SolutionRecord
+{
+	double cost;
+	uint32_t comment;
+	uint32_t task_id;
+	uint32_t start_scene;
+	uint32_t reserved;
+	uint64_t first_sub;
+	uint64_t num_subs;
+};
+
+struct SolutionFile::SubRecord
+{
+	// indices into the doubles section
+	uint64_t times;
+	uint64_t positions;
+	uint64_t velocities;
+	uint64_t accelerations;
+	uint64_t efforts;
+	uint32_t num_waypoints;
+	uint32_t num_joints;
+	// blob references
+	uint32_t joint_names;
+	uint32_t scene_diff;
+	uint32_t execution_info;
+	uint32_t multi_dof;
+	uint32_t comment;
+	uint32_t reserved;
+	double cost;
+	uint32_t id;
+	uint32_t stage_id;
+};
+
+struct SolutionFile::BlobRecord
+{
+	uint64_t offset;  // relative to blob_data section
+	uint64_t size;
+};
+
+namespace {
+template <typename Msg>
+std::string serialize(const Msg& msg) {
+	std::string buffer(ros::serialization::serializationLength(msg), '\0');
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[0]), buffer.size());
+	ros::serialization::serialize(stream, msg);
+	return buffer;
+}
+
+template <typename T>
+void writeArray(std::ofstream& file, const std::vector<T>& items) {
+	file.write(reinterpret_cast<const char*>(items.data()), static_cast<std::streamsize>(items.size() * sizeof(T)));
+}
+}  // namespace
+
+void SolutionFile::write(const std::string& path, const std::vector<moveit_task_constructor_msgs::Solution>& solutions) {
+	static_assert(sizeof(Header) % 8 == 0 && sizeof(SolutionRecord) % 8 == 0 && sizeof(SubRecord) % 8 == 0 &&
+	                  sizeof(BlobRecord) % 8 == 0,
+	              "records need to keep the doubles section aligned");
+
+	std::vector<SolutionRecord> solution_records;
+	std::vector<SubRecord> sub_records;
+	std::vector<double> doubles;
+	std::vector<std::string> blobs;
+	std::unordered_map<std::string, uint32_t> blob_index;  // deduplicate by serialized content
+
+	auto add_blob = [&](const auto& msg) -> uint32_t {
+		auto inserted = blob_index.emplace(serialize(msg), blobs.size() + 1);
+		if (inserted.second)
+			blobs.push_back(inserted.first->first);
+		return inserted.first->second;
+	};
+	// append given member of all points to doubles, if all points provide it
+	auto add_values = [&doubles](const std::vector<trajectory_msgs::JointTrajectoryPoint>& points, size_t num_joints,
+	                             std::vector<double> trajectory_msgs::JointTrajectoryPoint::*member) -> uint64_t {
+		if (points.empty() ||
+		    std::any_of(points.begin(), points.end(), [&](const auto& p) { return (p.*member).size() != num_joints; }))
+			return NONE;
+		const uint64_t offset = doubles.size();
+		for (const auto& p : points)
+			doubles.insert(doubles.end(), (p.*member).begin(), (p.*member).end());
+		return offset;
+	};
+
+	solution_records.reserve(solutions.size());
+	for (const auto& solution : solutions) {
+		SolutionRecord record{};
+		record.task_id = solution.task_id.empty() ? 0 : add_blob(solution.task_id);
+		record.start_scene = add_blob(solution.start_scene);
+		record.first_sub = sub_records.size();
+		record.num_subs = solution.sub_trajectory.size();
+		record.cost = 0.0;
+
+		for (const auto& t : solution.sub_trajectory) {
+			const auto& jt = t.trajectory.joint_trajectory;
+			SubRecord sub{};
+			sub.num_waypoints = jt.points.size();
+			sub.num_joints = jt.joint_names.size();
+			sub.times = doubles.size();
+			for (const auto& p : jt.points)
+				doubles.push_back(p.time_from_start.toSec());
+			sub.positions = add_values(jt.points, sub.num_joints, &trajectory_msgs::JointTrajectoryPoint::positions);
+			sub.velocities = add_values(jt.points, sub.num_joints, &trajectory_msgs::JointTrajectoryPoint::velocities);
+			sub.accelerations =
+			    add_values(jt.points, sub.num_joints, &trajectory_msgs::JointTrajectoryPoint::accelerations);
+			sub.efforts = add_values(jt.points, sub.num_joints, &trajectory_msgs::JointTrajectoryPoint::effort);
+
+			sub.joint_names = add_blob(jt.joint_names);
+			// scene diffs might have been moved to the solution's scene table already
+			sub.scene_diff = add_blob(t.scene_diff_index > 0 && t.scene_diff_index <= solution.scene_table.size() ?
+			                              solution.scene_table[t.scene_diff_index - 1] :
+			                              t.scene_diff);
+			sub.execution_info = add_blob(t.execution_info);
+			sub.multi_dof = t.trajectory.multi_dof_joint_trajectory.points.empty() ?
+			                    0 :
+			                    add_blob(t.trajectory.multi_dof_joint_trajectory);
+			sub.comment = t.info.comment.empty() ? 0 : add_blob(t.info.comment);
+			sub.cost = t.info.cost;
+			sub.id = t.info.id;
+			sub.stage_id = t.info.stage_id;
+			sub_records.push_back(sub);
+
+			record.cost += t.info.cost;
+		}
+		// the overall solution is described by its top-level sub solution, if available
+		if (!solution.sub_solution.empty()) {
+			record.cost = solution.sub_solution.front().info.cost;
+			const std::string& comment = solution.sub_solution.front().info.comment;
+			record.comment = comment.empty() ? 0 : add_blob(comment);
+		}
+		solution_records.push_back(record);
+	}
+
+	std::vector<BlobRecord> blob_records;
+	blob_records.reserve(blobs.size());
+	uint64_t blob_size = 0;
+	for (const auto& blob : blobs) {
+		blob_records.push_back(BlobRecord{ blob_size, blob.size() });
+		blob_size += blob.size();
+	}
+
+	Header header{};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.num_solutions = solution_records.size();
+	header.num_subs = sub_records.size();
+	header.num_blobs = blob_records.size();
+	header.num_doubles = doubles.size();
+	header.solutions = sizeof(Header);
+	header.subs = header.solutions + solution_records.size() * sizeof(SolutionRecord);
+	header.blobs = header.subs + sub_records.size() * sizeof(SubRecord);
+	header.doubles = header.blobs + blob_records.size() * sizeof(BlobRecord);
+	header.blob_data = header.doubles + doubles.size() * sizeof(double);
+	header.file_size = header.blob_data + blob_size;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("SolutionFile: cannot open '" + path + "' for writing");
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeArray(file, solution_records);
+	writeArray(file, sub_records);
+	writeArray(file, blob_records);
+	writeArray(file, doubles);
+	for (const auto& blob : blobs)
+		file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+	if (!file)
+		throw std::runtime_error("SolutionFile: failed to write '" + path + "'");
+}
+
+SolutionFile::SolutionFile(const std::string& path) {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("SolutionFile: cannot open '" + path + "'");
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+		::close(fd);
+		throw std::runtime_error("SolutionFile: '" + path + "' is not a solution file");
+	}
+	size_ = st.st_size;
+	void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);  // the mapping stays valid
+	if (data == MAP_FAILED)
+		throw std::runtime_error("SolutionFile: cannot map '" + path + "'");
+	data_ = static_cast<const uint8_t*>(data);
+	header_ = reinterpret_cast<const Header*>(data_);
+
+	const Header& h = *header_;
+	const bool valid = std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.version == VERSION &&
+	                   h.file_size == size_ && h.solutions == sizeof(Header) &&
+	                   h.subs == h.solutions + h.num_solutions * sizeof(SolutionRecord) &&
+	                   h.blobs == h.subs + h.num_subs * sizeof(SubRecord) &&
+	                   h.doubles == h.blobs + h.num_blobs * sizeof(BlobRecord) &&
+	                   h.blob_data == h.doubles + h.num_doubles * sizeof(double) && h.blob_data <= size_;
+	if (!valid) {
+		::munmap(const_cast<uint8_t*>(data_), size_);
+		throw std::runtime_error("SolutionFile: '" + path + "' is corrupt or has an unsupported version");
+	}
+}
+
+SolutionFile::~SolutionFile() {
+	::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+size_t SolutionFile::size() const {
+	return header_->num_solutions;
+}
+
+const SolutionFile::SolutionRecord& SolutionFile::solutionRecord(size_t solution) const {
+	if (solution >= header_->num_solutions)
+		throw std::out_of_range("SolutionFile: invalid solution index");
+	return reinterpret_cast<const SolutionRecord*>(data_ + header_->solutions)[solution];
+}
+
+const SolutionFile::SubRecord& SolutionFile::subRecord(size_t solution, size_t sub_trajectory) const {
+	const SolutionRecord& record = solutionRecord(solution);
+	if (sub_trajectory >= record.num_subs || record.first_sub + sub_trajectory >= header_->num_subs)
+		throw std::out_of_range("SolutionFile: invalid sub trajectory index");
+	return reinterpret_cast<const SubRecord*>(data_ + header_->subs)[record.first_sub + sub_trajectory];
+}
+
+template <typename Msg>
+void SolutionFile::readBlob(uint32_t index, Msg& msg) const {
+	if (index == 0)
+		return;  // missing blob: keep default
+	if (index > header_->num_blobs)
+		throw std::runtime_error("SolutionFile: invalid blob reference");
+	const BlobRecord& blob = reinterpret_cast<const BlobRecord*>(data_ + header_->blobs)[index - 1];
+	if (blob.offset + blob.size > size_ - header_->blob_data)
+		throw std::runtime_error("SolutionFile: blob exceeds file");
+	// IStream doesn't modify the buffer
+	ros::serialization::IStream stream(const_cast<uint8_t*>(data_ + header_->blob_data + blob.offset), blob.size);
+	ros::serialization::deserialize(stream, msg);
+}
+
+double SolutionFile::cost(size_t solution) const {
+	return solutionRecord(solution).cost;
+}
+
+std::string SolutionFile::comment(size_t solution) const {
+	std::string comment;
+	readBlob(solutionRecord(solution).comment, comment);
+	return comment;
+}
+
+size_t SolutionFile::numSubTrajectories(size_t solution) const {
+	return solutionRecord(solution).num_subs;
+}
+
+SolutionFile::TrajectoryView SolutionFile::trajectory(size_t solution, size_t sub_trajectory) const {
+	const SubRecord& sub = subRecord(solution, sub_trajectory);
+	const double* doubles = reinterpret_cast<const double*>(data_ + header_->doubles);
+	const uint64_t num_values = uint64_t(sub.num_waypoints) * sub.num_joints;
+	auto array = [&](uint64_t offset, uint64_t count) -> const double* {
+		if (offset == NONE)
+			return nullptr;
+		if (offset + count > header_->num_doubles)
+			throw std::runtime_error("SolutionFile: waypoint data exceeds file");
+		return doubles + offset;
+	};
+	return TrajectoryView{ sub.num_waypoints,
+		                   sub.num_joints,
+		                   array(sub.times, sub.num_waypoints),
+		                   array(sub.positions, num_values),
+		                   array(sub.velocities, num_values),
+		                   array(sub.accelerations, num_values),
+		                   array(sub.efforts, num_values) };
+}
+
+moveit_task_constructor_msgs::Solution SolutionFile::solution(size_t solution) const {
+	const SolutionRecord& record = solutionRecord(solution);
+	moveit_task_constructor_msgs::Solution msg;
+	readBlob(record.task_id, msg.task_id);
+	readBlob(record.start_scene, msg.start_scene);
+
+	msg.sub_trajectory.resize(record.num_subs);
+	for (size_t i = 0; i < record.num_subs; ++i) {
+		const SubRecord& sub = subRecord(solution, i);
+		const TrajectoryView view = trajectory(solution, i);
+		auto& t = msg.sub_trajectory[i];
+		t.info.id = sub.id;
+		t.info.cost = sub.cost;
+		t.info.stage_id = sub.stage_id;
+		readBlob(sub.comment, t.info.comment);
+		readBlob(sub.execution_info, t.execution_info);
+		readBlob(sub.scene_diff, t.scene_diff);
+		readBlob(sub.multi_dof, t.trajectory.multi_dof_joint_trajectory);
+
+		auto& jt = t.trajectory.joint_trajectory;
+		readBlob(sub.joint_names, jt.joint_names);
+		jt.points.resize(view.num_waypoints);
+		auto assign = [n = view.num_joints](const double* values, size_t waypoint, std::vector<double>& target) {
+			if (values)
+				target.assign(values + waypoint * n, values + (waypoint + 1) * n);
+		};
+		for (size_t w = 0; w < view.num_waypoints; ++w) {
+			auto& p = jt.points[w];
+			p.time_from_start = ros::Duration(view.times[w]);
+			assign(view.positions, w, p.positions);
+			assign(view.velocities, w, p.velocities);
+			assign(view.accelerations, w, p.accelerations);
+			assign(view.efforts, w, p.effort);
+		}
+	}
+	return msg;
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,201 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Shared-memory ring of serialized solutions
+*/
+
+#include <moveit/task_constructor/solution_ring.h>
+
+#include <ros/serialization.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <random>
+#include <stdexcept>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+constexpr char MAGIC[8] = { 'M', 'T', 'C', 'R', 'I', 'N', 'G', '\0' };
+constexpr uint32_t VERSION = 1;
+
+std::string segmentName(const std::string& name) {
+	return name.empty() || name.front() != '/' ? "/" + name : name;
+}
+}  // namespace
+
+struct SolutionRing::Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t capacity;
+	uint64_t instance;
+	// monotonic end position of the last blob, updated *before* the blob is written
+	std::atomic<uint64_t> head;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring header is shared between processes");
+
+SolutionRing::SolutionRing(const std::string& name, bool owner) : name_(segmentName(name)), owner_(owner) {}
+
+SolutionRing::~SolutionRing() {
+	if (data_)
+		::munmap(data_, size_);
+	if (owner_)
+		::shm_unlink(name_.c_str());
+}
+
+void SolutionRing::map(int fd, size_t size, bool writable) {
+	void* data = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);  // the mapping stays valid
+	if (data == MAP_FAILED)
+		throw std::runtime_error("SolutionRing: cannot map '" + name_ + "'");
+	data_ = static_cast<uint8_t*>(data);
+	size_ = size;
+	header_ = reinterpret_cast<Header*>(data_);
+}
+
+SolutionRingPtr SolutionRing::create(const std::string& name, size_t capacity) {
+	if (capacity == 0)
+		throw std::runtime_error("SolutionRing: capacity must be positive");
+	SolutionRingPtr ring(new SolutionRing(name, false));
+	::shm_unlink(ring->name_.c_str());  // replace stale segment of a previous run
+	const int fd = ::shm_open(ring->name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0)
+		throw std::runtime_error("SolutionRing: cannot create '" + ring->name_ + "'");
+	ring->owner_ = true;
+	const size_t size = sizeof(Header) + capacity;
+	if (::ftruncate(fd, size) != 0) {
+		::close(fd);
+		throw std::runtime_error("SolutionRing: cannot allocate " + std::to_string(size) + " bytes for '" +
+		                         ring->name_ + "'");
+	}
+	ring->map(fd, size, true);
+
+	Header* header = new (ring->data_) Header();
+	std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+	header->version = VERSION;
+	header->capacity = capacity;
+	header->instance = (uint64_t(std::random_device()()) << 32) ^
+	                   std::chrono::steady_clock::now().time_since_epoch().count();
+	header->head.store(0, std::memory_order_release);
+	return ring;
+}
+
+SolutionRingPtr SolutionRing::open(const std::string& name) {
+	SolutionRingPtr ring(new SolutionRing(name, false));
+	const int fd = ::shm_open(ring->name_.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+		throw std::runtime_error("SolutionRing: cannot open '" + ring->name_ + "'");
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+		::close(fd);
+		throw std::runtime_error("SolutionRing: '" + ring->name_ + "' is not a solution ring");
+	}
+	ring->map(fd, st.st_size, false);
+
+	const Header& h = *ring->header_;
+	if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION ||
+	    sizeof(Header) + h.capacity != ring->size_)
+		throw std::runtime_error("SolutionRing: '" + ring->name_ + "' is corrupt or has an unsupported version");
+	return ring;
+}
+
+size_t SolutionRing::capacity() const {
+	return header_->capacity;
+}
+
+uint64_t SolutionRing::instance() const {
+	return header_->instance;
+}
+
+bool SolutionRing::write(const moveit_task_constructor_msgs::Solution& msg,
+                         moveit_task_constructor_msgs::SolutionHandle& handle) {
+	if (!owner_)
+		throw std::logic_error("SolutionRing: '" + name_ + "' is mapped read-only");
+	const uint64_t capacity = header_->capacity;
+	const uint32_t size = ros::serialization::serializationLength(msg);
+	if (size > capacity)
+		return false;
+
+	uint64_t position = header_->head.load(std::memory_order_relaxed);
+	const uint64_t offset = position % capacity;
+	if (offset + size > capacity)  // blobs don't wrap around
+		position += capacity - offset;
+	// announce the range to be overwritten before actually writing it
+	header_->head.store(position + size, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	ros::serialization::OStream stream(data_ + sizeof(Header) + position % capacity, size);
+	ros::serialization::serialize(stream, msg);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	handle.task_id = msg.task_id;
+	handle.segment = name_;
+	handle.instance = header_->instance;
+	handle.position = position;
+	handle.size = size;
+	return true;
+}
+
+bool SolutionRing::read(const moveit_task_constructor_msgs::SolutionHandle& handle,
+                        moveit_task_constructor_msgs::Solution& msg) const {
+	const uint64_t capacity = header_->capacity;
+	if (segmentName(handle.segment) != name_ || handle.instance != header_->instance || handle.size > capacity ||
+	    handle.position % capacity + handle.size > capacity)
+		return false;
+	const uint64_t head = header_->head.load(std::memory_order_acquire);
+	if (head < handle.position + handle.size || head > handle.position + capacity)
+		return false;  // not yet written or already overwritten
+
+	try {
+		ros::serialization::IStream stream(data_ + sizeof(Header) + handle.position % capacity, handle.size);
+		ros::serialization::deserialize(stream, msg);
+	} catch (const std::exception&) {  // garbage from a concurrent overwrite
+		return false;
+	}
+	// validate that the blob was not overwritten while deserializing
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return header_->head.load(std::memory_order_relaxed) <= handle.position + capacity;
+}
+}  // namespace task_constructor
+}  // namespace moveit
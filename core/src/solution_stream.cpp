@@ -0,0 +1,94 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Thread-safe queue streaming solutions of a planning task to a consumer
+*/
+
+#include <moveit/task_constructor/solution_stream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace moveit {
+namespace task_constructor {
+
+void SolutionStream::push(const SolutionBaseConstPtr& solution) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (closed_)
+			return;
+		queue_.push_back(solution);
+	}
+	cond_.notify_one();
+}
+
+void SolutionStream::close() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		closed_ = true;
+	}
+	cond_.notify_all();
+}
+
+bool SolutionStream::closed() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return closed_;
+}
+
+SolutionBaseConstPtr SolutionStream::next(double timeout) {
+	std::unique_lock<std::mutex> lock(mutex_);
+	auto ready = [this] { return !queue_.empty() || closed_; };
+	if (std::isinf(timeout))
+		cond_.wait(lock, ready);
+	else if (!cond_.wait_for(lock, std::chrono::duration<double>(std::max(0.0, timeout)), ready))
+		return nullptr;  // timeout
+
+	if (queue_.empty())
+		return nullptr;  // closed and drained
+	SolutionBaseConstPtr solution = std::move(queue_.front());
+	queue_.pop_front();
+	return solution;
+}
+
+SolutionBaseConstPtr SolutionStream::tryNext() {
+	return next(0.0);
+}
+
+size_t SolutionStream::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queue_.size();
+}
+}  // namespace task_constructor
+}  // namespace moveit
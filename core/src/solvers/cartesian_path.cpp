@@ -44,6 +44,8 @@
 #include <moveit/robot_state/cartesian_interpolator.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <algorithm>
+
 using namespace trajectory_processing;
 
 namespace moveit {
@@ -54,6 +56,8 @@ CartesianPath::CartesianPath() {
 	auto& p = properties();
 	p.declare<geometry_msgs::PoseStamped>("ik_frame", "frame to move linearly (use for joint-space target)");
 	p.declare<double>("step_size", 0.01, "step size between consecutive waypoints");
+	p.declare<double>("max_step_size", 0.0,
+	                  "if larger than step_size, adapt step size in this range to the achieved precision");
 	p.declare<moveit::core::CartesianPrecision>("precision", moveit::core::CartesianPrecision(),
 	                                            "precision of linear path");
 	p.declare<double>("min_fraction", 1.0, "fraction of motion required for success");
@@ -63,6 +67,89 @@ CartesianPath::CartesianPath() {
 
 void CartesianPath::init(const core::RobotModelConstPtr& /*robot_model*/) {}
 
+namespace {
+Eigen::Isometry3d interpolate(const Eigen::Isometry3d& start, const Eigen::Quaterniond& start_q,
+                              const Eigen::Isometry3d& target, const Eigen::Quaterniond& target_q, double s) {
+	Eigen::Isometry3d pose(start_q.slerp(s, target_q));
+	pose.translation() = (1.0 - s) * start.translation() + s * target.translation();
+	return pose;
+}
+
+/** Cartesian path with adaptive step size
+ *
+ * Steps grow up to max_step as long as joint-space interpolation between consecutive waypoints
+ * stays within the given precision of the straight line, i.e. far from singularities and IK branch switches.
+ * Otherwise they are halved down to min_step. If even a minimal step fails, the remainder is planned
+ * by MoveIt's computeCartesianPath() with fixed min_step, which applies its own jump detection.
+ */
+double computeAdaptiveCartesianPath(moveit::core::RobotState* state, const moveit::core::JointModelGroup* jmg,
+                                    std::vector<moveit::core::RobotStatePtr>& trajectory,
+                                    const moveit::core::LinkModel& link, const Eigen::Isometry3d& target,
+                                    const Eigen::Isometry3d& offset, double min_step, double max_step,
+                                    const moveit::core::CartesianPrecision& precision,
+                                    const moveit::core::GroupStateValidityCallbackFn& is_valid,
+                                    const kinematics::KinematicsQueryOptions& options) {
+	state->updateLinkTransforms();
+	const Eigen::Isometry3d start = state->getGlobalLinkTransform(&link) * offset;
+	const double distance = (target.translation() - start.translation()).norm();
+	if (distance <= min_step)  // nothing to adapt
+		return moveit::core::CartesianInterpolator::computeCartesianPath(state, jmg, trajectory, &link, target, true,
+		                                                                 moveit::core::MaxEEFStep(min_step), precision,
+		                                                                 is_valid, options, offset);
+
+	const Eigen::Quaterniond start_q(start.linear());
+	const Eigen::Quaterniond target_q(target.linear());
+	const Eigen::Isometry3d offset_inv = offset.inverse();
+	const double ds_min = min_step / distance;
+	const double ds_max = max_step / distance;
+
+	trajectory.clear();
+	trajectory.push_back(std::make_shared<moveit::core::RobotState>(*state));
+	moveit::core::RobotState candidate(*state);
+	moveit::core::RobotState mid(*state);
+
+	double s = 0.0;
+	double ds = ds_max;
+	while (s < 1.0) {
+		const double s_next = std::min(1.0, s + ds);
+		const moveit::core::RobotState& prev = *trajectory.back();
+		candidate = prev;
+
+		bool ok = candidate.setFromIK(jmg, interpolate(start, start_q, target, target_q, s_next) * offset_inv,
+		                              link.getName(), 0.0, is_valid, options);
+		if (ok && ds > ds_min) {  // validate joint-space interpolation at the segment's midpoint
+			prev.interpolate(candidate, 0.5, mid, jmg);
+			mid.updateLinkTransforms();
+			const Eigen::Isometry3d actual = mid.getGlobalLinkTransform(&link) * offset;
+			const Eigen::Isometry3d expected = interpolate(start, start_q, target, target_q, 0.5 * (s + s_next));
+			ok = (actual.translation() - expected.translation()).norm() <= precision.translational &&
+			     Eigen::AngleAxisd(actual.linear().transpose() * expected.linear()).angle() <= precision.rotational;
+		}
+
+		if (ok) {
+			candidate.update();
+			trajectory.push_back(std::make_shared<moveit::core::RobotState>(candidate));
+			s = s_next;
+			ds = std::min(2.0 * ds, ds_max);
+		} else if (ds > ds_min) {
+			ds = std::max(0.5 * ds, ds_min);
+		} else {  // plan the remainder with fixed steps
+			moveit::core::RobotState remainder_start(prev);
+			std::vector<moveit::core::RobotStatePtr> remainder;
+			double fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+			    &remainder_start, jmg, remainder, &link, target, true, moveit::core::MaxEEFStep(min_step), precision,
+			    is_valid, options, offset);
+			trajectory.insert(trajectory.end(), remainder.begin() + std::min<size_t>(1, remainder.size()),
+			                  remainder.end());
+			s += (1.0 - s) * fraction;
+			break;
+		}
+	}
+	*state = *trajectory.back();
+	return s;
+}
+}  // namespace
+
 void CartesianPath::setIKFrame(const Eigen::Isometry3d& pose, const std::string& link) {
 	geometry_msgs::PoseStamped pose_msg;
 	pose_msg.header.frame_id = link;
@@ -75,6 +162,7 @@ PlannerInterface::Result CartesianPath::plan(const planning_scene::PlanningScene
                                              const moveit::core::JointModelGroup* jmg, double timeout,
                                              robot_trajectory::RobotTrajectoryPtr& result,
                                              const moveit_msgs::Constraints& path_constraints) {
+	PlannerTimer timer;
 	const auto& props = properties();
 	const moveit::core::LinkModel* link;
 	std::string error_msg;
@@ -87,7 +175,8 @@ PlannerInterface::Result CartesianPath::plan(const planning_scene::PlanningScene
 
 	// reach pose of forward kinematics
 	return plan(from, *link, offset, to->getCurrentState().getGlobalLinkTransform(link), jmg,
-	            std::min(timeout, props.get<double>("timeout")), result, path_constraints);
+	            std::min({ timeout, props.get<double>("timeout"), PlannerCancellation::remainingTime() }), result,
+	            path_constraints);
 }
 
 PlannerInterface::Result CartesianPath::plan(const planning_scene::PlanningSceneConstPtr& from,
@@ -95,6 +184,7 @@ PlannerInterface::Result CartesianPath::plan(const planning_scene::PlanningScene
                                              const Eigen::Isometry3d& target, const moveit::core::JointModelGroup* jmg,
                                              double /*timeout*/, robot_trajectory::RobotTrajectoryPtr& result,
                                              const moveit_msgs::Constraints& path_constraints) {
+	PlannerTimer timer;
 	const auto& props = properties();
 	planning_scene::PlanningScenePtr sandbox_scene = from->diff();
 
@@ -110,21 +200,26 @@ PlannerInterface::Result CartesianPath::plan(const planning_scene::PlanningScene
 	};
 
 	std::vector<moveit::core::RobotStatePtr> trajectory;
-	double achieved_fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
-	    &(sandbox_scene->getCurrentStateNonConst()), jmg, trajectory, &link, target, true,
-	    moveit::core::MaxEEFStep(props.get<double>("step_size")),
-	    props.get<moveit::core::CartesianPrecision>("precision"), is_valid,
-	    props.get<kinematics::KinematicsQueryOptions>("kinematics_options"), offset);
+	const double step_size = props.get<double>("step_size");
+	const double max_step_size = props.get<double>("max_step_size");
+	double achieved_fraction;
+	if (max_step_size > step_size)
+		achieved_fraction = computeAdaptiveCartesianPath(
+		    &(sandbox_scene->getCurrentStateNonConst()), jmg, trajectory, link, target, offset, step_size,
+		    max_step_size, props.get<moveit::core::CartesianPrecision>("precision"), is_valid,
+		    props.get<kinematics::KinematicsQueryOptions>("kinematics_options"));
+	else
+		achieved_fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+		    &(sandbox_scene->getCurrentStateNonConst()), jmg, trajectory, &link, target, true,
+		    moveit::core::MaxEEFStep(step_size), props.get<moveit::core::CartesianPrecision>("precision"), is_valid,
+		    props.get<kinematics::KinematicsQueryOptions>("kinematics_options"), offset);
 
 	assert(!trajectory.empty());  // there should be at least the start state
 	result = std::make_shared<robot_trajectory::RobotTrajectory>(sandbox_scene->getRobotModel(), jmg);
 	for (const auto& waypoint : trajectory)
 		result->addSuffixWayPoint(waypoint, 0.0);
 
-	auto timing = props.get<TimeParameterizationPtr>("time_parameterization");
-	if (timing)
-		timing->computeTimeStamps(*result, props.get<double>("max_velocity_scaling_factor"),
-		                          props.get<double>("max_acceleration_scaling_factor"));
+	applyTimeParameterization(result);
 
 	if (achieved_fraction < props.get<double>("min_fraction")) {
 		return { false, "min_fraction not met. Achieved: " + std::to_string(achieved_fraction) };
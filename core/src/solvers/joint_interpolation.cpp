@@ -37,10 +37,14 @@
 */
 
 #include <moveit/task_constructor/solvers/joint_interpolation.h>
+#include <moveit/task_constructor/batch_collision.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/trajectory_processing/time_parameterization.h>
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
+#include <vector>
 
 namespace moveit {
 namespace task_constructor {
@@ -51,17 +55,113 @@ using namespace trajectory_processing;
 JointInterpolationPlanner::JointInterpolationPlanner() {
 	auto& p = properties();
 	p.declare<double>("max_step", 0.1, "max joint step");
+	p.declare<bool>("bisection", false,
+	                "validate waypoints in bisection order (goal and midpoints first) to detect collisions early");
+	p.declare<uint32_t>("collision_batch_size", 1,
+	                    "number of waypoints collision-checked in a single call of the active BatchCollisionChecker");
 	// allow passing max_effort to GripperCommand actions via
 	p.declare<double>("max_effort", "max_effort for GripperCommand actions");
 }
 
 void JointInterpolationPlanner::init(const core::RobotModelConstPtr& /*robot_model*/) {}
 
+namespace {
+using Result = PlannerInterface::Result;
+
+// validate interpolated waypoints in sequential or bisection order, adding waypoints up to the first failure (or all)
+// to result. Waypoints are collision-checked in batches of given size via the active BatchCollisionChecker.
+Result validateWaypoints(const planning_scene::PlanningSceneConstPtr& scene, const moveit::core::RobotState& from_state,
+                         const moveit::core::RobotState& to_state, const moveit::core::JointModelGroup* jmg,
+                         double delta, bool bisection, size_t batch_size, robot_trajectory::RobotTrajectory& result) {
+	// waypoints: t_i = i * delta, i = 1..n, plus the goal (i = n+1)
+	std::vector<double> times;
+	for (double t = delta; t < 1.0; t += delta)  // NOLINT(clang-analyzer-security.FloatLoopCounter)
+		times.push_back(t);
+	times.push_back(1.0);
+	const size_t goal = times.size() - 1;
+
+	// fill result with waypoints up to (including) index last
+	auto fill = [&](size_t last) {
+		moveit::core::RobotState waypoint(from_state);
+		for (size_t i = 0; i <= last; ++i) {
+			if (i == goal)
+				result.addSuffixWayPoint(to_state, 1.0);
+			else {
+				from_state.interpolate(to_state, times[i], waypoint);
+				result.addSuffixWayPoint(waypoint, times[i]);
+			}
+		}
+	};
+
+	// validation order: sequential or goal first, then recursively the midpoints of unchecked ranges (breadth-first)
+	std::vector<size_t> order;
+	order.reserve(times.size());
+	if (!bisection) {
+		for (size_t i = 0; i <= goal; ++i)
+			order.push_back(i);
+	} else {
+		order.push_back(goal);
+		std::deque<std::pair<size_t, size_t>> ranges;  // half-open ranges of unchecked indices
+		ranges.emplace_back(0, goal);
+		while (!ranges.empty()) {
+			const auto range = ranges.front();
+			ranges.pop_front();
+			if (range.first >= range.second)
+				continue;
+			const size_t mid = range.first + (range.second - range.first) / 2;
+			order.push_back(mid);
+			ranges.emplace_back(range.first, mid);
+			ranges.emplace_back(mid + 1, range.second);
+		}
+	}
+
+	const BatchCollisionCheckerPtr checker = BatchCollisionChecker::active();
+	batch_size = std::max<size_t>(1, std::min(batch_size, order.size()));
+	std::vector<moveit::core::RobotState> waypoints(batch_size, from_state);
+	BatchCollisionChecker::States states;
+	for (size_t begin = 0; begin < order.size(); begin += batch_size) {
+		const size_t end = std::min(order.size(), begin + batch_size);
+		states.clear();
+		for (size_t k = begin; k < end; ++k) {
+			if (order[k] == goal) {
+				states.push_back(&to_state);
+				continue;
+			}
+			moveit::core::RobotState& waypoint = waypoints[k - begin];
+			from_state.interpolate(to_state, times[order[k]], waypoint);
+			waypoint.update();
+			states.push_back(&waypoint);
+		}
+
+		const std::vector<bool> colliding = checker->checkCollision(*scene, states, jmg->getName());
+		for (size_t k = begin; k < end; ++k) {
+			const size_t i = order[k];
+			Result r{ true, "" };
+			if (colliding[k - begin])
+				r = { false, i == goal ? "Goal state is in collision!" : "Waypoint is in collision!" };
+			else if (!states[k - begin]->satisfiesBounds(jmg))
+				r = { false, i == goal ? "Goal state is out of bounds!" : "Waypoint is out of bounds!" };
+			if (!r) {
+				fill(i);
+				return r;
+			}
+		}
+		if (end < order.size() && PlannerCancellation::cancelled()) {
+			fill(order[end - 1]);
+			return { false, "cancelled" };
+		}
+	}
+	fill(goal);
+	return { true, "" };
+}
+}  // namespace
+
 PlannerInterface::Result JointInterpolationPlanner::plan(const planning_scene::PlanningSceneConstPtr& from,
                                                          const planning_scene::PlanningSceneConstPtr& to,
                                                          const moveit::core::JointModelGroup* jmg, double /*timeout*/,
                                                          robot_trajectory::RobotTrajectoryPtr& result,
                                                          const moveit_msgs::Constraints& /*path_constraints*/) {
+	PlannerTimer timer;
 	const auto& props = properties();
 
 	// Get maximum joint distance
@@ -81,31 +181,13 @@ PlannerInterface::Result JointInterpolationPlanner::plan(const planning_scene::P
 	if (!from_state.satisfiesBounds(jmg))
 		return { false, "Start state is out of bounds!" };
 
-	moveit::core::RobotState waypoint(from_state);
 	double delta = d < 1e-6 ? 1.0 : props.get<double>("max_step") / d;
-	for (double t = delta; t < 1.0; t += delta) {  // NOLINT(clang-analyzer-security.FloatLoopCounter)
-		from_state.interpolate(to_state, t, waypoint);
-		result->addSuffixWayPoint(waypoint, t);
-
-		if (from->isStateColliding(waypoint, jmg->getName()))
-			return { false, "Waypoint is in collision!" };
-
-		if (!waypoint.satisfiesBounds(jmg))
-			return { false, "Waypoint is out of bounds!" };
-	}
-
-	// add goal point
-	result->addSuffixWayPoint(to_state, 1.0);
-	if (from->isStateColliding(to_state, jmg->getName()))
-		return { false, "Goal state is in collision!" };
-
-	if (!to_state.satisfiesBounds(jmg))
-		return { false, "Goal state is out of bounds!" };
+	auto r = validateWaypoints(from, from_state, to_state, jmg, delta, props.get<bool>("bisection"),
+	                           props.get<uint32_t>("collision_batch_size"), *result);
+	if (!r)
+		return r;
 
-	auto timing = props.get<TimeParameterizationPtr>("time_parameterization");
-	if (timing)
-		timing->computeTimeStamps(*result, props.get<double>("max_velocity_scaling_factor"),
-		                          props.get<double>("max_acceleration_scaling_factor"));
+	applyTimeParameterization(result);
 
 	// set max_effort on first and last waypoint (first, because we might reverse the trajectory)
 	const auto& max_effort = properties().get("max_effort");
@@ -128,7 +210,8 @@ PlannerInterface::Result JointInterpolationPlanner::plan(
     const planning_scene::PlanningSceneConstPtr& from, const moveit::core::LinkModel& link,
     const Eigen::Isometry3d& offset, const Eigen::Isometry3d& target, const moveit::core::JointModelGroup* jmg,
     double timeout, robot_trajectory::RobotTrajectoryPtr& result, const moveit_msgs::Constraints& path_constraints) {
-	timeout = std::min(timeout, properties().get<double>("timeout"));
+	PlannerTimer timer;
+	timeout = std::min({ timeout, properties().get<double>("timeout"), PlannerCancellation::remainingTime() });
 	const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double, std::ratio<1>>(timeout);
 
 	auto to{ from->diff() };
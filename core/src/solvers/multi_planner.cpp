@@ -38,29 +38,140 @@
 
 #include <moveit/task_constructor/solvers/multi_planner.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
 
 namespace moveit {
 namespace task_constructor {
 namespace solvers {
 
+bool MultiPlanner::appendIdentity(std::string& buffer) const {
+	if (!PlannerInterface::appendIdentity(buffer))
+		return false;
+	buffer += racing_ ? "racing " + std::to_string(grace_period_) : "sequential";
+	buffer += '\0';
+	for (const auto& p : *this)
+		if (!p->appendIdentity(buffer))
+			return false;
+	return true;
+}
+
 void MultiPlanner::init(const core::RobotModelConstPtr& robot_model) {
 	for (const auto& p : *this)
 		p->init(robot_model);
 }
 
+namespace {
+// state shared between a racing MultiPlanner and its (detached) planner threads
+struct RaceState
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+	struct Result
+	{
+		PlannerInterface::Result result;
+		robot_trajectory::RobotTrajectoryPtr trajectory;
+	};
+	std::vector<Result> results;
+	std::vector<bool> done;
+	size_t num_done = 0;
+	bool succeeded = false;
+	std::atomic<bool> cancelled{ false };
+
+	explicit RaceState(size_t n) : results(n), done(n, false) {}
+};
+}  // namespace
+
+PlannerInterface::Result MultiPlanner::race(const Request& request, double timeout,
+                                            robot_trajectory::RobotTrajectoryPtr& result) {
+	using clock = std::chrono::steady_clock;
+	const auto deadline = clock::now() + std::chrono::duration_cast<clock::duration>(
+	                                         std::chrono::duration<double>(std::min(timeout, 1e6)));
+
+	// planner threads are detached: losers might finish after we returned
+	auto state = std::make_shared<RaceState>(size());
+	for (size_t i = 0; i < size(); ++i) {
+		std::thread([state, i, planner = at(i), request, timeout]() {
+			RaceState::Result r;
+			{
+				PlannerCancellation cancellation(state->cancelled);
+				r.result = request(*planner, timeout, r.trajectory);
+			}
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->results[i] = std::move(r);
+			state->done[i] = true;
+			++state->num_done;
+			state->succeeded |= state->results[i].result.success;
+			state->cv.notify_all();
+		}).detach();
+	}
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	// wait until pred holds or deadline passed, forwarding cancellation of the calling thread to the racers
+	auto wait = [&](clock::time_point until, auto pred) {
+		while (!pred() && clock::now() < until && !PlannerCancellation::cancelled())
+			state->cv.wait_until(lock, std::min(until, clock::now() + std::chrono::milliseconds(10)), pred);
+	};
+	wait(deadline, [&] { return state->succeeded || state->num_done == size(); });
+	if (state->succeeded && grace_period_ > 0.0) {  // wait for more solutions arriving within the grace period
+		const auto grace_deadline = std::min(deadline, clock::now() + std::chrono::duration_cast<clock::duration>(
+		                                                                   std::chrono::duration<double>(grace_period_)));
+		wait(grace_deadline, [&] { return state->num_done == size(); });
+	}
+	state->cancelled = true;
+
+	// choose the shortest trajectory among successful results
+	const RaceState::Result* best = nullptr;
+	for (size_t i = 0; i < size(); ++i) {
+		const auto& r = state->results[i];
+		if (!state->done[i] || !r.result.success)
+			continue;
+		if (!best || (r.trajectory && best->trajectory &&
+		               trajectoryDuration(*r.trajectory) < trajectoryDuration(*best->trajectory)))
+			best = &r;
+	}
+	if (best) {
+		result = best->trajectory;
+		return best->result;
+	}
+	if (state->num_done < size())
+		return { false, "timeout" };
+
+	std::string comment = "No planner specified";
+	if (!state->results.empty())
+		comment = state->results.back().result.message;
+	return { false, comment };
+}
+
 PlannerInterface::Result MultiPlanner::plan(const planning_scene::PlanningSceneConstPtr& from,
                                             const planning_scene::PlanningSceneConstPtr& to,
                                             const moveit::core::JointModelGroup* jmg, double timeout,
                                             robot_trajectory::RobotTrajectoryPtr& result,
                                             const moveit_msgs::Constraints& path_constraints) {
-	double remaining_time = std::min(timeout, properties().get<double>("timeout"));
+	PlannerTimer timer;
+	double remaining_time =
+	    std::min({ timeout, properties().get<double>("timeout"), PlannerCancellation::remainingTime() });
 	auto start_time = std::chrono::steady_clock::now();
 
+	if (racing_ && !empty()) {
+		return race(
+		    [from, to, jmg, path_constraints](PlannerInterface& p, double timeout,
+		                                      robot_trajectory::RobotTrajectoryPtr& result) {
+			    return p.plan(from, to, jmg, timeout, result, path_constraints);
+		    },
+		    remaining_time, result);
+	}
+
 	std::string comment = "No planner specified";
 	for (const auto& p : *this) {
 		if (remaining_time < 0)
 			return { false, "timeout" };
+		if (PlannerCancellation::cancelled())
+			return { false, "cancelled" };
 		if (result)
 			result->clear();
 		auto r = p->plan(from, to, jmg, remaining_time, result, path_constraints);
@@ -81,13 +192,32 @@ PlannerInterface::Result MultiPlanner::plan(const planning_scene::PlanningSceneC
                                             const Eigen::Isometry3d& target, const moveit::core::JointModelGroup* jmg,
                                             double timeout, robot_trajectory::RobotTrajectoryPtr& result,
                                             const moveit_msgs::Constraints& path_constraints) {
-	double remaining_time = std::min(timeout, properties().get<double>("timeout"));
+	PlannerTimer timer;
+	double remaining_time =
+	    std::min({ timeout, properties().get<double>("timeout"), PlannerCancellation::remainingTime() });
 	auto start_time = std::chrono::steady_clock::now();
 
+	if (racing_ && !empty()) {
+		const moveit::core::LinkModel* link_ptr = &link;
+		// capture unaligned copies of Eigen transforms: the closure's storage isn't guaranteed to be aligned
+		using UnalignedIsometry = Eigen::Transform<double, 3, Eigen::Isometry, Eigen::DontAlign>;
+		UnalignedIsometry offset_copy(offset);
+		UnalignedIsometry target_copy(target);
+		return race(
+		    [from, link_ptr, offset_copy, target_copy, jmg, path_constraints](
+		        PlannerInterface& p, double timeout, robot_trajectory::RobotTrajectoryPtr& result) {
+			    return p.plan(from, *link_ptr, Eigen::Isometry3d(offset_copy), Eigen::Isometry3d(target_copy), jmg,
+			                  timeout, result, path_constraints);
+		    },
+		    remaining_time, result);
+	}
+
 	std::string comment = "No planner specified";
 	for (const auto& p : *this) {
 		if (remaining_time < 0)
 			return { false, "timeout" };
+		if (PlannerCancellation::cancelled())
+			return { false, "cancelled" };
 		if (result)
 			result->clear();
 		auto r = p->plan(from, link, offset, target, jmg, remaining_time, result, path_constraints);
@@ -0,0 +1,219 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Library of previously planned paths, reused by PipelinePlanner
+*/
+
+#include <moveit/task_constructor/solvers/path_library.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+#include <ros/serialization.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+namespace moveit {
+namespace task_constructor {
+namespace solvers {
+
+namespace {
+constexpr char MAGIC[8] = { 'M', 'T', 'C', 'P', 'L', 'I', 'B', '\0' };
+constexpr uint32_t VERSION = 1;
+
+template <typename T>
+void append(const T& value, std::string& buffer) {
+	const uint32_t length = ros::serialization::serializationLength(value);
+	const size_t offset = buffer.size();
+	buffer.resize(offset + length);
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[offset]), length);
+	ros::serialization::serialize(stream, value);
+}
+
+void hashCombine(std::size_t& seed, std::size_t value) {
+	seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+}  // namespace
+
+PathLibrary::Key PathLibrary::key(const std::string& group, const std::vector<double>& start,
+                                  const std::vector<double>& goal) const {
+	Key seed = std::hash<std::string>()(group);
+	for (const std::vector<double>* positions : { &start, &goal })
+		for (double value : *positions)
+			hashCombine(seed, std::hash<long>()(std::lround(value / resolution_)));
+	return seed;
+}
+
+robot_trajectory::RobotTrajectoryPtr PathLibrary::retrieve(const planning_scene::PlanningSceneConstPtr& scene,
+                                                           const moveit::core::RobotState& from,
+                                                           const moveit::core::RobotState& to,
+                                                           const moveit::core::JointModelGroup* jmg,
+                                                           double max_step) const {
+	std::vector<double> start, goal;
+	from.copyJointGroupPositions(jmg, start);
+	to.copyJointGroupPositions(jmg, goal);
+
+	// find stored path in either direction
+	trajectory_msgs::JointTrajectory path;
+	bool reversed = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = paths_.find(key(jmg->getName(), start, goal));
+		if (it == paths_.end() || it->second.first != jmg->getName()) {
+			it = paths_.find(key(jmg->getName(), goal, start));
+			reversed = true;
+		}
+		if (it == paths_.end() || it->second.first != jmg->getName())
+			return nullptr;
+		path = it->second.second;
+	}
+	if (path.joint_names != jmg->getVariableNames() || path.points.size() < 2)
+		return nullptr;  // group was modified since storing the path
+	if (reversed)
+		std::reverse(path.points.begin(), path.points.end());
+
+	// repair: connect the actual start and goal states instead of the stored ones
+	path.points.front().positions = start;
+	path.points.back().positions = goal;
+
+	// validate densely interpolated waypoints
+	auto result = std::make_shared<robot_trajectory::RobotTrajectory>(scene->getRobotModel(), jmg);
+	result->addSuffixWayPoint(from, 0.0);
+	moveit::core::RobotState prev(from), next(from), waypoint(from);
+	for (size_t i = 1; i < path.points.size(); ++i) {
+		if (i + 1 == path.points.size())
+			next = to;
+		else {
+			next.setJointGroupPositions(jmg, path.points[i].positions);
+			next.update();
+		}
+		const size_t steps = std::max<size_t>(1, std::ceil(prev.distance(next, jmg) / max_step));
+		for (size_t s = 1; s <= steps; ++s) {
+			prev.interpolate(next, static_cast<double>(s) / steps, waypoint, jmg);
+			waypoint.update();
+			if (!waypoint.satisfiesBounds(jmg) || !scene->isStateValid(waypoint, jmg->getName()))
+				return nullptr;
+		}
+		result->addSuffixWayPoint(next, 0.0);
+		prev = next;
+	}
+	return result;
+}
+
+void PathLibrary::store(const robot_trajectory::RobotTrajectory& trajectory) {
+	const moveit::core::JointModelGroup* jmg = trajectory.getGroup();
+	if (!jmg || trajectory.getWayPointCount() < 2)
+		return;
+
+	trajectory_msgs::JointTrajectory path;
+	path.joint_names = jmg->getVariableNames();
+	path.points.resize(trajectory.getWayPointCount());
+	for (size_t i = 0; i < path.points.size(); ++i)
+		trajectory.getWayPoint(i).copyJointGroupPositions(jmg, path.points[i].positions);
+	insert(jmg->getName(), std::move(path));
+}
+
+void PathLibrary::insert(const std::string& group, trajectory_msgs::JointTrajectory&& path) {
+	const Key k = key(group, path.points.front().positions, path.points.back().positions);
+	std::lock_guard<std::mutex> lock(mutex_);
+	paths_[k] = std::make_pair(group, std::move(path));
+}
+
+size_t PathLibrary::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return paths_.size();
+}
+
+void PathLibrary::clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	paths_.clear();
+}
+
+void PathLibrary::save(const std::string& path) const {
+	std::string buffer(MAGIC, sizeof(MAGIC));
+	append(VERSION, buffer);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		append(static_cast<uint64_t>(paths_.size()), buffer);
+		for (const auto& entry : paths_) {
+			append(entry.second.first, buffer);
+			append(entry.second.second, buffer);
+		}
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.write(buffer.data(), buffer.size()))
+		throw std::runtime_error("failed to write path library " + path);
+}
+
+void PathLibrary::load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		throw std::runtime_error("failed to open path library " + path);
+	std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (buffer.size() < sizeof(MAGIC) || std::memcmp(buffer.data(), MAGIC, sizeof(MAGIC)) != 0)
+		throw std::runtime_error("not a path library: " + path);
+
+	std::vector<std::pair<std::string, trajectory_msgs::JointTrajectory>> entries;
+	try {
+		ros::serialization::IStream stream(buffer.data() + sizeof(MAGIC), buffer.size() - sizeof(MAGIC));
+		uint32_t version;
+		ros::serialization::deserialize(stream, version);
+		if (version != VERSION)
+			throw std::runtime_error("unsupported path library version " + std::to_string(version) + ": " + path);
+		uint64_t count;
+		ros::serialization::deserialize(stream, count);
+		for (uint64_t i = 0; i < count; ++i) {
+			std::pair<std::string, trajectory_msgs::JointTrajectory> entry;
+			ros::serialization::deserialize(stream, entry.first);
+			ros::serialization::deserialize(stream, entry.second);
+			entries.push_back(std::move(entry));
+		}
+	} catch (const ros::Exception& e) {
+		throw std::runtime_error("corrupt path library " + path + ": " + e.what());
+	}
+
+	clear();
+	// keys are recomputed, as they depend on the resolution
+	for (auto& entry : entries)
+		if (entry.second.points.size() >= 2)
+			insert(entry.first, std::move(entry.second));
+}
+}  // namespace solvers
+}  // namespace task_constructor
+}  // namespace moveit
@@ -44,20 +44,67 @@
 #include <moveit/kinematic_constraints/utils.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace moveit {
 namespace task_constructor {
 namespace solvers {
 
+namespace {
+// terminate the pipeline's running request as soon as the calling thread's planning gets cancelled
+class TerminateOnCancel
+{
+public:
+	explicit TerminateOnCancel(const planning_pipeline::PlanningPipeline& pipeline) {
+		const PlannerCancellation* cancellation = PlannerCancellation::current();
+		if (!cancellation)
+			return;
+		watcher_ = std::thread([this, &pipeline, cancellation] {
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (!done_) {
+				if (cancellation->isCancelled()) {
+					pipeline.terminate();
+					return;
+				}
+				cond_.wait_for(lock, std::chrono::milliseconds(10));
+			}
+		});
+	}
+	~TerminateOnCancel() {
+		if (!watcher_.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			done_ = true;
+		}
+		cond_.notify_all();
+		watcher_.join();
+	}
+
+private:
+	std::thread watcher_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	bool done_ = false;
+};
+}  // namespace
+
+template <typename T>
 struct PlannerCache
 {
 	using PlannerID = std::tuple<std::string, std::string>;
-	using PlannerMap = std::map<PlannerID, std::weak_ptr<planning_pipeline::PlanningPipeline> >;
+	using PlannerMap = std::map<PlannerID, std::weak_ptr<T> >;
 	using ModelList = std::list<std::pair<std::weak_ptr<const moveit::core::RobotModel>, PlannerMap> >;
 	ModelList cache_;
+	std::mutex mutex_;
 
-	PlannerMap::mapped_type& retrieve(const moveit::core::RobotModelConstPtr& model, const PlannerID& id) {
+	typename PlannerMap::mapped_type& retrieve(const moveit::core::RobotModelConstPtr& model, const PlannerID& id) {
 		// find model in cache_ and remove expired entries while doing so
-		ModelList::iterator model_it = cache_.begin();
+		typename ModelList::iterator model_it = cache_.begin();
 		while (model_it != cache_.end()) {
 			if (model_it->first.expired()) {
 				model_it = cache_.erase(model_it);
@@ -70,15 +117,14 @@ struct PlannerCache
 		if (model_it == cache_.end())  // if not found, create a new PlannerMap for this model
 			model_it = cache_.insert(cache_.begin(), std::make_pair(model, PlannerMap()));
 
-		return model_it->second.insert(std::make_pair(id, PlannerMap::mapped_type())).first->second;
+		return model_it->second.insert(std::make_pair(id, typename PlannerMap::mapped_type())).first->second;
 	}
 };
 
-planning_pipeline::PlanningPipelinePtr PipelinePlanner::create(const PipelinePlanner::Specification& spec) {
-	static PlannerCache cache;
-
-	static constexpr char const* PLUGIN_PARAMETER_NAME = "planning_plugin";
+namespace {
+constexpr char const* PLUGIN_PARAMETER_NAME = "planning_plugin";
 
+std::string pipelineNamespace(const PipelinePlanner::Specification& spec) {
 	std::string pipeline_ns = spec.ns + "/planning_pipelines/" + spec.pipeline;
 	// fallback to old structure for pipeline parameters in MoveIt
 	if (!ros::NodeHandle(pipeline_ns).hasParam(PLUGIN_PARAMETER_NAME)) {
@@ -86,21 +132,134 @@ planning_pipeline::PlanningPipelinePtr PipelinePlanner::create(const PipelinePla
 		         "Attempting to load pipeline from old parameter structure. Please update your MoveIt config.");
 		pipeline_ns = spec.ns;
 	}
+	return pipeline_ns;
+}
+
+// serialize creation of pipelines: plugin loading isn't thread-safe
+std::mutex& creationMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
 
-	PlannerCache::PlannerID id(pipeline_ns, spec.adapter_param);
+planning_pipeline::PlanningPipelinePtr createPipeline(const PipelinePlanner::Specification& spec,
+                                                      const std::string& pipeline_ns) {
+	std::lock_guard<std::mutex> lock(creationMutex());
+	return std::make_shared<planning_pipeline::PlanningPipeline>(spec.model, ros::NodeHandle(pipeline_ns),
+	                                                             PLUGIN_PARAMETER_NAME, spec.adapter_param);
+}
+}  // namespace
+
+planning_pipeline::PlanningPipelinePtr PipelinePlanner::create(const PipelinePlanner::Specification& spec) {
+	static PlannerCache<planning_pipeline::PlanningPipeline> cache;
+
+	std::string pipeline_ns = pipelineNamespace(spec);
+	PlannerCache<planning_pipeline::PlanningPipeline>::PlannerID id(pipeline_ns, spec.adapter_param);
 
+	std::lock_guard<std::mutex> lock(cache.mutex_);
 	std::weak_ptr<planning_pipeline::PlanningPipeline>& entry = cache.retrieve(spec.model, id);
 	planning_pipeline::PlanningPipelinePtr planner = entry.lock();
 	if (!planner) {
 		// create new entry
-		planner = std::make_shared<planning_pipeline::PlanningPipeline>(spec.model, ros::NodeHandle(pipeline_ns),
-		                                                                PLUGIN_PARAMETER_NAME, spec.adapter_param);
+		planner = createPipeline(spec, pipeline_ns);
 		// store in cache
 		entry = planner;
 	}
 	return planner;
 }
 
+PipelinePlanner::PoolPtr PipelinePlanner::createPool(const Specification& spec) {
+	static PlannerCache<Pool> cache;
+
+	PlannerCache<Pool>::PlannerID id(pipelineNamespace(spec), spec.adapter_param);
+
+	std::lock_guard<std::mutex> lock(cache.mutex_);
+	std::weak_ptr<Pool>& entry = cache.retrieve(spec.model, id);
+	PoolPtr pool = entry.lock();
+	if (!pool) {
+		pool = std::make_shared<Pool>(spec);
+		entry = pool;
+	}
+	return pool;
+}
+
+PipelinePlanner::Pool::Pool(const Specification& spec) : spec_(spec), model_(spec.model) {}
+
+PipelinePlanner::Pool::Pool(const planning_pipeline::PlanningPipelinePtr& pipeline)
+  : model_(pipeline->getRobotModel()), fixed_(true) {
+	instances_.push_back(pipeline);
+	idle_.push_back(pipeline.get());
+}
+
+PipelinePlanner::Pool::Lease PipelinePlanner::Pool::acquire() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_.wait(lock, [this] { return !idle_.empty() || (!fixed_ && instances_.size() + creating_ < max_size_); });
+
+	planning_pipeline::PlanningPipeline* pipeline;
+	if (!idle_.empty()) {
+		pipeline = idle_.back();
+		idle_.pop_back();
+	} else {  // lazily create a new instance
+		// the first instance is shared with create()
+		const bool first = instances_.empty() && creating_ == 0;
+		++creating_;
+		lock.unlock();
+
+		planning_pipeline::PlanningPipelinePtr instance;
+		try {
+			instance = first ? PipelinePlanner::create(spec_) : createPipeline(spec_, pipelineNamespace(spec_));
+		} catch (...) {
+			lock.lock();
+			--creating_;
+			cv_.notify_one();
+			throw;
+		}
+
+		lock.lock();
+		--creating_;
+		instance->displayComputedMotionPlans(display_motion_plans_);
+		instance->publishReceivedRequests(publish_planning_requests_);
+		instances_.push_back(instance);
+		pipeline = instance.get();
+	}
+	return Lease(pipeline, [self = shared_from_this()](planning_pipeline::PlanningPipeline* p) { self->release(p); });
+}
+
+void PipelinePlanner::Pool::release(planning_pipeline::PlanningPipeline* pipeline) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		idle_.push_back(pipeline);
+	}
+	cv_.notify_one();
+}
+
+void PipelinePlanner::Pool::reserve(size_t max_size) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		max_size_ = std::max(max_size_, max_size);
+	}
+	cv_.notify_all();
+}
+
+size_t PipelinePlanner::Pool::maxSize() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return fixed_ ? instances_.size() : max_size_;
+}
+
+size_t PipelinePlanner::Pool::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return instances_.size();
+}
+
+void PipelinePlanner::Pool::setPublishing(bool display_motion_plans, bool publish_planning_requests) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	display_motion_plans_ = display_motion_plans;
+	publish_planning_requests_ = publish_planning_requests;
+	for (const auto& instance : instances_) {
+		instance->displayComputedMotionPlans(display_motion_plans);
+		instance->publishReceivedRequests(publish_planning_requests);
+	}
+}
+
 PipelinePlanner::PipelinePlanner(const std::string& pipeline_name) : pipeline_name_{ pipeline_name } {
 	auto& p = properties();
 	p.declare<std::string>("planner", "", "planner id");
@@ -118,32 +277,49 @@ PipelinePlanner::PipelinePlanner(const std::string& pipeline_name) : pipeline_na
 	p.declare<bool>("publish_planning_requests", false,
 	                "publish motion planning requests on topic " +
 	                    planning_pipeline::PlanningPipeline::MOTION_PLAN_REQUEST_TOPIC);
+	p.declare<uint>("max_pipelines", 1u,
+	                "max number of pipeline instances (created on demand) serving concurrent planning requests");
 }
 
 PipelinePlanner::PipelinePlanner(const planning_pipeline::PlanningPipelinePtr& planning_pipeline) : PipelinePlanner() {
 	planner_ = planning_pipeline;
 }
 
+bool PipelinePlanner::appendIdentity(std::string& buffer) const {
+	if (!PlannerInterface::appendIdentity(buffer))
+		return false;
+	// a custom pipeline is identified by its planner plugin
+	buffer += planner_ ? planner_->getPlannerPluginName() : pipeline_name_;
+	buffer += '\0';
+	return true;
+}
+
 void PipelinePlanner::init(const core::RobotModelConstPtr& robot_model) {
-	if (!planner_) {
-		Specification spec;
-		spec.model = robot_model;
-		spec.pipeline = pipeline_name_;
-		planner_ = create(spec);
-	} else if (robot_model != planner_->getRobotModel()) {
+	if (!pool_) {
+		if (planner_)  // custom pipeline cannot be replicated
+			pool_ = std::make_shared<Pool>(planner_);
+		else {
+			Specification spec;
+			spec.model = robot_model;
+			spec.pipeline = pipeline_name_;
+			pool_ = createPool(spec);
+		}
+	}
+	if (robot_model != pool_->getRobotModel()) {
 		throw std::runtime_error(
 		    "The robot model of the planning pipeline isn't the same as the task's robot model -- "
 		    "use Task::setRobotModel for setting the robot model when using custom planning pipeline");
 	}
-	planner_->displayComputedMotionPlans(properties().get<bool>("display_motion_plans"));
-	planner_->publishReceivedRequests(properties().get<bool>("publish_planning_requests"));
+	const auto& props = properties();
+	pool_->reserve(props.get<uint>("max_pipelines"));
+	pool_->setPublishing(props.get<bool>("display_motion_plans"), props.get<bool>("publish_planning_requests"));
 }
 
 void initMotionPlanRequest(moveit_msgs::MotionPlanRequest& req, const PropertyMap& p,
                            const moveit::core::JointModelGroup* jmg, double timeout) {
 	req.group_name = jmg->getName();
 	req.planner_id = p.get<std::string>("planner");
-	req.allowed_planning_time = std::min(timeout, p.get<double>("timeout"));
+	req.allowed_planning_time = std::min({ timeout, p.get<double>("timeout"), PlannerCancellation::remainingTime() });
 	req.start_state.is_diff = true;  // we don't specify an extra start state
 
 	req.num_planning_attempts = p.get<uint>("num_planning_attempts");
@@ -158,6 +334,16 @@ PlannerInterface::Result PipelinePlanner::plan(const planning_scene::PlanningSce
                                                robot_trajectory::RobotTrajectoryPtr& result,
                                                const moveit_msgs::Constraints& path_constraints) {
 	const auto& props = properties();
+	if (path_library_ && path_constraints.joint_constraints.empty() && path_constraints.position_constraints.empty() &&
+	    path_constraints.orientation_constraints.empty() && path_constraints.visibility_constraints.empty()) {
+		PlannerTimer timer;
+		result = path_library_->retrieve(from, from->getCurrentState(), to->getCurrentState(), jmg);
+		if (result) {
+			applyTimeParameterization(result);
+			return { true, "" };
+		}
+	}
+
 	moveit_msgs::MotionPlanRequest req;
 	initMotionPlanRequest(req, props, jmg, timeout);
 
@@ -195,9 +381,18 @@ PlannerInterface::Result PipelinePlanner::plan(const planning_scene::PlanningSce
 PlannerInterface::Result PipelinePlanner::plan(const planning_scene::PlanningSceneConstPtr& from,
                                                const moveit_msgs::MotionPlanRequest& req,
                                                robot_trajectory::RobotTrajectoryPtr& result) {
+	PlannerTimer timer;
 	::planning_interface::MotionPlanResponse res;
-	bool success = planner_->generatePlan(from, req, res);
+	// check out a pipeline instance exclusively used by this request
+	Pool::Lease pipeline = pool_->acquire();
+	bool success;
+	{
+		TerminateOnCancel terminate(*pipeline);
+		success = pipeline->generatePlan(from, req, res);
+	}
 	result = res.trajectory_;
+	if (success && path_library_ && result)
+		path_library_->store(*result);
 	return { success, success ? std::string() : static_cast<std::string>(res.error_code_) };
 }
 
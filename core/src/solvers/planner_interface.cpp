@@ -38,6 +38,15 @@
 
 #include <moveit/task_constructor/solvers/planner_interface.h>
 #include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <boost/core/demangle.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <limits>
+#include <typeinfo>
+#include <unordered_map>
 
 using namespace trajectory_processing;
 
@@ -45,12 +54,226 @@ namespace moveit {
 namespace task_constructor {
 namespace solvers {
 
+namespace {
+thread_local unsigned int planner_timer_depth = 0;
+thread_local std::chrono::steady_clock::time_point planner_timer_start;
+thread_local std::chrono::duration<double> planner_time{};
+thread_local const PlannerCancellation* planner_cancellation = nullptr;
+
+// path-only trajectories waiting for their time parameterization
+class DeferredTiming
+{
+	struct Entry
+	{
+		std::weak_ptr<robot_trajectory::RobotTrajectory> trajectory;
+		TimeParameterizationPtr timing;
+		double velocity_scaling;
+		double acceleration_scaling;
+		robot_trajectory::RobotTrajectoryConstPtr timed;  // time-parameterized copy, once finalized
+	};
+	std::mutex mutex_;
+	std::unordered_map<const robot_trajectory::RobotTrajectory*, Entry> entries_;
+	size_t purge_size_ = 64;
+
+	// find entry of a still existing trajectory (addresses might be reused after destruction)
+	std::unordered_map<const robot_trajectory::RobotTrajectory*, Entry>::iterator
+	find(const robot_trajectory::RobotTrajectory& trajectory) {
+		auto it = entries_.find(&trajectory);
+		if (it != entries_.end() && it->second.trajectory.lock().get() != &trajectory) {
+			entries_.erase(it);
+			return entries_.end();
+		}
+		return it;
+	}
+
+public:
+	static DeferredTiming& instance() {
+		static DeferredTiming registry;
+		return registry;
+	}
+
+	void add(const robot_trajectory::RobotTrajectoryPtr& trajectory, const TimeParameterizationPtr& timing,
+	         double velocity_scaling, double acceleration_scaling) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (entries_.size() >= purge_size_) {  // drop entries of destroyed (e.g. pruned) trajectories
+			for (auto it = entries_.begin(); it != entries_.end();)
+				it = it->second.trajectory.expired() ? entries_.erase(it) : std::next(it);
+			purge_size_ = std::max<size_t>(64, 2 * entries_.size());
+		}
+		entries_[trajectory.get()] = Entry{ trajectory, timing, velocity_scaling, acceleration_scaling };
+	}
+
+	// time-parameterized copy of a pending trajectory, computed once (nullptr if not pending)
+	robot_trajectory::RobotTrajectoryConstPtr finalize(const robot_trajectory::RobotTrajectory& trajectory) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		auto it = find(trajectory);
+		if (it == entries_.end())
+			return nullptr;
+		if (it->second.timed)
+			return it->second.timed;
+		const Entry entry = it->second;
+		lock.unlock();
+
+		// the trajectory might be read concurrently: time a deep copy (waypoints receive velocities) instead
+		auto timed = std::make_shared<robot_trajectory::RobotTrajectory>(trajectory, true);
+		entry.timing->computeTimeStamps(*timed, entry.velocity_scaling, entry.acceleration_scaling);
+
+		lock.lock();
+		it = find(trajectory);
+		if (it == entries_.end())
+			return timed;
+		if (!it->second.timed)  // the first of concurrent calls wins
+			it->second.timed = timed;
+		return it->second.timed;
+	}
+
+	// velocity scaling of pending trajectory (0 if not pending) and its timed copy, if finalized already
+	double pendingVelocityScaling(const robot_trajectory::RobotTrajectory& trajectory,
+	                              robot_trajectory::RobotTrajectoryConstPtr& timed) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = find(trajectory);
+		if (it == entries_.end())
+			return 0.0;
+		timed = it->second.timed;
+		return it->second.velocity_scaling;
+	}
+};
+}  // namespace
+
+robot_trajectory::RobotTrajectoryConstPtr
+finalizeTimeParameterization(const robot_trajectory::RobotTrajectory& trajectory) {
+	return DeferredTiming::instance().finalize(trajectory);
+}
+
+double trajectoryDuration(const robot_trajectory::RobotTrajectory& trajectory) {
+	robot_trajectory::RobotTrajectoryConstPtr timed;
+	const double velocity_scaling = DeferredTiming::instance().pendingVelocityScaling(trajectory, timed);
+	if (timed)
+		return timed->getDuration();
+	if (velocity_scaling <= 0.0)
+		return trajectory.getDuration();
+
+	// lower bound: each segment takes at least as long as its slowest joint at max velocity
+	const moveit::core::JointModelGroup* jmg = trajectory.getGroup();
+	const auto& joints = jmg ? jmg->getActiveJointModels() : trajectory.getRobotModel()->getActiveJointModels();
+	double duration = 0.0;
+	for (size_t i = 1; i < trajectory.getWayPointCount(); ++i) {
+		const moveit::core::RobotState& prev = trajectory.getWayPoint(i - 1);
+		const moveit::core::RobotState& next = trajectory.getWayPoint(i);
+		double segment = 0.0;
+		for (const moveit::core::JointModel* jm : joints) {
+			const double* p = prev.getJointPositions(jm);
+			const double* n = next.getJointPositions(jm);
+			const auto& bounds = jm->getVariableBounds();
+			for (size_t v = 0; v < bounds.size(); ++v) {
+				if (!bounds[v].velocity_bounded_ || bounds[v].max_velocity_ <= 0.0)
+					continue;
+				segment =
+				    std::max(segment, std::abs(n[v] - p[v]) / (bounds[v].max_velocity_ * velocity_scaling));
+			}
+		}
+		duration += segment;
+	}
+	return duration;
+}
+
+PlannerTimer::PlannerTimer() : trace_("plan", "planner") {
+	if (planner_timer_depth++ == 0)
+		planner_timer_start = std::chrono::steady_clock::now();
+}
+
+PlannerTimer::~PlannerTimer() {
+	if (--planner_timer_depth == 0)
+		planner_time += std::chrono::steady_clock::now() - planner_timer_start;
+}
+
+double PlannerTimer::elapsed() {
+	return planner_time.count();
+}
+
+PlannerCancellation::PlannerCancellation(const std::atomic<bool>* flag, Clock::time_point deadline)
+  : flag_(flag), deadline_(deadline), enclosing_(planner_cancellation), previous_(planner_cancellation) {
+	planner_cancellation = this;
+}
+
+PlannerCancellation::PlannerCancellation(const PlannerCancellation* enclosing)
+  : flag_(nullptr), deadline_(Clock::time_point::max()), enclosing_(enclosing), previous_(planner_cancellation) {
+	planner_cancellation = this;
+}
+
+PlannerCancellation::~PlannerCancellation() {
+	planner_cancellation = previous_;
+}
+
+const PlannerCancellation* PlannerCancellation::current() {
+	return planner_cancellation;
+}
+
+bool PlannerCancellation::cancelled() {
+	return planner_cancellation && planner_cancellation->isCancelled();
+}
+
+bool PlannerCancellation::isCancelled() const {
+	for (const PlannerCancellation* c = this; c; c = c->enclosing_) {
+		if (c->flag_ && c->flag_->load(std::memory_order_relaxed))
+			return true;
+		if (c->deadline_ != Clock::time_point::max() && Clock::now() >= c->deadline_)
+			return true;
+	}
+	return false;
+}
+
+double PlannerCancellation::remainingTime() {
+	auto deadline = Clock::time_point::max();
+	for (const PlannerCancellation* c = planner_cancellation; c; c = c->enclosing_)
+		deadline = std::min(deadline, c->deadline_);
+	if (deadline == Clock::time_point::max())
+		return std::numeric_limits<double>::infinity();
+	return std::max(0.0, std::chrono::duration<double>(deadline - Clock::now()).count());
+}
+
 PlannerInterface::PlannerInterface() {
 	auto& p = properties();
 	p.declare<double>("timeout", std::numeric_limits<double>::infinity(), "timeout for planner (s)");
 	p.declare<double>("max_velocity_scaling_factor", 1.0, "scale down max velocity by this factor");
 	p.declare<double>("max_acceleration_scaling_factor", 1.0, "scale down max acceleration by this factor");
 	p.declare<TimeParameterizationPtr>("time_parameterization", std::make_shared<TimeOptimalTrajectoryGeneration>());
+	p.declare<bool>("defer_time_parameterization", false,
+	                "keep trajectories path-only until their solution is published or executed");
+}
+
+void PlannerInterface::applyTimeParameterization(const robot_trajectory::RobotTrajectoryPtr& trajectory) const {
+	const auto& props = properties();
+	auto timing = props.get<TimeParameterizationPtr>("time_parameterization");
+	if (!timing || !trajectory)
+		return;
+	const double velocity_scaling = props.get<double>("max_velocity_scaling_factor");
+	const double acceleration_scaling = props.get<double>("max_acceleration_scaling_factor");
+	if (props.get<bool>("defer_time_parameterization"))
+		DeferredTiming::instance().add(trajectory, timing, velocity_scaling, acceleration_scaling);
+	else
+		timing->computeTimeStamps(*trajectory, velocity_scaling, acceleration_scaling);
+}
+
+bool PlannerInterface::appendIdentity(std::string& buffer) const {
+	buffer += boost::core::demangle(typeid(*this).name());
+	buffer += '\0';
+	for (const auto& pair : properties_) {
+		const boost::any& value = pair.second.value();
+		buffer += pair.first;
+		buffer += '\0';
+		if (value.type() == typeid(TimeParameterizationPtr)) {  // identified by its type, not its address
+			if (const auto& timing = boost::any_cast<const TimeParameterizationPtr&>(value))
+				buffer += boost::core::demangle(typeid(*timing).name());
+		} else {
+			const std::string serialized = Property::serialize(value);
+			if (!value.empty() && serialized.empty())
+				return false;
+			buffer += serialized;
+		}
+		buffer += '\0';
+	}
+	return true;
 }
 }  // namespace solvers
 }  // namespace task_constructor
@@ -37,16 +37,29 @@
 
 #include <moveit/task_constructor/stage_p.h>
 #include <moveit/task_constructor/container_p.h>
+#include <moveit/task_constructor/cost_terms.h>
 #include <moveit/task_constructor/introspection.h>
+#include <moveit/task_constructor/solution_cache.h>
+#include <moveit/task_constructor/plan_recording.h>
+#include <moveit/task_constructor/thread_pool.h>
 #include <moveit/task_constructor/fmt_p.h>
 
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <geometric_shapes/shapes.h>
 
 #include <ros/console.h>
+#include <ros/serialization.h>
 
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <exception>
+#include <cmath>
+#include <boost/functional/hash.hpp>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 namespace moveit {
@@ -96,14 +109,102 @@ std::ostream& operator<<(std::ostream& os, const InitStageException& e) {
 	return os;
 }
 
+void ComputeTimeStatistics::add(double duration, double planner_time) {
+	++count_;
+	min_ = std::min(min_, duration);
+	max_ = std::max(max_, duration);
+	sum_ += duration;
+	planner_time_ += planner_time;
+
+	const double us = duration * 1e6;
+	std::size_t bin = us < 2.0 ? 0 : static_cast<std::size_t>(std::log2(us));
+	++histogram_[std::min(bin, NUM_BINS - 1)];
+}
+
+double ComputeTimeStatistics::quantile(double q) const {
+	if (count_ == 0)
+		return 0.0;
+	const double rank = std::max(0.0, std::min(1.0, q)) * count_;
+	double cumulative = 0.0;
+	for (std::size_t bin = 0; bin < NUM_BINS; ++bin) {
+		if (histogram_[bin] == 0)
+			continue;
+		const double next = cumulative + histogram_[bin];
+		if (next >= rank) {
+			// interpolate geometrically within the bin's range, clamped to observed extrema
+			const double fraction = (rank - cumulative) / histogram_[bin];
+			const double lower = bin == 0 ? 0.0 : std::ldexp(1e-6, bin);
+			const double upper = std::ldexp(1e-6, bin + 1);
+			const double estimate = bin == 0 ? fraction * upper : lower * std::pow(upper / lower, fraction);
+			return std::max(min(), std::min(max_, estimate));
+		}
+		cumulative = next;
+	}
+	return max_;
+}
+
+namespace {
+struct DeferredPriorities
+{
+	size_t depth = 0;  // number of active scopes
+	std::vector<std::pair<const InterfaceState*, InterfaceState::Priority>> updates;  // in order of first update
+	std::unordered_map<const InterfaceState*, size_t> index;  // index into updates
+};
+thread_local DeferredPriorities DEFERRED_PRIORITIES;
+}  // namespace
+
+PriorityUpdateScope::PriorityUpdateScope(std::recursive_mutex* mutex) : mutex_(mutex) {
+	++DEFERRED_PRIORITIES.depth;
+}
+
+PriorityUpdateScope::~PriorityUpdateScope() {
+	DeferredPriorities& deferred = DEFERRED_PRIORITIES;
+	if (--deferred.depth > 0 || deferred.updates.empty())
+		return;
+
+	auto updates = std::move(deferred.updates);
+	deferred.updates.clear();
+	deferred.index.clear();
+	auto lock = mutex_ ? std::unique_lock<std::recursive_mutex>(*mutex_) : std::unique_lock<std::recursive_mutex>();
+	for (const auto& update : updates)  // notified listeners update immediately now
+		PriorityUpdateScope::update(*update.first, update.second);
+}
+
+void PriorityUpdateScope::update(const InterfaceState& state, const InterfaceState::Priority& priority) {
+	DeferredPriorities& deferred = DEFERRED_PRIORITIES;
+	if (deferred.depth == 0) {
+		const InterfaceState::Priority updated(priority, state.priority().status());
+		if (state.priority() != updated)
+			const_cast<InterfaceState&>(state).updatePriority(updated);
+		return;
+	}
+	auto inserted = deferred.index.emplace(&state, deferred.updates.size());
+	if (inserted.second)
+		deferred.updates.emplace_back(&state, priority);
+	else
+		deferred.updates[inserted.first->second].second = priority;
+}
+
+InterfaceState::Priority PriorityUpdateScope::priority(const InterfaceState& state) {
+	const DeferredPriorities& deferred = DEFERRED_PRIORITIES;
+	auto it = deferred.index.find(&state);
+	if (it == deferred.index.end())
+		return state.priority();
+	return InterfaceState::Priority(deferred.updates[it->second].second, state.priority().status());
+}
+
 StagePrivate::StagePrivate(Stage* me, const std::string& name)
   : me_{ me }
   , name_{ name }
   , cost_term_{ std::make_unique<CostTerm>() }
   , total_compute_time_{}
+  , states_{ ArenaAllocator<InterfaceState>(&states_arena_) }
   , parent_{ nullptr }
   , introspection_{ nullptr }
-  , preempt_requested_{ nullptr } {}
+  , preempt_requested_{ nullptr }
+  , planning_deadline_{ nullptr }
+  , thread_pool_{ nullptr }
+  , planning_mutex_{ nullptr } {}
 
 StagePrivate& StagePrivate::operator=(StagePrivate&& other) {
 	assert(typeid(*this) == typeid(other));
@@ -156,97 +257,413 @@ void StagePrivate::validateConnectivity() const {
 		                                     flowSymbol<START_IF_MASK>(required), flowSymbol<END_IF_MASK>(required)));
 }
 
+namespace {
+// number of markers kept for compact failures
+constexpr size_t MAX_COMPACT_FAILURE_MARKERS = 16;
+constexpr char const* NEAR_DUPLICATE_SOLUTION = "near-duplicate of a better solution";
+
+// reduce a failure to its creator, states, cost, comment, and a few (eagerly generated) markers
+void compactFailure(SolutionBase& solution) {
+	if (auto* sub = dynamic_cast<SubTrajectory*>(&solution))
+		sub->setTrajectory(nullptr);
+	solution.clearMarkerGenerators();
+	auto& markers = solution.markers();
+	if (markers.size() > MAX_COMPACT_FAILURE_MARKERS)
+		markers.resize(MAX_COMPACT_FAILURE_MARKERS);
+}
+}  // namespace
+
 bool StagePrivate::storeSolution(const SolutionBasePtr& solution, const InterfaceState* from,
                                  const InterfaceState* to) {
 	solution->setCreator(me());
-	if (introspection_)
+	if (diversity_tolerance_ > 0.0 && !solution->isFailure() && to && to->scene() && isNearDuplicate(*solution, *to))
+		solution->markAsFailure(NEAR_DUPLICATE_SOLUTION);
+
+	const uint32_t max_solutions = properties_.get<uint32_t>("max_stored_solutions");
+	if (max_solutions > 0 && !solution->isFailure() && solutions_.size() >= max_solutions &&
+	    !(*solution < *solutions_.back())) {
+		++num_evicted_;
+		return false;  // drop solution not improving on the stored ones
+	}
+	const bool store = !solution->isFailure() ||
+	                   (storeFailures() && (max_stored_failures_ == 0 || failures_.size() < max_stored_failures_));
+	if (introspection_ && store)
 		introspection_->registerSolution(*solution);
+	logEvent(solution->isFailure() ? EventLog::FAILURE : EventLog::SOLUTION,
+	         event_log_ && introspection_ && store ? introspection_->solutionId(*solution) : 0, solution->cost());
 
 	if (solution->isFailure()) {
-		++num_failures_;
+		countFailure(solution->commentSummary());  // don't generate details of dropped failures
 		if (parent())
 			parent()->pimpl()->onNewFailure(*me(), from, to);
-		if (!storeFailures())
+		if (!store)
 			return false;  // drop solution
+		if (compact_failures_)
+			compactFailure(*solution);
 		failures_.push_back(solution);
 	} else {
-		solutions_.insert(solution);
+		solution_handles_[solution.get()] = solutions_.insert(solution);
+		if (max_solutions > 0)
+			evictSolutions(max_solutions);
+		publishSnapshot();
 	}
 	return true;
 }
 
+void StagePrivate::logState(const InterfaceState& state, Interface::Direction dir, const SolutionBase& solution) {
+	if (!event_log_)
+		return;
+	const InterfaceState::Priority& prio = state.priority();
+	logEvent(EventLog::STATE, introspection_ ? introspection_->solutionId(solution) : 0, prio.cost(), prio.depth(),
+	         dir);
+}
+
+void StagePrivate::publishSnapshot() {
+	if (snapshots_)
+		std::atomic_store(&snapshot_, SolutionSnapshot(std::make_shared<const std::vector<SolutionBaseConstPtr>>(
+		                                  solutions_.begin(), solutions_.end())));
+}
+
+void StagePrivate::evictSolutions(size_t max_solutions) {
+	while (solutions_.size() > max_solutions)
+		evictSolution(std::prev(solutions_.end()), "evicted: exceeding max_stored_solutions");
+}
+
+void StagePrivate::evictSolution(ordered<SolutionBaseConstPtr>::iterator it, const char* comment) {
+	SolutionBaseConstPtr solution = *it;
+	solution_handles_.erase(solution.get());
+	solutions_.erase(it);
+	// solutions are kept alive, because interface states still refer to them
+	std::const_pointer_cast<SolutionBase>(solution)->markAsFailure(comment);
+	if (introspection_)
+		introspection_->expireSolution(*solution);
+	failures_.push_back(solution);
+	++num_evicted_;
+}
+
+void StagePrivate::rejectSolution(const SolutionBase& solution, const std::string& comment) {
+	const_cast<SolutionBase&>(solution).markAsFailure(comment);
+	auto handle = solution_handles_.find(&solution);
+	if (handle != solution_handles_.end()) {
+		// solutions are kept alive, because interface states still refer to them
+		failures_.push_back(*handle->second);
+		solutions_.erase(handle->second);
+		solution_handles_.erase(handle);
+		publishSnapshot();
+	}
+	if (!parent() || !parent()->pruning())
+		return;
+
+	// the failed solution is no alternative path keeping its states enabled anymore
+	ContainerBasePrivate* parent_impl = parent()->pimpl();
+	if (interfaceFlags() == InterfaceFlags(CONNECT)) {  // like onNewFailure(): re-enable on new opposite states
+		parent_impl->setStatus<Interface::BACKWARD>(me(), solution.end(), solution.start(), InterfaceState::ARMED, true);
+		parent_impl->setStatus<Interface::FORWARD>(me(), solution.start(), solution.end(), InterfaceState::ARMED, true);
+	} else {
+		parent_impl->setStatus<Interface::BACKWARD>(nullptr, nullptr, solution.start(), InterfaceState::PRUNED, true);
+		parent_impl->setStatus<Interface::FORWARD>(nullptr, nullptr, solution.end(), InterfaceState::PRUNED, true);
+	}
+}
+
+namespace {
+// Combine hashes of scene features compared by Connecting::compatible() - except for poses,
+// which are compared with some tolerance. Hashes are summed to be independent of iteration order.
+size_t computeSceneSignature(const planning_scene::PlanningScene& scene) {
+	size_t signature = 0;
+	for (const auto& object : *scene.getWorld()) {
+		size_t hash = std::hash<std::string>()(object.first);
+		boost::hash_combine(hash, object.second->shape_poses_.size());
+		signature += hash;
+	}
+
+	std::vector<const moveit::core::AttachedBody*> attached;
+	scene.getCurrentState().getAttachedBodies(attached);
+	for (const moveit::core::AttachedBody* body : attached) {
+		size_t hash = std::hash<std::string>()(body->getName());
+		boost::hash_combine(hash, body->getAttachedLinkName());
+		boost::hash_combine(hash, body->getShapes().size());
+		signature += ~hash;  // distinguish from collision objects of the same name
+	}
+	return signature;
+}
+
+constexpr char const* DUPLICATE_STATE = "duplicate of a previously sent state";
+constexpr char const* COMPUTE_TIMEOUT = "compute() exceeded timeout";
+
+// key of a state for deduplication: joint positions quantized by tolerance and scene signature
+size_t deduplicationKey(const planning_scene::PlanningScene& scene, double tolerance) {
+	size_t key = computeSceneSignature(scene);
+	const moveit::core::RobotState& state = scene.getCurrentState();
+	for (size_t i = 0, end = state.getVariableCount(); i != end; ++i)
+		boost::hash_combine(key, std::llround(state.getVariablePosition(i) / tolerance));
+	return key;
+}
+
+bool isClose(const Eigen::Isometry3d& a, const Eigen::Isometry3d& b, double tolerance) {
+	return (a.matrix() - b.matrix()).cwiseAbs().maxCoeff() <= tolerance;
+}
+
+// check equivalence of scenes with identical deduplicationKey(): joint positions and object poses within tolerance
+bool equivalent(const planning_scene::PlanningScene& a, const planning_scene::PlanningScene& b, double tolerance) {
+	const moveit::core::RobotState& sa = a.getCurrentState();
+	const moveit::core::RobotState& sb = b.getCurrentState();
+	for (size_t i = 0, end = sa.getVariableCount(); i != end; ++i)
+		if (std::abs(sa.getVariablePosition(i) - sb.getVariablePosition(i)) > tolerance)
+			return false;
+
+	if (a.getWorld()->size() != b.getWorld()->size())
+		return false;
+	for (const auto& object : *a.getWorld()) {
+		const collision_detection::World::ObjectConstPtr& other = b.getWorld()->getObject(object.first);
+		if (!other)
+			return false;
+		if (other == object.second)
+			continue;  // scene diffs share unmodified objects
+		if (!isClose(object.second->pose_, other->pose_, tolerance))
+			return false;
+	}
+
+	std::vector<const moveit::core::AttachedBody*> attached;
+	sa.getAttachedBodies(attached);
+	for (const moveit::core::AttachedBody* body : attached) {
+		const moveit::core::AttachedBody* other = sb.getAttachedBody(body->getName());
+		if (!other || other->getAttachedLink() != body->getAttachedLink() ||
+		    !isClose(body->getPose(), other->getPose(), tolerance))
+			return false;
+	}
+	return true;
+}
+}  // namespace
+
+namespace {
+// waypoints of all sub trajectories of solution in execution order
+std::vector<const moveit::core::RobotState*> waypoints(const SolutionBase& solution) {
+	std::vector<const SubTrajectory*> subs;
+	flatten(solution, subs);
+	std::vector<const moveit::core::RobotState*> result;
+	for (const SubTrajectory* sub : subs)
+		if (const auto& trajectory = sub->trajectory())
+			for (size_t i = 0, end = trajectory->getWayPointCount(); i != end; ++i)
+				result.push_back(&trajectory->getWayPoint(i));
+	return result;
+}
+
+// check whether all waypoints, compared at corresponding relative positions, are within tolerance
+bool similarWaypoints(const std::vector<const moveit::core::RobotState*>& a,
+                      const std::vector<const moveit::core::RobotState*>& b, double tolerance) {
+	if (a.empty() || b.empty())
+		return a.empty() && b.empty();
+	const size_t n = std::max(a.size(), b.size());
+	for (size_t i = 0; i != n; ++i) {
+		const moveit::core::RobotState& wa = *a[n > 1 ? i * (a.size() - 1) / (n - 1) : 0];
+		const moveit::core::RobotState& wb = *b[n > 1 ? i * (b.size() - 1) / (n - 1) : 0];
+		for (size_t j = 0, end = wa.getVariableCount(); j != end; ++j)
+			if (std::abs(wa.getVariablePosition(j) - wb.getVariablePosition(j)) > tolerance)
+				return false;
+	}
+	return true;
+}
+}  // namespace
+
+bool StagePrivate::isNearDuplicate(const SolutionBase& solution, const InterfaceState& end) {
+	// the new solution's end state is not yet set
+	std::vector<const moveit::core::RobotState*> trajectory;
+	if (diversity_distance_ == SolutionDistance::TRAJECTORY)
+		trajectory = waypoints(solution);
+
+	std::vector<ordered<SolutionBaseConstPtr>::iterator> worse;
+	for (auto it = solutions_.begin(); it != solutions_.end(); ++it) {
+		const SolutionBase& stored = **it;
+		if (!stored.end() || !stored.end()->scene() ||
+		    !equivalent(*stored.end()->scene(), *end.scene(), diversity_tolerance_))
+			continue;
+		if (diversity_distance_ == SolutionDistance::TRAJECTORY &&
+		    !similarWaypoints(waypoints(stored), trajectory, diversity_tolerance_))
+			continue;
+		if (!(solution < stored))
+			return true;  // stored solution is at least as good
+		worse.push_back(it);
+	}
+	for (auto it : worse)
+		evictSolution(it, "evicted: near-duplicate of a better solution");
+	if (!worse.empty())
+		publishSnapshot();
+	return false;
+}
+
+bool StagePrivate::isDuplicate(const InterfaceState& state, Interface::Direction dir, double cost) const {
+	if (sent_states_.empty() || !state.scene())
+		return false;
+	const double tolerance = properties_.get<double>("deduplication_tolerance");
+	size_t key = deduplicationKey(*state.scene(), tolerance);
+	boost::hash_combine(key, dir);
+	auto range = sent_states_.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it) {
+		const SentState& sent = it->second;
+		if (sent.cost <= cost && !sent.state->evicted() && equivalent(*sent.state->scene(), *state.scene(), tolerance))
+			return true;
+	}
+	return false;
+}
+
+void StagePrivate::registerSentState(const InterfaceState& state, Interface::Direction dir, double cost) {
+	const double tolerance = properties_.get<double>("deduplication_tolerance");
+	if (tolerance <= 0.0)
+		return;
+	size_t key = deduplicationKey(*state.scene(), tolerance);
+	boost::hash_combine(key, dir);
+	sent_states_.emplace(key, SentState{ &state, cost });
+}
+
 void StagePrivate::sendForward(const InterfaceState& from, InterfaceState&& to, const SolutionBasePtr& solution) {
 	assert(nextStarts());
+	auto lock = lockPlanning();
 
+	if (defer_costs_) {
+		auto pending_to = std::make_shared<InterfaceState>(std::move(to));
+		pending_costs_.push_back(PendingCost{ solution, &from, pending_to.get(), [this, &from, pending_to, solution] {
+			                                     completeSendForward(from, std::move(*pending_to), solution);
+		                                     } });
+		return;
+	}
 	computeCost(from, to, *solution);
+	completeSendForward(from, std::move(to), solution);
+}
+
+void StagePrivate::completeSendForward(const InterfaceState& from, InterfaceState&& to,
+                                       const SolutionBasePtr& solution) {
+	auto lock = lockPlanning();
+	if (!solution->isFailure() && isDuplicate(to, Interface::FORWARD, solution->cost()))
+		solution->markAsFailure(DUPLICATE_STATE);
 
 	if (!storeSolution(solution, &from, nullptr))
 		return;  // solution dropped
 
 	me()->forwardProperties(from, to);
 
-	auto to_it = states_.insert(states_.end(), std::move(to));
+	InterfaceState& stored_to = storeFailureState(std::move(to), *solution);
 
 	// register stored interfaces with solution
 	solution->setStartState(from);
-	solution->setEndState(*to_it);
+	solution->setEndState(stored_to);
 
-	if (!solution->isFailure())
-		nextStarts()->add(*to_it);
+	if (!solution->isFailure()) {
+		nextStarts()->add(stored_to);
+		registerSentState(stored_to, Interface::FORWARD, solution->cost());
+		logState(stored_to, Interface::FORWARD, *solution);
+	}
 
 	newSolution(solution);
 }
 
 void StagePrivate::sendBackward(InterfaceState&& from, const InterfaceState& to, const SolutionBasePtr& solution) {
 	assert(prevEnds());
+	auto lock = lockPlanning();
 
+	if (defer_costs_) {
+		auto pending_from = std::make_shared<InterfaceState>(std::move(from));
+		pending_costs_.push_back(PendingCost{ solution, pending_from.get(), &to, [this, pending_from, &to, solution] {
+			                                     completeSendBackward(std::move(*pending_from), to, solution);
+		                                     } });
+		return;
+	}
 	computeCost(from, to, *solution);
+	completeSendBackward(std::move(from), to, solution);
+}
+
+void StagePrivate::completeSendBackward(InterfaceState&& from, const InterfaceState& to,
+                                        const SolutionBasePtr& solution) {
+	auto lock = lockPlanning();
+	if (!solution->isFailure() && isDuplicate(from, Interface::BACKWARD, solution->cost()))
+		solution->markAsFailure(DUPLICATE_STATE);
 
 	if (!storeSolution(solution, nullptr, &to))
 		return;  // solution dropped
 
 	me()->forwardProperties(to, from);
 
-	auto from_it = states_.insert(states_.end(), std::move(from));
+	InterfaceState& stored_from = storeFailureState(std::move(from), *solution);
 
-	solution->setStartState(*from_it);
+	solution->setStartState(stored_from);
 	solution->setEndState(to);
 
-	if (!solution->isFailure())
-		prevEnds()->add(*from_it);
+	if (!solution->isFailure()) {
+		prevEnds()->add(stored_from);
+		registerSentState(stored_from, Interface::BACKWARD, solution->cost());
+		logState(stored_from, Interface::BACKWARD, *solution);
+	}
 
 	newSolution(solution);
 }
 
 void StagePrivate::spawn(InterfaceState&& from, InterfaceState&& to, const SolutionBasePtr& solution) {
 	assert(prevEnds() && nextStarts());
-
+	auto lock = lockPlanning();
+
+	if (defer_costs_) {
+		auto pending_from = std::make_shared<InterfaceState>(std::move(from));
+		auto pending_to = std::make_shared<InterfaceState>(std::move(to));
+		pending_costs_.push_back(
+		    PendingCost{ solution, pending_from.get(), pending_to.get(), [this, pending_from, pending_to, solution] {
+			                completeSpawn(std::move(*pending_from), std::move(*pending_to), solution);
+		                } });
+		return;
+	}
 	computeCost(from, to, *solution);
+	completeSpawn(std::move(from), std::move(to), solution);
+}
+
+void StagePrivate::completeSpawn(InterfaceState&& from, InterfaceState&& to, const SolutionBasePtr& solution) {
+	auto lock = lockPlanning();
+	// spawned states typically are identical: checking one end suffices
+	if (!solution->isFailure() && isDuplicate(to, Interface::FORWARD, solution->cost()))
+		solution->markAsFailure(DUPLICATE_STATE);
 
 	if (!storeSolution(solution, nullptr, nullptr))
 		return;  // solution dropped
 
-	auto from_it = states_.insert(states_.end(), std::move(from));
-	auto to_it = states_.insert(states_.end(), std::move(to));
+	InterfaceState& stored_from = storeFailureState(std::move(from), *solution);
+	InterfaceState& stored_to = storeFailureState(std::move(to), *solution);
 
-	solution->setStartState(*from_it);
-	solution->setEndState(*to_it);
+	solution->setStartState(stored_from);
+	solution->setEndState(stored_to);
 
 	if (!solution->isFailure()) {
-		prevEnds()->add(*from_it);
-		nextStarts()->add(*to_it);
+		prevEnds()->add(stored_from);
+		nextStarts()->add(stored_to);
+		registerSentState(stored_to, Interface::FORWARD, solution->cost());
+		logState(stored_from, Interface::BACKWARD, *solution);
+		logState(stored_to, Interface::FORWARD, *solution);
 	}
 
 	newSolution(solution);
 }
 
+InterfaceState& StagePrivate::storeState(InterfaceState&& state) {
+	state.boundSceneDiffDepth(max_scene_diff_depth_);
+	scene_diff_depth_ = std::max(scene_diff_depth_, state.sceneDiffDepth());
+	return *states_.insert(states_.end(), std::move(state));
+}
+
 void StagePrivate::spawn(InterfaceState&& state, const SolutionBasePtr& solution) {
 	spawn(InterfaceState(state), std::move(state), solution);
 }
 
 void StagePrivate::connect(const InterfaceState& from, const InterfaceState& to, const SolutionBasePtr& solution) {
+	auto lock = lockPlanning();
+	if (defer_costs_) {
+		pending_costs_.push_back(PendingCost{ solution, &from, &to, [this, &from, &to, solution] {
+			                                     completeConnect(from, to, solution);
+		                                     } });
+		return;
+	}
 	computeCost(from, to, *solution);
+	completeConnect(from, to, solution);
+}
 
+void StagePrivate::completeConnect(const InterfaceState& from, const InterfaceState& to,
+                                   const SolutionBasePtr& solution) {
+	auto lock = lockPlanning();
 	if (!storeSolution(solution, &from, &to))
 		return;  // solution dropped
 
@@ -256,6 +673,28 @@ void StagePrivate::connect(const InterfaceState& from, const InterfaceState& to,
 	newSolution(solution);
 }
 
+void StagePrivate::evaluatePendingCosts() {
+	std::vector<PendingCost> pending;
+	{
+		auto lock = lockPlanning();
+		pending.swap(pending_costs_);
+	}
+	if (pending.empty())
+		return;
+
+	// costs of different solutions are independent
+	std::vector<std::function<void()>> jobs;
+	jobs.reserve(pending.size());
+	for (const PendingCost& p : pending)
+		jobs.emplace_back([this, &p] { computeCost(*p.from, *p.to, *p.solution); });
+	me()->runConcurrently(std::move(jobs));
+
+	// send solutions in their order of creation
+	auto lock = lockPlanning();
+	for (const PendingCost& p : pending)
+		p.send();
+}
+
 void StagePrivate::newSolution(const SolutionBasePtr& solution) {
 	// call solution callbacks for both, valid solutions and failures
 	for (const auto& cb : solution_cbs_)
@@ -290,13 +729,20 @@ void StagePrivate::computeCost(const InterfaceState& from, const InterfaceState&
 	if (solution.isFailure())
 		return;
 
+	Tracer::Scope trace("cost", "cost", me());
 	// Temporarily set start/end states of the solution w/o actually registering the solution with them
 	// This allows CostTerms to compute costs based on the InterfaceState.
 	TmpSolutionContext tip(solution, me(), from, to);
 
 	std::string comment;
 	assert(cost_term_);
-	solution.setCost(solution.computeCost(*cost_term_, comment));
+	const CostTerm* term = cost_term_.get();
+	if (const auto* deferred = dynamic_cast<const cost::Deferred*>(term)) {
+		// only estimate cost for now
+		solution.setDeferredCostTerm(deferred->exact);
+		term = deferred->estimate.get();
+	}
+	solution.setCost(solution.computeCost(*term, comment));
 
 	// If a comment was specified, add it to the solution
 	if (!comment.empty() && !solution.comment().empty()) {
@@ -306,6 +752,64 @@ void StagePrivate::computeCost(const InterfaceState& from, const InterfaceState&
 	}
 }
 
+bool StagePrivate::resolveDeferredCosts(SolutionBase& solution) {
+	bool changed = false;
+	if (const auto* wrapped = dynamic_cast<const WrappedSolution*>(&solution)) {
+		if (resolveDeferredCosts(const_cast<SolutionBase&>(*wrapped->wrapped()))) {
+			solution.setCost(wrapped->wrapped()->cost());
+			changed = true;
+		}
+	} else if (const auto* sequence = dynamic_cast<const SolutionSequence*>(&solution)) {
+		double cost = 0.0;
+		for (const SolutionBase* sub : sequence->solutions()) {
+			changed |= resolveDeferredCosts(const_cast<SolutionBase&>(*sub));
+			cost += sub->cost();
+		}
+		if (changed)
+			solution.setCost(cost);
+	}
+
+	StagePrivate* creator = solution.creator() ? const_cast<Stage*>(solution.creator())->pimpl() : nullptr;
+	// an infinite exact cost rules out the solution: treat it as failure
+	auto reject = [&solution, creator](const std::string& comment) {
+		if (creator)
+			creator->rejectSolution(solution, comment);
+		else
+			solution.markAsFailure(comment);
+		return true;
+	};
+	if (changed && !std::isfinite(solution.cost()))
+		return reject("sub solution ruled out by its deferred cost");
+
+	const CostTerm* term = nullptr;
+	CostTermConstPtr exact = solution.deferredCostTerm();
+	if (exact) {
+		solution.setDeferredCostTerm(nullptr);
+		term = exact.get();
+	} else if (changed && creator)  // re-apply creator's cost term, as sub costs changed
+		term = creator->cost_term_.get();
+	if (!term)
+		return changed;
+
+	std::string comment;
+	const double cost = solution.computeCost(*term, comment);
+	if (!std::isfinite(cost))
+		return reject(comment.empty() ? "infinite deferred cost" : comment);
+	solution.setCost(cost);
+	if (!comment.empty())
+		solution.setComment(solution.comment().empty() ? comment : solution.comment() + " (" + comment + ")");
+
+	// update sort order of creator's solutions
+	if (creator) {
+		auto handle = creator->solution_handles_.find(&solution);
+		if (handle != creator->solution_handles_.end()) {
+			creator->solutions_.update(handle->second);
+			creator->publishSnapshot();
+		}
+	}
+	return true;
+}
+
 Stage::Stage(StagePrivate* impl) : pimpl_(impl) {
 	assert(impl);
 	auto& p = properties();
@@ -316,6 +820,12 @@ Stage::Stage(StagePrivate* impl) : pimpl_(impl) {
 
 	p.declare<std::set<std::string>>("forwarded_properties", std::set<std::string>(),
 	                                 "set of interface properties to forward");
+	p.declare<uint32_t>("max_stored_solutions", 0u, "max number of solutions kept (best first, 0 = unbounded)");
+	p.declare<double>("deduplication_tolerance", 0.0, "drop sent states equivalent to better ones sent before");
+	p.declare<double>("compression_joint_tolerance", 0.0,
+	                  "max joint deviation (rad) of waypoints dropped when publishing or executing (0 = off)");
+	p.declare<double>("compression_cartesian_tolerance", 0.0,
+	                  "max tip deviation (m) of waypoints dropped when publishing or executing (0 = off)");
 }
 
 Stage::~Stage() {
@@ -334,20 +844,35 @@ void Stage::reset() {
 	auto impl = pimpl();
 	// clear solutions + associated states
 	impl->solutions_.clear();
+	impl->solution_handles_.clear();
+	impl->publishSnapshot();
 	impl->failures_.clear();
 	impl->num_failures_ = 0u;
+	impl->failure_counts_.clear();
+	impl->num_evicted_ = 0u;
+	impl->num_timeouts_ = 0u;
+	impl->hardware_counter_values_ = PerfCounterValues();
+	impl->pending_costs_.clear();
+	impl->defer_costs_ = false;
+	impl->sent_states_.clear();
 	impl->states_.clear();
+	impl->states_arena_.release();
+	impl->scene_diff_depth_ = 0;
 	// clear pull interfaces
 	if (impl->starts_)
 		impl->starts_->clear();
 	if (impl->ends_)
 		impl->ends_->clear();
+	impl->total_compute_time_ = std::chrono::duration<double>::zero();
+	impl->compute_time_stats_.reset();
+	if (impl->keep_structure_)
+		return;
+
 	// reset push interfaces
 	impl->prev_ends_.reset();
 	impl->next_starts_.reset();
 	// reset inherited properties
 	impl->properties_.reset();
-	impl->total_compute_time_ = std::chrono::duration<double>::zero();
 }
 
 void Stage::init(const moveit::core::RobotModelConstPtr& /* robot_model */) {
@@ -420,6 +945,19 @@ const ordered<SolutionBaseConstPtr>& Stage::solutions() const {
 	return pimpl()->solutions_;
 }
 
+void Stage::enableSolutionSnapshots(bool enable) {
+	auto impl = pimpl();
+	impl->snapshots_ = enable;
+	if (enable)
+		impl->publishSnapshot();
+	else
+		std::atomic_store(&impl->snapshot_, SolutionSnapshot());
+}
+
+SolutionSnapshot Stage::solutionSnapshot() const {
+	return std::atomic_load(&pimpl()->snapshot_);
+}
+
 const std::list<SolutionBaseConstPtr>& Stage::failures() const {
 	return pimpl()->failures_;
 }
@@ -428,8 +966,40 @@ size_t Stage::numFailures() const {
 	return pimpl()->num_failures_;
 }
 
+size_t Stage::numEvictedSolutions() const {
+	return pimpl()->num_evicted_;
+}
+
+size_t Stage::numTimeouts() const {
+	return pimpl()->numTimeouts();
+}
+
+const PerfCounterValues& Stage::hardwareCounters() const {
+	return pimpl()->hardwareCounters();
+}
+
+double StagePrivate::timeoutBudget() const {
+	const Property& timeout = properties_.property("timeout");
+	if (!timeout.defined())
+		return 0.0;
+	const double budget = boost::any_cast<double>(timeout.value());
+	return std::isfinite(budget) && budget > 0.0 ? budget : 0.0;
+}
+
+void StagePrivate::onComputeTimeout(double budget) {
+	auto lock = lockPlanning();
+	++num_timeouts_;
+	countFailure(COMPUTE_TIMEOUT);
+	ROS_WARN_STREAM_NAMED("Stage", fmt::format("'{}': compute() cancelled after exceeding its timeout of {}s", name(),
+	                                           budget));
+}
+
+const std::map<std::string, size_t>& Stage::failureCounts() const {
+	return pimpl()->failure_counts_;
+}
+
 void Stage::silentFailure() {
-	++(pimpl()->num_failures_);
+	pimpl()->countFailure(std::string());
 }
 
 bool Stage::storeFailures() const {
@@ -437,8 +1007,16 @@ bool Stage::storeFailures() const {
 }
 
 void Stage::explainFailure(std::ostream& os) const {
-	if (!failures().empty())
-		os << ": " << failures().front()->comment();
+	// most frequent failure comments, from the aggregate (independent of the number of stored failures)
+	std::vector<std::pair<size_t, const std::string*>> counts;
+	for (const auto& entry : pimpl()->failure_counts_)
+		if (!entry.first.empty())
+			counts.emplace_back(entry.second, &entry.first);
+	const size_t num_shown = std::min<size_t>(3, counts.size());
+	std::partial_sort(counts.begin(), counts.begin() + num_shown, counts.end(),
+	                  [](const auto& a, const auto& b) { return a.first > b.first; });
+	for (size_t i = 0; i < num_shown; ++i)
+		os << (i == 0 ? ": " : ", ") << *counts[i].second << " (" << counts[i].first << "x)";
 }
 
 PropertyMap& Stage::properties() {
@@ -453,6 +1031,127 @@ double Stage::getTotalComputeTime() const {
 	return pimpl()->total_compute_time_.count();
 }
 
+const ComputeTimeStatistics& Stage::computeTimeStatistics() const {
+	return pimpl()->compute_time_stats_;
+}
+
+namespace {
+// positions, velocities, accelerations + joint, link, and collision body transforms
+std::size_t robotStateBytes(const moveit::core::RobotModel& model) {
+	return sizeof(moveit::core::RobotState) + 3 * model.getVariableCount() * sizeof(double) +
+	       (model.getJointModelCount() + model.getLinkModelCount() + model.getLinkGeometryCount()) *
+	           sizeof(Eigen::Isometry3d);
+}
+
+std::size_t shapeBytes(const shapes::Shape& shape) {
+	if (const auto* mesh = dynamic_cast<const shapes::Mesh*>(&shape))
+		return sizeof(shapes::Mesh) + 6 * mesh->vertex_count * sizeof(double) +
+		       mesh->triangle_count * (3 * sizeof(unsigned int) + 3 * sizeof(double));
+	return sizeof(shapes::Box);  // primitive shapes are small
+}
+
+std::size_t sceneBytes(const planning_scene::PlanningScene& scene) {
+	std::size_t bytes = sizeof(planning_scene::PlanningScene) + robotStateBytes(*scene.getRobotModel());
+	// diffs share unmodified objects with their parent: only count objects of root scenes
+	if (!scene.getParent()) {
+		for (const auto& object : *scene.getWorld()) {
+			bytes += sizeof(collision_detection::World::Object);
+			for (const auto& shape : object.second->shapes_)
+				bytes += shapeBytes(*shape);
+		}
+	}
+	return bytes;
+}
+
+std::size_t markerBytes(const std::deque<visualization_msgs::Marker>& markers) {
+	std::size_t bytes = 0;
+	for (const auto& marker : markers)
+		bytes += ros::serialization::serializationLength(marker);
+	return bytes;
+}
+
+void addSolutionBytes(const SolutionBase& solution, std::size_t& trajectories, std::size_t& markers) {
+	markers += markerBytes(solution.generatedMarkers());  // don't trigger lazy generation
+	if (const auto* sub = dynamic_cast<const SubTrajectory*>(&solution)) {
+		trajectories += sizeof(SubTrajectory);
+		if (const auto& trajectory = sub->trajectory())
+			trajectories += sizeof(robot_trajectory::RobotTrajectory) +
+			                trajectory->getWayPointCount() * (robotStateBytes(*trajectory->getRobotModel()) + sizeof(double));
+	} else if (const auto* sequence = dynamic_cast<const SolutionSequence*>(&solution))
+		trajectories += sizeof(SolutionSequence) + sequence->solutions().size() * sizeof(const SolutionBase*);
+	else
+		trajectories += sizeof(WrappedSolution);
+}
+}  // namespace
+
+std::size_t StagePrivate::evict(InterfaceState& state) {
+	assert(state.priority().status() == InterfaceState::Status::PRUNED);
+	std::size_t freed = 0;
+	if (state.scene()) {
+		freed += sceneBytes(*state.scene());
+		state.evictScene();
+	}
+	for (const auto* solutions : { &state.incomingTrajectories(), &state.outgoingTrajectories() }) {
+		for (SolutionBase* solution : *solutions) {
+			if (auto* sub = dynamic_cast<SubTrajectory*>(solution)) {
+				std::size_t trajectory = 0, markers = 0;
+				addSolutionBytes(*sub, trajectory, markers);
+				freed += trajectory + markers - sizeof(SubTrajectory);
+				sub->evict();
+				if (introspection_)
+					introspection_->expireSolution(*sub);
+			}
+		}
+	}
+	return freed;
+}
+
+MemoryUsage Stage::memoryUsage() const {
+	auto impl = pimpl();
+	MemoryUsage usage;
+
+	std::unordered_set<const planning_scene::PlanningScene*> scenes;
+	// trajectory lists only allocate once exceeding their inline capacity
+	auto heap_bytes = [](const InterfaceState::Solutions& solutions) {
+		return solutions.capacity() > InterfaceState::INLINE_SOLUTIONS ? solutions.capacity() * sizeof(SolutionBase*) : 0;
+	};
+	for (const InterfaceState& state : impl->states_) {
+		usage.states +=
+		    sizeof(InterfaceState) + heap_bytes(state.incomingTrajectories()) + heap_bytes(state.outgoingTrajectories());
+		if (state.scene() && scenes.insert(state.scene().get()).second)
+			usage.scenes += sceneBytes(*state.scene());
+	}
+
+	for (const auto& solution : impl->solutions_)
+		addSolutionBytes(*solution, usage.trajectories, usage.markers);
+	for (const auto& solution : impl->failures_)
+		addSolutionBytes(*solution, usage.failures, usage.failures);
+	return usage;
+}
+
+size_t Stage::concurrency() const {
+	const ThreadPool* pool = pimpl()->solverPool();
+	return pool ? pool->size() + 1 : 1;
+}
+
+void Stage::runConcurrently(std::vector<std::function<void()>>&& jobs) const {
+	if (ThreadPool* pool = pimpl()->solverPool()) {
+		if (jobs.size() > 1) {
+			// forward the calling thread's cancellation to the workers
+			const solvers::PlannerCancellation* cancellation = solvers::PlannerCancellation::current();
+			for (auto& job : jobs)
+				job = [cancellation, fn = std::move(job)] {
+					solvers::PlannerCancellation forward(cancellation);
+					fn();
+				};
+			pool->run(std::move(jobs));
+			return;
+		}
+	}
+	for (auto& job : jobs)
+		job();
+}
+
 void StagePrivate::composePropertyErrorMsg(const std::string& property_name, std::ostream& os) {
 	if (property_name.empty())
 		return;
@@ -582,31 +1281,95 @@ const InterfaceState& PropagatingEitherWayPrivate::fetchEndState() {
 	return *ends_->remove(ends_->begin()).front();
 }
 
+namespace {
+// whether a fetched state was extended by any successful solution
+bool extended(const InterfaceState::Solutions& solutions) {
+	return std::any_of(solutions.begin(), solutions.end(), [](const SolutionBase* s) { return !s->isFailure(); });
+}
+}  // namespace
+
 bool PropagatingEitherWayPrivate::canCompute() const {
 	return hasStartState() || hasEndState();
 }
 
+size_t PropagatingEitherWayPrivate::batchSize() const {
+	const uint32_t n = properties_.get<uint32_t>("max_batch_size");
+	if (n <= 1)
+		return 1;
+	// INTERFACE-initialized properties are specific to each state
+	for (const auto& p : properties_)
+		if (p.second.initsFrom(Stage::INTERFACE))
+			return 1;
+	return n;
+}
+
 void PropagatingEitherWayPrivate::compute() {
 	PropagatingEitherWay* me = static_cast<PropagatingEitherWay*>(me_);
 
+	// only fetching states needs to be locked, the actual computation can run concurrently
+	auto lock = lockPlanning();
+	const size_t batch_size = batchSize();
 	if (hasStartState()) {
 		const InterfaceState& state = fetchStartState();
 		// enforce property initialization from INTERFACE
 		properties_.performInitFrom(Stage::INTERFACE, state.properties());
-		me->computeForward(state);
+		std::vector<const InterfaceState*> batch;
+		if (batch_size > 1 && hasStartState()) {
+			batch.push_back(&state);
+			while (batch.size() < batch_size && hasStartState())
+				batch.push_back(&fetchStartState());
+		}
+		if (lock)
+			lock.unlock();
+		if (batch.empty())
+			me->computeForward(state);
+		else
+			me->computeForwardBatch(batch);
+		if (lock.mutex())
+			lock.lock();
+		if (starts_->beamWidth()) {
+			// dead ends: give the next parked states a chance
+			if (batch.empty() && !extended(state.outgoingTrajectories()))
+				starts_->releaseBeamSlot();
+			for (const InterfaceState* s : batch)
+				if (!extended(s->outgoingTrajectories()))
+					starts_->releaseBeamSlot();
+		}
 	}
 	if (hasEndState()) {
 		const InterfaceState& state = fetchEndState();
 		// enforce property initialization from INTERFACE
 		properties_.performInitFrom(Stage::INTERFACE, state.properties());
-		me->computeBackward(state);
+		std::vector<const InterfaceState*> batch;
+		if (batch_size > 1 && hasEndState()) {
+			batch.push_back(&state);
+			while (batch.size() < batch_size && hasEndState())
+				batch.push_back(&fetchEndState());
+		}
+		if (lock)
+			lock.unlock();
+		if (batch.empty())
+			me->computeBackward(state);
+		else
+			me->computeBackwardBatch(batch);
+		if (ends_->beamWidth()) {
+			if (lock.mutex())
+				lock.lock();
+			if (batch.empty() && !extended(state.incomingTrajectories()))
+				ends_->releaseBeamSlot();
+			for (const InterfaceState* s : batch)
+				if (!extended(s->incomingTrajectories()))
+					ends_->releaseBeamSlot();
+		}
 	}
 }
 
 PropagatingEitherWay::PropagatingEitherWay(const std::string& name)
   : PropagatingEitherWay(new PropagatingEitherWayPrivate(this, AUTO, name)) {}
 
-PropagatingEitherWay::PropagatingEitherWay(PropagatingEitherWayPrivate* impl) : ComputeBase(impl) {}
+PropagatingEitherWay::PropagatingEitherWay(PropagatingEitherWayPrivate* impl) : ComputeBase(impl) {
+	properties().declare<uint32_t>("max_batch_size", 1u, "maximal number of pending states computed per compute()");
+}
 
 void PropagatingEitherWay::restrictDirection(PropagatingEitherWay::Direction dir) {
 	auto impl = pimpl();
@@ -620,7 +1383,7 @@ void PropagatingEitherWay::restrictDirection(PropagatingEitherWay::Direction dir
 
 template <Interface::Direction dir>
 void PropagatingEitherWay::send(const InterfaceState& start, InterfaceState&& end, SubTrajectory&& trajectory) {
-	pimpl()->send<dir>(start, std::move(end), std::make_shared<SubTrajectory>(std::move(trajectory)));
+	pimpl()->send<dir>(start, std::move(end), pimpl()->makeSolution<SubTrajectory>(std::move(trajectory)));
 }
 // Explicit template instantiation is required. The compiler, otherwise, might just inline them.
 template void PropagatingEitherWay::send<Interface::FORWARD>(const InterfaceState& start, InterfaceState&& end,
@@ -636,15 +1399,66 @@ void PropagatingEitherWay::computeBackward(const InterfaceState& to) {
 	computeGeneric<Interface::BACKWARD>(to);
 }
 
+void PropagatingEitherWay::computeForwardBatch(const std::vector<const InterfaceState*>& from) {
+	std::vector<std::function<void()>> jobs;
+	jobs.reserve(from.size());
+	for (const InterfaceState* state : from)
+		jobs.emplace_back([this, state] { computeForward(*state); });
+	runConcurrently(std::move(jobs));
+}
+
+void PropagatingEitherWay::computeBackwardBatch(const std::vector<const InterfaceState*>& to) {
+	std::vector<std::function<void()>> jobs;
+	jobs.reserve(to.size());
+	for (const InterfaceState* state : to)
+		jobs.emplace_back([this, state] { computeBackward(*state); });
+	runConcurrently(std::move(jobs));
+}
+
+void PropagatingEitherWay::setSolutionCache(const SolutionCachePtr& cache) {
+	pimpl()->solution_cache_ = cache;
+}
+
+void PropagatingEitherWay::setPlanRecording(const PlanRecordingPtr& recording) {
+	pimpl()->plan_recording_ = recording;
+}
+
 template <Interface::Direction dir>
 void PropagatingEitherWay::computeGeneric(const InterfaceState& start) {
 	planning_scene::PlanningScenePtr end;
 	SubTrajectory trajectory;
 
-	if (!compute(start, end, trajectory, dir) && trajectory.comment().empty())
+	// reuse cached solution for identical input
+	const SolutionCachePtr& cache = pimpl()->solution_cache_;
+	const PlanRecordingPtr& recording = pimpl()->plan_recording_;
+	SolutionCache::Key key;
+	const bool cacheable = (cache || recording) && SolutionCache::computeKey(*this, dir, start, key);
+	bool success;
+	if (cacheable && recording && recording->replays() &&
+	    recording->replay(key, start.scene(), end, trajectory, success)) {
+		if (!success && trajectory.comment().empty())
+			silentFailure();
+		else
+			send<dir>(start, InterfaceState(end), std::move(trajectory));
+		return;
+	}
+	if (cacheable && cache && cache->lookup(key, start.scene(), end, trajectory)) {
+		send<dir>(start, InterfaceState(end), std::move(trajectory));
+		return;
+	}
+
+	const auto start_time = std::chrono::steady_clock::now();
+	success = compute(start, end, trajectory, dir);
+	if (cacheable && recording && recording->records())
+		recording->record(key, name(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count(),
+		                  success, start.scene(), end, trajectory);
+	if (!success && trajectory.comment().empty())
 		silentFailure();  // there is nothing to report (comment is empty)
-	else
+	else {
+		if (success && cacheable && cache && end && !trajectory.isFailure())
+			cache->store(key, start.scene(), end, trajectory);
 		send<dir>(start, InterfaceState(end), std::move(trajectory));
+	}
 }
 
 PropagatingForwardPrivate::PropagatingForwardPrivate(PropagatingForward* me, const std::string& name)
@@ -660,6 +1474,10 @@ void PropagatingForward::computeBackward(const InterfaceState& /* to */) {
 	assert(false);  // This should never be called
 }
 
+void PropagatingForward::computeBackwardBatch(const std::vector<const InterfaceState*>& /* to */) {
+	assert(false);  // This should never be called
+}
+
 PropagatingBackwardPrivate::PropagatingBackwardPrivate(PropagatingBackward* me, const std::string& name)
   : PropagatingEitherWayPrivate(me, PropagatingEitherWay::BACKWARD, name) {
 	// indicate, that we don't accept new states from starts_ interface
@@ -673,6 +1491,10 @@ void PropagatingBackward::computeForward(const InterfaceState& /* from */) {
 	assert(false);  // This should never be called
 }
 
+void PropagatingBackward::computeForwardBatch(const std::vector<const InterfaceState*>& /* from */) {
+	assert(false);  // This should never be called
+}
+
 GeneratorPrivate::GeneratorPrivate(Generator* me, const std::string& name) : ComputeBasePrivate(me, name) {}
 
 InterfaceFlags GeneratorPrivate::requiredInterface() const {
@@ -684,6 +1506,8 @@ bool GeneratorPrivate::canCompute() const {
 }
 
 void GeneratorPrivate::compute() {
+	// generators usually share state with their monitored stages: don't run concurrently
+	auto lock = lockPlanning();
 	static_cast<Generator*>(me_)->compute();
 }
 
@@ -691,11 +1515,11 @@ Generator::Generator(GeneratorPrivate* impl) : ComputeBase(impl) {}
 Generator::Generator(const std::string& name) : Generator(new GeneratorPrivate(this, name)) {}
 
 void Generator::spawn(InterfaceState&& from, InterfaceState&& to, SubTrajectory&& t) {
-	pimpl()->spawn(std::move(from), std::move(to), std::make_shared<SubTrajectory>(std::move(t)));
+	pimpl()->spawn(std::move(from), std::move(to), pimpl()->makeSolution<SubTrajectory>(std::move(t)));
 }
 
 void Generator::spawn(InterfaceState&& state, SubTrajectory&& t) {
-	pimpl()->spawn(std::move(state), std::make_shared<SubTrajectory>(std::move(t)));
+	pimpl()->spawn(std::move(state), pimpl()->makeSolution<SubTrajectory>(std::move(t)));
 }
 
 MonitoringGeneratorPrivate::MonitoringGeneratorPrivate(MonitoringGenerator* me, const std::string& name)
@@ -719,6 +1543,18 @@ void MonitoringGenerator::setMonitoredStage(Stage* monitored) {
 	impl->monitored_ = monitored;
 }
 
+void MonitoringGenerator::setBatchedMonitoring(bool batched) {
+	auto impl = pimpl();
+	if (!batched)
+		impl->flush();
+	impl->batched_ = batched;
+}
+
+void MonitoringGenerator::reset() {
+	pimpl()->buffered_.clear();
+	Generator::reset();
+}
+
 void MonitoringGenerator::init(const moveit::core::RobotModelConstPtr& robot_model) {
 	Generator::init(robot_model);
 
@@ -732,12 +1568,42 @@ void MonitoringGenerator::init(const moveit::core::RobotModelConstPtr& robot_mod
 	}
 }
 
+void MonitoringGenerator::onNewSolutions(const std::vector<const SolutionBase*>& solutions) {
+	for (const SolutionBase* s : solutions)
+		onNewSolution(*s);
+}
+
 void MonitoringGeneratorPrivate::solutionCB(const SolutionBase& s) {
 	// forward only successful solutions to monitor
-	if (!s.isFailure())
+	if (s.isFailure())
+		return;
+	if (batched_)
+		buffered_.push_back(&s);
+	else
 		static_cast<MonitoringGenerator*>(me())->onNewSolution(s);
 }
 
+bool MonitoringGeneratorPrivate::flush() {
+	if (buffered_.empty())
+		return false;
+	std::vector<const SolutionBase*> solutions;
+	solutions.swap(buffered_);
+	static_cast<MonitoringGenerator*>(me())->onNewSolutions(solutions);
+	return true;
+}
+
+bool MonitoringGeneratorPrivate::canCompute() const {
+	return !buffered_.empty() || GeneratorPrivate::canCompute();
+}
+
+void MonitoringGeneratorPrivate::compute() {
+	auto lock = lockPlanning();
+	// onNewSolutions() might have rejected all buffered solutions
+	if (flush() && !GeneratorPrivate::canCompute())
+		return;
+	GeneratorPrivate::compute();
+}
+
 ConnectingPrivate::ConnectingPrivate(Connecting* me, const std::string& name) : ComputeBasePrivate(me, name) {
 	starts_ = std::make_shared<Interface>(std::bind(&ConnectingPrivate::newState<Interface::BACKWARD>, this,
 	                                                std::placeholders::_1, std::placeholders::_2));
@@ -760,6 +1626,122 @@ ConnectingPrivate::StatePair ConnectingPrivate::make_pair<Interface::FORWARD>(In
 	return StatePair(second, first);
 }
 
+size_t ConnectingPrivate::sceneSignature(const InterfaceState& state) const {
+	auto it = scene_signatures_.find(&state);
+	return it != scene_signatures_.end() ? it->second : computeSceneSignature(*state.scene());
+}
+
+template <Interface::Direction dir>
+void ConnectingPrivate::addState(Interface::const_iterator it) {
+	scene_signatures_[&*it] = computeSceneSignature(*it->scene());
+	if (dir == Interface::BACKWARD) {  // new start state: add a row to pair_status_
+		state_ids_[&*it] = start_states_.size();
+		start_states_.push_back(it);
+		pair_status_.emplace_back(end_states_.size(), UNKNOWN);
+		open_pairs_.push_back(end_states_.size());
+		// the frontier remains valid if nothing else changed: add a cursor for the new start
+		if (frontier_changes_.first + 1 == starts_->changes() && frontier_changes_.second == ends_->changes()) {
+			pushPairs(it, ends_->cbegin(), false);
+			frontier_changes_.first = starts_->changes();
+		}
+	} else {  // new end state: add a column to pair_status_
+		state_ids_[&*it] = end_states_.size();
+		end_states_.push_back(it);
+		for (auto& row : pair_status_)
+			row.push_back(UNKNOWN);
+		for (size_t& open : open_pairs_)
+			++open;
+	}
+}
+
+ConnectingPrivate::PairStatus ConnectingPrivate::pairStatus(size_t start, size_t end) const {
+	const PairStatus status = pair_status_[start][end];
+	if (status != UNKNOWN)
+		return status;
+	const bool compatible = static_cast<const Connecting*>(me_)->compatible(*start_states_[start], *end_states_[end]);
+	setPairStatus(start, end, compatible ? PENDING : INCOMPATIBLE);
+	return pair_status_[start][end];
+}
+
+ConnectingPrivate::PairStatus ConnectingPrivate::pairStatus(const StatePair& pair) const {
+	auto start = state_ids_.find(&*pair.first);
+	auto end = state_ids_.find(&*pair.second);
+	if (start == state_ids_.end() || end == state_ids_.end())
+		return INCOMPATIBLE;  // unknown states
+	return pairStatus(start->second, end->second);
+}
+
+void ConnectingPrivate::setPairStatus(size_t start, size_t end, PairStatus status) const {
+	PairStatus& current = pair_status_[start][end];
+	const bool was_open = current == UNKNOWN || current == PENDING;
+	const bool open = status == UNKNOWN || status == PENDING;
+	if (open && !was_open)
+		++open_pairs_[start];
+	else if (!open && was_open)
+		--open_pairs_[start];
+	current = status;
+}
+
+template <Interface::Direction dir, typename Predicate>
+bool ConnectingPrivate::anyPendingOpposite(const InterfaceState& state, Predicate pred) const {
+	static_assert(Interface::FORWARD == 0 && Interface::BACKWARD == 1,
+	              "This code assumes FORWARD=0, BACKWARD=1. Don't change their order!");
+	auto id = state_ids_.find(&state);
+	if (id != state_ids_.end()) {
+		if (dir == Interface::BACKWARD) {  // state is a start: scan its row
+			for (size_t end = 0; end < end_states_.size(); ++end)
+				if (pairStatus(id->second, end) == PENDING && pred(end_states_[end]))
+					return true;
+		} else {  // state is an end: scan its column
+			for (size_t start = 0; start < start_states_.size(); ++start)
+				if (pairStatus(start, id->second) == PENDING && pred(start_states_[start]))
+					return true;
+		}
+	}
+	auto matches = [&state, &pred](const StatePair& candidate) {
+		return &*std::get<opposite<dir>()>(candidate) == &state && pred(std::get<dir>(candidate));
+	};
+	return std::any_of(pending.begin(), pending.end(), matches) ||
+	       std::any_of(parked_.begin(), parked_.end(), matches);
+}
+
+void ConnectingPrivate::addPendingPair(const StatePair& pair) {
+	if (pair.enabled())
+		pending.insert(pair);
+	else
+		parked_.push_back(pair);
+}
+
+void ConnectingPrivate::updatePendingPairs() {
+	if (pending.empty() && parked_.empty())
+		return;
+	// collect restored pairs first, as parking appends to parked_
+	auto restored =
+	    std::partition(parked_.begin(), parked_.end(), [](const StatePair& pair) { return !pair.enabled(); });
+	std::vector<StatePair> restore(restored, parked_.end());
+	parked_.erase(restored, parked_.end());
+
+	pending.remove_if([this](const StatePair& pair) {
+		if (pair.enabled())
+			return false;
+		parked_.push_back(pair);
+		return true;
+	});
+	// many of the remaining pairs will have changed priorities
+	pending.sort();
+	for (const StatePair& pair : restore)
+		pending.insert(pair);
+}
+
+void ConnectingPrivate::retryPair(const InterfaceState& from, const InterfaceState& to) {
+	auto start = state_ids_.find(&from);
+	auto end = state_ids_.find(&to);
+	if (start == state_ids_.end() || end == state_ids_.end())
+		return;
+	// explicitly listed pairs are computed regardless of their (DONE) status
+	addPendingPair(StatePair(start_states_[start->second], end_states_[end->second]));
+}
+
 template <Interface::Direction dir>
 void ConnectingPrivate::newState(Interface::iterator it, Interface::UpdateFlags updated) {
 	auto parent_pimpl = parent()->pimpl();
@@ -775,10 +1757,13 @@ void ConnectingPrivate::newState(Interface::iterator it, Interface::UpdateFlags
 			if (status == InterfaceState::Status::PRUNED)  // PRUNED becomes ARMED on opposite side
 				status = InterfaceState::Status::ARMED;  // (only for pending state pairs)
 
-			for (const auto& candidate : this->pending) {
-				if (std::get<opposite<dir>()>(candidate) != it)  // only consider pairs with source state == state
-					continue;
-				auto oit = std::get<dir>(candidate);  // opposite target state
+			// collect opposite states of pending pairs first: setStatus() reorders the interfaces
+			std::vector<Interface::const_iterator> opposites;
+			anyPendingOpposite<dir>(*it, [&opposites](Interface::const_iterator oit) {
+				opposites.push_back(oit);
+				return false;
+			});
+			for (Interface::const_iterator oit : opposites) {  // opposite target states
 				auto ostatus = oit->priority().status();
 				if (ostatus != status) {
 					if (status != InterfaceState::Status::ENABLED) {
@@ -796,30 +1781,29 @@ void ConnectingPrivate::newState(Interface::iterator it, Interface::UpdateFlags
 			}
 		}
 
-		// many pairs will have changed priorities: resort pending list
-		pending.sort();
-	} else {  // new state: insert all pairs with other interface
+		updatePendingPairs();
+	} else {  // new state: remember compatibility with all states of other interface
 		assert(it->priority().enabled());  // new solutions are feasible, aren't they?
+		addState<dir>(it);
 		InterfacePtr other_interface = pullInterface<dir>();
 		bool have_enabled_opposites = false;
 
 		// other interface states to re-enable (post-poned because otherwise order in other_interface changes during loop)
 		std::vector<Interface::iterator> oit_to_enable;
 		for (Interface::iterator oit = other_interface->begin(), oend = other_interface->end(); oit != oend; ++oit) {
-			if (!static_cast<Connecting*>(me_)->compatible(*it, *oit))
+			// Compatibility of all pairs is checked lazily (by pairStatus()), except for ARMED opposites
+			// and until an enabled opposite is found.
+			const bool armed = oit->priority().status() == InterfaceState::Status::ARMED;
+			if (!armed && (have_enabled_opposites || !oit->priority().enabled()))
+				continue;
+			if (pairStatus(make_pair<dir>(it, oit)) != PENDING)
 				continue;
 
 			// re-enable the opposing state oit (and its associated solution branch) if its status is ARMED
 			// https://github.com/moveit/moveit_task_constructor/pull/309#issuecomment-974636202
-			if (oit->priority().status() == InterfaceState::Status::ARMED) {
+			if (armed)
 				oit_to_enable.push_back(oit);
-				have_enabled_opposites = true;
-			}
-			if (oit->priority().enabled())
-				have_enabled_opposites = true;
-
-			// Remember all pending states, regardless of their status!
-			pending.insert(make_pair<dir>(it, oit));
+			have_enabled_opposites = true;
 		}
 		// actually re-enable other interface states, which were scheduled for re-enabling above
 		for (Interface::iterator oit : oit_to_enable)
@@ -851,20 +1835,11 @@ void ConnectingPrivate::newState(Interface::iterator it, Interface::UpdateFlags
 // If not, we exhausted all solution candidates for target and thus should mark it as failure.
 template <Interface::Direction dir>
 inline bool ConnectingPrivate::hasPendingOpposites(const InterfaceState* source, const InterfaceState* target) const {
-	for (const auto& candidate : this->pending) {
-		static_assert(Interface::FORWARD == 0 && Interface::BACKWARD == 1,
-		              "This code assumes FORWARD=0, BACKWARD=1. Don't change their order!");
-		const InterfaceState* src = &*std::get<dir>(candidate);
-		const InterfaceState* tgt = &*std::get<opposite<dir>()>(candidate);
-
-		if (tgt == target && src != source && src->priority().enabled())
-			return true;
-
-		// early stopping when only infeasible pairs are to come
-		if (!std::get<0>(candidate)->priority().enabled() || !std::get<1>(candidate)->priority().enabled())
-			break;
-	}
-	return false;
+	if (!target->priority().enabled())
+		return false;  // only pairs of enabled states are feasible
+	return anyPendingOpposite<dir>(*target, [source](Interface::const_iterator src) {
+		return &*src != source && src->priority().enabled();
+	});
 }
 // explicitly instantiate templates for both directions
 template bool ConnectingPrivate::hasPendingOpposites<Interface::FORWARD>(const InterfaceState* start,
@@ -872,39 +1847,209 @@ template bool ConnectingPrivate::hasPendingOpposites<Interface::FORWARD>(const I
 template bool ConnectingPrivate::hasPendingOpposites<Interface::BACKWARD>(const InterfaceState* end,
                                                                           const InterfaceState* start) const;
 
+namespace {
+// heap order of PairCursors: best on top
+template <typename Cursor>
+bool worseCursor(const Cursor& lhs, const Cursor& rhs) {
+	return rhs.prio < lhs.prio;
+}
+}  // namespace
+
+void ConnectingPrivate::pushPairs(Interface::const_iterator start, Interface::const_iterator end, bool single) const {
+	if (start == starts_->cend() || end == ends_->cend() || !start->priority().enabled() || !end->priority().enabled())
+		return;
+	frontier_.push_back(PairCursor{ start->priority() + end->priority(), start, end, single });
+	std::push_heap(frontier_.begin(), frontier_.end(), worseCursor<PairCursor>);
+}
+
+template <typename Visitor>
+void ConnectingPrivate::visitPendingPairs(Visitor visit) const {
+	// Both interfaces are sorted by priority (enabled states first) and the priority of a pair is the sum of
+	// its states' priorities. Hence, pairs of enabled states can be enumerated best-first like the cells of
+	// a sorted matrix, advancing a cursor per start through the ends. Finished pairs are dropped from the frontier.
+	if (frontier_changes_ != std::make_pair(starts_->changes(), ends_->changes())) {
+		frontier_.clear();
+		for (auto start = starts_->cbegin(); start != starts_->cend() && start->priority().enabled(); ++start)
+			pushPairs(start, ends_->cbegin(), false);
+		frontier_changes_ = std::make_pair(starts_->changes(), ends_->changes());
+	}
+
+	std::vector<PairCursor> visited;  // cursors of pending pairs, kept in the frontier
+	while (!frontier_.empty()) {
+		std::pop_heap(frontier_.begin(), frontier_.end(), worseCursor<PairCursor>);
+		const PairCursor cursor = frontier_.back();
+		frontier_.pop_back();
+
+		const size_t start = state_ids_.at(&*cursor.start);
+		if (!open_pairs_[start])
+			continue;  // all pairs of start are finished
+		if (!cursor.single)
+			pushPairs(cursor.start, std::next(cursor.end), false);
+		if (pairStatus(start, state_ids_.at(&*cursor.end)) != PENDING)
+			continue;
+		visited.push_back(PairCursor{ cursor.prio, cursor.start, cursor.end, true });  // already advanced
+		if (!visit(StatePair(cursor.start, cursor.end)))
+			break;
+	}
+	for (const PairCursor& cursor : visited) {
+		frontier_.push_back(cursor);
+		std::push_heap(frontier_.begin(), frontier_.end(), worseCursor<PairCursor>);
+	}
+}
+
+bool ConnectingPrivate::bestPendingPair(StatePair& best, bool& listed, size_t candidates) const {
+	if (candidates > 1) {
+		// collect the best candidates of both, the interfaces and the pending list, in order of priority
+		std::vector<std::pair<StatePair, bool>> found;
+		visitPendingPairs([&found, candidates](const StatePair& pair) {
+			found.emplace_back(pair, false);
+			return found.size() < candidates;
+		});
+		for (const StatePair& pair : pending) {
+			if (found.size() >= 2 * candidates || !pair.enabled())
+				break;
+			found.emplace_back(pair, true);
+		}
+		if (found.empty())
+			return false;
+		std::stable_sort(found.begin(), found.end(),
+		                 [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+		found.resize(std::min(found.size(), candidates));
+
+		// choose the closest pair: connecting close states is usually easy
+		auto distance = [](const StatePair& pair) {
+			return pair.first->scene()->getCurrentState().distance(pair.second->scene()->getCurrentState());
+		};
+		auto nearest = std::min_element(found.begin(), found.end(), [&distance](const auto& lhs, const auto& rhs) {
+			return distance(lhs.first) < distance(rhs.first);
+		});
+		best = nearest->first;
+		listed = nearest->second;
+		return true;
+	}
+
+	bool found = false;
+	visitPendingPairs([&best, &found](const StatePair& pair) {
+		best = pair;
+		found = true;
+		return false;
+	});
+
+	listed = false;
+	if (!pending.empty() && pending.front().enabled() && (!found || pending.front() < best)) {
+		best = pending.front();
+		listed = found = true;
+	}
+	return found;
+}
+
 bool ConnectingPrivate::canCompute() const {
 	// ROS_DEBUG_STREAM("canCompute " << name() << ": " << pendingPairsPrinter());
 	// Do we still have feasible pending state pairs?
-	return !pending.empty() && pending.front().first->priority().enabled() &&
-	       pending.front().second->priority().enabled();
+	StatePair best(starts_->cend(), ends_->cend());
+	bool listed;
+	return bestPendingPair(best, listed);
 }
 
 void ConnectingPrivate::compute() {
-	const StatePair& top = pending.pop();
-	const InterfaceState& from = *top.first;
-	const InterfaceState& to = *top.second;
-	assert(from.priority().enabled() && to.priority().enabled());
-	static_cast<Connecting*>(me_)->compute(from, to);
+	auto lock = lockPlanning();
+	ThreadPool* pool = solverPool();
+	const size_t max_pairs = pool ? std::max<uint32_t>(1, properties().get<uint32_t>("max_concurrent_pairs")) : 1;
+	const size_t candidates = properties().get<uint32_t>("nearest_candidates");
+
+	std::vector<StatePair> pairs;
+	StatePair top(starts_->cend(), ends_->cend());
+	bool listed;
+	while (pairs.size() < max_pairs && bestPendingPair(top, listed, candidates)) {
+		if (listed)
+			pending.pop();
+		else
+			setPairStatus(top, DONE);
+		assert(top.first->priority().enabled() && top.second->priority().enabled());
+		pairs.push_back(top);
+	}
+	if (pairs.empty())
+		return;  // in multi-threaded planning, pending pairs might have been disabled meanwhile
+	if (lock)
+		lock.unlock();  // the actual computation can run concurrently
+
+	auto* me = static_cast<Connecting*>(me_);
+	if (pairs.size() == 1) {
+		me->compute(*pairs.front().first, *pairs.front().second);
+		return;
+	}
+
+	// a failing pair must not discard the results of the others: remember the first error and rethrow it at the end
+	std::vector<std::function<void()>> finish(pairs.size());
+	std::vector<std::exception_ptr> errors(pairs.size());
+	std::vector<ThreadPool::Job> jobs;
+	jobs.reserve(pairs.size());
+	for (size_t i = 0; i < pairs.size(); ++i)
+		jobs.emplace_back([me, &pairs, &finish, &errors, i] {
+			try {
+				finish[i] = me->computeConcurrently(*pairs[i].first, *pairs[i].second);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		});
+	pool->run(std::move(jobs));
+	// feed back results in order of priority
+	std::exception_ptr error;
+	for (size_t i = 0; i < pairs.size(); ++i) {
+		if (finish[i]) {
+			try {
+				finish[i]();
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+		if (!error)
+			error = errors[i];
+	}
+	if (error)
+		std::rethrow_exception(error);
 }
 
 std::ostream& operator<<(std::ostream& os, const PendingPairsPrinter& p) {
 	const auto* impl = p.instance_;
 	const char* reset = InterfaceState::colorForStatus(3);
-	for (const auto& candidate : impl->pending) {
+	std::vector<ConnectingPrivate::StatePair> pairs(impl->pending.begin(), impl->pending.end());
+	pairs.insert(pairs.end(), impl->parked_.begin(), impl->parked_.end());
+	for (size_t start = 0; start < impl->pair_status_.size(); ++start) {
+		for (size_t end = 0; end < impl->end_states_.size(); ++end)
+			if (impl->pairStatus(start, end) == ConnectingPrivate::PENDING)
+				pairs.emplace_back(impl->start_states_[start], impl->end_states_[end]);
+	}
+	std::stable_sort(pairs.begin(), pairs.end());
+	for (const auto& candidate : pairs) {
 		size_t first = getIndex(*impl->starts(), candidate.first);
 		size_t second = getIndex(*impl->ends(), candidate.second);
 		os << InterfaceState::colorForStatus(candidate.first->priority().status()) << first << reset << ":"
 		   << InterfaceState::colorForStatus(candidate.second->priority().status()) << second << reset << " ";
 	}
-	if (impl->pending.empty())
+	if (pairs.empty())
 		os << "---";
 	return os;
 }
 
-Connecting::Connecting(const std::string& name) : ComputeBase(new ConnectingPrivate(this, name)) {}
+Connecting::Connecting(const std::string& name) : ComputeBase(new ConnectingPrivate(this, name)) {
+	properties().declare<uint32_t>("max_concurrent_pairs", 1u, "number of best pending pairs computed concurrently");
+	properties().declare<uint32_t>("nearest_candidates", 1u,
+	                               "number of best pending pairs among which the one with the closest states is computed");
+}
 
 void Connecting::reset() {
-	pimpl()->pending.clear();
+	auto impl = pimpl();
+	impl->pending.clear();
+	impl->parked_.clear();
+	impl->state_ids_.clear();
+	impl->start_states_.clear();
+	impl->end_states_.clear();
+	impl->pair_status_.clear();
+	impl->open_pairs_.clear();
+	impl->frontier_.clear();
+	impl->frontier_changes_ = std::make_pair(SIZE_MAX, SIZE_MAX);
+	impl->scene_signatures_.clear();
 	ComputeBase::reset();
 }
 
@@ -918,6 +2063,10 @@ bool Connecting::compatible(const InterfaceState& from_state, const InterfaceSta
 		return false;
 	};
 
+	// cheap check first: signatures differ if objects or their shapes don't match
+	if (pimpl()->sceneSignature(from_state) != pimpl()->sceneSignature(to_state))
+		return false_with_debug("{}: different collision objects or attached bodies", name());
+
 	if (from->getWorld()->size() != to->getWorld()->size())
 		return false_with_debug("{}: different number of collision objects", name());
 
@@ -928,6 +2077,8 @@ bool Connecting::compatible(const InterfaceState& from_state, const InterfaceSta
 		const collision_detection::World::ObjectConstPtr& to_object = to->getWorld()->getObject(from_object_name);
 		if (!to_object)
 			return false_with_debug("{}: object missing: {}", name(), from_object_name);
+		if (to_object == from_object)
+			continue;  // scene diffs share unmodified objects
 
 		if (!(from_object->pose_.matrix() - to_object->pose_.matrix()).isZero(1e-4))
 			return false_with_debug("{}: different object pose: {}", name(), from_object_name);
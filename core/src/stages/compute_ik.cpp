@@ -35,8 +35,10 @@
 /* Authors: Robert Haschke, Michael Goerner */
 
 #include <moveit/task_constructor/stages/compute_ik.h>
+#include <moveit/task_constructor/kinematics_pool.h>
 #include <moveit/task_constructor/storage.h>
 #include <moveit/task_constructor/marker_tools.h>
+#include <moveit/task_constructor/solvers/planner_interface.h>
 #include <moveit/task_constructor/fmt_p.h>
 
 #include <moveit/planning_scene/planning_scene.h>
@@ -45,21 +47,33 @@
 
 #include <Eigen/Geometry>
 #include <tf2_eigen/tf2_eigen.h>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <boost/optional.hpp>
 #include <ros/console.h>
 
 namespace moveit {
 namespace task_constructor {
 namespace stages {
 
-ComputeIK::ComputeIK(const std::string& name, Stage::pointer&& child) : WrapperBase(name, std::move(child)) {
+ComputeIK::ComputeIK(const std::string& name, Stage::pointer&& child)
+  : WrapperBase(name, std::move(child)), kinematics_pool_(std::make_shared<KinematicsPool>()) {
 	auto& p = properties();
 	p.declare<std::string>("eef", "name of end-effector group");
 	p.declare<std::string>("group", "name of active group (derived from eef if not provided)");
 	p.declare<std::string>("default_pose", "", "default joint pose of active group (defines cost of IK)");
 	p.declare<uint32_t>("max_ik_solutions", 1);
+	p.declare<uint32_t>("seed_cache_size", 0,
+	                    "number of previous IK solutions kept to seed IK of nearby targets (0 disables caching)");
+	p.declare<uint32_t>("max_batch_size", 1, "maximum number of upstream solutions processed per compute() call");
+	p.declare<bool>("diverse_seeds", false,
+	                "spread IK seeds over the group's joint space and search them in parallel (max_ik_solutions > 1)");
 	p.declare<bool>("ignore_collisions", false);
 	p.declare<double>("min_solution_distance", 0.1,
 	                  "minimum distance between seperate IK solutions for the same target");
@@ -68,6 +82,9 @@ ComputeIK::ComputeIK(const std::string& name, Stage::pointer&& child) : WrapperB
 	// ik_frame and target_pose are read from the interface
 	p.declare<geometry_msgs::PoseStamped>("ik_frame", "frame to be moved towards goal pose");
 	p.declare<geometry_msgs::PoseStamped>("target_pose", "goal pose for ik frame");
+	// optional joint seed provided along with target_pose, e.g. by GenerateGraspPoseFromDatabase
+	p.declare<moveit_msgs::RobotState>("ik_seed", moveit_msgs::RobotState(), "joint positions tried first for IK");
+	p.configureInitFrom(Stage::INTERFACE, { "ik_seed" });
 }
 
 void ComputeIK::setIKFrame(const Eigen::Isometry3d& pose, const std::string& link) {
@@ -100,12 +117,15 @@ namespace {
 
 // ??? TODO: provide callback methods in PlanningScene class / probably not very useful here though...
 // TODO: move into MoveIt core, lift active_components_only_ from fcl to common interface
+// Check the end-effector, placed at the given pose, for collisions with the world.
+// acm is expected to allow collisions of the (not yet moved) parent links, see ComputeIK::EEFCollisionBundle
 bool isTargetPoseCollidingInEEF(const planning_scene::PlanningSceneConstPtr& scene,
                                 moveit::core::RobotState& robot_state, Eigen::Isometry3d pose,
-                                const moveit::core::LinkModel* link, const moveit::core::JointModelGroup* jmg = nullptr,
+                                const moveit::core::LinkModel* link, const moveit::core::LinkModel* parent,
+                                const collision_detection::AllowedCollisionMatrix& acm,
+                                const moveit::core::JointModelGroup* jmg = nullptr,
                                 collision_detection::CollisionResult* collision_result = nullptr) {
 	// consider all rigidly connected parent links as well
-	const moveit::core::LinkModel* parent = moveit::core::RobotModel::getRigidlyConnectedParentLinkModel(link);
 	if (parent != link)  // transform pose into pose suitable to place parent
 		pose = pose * robot_state.getGlobalLinkTransform(link).inverse() * robot_state.getGlobalLinkTransform(parent);
 
@@ -113,30 +133,15 @@ bool isTargetPoseCollidingInEEF(const planning_scene::PlanningSceneConstPtr& sce
 	robot_state.updateStateWithLinkAt(parent, pose);
 	robot_state.updateCollisionBodyTransforms();
 
-	// disable collision checking for parent links (except links fixed to root)
-	auto acm = scene->getAllowedCollisionMatrix();
-	std::vector<const std::string*> pending_links;  // parent link names that might be rigidly connected to root
-	while (parent) {
-		pending_links.push_back(&parent->getName());
-		link = parent;
-		const moveit::core::JointModel* joint = link->getParentJointModel();
-		parent = joint->getParentLinkModel();
-
-		if (joint->getType() != moveit::core::JointModel::FIXED) {
-			for (const std::string* name : pending_links)
-				acm.setDefaultEntry(*name, true);
-			pending_links.clear();
-		}
-	}
-
 	// check collision with the world using the padded version
+	// self-collisions are meaningless here, as only the end-effector was moved
 	collision_detection::CollisionRequest req;
 	collision_detection::CollisionResult result;
 	req.contacts = (collision_result != nullptr);
 	if (jmg)
 		req.group_name = jmg->getName();
 	collision_detection::CollisionResult& res = collision_result ? *collision_result : result;
-	scene->checkCollision(req, res, robot_state, acm);
+	scene->getCollisionEnv()->checkRobotCollision(req, res, robot_state, acm);
 	return res.collision;
 }
 
@@ -185,10 +190,269 @@ bool validateGroup(const PropertyMap& props, const moveit::core::RobotModelConst
 	return true;
 }
 
+// value of an optional string property (empty if undefined)
+std::string optionalString(const PropertyMap& props, const std::string& name) {
+	const boost::any& value = props.get(name);
+	return value.empty() ? std::string() : boost::any_cast<std::string>(value);
+}
+
+// lazily generated markers of target and ik frames
+SolutionBase::MarkerGenerator frameMarkers(const geometry_msgs::PoseStamped& target_pose,
+                                           const geometry_msgs::PoseStamped& ik_pose) {
+	return [target_pose, ik_pose](SolutionBase::Markers& markers) {
+		rviz_marker_tools::appendFrame(markers, target_pose, 0.1, "target frame");
+		rviz_marker_tools::appendFrame(markers, ik_pose, 0.1, "ik frame");
+	};
+}
+
+// lazily generated markers of end-effector links placed at the target pose in state
+SolutionBase::MarkerGenerator eefMarkers(const std::shared_ptr<const moveit::core::RobotState>& state,
+                                         const std::vector<const moveit::core::LinkModel*>& links, bool collision,
+                                         const boost::optional<std_msgs::ColorRGBA>& tint = boost::none) {
+	return [state, links, collision, tint](SolutionBase::Markers& markers) {
+		auto appender = [&markers, &tint](visualization_msgs::Marker& marker, const std::string& /*name*/) {
+			marker.ns = "ik target";
+			if (tint)
+				marker.color = *tint;
+			else
+				marker.color.a *= 0.5;
+			markers.push_back(marker);
+		};
+		if (collision)
+			generateCollisionMarkers(*state, appender, links);
+		else
+			generateVisualMarkers(*state, appender, links);
+	};
+}
+
+// IK query for a single upstream solution: prepared and reported serially, but solved concurrently
+struct IKQuery
+{
+	const SolutionBase* upstream;
+	planning_scene::PlanningSceneConstPtr scene;
+	const moveit::core::JointModelGroup* jmg;
+	const moveit::core::LinkModel* link;
+	Eigen::Isometry3d target_pose;
+	std::unique_ptr<moveit::core::RobotState> sandbox_state;  // private state of the query's IK search
+	std::vector<std::unique_ptr<moveit::core::RobotState>> branch_states;  // private states of additional searches
+	SolutionBase::MarkerGenerator frame_markers;
+	std::shared_ptr<const moveit::core::RobotState> eef_state;  // end-effector placed at target pose, for markers
+	std::vector<const moveit::core::LinkModel*> eef_links;
+	std::vector<double> compare_pose;
+	std::unique_ptr<kinematic_constraints::KinematicConstraintSet> constraint_set;
+	std::vector<std::vector<double>> seeds;  // cached solutions of nearby targets, tried first
+	std::vector<std::vector<double>> strata;  // diverse seeds, tried before random restarts
+	KinematicsPool* kinematics;  // leasing a solver instance to each concurrent IK search
+	IKCache* cache = nullptr;
+	IKCache::Key cache_key = 0;
+	IKCache::Solutions cached;  // validated solutions of a matching target, tried before IK
+	bool ignore_collisions;
+	double min_solution_distance;
+	uint32_t max_ik_solutions;
+	double timeout;
+	IKSolutions ik_solutions;  // shared by all branches of the search, guarded by mutex
+	std::unique_ptr<std::mutex> mutex = std::make_unique<std::mutex>();
+};
+
+// distance measure between target poses to find nearby cached IK seeds
+double poseDistance(const Eigen::Isometry3d& a, const Eigen::Isometry3d& b) {
+	// weight rotations such that 1 rad corresponds to 0.1 m
+	const double angle = Eigen::AngleAxisd(a.linear().transpose() * b.linear()).angle();
+	return (a.translation() - b.translation()).norm() + 0.1 * angle;
+}
+
+// Latin hypercube sampling of count seeds: the range of each single-variable joint is split into count strata,
+// each of which is covered by exactly one seed. Other variables are sampled randomly.
+std::vector<std::vector<double>> stratifiedSeeds(moveit::core::RobotState& state,
+                                                 const moveit::core::JointModelGroup* jmg, size_t count) {
+	std::vector<std::vector<double>> seeds(count);
+	for (auto& seed : seeds) {
+		state.setToRandomPositions(jmg);
+		state.copyJointGroupPositions(jmg, seed);
+	}
+
+	random_numbers::RandomNumberGenerator& rng = state.getRandomNumberGenerator();
+	std::vector<size_t> order(count);
+	for (const moveit::core::JointModel* joint : jmg->getActiveJointModels()) {
+		if (joint->getVariableCount() != 1)
+			continue;
+		const moveit::core::VariableBounds& bounds = joint->getVariableBounds()[0];
+		const double lower = bounds.min_position_;
+		const double upper = bounds.max_position_;
+		if (!std::isfinite(lower) || !std::isfinite(upper) || upper <= lower)
+			continue;
+		const int index = jmg->getVariableGroupIndex(joint->getName());
+
+		// random permutation of strata
+		std::iota(order.begin(), order.end(), 0);
+		for (size_t i = count - 1; i > 0; --i)
+			std::swap(order[i], order[rng.uniformInteger(0, static_cast<int>(i))]);
+		for (size_t k = 0; k < count; ++k)
+			seeds[k][index] = lower + (order[k] + rng.uniform01()) / count * (upper - lower);
+	}
+	return seeds;
+}
+
+// search for (up to max_ik_solutions) IK solutions of a query, only touching the query itself
+// The search might be split into several branches, running concurrently using their own sandbox states.
+void solveIK(IKQuery& q, size_t branch = 0, size_t num_branches = 1) {
+	auto is_duplicate = [&q](const moveit::core::JointModelGroup* jmg, const double* joint_positions) {
+		for (const auto& sol : q.ik_solutions) {
+			if (jmg->distance(joint_positions, sol.joint_positions.data()) < q.min_solution_distance)
+				return true;
+		}
+		return false;
+	};
+	auto is_complete = [&q] {
+		std::lock_guard<std::mutex> lock(*q.mutex);
+		return q.ik_solutions.size() >= q.max_ik_solutions;
+	};
+	auto is_valid = [&q, &is_duplicate](moveit::core::RobotState* state, const moveit::core::JointModelGroup* jmg,
+	                                    const double* joint_positions) {
+		if (solvers::PlannerCancellation::cancelled())
+			return false;  // skip expensive validation, the search is aborted anyway
+		{
+			std::lock_guard<std::mutex> lock(*q.mutex);
+			if (q.ik_solutions.size() >= q.max_ik_solutions)
+				return true;  // another branch completed the search, stop IK
+			if (is_duplicate(jmg, joint_positions))
+				return false;  // too close to already found solution
+		}
+		state->setJointGroupPositions(jmg, joint_positions);
+		state->update();
+
+		IKSolution solution;
+		state->copyJointGroupPositions(jmg, solution.joint_positions);
+
+		// validate constraints
+		solution.satisfies_constraints = q.constraint_set->decide(*state).satisfied;
+
+		// check for collisions
+		collision_detection::CollisionRequest req;
+		collision_detection::CollisionResult res;
+		req.contacts = true;
+		req.max_contacts = 1;
+		req.group_name = jmg->getName();
+		q.scene->checkCollision(req, res, *state);
+		solution.collision_free = q.ignore_collisions || !res.collision;
+		if (!res.contacts.empty()) {
+			solution.contact = res.contacts.begin()->second.front();
+		}
+		const bool valid = solution.satisfies_constraints && solution.collision_free;
+
+		// other branches might have found a similar solution meanwhile
+		std::lock_guard<std::mutex> lock(*q.mutex);
+		if (q.ik_solutions.size() >= q.max_ik_solutions)
+			return true;
+		if (is_duplicate(jmg, solution.joint_positions.data()))
+			return false;
+		q.ik_solutions.push_back(std::move(solution));
+		return valid;
+	};
+
+	const bool primary = branch == 0;  // primary branch tries cached solutions, seeds, and current state
+	moveit::core::RobotState& sandbox_state = primary ? *q.sandbox_state : *q.branch_states[branch - 1];
+
+	// cached solutions of a matching target might render IK unnecessary
+	if (primary && !q.cached.empty()) {
+		moveit::core::RobotState state(sandbox_state);
+		for (const auto& cached : q.cached) {
+			if (is_complete())
+				return;
+			if (cached.size() != q.jmg->getVariableCount())
+				continue;
+			state.setJointGroupPositions(q.jmg, cached);
+			state.update();
+			if (q.cache->matches(state.getGlobalLinkTransform(q.link), q.target_pose))
+				is_valid(&state, q.jmg, cached.data());
+		}
+	}
+
+	// seed order: cached seeds, current state, diverse seeds, random restarts
+	size_t attempt = primary ? 0 : q.seeds.size() + 1;
+	size_t stratum = branch;
+	std::vector<double> random_seed;
+
+	double remaining_time = q.timeout;
+	auto start_time = std::chrono::steady_clock::now();
+	while (!is_complete() && remaining_time > 0) {
+		if (solvers::PlannerCancellation::cancelled())
+			break;
+		if (attempt < q.seeds.size()) {
+			sandbox_state.setJointGroupPositions(q.jmg, q.seeds[attempt]);
+			sandbox_state.update();
+		} else if (attempt > q.seeds.size() && stratum < q.strata.size()) {
+			sandbox_state.setJointGroupPositions(q.jmg, q.strata[stratum]);
+			sandbox_state.update();
+			stratum += num_branches;
+		} else if (attempt > q.seeds.size()) {
+			sandbox_state.setToRandomPositions(q.jmg);
+			if (!q.strata.empty()) {
+				// with diverse seeding, avoid restarts close to found solutions, likely converging to them again
+				for (size_t trial = 0; trial < 10; ++trial) {
+					sandbox_state.copyJointGroupPositions(q.jmg, random_seed);
+					std::lock_guard<std::mutex> lock(*q.mutex);
+					if (!is_duplicate(q.jmg, random_seed.data()))
+						break;
+					sandbox_state.setToRandomPositions(q.jmg);
+				}
+			}
+			sandbox_state.update();
+		} else if (attempt > 0) {  // revert to current state after trying cached seeds
+			std::vector<double> current;
+			q.scene->getCurrentState().copyJointGroupPositions(q.jmg, current);
+			sandbox_state.setJointGroupPositions(q.jmg, current);
+			sandbox_state.update();
+		}
+		++attempt;
+
+		// concurrent branches and batched queries use their own solver instance
+		bool succeeded =
+		    q.kinematics->setFromIK(sandbox_state, q.jmg, q.target_pose, q.link->getName(), remaining_time, is_valid);
+
+		auto now = std::chrono::steady_clock::now();
+		remaining_time -= std::chrono::duration<double>(now - start_time).count();
+		start_time = now;
+
+		// TODO: magic constant should be a property instead ("current_seed_only", or equivalent)
+		// Yeah, you are right, these are two different semantic concepts:
+		// One could also have multiple IK solutions derived from the same seed
+		if (!succeeded && q.max_ik_solutions == 1 && attempt > q.seeds.size())
+			break;  // all non-random seeds failed
+	}
+}
 }  // anonymous namespace
 
+const ComputeIK::EEFCollisionBundle& ComputeIK::eefCollisionBundle(const moveit::core::LinkModel* link) {
+	if (eef_bundle_.link == link)
+		return eef_bundle_;
+
+	EEFCollisionBundle& bundle = eef_bundle_;
+	bundle.link = link;
+	bundle.parent = moveit::core::RobotModel::getRigidlyConnectedParentLinkModel(link);
+	bundle.links = bundle.parent->getParentJointModel()->getDescendantLinkModels();
+
+	// disable collision checking for parent links (except links fixed to root)
+	bundle.disabled_links.clear();
+	std::vector<const std::string*> pending_links;  // parent link names that might be rigidly connected to root
+	for (const moveit::core::LinkModel* parent = bundle.parent; parent;) {
+		pending_links.push_back(&parent->getName());
+		const moveit::core::JointModel* joint = parent->getParentJointModel();
+		parent = joint->getParentLinkModel();
+
+		if (joint->getType() != moveit::core::JointModel::FIXED) {
+			for (const std::string* name : pending_links)
+				bundle.disabled_links.push_back(*name);
+			pending_links.clear();
+		}
+	}
+	return bundle;
+}
+
 void ComputeIK::reset() {
 	upstream_solutions_.clear();
+	seed_cache_.clear();
+	eef_bundle_ = EEFCollisionBundle();
 	WrapperBase::reset();
 }
 
@@ -212,6 +476,16 @@ void ComputeIK::init(const moveit::core::RobotModelConstPtr& robot_model) {
 	if (!validateGroup(props, robot_model, eef_jmg, jmg, &msg))
 		errors.push_back(*this, msg);
 
+	// precompute the end-effector's collision bundle if the IK link is already known
+	eef_bundle_ = EEFCollisionBundle();
+	if (!errors && props.get("ik_frame").empty() && (eef_jmg || jmg)) {
+		const moveit::core::LinkModel* link = eef_jmg ?
+		                                          robot_model->getLinkModel(eef_jmg->getEndEffectorParentGroup().second) :
+		                                          jmg->getOnlyOneEndEffectorTip();
+		if (link)
+			eefCollisionBundle(link);
+	}
+
 	if (errors)
 		throw errors;
 }
@@ -235,246 +509,329 @@ void ComputeIK::compute() {
 	if (upstream_solutions_.empty())
 		return;
 
-	const SolutionBase& s = *upstream_solutions_.pop();
-
-	// -1 TODO: this should not be necessary in my opinion: Why do you think so?
-	// It is, because the properties on the interface might change from call to call...
-	// enforced initialization from interface ensures that new target_pose is read
-	properties().performInitFrom(INTERFACE, s.start()->properties());
-	const auto& props = properties();
+	// drain a batch of upstream solutions
+	const uint32_t max_batch_size = std::max<uint32_t>(1, max_batch_size_.get(properties()));
+	std::vector<const SolutionBase*> batch;
+	while (batch.size() < max_batch_size && !upstream_solutions_.empty())
+		batch.push_back(upstream_solutions_.pop());
 
-	const planning_scene::PlanningSceneConstPtr& scene{ s.start()->scene() };
-
-	const bool ignore_collisions = props.get<bool>("ignore_collisions");
-	const auto& robot_model = scene->getRobotModel();
+	// eef / group resolution, reused for all targets sharing the same values
+	moveit::core::RobotModelConstPtr resolved_model;
+	std::string resolved_eef, resolved_group;
 	const moveit::core::JointModelGroup* eef_jmg = nullptr;
 	const moveit::core::JointModelGroup* jmg = nullptr;
-	std::string msg;
-
-	if (!validateEEF(props, robot_model, eef_jmg, &msg)) {
-		ROS_WARN_STREAM_NAMED("ComputeIK", msg);
-		return;
-	}
-	if (!validateGroup(props, robot_model, eef_jmg, jmg, &msg)) {
-		ROS_WARN_STREAM_NAMED("ComputeIK", msg);
-		return;
-	}
-	if (!eef_jmg && !jmg) {
-		ROS_WARN_STREAM_NAMED("ComputeIK", "Neither eef nor group are well defined");
-		return;
-	}
-	properties().property("timeout").setDefaultValue(jmg->getDefaultIKTimeout());
-
-	// extract target_pose
-	geometry_msgs::PoseStamped target_pose_msg = props.get<geometry_msgs::PoseStamped>("target_pose");
-	if (target_pose_msg.header.frame_id.empty())  // if not provided, assume planning frame
-		target_pose_msg.header.frame_id = scene->getPlanningFrame();
-
-	Eigen::Isometry3d target_pose;
-	tf2::fromMsg(target_pose_msg.pose, target_pose);
-	if (target_pose_msg.header.frame_id != scene->getPlanningFrame()) {
-		if (!scene->knowsFrameTransform(target_pose_msg.header.frame_id)) {
-			ROS_WARN_STREAM_NAMED("ComputeIK",
-			                      "Unknown reference frame for target pose: " << target_pose_msg.header.frame_id);
-			return;
-		}
-		// transform target_pose w.r.t. planning frame
-		target_pose = scene->getFrameTransform(target_pose_msg.header.frame_id) * target_pose;
-	}
-
-	// determine IK link from ik_frame
+	// ik frame resolution, reused for all targets sharing the same ik_frame and scene
+	planning_scene::PlanningSceneConstPtr resolved_scene;
+	boost::optional<geometry_msgs::PoseStamped> resolved_ik_frame;
 	const moveit::core::LinkModel* link = nullptr;
 	geometry_msgs::PoseStamped ik_pose_msg;
-	const boost::any& value = props.get("ik_frame");
-	if (value.empty()) {  // property undefined
-		//  determine IK link from eef/group
-		if (!(link = eef_jmg ? robot_model->getLinkModel(eef_jmg->getEndEffectorParentGroup().second) :
-                             jmg->getOnlyOneEndEffectorTip())) {
-			ROS_WARN_STREAM_NAMED("ComputeIK", "Failed to derive IK target link");
-			return;
+	Eigen::Isometry3d ik_offset = Eigen::Isometry3d::Identity();  // transform from ik frame to link
+	// collision matrix for the end-effector check, reused for all targets sharing the same scene and link
+	planning_scene::PlanningSceneConstPtr acm_scene;
+	const moveit::core::LinkModel* acm_link = nullptr;
+	collision_detection::AllowedCollisionMatrix acm;
+	// collision signature for the IK cache, reused for all targets sharing the same scene and group
+	planning_scene::PlanningSceneConstPtr signature_scene;
+	const moveit::core::JointModelGroup* signature_jmg = nullptr;
+	std::size_t signature = 0;
+
+	std::vector<IKQuery> queries;
+	queries.reserve(batch.size());
+	for (const SolutionBase* upstream : batch) {
+		const SolutionBase& s = *upstream;
+
+		// -1 TODO: this should not be necessary in my opinion: Why do you think so?
+		// It is, because the properties on the interface might change from call to call...
+		// enforced initialization from interface ensures that new target_pose is read
+		properties().performInitFrom(INTERFACE, s.start()->properties());
+		const auto& props = properties();
+
+		const planning_scene::PlanningSceneConstPtr& scene{ s.start()->scene() };
+
+		const bool ignore_collisions = ignore_collisions_.get(props);
+		const auto& robot_model = scene->getRobotModel();
+		std::string msg;
+
+		std::string eef = optionalString(props, "eef");
+		std::string group = optionalString(props, "group");
+		if (!resolved_model || robot_model != resolved_model || eef != resolved_eef || group != resolved_group) {
+			resolved_model.reset();
+			resolved_scene.reset();  // ik link depends on eef / group
+			eef_jmg = jmg = nullptr;
+			if (!validateEEF(props, robot_model, eef_jmg, &msg)) {
+				ROS_WARN_STREAM_NAMED("ComputeIK", msg);
+				continue;
+			}
+			if (!validateGroup(props, robot_model, eef_jmg, jmg, &msg)) {
+				ROS_WARN_STREAM_NAMED("ComputeIK", msg);
+				continue;
+			}
+			if (!eef_jmg && !jmg) {
+				ROS_WARN_STREAM_NAMED("ComputeIK", "Neither eef nor group are well defined");
+				continue;
+			}
+			resolved_model = robot_model;
+			resolved_eef = std::move(eef);
+			resolved_group = std::move(group);
 		}
-		ik_pose_msg.header.frame_id = link->getName();
-		ik_pose_msg.pose.orientation.w = 1.0;
-	} else {
-		ik_pose_msg = boost::any_cast<geometry_msgs::PoseStamped>(value);
-		Eigen::Isometry3d ik_pose;
-		tf2::fromMsg(ik_pose_msg.pose, ik_pose);
-
-		if (!scene->getCurrentState().knowsFrameTransform(ik_pose_msg.header.frame_id)) {
-			ROS_WARN_STREAM_NAMED("ComputeIK",
-			                      fmt::format("ik frame unknown in robot: '{}'", ik_pose_msg.header.frame_id));
-			return;
+		properties().property("timeout").setDefaultValue(jmg->getDefaultIKTimeout());
+
+		// extract target_pose
+		geometry_msgs::PoseStamped target_pose_msg = target_pose_.get(props);
+		if (target_pose_msg.header.frame_id.empty())  // if not provided, assume planning frame
+			target_pose_msg.header.frame_id = scene->getPlanningFrame();
+
+		Eigen::Isometry3d target_pose;
+		tf2::fromMsg(target_pose_msg.pose, target_pose);
+		if (target_pose_msg.header.frame_id != scene->getPlanningFrame()) {
+			if (!scene->knowsFrameTransform(target_pose_msg.header.frame_id)) {
+				ROS_WARN_STREAM_NAMED("ComputeIK",
+				                      "Unknown reference frame for target pose: " << target_pose_msg.header.frame_id);
+				continue;
+			}
+			// transform target_pose w.r.t. planning frame
+			target_pose = scene->getFrameTransform(target_pose_msg.header.frame_id) * target_pose;
 		}
-		ik_pose = scene->getCurrentState().getFrameTransform(ik_pose_msg.header.frame_id) * ik_pose;
-
-		link = scene->getCurrentState().getRigidlyConnectedParentLinkModel(ik_pose_msg.header.frame_id);
-
-		// transform target pose such that ik frame will reach there if link does
-		target_pose = target_pose * ik_pose.inverse() * scene->getCurrentState().getFrameTransform(link->getName());
-	}
 
-	// validate placed link for collisions
-	collision_detection::CollisionResult collisions;
-	moveit::core::RobotState sandbox_state{ scene->getCurrentState() };
-	bool colliding =
-	    !ignore_collisions && isTargetPoseCollidingInEEF(scene, sandbox_state, target_pose, link, jmg, &collisions);
-
-	// frames at target pose and ik frame
-	std::deque<visualization_msgs::Marker> frame_markers;
-	rviz_marker_tools::appendFrame(frame_markers, target_pose_msg, 0.1, "target frame");
-	rviz_marker_tools::appendFrame(frame_markers, ik_pose_msg, 0.1, "ik frame");
-	// end-effector markers
-	std::deque<visualization_msgs::Marker> eef_markers;
-	// visualize placed end-effector
-	auto appender = [&eef_markers](visualization_msgs::Marker& marker, const std::string& /*name*/) {
-		marker.ns = "ik target";
-		marker.color.a *= 0.5;
-		eef_markers.push_back(marker);
-	};
-	const auto& links_to_visualize = moveit::core::RobotModel::getRigidlyConnectedParentLinkModel(link)
-	                                     ->getParentJointModel()
-	                                     ->getDescendantLinkModels();
-	if (colliding) {
-		SubTrajectory solution;
-		std::copy(frame_markers.begin(), frame_markers.end(), std::back_inserter(solution.markers()));
-		generateCollisionMarkers(sandbox_state, appender, links_to_visualize);
-		std::copy(eef_markers.begin(), eef_markers.end(), std::back_inserter(solution.markers()));
-		solution.markAsFailure();
-		// TODO: visualize collisions
-		solution.setComment(s.comment() + " eef in collision: " + listCollisionPairs(collisions.contacts, ", "));
-		auto colliding_scene{ scene->diff() };
-		colliding_scene->setCurrentState(sandbox_state);
-		spawn(InterfaceState(colliding_scene), std::move(solution));
-		return;
-	} else
-		generateVisualMarkers(sandbox_state, appender, links_to_visualize);
-
-	// determine joint values of robot pose to compare IK solution with for costs
-	std::vector<double> compare_pose;
-	const std::string& compare_pose_name = props.get<std::string>("default_pose");
-	if (!compare_pose_name.empty()) {
-		moveit::core::RobotState compare_state(robot_model);
-		compare_state.setToDefaultValues(jmg, compare_pose_name);
-		compare_state.copyJointGroupPositions(jmg, compare_pose);
-	} else
-		scene->getCurrentState().copyJointGroupPositions(jmg, compare_pose);
-
-	double min_solution_distance = props.get<double>("min_solution_distance");
-
-	kinematic_constraints::KinematicConstraintSet constraint_set(robot_model);
-	constraint_set.add(props.get<moveit_msgs::Constraints>("constraints"), scene->getTransforms());
-
-	IKSolutions ik_solutions;
-	auto is_valid = [scene, ignore_collisions, min_solution_distance, &constraint_set = std::as_const(constraint_set),
-	                 &ik_solutions](moveit::core::RobotState* state, const moveit::core::JointModelGroup* jmg,
-	                                const double* joint_positions) {
-		for (const auto& sol : ik_solutions) {
-			if (jmg->distance(joint_positions, sol.joint_positions.data()) < min_solution_distance)
-				return false;  // too close to already found solution
+		// determine IK link from ik_frame
+		const boost::any& value = props.get("ik_frame");
+		boost::optional<geometry_msgs::PoseStamped> ik_frame;
+		if (!value.empty())
+			ik_frame = boost::any_cast<geometry_msgs::PoseStamped>(value);
+		if (!resolved_scene || scene != resolved_scene || ik_frame != resolved_ik_frame) {
+			resolved_scene.reset();
+			if (!ik_frame) {  // property undefined
+				//  determine IK link from eef/group
+				if (!(link = eef_jmg ? robot_model->getLinkModel(eef_jmg->getEndEffectorParentGroup().second) :
+                                     jmg->getOnlyOneEndEffectorTip())) {
+					ROS_WARN_STREAM_NAMED("ComputeIK", "Failed to derive IK target link");
+					continue;
+				}
+				ik_pose_msg = geometry_msgs::PoseStamped();
+				ik_pose_msg.header.frame_id = link->getName();
+				ik_pose_msg.pose.orientation.w = 1.0;
+				ik_offset.setIdentity();
+			} else {
+				ik_pose_msg = *ik_frame;
+				Eigen::Isometry3d ik_pose;
+				tf2::fromMsg(ik_pose_msg.pose, ik_pose);
+
+				if (!scene->getCurrentState().knowsFrameTransform(ik_pose_msg.header.frame_id)) {
+					ROS_WARN_STREAM_NAMED("ComputeIK",
+					                      fmt::format("ik frame unknown in robot: '{}'", ik_pose_msg.header.frame_id));
+					continue;
+				}
+				ik_pose = scene->getCurrentState().getFrameTransform(ik_pose_msg.header.frame_id) * ik_pose;
+
+				link = scene->getCurrentState().getRigidlyConnectedParentLinkModel(ik_pose_msg.header.frame_id);
+
+				// transform target pose such that ik frame will reach there if link does
+				ik_offset = ik_pose.inverse() * scene->getCurrentState().getFrameTransform(link->getName());
+			}
+			resolved_scene = scene;
+			resolved_ik_frame = std::move(ik_frame);
+		}
+		target_pose = target_pose * ik_offset;
+
+		// validate placed link for collisions
+		const EEFCollisionBundle& bundle = eefCollisionBundle(link);
+		collision_detection::CollisionResult collisions;
+		auto sandbox_state = std::make_unique<moveit::core::RobotState>(scene->getCurrentState());
+		bool colliding = false;
+		if (!ignore_collisions) {
+			if (scene != acm_scene || link != acm_link) {
+				acm = scene->getAllowedCollisionMatrix();
+				for (const std::string& name : bundle.disabled_links)
+					acm.setDefaultEntry(name, true);
+				acm_scene = scene;
+				acm_link = link;
+			}
+			colliding =
+			    isTargetPoseCollidingInEEF(scene, *sandbox_state, target_pose, link, bundle.parent, acm, jmg, &collisions);
 		}
-		state->setJointGroupPositions(jmg, joint_positions);
-		state->update();
-
-		ik_solutions.emplace_back();
-		auto& solution{ ik_solutions.back() };
-		state->copyJointGroupPositions(jmg, solution.joint_positions);
 
-		// validate constraints
-		solution.satisfies_constraints = constraint_set.decide(*state).satisfied;
+		// markers of frames at target pose and ik frame, as well as of the placed end-effector,
+		// are only generated when needed, e.g. for introspection
+		auto frame_markers = frameMarkers(target_pose_msg, ik_pose_msg);
+		auto eef_state = std::make_shared<const moveit::core::RobotState>(*sandbox_state);
+		if (colliding) {
+			SubTrajectory solution;
+			solution.addMarkerGenerator(std::move(frame_markers));
+			solution.addMarkerGenerator(eefMarkers(eef_state, bundle.links, true));
+			solution.markAsFailure();
+			// TODO: visualize collisions
+			solution.setComment(s.comment() + " eef in collision");
+			solution.setCommentGenerator([contacts = std::move(collisions.contacts)] {
+				return ": " + listCollisionPairs(contacts, ", ");
+			});
+			auto colliding_scene{ scene->diff() };
+			colliding_scene->setCurrentState(*sandbox_state);
+			spawn(InterfaceState(colliding_scene), std::move(solution));
+			continue;
+		}
 
-		// check for collisions
-		collision_detection::CollisionRequest req;
-		collision_detection::CollisionResult res;
-		req.contacts = true;
-		req.max_contacts = 1;
-		req.group_name = jmg->getName();
-		scene->checkCollision(req, res, *state);
-		solution.collision_free = ignore_collisions || !res.collision;
-		if (!res.contacts.empty()) {
-			solution.contact = res.contacts.begin()->second.front();
+		IKQuery q;
+		q.upstream = upstream;
+		q.scene = scene;
+		q.jmg = jmg;
+		q.link = link;
+		q.target_pose = target_pose;
+		q.sandbox_state = std::move(sandbox_state);
+		q.frame_markers = std::move(frame_markers);
+		q.eef_state = std::move(eef_state);
+		q.eef_links = bundle.links;
+		q.ignore_collisions = ignore_collisions;
+		q.min_solution_distance = min_solution_distance_.get(props);
+		q.max_ik_solutions = max_ik_solutions_.get(props);
+		q.timeout = timeout();
+		q.kinematics = kinematics_pool_.get();
+
+		if (ik_cache_) {
+			if (scene != signature_scene || jmg != signature_jmg) {
+				signature = IKCache::collisionSignature(*scene, jmg);
+				signature_scene = scene;
+				signature_jmg = jmg;
+			}
+			q.cache = ik_cache_.get();
+			q.cache_key = ik_cache_->computeKey(jmg, link, target_pose, signature);
+			ik_cache_->lookup(q.cache_key, q.cached);
 		}
 
-		return solution.satisfies_constraints && solution.collision_free;
-	};
+		// a seed provided by the interface is tried first, if it covers all variables of the group
+		const moveit_msgs::RobotState& ik_seed = ik_seed_.get(props);
+		if (!ik_seed.joint_state.name.empty()) {
+			const auto& names = ik_seed.joint_state.name;
+			std::vector<double> seed;
+			for (const std::string& variable : jmg->getVariableNames()) {
+				auto it = std::find(names.begin(), names.end(), variable);
+				if (it == names.end() || static_cast<size_t>(it - names.begin()) >= ik_seed.joint_state.position.size())
+					break;
+				seed.push_back(ik_seed.joint_state.position[it - names.begin()]);
+			}
+			if (seed.size() == jmg->getVariableCount())
+				q.seeds.push_back(std::move(seed));
+		}
 
-	uint32_t max_ik_solutions = props.get<uint32_t>("max_ik_solutions");
-	bool tried_current_state_as_seed = false;
+		// select seeds from the IK solutions of the nearest previously solved targets
+		if (seed_cache_size_.get(props) > 0) {
+			std::vector<std::pair<double, const IKSeed*>> candidates;
+			for (const IKSeed& seed : seed_cache_)
+				if (seed.jmg == jmg && seed.link == link)
+					candidates.emplace_back(poseDistance(seed.target_pose, target_pose), &seed);
+			const size_t num_seeds = std::min<size_t>(q.max_ik_solutions, candidates.size());
+			std::partial_sort(candidates.begin(), candidates.begin() + num_seeds, candidates.end(),
+			                  [](const auto& a, const auto& b) { return a.first < b.first; });
+			for (size_t i = 0; i < num_seeds; ++i)
+				q.seeds.push_back(candidates[i].second->joint_positions);
+		}
 
-	double remaining_time = timeout();
-	auto start_time = std::chrono::steady_clock::now();
-	while (ik_solutions.size() < max_ik_solutions && remaining_time > 0) {
-		if (tried_current_state_as_seed) {
-			sandbox_state.setToRandomPositions(jmg);
-			sandbox_state.update();
+		// determine joint values of robot pose to compare IK solution with for costs
+		const std::string& compare_pose_name = default_pose_.get(props);
+		if (!compare_pose_name.empty()) {
+			moveit::core::RobotState compare_state(robot_model);
+			compare_state.setToDefaultValues(jmg, compare_pose_name);
+			compare_state.copyJointGroupPositions(jmg, q.compare_pose);
+		} else
+			scene->getCurrentState().copyJointGroupPositions(jmg, q.compare_pose);
+
+		// diverse seeds, searched by concurrent branches in multi-threaded planning
+		if (diverse_seeds_.get(props) && q.max_ik_solutions > 1 && q.cached.size() < q.max_ik_solutions) {
+			moveit::core::RobotState state(*q.sandbox_state);
+			q.strata = stratifiedSeeds(state, jmg, q.max_ik_solutions);
+			const size_t num_branches = std::min<size_t>(q.max_ik_solutions, concurrency());
+			for (size_t branch = 1; branch < num_branches; ++branch)
+				q.branch_states.push_back(std::make_unique<moveit::core::RobotState>(*q.sandbox_state));
 		}
-		tried_current_state_as_seed = true;
 
-		size_t previous = ik_solutions.size();
-		bool succeeded = sandbox_state.setFromIK(jmg, target_pose, link->getName(), remaining_time, is_valid);
+		q.constraint_set = std::make_unique<kinematic_constraints::KinematicConstraintSet>(robot_model);
+		q.constraint_set->add(constraints_.get(props), scene->getTransforms());
 
-		auto now = std::chrono::steady_clock::now();
-		remaining_time -= std::chrono::duration<double>(now - start_time).count();
-		start_time = now;
+		queries.push_back(std::move(q));
+	}
 
+	// IK searches of different targets are independent of each other
+	std::vector<std::function<void()>> jobs;
+	jobs.reserve(queries.size());
+	for (IKQuery& q : queries) {
+		const size_t num_branches = q.branch_states.size() + 1;
+		for (size_t branch = 0; branch < num_branches; ++branch)
+			jobs.emplace_back([&q, branch, num_branches] { solveIK(q, branch, num_branches); });
+	}
+	runConcurrently(std::move(jobs));
+
+	// report results in order of upstream solutions
+	const uint32_t seed_cache_size = seed_cache_size_.get(properties());
+	for (IKQuery& q : queries) {
+		const SolutionBase& s = *q.upstream;
+		// remember valid solutions to warm-start IK of subsequent targets
+		for (const auto& ik_solution : q.ik_solutions) {
+			if (seed_cache_size == 0 || !ik_solution.collision_free || !ik_solution.satisfies_constraints)
+				continue;
+			seed_cache_.push_back(IKSeed{ q.jmg, q.link, q.target_pose, ik_solution.joint_positions });
+			while (seed_cache_.size() > seed_cache_size)
+				seed_cache_.pop_front();
+		}
+		if (q.cache) {
+			IKCache::Solutions valid;
+			for (const auto& ik_solution : q.ik_solutions)
+				if (ik_solution.collision_free && ik_solution.satisfies_constraints)
+					valid.push_back(ik_solution.joint_positions);
+			if (!valid.empty() && valid != q.cached)
+				q.cache->store(q.cache_key, valid);
+		}
 		// for all new solutions (successes and failures)
-		for (size_t i = previous; i != ik_solutions.size(); ++i) {
+		for (const auto& ik_solution : q.ik_solutions) {
 			// create a new scene for each solution as they will have different robot states
-			planning_scene::PlanningScenePtr solution_scene = scene->diff();
+			planning_scene::PlanningScenePtr solution_scene = q.scene->diff();
 			SubTrajectory solution;
 			solution.setComment(s.comment());
-			std::copy(frame_markers.begin(), frame_markers.end(), std::back_inserter(solution.markers()));
+			solution.addMarkerGenerator(SolutionBase::MarkerGenerator(q.frame_markers));
 
-			if (ik_solutions[i].collision_free && ik_solutions[i].satisfies_constraints)
+			if (ik_solution.collision_free && ik_solution.satisfies_constraints)
 				// compute cost as distance to compare_pose
-				solution.setCost(s.cost() + jmg->distance(ik_solutions[i].joint_positions.data(), compare_pose.data()));
-			else if (!ik_solutions[i].collision_free) {  // solution was in collision
-				std::stringstream ss;
-				ss << "Collision between '" << ik_solutions[i].contact.body_name_1 << "' and '"
-				   << ik_solutions[i].contact.body_name_2 << "'";
-				solution.markAsFailure(ss.str());
-			} else if (!ik_solutions[i].satisfies_constraints) {  // solution was violating constraints
+				solution.setCost(s.cost() + q.jmg->distance(ik_solution.joint_positions.data(), q.compare_pose.data()));
+			else if (!ik_solution.collision_free) {  // solution was in collision
+				solution.markAsFailure();
+				solution.setComment("Collision");
+				solution.setCommentGenerator([first = ik_solution.contact.body_name_1,
+				                              second = ik_solution.contact.body_name_2, upstream = s.comment()] {
+					return " between '" + first + "' and '" + second + "'" + (upstream.empty() ? "" : "\n" + upstream);
+				});
+			} else if (!ik_solution.satisfies_constraints) {  // solution was violating constraints
 				solution.markAsFailure("Constraints violated");
 			}
 			// set scene's robot state
 			moveit::core::RobotState& solution_state = solution_scene->getCurrentStateNonConst();
-			solution_state.setJointGroupPositions(jmg, ik_solutions[i].joint_positions.data());
+			solution_state.setJointGroupPositions(q.jmg, ik_solution.joint_positions.data());
 			solution_state.update();
 
 			InterfaceState state(solution_scene);
 			forwardProperties(*s.start(), state);
 
 			// ik target link placement
-			std::copy(eef_markers.begin(), eef_markers.end(), std::back_inserter(solution.markers()));
+			solution.addMarkerGenerator(eefMarkers(q.eef_state, q.eef_links, false));
 
 			spawn(std::move(state), std::move(solution));
 		}
 
-		// TODO: magic constant should be a property instead ("current_seed_only", or equivalent)
-		// Yeah, you are right, these are two different semantic concepts:
-		// One could also have multiple IK solutions derived from the same seed
-		if (!succeeded && max_ik_solutions == 1)
-			break;  // first and only attempt failed
-	}
+		if (q.ik_solutions.empty()) {  // failed to find any solution
+			planning_scene::PlanningScenePtr scene = s.start()->scene()->diff();
+			SubTrajectory solution;
+
+			solution.markAsFailure();
+			solution.setComment(s.comment() + " no IK found");
+			solution.addMarkerGenerator(std::move(q.frame_markers));
 
-	if (ik_solutions.empty()) {  // failed to find any solution
-		planning_scene::PlanningScenePtr scene = s.start()->scene()->diff();
-		SubTrajectory solution;
-
-		solution.markAsFailure();
-		solution.setComment(s.comment() + " no IK found");
-		std::copy(frame_markers.begin(), frame_markers.end(), std::back_inserter(solution.markers()));
-
-		// ik target link placement
-		std_msgs::ColorRGBA tint_color;
-		tint_color.r = 1.0;
-		tint_color.g = 0.0;
-		tint_color.b = 0.0;
-		tint_color.a = 0.5;
-		for (auto& marker : eef_markers)
-			marker.color = tint_color;
-		std::copy(eef_markers.begin(), eef_markers.end(), std::back_inserter(solution.markers()));
-
-		spawn(InterfaceState(scene), std::move(solution));
+			// ik target link placement
+			std_msgs::ColorRGBA tint_color;
+			tint_color.r = 1.0;
+			tint_color.g = 0.0;
+			tint_color.b = 0.0;
+			tint_color.a = 0.5;
+			solution.addMarkerGenerator(eefMarkers(q.eef_state, q.eef_links, false, tint_color));
+
+			spawn(InterfaceState(scene), std::move(solution));
+		}
 	}
 }
 }  // namespace stages
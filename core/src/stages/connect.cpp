@@ -50,6 +50,33 @@ namespace moveit {
 namespace task_constructor {
 namespace stages {
 
+namespace {
+// copy of a group trajectory, with all joints outside the group taken from base
+robot_trajectory::RobotTrajectoryPtr rebase(const robot_trajectory::RobotTrajectory& trajectory,
+                                            const moveit::core::RobotState& base) {
+	const moveit::core::JointModelGroup* jmg = trajectory.getGroup();
+	auto result = std::make_shared<robot_trajectory::RobotTrajectory>(trajectory.getRobotModel(), jmg);
+	std::vector<double> values;
+	for (size_t i = 0; i < trajectory.getWayPointCount(); ++i) {
+		const moveit::core::RobotState& waypoint = trajectory.getWayPoint(i);
+		auto state = std::make_shared<moveit::core::RobotState>(base);
+		waypoint.copyJointGroupPositions(jmg, values);
+		state->setJointGroupPositions(jmg, values);
+		if (waypoint.hasVelocities()) {
+			waypoint.copyJointGroupVelocities(jmg, values);
+			state->setJointGroupVelocities(jmg, values);
+		}
+		if (waypoint.hasAccelerations()) {
+			waypoint.copyJointGroupAccelerations(jmg, values);
+			state->setJointGroupAccelerations(jmg, values);
+		}
+		state->update();
+		result->addSuffixWayPoint(state, trajectory.getWayPointDurationFromPrevious(i));
+	}
+	return result;
+}
+}  // namespace
+
 Connect::Connect(const std::string& name, const GroupPlannerVector& planners) : Connecting(name), planner_(planners) {
 	setTimeout(1.0);
 	setCostTerm(std::make_unique<cost::PathLength>());
@@ -60,13 +87,13 @@ Connect::Connect(const std::string& name, const GroupPlannerVector& planners) :
 	                  "maximally accepted joint configuration distance between trajectory endpoint and goal state");
 	p.declare<moveit_msgs::Constraints>("path_constraints", moveit_msgs::Constraints(),
 	                                    "constraints to maintain during trajectory");
+	p.declare<bool>("plan_groups_concurrently", false, "plan the segments of disjoint groups concurrently");
 	properties().declare<TimeParameterizationPtr>("merge_time_parameterization",
 	                                              std::make_shared<TimeOptimalTrajectoryGeneration>());
 }
 
 void Connect::reset() {
 	Connecting::reset();
-	merged_jmg_.reset();
 	subsolutions_.clear();
 	states_.clear();
 }
@@ -92,9 +119,10 @@ void Connect::init(const core::RobotModelConstPtr& robot_model) {
 		}
 	}
 
-	if (!errors && groups.size() >= 2 && !merged_jmg_) {  // enable merging?
+	merged_jmg_.reset();
+	if (!errors && groups.size() >= 2) {  // enable merging?
 		try {
-			merged_jmg_.reset(task_constructor::merge(groups));
+			merged_jmg_ = task_constructor::mergedGroup(groups);
 		} catch (const std::runtime_error& e) {
 			ROS_INFO_STREAM_NAMED("Connect", fmt::format("{}: {}. Disabling merging.", this->name(), e.what()));
 		}
@@ -136,11 +164,15 @@ bool Connect::compatible(const InterfaceState& from_state, const InterfaceState&
 }
 
 void Connect::compute(const InterfaceState& from, const InterfaceState& to) {
+	computeConcurrently(from, to)();
+}
+
+std::function<void()> Connect::computeConcurrently(const InterfaceState& from, const InterfaceState& to) {
 	const auto& props = properties();
 	double timeout = this->timeout();
-	MergeMode mode = props.get<MergeMode>("merge_mode");
-	double max_distance = props.get<double>("max_distance");
-	const auto& path_constraints = props.get<moveit_msgs::Constraints>("path_constraints");
+	MergeMode mode = merge_mode_.get(props);
+	double max_distance = max_distance_.get(props);
+	const auto& path_constraints = path_constraints_.get(props);
 
 	const moveit::core::RobotState& final_goal_state = to.scene()->getCurrentState();
 	std::vector<robot_trajectory::RobotTrajectoryConstPtr> sub_trajectories;
@@ -149,10 +181,16 @@ void Connect::compute(const InterfaceState& from, const InterfaceState& to) {
 	planning_scene::PlanningSceneConstPtr start = from.scene();
 	intermediate_scenes.push_back(start);
 
+	// segments planned concurrently from the start state (only for disjoint groups)
+	std::vector<robot_trajectory::RobotTrajectoryPtr> concurrent;
+	if (merged_jmg_ && plan_groups_concurrently_.get(props))
+		concurrent = planGroupsConcurrently(from, to);
+
 	bool success = false;
 	std::string comment = "No planners specified";
 	std::vector<double> positions;
-	for (const GroupPlannerVector::value_type& pair : planner_) {
+	for (size_t i = 0; i < planner_.size(); ++i) {
+		const GroupPlannerVector::value_type& pair = planner_[i];
 		// set intermediate goal state
 		planning_scene::PlanningScenePtr end = start->diff();
 		const moveit::core::JointModelGroup* jmg = final_goal_state.getJointModelGroup(pair.first);
@@ -162,15 +200,24 @@ void Connect::compute(const InterfaceState& from, const InterfaceState& to) {
 		goal_state.update();
 		intermediate_scenes.push_back(end);
 
+		// reuse the concurrently planned segment if it is valid from the intermediate start state as well
 		robot_trajectory::RobotTrajectoryPtr trajectory;
-		auto result = pair.second->plan(start, end, jmg, timeout, trajectory, path_constraints);
-		success = bool(result);
+		if (i < concurrent.size() && concurrent[i]) {
+			trajectory = rebase(*concurrent[i], start->getCurrentState());
+			if (!start->isPathValid(*trajectory, path_constraints))
+				trajectory.reset();
+		}
+		if (trajectory)
+			success = true;
+		else {
+			auto result = pair.second->plan(start, end, jmg, timeout, trajectory, path_constraints);
+			success = bool(result);
+			comment = result.message;
+		}
 		sub_trajectories.push_back(trajectory);  // include failed trajectory
 
-		if (!success) {
-			comment = result.message;
+		if (!success)
 			break;
-		}
 
 		if (trajectory->getLastWayPoint().distance(goal_state, jmg) > max_distance) {
 			success = false;
@@ -185,11 +232,49 @@ void Connect::compute(const InterfaceState& from, const InterfaceState& to) {
 	SolutionBasePtr solution;
 	if (success && mode != SEQUENTIAL)  // try to merge
 		solution = merge(sub_trajectories, intermediate_scenes, from.scene()->getCurrentState());
-	if (!solution)  // success == false or merging failed: store sequentially
-		solution = makeSequential(sub_trajectories, intermediate_scenes, from, to);
-	if (!success)  // error during sequential planning
-		solution->markAsFailure(comment);
-	connect(from, to, solution);
+
+	// storing sub solutions (in makeSequential) and connecting needs to be serialized
+	return [this, &from, &to, solution, sub_trajectories = std::move(sub_trajectories),
+	        intermediate_scenes = std::move(intermediate_scenes), success, comment = std::move(comment)]() mutable {
+		if (!solution)  // success == false or merging failed: store sequentially
+			solution = makeSequential(sub_trajectories, intermediate_scenes, from, to);
+		if (!success)  // error during sequential planning
+			solution->markAsFailure(comment);
+		connect(from, to, solution);
+	};
+}
+
+std::vector<robot_trajectory::RobotTrajectoryPtr> Connect::planGroupsConcurrently(const InterfaceState& from,
+                                                                                  const InterfaceState& to) {
+	const auto& props = properties();
+	double timeout = this->timeout();
+	double max_distance = max_distance_.get(props);
+	const auto& path_constraints = path_constraints_.get(props);
+	const moveit::core::RobotState& final_goal_state = to.scene()->getCurrentState();
+
+	std::vector<robot_trajectory::RobotTrajectoryPtr> trajectories(planner_.size());
+	std::vector<std::function<void()>> jobs;
+	jobs.reserve(planner_.size());
+	for (size_t i = 0; i < planner_.size(); ++i) {
+		// goal: start state with only this group moved to its final positions
+		const moveit::core::JointModelGroup* jmg = final_goal_state.getJointModelGroup(planner_[i].first);
+		planning_scene::PlanningScenePtr end = from.scene()->diff();
+		std::vector<double> positions;
+		final_goal_state.copyJointGroupPositions(jmg, positions);
+		moveit::core::RobotState& goal_state = end->getCurrentStateNonConst();
+		goal_state.setJointGroupPositions(jmg, positions);
+		goal_state.update();
+
+		jobs.push_back([&, i, jmg, end = std::move(end)] {
+			robot_trajectory::RobotTrajectoryPtr trajectory;
+			const auto& planner = planner_[i].second;
+			if (planner->plan(from.scene(), end, jmg, timeout, trajectory, path_constraints) &&
+			    trajectory->getLastWayPoint().distance(end->getCurrentState(), jmg) <= max_distance)
+				trajectories[i] = trajectory;
+		});
+	}
+	runConcurrently(std::move(jobs));
+	return trajectories;
 }
 
 SolutionSequencePtr
@@ -205,6 +290,7 @@ Connect::makeSequential(const std::vector<robot_trajectory::RobotTrajectoryConst
 
 	auto scene_it = intermediate_scenes.begin();
 	SolutionSequence::container_type sub_solutions;
+	sub_solutions.reserve(sub_trajectories.size());
 	for (const auto& sub : sub_trajectories) {
 		// persistently store sub solution
 		auto inserted = subsolutions_.insert(subsolutions_.end(), SubTrajectory(sub));
@@ -244,8 +330,7 @@ SubTrajectoryPtr Connect::merge(const std::vector<robot_trajectory::RobotTraject
 		return SubTrajectoryPtr();
 
 	// check merged trajectory for collisions
-	if (!intermediate_scenes.front()->isPathValid(*trajectory,
-	                                              properties().get<moveit_msgs::Constraints>("path_constraints")))
+	if (!intermediate_scenes.front()->isPathValid(*trajectory, path_constraints_.get(properties())))
 		return SubTrajectoryPtr();
 
 	return std::make_shared<SubTrajectory>(trajectory);
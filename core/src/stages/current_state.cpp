@@ -43,6 +43,7 @@
 #include <moveit_msgs/PlanningSceneComponents.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
 #include <ros/ros.h>
 
 namespace moveit {
@@ -63,6 +64,12 @@ void CurrentState::init(const moveit::core::RobotModelConstPtr& robot_model) {
 	Generator::init(robot_model);
 	robot_model_ = robot_model;
 	scene_.reset();
+
+	if (monitor_ && monitor_->getRobotModel() != robot_model) {
+		InitStageException errors;
+		errors.push_back(*this, "PlanningSceneMonitor uses a different robot model");
+		throw errors;
+	}
 }
 
 bool CurrentState::canCompute() const {
@@ -70,6 +77,19 @@ bool CurrentState::canCompute() const {
 }
 
 void CurrentState::compute() {
+	if (monitor_) {
+		planning_scene_monitor::LockedPlanningSceneRO locked(monitor_);
+		if (locked) {
+			// deep copy: the monitored scene keeps changing after releasing the lock
+			scene_ = planning_scene::PlanningScene::clone(locked);
+			spawn(InterfaceState(scene_), 0.0);
+		} else {
+			scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+			ROS_WARN("failed to acquire current PlanningScene from monitor");
+		}
+		return;
+	}
+
 	scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
 
 	ros::NodeHandle h;
@@ -47,6 +47,7 @@
 #include <Eigen/Geometry>
 #include <tf2_eigen/tf2_eigen.h>
 #include <ros/console.h>
+#include <map>
 
 namespace vm = visualization_msgs;
 namespace cd = collision_detection;
@@ -62,16 +63,17 @@ FixCollisionObjects::FixCollisionObjects(const std::string& name) : PropagatingE
 	auto& p = properties();
 	p.declare<double>("max_penetration", "maximally corrected penetration depth");
 	p.declare<geometry_msgs::Vector3>("direction", "direction vector to use for corrections");
+	p.declare<bool>("single_pass", false, "correct all objects from a single collision query, verifying once");
 }
 
 void FixCollisionObjects::computeForward(const InterfaceState& from) {
-	planning_scene::PlanningScenePtr to = from.scene()->diff();
-	sendForward(from, InterfaceState(to), fixCollisions(*to));
+	SceneBuilder to(from.scene());
+	sendForward(from, InterfaceState(to.scene()), fixCollisions(to));
 }
 
 void FixCollisionObjects::computeBackward(const InterfaceState& to) {
-	planning_scene::PlanningScenePtr from = to.scene()->diff();
-	sendBackward(InterfaceState(from), to, fixCollisions(*from));
+	SceneBuilder from(to.scene());
+	sendBackward(InterfaceState(from.scene()), to, fixCollisions(from));
 }
 
 bool computeCorrection(const std::vector<cd::Contact>& contacts, Eigen::Vector3d& correction,
@@ -95,11 +97,13 @@ bool computeCorrection(const std::vector<cd::Contact>& contacts, Eigen::Vector3d
 	return true;
 }
 
-SubTrajectory FixCollisionObjects::fixCollisions(planning_scene::PlanningScene& scene) const {
+SubTrajectory FixCollisionObjects::fixCollisions(SceneBuilder& builder) const {
+	planning_scene::PlanningScene& scene = *builder.scene();
 	SubTrajectory result;
 	const auto& props = properties();
 	double max_penetration = props.get<double>("max_penetration");
 	const boost::any& dir = props.get("direction");
+	const bool single_pass = props.get<bool>("single_pass");
 
 	cd::CollisionRequest req;
 	cd::CollisionResult res;
@@ -114,6 +118,9 @@ SubTrajectory FixCollisionObjects::fixCollisions(planning_scene::PlanningScene&
 	m.header.frame_id = scene.getPlanningFrame();
 	m.ns = "collisions";
 
+	// corrections of all colliding objects, accumulated in single-pass mode
+	std::map<std::string, Eigen::Vector3d> corrections;
+
 	bool failure = false;
 	while (!failure) {
 		res.clear();
@@ -121,6 +128,8 @@ SubTrajectory FixCollisionObjects::fixCollisions(planning_scene::PlanningScene&
 		                                             scene.getAllowedCollisionMatrix());
 		if (!res.collision)
 			return result;
+		if (single_pass && !corrections.empty())
+			break;  // corrections applied, but collisions remain
 
 		for (const auto& info : res.contacts) {
 			Eigen::Vector3d correction;
@@ -140,17 +149,41 @@ SubTrajectory FixCollisionObjects::fixCollisions(planning_scene::PlanningScene&
 			if (failure)
 				break;
 
+			const std::string& name = c.body_type_1 == cd::BodyTypes::WORLD_OBJECT ? c.body_name_1 : c.body_name_2;
+			if (single_pass) {
+				if (!dir.empty()) {
+					// shift along the given direction far enough to resolve the penetration along correction
+					Eigen::Vector3d d;
+					tf2::fromMsg(boost::any_cast<geometry_msgs::Vector3>(dir), d);
+					double projection = d.normalized().dot(correction / depth);
+					if ((failure = projection < 1e-3))
+						break;
+					correction = d.normalized() * (depth / projection);
+				}
+				// combine corrections of several contact pairs of the same object: only add what is missing
+				auto inserted = corrections.emplace(name, correction);
+				if (!inserted.second) {
+					Eigen::Vector3d& total = inserted.first->second;
+					double covered = total.dot(correction) / correction.squaredNorm();
+					if (covered < 1.0)
+						total += (1.0 - covered) * correction;
+				}
+				continue;
+			}
+
 			// fix collision by shifting object along correction direction
 			if (!dir.empty())  // if explicitly given, use this correction direction
 				tf2::fromMsg(boost::any_cast<geometry_msgs::Vector3>(dir), correction);
-
-			const std::string& name = c.body_type_1 == cd::BodyTypes::WORLD_OBJECT ? c.body_name_1 : c.body_name_2;
-			scene.getWorldNonConst()->moveObject(name, Eigen::Isometry3d(Eigen::Translation3d(correction)));
+			builder.shiftObject(name, Eigen::Isometry3d(Eigen::Translation3d(correction)));
 		}
+		// resolve all collisions at once and verify the result with a single, final check
+		if (single_pass && !failure)
+			for (const auto& correction : corrections)
+				builder.shiftObject(correction.first, Eigen::Isometry3d(Eigen::Translation3d(correction.second)));
 	}
 
 	// failure
-	result.markAsFailure();
+	result.markAsFailure(single_pass && !failure ? "collisions remain after single-pass correction" : "");
 	return result;
 }
 }  // namespace stages
@@ -96,7 +96,9 @@ void FixedCartesianPoses::compute() {
 		SubTrajectory trajectory;
 		trajectory.setCost(0.0);
 
-		rviz_marker_tools::appendFrame(trajectory.markers(), pose, 0.1, "pose frame");
+		trajectory.addMarkerGenerator([pose](SolutionBase::Markers& markers) {
+			rviz_marker_tools::appendFrame(markers, pose, 0.1, "pose frame");
+		});
 
 		spawn(std::move(state), std::move(trajectory));
 	}
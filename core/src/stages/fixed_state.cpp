@@ -53,6 +53,14 @@ void FixedState::setState(const planning_scene::PlanningScenePtr& scene) {
 	scene_ = scene;
 }
 
+void FixedState::applySceneDiff(const moveit_msgs::PlanningScene& diff) {
+	if (!scene_)
+		return;
+	// clone() decouples the scene from states spawned before
+	scene_ = planning_scene::PlanningScene::clone(scene_);
+	scene_->setPlanningSceneDiffMsg(diff);
+}
+
 void FixedState::reset() {
 	Generator::reset();
 	ran_ = false;
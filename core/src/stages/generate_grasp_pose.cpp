@@ -43,7 +43,10 @@
 #include <moveit/robot_state/conversions.h>
 
 #include <Eigen/Geometry>
+#include <Eigen/StdVector>
 #include <tf2_eigen/tf2_eigen.h>
+#include <cmath>
+#include <vector>
 
 namespace moveit {
 namespace task_constructor {
@@ -55,6 +58,9 @@ GenerateGraspPose::GenerateGraspPose(const std::string& name) : GeneratePose(nam
 	p.declare<std::string>("object");
 	p.declare<double>("angle_delta", 0.1, "angular steps (rad)");
 	p.declare<Eigen::Vector3d>("rotation_axis", Eigen::Vector3d::UnitZ(), "rotate object pose about given axis");
+	p.declare<double>("max_reach", 0.0, "reject objects farther away from the arm's base (0 = disabled)");
+	p.declare<CandidateFilter>("candidate_filter", CandidateFilter(), "predicate to pre-filter grasp candidates");
+	p.declare<bool>("generate_markers", true, "generate markers for grasp candidates");
 
 	p.declare<boost::any>("pregrasp", "pregrasp posture");
 	p.declare<boost::any>("grasp", "grasp posture");
@@ -101,9 +107,10 @@ void GenerateGraspPose::init(const core::RobotModelConstPtr& robot_model) {
 
 	const auto& props = properties();
 
-	// check angle_delta
-	if (props.get<double>("angle_delta") == 0.)
-		errors.push_back(*this, "angle_delta must be non-zero");
+	// check angle_delta: it determines the number of candidates
+	const double angle_delta = props.get<double>("angle_delta");
+	if (!std::isfinite(angle_delta) || angle_delta == 0.)
+		errors.push_back(*this, "angle_delta must be finite and non-zero");
 
 	// check availability of object
 	props.get<std::string>("object");
@@ -128,22 +135,35 @@ void GenerateGraspPose::init(const core::RobotModelConstPtr& robot_model) {
 }
 
 void GenerateGraspPose::onNewSolution(const SolutionBase& s) {
-	planning_scene::PlanningSceneConstPtr scene = s.end()->scene();
+	onNewSolutions({ &s });
+}
 
+void GenerateGraspPose::onNewSolutions(const std::vector<const SolutionBase*>& solutions) {
 	const auto& props = properties();
 	const std::string& object = props.get<std::string>("object");
-	if (!scene->knowsFrameTransform(object)) {
-		const std::string msg = "object '" + object + "' not in scene";
-		spawn(InterfaceState{ scene }, SubTrajectory::failure(msg));
-		return;
-	}
 
-	upstream_solutions_.push(&s);
+	// solutions often share their scene: look up the object only once per scene
+	const planning_scene::PlanningScene* checked = nullptr;
+	bool known = false;
+	for (const SolutionBase* s : solutions) {
+		planning_scene::PlanningSceneConstPtr scene = s->end()->scene();
+		if (scene.get() != checked) {
+			checked = scene.get();
+			known = scene->knowsFrameTransform(object);
+		}
+		if (!known) {
+			const std::string msg = "object '" + object + "' not in scene";
+			spawn(InterfaceState{ scene }, SubTrajectory::failure(msg));
+			continue;
+		}
+
+		upstream_solutions_.push(s);
+	}
 }
 
-void GenerateGraspPose::compute() {
+planning_scene::PlanningScenePtr GenerateGraspPose::nextPreGraspScene() {
 	if (upstream_solutions_.empty())
-		return;
+		return nullptr;
 	planning_scene::PlanningScenePtr scene = upstream_solutions_.pop()->end()->scene()->diff();
 
 	// set end effector pose
@@ -151,23 +171,59 @@ void GenerateGraspPose::compute() {
 	const std::string& eef = props.get<std::string>("eef");
 	const moveit::core::JointModelGroup* jmg = scene->getRobotModel()->getEndEffector(eef);
 
-	moveit::core::RobotState& robot_state = scene->getCurrentStateNonConst();
 	try {
-		applyPreGrasp(robot_state, jmg, props.property("pregrasp"));
+		applyPreGrasp(scene->getCurrentStateNonConst(), jmg, props.property("pregrasp"));
 	} catch (const moveit::Exception& e) {
 		spawn(InterfaceState{ scene }, SubTrajectory::failure(std::string{ "invalid pregrasp: " } + e.what()));
+		return nullptr;
+	}
+	return scene;
+}
+
+void GenerateGraspPose::compute() {
+	planning_scene::PlanningScenePtr scene = nextPreGraspScene();
+	if (!scene)
 		return;
+
+	const auto& props = properties();
+	const moveit::core::JointModelGroup* jmg = scene->getRobotModel()->getEndEffector(props.get<std::string>("eef"));
+	const moveit::core::RobotState& robot_state = scene->getCurrentState();
+	const std::string& object = props.get<std::string>("object");
+	const Eigen::Isometry3d& object_pose = scene->getFrameTransform(object);
+
+	// reachability pre-filter: all candidates share the origin of the object frame
+	const double max_reach = props.get<double>("max_reach");
+	if (max_reach > 0.0) {
+		const moveit::core::JointModelGroup* arm =
+		    scene->getRobotModel()->getJointModelGroup(jmg->getEndEffectorParentGroup().first);
+		const moveit::core::LinkModel* base = arm ? arm->getCommonRoot()->getParentLinkModel() : nullptr;
+		const Eigen::Vector3d base_position =
+		    base ? robot_state.getGlobalLinkTransform(base).translation() : Eigen::Vector3d::Zero();
+		if ((object_pose.translation() - base_position).norm() > max_reach) {
+			spawn(InterfaceState{ scene }, SubTrajectory::failure("object '" + object + "' out of reach"));
+			return;
+		}
 	}
 
-	geometry_msgs::PoseStamped target_pose_msg;
-	target_pose_msg.header.frame_id = props.get<std::string>("object");
-	Eigen::Vector3d rotation_axis = props.get<Eigen::Vector3d>("rotation_axis");
+	// compute all candidate poses (w.r.t. the object frame) at once
+	const double angle_delta = props.get<double>("angle_delta");
+	const Eigen::Vector3d rotation_axis = props.get<Eigen::Vector3d>("rotation_axis");
+	std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> candidates;
+	candidates.reserve(static_cast<size_t>(std::ceil(2. * M_PI / std::abs(angle_delta))));
+	for (double angle = 0.0; angle < 2. * M_PI && angle > -2. * M_PI; angle += angle_delta)
+		candidates.emplace_back(Eigen::AngleAxisd(angle, rotation_axis));  // rotate object pose about axis
+
+	const auto& filter = props.get<CandidateFilter>("candidate_filter");
+	const bool generate_markers = props.get<bool>("generate_markers");
 
-	double current_angle = 0.0;
-	while (current_angle < 2. * M_PI && current_angle > -2. * M_PI) {
-		// rotate object pose about axis
-		Eigen::Isometry3d target_pose(Eigen::AngleAxisd(current_angle, rotation_axis));
-		current_angle += props.get<double>("angle_delta");
+	geometry_msgs::PoseStamped target_pose_msg;
+	target_pose_msg.header.frame_id = object;
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		const Eigen::Isometry3d& target_pose = candidates[i];
+		if (filter && !filter(*scene, object_pose * target_pose)) {
+			silentFailure();  // rejected candidates are only counted
+			continue;
+		}
 
 		InterfaceState state(scene);
 		target_pose_msg.pose = tf2::toMsg(target_pose);
@@ -176,10 +232,13 @@ void GenerateGraspPose::compute() {
 
 		SubTrajectory trajectory;
 		trajectory.setCost(0.0);
-		trajectory.setComment(std::to_string(current_angle));
+		trajectory.setComment(std::to_string((i + 1) * angle_delta));
 
-		// add frame at target pose
-		rviz_marker_tools::appendFrame(trajectory.markers(), target_pose_msg, 0.1, "grasp frame");
+		// add frame at target pose, generated on demand only
+		if (generate_markers)
+			trajectory.addMarkerGenerator([target_pose_msg](SolutionBase::Markers& markers) {
+				rviz_marker_tools::appendFrame(markers, target_pose_msg, 0.1, "grasp frame");
+			});
 
 		spawn(std::move(state), std::move(trajectory));
 	}
@@ -0,0 +1,152 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:    Generator Stage for precomputed grasp poses from a grasp database
+*/
+
+#include <moveit/task_constructor/stages/generate_grasp_pose_from_database.h>
+#include <moveit/task_constructor/storage.h>
+#include <rviz_marker_tools/marker_creation.h>
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit_msgs/RobotState.h>
+
+#include <tf2_eigen/tf2_eigen.h>
+#include <stdexcept>
+
+namespace moveit {
+namespace task_constructor {
+namespace stages {
+
+GenerateGraspPoseFromDatabase::GenerateGraspPoseFromDatabase(const std::string& name) : GenerateGraspPose(name) {
+	auto& p = properties();
+	p.declare<std::string>("database", "path of the grasp database of the object's type");
+	p.declare<double>("max_distance", 0.05, "max position distance (m) between current and recorded object pose");
+	p.declare<double>("max_angle", 0.3, "max orientation distance (rad) between current and recorded object pose");
+	p.declare<uint32_t>("max_candidates", 0, "max number of closest grasps spawned per object pose (0 = unlimited)");
+}
+
+void GenerateGraspPoseFromDatabase::init(const core::RobotModelConstPtr& robot_model) {
+	InitStageException errors;
+	try {
+		GenerateGraspPose::init(robot_model);
+	} catch (InitStageException& e) {
+		errors.append(e);
+	}
+
+	// (re)load database only if its path changed
+	const std::string& path = properties().get<std::string>("database");
+	if (!database_ || path != database_path_) {
+		database_.reset();
+		try {
+			database_ = std::make_shared<const GraspDatabase>(path);
+			database_path_ = path;
+		} catch (const std::runtime_error& e) {
+			errors.push_back(*this, e.what());
+		}
+	}
+	if (database_)
+		for (const std::string& name : database_->jointNames())
+			if (!robot_model->hasJointModel(name))
+				errors.push_back(*this, "grasp database refers to unknown joint: " + name);
+
+	if (errors)
+		throw errors;
+}
+
+void GenerateGraspPoseFromDatabase::compute() {
+	planning_scene::PlanningScenePtr scene = nextPreGraspScene();
+	if (!scene)
+		return;
+
+	const auto& props = properties();
+	const std::string& object = props.get<std::string>("object");
+	const GraspDatabase& db = *database_;
+	if (!scene->knowsFrameTransform(db.referenceFrame())) {
+		spawn(InterfaceState{ scene },
+		      SubTrajectory::failure("unknown reference frame of grasp database: " + db.referenceFrame()));
+		return;
+	}
+	const Eigen::Isometry3d& object_pose = scene->getFrameTransform(object);
+	const Eigen::Isometry3d reference_pose = scene->getFrameTransform(db.referenceFrame());
+
+	std::vector<GraspDatabase::Match> matches = db.lookup(reference_pose.inverse() * object_pose,
+	                                                      props.get<double>("max_distance"), props.get<double>("max_angle"));
+	if (matches.empty()) {
+		spawn(InterfaceState{ scene }, SubTrajectory::failure("no database grasps for pose of object '" + object + "'"));
+		return;
+	}
+	const uint32_t max_candidates = props.get<uint32_t>("max_candidates");
+	if (max_candidates > 0 && matches.size() > max_candidates)
+		matches.resize(max_candidates);
+
+	const auto& filter = props.get<CandidateFilter>("candidate_filter");
+	const bool generate_markers = props.get<bool>("generate_markers");
+
+	geometry_msgs::PoseStamped target_pose_msg;
+	target_pose_msg.header.frame_id = object;
+	moveit_msgs::RobotState seed;
+	seed.is_diff = true;
+	seed.joint_state.name = db.jointNames();
+	for (const GraspDatabase::Match& match : matches) {
+		const Eigen::Isometry3d target_pose = db.graspPose(match.index);
+		if (filter && !filter(*scene, object_pose * target_pose)) {
+			silentFailure();  // rejected candidates are only counted
+			continue;
+		}
+
+		InterfaceState state(scene);
+		target_pose_msg.pose = tf2::toMsg(target_pose);
+		state.properties().set("target_pose", target_pose_msg);
+		const double* positions = db.jointPositions(match.index);
+		seed.joint_state.position.assign(positions, positions + seed.joint_state.name.size());
+		state.properties().set("ik_seed", seed);
+		props.exposeTo(state.properties(), { "pregrasp", "grasp" });
+
+		SubTrajectory trajectory;
+		trajectory.setCost(db.cost(match.index));
+		trajectory.setComment("grasp " + std::to_string(db.graspId(match.index)));
+
+		// add frame at target pose, generated on demand only
+		if (generate_markers)
+			trajectory.addMarkerGenerator([target_pose_msg](SolutionBase::Markers& markers) {
+				rviz_marker_tools::appendFrame(markers, target_pose_msg, 0.1, "grasp frame");
+			});
+
+		spawn(std::move(state), std::move(trajectory));
+	}
+}
+}  // namespace stages
+}  // namespace task_constructor
+}  // namespace moveit
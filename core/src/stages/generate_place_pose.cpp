@@ -36,6 +36,7 @@
 
 #include <moveit/task_constructor/stages/generate_place_pose.h>
 #include <moveit/task_constructor/storage.h>
+#include <moveit/task_constructor/cost_terms.h>
 #include <moveit/task_constructor/marker_tools.h>
 
 #include <rviz_marker_tools/marker_creation.h>
@@ -44,45 +45,178 @@
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/robot_state/attached_body.h>
 
+#include <geometric_shapes/bodies.h>
+#include <geometric_shapes/shapes.h>
+
 #include <Eigen/Geometry>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
 namespace moveit {
 namespace task_constructor {
 namespace stages {
 
 GeneratePlacePose::GeneratePlacePose(const std::string& name) : GeneratePose(name) {
+	// forward the cost of spawned placements (clearance penalty in batch mode) instead of GeneratePose's constant one
+	setCostTerm(std::make_unique<CostTerm>());
+
 	auto& p = properties();
 	p.declare<std::string>("object");
 	p.declare<bool>("allow_z_flip", false, "allow placing objects upside down");
+	p.declare<uint32_t>("sample_count", 0,
+	                    "number of placements sampled around the nominal pose (0 disables batch sampling)");
+	p.declare<double>("sample_radius", 0.05, "radius of the disc (in world's xy plane) placements are sampled from");
+	p.declare<double>("clearance", 0.05, "desired horizontal clearance of sampled placements to world objects");
 }
 
+namespace {
+// points on the hull of a shape (w.r.t. shape frame), slightly moved inwards to tolerate touching contacts
+EigenSTL::vector_Vector3d hullPoints(const shapes::Shape& shape) {
+	EigenSTL::vector_Vector3d points{ Eigen::Vector3d::Zero() };
+	switch (shape.type) {
+		case shapes::BOX: {
+			const double* size = static_cast<const shapes::Box&>(shape).size;
+			for (int corner = 0; corner < 8; ++corner)
+				points.emplace_back((corner & 1 ? 0.5 : -0.5) * size[0], (corner & 2 ? 0.5 : -0.5) * size[1],
+				                    (corner & 4 ? 0.5 : -0.5) * size[2]);
+			break;
+		}
+		case shapes::CYLINDER:
+		case shapes::CONE: {
+			double radius, length;
+			if (shape.type == shapes::CYLINDER) {
+				radius = static_cast<const shapes::Cylinder&>(shape).radius;
+				length = static_cast<const shapes::Cylinder&>(shape).length;
+			} else {  // cone: sampling the base rim twice is fine
+				radius = static_cast<const shapes::Cone&>(shape).radius;
+				length = static_cast<const shapes::Cone&>(shape).length;
+			}
+			for (int i = 0; i < 8; ++i) {
+				const double angle = i * M_PI / 4;
+				for (double z : { -0.5 * length, 0.5 * length })
+					points.emplace_back(radius * std::cos(angle), radius * std::sin(angle), z);
+			}
+			break;
+		}
+		case shapes::SPHERE: {
+			const double radius = static_cast<const shapes::Sphere&>(shape).radius;
+			for (int axis = 0; axis < 3; ++axis)
+				for (double sign : { -1.0, 1.0 })
+					points.push_back(sign * radius * Eigen::Vector3d::Unit(axis));
+			break;
+		}
+		case shapes::MESH: {
+			const auto& mesh = static_cast<const shapes::Mesh&>(shape);
+			const unsigned int stride = std::max(1u, mesh.vertex_count / 64);
+			for (unsigned int i = 0; i < mesh.vertex_count; i += stride)
+				points.emplace_back(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+			break;
+		}
+		default:
+			break;
+	}
+	constexpr double TOLERANCE = 1e-3;
+	for (Eigen::Vector3d& point : points)
+		if (point.norm() > TOLERANCE)
+			point -= TOLERANCE * point.normalized();
+	return points;
+}
+
+// cheap pre-filter for placements of an attached object: points on the object's hull are tested against world bodies
+class PlacementChecker
+{
+	std::vector<std::unique_ptr<bodies::Body>> world_;
+	EigenSTL::vector_Vector3d points_;  // w.r.t. object frame
+
+public:
+	PlacementChecker(const planning_scene::PlanningScene& scene, const moveit::core::AttachedBody& object) {
+		for (const auto& pair : *scene.getWorld()) {
+			const collision_detection::World::Object& world_object = *pair.second;
+			for (size_t i = 0; i < world_object.shapes_.size(); ++i) {
+				std::unique_ptr<bodies::Body> body(bodies::createBodyFromShape(world_object.shapes_[i].get()));
+				if (!body)
+					continue;
+				body->setPose(world_object.global_shape_poses_[i]);
+				world_.push_back(std::move(body));
+			}
+		}
+		for (size_t i = 0; i < object.getShapes().size(); ++i)
+			for (const Eigen::Vector3d& point : hullPoints(*object.getShapes()[i]))
+				points_.push_back(object.getShapePoses()[i] * point);
+	}
+
+	/// check if the object placed at pose collides with world objects
+	bool colliding(const Eigen::Isometry3d& pose) const {
+		for (const Eigen::Vector3d& point : points_) {
+			const Eigen::Vector3d p = pose * point;
+			for (const auto& body : world_)
+				if (body->containsPoint(p))
+					return true;
+		}
+		return false;
+	}
+
+	/// horizontal distance of the object placed at pose to the closest world object, estimated by ray casting
+	double clearance(const Eigen::Isometry3d& pose) const {
+		double clearance = std::numeric_limits<double>::infinity();
+		EigenSTL::vector_Vector3d intersections;
+		for (const Eigen::Vector3d& point : points_) {
+			const Eigen::Vector3d p = pose * point;
+			for (const Eigen::Vector3d& dir : { Eigen::Vector3d::UnitX(), Eigen::Vector3d(-Eigen::Vector3d::UnitX()),
+			                                    Eigen::Vector3d::UnitY(), Eigen::Vector3d(-Eigen::Vector3d::UnitY()) })
+				for (const auto& body : world_) {
+					intersections.clear();
+					if (body->intersectsRay(p, dir, &intersections, 1))
+						clearance = std::min(clearance, (intersections.front() - p).norm());
+				}
+		}
+		return clearance;
+	}
+};
+}  // namespace
+
 void GeneratePlacePose::onNewSolution(const SolutionBase& s) {
-	planning_scene::PlanningSceneConstPtr scene = s.end()->scene();
+	onNewSolutions({ &s });
+}
 
+void GeneratePlacePose::onNewSolutions(const std::vector<const SolutionBase*>& solutions) {
 	const auto& props = properties();
 	const std::string& object = props.get<std::string>("object");
-	bool frame_found = false;
-	const moveit::core::LinkModel* link = nullptr;
-	scene->getCurrentState().getFrameInfo(object, link, frame_found);
+
+	// solutions often share their scene: look up the object's frame only once per scene
+	const planning_scene::PlanningScene* checked = nullptr;
 	std::string msg;
-	if (!frame_found)
-		msg = "frame '" + object + "' is not known";
-	if (!link)
-		msg = "frame '" + object + "' is not attached to the robot";
-	if (!msg.empty()) {
-		if (storeFailures()) {
-			InterfaceState state(scene);
-			SubTrajectory solution;
-			solution.markAsFailure();
-			solution.setComment(msg);
-			spawn(std::move(state), std::move(solution));
-		} else
-			ROS_WARN_STREAM_NAMED("GeneratePlacePose", msg);
-		return;
-	}
+	for (const SolutionBase* s : solutions) {
+		planning_scene::PlanningSceneConstPtr scene = s->end()->scene();
+		if (scene.get() != checked) {
+			checked = scene.get();
+			bool frame_found = false;
+			const moveit::core::LinkModel* link = nullptr;
+			scene->getCurrentState().getFrameInfo(object, link, frame_found);
+			msg.clear();
+			if (!frame_found)
+				msg = "frame '" + object + "' is not known";
+			if (!link)
+				msg = "frame '" + object + "' is not attached to the robot";
+		}
+		if (!msg.empty()) {
+			if (storeFailures()) {
+				InterfaceState state(scene);
+				SubTrajectory solution;
+				solution.markAsFailure();
+				solution.setComment(msg);
+				spawn(std::move(state), std::move(solution));
+			} else
+				ROS_WARN_STREAM_NAMED("GeneratePlacePose", msg);
+			continue;
+		}
 
-	upstream_solutions_.push(&s);
+		upstream_solutions_.push(s);
+	}
 }
 
 void GeneratePlacePose::compute() {
@@ -106,8 +240,10 @@ void GeneratePlacePose::compute() {
 	// target pose w.r.t. planning frame
 	scene->getTransforms().transformPose(pose_msg.header.frame_id, target_pose, target_pose);
 
-	// spawn the nominal target object pose, considering flip about z and rotations about z-axis
-	auto spawner = [&s, &scene, &ik_frame, this](const Eigen::Isometry3d& nominal, uint z_flips, uint z_rotations = 10) {
+	// placements to spawn: target ik_frame's pose w.r.t. planning frame, and cost
+	std::vector<std::pair<Eigen::Isometry3d, double>> placements;
+	// collect the nominal target object pose, considering flip about z and rotations about z-axis
+	auto spawner = [&placements](const Eigen::Isometry3d& nominal, uint z_flips, uint z_rotations = 10) {
 		for (uint flip = 0; flip <= z_flips; ++flip) {
 			// flip about object's x-axis
 			Eigen::Isometry3d object = nominal * Eigen::AngleAxisd(flip * M_PI, Eigen::Vector3d::UnitX());
@@ -117,48 +253,93 @@ void GeneratePlacePose::compute() {
 				object.pretranslate(-pos)
 				    .prerotate(Eigen::AngleAxisd(i * 2. * M_PI / z_rotations, Eigen::Vector3d::UnitZ()))
 				    .pretranslate(pos);
-
-				// target ik_frame's pose w.r.t. planning frame
-				geometry_msgs::PoseStamped target_pose_msg;
-				target_pose_msg.header.frame_id = scene->getPlanningFrame();
-				target_pose_msg.pose = tf2::toMsg(object);
-
-				InterfaceState state(scene);
-				forwardProperties(*s.end(), state);  // forward properties from inner solutions
-				state.properties().set("target_pose", target_pose_msg);
-				state.properties().set("ik_frame", ik_frame);
-
-				SubTrajectory trajectory;
-				trajectory.setCost(0.0);
-				rviz_marker_tools::appendFrame(trajectory.markers(), target_pose_msg, 0.1, "place frame");
-
-				spawn(std::move(state), std::move(trajectory));
+				placements.emplace_back(object, 0.0);
 			}
 		}
 	};
 
 	uint z_flips = props.get<bool>("allow_z_flip") ? 1 : 0;
+	bool handled = false;
 	if (object && object->getShapes().size() == 1) {
 		switch (object->getShapes()[0]->type) {
 			case shapes::CYLINDER:
 				spawner(target_pose, z_flips);
-				return;
+				handled = true;
+				break;
 
 			case shapes::BOX: {  // consider 180/90 degree rotations about z axis
 				const double* dims = static_cast<const shapes::Box&>(*object->getShapes()[0]).size;
 				spawner(target_pose, z_flips, (std::abs(dims[0] - dims[1]) < 1e-5) ? 4 : 2);
-				return;
+				handled = true;
+				break;
 			}
 			case shapes::SPHERE:  // keep original orientation and rotate about world's z
 				spawner(target_pose, z_flips);
-				return;
+				handled = true;
+				break;
 			default:
 				break;
 		}
 	}
-
 	// any other case: only try given target pose
-	spawner(target_pose, 1, 1);
+	if (!handled)
+		spawner(target_pose, 1, 1);
+
+	// batch mode: sample placements around the nominal ones, reject colliding ones, and sort by clearance
+	const uint32_t sample_count = props.get<uint32_t>("sample_count");
+	std::vector<Eigen::Isometry3d> colliding;  // rejected placements, reported as failures
+	if (sample_count > 0 && object) {
+		const double radius = props.get<double>("sample_radius");
+		const double desired_clearance = props.get<double>("clearance");
+		const size_t num_nominal = placements.size();
+		placements.reserve(num_nominal * (sample_count + 1));
+		for (uint32_t k = 1; k <= sample_count; ++k) {
+			// evenly spread offsets on a disc (Vogel's spiral)
+			const double rho = radius * std::sqrt(double(k) / sample_count);
+			const double theta = k * M_PI * (3.0 - std::sqrt(5.0));
+			const Eigen::Translation3d offset(rho * std::cos(theta), rho * std::sin(theta), 0.0);
+			for (size_t i = 0; i < num_nominal; ++i)
+				placements.emplace_back(offset * placements[i].first, 0.0);
+		}
+
+		const PlacementChecker checker(*scene, *object);
+		std::vector<std::pair<Eigen::Isometry3d, double>> valid;
+		for (const auto& placement : placements) {
+			if (checker.colliding(placement.first)) {
+				if (storeFailures())
+					colliding.push_back(placement.first);
+				continue;
+			}
+			valid.emplace_back(placement.first, std::max(0.0, desired_clearance - checker.clearance(placement.first)));
+		}
+		std::stable_sort(valid.begin(), valid.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+		placements.swap(valid);
+	}
+
+	auto spawn_placement = [&](const Eigen::Isometry3d& pose, double cost, bool failure) {
+		geometry_msgs::PoseStamped target_pose_msg;
+		target_pose_msg.header.frame_id = scene->getPlanningFrame();
+		target_pose_msg.pose = tf2::toMsg(pose);
+
+		InterfaceState state(scene);
+		forwardProperties(*s.end(), state);  // forward properties from inner solutions
+		state.properties().set("target_pose", target_pose_msg);
+		state.properties().set("ik_frame", ik_frame);
+
+		SubTrajectory trajectory;
+		trajectory.setCost(cost);
+		if (failure)
+			trajectory.markAsFailure("object collides with world");
+		trajectory.addMarkerGenerator([target_pose_msg](SolutionBase::Markers& markers) {
+			rviz_marker_tools::appendFrame(markers, target_pose_msg, 0.1, "place frame");
+		});
+
+		spawn(std::move(state), std::move(trajectory));
+	};
+	for (const auto& placement : placements)
+		spawn_placement(placement.first, placement.second, false);
+	for (const Eigen::Isometry3d& pose : colliding)
+		spawn_placement(pose, 0.0, true);
 }
 }  // namespace stages
 }  // namespace task_constructor
@@ -88,7 +88,9 @@ void GeneratePose::compute() {
 	SubTrajectory trajectory;
 	trajectory.setCost(0.0);
 
-	rviz_marker_tools::appendFrame(trajectory.markers(), target_pose, 0.1, "pose frame");
+	trajectory.addMarkerGenerator([target_pose](SolutionBase::Markers& markers) {
+		rviz_marker_tools::appendFrame(markers, target_pose, 0.1, "pose frame");
+	});
 
 	spawn(std::move(state), std::move(trajectory));
 }
@@ -43,12 +43,37 @@
 #include <Eigen/Geometry>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <boost/math/special_functions/erf.hpp>
+
 #include <chrono>
+#include <cmath>
 
 namespace {
-// TODO(henningkayser): support user-defined random number engines
-std::random_device RANDOM_DEVICE;
-std::mt19937 ENGINE(RANDOM_DEVICE());
+// n-th prime number (starting with 2 for n = 0), serving as base of the n-th Halton dimension
+unsigned int prime(size_t n) {
+	static const unsigned int PRIMES[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53 };
+	if (n < sizeof(PRIMES) / sizeof(PRIMES[0]))
+		return PRIMES[n];
+	unsigned int candidate = PRIMES[sizeof(PRIMES) / sizeof(PRIMES[0]) - 1];
+	for (size_t i = sizeof(PRIMES) / sizeof(PRIMES[0]) - 1; i < n;) {
+		candidate += 2;
+		bool is_prime = true;
+		for (unsigned int d = 3; d * d <= candidate && is_prime; d += 2)
+			is_prime = candidate % d != 0;
+		if (is_prime)
+			++i;
+	}
+	return candidate;
+}
+
+// radical inverse of index in given base, i.e. the index-th element of a Halton sequence, in (0,1) for index > 0
+double radicalInverse(size_t index, unsigned int base) {
+	double result = 0.0;
+	double scale = 1.0 / base;
+	for (; index > 0; index /= base, scale /= base)
+		result += (index % base) * scale;
+	return result;
+}
 }  // namespace
 
 namespace moveit {
@@ -59,101 +84,140 @@ GenerateRandomPose::GenerateRandomPose(const std::string& name) : GeneratePose(n
 	auto& p = properties();
 	p.declare<size_t>("max_solutions", 20, "maximum number of spawned solutions");
 	p.property("pose").setDescription("seed pose");
+	p.declare<bool>("quasi_random", false, "sample from a low-discrepancy Halton sequence instead of random numbers");
+	p.declare<bool>("resumable", false, "spawn a single pose per compute() call");
 	p.property("timeout").setDefaultValue(1.0 /* seconds */);
 }
 
+void GenerateRandomPose::reset() {
+	sample_index_ = 0;
+	sampling_.reset();
+	GeneratePose::reset();
+}
+
+double GenerateRandomPose::sampleUnit(size_t dimension, double (*inverse_cdf)(double), double width) {
+	if (quasi_random_)
+		return inverse_cdf(radicalInverse(sample_index_, prime(dimension))) * width;
+	return inverse_cdf(std::uniform_real_distribution<double>(0.0, 1.0)(engine_)) * width;
+}
+
 template <>
 GenerateRandomPose::PoseDimensionSampler
 GenerateRandomPose::getPoseDimensionSampler<std::normal_distribution>(double stddev) {
-	return [stddev](double mean) {
-		static std::normal_distribution<double> dist(mean, stddev);
-		return dist(ENGINE);
+	const size_t dimension = pose_dimension_samplers_.size();
+	return [this, dimension, stddev](double mean) {
+		if (!quasi_random_)
+			return std::normal_distribution<double>(mean, stddev)(engine_);
+		// inverse cdf of standard normal distribution
+		auto inverse_cdf = [](double u) { return M_SQRT2 * boost::math::erf_inv(2.0 * u - 1.0); };
+		return mean + sampleUnit(dimension, inverse_cdf, stddev);
 	};
 }
 
 template <>
 GenerateRandomPose::PoseDimensionSampler
 GenerateRandomPose::getPoseDimensionSampler<std::uniform_real_distribution>(double range) {
-	return [range](double mean) {
-		static std::uniform_real_distribution<double> dist(mean - 0.5 * range, mean + 0.5 * range);
-		return dist(ENGINE);
+	const size_t dimension = pose_dimension_samplers_.size();
+	return [this, dimension, range](double mean) {
+		auto inverse_cdf = [](double u) { return u - 0.5; };
+		return mean + sampleUnit(dimension, inverse_cdf, range);
 	};
 }
 
 bool GenerateRandomPose::canCompute() const {
-	return GeneratePose::canCompute() && !pose_dimension_samplers_.empty();
+	return (sampling_ || GeneratePose::canCompute()) && !pose_dimension_samplers_.empty();
 }
 
 void GenerateRandomPose::compute() {
-	if (upstream_solutions_.empty())
-		return;
-
-	const SolutionBase& s = *upstream_solutions_.pop();
-	planning_scene::PlanningScenePtr scene = s.end()->scene()->diff();
-	auto seed_pose = properties().get<geometry_msgs::PoseStamped>("pose");
-	if (seed_pose.header.frame_id.empty())
-		seed_pose.header.frame_id = scene->getPlanningFrame();
-	else if (!scene->knowsFrameTransform(seed_pose.header.frame_id)) {
-		ROS_WARN_NAMED("GenerateRandomPose", "Unknown frame: '%s'", seed_pose.header.frame_id.c_str());
-		return;
+	const bool resumable = properties().get<bool>("resumable");
+	if (!sampling_) {
+		startSampling();
+		if (resumable)
+			return;  // spawning the seed pose was the first step
+	}
+	while (sampling_) {
+		sampleStep();
+		if (resumable)
+			return;
 	}
+}
 
-	const auto& spawn_target_pose = [&](const geometry_msgs::PoseStamped& target_pose) {
-		InterfaceState state(scene);
-		forwardProperties(*s.end(), state);  // forward registered properties from received solution
-		state.properties().set("target_pose", target_pose);
+void GenerateRandomPose::spawnTargetPose(const geometry_msgs::PoseStamped& target_pose) {
+	InterfaceState state(sampling_->scene);
+	forwardProperties(*sampling_->source->end(), state);  // forward registered properties from received solution
+	state.properties().set("target_pose", target_pose);
 
-		SubTrajectory trajectory;
-		trajectory.setCost(0.0);
+	SubTrajectory trajectory;
+	trajectory.setCost(0.0);
 
-		rviz_marker_tools::appendFrame(trajectory.markers(), target_pose, 0.1, "pose frame");
+	trajectory.addMarkerGenerator([target_pose](SolutionBase::Markers& markers) {
+		rviz_marker_tools::appendFrame(markers, target_pose, 0.1, "pose frame");
+	});
 
-		spawn(std::move(state), std::move(trajectory));
-	};
+	spawn(std::move(state), std::move(trajectory));
+}
 
-	spawn_target_pose(seed_pose);
+void GenerateRandomPose::startSampling() {
+	if (upstream_solutions_.empty())
+		return;
 
-	if (pose_dimension_samplers_.empty())
+	auto sampling = std::make_unique<Sampling>();
+	sampling->source = upstream_solutions_.pop();
+	sampling->scene = sampling->source->end()->scene()->diff();
+	sampling->seed_pose = properties().get<geometry_msgs::PoseStamped>("pose");
+	if (sampling->seed_pose.header.frame_id.empty())
+		sampling->seed_pose.header.frame_id = sampling->scene->getPlanningFrame();
+	else if (!sampling->scene->knowsFrameTransform(sampling->seed_pose.header.frame_id)) {
+		ROS_WARN_NAMED("GenerateRandomPose", "Unknown frame: '%s'", sampling->seed_pose.header.frame_id.c_str());
 		return;
+	}
+	sampling->max_solutions = properties().get<size_t>("max_solutions");
+	sampling->timeout = timeout();
+	quasi_random_ = properties().get<bool>("quasi_random");
+
+	sampling_ = std::move(sampling);
+	spawnTargetPose(sampling_->seed_pose);
+	if (pose_dimension_samplers_.empty() || !sampling_->pending())
+		sampling_.reset();
+}
 
-	auto sample_pose = seed_pose;
-	Eigen::Isometry3d seed, sample;
-	tf2::fromMsg(seed_pose.pose, seed);
-	double elapsed_time = 0.0;
+void GenerateRandomPose::sampleStep() {
 	const auto start_time = std::chrono::steady_clock::now();
-	size_t spawned_solutions = 0;
-	const size_t max_solutions = properties().get<size_t>("max_solutions");
-
-	while (elapsed_time < timeout() && ++spawned_solutions < max_solutions) {
-		// Randomize pose using specified dimension samplers applied
-		// in the order in which they have been specified
-		sample = seed;
-		for (const auto& pose_dim_sampler : pose_dimension_samplers_) {
-			switch (pose_dim_sampler.first) {
-				case X:
-					sample.translate(Eigen::Vector3d(pose_dim_sampler.second(0), 0, 0));
-					break;
-				case Y:
-					sample.translate(Eigen::Vector3d(0, pose_dim_sampler.second(0), 0));
-					break;
-				case Z:
-					sample.translate(Eigen::Vector3d(0, 0, pose_dim_sampler.second(0)));
-					break;
-				case ROLL:
-					sample.rotate(Eigen::AngleAxisd(pose_dim_sampler.second(0.0), Eigen::Vector3d::UnitX()));
-					break;
-				case PITCH:
-					sample.rotate(Eigen::AngleAxisd(pose_dim_sampler.second(0.0), Eigen::Vector3d::UnitY()));
-					break;
-				case YAW:
-					sample.rotate(Eigen::AngleAxisd(pose_dim_sampler.second(0.0), Eigen::Vector3d::UnitZ()));
-			}
+	++sample_index_;  // all dimensions of a pose share the same (quasi-random) sample index
+
+	// Randomize pose using specified dimension samplers applied
+	// in the order in which they have been specified
+	Eigen::Isometry3d sample;
+	tf2::fromMsg(sampling_->seed_pose.pose, sample);
+	for (const auto& pose_dim_sampler : pose_dimension_samplers_) {
+		switch (pose_dim_sampler.first) {
+			case X:
+				sample.translate(Eigen::Vector3d(pose_dim_sampler.second(0), 0, 0));
+				break;
+			case Y:
+				sample.translate(Eigen::Vector3d(0, pose_dim_sampler.second(0), 0));
+				break;
+			case Z:
+				sample.translate(Eigen::Vector3d(0, 0, pose_dim_sampler.second(0)));
+				break;
+			case ROLL:
+				sample.rotate(Eigen::AngleAxisd(pose_dim_sampler.second(0.0), Eigen::Vector3d::UnitX()));
+				break;
+			case PITCH:
+				sample.rotate(Eigen::AngleAxisd(pose_dim_sampler.second(0.0), Eigen::Vector3d::UnitY()));
+				break;
+			case YAW:
+				sample.rotate(Eigen::AngleAxisd(pose_dim_sampler.second(0.0), Eigen::Vector3d::UnitZ()));
 		}
-		sample_pose.pose = tf2::toMsg(sample);
-		spawn_target_pose(sample_pose);
-
-		elapsed_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
 	}
+	auto sample_pose = sampling_->seed_pose;
+	sample_pose.pose = tf2::toMsg(sample);
+	spawnTargetPose(sample_pose);
+
+	++sampling_->spawned;
+	sampling_->elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	if (!sampling_->pending())
+		sampling_.reset();
 }
 }  // namespace stages
 }  // namespace task_constructor
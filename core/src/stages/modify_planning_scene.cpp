@@ -65,6 +65,7 @@ void ModifyPlanningScene::addObject(const moveit_msgs::CollisionObject& collisio
 		return;
 	}
 	collision_objects_.push_back(collision_object);
+	batches_[0].valid = batches_[1].valid = false;
 }
 
 void ModifyPlanningScene::removeObject(const std::string& object_name) {
@@ -72,6 +73,7 @@ void ModifyPlanningScene::removeObject(const std::string& object_name) {
 	obj.id = object_name;
 	obj.operation = moveit_msgs::CollisionObject::REMOVE;
 	collision_objects_.push_back(obj);
+	batches_[0].valid = batches_[1].valid = false;
 }
 
 void ModifyPlanningScene::moveObject(const moveit_msgs::CollisionObject& collision_object) {
@@ -81,6 +83,7 @@ void ModifyPlanningScene::moveObject(const moveit_msgs::CollisionObject& collisi
 		return;
 	}
 	collision_objects_.push_back(collision_object);
+	batches_[0].valid = batches_[1].valid = false;
 }
 
 void ModifyPlanningScene::allowCollisions(const Names& first, const Names& second, bool allow) {
@@ -94,6 +97,14 @@ void ModifyPlanningScene::allowCollisions(const std::string& first, const moveit
 		allowCollisions(Names({ first }), links, allow);
 }
 
+void ModifyPlanningScene::init(const moveit::core::RobotModelConstPtr& robot_model) {
+	PropagatingEitherWay::init(robot_model);
+	// compile batches upfront, such that concurrent computations only read them
+	batches_[0].valid = batches_[1].valid = false;
+	batch(false);
+	batch(true);
+}
+
 void ModifyPlanningScene::computeForward(const InterfaceState& from) {
 	auto result = apply(from, false);
 	sendForward(from, std::move(result.first), std::move(result.second));
@@ -119,9 +130,8 @@ void ModifyPlanningScene::attachObjects(planning_scene::PlanningScene& scene,
 	}
 }
 
-void ModifyPlanningScene::allowCollisions(planning_scene::PlanningScene& scene, const CollisionMatrixPairs& pairs,
-                                          bool invert) {
-	collision_detection::AllowedCollisionMatrix& acm = scene.getAllowedCollisionMatrixNonConst();
+void ModifyPlanningScene::allowCollisions(collision_detection::AllowedCollisionMatrix& acm,
+                                          const CollisionMatrixPairs& pairs, bool invert) {
 	bool allow = invert ? !pairs.allow : pairs.allow;
 	if (pairs.second.empty()) {
 		for (const auto& name : pairs.first) {
@@ -135,21 +145,27 @@ void ModifyPlanningScene::allowCollisions(planning_scene::PlanningScene& scene,
 // invert indicates, whether to detach instead of attach (and vice versa)
 // as well as to forbid instead of allow collision (and vice versa)
 std::pair<InterfaceState, SubTrajectory> ModifyPlanningScene::apply(const InterfaceState& from, bool invert) {
-	planning_scene::PlanningScenePtr scene = from.scene()->diff();
+	SceneBuilder builder(from.scene(), &shape_cache_);
+	const planning_scene::PlanningScenePtr& scene = builder.scene();
 	InterfaceState state(scene);
 	SubTrajectory traj;
 	try {
-		// add/remove/move objects
-		for (auto& collision_object : collision_objects_)
-			processCollisionObject(*scene, collision_object, invert);
+		// add/remove/move objects, all at once
+		const Batch& objects = batch(invert);
+		if (!objects.error.empty())
+			throw std::runtime_error(objects.error);
+		builder.processCollisionObjects(objects.objects);
 
 		// attach/detach objects
 		for (const auto& pair : attach_objects_)
 			attachObjects(*scene, pair, invert);
 
-		// allow/forbid collisions
-		for (const auto& pairs : collision_matrix_edits_)
-			allowCollisions(*scene, pairs, invert);
+		// allow/forbid collisions, modifying the scene's ACM only once
+		if (!collision_matrix_edits_.empty()) {
+			collision_detection::AllowedCollisionMatrix& acm = scene->getAllowedCollisionMatrixNonConst();
+			for (const auto& pairs : collision_matrix_edits_)
+				allowCollisions(acm, pairs, invert);
+		}
 
 		if (callback_)
 			callback_(scene, properties());
@@ -170,22 +186,34 @@ std::pair<InterfaceState, SubTrajectory> ModifyPlanningScene::apply(const Interf
 	return std::make_pair(state, traj);
 }
 
-void ModifyPlanningScene::processCollisionObject(planning_scene::PlanningScene& scene,
-                                                 const moveit_msgs::CollisionObject& object, bool invert) {
-	const auto op = object.operation;
-	if (invert) {
+const ModifyPlanningScene::Batch& ModifyPlanningScene::batch(bool invert) {
+	Batch& batch = batches_[invert];
+	if (batch.valid)
+		return batch;
+
+	batch.objects.clear();
+	batch.error.clear();
+	std::vector<moveit_msgs::CollisionObject> objects;
+	objects.reserve(collision_objects_.size());
+	for (const auto& object : collision_objects_) {
+		objects.push_back(object);
+		if (!invert)
+			continue;
+		const auto op = object.operation;
 		if (op == moveit_msgs::CollisionObject::ADD)
-			// (temporarily) change operation to REMOVE to revert adding the object
-			const_cast<moveit_msgs::CollisionObject&>(object).operation = moveit_msgs::CollisionObject::REMOVE;
+			// revert adding the object
+			objects.back().operation = moveit_msgs::CollisionObject::REMOVE;
 		else if (op == moveit_msgs::CollisionObject::REMOVE)
-			throw std::runtime_error("cannot apply removeObject() backwards");
+			batch.error = "cannot apply removeObject() backwards";
 		else if (op == moveit_msgs::CollisionObject::MOVE)
-			throw std::runtime_error("cannot apply moveObject() backwards");
+			batch.error = "cannot apply moveObject() backwards";
+		if (!batch.error.empty())
+			break;
 	}
-
-	scene.processCollisionObjectMsg(object);
-	// restore previous operation (for next call)
-	const_cast<moveit_msgs::CollisionObject&>(object).operation = op;
+	if (batch.error.empty())
+		batch.objects = SceneBuilder::coalesce(objects);
+	batch.valid = true;
+	return batch;
 }
 }  // namespace stages
 }  // namespace task_constructor
@@ -40,6 +40,7 @@
 #include <moveit/task_constructor/cost_terms.h>
 
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/kinematic_constraints/kinematic_constraint.h>
 #include <rviz_marker_tools/marker_creation.h>
 #include <tf2_eigen/tf2_eigen.h>
 
@@ -65,6 +66,10 @@ MoveRelative::MoveRelative(const std::string& name, const solvers::PlannerInterf
 
 	p.declare<moveit_msgs::Constraints>("path_constraints", moveit_msgs::Constraints(),
 	                                    "constraints to maintain during trajectory");
+
+	p.declare<double>("fast_path_distance", 0.0, "max distance of Cartesian moves planned by Jacobian integration");
+	p.declare<moveit::core::CartesianPrecision>("fast_path_precision", moveit::core::CartesianPrecision(),
+	                                            "max deviation of the fast path from the straight line");
 }
 
 void MoveRelative::setIKFrame(const Eigen::Isometry3d& pose, const std::string& link) {
@@ -105,6 +110,75 @@ static bool getJointStateFromOffset(const boost::any& direction, const Interface
 	return false;
 }
 
+static constexpr double FAST_PATH_LINEAR_STEP = 0.005;  // m
+static constexpr double FAST_PATH_ANGULAR_STEP = 0.05;  // rad
+static constexpr double FAST_PATH_MAX_JOINT_STEP = 0.1;  // rad or m, larger steps indicate a singularity
+
+/* Plan a short straight-line motion of link * offset to target by integrating the Jacobian's pseudo-inverse
+ *
+ * Each step's linear prediction is accepted only if it stays within precision of the straight line.
+ * All waypoints are validated for collisions and path constraints at the end.
+ * Returns nullptr if any of these checks fails.
+ */
+static robot_trajectory::RobotTrajectoryPtr
+integrateJacobian(const planning_scene::PlanningScene& scene, const moveit::core::JointModelGroup* jmg,
+                  const moveit::core::LinkModel& link, const Eigen::Isometry3d& offset, const Eigen::Isometry3d& target,
+                  const moveit::core::CartesianPrecision& precision, const moveit_msgs::Constraints& path_constraints) {
+	moveit::core::RobotState state(scene.getCurrentState());
+	state.update();
+	const Eigen::Isometry3d start = state.getGlobalLinkTransform(&link) * offset;
+	const Eigen::Quaterniond start_q(start.linear());
+	const Eigen::Quaterniond target_q(target.linear());
+	const double distance = (target.translation() - start.translation()).norm();
+	const double angle = start_q.angularDistance(target_q);
+	const double steps =
+	    std::max(1.0, std::ceil(std::max(distance / FAST_PATH_LINEAR_STEP, angle / FAST_PATH_ANGULAR_STEP)));
+
+	auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(scene.getRobotModel(), jmg);
+	trajectory->addSuffixWayPoint(state, 0.0);
+
+	Eigen::MatrixXd jacobian;
+	Eigen::VectorXd positions;
+	Eigen::Matrix<double, 6, 1> error;
+	for (double i = 1.0; i <= steps; i += 1.0) {
+		Eigen::Isometry3d expected(start_q.slerp(i / steps, target_q));
+		expected.translation() = start.translation() + (i / steps) * (target.translation() - start.translation());
+
+		// twist from current to expected pose, expressed in the model frame like the Jacobian
+		const Eigen::Isometry3d current = state.getGlobalLinkTransform(&link) * offset;
+		const Eigen::AngleAxisd rotation(expected.linear() * current.linear().transpose());
+		error << expected.translation() - current.translation(), rotation.angle() * rotation.axis();
+
+		if (!state.getJacobian(jmg, &link, offset.translation(), jacobian))
+			return nullptr;
+		const Eigen::VectorXd delta = jacobian.completeOrthogonalDecomposition().solve(error);
+		if (delta.cwiseAbs().maxCoeff() > FAST_PATH_MAX_JOINT_STEP)
+			return nullptr;
+
+		state.copyJointGroupPositions(jmg, positions);
+		state.setJointGroupPositions(jmg, positions + delta);
+		if (!state.satisfiesBounds(jmg))
+			return nullptr;
+		state.update();
+
+		const Eigen::Isometry3d reached = state.getGlobalLinkTransform(&link) * offset;
+		if ((reached.translation() - expected.translation()).norm() > precision.translational ||
+		    Eigen::AngleAxisd(reached.linear().transpose() * expected.linear()).angle() > precision.rotational)
+			return nullptr;
+		trajectory->addSuffixWayPoint(state, 0.0);
+	}
+
+	// validate all waypoints in one go
+	kinematic_constraints::KinematicConstraintSet kcs(scene.getRobotModel());
+	kcs.add(path_constraints, scene.getTransforms());
+	for (size_t i = 1; i < trajectory->getWayPointCount(); ++i) {
+		const moveit::core::RobotState& waypoint = trajectory->getWayPoint(i);
+		if (scene.isStateColliding(waypoint, jmg->getName()) || !kcs.decide(waypoint).satisfied)
+			return nullptr;
+	}
+	return trajectory;
+}
+
 // Create an arrow marker from start_pose to reached_pose, split into a red and green part based on achieved distance
 static void visualizePlan(std::deque<visualization_msgs::Marker>& markers, Interface::Direction dir, bool success,
                           const std::string& ns, const std::string& frame_id, const Eigen::Isometry3d& start_pose,
@@ -290,11 +364,21 @@ bool MoveRelative::compute(const InterfaceState& state, planning_scene::Planning
 		// offset from link to ik_frame
 		const Eigen::Isometry3d& offset = scene->getCurrentState().getGlobalLinkTransform(link).inverse() * ik_pose_world;
 
-		auto result =
-		    planner_->plan(state.scene(), *link, offset, target_eigen, jmg, timeout, robot_trajectory, path_constraints);
-		success = bool(result);
-		if (!success)
-			comment = result.message;
+		// short moves: try Jacobian integration before resorting to the planner
+		if ((use_rotation_distance ? angular_norm : linear_norm) <= props.get<double>("fast_path_distance"))
+			robot_trajectory = integrateJacobian(*scene, jmg, *link, offset, target_eigen,
+			                                     props.get<moveit::core::CartesianPrecision>("fast_path_precision"),
+			                                     path_constraints);
+		if (robot_trajectory) {
+			planner_->applyTimeParameterization(robot_trajectory);
+			success = true;
+		} else {
+			auto result = planner_->plan(state.scene(), *link, offset, target_eigen, jmg, timeout, robot_trajectory,
+			                             path_constraints);
+			success = bool(result);
+			if (!success)
+				comment = result.message;
+		}
 
 		if (robot_trajectory && robot_trajectory->getWayPointCount() > 0) {  // the following requires a robot_trajectory
 			                                                                  // returned from planning
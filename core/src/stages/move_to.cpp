@@ -92,6 +92,9 @@ void MoveTo::setGoal(const std::map<std::string, double>& joints) {
 void MoveTo::init(const moveit::core::RobotModelConstPtr& robot_model) {
 	PropagatingEitherWay::init(robot_model);
 	planner_->init(robot_model);
+
+	std::lock_guard<std::mutex> lock(resolved_goal_mutex_);
+	resolved_goal_.reset();  // group pointers refer to the previous robot model
 }
 
 bool MoveTo::getJointStateGoal(const boost::any& goal, const moveit::core::JointModelGroup* jmg,
@@ -174,6 +177,57 @@ bool MoveTo::getPointGoal(const boost::any& goal, const Eigen::Isometry3d& ik_po
 	return true;
 }
 
+std::shared_ptr<const MoveTo::ResolvedGoal> MoveTo::resolveGoal(const boost::any& goal,
+                                                                const moveit::core::JointModelGroup* jmg) {
+	const uint64_t generation = properties().generation();
+	{
+		std::lock_guard<std::mutex> lock(resolved_goal_mutex_);
+		if (resolved_goal_ && resolved_goal_->generation == generation && resolved_goal_->jmg == jmg)
+			return resolved_goal_;
+	}
+
+	auto resolved = std::make_shared<ResolvedGoal>();
+	resolved->generation = generation;
+	resolved->jmg = jmg;
+
+	// resolve joint-space goals on a scratch state, recording the affected variables
+	const moveit::core::RobotModel& robot_model = *jmg->getParentModel();
+	moveit::core::RobotState scratch(jmg->getParentModel());
+	scratch.setToDefaultValues();
+	if (getJointStateGoal(goal, jmg, scratch)) {
+		resolved->type = ResolvedGoal::JOINTS;
+		if (goal.type() == typeid(std::string))
+			resolved->variables = jmg->getVariableIndexList();
+		else if (const auto* msg = boost::any_cast<moveit_msgs::RobotState>(&goal)) {
+			for (const auto& name : msg->joint_state.name)
+				resolved->variables.push_back(robot_model.getVariableIndex(name));
+			for (const auto& name : msg->multi_dof_joint_state.joint_names) {
+				const moveit::core::JointModel* joint = robot_model.getJointModel(name);
+				for (size_t i = 0; i < joint->getVariableCount(); ++i)
+					resolved->variables.push_back(joint->getFirstVariableIndex() + i);
+			}
+		} else {
+			for (const auto& joint : boost::any_cast<const std::map<std::string, double>&>(goal))
+				resolved->variables.push_back(robot_model.getVariableIndex(joint.first));
+		}
+		for (int index : resolved->variables)
+			resolved->positions.push_back(scratch.getVariablePosition(index));
+	} else if (const auto* msg = boost::any_cast<geometry_msgs::PoseStamped>(&goal)) {
+		resolved->type = ResolvedGoal::POSE;
+		resolved->frame = msg->header.frame_id;
+		tf2::fromMsg(msg->pose, resolved->pose);
+	} else if (const auto* msg = boost::any_cast<geometry_msgs::PointStamped>(&goal)) {
+		resolved->type = ResolvedGoal::POINT;
+		resolved->frame = msg->header.frame_id;
+		resolved->pose.setIdentity();
+		tf2::fromMsg(msg->point, resolved->pose.translation());
+	}
+
+	std::lock_guard<std::mutex> lock(resolved_goal_mutex_);
+	resolved_goal_ = resolved;
+	return resolved;
+}
+
 bool MoveTo::compute(const InterfaceState& state, planning_scene::PlanningScenePtr& scene, SubTrajectory& solution,
                      Interface::Direction dir) {
 	scene = state.scene()->diff();
@@ -182,24 +236,30 @@ bool MoveTo::compute(const InterfaceState& state, planning_scene::PlanningSceneP
 
 	const auto& props = properties();
 	double timeout = this->timeout();
-	const std::string& group = props.get<std::string>("group");
+	const std::string& group = group_.get(props);
 	const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup(group);
 	if (!jmg) {
 		solution.markAsFailure("invalid joint model group: " + group);
 		return false;
 	}
-	boost::any goal = props.get("goal");
+	const boost::any& goal = props.get("goal");
 	if (goal.empty()) {
 		solution.markAsFailure("undefined goal");
 		return false;
 	}
 
-	const auto& path_constraints = props.get<moveit_msgs::Constraints>("path_constraints");
+	const auto& path_constraints = path_constraints_.get(props);
 	robot_trajectory::RobotTrajectoryPtr robot_trajectory;
 	bool success = false;
 	std::string comment = "";
 
-	if (getJointStateGoal(goal, jmg, scene->getCurrentStateNonConst())) {
+	const std::shared_ptr<const ResolvedGoal> resolved = resolveGoal(goal, jmg);
+	if (resolved->type == ResolvedGoal::JOINTS) {
+		moveit::core::RobotState& goal_state = scene->getCurrentStateNonConst();
+		for (size_t i = 0; i < resolved->variables.size(); ++i)
+			goal_state.setVariablePosition(resolved->variables[i], resolved->positions[i]);
+		goal_state.update();
+
 		// plan to joint-space target
 		auto result = planner_->plan(state.scene(), scene, jmg, timeout, robot_trajectory, path_constraints);
 		success = bool(result);
@@ -220,7 +280,13 @@ bool MoveTo::compute(const InterfaceState& state, planning_scene::PlanningSceneP
 			return false;
 		}
 
-		if (!getPoseGoal(goal, scene, target) && !getPointGoal(goal, ik_pose_world, scene, target)) {
+		if (resolved->type == ResolvedGoal::POSE)
+			target = scene->getFrameTransform(resolved->frame) * resolved->pose;
+		else if (resolved->type == ResolvedGoal::POINT) {
+			// retain link orientation
+			target = ik_pose_world;
+			target.translation() = scene->getFrameTransform(resolved->frame) * resolved->pose.translation();
+		} else {
 			solution.markAsFailure(std::string("invalid goal type: ") + goal.type().name());
 			return false;
 		}
@@ -229,7 +295,9 @@ bool MoveTo::compute(const InterfaceState& state, planning_scene::PlanningSceneP
 			geometry_msgs::PoseStamped msg;
 			msg.header.frame_id = scene->getPlanningFrame();
 			msg.pose = tf2::toMsg(pose);
-			rviz_marker_tools::appendFrame(solution.markers(), msg, 0.1, name);
+			solution.addMarkerGenerator([msg, name = std::string(name)](SolutionBase::Markers& markers) {
+				rviz_marker_tools::appendFrame(markers, msg, 0.1, name);
+			});
 		} };
 
 		// visualize plan with frame at target pose and frame at link
@@ -2,7 +2,7 @@
 
 #include <moveit/task_constructor/solvers/cartesian_path.h>
 
-#include <moveit/task_constructor/container.h>
+#include <moveit/task_constructor/container_p.h>
 #include <moveit/task_constructor/stages/move_relative.h>
 
 #include <moveit/planning_scene/planning_scene.h>
@@ -17,6 +17,7 @@ PickPlaceBase::PickPlaceBase(Stage::pointer&& grasp_stage, const std::string& na
 	p.declare<std::string>("object", "name of object to grasp");
 	p.declare<std::string>("eef", "end effector name");
 	p.declare<std::string>("eef_frame", "name of end effector frame");
+	p.declare<bool>("parallel_motions", false, "plan approach and lift of a grasp candidate concurrently");
 
 	// internal properties (cannot be marked as such yet)
 	p.declare<std::string>("eef_group", "JMG of eef");
@@ -83,6 +84,29 @@ void PickPlaceBase::init(const moveit::core::RobotModelConstPtr& robot_model) {
 	SerialContainer::init(robot_model);
 }
 
+void PickPlaceBase::compute() {
+	if (!properties().get<bool>("parallel_motions")) {
+		SerialContainer::compute();
+		return;
+	}
+
+	// generate grasp candidates first, such that both motions can be planned from them in this run
+	if (grasp_stage_->pimpl()->canCompute())
+		grasp_stage_->pimpl()->runCompute();
+
+	std::vector<std::function<void()>> jobs;
+	{
+		auto lock = pimpl()->lockPlanning();
+		for (const auto& stage : pimpl()->children()) {
+			StagePrivate* child = stage->pimpl();
+			if (stage.get() != grasp_stage_ && child->canCompute())
+				jobs.emplace_back([child] { child->runCompute(); });
+		}
+	}
+	// solutions of approach and lift are joined via the grasp stage's solutions
+	runConcurrently(std::move(jobs));
+}
+
 void PickPlaceBase::setApproachRetract(const geometry_msgs::TwistStamped& motion, double min_distance,
                                        double max_distance) {
 	auto& p = approach_stage_->properties();
@@ -36,13 +36,16 @@
 #include <moveit/task_constructor/stages/predicate_filter.h>
 
 #include <moveit/task_constructor/storage.h>
+#include <moveit/task_constructor/stage_p.h>
 
 #include <moveit/planning_scene/planning_scene.h>
 
 #include <moveit/robot_state/conversions.h>
 #include <moveit/robot_state/robot_state.h>
 
+#include <algorithm>
 #include <functional>
+#include <numeric>
 
 namespace moveit {
 namespace task_constructor {
@@ -52,7 +55,14 @@ PredicateFilter::PredicateFilter(const std::string& name, Stage::pointer&& child
   : WrapperBase(name, std::move(child)) {
 	auto& p = properties();
 	p.declare<Predicate>("predicate", "predicate to filter wrapped solutions");
+	p.declare<BatchPredicate>("batch_predicate", "predicate to filter all solutions of a compute() call at once");
 	p.declare<bool>("ignore_filter", false, "ignore predicate and forward all solutions");
+	p.declare<bool>("concurrent", false, "evaluate (thread-safe) predicate concurrently on the task's thread pool");
+}
+
+void PredicateFilter::reset() {
+	pending_.clear();
+	WrapperBase::reset();
 }
 
 void PredicateFilter::init(const moveit::core::RobotModelConstPtr& robot_model) {
@@ -68,7 +78,7 @@ void PredicateFilter::init(const moveit::core::RobotModelConstPtr& robot_model)
 
 	// In theory this could be set in interface states
 	// but we enforce it here to keep code flow sane and maintainable
-	if (props.get("predicate").empty()) {
+	if (props.get("predicate").empty() && props.get("batch_predicate").empty()) {
 		InitStageException e(*this, "predicate is not specified");
 		errors.append(e);
 	}
@@ -77,9 +87,26 @@ void PredicateFilter::init(const moveit::core::RobotModelConstPtr& robot_model)
 		throw errors;
 }
 
+bool PredicateFilter::canCompute() const {
+	return !pending_.empty() || WrapperBase::canCompute();
+}
+
+void PredicateFilter::compute() {
+	if (WrapperBase::canCompute())
+		WrapperBase::compute();
+	evaluatePending();
+}
+
 void PredicateFilter::onNewSolution(const SolutionBase& s) {
 	const auto& props = properties();
 
+	// defer evaluation until the child's compute() finished
+	if (!props.get<bool>("ignore_filter") &&
+	    (props.get<bool>("concurrent") || !props.get("batch_predicate").empty())) {
+		pending_.push_back(&s);
+		return;
+	}
+
 	// false-positive in clang-tidy 10.0.0: predicate might change comment
 	// NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
 	std::string comment = s.comment();
@@ -90,6 +117,51 @@ void PredicateFilter::onNewSolution(const SolutionBase& s) {
 
 	liftSolution(s, cost, comment);
 }
+
+void PredicateFilter::evaluatePending() {
+	std::vector<const SolutionBase*> solutions;
+	{
+		auto lock = pimpl()->lockPlanning();
+		solutions.swap(pending_);
+	}
+	if (solutions.empty())
+		return;
+
+	const auto& props = properties();
+	std::vector<std::string> comments;
+	comments.reserve(solutions.size());
+	for (const SolutionBase* s : solutions)
+		comments.push_back(s->comment());
+
+	std::vector<bool> accepted;
+	if (!props.get("batch_predicate").empty()) {
+		accepted = props.get<BatchPredicate>("batch_predicate")(solutions, comments);
+		if (accepted.size() != solutions.size())
+			throw std::runtime_error("batch_predicate returned " + std::to_string(accepted.size()) + " results for " +
+			                         std::to_string(solutions.size()) + " solutions");
+	} else {
+		const Predicate& predicate = props.get<Predicate>("predicate");
+		// std::vector<bool> is not safe for concurrent writes
+		std::vector<char> results(solutions.size());
+		std::vector<std::function<void()>> jobs;
+		jobs.reserve(solutions.size());
+		for (size_t i = 0; i < solutions.size(); ++i)
+			jobs.emplace_back([&, i] { results[i] = predicate(*solutions[i], comments[i]); });
+		runConcurrently(std::move(jobs));
+		accepted.assign(results.begin(), results.end());
+	}
+
+	// forward in cost order
+	std::vector<size_t> order(solutions.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+	                 [&solutions](size_t a, size_t b) { return solutions[a]->cost() < solutions[b]->cost(); });
+
+	auto lock = pimpl()->lockPlanning();
+	for (size_t i : order)
+		liftSolution(*solutions[i], accepted[i] ? solutions[i]->cost() : std::numeric_limits<double>::infinity(),
+		             comments[i]);
+}
 }  // namespace stages
 }  // namespace task_constructor
 }  // namespace moveit
@@ -0,0 +1,475 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Wrapper distributing the computation of its child stage to remote worker nodes
+ */
+
+#include <moveit/task_constructor/stages/remote_stage.h>
+#include <moveit/task_constructor/container_p.h>
+#include <moveit/task_constructor/storage.h>
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+#include <actionlib/client/simple_action_client.h>
+#include <actionlib/server/simple_action_server.h>
+
+#include <list>
+#include <map>
+
+namespace moveit {
+namespace task_constructor {
+namespace stages {
+
+using moveit_task_constructor_msgs::ComputeStageAction;
+using moveit_task_constructor_msgs::ComputeStageGoal;
+using moveit_task_constructor_msgs::ComputeStageResult;
+using moveit_task_constructor_msgs::RemoteSolution;
+using moveit_task_constructor_msgs::RemoteState;
+
+namespace {
+constexpr char LOGNAME[] = "RemoteStage";
+
+void toMsg(const PropertyMap& properties, std::vector<moveit_task_constructor_msgs::Property>& msg) {
+	for (const auto& pair : properties) {
+		const Property& p = pair.second;
+		if (!p.defined())
+			continue;
+		msg.emplace_back();
+		msg.back().name = pair.first;
+		msg.back().description = p.description();
+		msg.back().type = p.typeName();
+		const std::string wire = Property::encode(p.value());
+		msg.back().value_binary.assign(wire.begin(), wire.end());
+	}
+}
+
+void fromMsg(const std::vector<moveit_task_constructor_msgs::Property>& msg, PropertyMap& properties) {
+	for (const auto& p : msg) {
+		boost::any value = p.value_binary.empty() ?
+		                       Property::deserialize(p.type, p.value) :
+		                       Property::decode(p.type, std::string(p.value_binary.begin(), p.value_binary.end()));
+		if (value.empty())
+			ROS_WARN_STREAM_NAMED(LOGNAME, "Cannot decode property '" << p.name << "' of type " << p.type);
+		else
+			properties.set<boost::any>(p.name, value);
+	}
+}
+
+// scene described by a (diff or full) scene msg, w.r.t. the given base scene
+planning_scene::PlanningScenePtr toScene(const planning_scene::PlanningSceneConstPtr& base,
+                                         const moveit_msgs::PlanningScene& msg) {
+	planning_scene::PlanningScenePtr scene = base->diff();
+	if (msg.is_diff)
+		scene->setPlanningSceneDiffMsg(msg);
+	else
+		scene->setPlanningSceneMsg(msg);
+	return scene;
+}
+}  // namespace
+
+struct RemoteStage::Worker
+{
+	explicit Worker(const std::string& name) : client(name, true) {}
+
+	actionlib::SimpleActionClient<ComputeStageAction> client;
+	Batch batch;  // inputs of the goal in flight, empty if idle
+};
+
+RemoteStage::RemoteStage(const std::string& name, Stage::pointer&& child) : WrapperBase(name, std::move(child)) {
+	auto& p = properties();
+	p.declare<std::vector<std::string>>("workers", { "compute_stage" }, "action names of worker nodes");
+	p.declare<uint32_t>("batch_size", 10, "maximum number of inputs sent in a single goal");
+}
+
+RemoteStage::~RemoteStage() = default;
+
+void RemoteStage::reset() {
+	// cancel goals in flight: their inputs are gone
+	for (auto& worker : workers_) {
+		if (!worker->batch.empty())
+			worker->client.cancelGoal();
+		worker->batch.clear();
+	}
+	sent_pairs_.clear();
+	WrapperBase::reset();
+}
+
+void RemoteStage::init(const moveit::core::RobotModelConstPtr& robot_model) {
+	InitStageException errors;
+	try {
+		WrapperBase::init(robot_model);
+	} catch (InitStageException& e) {
+		errors.append(e);
+	}
+	robot_model_ = robot_model;
+
+	if (wrapped() && wrapped()->pimpl()->requiredInterface() == GENERATE)
+		errors.push_back(*this, "remote execution is only supported for propagating and connecting stages");
+
+	const auto& names = properties().get<std::vector<std::string>>("workers");
+	if (names.empty())
+		errors.push_back(*this, "no workers specified");
+	else if (names != worker_names_) {
+		workers_.clear();
+		for (const auto& name : names)
+			workers_.push_back(std::make_unique<Worker>(name));
+		worker_names_ = names;
+	}
+
+	if (errors)
+		throw errors;
+
+	for (const auto& worker : workers_)
+		if (!worker->client.isServerConnected() && !worker->client.waitForServer(ros::Duration(1.0)))
+			ROS_WARN_STREAM_NAMED(LOGNAME, "Worker not (yet) available for stage '" << name() << "'");
+}
+
+uint8_t RemoteStage::mode() const {
+	const InterfaceFlags required = wrapped()->pimpl()->requiredInterface();
+	if (required == PROPAGATE_FORWARDS)
+		return ComputeStageGoal::FORWARD;
+	if (required == PROPAGATE_BACKWARDS)
+		return ComputeStageGoal::BACKWARD;
+	return ComputeStageGoal::CONNECT;
+}
+
+bool RemoteStage::collectInputs(Batch& batch, uint32_t max_size) {
+	auto impl = wrapped()->pimpl();
+	const uint8_t m = mode();
+	if (m == ComputeStageGoal::CONNECT) {
+		for (const InterfaceState* from : *impl->starts()) {
+			if (!from->priority().enabled())
+				break;
+			for (const InterfaceState* to : *impl->ends()) {
+				if (!to->priority().enabled())
+					break;
+				if (!sent_pairs_.insert(std::make_pair(from, to)).second)
+					continue;
+				batch.push_back(from);
+				batch.push_back(to);
+				if (batch.size() >= 2 * max_size)
+					return true;
+			}
+		}
+	} else {
+		const InterfacePtr& pull = m == ComputeStageGoal::FORWARD ? impl->starts() : impl->ends();
+		while (batch.size() < max_size && !pull->empty() && pull->front()->priority().enabled())
+			batch.push_back(pull->remove(pull->begin()).front());
+	}
+	return !batch.empty();
+}
+
+bool RemoteStage::canCompute() const {
+	bool connected = false;
+	for (const auto& worker : workers_) {
+		if (!worker->batch.empty())
+			return true;
+		connected = connected || worker->client.isServerConnected();
+	}
+	// without any worker, inputs cannot be sent: report this once per loss of connection
+	if (!connected) {
+		if (!disconnected_)
+			ROS_WARN_STREAM_NAMED(LOGNAME, "No worker connected for stage '" << name() << "'");
+		disconnected_ = true;
+		return false;
+	}
+	disconnected_ = false;
+
+	auto impl = wrapped()->pimpl();
+	auto enabled = [](const InterfaceConstPtr& interface) {
+		return interface && !interface->empty() && interface->front()->priority().enabled();
+	};
+	if (mode() != ComputeStageGoal::CONNECT)
+		return enabled(impl->starts()) || enabled(impl->ends());
+
+	// any enabled pair not yet sent?
+	if (!enabled(impl->starts()) || !enabled(impl->ends()))
+		return false;
+	for (const InterfaceState* from : *impl->starts()) {
+		if (!from->priority().enabled())
+			break;
+		for (const InterfaceState* to : *impl->ends()) {
+			if (!to->priority().enabled())
+				break;
+			if (!sent_pairs_.count(std::make_pair(from, to)))
+				return true;
+		}
+	}
+	return false;
+}
+
+bool RemoteStage::collectResults() {
+	bool progress = false;
+	for (auto& worker : workers_) {
+		if (worker->batch.empty())
+			continue;
+		const auto state = worker->client.getState();
+		if (!state.isDone())
+			continue;
+
+		progress = true;
+		Batch batch;
+		batch.swap(worker->batch);
+		auto result = worker->client.getResult();
+		if (state == actionlib::SimpleClientGoalState::SUCCEEDED && result)
+			processResult(batch, *result);
+		else
+			processFailure(batch, "remote computation failed: " + state.toString());
+	}
+	return progress;
+}
+
+void RemoteStage::compute() {
+	auto lock = pimpl()->lockPlanning();
+	bool progress = collectResults();
+
+	const uint8_t m = mode();
+	const uint32_t batch_size = std::max<uint32_t>(1, properties().get<uint32_t>("batch_size"));
+	for (auto& worker : workers_) {
+		if (!worker->batch.empty() || !worker->client.isServerConnected())
+			continue;
+		if (!collectInputs(worker->batch, batch_size))
+			break;
+
+		ComputeStageGoal goal;
+		goal.mode = m;
+		goal.states.resize(worker->batch.size());
+		for (size_t i = 0; i < worker->batch.size(); ++i) {
+			const InterfaceState& state = *worker->batch[i];
+			state.scene()->getPlanningSceneMsg(goal.states[i].scene);
+			toMsg(state.properties(), goal.states[i].properties);
+		}
+		worker->client.sendGoal(goal);
+		progress = true;
+	}
+
+	if (progress)
+		return;
+
+	// nothing to do locally: wait (briefly) for a result, allowing other stages to proceed meanwhile
+	lock.unlock();
+	for (auto& worker : workers_)
+		if (!worker->batch.empty() && worker->client.waitForResult(ros::Duration(0.01)))
+			break;
+}
+
+namespace {
+SubTrajectoryPtr toSolution(const moveit::core::RobotModelConstPtr& robot_model,
+                            const moveit::core::RobotState& reference, const RemoteSolution& msg) {
+	robot_trajectory::RobotTrajectoryPtr trajectory;
+	if (!msg.solution.trajectory.joint_trajectory.points.empty() ||
+	    !msg.solution.trajectory.multi_dof_joint_trajectory.points.empty()) {
+		trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model, nullptr);
+		trajectory->setRobotTrajectoryMsg(reference, msg.solution.trajectory);
+	}
+	auto solution = std::make_shared<SubTrajectory>(trajectory, msg.solution.info.cost, msg.solution.info.comment);
+	solution->markers() = msg.solution.info.markers;
+	if (msg.failure)
+		solution->markAsFailure(msg.solution.info.comment);
+	return solution;
+}
+}  // namespace
+
+void RemoteStage::processResult(const Batch& batch, const ComputeStageResult& result) {
+	auto impl = wrapped()->pimpl();
+	const uint8_t m = mode();
+	const size_t stride = m == ComputeStageGoal::CONNECT ? 2 : 1;
+
+	for (const RemoteSolution& msg : result.solutions) {
+		if ((msg.input + 1) * stride > batch.size()) {
+			ROS_WARN_STREAM_NAMED(LOGNAME, "Ignoring remote solution with invalid input index " << msg.input);
+			continue;
+		}
+		const InterfaceState& input = *batch[msg.input * stride];
+
+		if (m == ComputeStageGoal::CONNECT) {
+			const InterfaceState& to = *batch[msg.input * stride + 1];
+			impl->connect(input, to, toSolution(robot_model_, input.scene()->getCurrentState(), msg));
+			continue;
+		}
+
+		InterfaceState state(toScene(input.scene(), msg.solution.scene_diff));
+		fromMsg(msg.properties, state.properties());
+		// trajectories always start at the scene of the solution's start state
+		const InterfaceState& start = m == ComputeStageGoal::FORWARD ? input : state;
+		auto solution = toSolution(robot_model_, start.scene()->getCurrentState(), msg);
+		if (m == ComputeStageGoal::FORWARD)
+			impl->sendForward(input, std::move(state), solution);
+		else
+			impl->sendBackward(std::move(state), input, solution);
+	}
+}
+
+void RemoteStage::processFailure(const Batch& batch, const std::string& comment) {
+	ROS_WARN_STREAM_NAMED(LOGNAME, comment);
+	auto impl = wrapped()->pimpl();
+	const uint8_t m = mode();
+	auto failure = [&comment]() {
+		auto solution = std::make_shared<SubTrajectory>();
+		solution->markAsFailure(comment);
+		return solution;
+	};
+	if (m == ComputeStageGoal::CONNECT) {
+		for (size_t i = 0; i + 1 < batch.size(); i += 2)
+			impl->connect(*batch[i], *batch[i + 1], failure());
+		return;
+	}
+	for (const InterfaceState* input : batch) {
+		if (m == ComputeStageGoal::FORWARD)
+			impl->sendForward(*input, InterfaceState(input->scene()->diff()), failure());
+		else
+			impl->sendBackward(InterfaceState(input->scene()->diff()), *input, failure());
+	}
+}
+
+void RemoteStage::onNewSolution(const SolutionBase& s) {
+	liftSolution(s);
+}
+
+struct RemoteStageServer::Server
+{
+	Server(const std::string& action_name, RemoteStageServer& owner)
+	  : server(nh, action_name,
+	           [this, &owner](const moveit_task_constructor_msgs::ComputeStageGoalConstPtr& goal) {
+		           server.setSucceeded(owner.compute(*goal));
+	           },
+	           false) {
+		server.start();
+	}
+
+	ros::NodeHandle nh;
+	actionlib::SimpleActionServer<ComputeStageAction> server;
+};
+
+RemoteStageServer::RemoteStageServer(const std::string& action_name, Stage::pointer&& stage,
+                                     const moveit::core::RobotModelConstPtr& robot_model)
+  : stage_(std::move(stage))
+  , robot_model_(robot_model)
+  , prev_ends_(std::make_shared<Interface>())
+  , next_starts_(std::make_shared<Interface>()) {
+	if (!action_name.empty())
+		server_ = std::make_unique<Server>(action_name, *this);
+}
+
+RemoteStageServer::~RemoteStageServer() = default;
+
+void RemoteStageServer::prepare(InterfaceFlags flags) {
+	auto impl = stage_->pimpl();
+	stage_->reset();
+	prev_ends_->clear();
+	next_starts_->clear();
+	impl->setPrevEnds(flags & WRITES_PREV_END ? prev_ends_ : nullptr);
+	impl->setNextStarts(flags & WRITES_NEXT_START ? next_starts_ : nullptr);
+	stage_->init(robot_model_);
+	impl->resolveInterface(flags);
+}
+
+void RemoteStageServer::collect(uint32_t input, const InterfaceState* state, bool forward,
+                                ComputeStageResult& result) {
+	auto process = [&](const SolutionBaseConstPtr& s) {
+		const auto* sub = dynamic_cast<const SubTrajectory*>(s.get());
+		if (!sub) {
+			ROS_WARN_STREAM_NAMED(LOGNAME, "Remote stages need to yield SubTrajectory solutions");
+			return;
+		}
+		const InterfaceState* input_state = forward ? s->start() : s->end();
+		const InterfaceState* output_state = forward ? s->end() : s->start();
+		if (state && input_state != state)
+			return;  // solution of another input
+
+		moveit_task_constructor_msgs::Solution msg;
+		sub->appendTo(msg);
+		result.solutions.emplace_back();
+		RemoteSolution& r = result.solutions.back();
+		r.input = input;
+		r.solution = msg.sub_trajectory.front();
+		r.failure = s->isFailure();
+		if (state)  // propagation created a new state
+			toMsg(output_state->properties(), r.properties);
+	};
+	for (const auto& s : stage_->solutions())
+		process(s);
+	for (const auto& s : stage_->failures())
+		process(s);
+}
+
+ComputeStageResult RemoteStageServer::compute(const ComputeStageGoal& goal) {
+	ComputeStageResult result;
+	auto impl = stage_->pimpl();
+	std::list<InterfaceState> inputs;  // stable addresses
+	auto add = [&](const RemoteState& msg, const InterfacePtr& interface) -> const InterfaceState* {
+		auto scene = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+		scene->setPlanningSceneMsg(msg.scene);
+		inputs.emplace_back(scene, InterfaceState::Priority(1, 0.0));
+		fromMsg(msg.properties, inputs.back().properties());
+		interface->add(inputs.back());
+		return &inputs.back();
+	};
+	auto run = [&]() {
+		while (impl->canCompute())
+			impl->runCompute();
+	};
+
+	try {
+		if (goal.mode == ComputeStageGoal::CONNECT) {
+			// compute pairs individually: connecting stages would try all combinations otherwise
+			for (uint32_t i = 0; i + 1 < goal.states.size(); i += 2) {
+				prepare(CONNECT);
+				inputs.clear();
+				add(goal.states[i], impl->starts());
+				add(goal.states[i + 1], impl->ends());
+				run();
+				collect(i / 2, nullptr, true, result);
+			}
+		} else {
+			const bool forward = goal.mode == ComputeStageGoal::FORWARD;
+			prepare(forward ? PROPAGATE_FORWARDS : PROPAGATE_BACKWARDS);
+			inputs.clear();
+			std::vector<const InterfaceState*> states;
+			for (const auto& msg : goal.states)
+				states.push_back(add(msg, forward ? impl->starts() : impl->ends()));
+			run();
+			for (uint32_t i = 0; i < states.size(); ++i)
+				collect(i, states[i], forward, result);
+		}
+	} catch (const InitStageException& e) {
+		ROS_ERROR_STREAM_NAMED(LOGNAME, "Failed to initialize remote stage:\n" << e);
+	}
+	stage_->reset();
+	return result;
+}
+}  // namespace stages
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,75 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Register default-constructible stages for use with TaskDescription
+*/
+
+#include <moveit/task_constructor/task_description.h>
+#include <moveit/task_constructor/stages.h>
+#include <moveit/task_constructor/stages/generate_random_pose.h>
+#include <moveit/task_constructor/stages/noop.h>
+#include <moveit/task_constructor/stages/passthrough.h>
+
+namespace moveit {
+namespace task_constructor {
+namespace stages {
+
+namespace {
+struct Registrar
+{
+	Registrar() {
+		TaskDescription::registerStageType<CurrentState>("CurrentState");
+		TaskDescription::registerStageType<FixedState>("FixedState");
+		TaskDescription::registerStageType<FixedCartesianPoses>("FixedCartesianPoses");
+		TaskDescription::registerStageType<FixCollisionObjects>("FixCollisionObjects");
+		TaskDescription::registerStageType<GeneratePose>("GeneratePose");
+		TaskDescription::registerStageType<GenerateRandomPose>("GenerateRandomPose");
+		TaskDescription::registerStageType<GenerateGraspPose>("GenerateGraspPose");
+		TaskDescription::registerStageType<GenerateGraspPoseFromDatabase>("GenerateGraspPoseFromDatabase");
+		TaskDescription::registerStageType<GeneratePlacePose>("GeneratePlacePose");
+		TaskDescription::registerStageType<ModifyPlanningScene>("ModifyPlanningScene");
+		TaskDescription::registerStageType<ComputeIK>("ComputeIK");
+		TaskDescription::registerStageType<PassThrough>("PassThrough");
+		TaskDescription::registerStageType<NoOp>("NoOp");
+		TaskDescription::registerStageType<RemoteStage>("RemoteStage");
+		TaskDescription::registerStageType("PredicateFilter", typeid(PredicateFilter),
+		                                   [] { return std::make_unique<PredicateFilter>("predicate filter"); });
+	}
+};
+// stages requiring solvers (Connect, MoveTo, MoveRelative) need factories provided by the user
+const Registrar REGISTRAR;
+}  // namespace
+}  // namespace stages
+}  // namespace task_constructor
+}  // namespace moveit
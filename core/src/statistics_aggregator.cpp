@@ -0,0 +1,159 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Aggregated statistics of many tasks, published on a single topic
+*/
+
+#include <moveit/task_constructor/statistics_aggregator.h>
+#include <moveit/task_constructor/task_p.h>
+
+#include <ros/node_handle.h>
+
+#include <cstdint>
+#include <limits>
+
+namespace moveit {
+namespace task_constructor {
+
+StatisticsAggregator::StatisticsAggregator(double rate, const std::string& topic)
+  : period_(rate > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate)) :
+                         Clock::duration::zero()) {
+	// only publish if ros::init() was called
+	if (ros::isInitialized())
+		publisher_ = ros::NodeHandle().advertise<moveit_task_constructor_msgs::FleetStatistics>(topic, 1);
+}
+
+StatisticsAggregator::Entry& StatisticsAggregator::entry(const Task& task) {
+	auto inserted = entries_.emplace(&task, Entry());
+	Entry& e = inserted.first->second;
+	if (inserted.second) {
+		e.summary.id = reinterpret_cast<std::uintptr_t>(&task);
+		e.summary.best_cost = std::numeric_limits<double>::infinity();
+		e.summary.time_to_first_solution = -1.0;
+	}
+	return e;
+}
+
+void StatisticsAggregator::summarize(const Task& task, moveit_task_constructor_msgs::TaskSummary& summary) {
+	const std::string& ns = task.pimpl()->ns();
+	summary.name = ns.empty() ? task.name() : ns;
+	const auto& solutions = task.solutions();
+	summary.num_solutions = solutions.size();
+	summary.best_cost = solutions.empty() ? std::numeric_limits<double>::infinity() : solutions.front()->cost();
+
+	summary.stage_names.clear();
+	summary.stage_compute_times.clear();
+	task.stages()->traverseRecursively([&summary](const Stage& stage, unsigned int /*depth*/) {
+		summary.stage_names.push_back(stage.name());
+		summary.stage_compute_times.push_back(stage.getTotalComputeTime());
+		return true;
+	});
+}
+
+void StatisticsAggregator::planStarted(const Task& task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		Entry& e = entry(task);
+		e.plan_start = Clock::now();
+		e.summary.planning = true;
+		e.summary.time_to_first_solution = -1.0;
+	}
+	update(task, true);
+}
+
+void StatisticsAggregator::update(const Task& task, bool force) {
+	const auto now = Clock::now();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		Entry& e = entry(task);
+		// record the time to the first solution precisely, regardless of rate limiting
+		if (e.summary.planning && e.summary.time_to_first_solution < 0.0 && !task.solutions().empty())
+			e.summary.time_to_first_solution = std::chrono::duration<double>(now - e.plan_start).count();
+		if (!force && now - e.last_update < period_)
+			return;
+		e.last_update = now;
+	}
+
+	// summarize outside the lock: only the planning thread modifies the task
+	moveit_task_constructor_msgs::TaskSummary summary;
+	summarize(task, summary);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		Entry& e = entry(task);
+		summary.id = e.summary.id;
+		summary.planning = e.summary.planning;
+		summary.time_to_first_solution = e.summary.time_to_first_solution;
+		e.summary = std::move(summary);
+	}
+	publish();
+}
+
+void StatisticsAggregator::planFinished(const Task& task) {
+	update(task, true);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		entry(task).summary.planning = false;
+	}
+	publish(true);
+}
+
+void StatisticsAggregator::remove(const Task& task) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.erase(&task);
+}
+
+void StatisticsAggregator::fill(moveit_task_constructor_msgs::FleetStatistics& msg) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	msg.tasks.clear();
+	msg.tasks.reserve(entries_.size());
+	for (const auto& e : entries_)
+		msg.tasks.push_back(e.second.summary);
+}
+
+void StatisticsAggregator::publish(bool force) {
+	if (!publisher_)
+		return;
+	moveit_task_constructor_msgs::FleetStatistics msg;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		const auto now = Clock::now();
+		if (!force && now - last_published_ < period_)
+			return;
+		last_published_ = now;
+	}
+	fill(msg);
+	publisher_.publish(msg);
+}
+}  // namespace task_constructor
+}  // namespace moveit
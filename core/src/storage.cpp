@@ -38,14 +38,44 @@
 #include <moveit/task_constructor/stage_p.h>
 #include <moveit/task_constructor/storage.h>
 #include <moveit/task_constructor/introspection.h>
+#include <moveit/task_constructor/solvers/planner_interface.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <ros/serialization.h>
+#include <algorithm>
 #include <assert.h>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
 
 namespace moveit {
 namespace task_constructor {
 
+namespace {
+std::string serialize(const moveit_msgs::PlanningScene& msg) {
+	std::string buffer(ros::serialization::serializationLength(msg), '\0');
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[0]), buffer.size());
+	ros::serialization::serialize(stream, msg);
+	return buffer;
+}
+
+/// move scene diffs of sub trajectories into msg.scene_table, storing identical ones only once
+void deduplicateScenes(moveit_task_constructor_msgs::Solution& msg) {
+	// key by serialized content: hashing and comparison of the byte streams detect identical diffs
+	std::unordered_map<std::string, uint32_t> index;
+	for (auto& t : msg.sub_trajectory) {
+		if (t.scene_diff_index)
+			continue;
+		auto inserted = index.emplace(serialize(t.scene_diff), msg.scene_table.size() + 1);
+		if (inserted.second)
+			msg.scene_table.push_back(std::move(t.scene_diff));
+		t.scene_diff = moveit_msgs::PlanningScene();
+		t.scene_diff_index = inserted.first->second;
+	}
+}
+}  // namespace
+
 planning_scene::PlanningSceneConstPtr ensureUpdated(const planning_scene::PlanningScenePtr& scene) {
 	// ensure scene's state is updated
 	if (scene->getCurrentState().dirty())
@@ -69,6 +99,52 @@ InterfaceState::InterfaceState(const planning_scene::PlanningSceneConstPtr& ps,
 InterfaceState::InterfaceState(const InterfaceState& other)
   : scene_(other.scene_), properties_(other.properties_), priority_(other.priority_) {}
 
+size_t InterfaceState::sceneDiffDepth() const {
+	size_t depth = 0;
+	for (auto parent = scene_->getParent(); parent; parent = parent->getParent())
+		++depth;
+	return depth;
+}
+
+bool InterfaceState::boundSceneDiffDepth(size_t max_depth) {
+	if (max_depth == 0 || sceneDiffDepth() <= max_depth)
+		return false;
+	// clone() decouples the copy from all parent scenes
+	scene_ = planning_scene::PlanningScene::clone(scene_);
+	clearSceneMsgs();
+	return true;
+}
+
+void InterfaceState::applySceneDiff(const moveit_msgs::PlanningScene& diff) {
+	if (!scene_)
+		return;
+	planning_scene::PlanningScenePtr scene = scene_->diff();
+	scene->setPlanningSceneDiffMsg(diff);
+	scene_ = scene;
+	clearSceneMsgs();
+}
+
+std::shared_ptr<const moveit_msgs::PlanningScene> InterfaceState::sceneMsg(bool diff) const {
+	auto& cache = scene_msgs_[diff];
+	std::shared_ptr<const moveit_msgs::PlanningScene> msg = std::atomic_load(&cache);
+	if (msg || !scene_)
+		return msg;
+
+	auto converted = std::make_shared<moveit_msgs::PlanningScene>();
+	if (diff)
+		scene_->getPlanningSceneDiffMsg(*converted);
+	else
+		scene_->getPlanningSceneMsg(*converted);
+	msg = std::move(converted);
+	std::atomic_store(&cache, msg);  // concurrent conversions yield identical messages
+	return msg;
+}
+
+void InterfaceState::clearSceneMsgs() const {
+	for (auto& cache : scene_msgs_)
+		std::atomic_store(&cache, std::shared_ptr<const moveit_msgs::PlanningScene>());
+}
+
 bool InterfaceState::Priority::operator<(const InterfaceState::Priority& other) const {
 	// first order by status if that differs
 	if (status() != other.status())
@@ -78,13 +154,18 @@ bool InterfaceState::Priority::operator<(const InterfaceState::Priority& other)
 	if (depth() != other.depth())
 		return depth() > other.depth();  // larger depth = smaller prio!
 
-	// finally by cost
+	// finally by cost (including the estimated cost-to-go)
+	const double f = cost() + estimate();
+	const double other_f = other.cost() + other.estimate();
+	if (f != other_f)
+		return f < other_f;
 	return cost() < other.cost();
 }
 
 void InterfaceState::updatePriority(const InterfaceState::Priority& priority) {
-	// Never overwrite ARMED with PRUNED
-	if (priority.status() == InterfaceState::Status::PRUNED && priority_.status() == InterfaceState::Status::ARMED)
+	// Never overwrite ARMED with PRUNED (unless the state was merely parked outside the beam)
+	if (priority.status() == InterfaceState::Status::PRUNED && priority_.status() == InterfaceState::Status::ARMED &&
+	    !beam_parked_)
 		return;
 
 	if (owner()) {
@@ -101,6 +182,43 @@ Interface::Interface(const Interface::NotifyFunction& notify) : notify_(notify)
 
 // Announce a new InterfaceState
 void Interface::add(InterfaceState& state) {
+	if (!inbox_enabled_) {
+		addNow(state);
+		return;
+	}
+	assert(state.owner_ == nullptr);
+	state.inbox_next_ = inbox_.load(std::memory_order_relaxed);
+	while (!inbox_.compare_exchange_weak(state.inbox_next_, &state, std::memory_order_release,
+	                                     std::memory_order_relaxed))
+		;
+}
+
+size_t Interface::drain() {
+	InterfaceState* head = inbox_.exchange(nullptr, std::memory_order_acquire);
+	// reverse the stack to insert states in the order they were added
+	InterfaceState* fifo = nullptr;
+	size_t count = 0;
+	while (head) {
+		InterfaceState* next = head->inbox_next_;
+		head->inbox_next_ = fifo;
+		fifo = head;
+		head = next;
+		++count;
+	}
+	while (fifo) {
+		InterfaceState* state = fifo;
+		fifo = state->inbox_next_;
+		state->inbox_next_ = nullptr;
+		// the state might have been pruned while waiting
+		const InterfaceState::Status status = state->priority().status();
+		addNow(*state);
+		if (status != state->priority().status())
+			updatePriority(state, InterfaceState::Priority(state->priority(), status));
+	}
+	return count;
+}
+
+void Interface::addNow(InterfaceState& state) {
 	// require valid scene
 	assert(state.scene());
 	// incoming and outgoing must not contain elements both
@@ -115,6 +233,7 @@ void Interface::add(InterfaceState& state) {
 	std::list<InterfaceState*> container;
 	Interface::iterator it = container.insert(container.end(), &state);
 	it->owner_ = this;
+	it->position_ = it;  // list nodes are stable across splicing
 
 	// if either incoming or outgoing is defined, derive priority from there
 	if (!state.incomingTrajectories().empty())
@@ -125,31 +244,68 @@ void Interface::add(InterfaceState& state) {
 		assert(it->priority_.enabled());
 		assert(it->priority_.depth() >= 1u);
 	}
+	if (cost_to_go_)
+		it->priority_ = it->priority_.withEstimate(cost_to_go_(state, cost_to_go_dir_));
 
-	// move list node into interface's state list (sorted by priority)
-	moveFrom(it, container);
+	// move list node into interface's state list (sorted by priority, if requested)
+	if (sorted_)
+		moveFrom(it, container);
+	else
+		c.splice(c.end(), container, it);
+	markModified();
 	// and finally call notify callback
 	if (notify_)
 		notify_(it, UpdateFlags());
+	if (beam_width_) {
+		trackBeam(&*it);
+		if (it->priority_.enabled())
+			++beam_slots_;
+	}
+	// branch-and-bound: prune states that cannot improve on the best solution anymore
+	if (it->priority_.enabled() && exceedsCostBound(*it))
+		it->updateStatus(InterfaceState::Status::PRUNED);
+	balanceBeam();
 }
 
 Interface::container_type Interface::remove(iterator it) {
+	if (beam_width_)
+		untrackBeam(&*it);
 	container_type result;
-	moveTo(it, result, result.end());
+	if (sorted_)
+		moveTo(it, result, result.end());
+	else
+		result.splice(result.end(), c, it);
 	it->owner_ = nullptr;
+	it->beam_parked_ = false;
+	markModified();
 	return result;
 }
 
-void Interface::updatePriority(InterfaceState* state, const InterfaceState::Priority& priority) {
+void Interface::clear() {
+	// states might be destroyed already: don't access them
+	enabled_states_.clear();
+	parked_states_.clear();
+	beam_slots_ = 0;
+	base_type::clear();
+	markModified();
+}
+
+void Interface::updatePriority(InterfaceState* state, const InterfaceState::Priority& new_prio) {
 	const auto old_prio = state->priority();
+	// the estimated cost-to-go is a property of the state, independent of the path leading to it
+	const InterfaceState::Priority priority = new_prio.withEstimate(old_prio.estimate());
 	if (priority == old_prio)
 		return;  // nothing to do
 
-	auto it = std::find(begin(), end(), state);  // find iterator to state
-	assert(it != end());  // state should be part of this interface
+	assert(state->owner_ == this);  // state should be part of this interface
+	iterator it = state->position_;  // constant-time lookup of state's list node
 
+	if (beam_width_)
+		untrackBeam(state);  // sets are ordered by the old priority
 	state->priority_ = priority;  // update priority
-	update(it);  // update position in ordered list
+	if (sorted_)
+		update(it);  // update position in ordered list
+	markModified();
 
 	if (notify_) {
 		UpdateFlags updated(Update::ALL);
@@ -158,6 +314,99 @@ void Interface::updatePriority(InterfaceState* state, const InterfaceState::Prio
 
 		notify_(it, updated);  // notify callback
 	}
+
+	if (beam_width_) {
+		if (priority.status() != InterfaceState::Status::ARMED)
+			state->beam_parked_ = false;
+		trackBeam(state);
+		if (old_prio.enabled() != priority.enabled()) {
+			if (priority.enabled())
+				++beam_slots_;
+			else if (beam_slots_ > 0)
+				--beam_slots_;
+			balanceBeam();
+		}
+	}
+}
+
+void Interface::setBeamWidth(size_t width) {
+	if (width == 0) {  // re-enable all parked states
+		beam_width_ = 0;
+		std::vector<InterfaceState*> parked(parked_states_.begin(), parked_states_.end());
+		enabled_states_.clear();
+		parked_states_.clear();
+		for (InterfaceState* state : parked) {
+			state->beam_parked_ = false;
+			updatePriority(state, InterfaceState::Priority(state->priority(), InterfaceState::Status::ENABLED));
+		}
+		beam_slots_ = 0;
+		return;
+	}
+	if (!beam_width_) {  // start tracking the beam's boundary
+		beam_width_ = width;
+		for (InterfaceState* state : c)
+			trackBeam(state);
+	}
+	beam_width_ = width;
+	beam_slots_ = enabled_states_.size();
+	balanceBeam();
+}
+
+void Interface::releaseBeamSlot() {
+	if (beam_slots_ > 0)
+		--beam_slots_;
+	balanceBeam();
+}
+
+size_t Interface::widenBeam() {
+	if (!beam_width_)
+		return 0;
+	beam_slots_ = enabled_states_.size();
+	const size_t before = beam_slots_;
+	balanceBeam();
+	return beam_slots_ > before ? beam_slots_ - before : 0;
+}
+
+void Interface::balanceBeam() {
+	if (!beam_width_ || beam_balancing_)
+		return;
+	beam_balancing_ = true;
+
+	// park the worst enabled state while there are too many (otherwise, excess slots are held by fetched states)
+	while (beam_slots_ > beam_width_ && !enabled_states_.empty()) {
+		InterfaceState* worst = *enabled_states_.rbegin();
+		worst->beam_parked_ = true;
+		updatePriority(worst, InterfaceState::Priority(worst->priority(), InterfaceState::Status::ARMED));  // frees slot
+	}
+	// re-enable the best parked state while there are free slots
+	while (beam_slots_ < beam_width_ && !parked_states_.empty()) {
+		InterfaceState* best = *parked_states_.begin();
+		best->beam_parked_ = false;
+		updatePriority(best, InterfaceState::Priority(best->priority(), InterfaceState::Status::ENABLED));  // takes slot
+	}
+	beam_balancing_ = false;
+}
+
+bool Interface::PriorityLess::operator()(const InterfaceState* a, const InterfaceState* b) const {
+	if (a->priority() < b->priority())
+		return true;
+	if (b->priority() < a->priority())
+		return false;
+	return std::less<const InterfaceState*>()(a, b);  // distinguish states of equal priority
+}
+
+void Interface::trackBeam(InterfaceState* state) {
+	if (state->owner_ != this)
+		return;  // removed meanwhile, e.g. by the notify callback
+	if (state->priority().enabled())
+		enabled_states_.insert(state);
+	else if (state->beam_parked_)
+		parked_states_.insert(state);
+}
+
+void Interface::untrackBeam(InterfaceState* state) {
+	enabled_states_.erase(state);
+	parked_states_.erase(state);
 }
 
 std::ostream& operator<<(std::ostream& os, const Interface& interface) {
@@ -175,8 +424,10 @@ const char* InterfaceState::STATUS_COLOR_[] = {
 };
 std::ostream& operator<<(std::ostream& os, const InterfaceState::Priority& prio) {
 	// maps InterfaceState::Status values to output (color-changing) prefix
-	os << InterfaceState::colorForStatus(prio.status()) << prio.depth() << ":" << prio.cost()
-	   << InterfaceState::colorForStatus(3);
+	os << InterfaceState::colorForStatus(prio.status()) << prio.depth() << ":" << prio.cost();
+	if (prio.estimate() != 0.0)
+		os << "+" << prio.estimate();
+	os << InterfaceState::colorForStatus(3);
 	return os;
 }
 std::ostream& operator<<(std::ostream& os, Interface::Direction dir) {
@@ -193,6 +444,35 @@ void SolutionBase::setCost(double cost) {
 	cost_ = cost;
 }
 
+double SolutionBase::computeCachedCost(const CostTerm& cost, std::string& comment) const {
+	const uint64_t term = cost.id();
+	const uint64_t version = cost.version();
+	auto cache = std::atomic_load(&cost_cache_);
+	if (cache)
+		for (const CachedCost& entry : *cache)
+			if (entry.term == term && entry.version == version) {
+				comment = entry.comment;
+				return entry.cost;
+			}
+
+	std::string computed_comment;
+	const double result = computeCost(cost, computed_comment);
+
+	// publish an updated copy, replacing an outdated result of the same term
+	std::shared_ptr<std::vector<CachedCost>> updated;
+	do {
+		updated = cache ? std::make_shared<std::vector<CachedCost>>(*cache) : std::make_shared<std::vector<CachedCost>>();
+		auto it = std::find_if(updated->begin(), updated->end(),
+		                       [term](const CachedCost& entry) { return entry.term == term; });
+		if (it == updated->end())
+			it = updated->insert(it, CachedCost());
+		*it = CachedCost{ term, version, result, computed_comment };
+	} while (!std::atomic_compare_exchange_weak(&cost_cache_, &cache,
+	                                             std::shared_ptr<const std::vector<CachedCost>>(updated)));
+	comment = std::move(computed_comment);
+	return result;
+}
+
 void SolutionBase::markAsFailure(const std::string& msg) {
 	setCost(std::numeric_limits<double>::infinity());
 	if (!msg.empty()) {
@@ -204,9 +484,28 @@ void SolutionBase::markAsFailure(const std::string& msg) {
 	}
 }
 
-void SolutionBase::toMsg(moveit_task_constructor_msgs::Solution& msg, Introspection* introspection) const {
+void SolutionBase::generateComment() const {
+	std::lock_guard<std::mutex> lock(generation_mutex_.mutex);
+	if (!comment_generator_)
+		return;
+	comment_ += comment_generator_();
+	comment_generator_ = nullptr;
+}
+
+void SolutionBase::generateMarkers() const {
+	std::lock_guard<std::mutex> lock(generation_mutex_.mutex);
+	for (const auto& generator : marker_generators_)
+		generator(markers_);
+	marker_generators_.clear();
+}
+
+void SolutionBase::toMsg(moveit_task_constructor_msgs::Solution& msg, Introspection* introspection,
+                         bool deduplicate_scenes) const {
 	appendTo(msg, introspection);
-	start()->scene()->getPlanningSceneMsg(msg.start_scene);
+	if (auto scene = start()->sceneMsg())  // might be evicted
+		msg.start_scene = *scene;
+	if (deduplicate_scenes)
+		deduplicateScenes(msg);
 }
 
 void SolutionBase::fillInfo(moveit_task_constructor_msgs::SolutionInfo& info, Introspection* introspection) const {
@@ -228,13 +527,85 @@ void SubTrajectory::appendTo(moveit_task_constructor_msgs::Solution& msg, Intros
 
 	t.execution_info = creator()->trajectoryExecutionInfo();
 
+	finalizeTimeParameterization();
 	if (trajectory())
-		trajectory()->getRobotTrajectoryMsg(t.trajectory);
+		compressedTrajectory()->getRobotTrajectoryMsg(t.trajectory);
 
-	if (this->end()->scene()->getParent() == this->start()->scene())
-		this->end()->scene()->getPlanningSceneDiffMsg(t.scene_diff);
-	else
-		this->end()->scene()->getPlanningSceneMsg(t.scene_diff);
+	if (!this->end()->scene())  // evicted
+		return;
+	// states shared by several solutions are converted only once
+	t.scene_diff = *this->end()->sceneMsg(this->end()->scene()->getParent() == this->start()->scene());
+}
+
+robot_trajectory::RobotTrajectoryConstPtr SubTrajectory::compressedTrajectory() const {
+	if (!trajectory() || !creator())
+		return trajectory();
+	const PropertyMap& p = creator()->properties();
+	const double joint_tolerance = p.get<double>("compression_joint_tolerance");
+	const double cartesian_tolerance = p.get<double>("compression_cartesian_tolerance");
+	if (joint_tolerance <= 0.0 && cartesian_tolerance <= 0.0)
+		return trajectory();
+
+	const auto trajectory = std::atomic_load(&trajectory_);
+	auto cached = std::atomic_load(&compressed_);
+	if (cached && cached->source == trajectory.get() && cached->joint_tolerance == joint_tolerance &&
+	    cached->cartesian_tolerance == cartesian_tolerance)
+		return cached->trajectory;
+
+	// concurrent first accesses might compress twice, which is harmless
+	cached = std::make_shared<const Compressed>(Compressed{
+	    trajectory.get(), joint_tolerance, cartesian_tolerance,
+	    compressTrajectory(*trajectory, joint_tolerance, cartesian_tolerance) });
+	std::atomic_store(&compressed_, cached);
+	if (std::atomic_load(&trajectory_) != trajectory)  // replaced meanwhile: drop the outdated copy
+		std::atomic_store(&compressed_, std::shared_ptr<const Compressed>());
+	return cached->trajectory;
+}
+
+void SubTrajectory::finalizeTimeParameterization() const {
+	auto trajectory = std::atomic_load(&trajectory_);
+	if (!trajectory)
+		return;
+	robot_trajectory::RobotTrajectoryConstPtr timed = solvers::finalizeTimeParameterization(*trajectory);
+	// concurrent calls receive the same copy: only one of them needs to replace the trajectory
+	if (timed && std::atomic_compare_exchange_strong(&trajectory_, &trajectory, timed)) {
+		// times changed
+		std::atomic_store(&waypoints_, std::shared_ptr<const Waypoints>());
+		std::atomic_store(&compressed_, std::shared_ptr<const Compressed>());
+	}
+}
+
+std::shared_ptr<const SubTrajectory::Waypoints> SubTrajectory::waypoints() const {
+	if (auto cached = std::atomic_load(&waypoints_))
+		return cached;
+	const auto trajectory = std::atomic_load(&trajectory_);
+	if (!trajectory)
+		return nullptr;
+
+	// concurrent first accesses might build the view twice, which is harmless
+	auto result = std::make_shared<Waypoints>();
+	const moveit::core::JointModelGroup* jmg = trajectory->getGroup();
+	const size_t rows = trajectory->getWayPointCount();
+	const size_t cols = jmg ? jmg->getVariableCount() : trajectory->getRobotModel()->getVariableCount();
+	result->group = jmg;
+	result->positions.resize(rows, cols);
+	result->times.resize(rows);
+	double time = 0.0;
+	for (size_t i = 0; i != rows; ++i) {
+		const moveit::core::RobotState& state = trajectory->getWayPoint(i);
+		if (jmg)
+			state.copyJointGroupPositions(jmg, result->positions.row(i).data());
+		else
+			std::copy_n(state.getVariablePositions(), cols, result->positions.row(i).data());
+		result->times[i] = (time += trajectory->getWayPointDurationFromPrevious(i));
+	}
+	std::shared_ptr<const Waypoints> view = std::move(result);
+	std::atomic_store(&waypoints_, view);
+	if (std::atomic_load(&trajectory_) != trajectory) {  // replaced meanwhile: drop the outdated view
+		std::atomic_store(&waypoints_, std::shared_ptr<const Waypoints>());
+		return waypoints();
+	}
+	return view;
 }
 
 double SubTrajectory::computeCost(const CostTerm& f, std::string& comment) const {
@@ -285,18 +656,203 @@ double SolutionSequence::computeCost(const CostTerm& f, std::string& comment) co
 }
 
 void WrappedSolution::appendTo(moveit_task_constructor_msgs::Solution& solution, Introspection* introspection) const {
-	wrapped_->appendTo(solution, introspection);
-
-	// prepend this solutions info as a SubSolution msg
-	moveit_task_constructor_msgs::SubSolution sub_msg;
-	SolutionBase::fillInfo(sub_msg.info, introspection);
-	sub_msg.sub_solution_id.push_back(introspection ? introspection->solutionId(*wrapped_) : 0);
-	solution.sub_solution.insert(solution.sub_solution.begin(), std::move(sub_msg));
+	innermost_->appendTo(solution, introspection);
+
+	// prepend infos of the whole chain of wrappers (outermost first) as SubSolution msgs in a single insertion
+	std::vector<moveit_task_constructor_msgs::SubSolution> chain;
+	for (const SolutionBase* s = this; s != innermost_;) {
+		const auto* w = static_cast<const WrappedSolution*>(s);
+		chain.emplace_back();
+		w->fillInfo(chain.back().info, introspection);
+		chain.back().sub_solution_id.push_back(introspection ? introspection->solutionId(*w->wrapped_) : 0);
+		s = w->wrapped_;
+	}
+	solution.sub_solution.insert(solution.sub_solution.begin(), std::make_move_iterator(chain.begin()),
+	                             std::make_move_iterator(chain.end()));
 }
 
 double WrappedSolution::computeCost(const CostTerm& f, std::string& comment) const {
 	return f(*this, comment);
 }
 
+void flatten(const SolutionBase& solution, std::vector<const SubTrajectory*>& result) {
+	if (const auto* sequence = dynamic_cast<const SolutionSequence*>(&solution)) {
+		for (const SolutionBase* sub : sequence->solutions())
+			flatten(*sub, result);
+	} else if (const auto* wrapped = dynamic_cast<const WrappedSolution*>(&solution))
+		flatten(*wrapped->innermost(), result);
+	else if (const auto* sub = dynamic_cast<const SubTrajectory*>(&solution))
+		result.push_back(sub);
+}
+
+namespace {
+// non-empty trajectories of solution's SubTrajectories in execution order, with finalized time parameterization
+std::vector<const robot_trajectory::RobotTrajectory*> collectTrajectories(const SolutionBase& solution) {
+	std::vector<const SubTrajectory*> subs;
+	flatten(solution, subs);
+
+	std::vector<const robot_trajectory::RobotTrajectory*> result;
+	result.reserve(subs.size());
+	for (const SubTrajectory* sub : subs) {
+		sub->finalizeTimeParameterization();
+		// the sub solution keeps its (finalized) trajectory alive
+		const auto trajectory = sub->trajectory();
+		if (trajectory && !trajectory->empty())
+			result.push_back(trajectory.get());
+	}
+	return result;
+}
+}  // namespace
+
+FlatTrajectory flattenTrajectory(const SolutionBase& solution) {
+	FlatTrajectory result;
+	const auto trajectories = collectTrajectories(solution);
+	if (trajectories.empty())
+		return result;
+
+	size_t num_waypoints = 0;
+	for (const auto* trajectory : trajectories)
+		num_waypoints += trajectory->getWayPointCount();
+
+	result.variable_names = trajectories.front()->getRobotModel()->getVariableNames();
+	const size_t num_variables = result.variable_names.size();
+	result.times.reserve(num_waypoints);
+	result.positions.reserve(num_waypoints * num_variables);
+	result.velocities.reserve(num_waypoints * num_variables);
+
+	double offset = 0.0;
+	for (const auto* trajectory : trajectories) {
+		// skip first waypoint of subsequent trajectories: it coincides with the previous end
+		for (size_t i = result.times.empty() ? 0 : 1, end = trajectory->getWayPointCount(); i < end; ++i) {
+			const moveit::core::RobotState& waypoint = trajectory->getWayPoint(i);
+			result.times.push_back(offset + trajectory->getWayPointDurationFromStart(i));
+
+			const double* positions = waypoint.getVariablePositions();
+			result.positions.insert(result.positions.end(), positions, positions + num_variables);
+			if (waypoint.hasVelocities()) {
+				const double* velocities = waypoint.getVariableVelocities();
+				result.velocities.insert(result.velocities.end(), velocities, velocities + num_variables);
+			} else
+				result.velocities.resize(result.velocities.size() + num_variables, 0.0);
+		}
+		offset += trajectory->getDuration();
+	}
+	return result;
+}
+
+robot_trajectory::RobotTrajectoryPtr concatenateTrajectories(const SolutionBase& solution) {
+	robot_trajectory::RobotTrajectoryPtr result;
+	for (const auto* trajectory : collectTrajectories(solution)) {
+		if (!result) {
+			result = std::make_shared<robot_trajectory::RobotTrajectory>(trajectory->getRobotModel(), nullptr);
+			result->append(*trajectory, 0.0);
+		} else  // skip first waypoint, coinciding with the previous end
+			result->append(*trajectory, 0.0, 1);
+	}
+	return result;
+}
+
+robot_trajectory::RobotTrajectoryPtr compressTrajectory(const robot_trajectory::RobotTrajectory& trajectory,
+                                                        double joint_tolerance, double cartesian_tolerance) {
+	auto result = std::make_shared<robot_trajectory::RobotTrajectory>(trajectory.getRobotModel(), trajectory.getGroup());
+	const size_t num_waypoints = trajectory.getWayPointCount();
+	if (num_waypoints == 0)
+		return result;
+
+	const moveit::core::JointModelGroup* jmg = trajectory.getGroup();
+	const auto& joints = jmg ? jmg->getActiveJointModels() : trajectory.getRobotModel()->getActiveJointModels();
+	std::vector<const moveit::core::LinkModel*> tips;
+	if (jmg && cartesian_tolerance > 0.0) {
+		jmg->getEndEffectorTips(tips);
+		if (tips.empty() && !jmg->getLinkModels().empty())
+			tips.push_back(jmg->getLinkModels().back());
+	}
+	if (joint_tolerance <= 0.0 && tips.empty()) {  // nothing to check against: keep all waypoints
+		result->append(trajectory, 0.0);
+		return result;
+	}
+
+	auto time = [&trajectory](size_t i) { return trajectory.getWayPointDurationFromStart(i); };
+	moveit::core::RobotState interpolated(trajectory.getFirstWayPoint());
+	// interpolate waypoint i from waypoints first and last, w.r.t. time or index if not timed
+	auto interpolate = [&](size_t first, size_t last, size_t i) {
+		const double span = time(last) - time(first);
+		const double alpha = span > 0.0 ? (time(i) - time(first)) / span : double(i - first) / double(last - first);
+		trajectory.getWayPoint(first).interpolate(trajectory.getWayPoint(last), alpha, interpolated);
+	};
+
+	// tip positions of all waypoints, computed once
+	std::vector<Eigen::Vector3d> tip_positions;
+	if (!tips.empty()) {
+		tip_positions.reserve(num_waypoints * tips.size());
+		moveit::core::RobotState waypoint(trajectory.getFirstWayPoint());
+		for (size_t i = 0; i < num_waypoints; ++i) {
+			waypoint = trajectory.getWayPoint(i);
+			waypoint.updateLinkTransforms();
+			for (const moveit::core::LinkModel* tip : tips)
+				tip_positions.push_back(waypoint.getGlobalLinkTransform(tip).translation());
+		}
+	}
+
+	// deviation of waypoint i from the interpolation between first and last, relative to the tolerances
+	auto deviation = [&](size_t first, size_t last, size_t i) {
+		interpolate(first, last, i);
+		double result = 0.0;
+		if (joint_tolerance > 0.0) {
+			const moveit::core::RobotState& original = trajectory.getWayPoint(i);
+			for (const moveit::core::JointModel* jm : joints)
+				result = std::max(result, jm->distance(interpolated.getJointPositions(jm), original.getJointPositions(jm)) /
+				                              joint_tolerance);
+		}
+		if (!tips.empty()) {
+			interpolated.updateLinkTransforms();
+			for (size_t t = 0; t < tips.size(); ++t) {
+				const Eigen::Vector3d& expected = tip_positions[i * tips.size() + t];
+				result = std::max(result, (interpolated.getGlobalLinkTransform(tips[t]).translation() - expected).norm() /
+				                              cartesian_tolerance);
+			}
+		}
+		return result;
+	};
+
+	// Douglas-Peucker: split segments at their most deviating waypoint until all dropped ones are within tolerance
+	std::vector<bool> keep(num_waypoints, false);
+	keep.front() = keep.back() = true;
+	std::vector<std::pair<size_t, size_t>> segments;
+	if (num_waypoints > 2)
+		segments.emplace_back(0, num_waypoints - 1);
+	while (!segments.empty()) {
+		const size_t first = segments.back().first;
+		const size_t last = segments.back().second;
+		segments.pop_back();
+
+		double max_deviation = 1.0;
+		size_t split = last;
+		for (size_t i = first + 1; i < last; ++i) {
+			const double d = deviation(first, last, i);
+			if (d > max_deviation) {
+				max_deviation = d;
+				split = i;
+			}
+		}
+		if (split == last)
+			continue;  // all inner waypoints can be dropped
+		keep[split] = true;
+		if (split - first > 1)
+			segments.emplace_back(first, split);
+		if (last - split > 1)
+			segments.emplace_back(split, last);
+	}
+
+	result->addSuffixWayPoint(trajectory.getWayPoint(0), trajectory.getWayPointDurationFromPrevious(0));
+	for (size_t i = 1, previous = 0; i < num_waypoints; ++i) {
+		if (!keep[i])
+			continue;
+		result->addSuffixWayPoint(trajectory.getWayPoint(i), time(i) - time(previous));
+		previous = i;
+	}
+	return result;
+}
+
 }  // namespace task_constructor
 }  // namespace moveit
@@ -38,6 +38,9 @@
 #include <moveit/task_constructor/container_p.h>
 #include <moveit/task_constructor/task_p.h>
 #include <moveit/task_constructor/introspection.h>
+#include <moveit/task_constructor/plan_recording.h>
+#include <moveit/task_constructor/robot_model_cache.h>
+#include <moveit/task_constructor/trace.h>
 #include <moveit_task_constructor_msgs/ExecuteTaskSolutionAction.h>
 
 #include <ros/ros.h>
@@ -45,10 +48,17 @@
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/plan_execution/plan_execution.h>
+#include <moveit/utils/message_checks.h>
 
 #include <scope_guard/scope_guard.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace {
 std::string rosNormalizeName(const std::string& name) {
@@ -68,13 +78,47 @@ std::string rosNormalizeName(const std::string& name) {
 	}
 	return n;
 }
+
+std::string formatBytes(std::size_t bytes) {
+	static const char* units[] = { "B", "KiB", "MiB", "GiB" };
+	double value = bytes;
+	std::size_t unit = 0;
+	for (; value >= 1024.0 && unit + 1 < sizeof(units) / sizeof(units[0]); ++unit)
+		value /= 1024.0;
+	return unit == 0 ? fmt::format("{} B", bytes) : fmt::format("{:.1f} {}", value, units[unit]);
+}
+
+// number of plan() iterations between checks of the memory budget
+constexpr size_t MEMORY_CHECK_INTERVAL = 16;
 }  // namespace
 
 namespace moveit {
 namespace task_constructor {
 
 TaskPrivate::TaskPrivate(Task* me, const std::string& ns)
-  : WrapperBasePrivate(me, std::string()), ns_(rosNormalizeName(ns)), preempt_requested_(false) {}
+  : WrapperBasePrivate(me, std::string())
+  , ns_(rosNormalizeName(ns))
+  , preempt_requested_(false)
+  , initialized_(false)
+  , reuse_structure_(false)
+  , stage_watchdog_(false)
+  , hardware_counters_(false)
+  , concurrent_costs_(false)
+  , num_threads_(1)
+  , shared_thread_pool_(false)
+  , max_scene_diff_depth_(0)
+  , event_log_capacity_(0)
+  , memory_budget_(0)
+  , pruned_state_expiry_(0.0)
+  , cost_pruning_slack_(std::numeric_limits<double>::infinity())
+  , cost_bound_(std::numeric_limits<double>::infinity())
+  , pruned_cost_bound_(std::numeric_limits<double>::infinity())
+  , beam_width_(0)
+  , max_stored_failures_(0)
+  , compact_failures_(false)
+  , solution_diversity_(0.0)
+  , solution_distance_(SolutionDistance::END_STATE)
+  , interface_inbox_(false) {}
 
 TaskPrivate& TaskPrivate::operator=(TaskPrivate&& other) {
 	this->WrapperBasePrivate::operator=(std::move(other));
@@ -82,6 +126,38 @@ TaskPrivate& TaskPrivate::operator=(TaskPrivate&& other) {
 	robot_model_ = std::move(other.robot_model_);
 	robot_model_loader_ = std::move(other.robot_model_loader_);
 	task_cbs_ = std::move(other.task_cbs_);
+	num_threads_ = other.num_threads_;
+	thread_pool_ = std::move(other.thread_pool_);
+	shared_thread_pool_ = other.shared_thread_pool_;
+	thread_options_ = std::move(other.thread_options_);
+	solver_pool_ = std::move(other.solver_pool_);
+	solution_pool_ = std::move(other.solution_pool_);
+	scheduler_ = std::move(other.scheduler_);
+	planning_deadline_.stage_share = other.planning_deadline_.stage_share;
+	stage_watchdog_ = other.stage_watchdog_;
+	watchdog_ = std::move(other.watchdog_);
+	hardware_counters_ = other.hardware_counters_;
+	concurrent_costs_ = other.concurrent_costs_;
+	diagnostics_ = std::move(other.diagnostics_);
+	if (other.statistics_aggregator_)  // report under the new task's address
+		other.statistics_aggregator_->remove(*static_cast<const Task*>(other.me_));
+	statistics_aggregator_ = std::move(other.statistics_aggregator_);
+	plan_recording_ = std::move(other.plan_recording_);
+	max_scene_diff_depth_ = other.max_scene_diff_depth_;
+	trace_file_ = std::move(other.trace_file_);
+	event_log_capacity_ = other.event_log_capacity_;
+	event_log_ = std::move(other.event_log_);
+	event_log_file_ = std::move(other.event_log_file_);
+	memory_budget_ = other.memory_budget_;
+	pruned_state_expiry_ = other.pruned_state_expiry_;
+	cost_to_go_ = std::move(other.cost_to_go_);
+	cost_pruning_slack_ = other.cost_pruning_slack_;
+	beam_width_ = other.beam_width_;
+	interface_inbox_ = other.interface_inbox_;
+	max_stored_failures_ = other.max_stored_failures_;
+	compact_failures_ = other.compact_failures_;
+	solution_diversity_ = other.solution_diversity_;
+	solution_distance_ = other.solution_distance_;
 	// Ensure same introspection status, but keep the existing introspection instance,
 	// which stores this task pointer and includes it in its task_id_
 	static_cast<Task*>(me_)->enableIntrospection(static_cast<bool>(other.introspection_));
@@ -118,6 +194,8 @@ Task& Task::operator=(Task&& other) {  // NOLINT(performance-noexcept-move-const
 Task::~Task() {
 	auto impl = pimpl();
 	impl->introspection_.reset();  // stop introspection
+	if (impl->statistics_aggregator_)
+		impl->statistics_aggregator_->remove(*this);
 	clear();  // remove all stages
 	impl->robot_model_.reset();
 	// only destroy loader after all references to the model are gone!
@@ -137,8 +215,9 @@ void Task::setRobotModel(const core::RobotModelConstPtr& robot_model) {
 
 void Task::loadRobotModel(const std::string& robot_description) {
 	auto impl = pimpl();
-	impl->robot_model_loader_ = std::make_shared<robot_model_loader::RobotModelLoader>(robot_description);
-	setRobotModel(impl->robot_model_loader_->getModel());
+	impl->robot_model_loader_ = RobotModelCache::load(robot_description);
+	if (impl->robot_model_loader_)
+		setRobotModel(impl->robot_model_loader_->getModel());
 	if (!impl->robot_model_)
 		throw Exception("Task failed to construct RobotModel");
 }
@@ -196,6 +275,41 @@ void Task::reset() {
 		impl->introspection_->reset();
 
 	WrapperBase::reset();
+	impl->initialized_ = false;
+	impl->reuse_structure_ = false;
+	impl->resetCostBound();
+	impl->pruned_since_.clear();
+}
+
+void Task::softReset() {
+	auto impl = pimpl();
+	if (!impl->initialized_) {
+		reset();
+		return;
+	}
+
+	auto set_keep_structure = [impl](bool keep) {
+		impl->setKeepStructure(keep);
+		impl->traverseStages(
+		    [keep](Stage& stage, int /*depth*/) {
+			    stage.pimpl()->setKeepStructure(keep);
+			    return true;
+		    },
+		    1, UINT_MAX);
+	};
+	set_keep_structure(true);
+	auto guard = sg::make_scope_guard([&set_keep_structure]() noexcept { set_keep_structure(false); });
+
+	WrapperBase::reset();
+	impl->reuse_structure_ = true;
+	impl->resetCostBound();
+	impl->pruned_since_.clear();
+
+	// signal introspection, that this task was reset, and republish the unchanged structure
+	if (impl->introspection_) {
+		impl->introspection_->reset();
+		impl->introspection_->publishTaskDescription();
+	}
 }
 
 void Task::init() {
@@ -210,31 +324,106 @@ void Task::init() {
 
 	// and *afterwards* initialize all children recursively
 	stages()->init(impl->robot_model_);
+	// complete solutions of the root pipeline are lifted as requested by plan(), i.e. best-first up to max_solutions
+	if (auto* serial = dynamic_cast<SerialContainerPrivate*>(stages()->pimpl()))
+		serial->setLiftOnRequest(true);
 	// task expects its wrapped child to push to both ends, this triggers interface resolution
 	stages()->pimpl()->resolveInterface(InterfaceFlags({ GENERATE }));
 
-	// provide introspection instance and preempt_requested to all stages
+	// (re)create own thread pool if needed: calling thread is used as a worker too
+	if (!impl->shared_thread_pool_) {
+		if (impl->num_threads_ <= 1)
+			impl->thread_pool_.reset();
+		else if (!impl->thread_pool_ || impl->thread_pool_->size() != impl->num_threads_ - 1 ||
+		         impl->thread_pool_->options() != impl->thread_options_)
+			impl->thread_pool_ = std::make_shared<ThreadPool>(impl->num_threads_ - 1, impl->thread_options_);
+	}
+	ThreadPool* pool = impl->thread_pool_.get();
+	ThreadPool* solver_pool = impl->solver_pool_.get();
+	std::recursive_mutex* planning_mutex = pool || solver_pool ? &impl->planning_mutex_ : nullptr;
+
+	if (!impl->stage_watchdog_)
+		impl->watchdog_.reset();
+	else if (!impl->watchdog_)
+		impl->watchdog_ = std::make_unique<Watchdog>();
+	Watchdog* watchdog = impl->watchdog_.get();
+	if (impl->hardware_counters_ && !PerfCounters::available())
+		ROS_WARN_NAMED("Task", "Hardware counters are unavailable: check perf_event support and perf_event_paranoid");
+
+	// solutions of all stages are allocated from a shared pool, which is kept across reset()
+	if (!impl->solution_pool_)
+		impl->solution_pool_ = std::make_shared<RecyclingPool>();
+	impl->setSolutionPool(impl->solution_pool_);
+
+	// keep the event log (and its recorded events) as long as its capacity doesn't change
+	if (impl->event_log_capacity_ == 0)
+		impl->event_log_.reset();
+	else if (!impl->event_log_ || impl->event_log_->capacity() != impl->event_log_capacity_)
+		impl->event_log_ = std::make_shared<EventLog>(impl->event_log_capacity_);
+	EventLog* event_log = impl->event_log_.get();
+	uint32_t num_logged_stages = 0;
+
+	// provide introspection instance, preempt_requested, thread pool, and solution pool to all stages
 	auto* introspection = impl->introspection_.get();
 	impl->traverseStages(
-	    [introspection, impl](Stage& stage, int /*depth*/) {
+	    [introspection, impl, pool, solver_pool, planning_mutex, watchdog, event_log,
+	     &num_logged_stages](Stage& stage, int /*depth*/) {
 		    stage.pimpl()->setIntrospection(introspection);
+		    if (event_log) {
+			    // refer to stages by their introspection ids, if available
+			    const uint32_t id = introspection ? introspection->stageId(&stage) : ++num_logged_stages;
+			    event_log->setStageName(id, stage.name());
+			    stage.pimpl()->setEventLog(event_log, id);
+		    } else
+			    stage.pimpl()->setEventLog(nullptr, 0);
 		    stage.pimpl()->setPreemptRequestedMember(&impl->preempt_requested_);
+		    stage.pimpl()->setPlanningDeadlineMember(&impl->planning_deadline_);
+		    stage.pimpl()->setThreadPool(pool, planning_mutex);
+		    stage.pimpl()->setSolverPool(solver_pool);
+		    // containers' timeouts and hardware counters refer to their children
+		    stage.pimpl()->setWatchdog(dynamic_cast<ComputeBase*>(&stage) ? watchdog : nullptr);
+		    stage.pimpl()->setHardwareCounters(impl->hardware_counters_ && dynamic_cast<ComputeBase*>(&stage));
+		    stage.pimpl()->setConcurrentCosts(impl->concurrent_costs_ && dynamic_cast<ComputeBase*>(&stage));
+		    stage.pimpl()->setSolutionPool(impl->solution_pool_);
+		    stage.pimpl()->setMaxSceneDiffDepth(impl->max_scene_diff_depth_);
+		    stage.pimpl()->setCostToGo(impl->cost_to_go_);
+		    stage.pimpl()->setCostBound(std::isfinite(impl->cost_pruning_slack_) ? &impl->cost_bound_ : nullptr);
+		    if (auto* propagator = dynamic_cast<PropagatingEitherWay*>(&stage)) {
+			    // beams rely on stages consuming their states in priority order
+			    stage.pimpl()->setBeamWidth(impl->beam_width_);
+			    propagator->setPlanRecording(impl->plan_recording_);
+		    }
+		    stage.pimpl()->setInboxEnabled(impl->interface_inbox_);
+		    stage.pimpl()->setFailureStorage(impl->max_stored_failures_, impl->compact_failures_);
 		    return true;
 	    },
 	    1, UINT_MAX);
+	// near-duplicates are only filtered among top-level solutions
+	stages()->pimpl()->setSolutionDiversity(impl->solution_diversity_, impl->solution_distance_);
+	// allow reading top-level solutions while planning
+	stages()->enableSolutionSnapshots();
+
+	if (impl->scheduler_)
+		impl->scheduler_->init(*stages());
 
 	// first time publish task
 	if (introspection)
 		introspection->publishTaskDescription();
+	impl->initialized_ = true;
 }
 
 bool Task::canCompute() const {
+	if (const auto& scheduler = pimpl()->scheduler_)
+		return scheduler->canCompute(*stages());
 	return stages()->canCompute();
 }
 
 void Task::compute() {
 	try {
-		stages()->pimpl()->runCompute();
+		if (const auto& scheduler = pimpl()->scheduler_)
+			scheduler->compute(*stages());
+		else
+			stages()->pimpl()->runCompute();
 	} catch (const PreemptStageException& e) {
 		// do nothing, needed for early stop
 	}
@@ -245,32 +434,728 @@ moveit::core::MoveItErrorCode Task::plan(size_t max_solutions) {
 	auto guard = sg::make_scope_guard([this]() noexcept { this->resetPreemptRequest(); });
 
 	auto impl = pimpl();
-	init();
+	// close solution streams once planning finished
+	auto stream_guard = sg::make_scope_guard([impl]() noexcept { impl->closeSolutionStreams(); });
+	// after softReset(), the initialized structure is reused
+	if (!impl->reuse_structure_)
+		init();
+	impl->reuse_structure_ = false;
+
+	// record a timeline of this planning run if requested
+	if (!impl->trace_file_.empty())
+		Tracer::instance().start();
+	auto trace_guard = sg::make_scope_guard([impl]() noexcept {
+		if (impl->trace_file_.empty())
+			return;
+		Tracer::instance().stop();
+		if (!Tracer::instance().write(impl->trace_file_))
+			ROS_ERROR_STREAM_NAMED("Task", "Failed to write trace to " << impl->trace_file_);
+	});
 
 	// Print state and return success if there are solutions otherwise the input error_code
-	const auto success_or = [this](const int32_t error_code) -> int32_t {
+	const auto success_or = [this, impl](const int32_t error_code) -> int32_t {
+		// always publish the final state, regardless of rate limiting
+		if (impl->introspection_)
+			impl->introspection_->publishTaskState(true);
+		if (impl->plan_recording_ && impl->plan_recording_->records())
+			impl->recordInputScene();
+		if (impl->diagnostics_) {
+			impl->diagnostics_->planFinished(*stages(), numSolutions() > 0);
+			impl->diagnostics_->publish(*stages());
+		}
+		if (impl->statistics_aggregator_)
+			impl->statistics_aggregator_->planFinished(*this);
 		if (numSolutions() > 0)
 			return moveit::core::MoveItErrorCode::SUCCESS;
+		impl->writeEventLog();
 		printState();
 		explainFailure();
 		return error_code;
 	};
 	const double available_time = timeout();
 	const auto start_time = std::chrono::steady_clock::now();
-	while (canCompute() && (max_solutions == 0 || numSolutions() < max_solutions)) {
+	impl->planning_deadline_.deadline =
+	    std::isfinite(available_time) ?
+	        start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	                         std::chrono::duration<double>(available_time)) :
+	        std::chrono::steady_clock::time_point::max();
+	size_t iterations = 0;
+	if (impl->diagnostics_)
+		impl->diagnostics_->planStarted(*stages());
+	if (impl->statistics_aggregator_)
+		impl->statistics_aggregator_->planStarted(*this);
+	impl->drainInboxes();
+	impl->liftPendingSolutions(max_solutions);
+	while ((canCompute() || impl->widenBeams()) && (max_solutions == 0 || numSolutions() < max_solutions)) {
 		if (impl->preempt_requested_)
 			return success_or(moveit::core::MoveItErrorCode::PREEMPTED);
 		if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() >= available_time)
 			return success_or(moveit::core::MoveItErrorCode::TIMED_OUT);
 		compute();
+		impl->drainInboxes();
+		impl->liftPendingSolutions(max_solutions);
+		if (impl->cost_bound_ < impl->pruned_cost_bound_)
+			impl->pruneByCost();
+		if ((impl->memory_budget_ || impl->pruned_state_expiry_ > 0.0) && ++iterations % MEMORY_CHECK_INTERVAL == 0) {
+			if (impl->pruned_state_expiry_ > 0.0)
+				impl->evictExpiredStates();
+			if (impl->memory_budget_)
+				impl->enforceMemoryBudget();
+		}
 		for (const auto& cb : impl->task_cbs_)
 			cb(*this);
 		if (impl->introspection_)
 			impl->introspection_->publishTaskState();
+		if (impl->diagnostics_) {
+			if (numSolutions() > 0)
+				impl->diagnostics_->firstSolution();
+			impl->diagnostics_->publish(*stages());
+		}
+		if (impl->statistics_aggregator_)
+			impl->statistics_aggregator_->update(*this);
 	};
 	return success_or(moveit::core::MoveItErrorCode::PLANNING_FAILED);
 }
 
+namespace {
+/// Validate solutions against scene changes, caching results of sub solutions shared between solutions
+class SolutionValidator
+{
+	moveit_msgs::PlanningScene world_diff_;
+	std::vector<std::string> changed_objects_;
+	bool robot_changed_;
+	std::unordered_map<const SolutionBase*, bool> cache_;
+	std::unordered_set<const InterfaceState*> updated_;
+
+	// Does sub attach, detach, add, remove, or move one of the changed objects?
+	bool manipulates(const SubTrajectory& sub) const {
+		const planning_scene::PlanningScene& start = *sub.start()->scene();
+		const planning_scene::PlanningScene& end = *sub.end()->scene();
+		for (const std::string& id : changed_objects_) {
+			if (start.getCurrentState().hasAttachedBody(id) || end.getCurrentState().hasAttachedBody(id))
+				return true;
+			const bool known = start.getWorld()->hasObject(id);
+			if (known != end.getWorld()->hasObject(id) ||
+			    (known && !start.getFrameTransform(id).isApprox(end.getFrameTransform(id))))
+				return true;
+		}
+		return false;
+	}
+
+	bool validate(const SubTrajectory& sub) const {
+		if (!sub.start()->scene() || !sub.end()->scene())
+			return false;
+		if (manipulates(sub))
+			return false;
+		planning_scene::PlanningScenePtr scene = sub.start()->scene()->diff();
+		scene->setPlanningSceneDiffMsg(world_diff_);
+		if (sub.trajectory() && !sub.trajectory()->empty())
+			return scene->isPathValid(*sub.trajectory());
+		return scene->isStateValid(scene->getCurrentState());
+	}
+
+public:
+	// like for PlanningScene::setPlanningSceneDiffMsg(), a robot_state that is not a diff replaces the robot state
+	SolutionValidator(const moveit_msgs::PlanningScene& scene_diff)
+	  : robot_changed_(!scene_diff.is_diff || !moveit::core::isEmpty(scene_diff.robot_state)) {
+		world_diff_.is_diff = true;
+		world_diff_.robot_state.is_diff = true;
+		world_diff_.world = scene_diff.world;
+		for (const moveit_msgs::CollisionObject& object : scene_diff.world.collision_objects)
+			changed_objects_.push_back(object.id);
+	}
+
+	/// all states originate from the former robot state
+	bool robotChanged() const { return robot_changed_; }
+
+	bool isValid(const SolutionBase& solution) {
+		auto it = cache_.find(&solution);
+		if (it != cache_.end())
+			return it->second;
+
+		bool valid = true;
+		if (const auto* sequence = dynamic_cast<const SolutionSequence*>(&solution)) {
+			for (const SolutionBase* sub : sequence->solutions())
+				if (!(valid = isValid(*sub)))
+					break;
+		} else if (const auto* wrapped = dynamic_cast<const WrappedSolution*>(&solution))
+			valid = isValid(*wrapped->innermost());
+		else if (const auto* sub = dynamic_cast<const SubTrajectory*>(&solution))
+			valid = validate(*sub);
+
+		cache_.emplace(&solution, valid);
+		return valid;
+	}
+
+	/// apply the world changes to state, such that planning continues in the changed world
+	void update(const InterfaceState* state) {
+		// states are owned by their stages, which keep them alive until reset()
+		if (state && updated_.insert(state).second)
+			const_cast<InterfaceState*>(state)->applySceneDiff(world_diff_);
+	}
+
+	/// apply the world changes to all states of a valid solution, such that it doesn't restore the former world
+	void update(const SolutionBase& solution) {
+		update(solution.start());
+		update(solution.end());
+		if (const auto* sequence = dynamic_cast<const SolutionSequence*>(&solution)) {
+			for (const SolutionBase* sub : sequence->solutions())
+				update(*sub);
+		} else if (const auto* wrapped = dynamic_cast<const WrappedSolution*>(&solution))
+			update(*wrapped->wrapped());
+	}
+};
+
+/** Recover from solutions invalidated by a scene change
+ *
+ * States created by an invalidated solution are pruned together with all solutions extending them.
+ * States consumed by an invalidated solution are passed to its stage again, to be planned in the changed world.
+ */
+class InvalidationRecovery
+{
+	struct Invalidated
+	{
+		Stage* stage;
+		const SolutionBase* solution;
+	};
+	std::vector<Invalidated> invalidated_;
+	std::unordered_map<const Stage*, std::unordered_set<const InterfaceState*>> created_;
+
+	// was state created by stage (rather than consumed from one of its interfaces)?
+	bool created(const Stage& stage, const InterfaceState* state) {
+		auto it = created_.find(&stage);
+		if (it == created_.end()) {
+			it = created_.emplace(&stage, std::unordered_set<const InterfaceState*>()).first;
+			for (const InterfaceState& s : stage.pimpl()->states())
+				it->second.insert(&s);
+		}
+		return it->second.count(state) > 0;
+	}
+
+	// does stage keep a valid solution extending state into direction dir?
+	template <Interface::Direction dir>
+	static bool extended(const Stage& stage, const InterfaceState& state) {
+		const InterfaceState::Solutions& solutions = trajectories<dir>(state);
+		return std::any_of(solutions.begin(), solutions.end(),
+		                   [&stage](const SolutionBase* s) { return s->creator() == &stage && !s->isFailure(); });
+	}
+
+public:
+	/// remember a solution created by stage itself (i.e. not lifted from a child), which became invalid
+	void add(Stage& stage, const SolutionBase& solution) { invalidated_.push_back(Invalidated{ &stage, &solution }); }
+
+	/// prune and retry, once all invalid solutions are marked as failures
+	void apply() {
+		std::vector<std::pair<InterfacePtr, const InterfaceState*>> retries;
+		for (const Invalidated& i : invalidated_) {
+			const InterfaceState* start = i.solution->start();
+			const InterfaceState* end = i.solution->end();
+			const bool created_start = created(*i.stage, start);
+			const bool created_end = created(*i.stage, end);
+			if (ContainerBase* parent = i.stage->pimpl()->parent()) {
+				// the invalidated solution is no alternative path keeping these states enabled
+				if (created_start)
+					parent->pimpl()->setStatus<Interface::BACKWARD>(nullptr, nullptr, start, InterfaceState::PRUNED, true);
+				if (created_end)
+					parent->pimpl()->setStatus<Interface::FORWARD>(nullptr, nullptr, end, InterfaceState::PRUNED, true);
+			}
+			if (auto* connecting = dynamic_cast<Connecting*>(i.stage))
+				connecting->pimpl()->retryPair(*start, *end);
+			else if (created_end && !created_start && !extended<Interface::FORWARD>(*i.stage, *start))
+				retries.emplace_back(i.stage->pimpl()->starts(), start);
+			else if (created_start && !created_end && !extended<Interface::BACKWARD>(*i.stage, *end))
+				retries.emplace_back(i.stage->pimpl()->ends(), end);
+		}
+
+		std::unordered_set<const InterfaceState*> retried;
+		for (const auto& retry : retries) {
+			// skip states pruned meanwhile (e.g. by an invalidated predecessor) or still pending
+			const InterfaceState* state = retry.second;
+			if (retry.first && state->priority().enabled() && !state->owner() && retried.insert(state).second)
+				retry.first->add(const_cast<InterfaceState&>(*state));
+		}
+	}
+};
+
+// apply scene_diff to the generator(s) spawning the start state of the task
+void applyStartSceneDiff(Stage& stage, const moveit_msgs::PlanningScene& scene_diff) {
+	if (auto* generator = dynamic_cast<Generator*>(&stage)) {
+		generator->applySceneDiff(scene_diff);
+		return;
+	}
+	auto* container = dynamic_cast<ContainerBase*>(&stage);
+	if (!container || container->pimpl()->children().empty())
+		return;
+	if (dynamic_cast<ParallelContainerBase*>(container)) {  // all children share the start
+		for (const Stage::pointer& child : container->pimpl()->children())
+			applyStartSceneDiff(*child, scene_diff);
+	} else
+		applyStartSceneDiff(*container->pimpl()->children().front(), scene_diff);
+}
+}  // namespace
+
+moveit::core::MoveItErrorCode Task::replan(const moveit_msgs::PlanningScene& scene_diff, size_t max_solutions) {
+	auto impl = pimpl();
+	// future planning needs to start from the changed scene
+	applyStartSceneDiff(*stages(), scene_diff);
+
+	SolutionValidator validator(scene_diff);
+	if (!impl->initialized_ || validator.robotChanged()) {
+		// all states originate from the former robot state: plan from scratch
+		reset();
+		return plan(max_solutions);
+	}
+
+	// validate the solutions of all stages, before updating any scene
+	InvalidationRecovery recovery;
+	size_t num_invalid = 0;
+	impl->traverseStages(
+	    [&validator, &recovery, &num_invalid](Stage& stage, int /*depth*/) {
+		    const bool lifting = dynamic_cast<ContainerBase*>(&stage) != nullptr;
+		    num_invalid += stage.pimpl()->invalidateSolutions(
+		        [&](const SolutionBase& solution) {
+			        if (validator.isValid(solution))
+				        return false;
+			        // solutions lifted from children are recovered at their creators
+			        if (!lifting || dynamic_cast<const SubTrajectory*>(&solution))
+				        recovery.add(stage, solution);
+			        return true;
+		        },
+		        "invalidated by scene change");
+		    return true;
+	    },
+	    1, UINT_MAX);
+
+	// kept solutions and pending states of all stages continue in the changed world
+	impl->traverseStages(
+	    [&validator](Stage& stage, int /*depth*/) {
+		    for (const InterfaceState& state : stage.pimpl()->states())
+			    validator.update(&state);
+		    for (const SolutionBaseConstPtr& solution : stage.solutions())
+			    validator.update(*solution);
+		    return true;
+	    },
+	    1, UINT_MAX);
+	recovery.apply();
+	ROS_DEBUG_STREAM_NAMED("Task", fmt::format("replan: {} solution(s) invalidated, {} remaining", num_invalid,
+	                                           numSolutions()));
+	if (impl->introspection_) {
+		impl->introspection_->clearSolutionMsgs();
+		impl->introspection_->publishTaskState(true);
+	}
+
+	if (numSolutions() > 0 && (max_solutions == 0 || numSolutions() >= max_solutions)) {
+		if (impl->plan_recording_ && impl->plan_recording_->records())
+			impl->recordInputScene();
+		return moveit::core::MoveItErrorCode::SUCCESS;
+	}
+	// continue planning, reusing the states and solutions of all stages
+	impl->reuse_structure_ = true;
+	return plan(max_solutions);
+}
+
+void Task::setNumThreads(size_t num_threads) {
+	pimpl()->num_threads_ = std::max<size_t>(1, num_threads);
+}
+
+size_t Task::numThreads() const {
+	return pimpl()->num_threads_;
+}
+
+void Task::setThreadPool(const std::shared_ptr<ThreadPool>& pool) {
+	auto impl = pimpl();
+	impl->thread_pool_ = pool;
+	impl->shared_thread_pool_ = static_cast<bool>(pool);
+}
+
+void Task::setThreadOptions(const ThreadPool::Options& options) {
+	pimpl()->thread_options_ = options;
+}
+
+const ThreadPool::Options& Task::threadOptions() const {
+	return pimpl()->thread_options_;
+}
+
+void Task::setSolverThreadPool(const std::shared_ptr<ThreadPool>& pool) {
+	pimpl()->solver_pool_ = pool;
+}
+
+const std::shared_ptr<ThreadPool>& Task::solverThreadPool() const {
+	return pimpl()->solver_pool_;
+}
+
+void Task::setStageTimeShare(double share) {
+	pimpl()->planning_deadline_.stage_share = std::max(0.0, std::min(share, 1.0));
+}
+
+double Task::stageTimeShare() const {
+	return pimpl()->planning_deadline_.stage_share;
+}
+
+void Task::setStageWatchdog(bool enable) {
+	pimpl()->stage_watchdog_ = enable;
+}
+
+bool Task::stageWatchdog() const {
+	return pimpl()->stage_watchdog_;
+}
+
+void Task::setHardwareCounters(bool enable) {
+	pimpl()->hardware_counters_ = enable;
+}
+
+bool Task::hardwareCounters() const {
+	return pimpl()->hardware_counters_;
+}
+
+void Task::setConcurrentCosts(bool enable) {
+	pimpl()->concurrent_costs_ = enable;
+}
+
+bool Task::concurrentCosts() const {
+	return pimpl()->concurrent_costs_;
+}
+
+void Task::enableDiagnostics(double rate, double window) {
+	auto impl = pimpl();
+	const std::string& id = impl->ns().empty() ? name() : impl->ns();
+	if (rate > 0.0)
+		impl->diagnostics_ = std::make_shared<PlanningDiagnostics>(id, rate, window);
+	else
+		impl->diagnostics_.reset();
+}
+
+const PlanningDiagnostics* Task::diagnostics() const {
+	return pimpl()->diagnostics_.get();
+}
+
+void Task::setStatisticsAggregator(const StatisticsAggregatorPtr& aggregator) {
+	auto impl = pimpl();
+	if (impl->statistics_aggregator_ && impl->statistics_aggregator_ != aggregator)
+		impl->statistics_aggregator_->remove(*this);
+	impl->statistics_aggregator_ = aggregator;
+}
+
+const StatisticsAggregatorPtr& Task::statisticsAggregator() const {
+	return pimpl()->statistics_aggregator_;
+}
+
+void Task::setScheduler(const SchedulerPtr& scheduler) {
+	pimpl()->scheduler_ = scheduler;
+}
+
+const SchedulerPtr& Task::scheduler() const {
+	return pimpl()->scheduler_;
+}
+
+void Task::setMaxSceneDiffDepth(size_t depth) {
+	pimpl()->max_scene_diff_depth_ = depth;
+}
+
+size_t Task::maxSceneDiffDepth() const {
+	return pimpl()->max_scene_diff_depth_;
+}
+
+void Task::setFailureStorage(size_t max_failures, bool compact) {
+	pimpl()->max_stored_failures_ = max_failures;
+	pimpl()->compact_failures_ = compact;
+}
+
+size_t Task::maxStoredFailures() const {
+	return pimpl()->max_stored_failures_;
+}
+
+bool Task::compactFailures() const {
+	return pimpl()->compact_failures_;
+}
+
+void Task::setSolutionDiversity(double tolerance, SolutionDistance distance) {
+	pimpl()->solution_diversity_ = tolerance;
+	pimpl()->solution_distance_ = distance;
+}
+
+double Task::solutionDiversity() const {
+	return pimpl()->solution_diversity_;
+}
+
+void Task::setMemoryBudget(size_t bytes) {
+	pimpl()->memory_budget_ = bytes;
+}
+
+size_t Task::memoryBudget() const {
+	return pimpl()->memory_budget_;
+}
+
+void Task::setPrunedStateExpiry(double seconds) {
+	pimpl()->pruned_state_expiry_ = seconds;
+}
+
+double Task::prunedStateExpiry() const {
+	return pimpl()->pruned_state_expiry_;
+}
+
+void Task::setCostToGoHeuristic(const Interface::CostToGo& heuristic) {
+	pimpl()->cost_to_go_ = heuristic;
+}
+
+const Interface::CostToGo& Task::costToGoHeuristic() const {
+	return pimpl()->cost_to_go_;
+}
+
+void Task::setInterfaceInbox(bool enable) {
+	pimpl()->interface_inbox_ = enable;
+}
+
+bool Task::interfaceInbox() const {
+	return pimpl()->interface_inbox_;
+}
+
+void TaskPrivate::liftPendingSolutions(size_t max_solutions) {
+	const ContainerBase* root = stages();
+	auto* serial = root ? dynamic_cast<const SerialContainerPrivate*>(root->pimpl()) : nullptr;
+	if (!serial || !serial->hasPendingSolutions())
+		return;
+	auto lock = lockPlanning();
+	const size_t num_solutions = root->solutions().size();
+	auto* impl = const_cast<SerialContainerPrivate*>(serial);
+	if (max_solutions == 0)
+		impl->liftPendingSolutions();
+	else if (num_solutions < max_solutions)
+		impl->liftPendingSolutions(max_solutions - num_solutions);
+}
+
+void TaskPrivate::drainInboxes() {
+	if (!interface_inbox_)
+		return;
+	auto lock = lockPlanning();
+	// draining a container's interface hands over states to its children, thus repeat until nothing is left
+	bool drained = true;
+	while (drained) {
+		drained = false;
+		traverseStages(
+		    [&drained](Stage& stage, int /*depth*/) {
+			    drained |= stage.pimpl()->drainInterfaces();
+			    return true;
+		    },
+		    1, UINT_MAX);
+	}
+}
+
+namespace {
+// Connecting stages check compatibility of new states against all (also pruned) opposite states
+void collectConnectingStates(const Stage& stage, std::unordered_set<const InterfaceState*>& states) {
+	if (!dynamic_cast<const Connecting*>(&stage))
+		return;
+	for (const InterfaceConstPtr& interface : { stage.pimpl()->starts(), stage.pimpl()->ends() })
+		if (interface)
+			states.insert(interface->begin(), interface->end());
+}
+}  // namespace
+
+void TaskPrivate::enforceMemoryBudget() {
+	std::size_t usage = 0;
+	std::vector<InterfaceState*> candidates;
+	std::unordered_set<const InterfaceState*> protected_states;
+	ContainerBase::StageCallback collect = [&](const Stage& stage, unsigned int /*depth*/) -> bool {
+		usage += stage.memoryUsage().total();
+		for (const InterfaceState& state : stage.pimpl()->states())
+			if (state.priority().status() == InterfaceState::Status::PRUNED && !state.evicted())
+				candidates.push_back(const_cast<InterfaceState*>(&state));
+		collectConnectingStates(stage, protected_states);
+		return true;
+	};
+	stages()->traverseRecursively(collect);
+	if (usage <= memory_budget_)
+		return;
+
+	// evict lowest-priority states first
+	std::sort(candidates.begin(), candidates.end(),
+	          [](const InterfaceState* a, const InterfaceState* b) { return a->priority() > b->priority(); });
+	std::size_t num_evicted = 0;
+	for (InterfaceState* state : candidates) {
+		if (usage <= memory_budget_)
+			break;
+		if (protected_states.count(state))
+			continue;
+		usage -= std::min(usage, StagePrivate::evict(*state));
+		++num_evicted;
+	}
+	ROS_DEBUG_STREAM_NAMED("Task", fmt::format("evicted {} pruned state(s), memory usage now ~{}", num_evicted,
+	                                           formatBytes(usage)));
+}
+
+void TaskPrivate::evictExpiredStates() {
+	const auto now = std::chrono::steady_clock::now();
+	const auto expiry = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	    std::chrono::duration<double>(pruned_state_expiry_));
+	// rebuilt from scratch: forgets states that were re-enabled or evicted meanwhile
+	std::unordered_map<const InterfaceState*, std::chrono::steady_clock::time_point> pruned_since;
+	std::vector<std::pair<InterfaceState*, std::chrono::steady_clock::time_point>> expired;
+	std::unordered_set<const InterfaceState*> protected_states;
+	ContainerBase::StageCallback collect = [&](const Stage& stage, unsigned int /*depth*/) -> bool {
+		for (const InterfaceState& state : stage.pimpl()->states()) {
+			if (state.priority().status() != InterfaceState::Status::PRUNED || state.evicted())
+				continue;
+			auto it = pruned_since_.find(&state);
+			const auto since = it == pruned_since_.end() ? now : it->second;
+			if (now - since >= expiry)
+				expired.emplace_back(const_cast<InterfaceState*>(&state), since);
+			else
+				pruned_since.emplace(&state, since);
+		}
+		collectConnectingStates(stage, protected_states);
+		return true;
+	};
+	stages()->traverseRecursively(collect);
+
+	std::size_t num_evicted = 0, freed = 0;
+	for (const auto& entry : expired) {
+		if (protected_states.count(entry.first)) {
+			pruned_since.insert(entry);  // keep tracking, it might become evictable later
+			continue;
+		}
+		freed += StagePrivate::evict(*entry.first);
+		++num_evicted;
+	}
+	pruned_since_.swap(pruned_since);
+	if (num_evicted)
+		ROS_DEBUG_STREAM_NAMED("Task", fmt::format("evicted {} expired pruned state(s), freeing ~{}", num_evicted,
+		                                           formatBytes(freed)));
+}
+
+void Task::setCostPruningSlack(double slack) {
+	pimpl()->cost_pruning_slack_ = slack;
+}
+
+double Task::costPruningSlack() const {
+	return pimpl()->cost_pruning_slack_;
+}
+
+void TaskPrivate::pruneByCost() {
+	pruned_cost_bound_ = cost_bound_;
+	// collect first: updating the status reorders the interfaces
+	std::vector<InterfaceState*> exceeding;
+	ContainerBase::StageCallback collect = [&exceeding](const Stage& stage, unsigned int /*depth*/) -> bool {
+		for (const InterfaceConstPtr& interface : { stage.pimpl()->starts(), stage.pimpl()->ends() }) {
+			if (!interface)
+				continue;
+			for (const InterfaceState* state : *interface)
+				if (state->priority().enabled() && interface->exceedsCostBound(*state))
+					exceeding.push_back(const_cast<InterfaceState*>(state));
+		}
+		return true;
+	};
+	stages()->traverseRecursively(collect);
+
+	for (InterfaceState* state : exceeding)
+		if (state->priority().enabled() && state->owner()->exceedsCostBound(*state))  // might be updated meanwhile
+			state->updateStatus(InterfaceState::Status::PRUNED);
+	ROS_DEBUG_STREAM_NAMED("Pruning", fmt::format("pruned {} state(s) exceeding cost bound {}", exceeding.size(),
+	                                              pruned_cost_bound_));
+}
+
+void Task::setPlanRecording(const PlanRecordingPtr& recording) {
+	pimpl()->plan_recording_ = recording;
+}
+
+const PlanRecordingPtr& Task::planRecording() const {
+	return pimpl()->plan_recording_;
+}
+
+void Task::checkpoint(const std::string& path) {
+	auto impl = pimpl();
+	const PlanRecordingPtr& recording = impl->plan_recording_;
+	if (!recording || !recording->records())
+		throw std::runtime_error("checkpoints require a plan recording in RECORD or RESUME mode");
+	impl->recordInputScene();
+	recording->save(path);
+}
+
+void Task::resume(const std::string& path) {
+	auto recording = std::make_shared<PlanRecording>(PlanRecording::RESUME);
+	recording->load(path);
+	setPlanRecording(recording);
+	reset();
+}
+
+void TaskPrivate::recordInputScene() {
+	const SolutionBase* spawned = nullptr;
+	ContainerBase::StageCallback find = [&spawned](const Stage& stage, unsigned int /*depth*/) -> bool {
+		if (!spawned && dynamic_cast<const Generator*>(&stage) && !dynamic_cast<const MonitoringGenerator*>(&stage) &&
+		    !stage.solutions().empty())
+			spawned = stage.solutions().front().get();
+		return !spawned;
+	};
+	stages()->traverseRecursively(find);
+	if (!spawned)
+		return;
+	moveit_msgs::PlanningScene scene;
+	spawned->end()->scene()->getPlanningSceneMsg(scene);
+	plan_recording_->setScene(scene);
+}
+
+void Task::setBeamWidth(size_t width) {
+	pimpl()->beam_width_ = width;
+}
+
+size_t Task::beamWidth() const {
+	return pimpl()->beam_width_;
+}
+
+bool TaskPrivate::widenBeams() {
+	if (!beam_width_)
+		return false;
+	size_t enabled = 0;
+	ContainerBase::StageCallback widen = [&enabled](const Stage& stage, unsigned int /*depth*/) -> bool {
+		auto impl = const_cast<StagePrivate*>(stage.pimpl());
+		for (const InterfacePtr& interface : { impl->starts(), impl->ends() })
+			if (interface)
+				enabled += interface->widenBeam();
+		return true;
+	};
+	stages()->traverseRecursively(widen);
+	ROS_DEBUG_STREAM_NAMED("Beam", fmt::format("re-enabled {} parked state(s)", enabled));
+	return enabled > 0 && stages()->canCompute();
+}
+
+void Task::setTraceFile(const std::string& filename) {
+	pimpl()->trace_file_ = filename;
+}
+
+const std::string& Task::traceFile() const {
+	return pimpl()->trace_file_;
+}
+
+void Task::setEventLogCapacity(size_t capacity) {
+	pimpl()->event_log_capacity_ = capacity;
+}
+
+size_t Task::eventLogCapacity() const {
+	return pimpl()->event_log_capacity_;
+}
+
+EventLogPtr Task::eventLog() const {
+	return pimpl()->event_log_;
+}
+
+void Task::setEventLogFile(const std::string& filename) {
+	pimpl()->event_log_file_ = filename;
+}
+
+const std::string& Task::eventLogFile() const {
+	return pimpl()->event_log_file_;
+}
+
+void TaskPrivate::writeEventLog() const {
+	if (!event_log_ || event_log_file_.empty())
+		return;
+	try {
+		event_log_->write(event_log_file_);
+	} catch (const std::runtime_error& e) {
+		ROS_ERROR_STREAM_NAMED("Task", e.what());
+	}
+}
+
 void Task::preempt() {
 	pimpl()->preempt_requested_ = true;
 }
@@ -279,16 +1164,194 @@ void Task::resetPreemptRequest() {
 	pimpl()->preempt_requested_ = false;
 }
 
-moveit::core::MoveItErrorCode Task::execute(const SolutionBase& s) {
+namespace {
+moveit::core::MoveItErrorCode sendExecuteGoal(const moveit_task_constructor_msgs::ExecuteTaskSolutionGoal& goal) {
 	actionlib::SimpleActionClient<moveit_task_constructor_msgs::ExecuteTaskSolutionAction> ac("execute_task_solution");
 	if (!ac.waitForServer(ros::Duration(0.5))) {
 		ROS_ERROR("Failed to connect to the 'execute_task_solution' action server");
 		return moveit::core::MoveItErrorCode::FAILURE;
 	}
 
+	ac.sendGoal(goal);
+	ac.waitForResult();
+	return ac.getResult()->error_code;
+}
+}  // namespace
+
+moveit::core::MoveItErrorCode Task::execute(const SolutionBase& s) {
+	moveit_task_constructor_msgs::ExecuteTaskSolutionGoal goal;
+	// with shared memory enabled, only send the handle
+	Introspection* introspection = pimpl()->introspection_.get();
+	if (!introspection || !introspection->solutionHandle(s, goal.solution_handle))
+		s.toMsg(goal.solution, introspection);
+	return sendExecuteGoal(goal);
+}
+
+moveit::core::MoveItErrorCode Task::execute(const moveit_task_constructor_msgs::Solution& solution) {
 	moveit_task_constructor_msgs::ExecuteTaskSolutionGoal goal;
-	s.toMsg(goal.solution, pimpl()->introspection_.get());
+	goal.solution = solution;
+	return sendExecuteGoal(goal);
+}
+
+void Task::saveSolutions(const std::string& path, size_t max_solutions) const {
+	std::vector<moveit_task_constructor_msgs::Solution> msgs;
+	msgs.reserve(max_solutions > 0 ? std::min(max_solutions, solutions().size()) : solutions().size());
+	for (const auto& solution : solutions()) {
+		if (max_solutions > 0 && msgs.size() >= max_solutions)
+			break;
+		msgs.emplace_back();
+		auto& msg = msgs.back();
+		solution->toMsg(msg, pimpl()->introspection_.get());
+		if (msg.sub_solution.empty()) {  // w/o introspection, provide the overall solution info anyway
+			msg.sub_solution.emplace_back();
+			solution->fillInfo(msg.sub_solution.back().info);
+		}
+	}
+	SolutionFile::write(path, msgs);
+}
+
+SolutionFilePtr Task::loadSolutions(const std::string& path) {
+	return std::make_shared<SolutionFile>(path);
+}
+
+moveit::core::MoveItErrorCode Task::execute(const SolutionBase& s, plan_execution::PlanExecution& executor) {
+	std::vector<const SubTrajectory*> subs;
+	flatten(s, subs);
+
+	plan_execution::ExecutableMotionPlan plan;
+	plan.plan_components_.reserve(subs.size());
+	for (size_t i = 0; i < subs.size(); ++i) {
+		const SubTrajectory* sub = subs[i];
+		plan.plan_components_.emplace_back();
+		plan_execution::ExecutableTrajectory& exec_traj = plan.plan_components_.back();
+		exec_traj.description_ = std::to_string(i + 1) + "/" + std::to_string(subs.size());
+		// executor only reads the trajectory, thus share it instead of copying
+		if (sub->trajectory())
+			exec_traj.trajectory_ =
+			    std::const_pointer_cast<robot_trajectory::RobotTrajectory>(sub->compressedTrajectory());
+		else
+			exec_traj.trajectory_ = std::make_shared<robot_trajectory::RobotTrajectory>(
+			    sub->start()->scene()->getRobotModel(), nullptr);
+		if (sub->creator())
+			exec_traj.controller_names_ = sub->creator()->trajectoryExecutionInfo().controller_names;
+
+		exec_traj.effect_on_success_ = [sub, psm = executor.getPlanningSceneMonitor()](
+		                                   const plan_execution::ExecutableMotionPlan* /*plan*/) {
+			moveit_msgs::PlanningScene scene_diff;
+			if (sub->end()->scene()->getParent() == sub->start()->scene())
+				sub->end()->scene()->getPlanningSceneDiffMsg(scene_diff);
+			else
+				sub->end()->scene()->getPlanningSceneMsg(scene_diff);
+			// Never modify joint state directly (only via robot trajectories)
+			scene_diff.robot_state.joint_state = sensor_msgs::JointState();
+			scene_diff.robot_state.multi_dof_joint_state = sensor_msgs::MultiDOFJointState();
+			scene_diff.robot_state.is_diff = true;
+
+			if (psm && !moveit::core::isEmpty(scene_diff))
+				return psm->newPlanningSceneMessage(scene_diff);
+			return true;
+		};
+	}
+	return executor.executeAndMonitor(plan);
+}
+
+std::vector<const SolutionBase*> Task::stablePrefix() const {
+	std::vector<const SolutionBase*> prefix;
+	const auto* serial = dynamic_cast<const SerialContainer*>(stages());
+	if (!serial)
+		return prefix;
 
+	const auto& children = serial->pimpl()->children();
+	auto child = children.cbegin();
+	if (child == children.cend())
+		return prefix;
+
+	// a unique start state, which will not change anymore
+	const Stage& first = **child;
+	if (first.solutions().size() != 1 || first.pimpl()->canCompute())
+		return prefix;
+	prefix.push_back(first.solutions().front().get());
+
+	for (++child; child != children.cend(); ++child) {
+		if (!dynamic_cast<const PropagatingEitherWay*>(child->get()))
+			break;
+
+		// find the unique sub trajectory created by child from the end of the current prefix
+		const SolutionBase* next = nullptr;
+		for (const SolutionBase* s : prefix.back()->end()->outgoingTrajectories()) {
+			if (s->creator() != child->get())
+				continue;
+			if (next) {  // ambiguous
+				next = nullptr;
+				break;
+			}
+			next = s;
+		}
+		if (!next || next->isFailure())
+			break;
+		prefix.push_back(next);
+	}
+	return prefix;
+}
+
+moveit::core::MoveItErrorCode Task::planAndExecute(size_t max_solutions) {
+	actionlib::SimpleActionClient<moveit_task_constructor_msgs::ExecuteTaskSolutionAction> ac("execute_task_solution");
+	if (!ac.waitForServer(ros::Duration(0.5))) {
+		ROS_ERROR("Failed to connect to the 'execute_task_solution' action server");
+		return moveit::core::MoveItErrorCode::FAILURE;
+	}
+
+	// once the stable prefix comprises some motion, send it for execution
+	std::vector<const SubTrajectory*> executed;
+	auto cb = addTaskCallback([this, &ac, &executed](const Task& /*task*/) {
+		if (!executed.empty())
+			return;  // already executing
+		std::vector<const SubTrajectory*> prefix;
+		for (const SolutionBase* s : stablePrefix())
+			flatten(*s, prefix);
+		if (std::none_of(prefix.begin(), prefix.end(), [](const SubTrajectory* sub) {
+			    return sub->trajectory() && !sub->trajectory()->empty();
+		    }))
+			return;
+
+		moveit_task_constructor_msgs::ExecuteTaskSolutionGoal goal;
+		for (const SubTrajectory* sub : prefix)
+			sub->appendTo(goal.solution, pimpl()->introspection_.get());
+		prefix.front()->start()->scene()->getPlanningSceneMsg(goal.solution.start_scene);
+		ROS_DEBUG_STREAM_NAMED("Task", "executing stable prefix of " << prefix.size() << " sub trajectories");
+		ac.sendGoal(goal);
+		executed = std::move(prefix);
+	});
+	auto guard = sg::make_scope_guard([this, cb]() noexcept { this->eraseTaskCallback(cb); });
+
+	moveit::core::MoveItErrorCode result = plan(max_solutions);
+	const bool prefix_sent = !executed.empty();
+	if (!result) {
+		if (prefix_sent)
+			ac.waitForResult();
+		return result;
+	}
+	if (!prefix_sent)
+		return execute(*solutions().front());
+
+	ac.waitForResult();
+	if (ac.getResult()->error_code.val != moveit_msgs::MoveItErrorCodes::SUCCESS)
+		return ac.getResult()->error_code;
+
+	// execute remainder of the best solution, after the already executed prefix
+	std::vector<const SubTrajectory*> remaining;
+	flatten(*solutions().front(), remaining);
+	if (remaining.size() < executed.size() || !std::equal(executed.begin(), executed.end(), remaining.begin())) {
+		ROS_ERROR_NAMED("Task", "best solution doesn't start with the executed prefix");
+		return moveit::core::MoveItErrorCode::FAILURE;
+	}
+	if (remaining.size() == executed.size())
+		return moveit::core::MoveItErrorCode::SUCCESS;
+
+	moveit_task_constructor_msgs::ExecuteTaskSolutionGoal goal;
+	for (auto it = remaining.begin() + executed.size(); it != remaining.end(); ++it)
+		(*it)->appendTo(goal.solution, pimpl()->introspection_.get());
+	executed.back()->end()->scene()->getPlanningSceneMsg(goal.solution.start_scene);
 	ac.sendGoal(goal);
 	ac.waitForResult();
 	return ac.getResult()->error_code;
@@ -302,8 +1365,51 @@ void Task::publishAllSolutions(bool wait) {
 void Task::onNewSolution(const SolutionBase& s) {
 	// no need to call WrapperBase::onNewSolution!
 	auto impl = pimpl();
+	// tighten the bound for branch-and-bound pruning, which might be accessed concurrently
+	const double bound = s.cost() + impl->cost_pruning_slack_;
+	double current = impl->cost_bound_;
+	while (bound < current && !impl->cost_bound_.compare_exchange_weak(current, bound)) {
+	}
 	for (const auto& cb : impl->solution_cbs_)
 		cb(s);
+	impl->streamSolution(s);
+}
+
+SolutionStreamPtr Task::streamSolutions() {
+	auto impl = pimpl();
+	auto stream = std::make_shared<SolutionStream>();
+	std::lock_guard<std::mutex> lock(impl->solution_streams_mutex_);
+	impl->solution_streams_.push_back(stream);
+	return stream;
+}
+
+void TaskPrivate::streamSolution(const SolutionBase& solution) {
+	std::lock_guard<std::mutex> lock(solution_streams_mutex_);
+	if (solution_streams_.empty())
+		return;
+
+	// retrieve the shared pointer of the solution, stored by the wrapped container
+	const auto& solutions = stages()->solutions();
+	auto it = std::find_if(solutions.begin(), solutions.end(),
+	                       [&solution](const SolutionBaseConstPtr& s) { return s.get() == &solution; });
+	if (it == solutions.end())
+		return;
+
+	for (auto stream = solution_streams_.begin(); stream != solution_streams_.end();) {
+		if (auto s = stream->lock()) {
+			s->push(*it);
+			++stream;
+		} else
+			stream = solution_streams_.erase(stream);  // consumer is gone
+	}
+}
+
+void TaskPrivate::closeSolutionStreams() {
+	std::lock_guard<std::mutex> lock(solution_streams_mutex_);
+	for (const auto& stream : solution_streams_)
+		if (auto s = stream.lock())
+			s->close();
+	solution_streams_.clear();
 }
 
 ContainerBase* Task::stages() {
@@ -330,7 +1436,15 @@ const core::RobotModelConstPtr& Task::getRobotModel() const {
 }
 
 void Task::printState(std::ostream& os) const {
-	os << *stages();
+	ContainerBase::StageCallback processor = [&os](const Stage& stage, unsigned int depth) -> bool {
+		os << std::string(2 * depth, ' ') << *stage.pimpl();
+		const MemoryUsage memory = stage.memoryUsage();
+		if (memory.total() > 0)
+			os << " [" << formatBytes(memory.total()) << "]";
+		os << std::endl;
+		return true;
+	};
+	stages()->traverseRecursively(processor);
 }
 
 void Task::explainFailure(std::ostream& os) const {
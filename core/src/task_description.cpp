@@ -0,0 +1,278 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Serialized description of a task's stage tree
+*/
+
+#include <moveit/task_constructor/task_description.h>
+#include <moveit/task_constructor/container.h>
+#include <moveit/task_constructor/stage_p.h>
+#include <moveit/task_constructor/task.h>
+
+#include <ros/console.h>
+#include <ros/serialization.h>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+constexpr char MAGIC[8] = { 'M', 'T', 'C', 'T', 'A', 'S', 'K', '\0' };
+constexpr uint32_t VERSION = 1;
+
+template <typename T>
+void append(const T& value, std::string& buffer) {
+	const uint32_t length = ros::serialization::serializationLength(value);
+	const size_t offset = buffer.size();
+	buffer.resize(offset + length);
+	ros::serialization::OStream stream(reinterpret_cast<uint8_t*>(&buffer[offset]), length);
+	ros::serialization::serialize(stream, value);
+}
+
+class StageTypeRegistry
+{
+	std::mutex mutex_;
+	std::map<std::string, TaskDescription::Factory> factories_;
+	std::map<std::type_index, std::string> names_;
+
+public:
+	StageTypeRegistry() {
+		insert("SerialContainer", typeid(SerialContainer), [] { return std::make_unique<SerialContainer>(); });
+		insert("Alternatives", typeid(Alternatives), [] { return std::make_unique<Alternatives>(); });
+		insert("Fallbacks", typeid(Fallbacks), [] { return std::make_unique<Fallbacks>(); });
+		insert("Merger", typeid(Merger), [] { return std::make_unique<Merger>(); });
+	}
+
+	void insert(const std::string& type, const std::type_index& type_index, TaskDescription::Factory factory) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		factories_[type] = std::move(factory);
+		names_[type_index] = type;
+	}
+
+	std::string name(const Stage& stage) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = names_.find(typeid(stage));
+		if (it == names_.end())
+			throw std::runtime_error("TaskDescription: unregistered type of stage '" + stage.name() + "'");
+		return it->second;
+	}
+
+	Stage::pointer create(const std::string& type) {
+		TaskDescription::Factory factory;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto it = factories_.find(type);
+			if (it == factories_.end())
+				throw std::runtime_error("TaskDescription: unregistered stage type '" + type + "'");
+			factory = it->second;
+		}
+		return factory();
+	}
+};
+
+StageTypeRegistry& registry() {
+	static StageTypeRegistry instance;
+	return instance;
+}
+
+// direction resolved during the last init(), AUTO if not (yet) resolved
+uint8_t resolvedDirection(const Stage& stage) {
+	if (!dynamic_cast<const PropagatingEitherWay*>(&stage))
+		return PropagatingEitherWay::AUTO;
+	InterfaceFlags required = stage.pimpl()->requiredInterface();
+	if ((required & START_IF_MASK) == READS_START)
+		return PropagatingEitherWay::FORWARD;
+	if ((required & START_IF_MASK) == WRITES_PREV_END)
+		return PropagatingEitherWay::BACKWARD;
+	return PropagatingEitherWay::AUTO;
+}
+}  // namespace
+
+void TaskDescription::registerStageType(const std::string& type, const std::type_index& type_index, Factory factory) {
+	registry().insert(type, type_index, std::move(factory));
+}
+
+TaskDescription TaskDescription::describe(const Task& task) {
+	TaskDescription result;
+	// the task's wrapped container is created by the task itself: its type is not needed
+	describe(*task.stages(), "", result.nodes_);
+	return result;
+}
+
+void TaskDescription::describe(const Stage& stage, const std::string& type, std::vector<Node>& nodes) {
+	const size_t index = nodes.size();
+	nodes.push_back(Node{ type, stage.name(), resolvedDirection(stage), 0, {} });
+
+	// only describe manually set values: reset() drops values initialized from other sources
+	PropertyMap props = stage.properties();
+	props.reset();
+	for (const auto& pair : props) {
+		const Property& p = pair.second;
+		if (!p.defined())
+			continue;
+		std::string wire = Property::encode(p.value());
+		const std::string type_name = p.typeName();
+		if (wire.empty() && Property::decode(type_name, wire).empty()) {
+			ROS_WARN_STREAM_NAMED("TaskDescription", "skipping non-serializable property '"
+			                                             << pair.first << "' of stage '" << stage.name() << "'");
+			continue;
+		}
+		nodes[index].properties.push_back(Value{ pair.first, type_name, std::move(wire), p.value() });
+	}
+
+	if (const auto* container = dynamic_cast<const ContainerBase*>(&stage)) {
+		container->traverseChildren([&nodes, index](const Stage& child, unsigned int /*depth*/) {
+			++nodes[index].num_children;
+			describe(child, registry().name(child), nodes);
+			return true;
+		});
+	}
+}
+
+void TaskDescription::save(const std::string& path) const {
+	std::string buffer(MAGIC, sizeof(MAGIC));
+	append(VERSION, buffer);
+	append(static_cast<uint32_t>(nodes_.size()), buffer);
+	for (const Node& node : nodes_) {
+		append(node.type, buffer);
+		append(node.name, buffer);
+		append(node.direction, buffer);
+		append(node.num_children, buffer);
+		append(static_cast<uint32_t>(node.properties.size()), buffer);
+		for (const Value& v : node.properties) {
+			append(v.name, buffer);
+			append(v.type, buffer);
+			append(v.wire, buffer);
+		}
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.write(buffer.data(), buffer.size()))
+		throw std::runtime_error("failed to write task description " + path);
+}
+
+TaskDescription TaskDescription::load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		throw std::runtime_error("failed to open task description " + path);
+	std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (buffer.size() < sizeof(MAGIC) || std::memcmp(buffer.data(), MAGIC, sizeof(MAGIC)) != 0)
+		throw std::runtime_error("not a task description: " + path);
+
+	TaskDescription result;
+	try {
+		ros::serialization::IStream stream(buffer.data() + sizeof(MAGIC), buffer.size() - sizeof(MAGIC));
+		uint32_t version;
+		ros::serialization::deserialize(stream, version);
+		if (version != VERSION)
+			throw std::runtime_error("unsupported task description version " + std::to_string(version) + ": " + path);
+		uint32_t count;
+		ros::serialization::deserialize(stream, count);
+		size_t remaining = 1;  // number of nodes still expected by the hierarchy
+		for (uint32_t i = 0; i < count; ++i) {
+			Node node;
+			ros::serialization::deserialize(stream, node.type);
+			ros::serialization::deserialize(stream, node.name);
+			ros::serialization::deserialize(stream, node.direction);
+			ros::serialization::deserialize(stream, node.num_children);
+			uint32_t num_properties;
+			ros::serialization::deserialize(stream, num_properties);
+			for (uint32_t j = 0; j < num_properties; ++j) {
+				Value v;
+				ros::serialization::deserialize(stream, v.name);
+				ros::serialization::deserialize(stream, v.type);
+				ros::serialization::deserialize(stream, v.wire);
+				// decode once, sharing the value with all built tasks
+				v.value = Property::decode(v.type, v.wire);
+				if (v.value.empty())
+					throw std::runtime_error("cannot decode property '" + v.name + "' of type " + v.type);
+				node.properties.push_back(std::move(v));
+			}
+			if (remaining == 0)
+				throw std::runtime_error("inconsistent hierarchy");
+			remaining = remaining - 1 + node.num_children;
+			result.nodes_.push_back(std::move(node));
+		}
+		if (remaining != 0)
+			throw std::runtime_error("inconsistent hierarchy");
+	} catch (const ros::Exception& e) {
+		throw std::runtime_error("corrupt task description " + path + ": " + e.what());
+	} catch (const std::runtime_error& e) {
+		throw std::runtime_error("invalid task description " + path + ": " + e.what());
+	}
+	return result;
+}
+
+void TaskDescription::build(Task& task) const {
+	if (nodes_.empty())
+		return;
+	for (const Value& v : nodes_.front().properties)
+		task.setProperty(v.name, v.value);
+	build(*task.stages(), nodes_.begin());
+}
+
+std::vector<TaskDescription::Node>::const_iterator
+TaskDescription::build(ContainerBase& container, std::vector<Node>::const_iterator node) const {
+	auto it = std::next(node);
+	for (uint32_t i = 0; i < node->num_children; ++i) {
+		const Node& child = *it;
+		Stage::pointer stage = registry().create(child.type);
+		stage->setName(child.name);
+
+		for (const Value& v : child.properties)
+			stage->setProperty(v.name, v.value);
+		if (child.direction != PropagatingEitherWay::AUTO) {
+			auto* propagator = dynamic_cast<PropagatingEitherWay*>(stage.get());
+			if (!propagator)
+				throw std::runtime_error("TaskDescription: stage '" + child.name + "' is not propagating");
+			propagator->restrictDirection(static_cast<PropagatingEitherWay::Direction>(child.direction));
+		}
+
+		if (auto* sub = dynamic_cast<ContainerBase*>(stage.get()))
+			it = build(*sub, it);
+		else if (child.num_children > 0)
+			throw std::runtime_error("TaskDescription: stage '" + child.name + "' cannot hold children");
+		else
+			++it;
+		container.add(std::move(stage));
+	}
+	return it;
+}
+}  // namespace task_constructor
+}  // namespace moveit
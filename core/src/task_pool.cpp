@@ -0,0 +1,150 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Pool planning several tasks concurrently, sharing robot model and threads
+*/
+
+#include <moveit/task_constructor/task_pool.h>
+#include <moveit/task_constructor/robot_model_cache.h>
+#include <moveit/task_constructor/thread_pool.h>
+
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace moveit {
+namespace task_constructor {
+
+TaskPool::TaskPool(size_t num_planners, size_t num_workers, const moveit::core::RobotModelConstPtr& robot_model,
+                   const std::string& robot_description)
+  : robot_model_(robot_model) {
+	if (num_planners == 0)
+		throw std::invalid_argument("TaskPool requires at least one planner thread");
+	if (!robot_model_) {  // load robot model once, sharing it with all tasks
+		if (auto loader = RobotModelCache::load(robot_description))
+			robot_model_ = loader->getModel();
+		if (!robot_model_)
+			throw std::runtime_error("TaskPool: failed to load robot model from '" + robot_description + "'");
+	}
+	if (num_workers > 0)
+		thread_pool_ = std::make_shared<ThreadPool>(num_workers);
+
+	planners_.reserve(num_planners);
+	for (size_t i = 0; i < num_planners; ++i)
+		planners_.emplace_back(&TaskPool::plannerLoop, this);
+}
+
+TaskPool::~TaskPool() {
+	preempt();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+	for (auto& planner : planners_)
+		planner.join();
+}
+
+std::future<moveit::core::MoveItErrorCode> TaskPool::submit(const TaskPtr& task, size_t max_solutions) {
+	if (!task)
+		throw std::invalid_argument("TaskPool: cannot submit nullptr");
+	if (!task->getRobotModel())
+		task->setRobotModel(robot_model_);
+	task->setThreadPool(thread_pool_);
+
+	Entry entry{ task, max_solutions, {} };
+	auto future = entry.result.get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		queue_.push_back(std::move(entry));
+	}
+	cond_.notify_one();
+	return future;
+}
+
+std::vector<moveit::core::MoveItErrorCode> TaskPool::planAll(const std::vector<TaskPtr>& tasks, size_t max_solutions) {
+	std::vector<std::future<moveit::core::MoveItErrorCode>> futures;
+	futures.reserve(tasks.size());
+	for (const TaskPtr& task : tasks)
+		futures.push_back(submit(task, max_solutions));
+
+	std::vector<moveit::core::MoveItErrorCode> results;
+	results.reserve(futures.size());
+	for (auto& future : futures)
+		results.push_back(future.get());
+	return results;
+}
+
+void TaskPool::preempt() {
+	std::deque<Entry> discarded;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		discarded.swap(queue_);
+		for (const TaskPtr& task : running_)
+			task->preempt();
+	}
+	for (Entry& entry : discarded)
+		entry.result.set_value(moveit::core::MoveItErrorCode::PREEMPTED);
+}
+
+size_t TaskPool::pending() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queue_.size() + running_.size();
+}
+
+void TaskPool::plannerLoop() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+		if (queue_.empty())  // stop_ was requested
+			return;
+
+		Entry entry = std::move(queue_.front());
+		queue_.pop_front();
+		running_.push_back(entry.task);
+
+		lock.unlock();
+		try {
+			entry.result.set_value(entry.task->plan(entry.max_solutions));
+		} catch (...) {
+			entry.result.set_exception(std::current_exception());
+		}
+		lock.lock();
+
+		running_.erase(std::find(running_.begin(), running_.end(), entry.task));
+	}
+}
+}  // namespace task_constructor
+}  // namespace moveit
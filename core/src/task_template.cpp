@@ -0,0 +1,76 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Template to quickly instantiate structurally identical tasks
+*/
+
+#include <moveit/task_constructor/task_template.h>
+
+#include <stdexcept>
+
+namespace moveit {
+namespace task_constructor {
+
+TaskTemplate::TaskTemplate(Builder builder, const moveit::core::RobotModelConstPtr& robot_model,
+                           const std::string& ns, bool introspection)
+  : builder_(std::move(builder)), robot_model_(robot_model), ns_(ns), introspection_(introspection) {
+	if (!builder_)
+		throw std::invalid_argument("TaskTemplate requires a builder");
+}
+
+Task TaskTemplate::instantiate(const std::string& name, const Overrides& overrides) {
+	Task task(ns_, introspection_);
+	if (!robot_model_) {  // load robot model once, sharing it with all subsequent instances
+		task.loadRobotModel();
+		robot_model_ = task.getRobotModel();
+	} else
+		task.setRobotModel(robot_model_);
+	task.setName(name);
+
+	builder_(task);
+
+	for (const Override& o : overrides) {
+		if (o.stage.empty()) {
+			task.setProperty(o.property, o.value);
+			continue;
+		}
+		Stage* stage = task.findChild(o.stage);
+		if (!stage)
+			throw std::runtime_error("TaskTemplate: unknown stage '" + o.stage + "'");
+		stage->setProperty(o.property, o.value);
+	}
+	return task;
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,157 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/task_constructor/thread_pool.h>
+
+#include <ros/console.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace moveit {
+namespace task_constructor {
+
+ThreadPool::ThreadPool(size_t num_workers, const Options& options) : options_(options) {
+	workers_.reserve(num_workers);
+	for (size_t i = 0; i < num_workers; ++i)
+		workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+	for (auto& worker : workers_)
+		worker.join();
+}
+
+void ThreadPool::run(std::vector<Job>&& jobs) {
+	if (jobs.empty())
+		return;
+
+	auto batch = std::make_shared<Batch>();
+	batch->pending = jobs.size();
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (auto& job : jobs)
+		queue_.emplace_back(std::move(job), batch);
+	cond_.notify_all();
+
+	// help processing jobs of our batch until it is finished
+	while (batch->pending > 0) {
+		auto own = std::find_if(queue_.begin(), queue_.end(), [&batch](const QueueItem& item) {
+			return item.second == batch;
+		});
+		if (own != queue_.end())
+			execute(lock, own);
+		else  // remaining jobs are processed by other threads
+			cond_.wait(lock);
+	}
+
+	if (batch->error)
+		std::rethrow_exception(batch->error);
+}
+
+void ThreadPool::execute(std::unique_lock<std::mutex>& lock, std::deque<QueueItem>::iterator it) {
+	QueueItem item = std::move(*it);
+	queue_.erase(it);
+
+	lock.unlock();
+	std::exception_ptr error;
+	try {
+		item.first();
+	} catch (...) {
+		error = std::current_exception();
+	}
+	lock.lock();
+
+	Batch& batch = *item.second;
+	if (error && !batch.error)
+		batch.error = error;
+	if (--batch.pending == 0)
+		cond_.notify_all();  // wake up thread waiting for this batch
+}
+
+void ThreadPool::configureWorker(size_t index) const {
+#ifdef __linux__
+	if (!options_.cpus.empty()) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (options_.pin)
+			CPU_SET(options_.cpus[index % options_.cpus.size()], &set);
+		else
+			for (unsigned int cpu : options_.cpus)
+				CPU_SET(cpu, &set);
+		if (int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+			ROS_WARN_STREAM_NAMED("ThreadPool", "Failed to set CPU affinity of worker: " << strerror(error));
+	}
+	if (options_.policy != Options::DEFAULT) {
+		sched_param param{};
+		const int policy = options_.policy == Options::BATCH ? SCHED_BATCH : SCHED_IDLE;
+		if (int error = pthread_setschedparam(pthread_self(), policy, &param))
+			ROS_WARN_STREAM_NAMED("ThreadPool", "Failed to set scheduling policy of worker: " << strerror(error));
+	}
+	// on Linux, the nice value is a per-thread attribute
+	if (options_.nice != 0 && setpriority(PRIO_PROCESS, syscall(SYS_gettid), options_.nice) != 0)
+		ROS_WARN_STREAM_NAMED("ThreadPool", "Failed to set nice value of worker: " << strerror(errno));
+#else
+	(void)index;
+	if (!options_.cpus.empty() || options_.policy != Options::DEFAULT || options_.nice != 0)
+		ROS_WARN_ONCE_NAMED("ThreadPool", "Thread placement and scheduling options are only supported on Linux");
+#endif
+}
+
+void ThreadPool::workerLoop(size_t index) {
+	configureWorker(index);
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+		if (queue_.empty())  // stop_ was requested
+			return;
+		execute(lock, queue_.begin());
+	}
+}
+}  // namespace task_constructor
+}  // namespace moveit
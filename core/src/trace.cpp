@@ -0,0 +1,200 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Opt-in recording of a planning timeline in Chrome trace format
+*/
+
+#include <moveit/task_constructor/trace.h>
+#include <moveit/task_constructor/stage_p.h>
+#include <moveit/task_constructor/introspection.h>
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <unordered_map>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace moveit {
+namespace task_constructor {
+
+namespace {
+struct Event
+{
+	const char* name;
+	const char* category;
+	std::string stage;
+	uint32_t stage_id;
+	uint32_t tid;
+	double ts;  // begin, microseconds since start
+	double dur;  // duration, microseconds
+	bool has_counters;
+	PerfCounterValues counters;
+};
+
+void writeEscaped(std::ostream& os, const std::string& s) {
+	os << '"';
+	for (char c : s) {
+		switch (c) {
+			case '"':
+				os << "\\\"";
+				break;
+			case '\\':
+				os << "\\\\";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+					os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+				else
+					os << c;
+		}
+	}
+	os << '"';
+}
+}  // namespace
+
+class Tracer::Impl
+{
+public:
+	std::atomic<bool> enabled{ false };
+	std::chrono::steady_clock::time_point origin;
+	mutable std::mutex mutex;
+	std::vector<Event> events;
+	std::unordered_map<std::thread::id, uint32_t> threads;  // small, stable ids of recorded threads
+};
+
+Tracer& Tracer::instance() {
+	static Tracer tracer;
+	return tracer;
+}
+
+Tracer::Tracer() : impl_(new Impl()) {}
+
+Tracer::~Tracer() {
+	delete impl_;
+}
+
+void Tracer::start() {
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	impl_->events.clear();
+	impl_->threads.clear();
+	impl_->origin = std::chrono::steady_clock::now();
+	impl_->enabled = true;
+}
+
+void Tracer::stop() {
+	impl_->enabled = false;
+}
+
+bool Tracer::enabled() const {
+	return impl_->enabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::record(const char* name, const char* category, const Stage* stage,
+                    std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end,
+                    const PerfCounterValues* counters) {
+	Event e{ name, category, std::string(), 0, 0, 0.0, 0.0, counters != nullptr, PerfCounterValues() };
+	if (counters)
+		e.counters = *counters;
+	if (stage) {
+		e.stage = stage->name();
+		if (const Introspection* introspection = stage->pimpl()->introspection_)
+			e.stage_id = introspection->stageId(stage);
+	}
+
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	if (begin < impl_->origin)  // event started before (re)start of recording
+		return;
+	e.tid = impl_->threads.emplace(std::this_thread::get_id(), impl_->threads.size()).first->second;
+	e.ts = std::chrono::duration<double, std::micro>(begin - impl_->origin).count();
+	e.dur = std::chrono::duration<double, std::micro>(end - begin).count();
+	impl_->events.push_back(std::move(e));
+}
+
+void Tracer::write(std::ostream& os) const {
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	os << "{\"traceEvents\":[";
+	const char* separator = "\n";
+	os << std::fixed << std::setprecision(3);
+	for (const auto& e : impl_->events) {
+		os << separator << R"({"name":)";
+		writeEscaped(os, e.name);
+		os << R"(,"cat":)";
+		writeEscaped(os, e.category);
+		os << R"(,"ph":"X","pid":0,"tid":)" << e.tid << R"(,"ts":)" << e.ts << R"(,"dur":)" << e.dur;
+		if (!e.stage.empty() || e.has_counters) {
+			os << R"(,"args":{)";
+			const char* arg_separator = "";
+			if (!e.stage.empty()) {
+				os << R"("stage":)";
+				writeEscaped(os, e.stage);
+				os << R"(,"stage_id":)" << e.stage_id;
+				arg_separator = ",";
+			}
+			if (e.has_counters) {
+				const auto& c = e.counters;
+				os << arg_separator << R"("cycles":)" << c.cycles << R"(,"instructions":)" << c.instructions
+				   << R"(,"cache_misses":)" << c.cache_misses << R"(,"context_switches":)" << c.context_switches;
+			}
+			os << "}";
+		}
+		os << "}";
+		separator = ",\n";
+	}
+	os << "\n]}\n";
+}
+
+bool Tracer::write(const std::string& filename) const {
+	std::ofstream file(filename);
+	if (!file)
+		return false;
+	write(file);
+	return static_cast<bool>(file);
+}
+
+Tracer::Scope::Scope(const char* name, const char* category, const Stage* stage)
+  : name_(name), category_(category), stage_(stage), active_(Tracer::instance().enabled()) {
+	if (active_)
+		begin_ = std::chrono::steady_clock::now();
+}
+
+Tracer::Scope::~Scope() {
+	if (active_)
+		Tracer::instance().record(name_, category_, stage_, begin_, std::chrono::steady_clock::now(),
+		                          has_counters_ ? &counters_ : nullptr);
+}
+}  // namespace task_constructor
+}  // namespace moveit
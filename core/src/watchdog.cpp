@@ -0,0 +1,93 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Watchdog thread enforcing time budgets of stage computations
+*/
+
+#include <moveit/task_constructor/watchdog.h>
+
+#include <ros/console.h>
+
+namespace moveit {
+namespace task_constructor {
+
+Watchdog::Watchdog() : thread_(&Watchdog::loop, this) {}
+
+Watchdog::~Watchdog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+	thread_.join();
+}
+
+Watchdog::Scope::Scope(Watchdog* watchdog, Clock::time_point deadline, const std::string& name)
+  : watchdog_(watchdog), name_(name) {
+	if (!watchdog_)
+		return;
+	std::lock_guard<std::mutex> lock(watchdog_->mutex_);
+	entry_ = watchdog_->deadlines_.emplace(deadline, this);
+	if (entry_ == watchdog_->deadlines_.begin())
+		watchdog_->cond_.notify_all();  // wake up to wait for the new earliest deadline
+}
+
+Watchdog::Scope::~Scope() {
+	if (!watchdog_)
+		return;
+	std::lock_guard<std::mutex> lock(watchdog_->mutex_);
+	if (!expired_)
+		watchdog_->deadlines_.erase(entry_);
+}
+
+void Watchdog::loop() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!stop_) {
+		if (deadlines_.empty()) {
+			cond_.wait(lock);
+			continue;
+		}
+		auto earliest = deadlines_.begin();
+		if (Clock::now() < earliest->first) {
+			cond_.wait_until(lock, earliest->first);
+			continue;
+		}
+		Scope* scope = earliest->second;
+		deadlines_.erase(earliest);
+		scope->expired_ = true;
+		ROS_WARN_STREAM_NAMED("Watchdog", "'" << scope->name_ << "' exceeded its timeout, requesting cancellation");
+	}
+}
+}  // namespace task_constructor
+}  // namespace moveit
@@ -0,0 +1,91 @@
+#include <moveit/task_constructor/container_p.h>
+#include <moveit/task_constructor/stage_p.h>
+#include <moveit/task_constructor/task.h>
+
+#include "stage_mockups.h"
+#include "models.h"
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+
+using namespace moveit::task_constructor;
+
+namespace {
+
+PredefinedCosts zeros(size_t n) {
+	return PredefinedCosts{ std::list<double>(n, 0.0), true };
+}
+
+// peak resident set size of this process in kB
+double peakMemory() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+// plan the task built by fill() and report states, solutions, and memory
+template <typename Fill>
+void runTask(benchmark::State& state, Fill&& fill) {
+	size_t num_states = 0;
+	size_t num_solutions = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		resetMockupIds();
+		Task t;
+		t.setRobotModel(getModel());
+		fill(t);
+		state.ResumeTiming();
+
+		t.plan();
+
+		state.PauseTiming();
+		num_solutions += t.numSolutions();
+		t.stages()->traverseRecursively([&num_states](const Stage& stage, unsigned int /*depth*/) {
+			num_states += stage.pimpl()->numStates();
+			return true;
+		});
+		state.ResumeTiming();
+	}
+	state.counters["states"] = benchmark::Counter(num_states, benchmark::Counter::kIsRate);
+	state.counters["solutions"] = benchmark::Counter(num_solutions, benchmark::Counter::kIsRate);
+	state.counters["peak_rss_kB"] = peakMemory();
+}
+
+// n x n states connected by a single Connect stage
+void connectFanOut(benchmark::State& state) {
+	const size_t n = state.range(0);
+	runTask(state, [n](Task& t) {
+		t.add(Stage::pointer(new GeneratorMockup(zeros(n))));
+		t.add(Stage::pointer(new ConnectMockup()));
+		t.add(Stage::pointer(new GeneratorMockup(zeros(n))));
+	});
+}
+BENCHMARK(connectFanOut)->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+
+// a single state propagated through a long chain of stages
+void serialChain(benchmark::State& state) {
+	const size_t depth = state.range(0);
+	runTask(state, [depth](Task& t) {
+		t.add(Stage::pointer(new GeneratorMockup()));
+		for (size_t i = 0; i < depth; ++i)
+			t.add(Stage::pointer(new ForwardMockup()));
+	});
+}
+BENCHMARK(serialChain)->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+
+// many states propagated through many alternatives
+void wideAlternatives(benchmark::State& state) {
+	const size_t width = state.range(0);
+	runTask(state, [width](Task& t) {
+		t.add(Stage::pointer(new GeneratorMockup(zeros(100))));
+		auto alternatives = std::make_unique<Alternatives>();
+		for (size_t i = 0; i < width; ++i)
+			alternatives->add(Stage::pointer(new ForwardMockup()));
+		t.add(std::move(alternatives));
+	});
+}
+BENCHMARK(wideAlternatives)->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
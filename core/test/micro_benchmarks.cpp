@@ -0,0 +1,257 @@
+#include <moveit/task_constructor/cost_queue.h>
+#include <moveit/task_constructor/storage.h>
+#include <moveit/task_constructor/stage_p.h>
+#include <moveit/task_constructor/task.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+#include "stage_mockups.h"
+#include "models.h"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace moveit::task_constructor;
+using Prio = InterfaceState::Priority;
+
+namespace {
+
+// priorities as seen during planning: mostly shallow, enabled states with exponentially distributed costs
+class PrioritySampler
+{
+	std::mt19937 rng_{ 42 };
+	std::geometric_distribution<unsigned int> depth_{ 0.5 };
+	std::exponential_distribution<double> cost_{ 1.0 };
+	std::discrete_distribution<int> status_{ 90, 7, 3 };  // ENABLED, ARMED, PRUNED
+
+public:
+	Prio operator()() { return Prio(depth_(rng_), cost_(rng_), static_cast<InterfaceState::Status>(status_(rng_))); }
+	size_t index(size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(rng_); }
+};
+
+std::vector<Prio> samplePriorities(size_t n) {
+	PrioritySampler sample;
+	std::vector<Prio> result;
+	result.reserve(n);
+	for (size_t i = 0; i < n; ++i)
+		result.push_back(sample());
+	return result;
+}
+
+template <typename Backend>
+using PrioQueue = ordered<Prio*, ValueOrPointeeLess<Prio*>, Backend>;
+
+// sorted insertion of n items
+template <typename Backend>
+void orderedInsert(benchmark::State& state) {
+	const size_t n = state.range(0);
+	auto prios = samplePriorities(n);
+	for (auto _ : state) {
+		PrioQueue<Backend> q;
+		for (auto& p : prios)
+			q.insert(&p);
+		benchmark::DoNotOptimize(q.top());
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	state.SetComplexityN(n);
+}
+
+// re-sort a single item after changing its priority
+template <typename Backend>
+void orderedUpdate(benchmark::State& state) {
+	const size_t n = state.range(0);
+	auto prios = samplePriorities(n);
+	PrioQueue<Backend> q;
+	std::vector<typename PrioQueue<Backend>::iterator> items;
+	for (auto& p : prios)
+		items.push_back(q.insert(&p));
+
+	PrioritySampler sample;
+	for (auto _ : state) {
+		auto& it = items[sample.index(n)];
+		**it = sample();
+		q.update(it);
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.SetComplexityN(n);
+}
+
+// erase all items in random order
+template <typename Backend>
+void orderedRemove(benchmark::State& state) {
+	const size_t n = state.range(0);
+	auto prios = samplePriorities(n);
+	PrioritySampler sample;
+	for (auto _ : state) {
+		state.PauseTiming();
+		PrioQueue<Backend> q;
+		std::vector<typename PrioQueue<Backend>::iterator> items;
+		for (auto& p : prios)
+			items.push_back(q.insert(&p));
+		std::shuffle(items.begin(), items.end(), std::mt19937(sample.index(n)));
+		state.ResumeTiming();
+
+		for (auto it : items)
+			q.erase(it);
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	state.SetComplexityN(n);
+}
+
+// visit all items in order
+template <typename Backend>
+void orderedIterate(benchmark::State& state) {
+	const size_t n = state.range(0);
+	auto prios = samplePriorities(n);
+	PrioQueue<Backend> q;
+	for (auto& p : prios)
+		q.insert(&p);
+
+	for (auto _ : state) {
+		double sum = 0.0;
+		for (const Prio* p : q)
+			sum += p->cost();
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	state.SetComplexityN(n);
+}
+
+// the list backend is linear in n per insertion: stop at 10k to keep runtime bounded
+#define BENCHMARK_ORDERED(fn)                                                                         \
+	BENCHMARK_TEMPLATE(fn, ordered_backend::list)->RangeMultiplier(10)->Range(10, 10000)->Complexity(); \
+	BENCHMARK_TEMPLATE(fn, ordered_backend::indexed)->RangeMultiplier(10)->Range(10, 100000)->Complexity()
+
+BENCHMARK_ORDERED(orderedInsert);
+BENCHMARK_ORDERED(orderedUpdate);
+BENCHMARK_ORDERED(orderedRemove);
+BENCHMARK_ORDERED(orderedIterate);
+
+// insertion and popping of cost_ordered items, as used for solution queues
+void costOrderedPushPop(benchmark::State& state) {
+	const size_t n = state.range(0);
+	auto prios = samplePriorities(n);
+	for (auto _ : state) {
+		cost_ordered<const Prio*> q;
+		for (const auto& p : prios)
+			q.insert(&p, p.cost());
+		while (!q.empty())
+			benchmark::DoNotOptimize(q.pop());
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	state.SetComplexityN(n);
+}
+BENCHMARK(costOrderedPushPop)->RangeMultiplier(10)->Range(10, 10000)->Complexity();
+
+// InterfaceStates sharing a single scene, filled with realistic priorities
+struct States
+{
+	std::vector<std::unique_ptr<InterfaceState>> states;
+
+	States(size_t n) {
+		auto scene = std::make_shared<planning_scene::PlanningScene>(getModel());
+		for (const auto& p : samplePriorities(n))
+			states.push_back(std::make_unique<InterfaceState>(scene, p));
+	}
+};
+
+// adding n states to an Interface
+void interfaceAdd(benchmark::State& state) {
+	const size_t n = state.range(0);
+	States s(n);
+	for (auto _ : state) {
+		Interface interface;
+		for (auto& st : s.states)
+			interface.add(*st);
+		state.PauseTiming();
+		while (!interface.empty())
+			interface.remove(interface.begin());
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	state.SetComplexityN(n);
+}
+BENCHMARK(interfaceAdd)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+// Interface::updatePriority() under churn: random states receive random new priorities
+void interfaceUpdatePriority(benchmark::State& state) {
+	const size_t n = state.range(0);
+	States s(n);
+	size_t notifications = 0;
+	Interface interface([&notifications](Interface::iterator, Interface::UpdateFlags) { ++notifications; });
+	for (auto& st : s.states)
+		interface.add(*st);
+
+	PrioritySampler sample;
+	for (auto _ : state)
+		interface.updatePriority(s.states[sample.index(n)].get(), sample());
+
+	state.SetItemsProcessed(state.iterations());
+	state.SetComplexityN(n);
+	state.counters["notifications"] = benchmark::Counter(notifications, benchmark::Counter::kAvgIterations);
+	while (!interface.empty())
+		interface.remove(interface.begin());
+}
+BENCHMARK(interfaceUpdatePriority)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+// visit all states of an Interface in priority order
+void interfaceIterate(benchmark::State& state) {
+	const size_t n = state.range(0);
+	States s(n);
+	Interface interface;
+	for (auto& st : s.states)
+		interface.add(*st);
+
+	for (auto _ : state) {
+		size_t enabled = 0;
+		for (const InterfaceState* st : interface)
+			enabled += st->priority().enabled();
+		benchmark::DoNotOptimize(enabled);
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	state.SetComplexityN(n);
+	while (!interface.empty())
+		interface.remove(interface.begin());
+}
+BENCHMARK(interfaceIterate)->RangeMultiplier(10)->Range(10, 100000)->Complexity();
+
+// growth of ConnectingPrivate's pending pairs: n start and n end states arrive alternately
+void connectingPending(benchmark::State& state) {
+	const size_t n = state.range(0);
+	for (auto _ : state) {
+		state.PauseTiming();
+		resetMockupIds();
+		auto starts = std::make_unique<States>(n);
+		auto ends = std::make_unique<States>(n);
+		auto t = std::make_unique<Task>();
+		t->setRobotModel(getModel());
+		t->add(Stage::pointer(new GeneratorMockup()));
+		auto connect = new ConnectMockup();
+		t->add(Stage::pointer(connect));
+		t->add(Stage::pointer(new GeneratorMockup()));
+		t->init();
+		auto impl = connect->pimpl();
+		state.ResumeTiming();
+
+		for (size_t i = 0; i < n; ++i) {
+			impl->starts()->add(*starts->states[i]);
+			impl->ends()->add(*ends->states[i]);
+		}
+
+		state.PauseTiming();
+		t.reset();  // destroy the task before its states
+		starts.reset();
+		ends.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * 2 * n);
+	state.SetComplexityN(n);
+}
+// pairs grow quadratically with n
+BENCHMARK(connectingPending)->RangeMultiplier(10)->Range(10, 1000)->Complexity()->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
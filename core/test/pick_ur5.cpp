@@ -32,8 +32,11 @@ void spawnObject() {
 	psi.applyCollisionObject(o);
 }
 
-TEST(UR5, pick) {
+// pick task, optionally planning approach and lift motions concurrently
+void planPick(bool parallel_motions) {
 	Task t;
+	if (parallel_motions)
+		t.setNumThreads(4);
 
 	Stage* initial_stage = nullptr;
 	auto initial = std::make_unique<stages::CurrentState>("current state");
@@ -63,6 +66,7 @@ TEST(UR5, pick) {
 	auto pick = std::make_unique<stages::Pick>(std::move(grasp));
 	pick->setProperty("eef", std::string("gripper"));
 	pick->setProperty("object", std::string("object"));
+	pick->setParallelMotions(parallel_motions);
 	geometry_msgs::TwistStamped approach;
 	approach.header.frame_id = "s_model_tool0";
 	approach.twist.linear.x = 1.0;
@@ -87,6 +91,15 @@ TEST(UR5, pick) {
 	EXPECT_LE(solutions, 60u);
 }
 
+TEST(UR5, pick) {
+	planPick(false);
+}
+
+// approach and lift of all grasp candidates are planned concurrently, finding as many solutions
+TEST(UR5, pickParallelMotions) {
+	planPick(true);
+}
+
 int main(int argc, char** argv) {
 	testing::InitGoogleTest(&argc, argv);
 	ros::init(argc, argv, "ur5");
@@ -0,0 +1,64 @@
+#include <moveit/task_constructor/arena_p.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+
+using namespace moveit::task_constructor;
+
+TEST(MonotonicArena, alignment) {
+	MonotonicArena arena(64);
+	for (std::size_t alignment : { 1, 2, 4, 8, 16 }) {
+		arena.allocate(1, 1);  // misalign next allocation
+		void* p = arena.allocate(3, alignment);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignment, 0u);
+	}
+}
+
+TEST(MonotonicArena, reuseAfterRelease) {
+	MonotonicArena arena(128);
+	void* first = arena.allocate(100, 8);
+	arena.allocate(100, 8);  // requires a new block
+	EXPECT_EQ(arena.capacity(), 256u);
+
+	arena.allocate(1000, 8);  // oversized block
+	EXPECT_EQ(arena.capacity(), 1256u);
+
+	arena.release();
+	EXPECT_EQ(arena.allocate(100, 8), first);  // blocks are reused
+	arena.allocate(1000, 8);
+	EXPECT_EQ(arena.capacity(), 1256u);
+}
+
+TEST(ArenaAllocator, list) {
+	MonotonicArena arena;
+	std::list<std::string, ArenaAllocator<std::string>> l{ ArenaAllocator<std::string>(&arena) };
+	for (int i = 0; i < 100; ++i)
+		l.emplace_back(std::to_string(i));
+	EXPECT_EQ(l.size(), 100u);
+	EXPECT_EQ(l.back(), "99");
+
+	l.clear();
+	arena.release();
+	l.emplace_back("reused");
+	EXPECT_EQ(l.front(), "reused");
+}
+
+TEST(PoolAllocator, recycling) {
+	auto pool = std::make_shared<RecyclingPool>();
+	std::weak_ptr<RecyclingPool> weak_pool = pool;
+	auto first = std::allocate_shared<std::string>(PoolAllocator<std::string>(pool), "first");
+	const void* address = first.get();
+	first.reset();
+
+	// memory of released objects is reused
+	auto second = std::allocate_shared<std::string>(PoolAllocator<std::string>(pool), "second");
+	EXPECT_EQ(second.get(), address);
+
+	// pool is kept alive by its allocated objects
+	pool.reset();
+	EXPECT_FALSE(weak_pool.expired());
+	second.reset();
+	EXPECT_TRUE(weak_pool.expired());
+}
@@ -2,16 +2,37 @@
 #include <moveit/task_constructor/stage_p.h>
 #include <moveit/task_constructor/task_p.h>
 #include <moveit/task_constructor/stages/fixed_state.h>
+#include <moveit/task_constructor/stages/predicate_filter.h>
+#include <moveit/task_constructor/solution_cache.h>
+#include <moveit/task_constructor/solvers/joint_interpolation.h>
+#include <moveit/task_constructor/solvers/multi_planner.h>
+#include <moveit/task_constructor/plan_recording.h>
+#include <moveit/task_constructor/task_pool.h>
+#include <moveit/task_constructor/task_template.h>
+#include <moveit/task_constructor/task_description.h>
+#include <moveit/task_constructor/moveit_compat.h>
+#include <moveit/task_constructor/thread_pool.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/utils/robot_model_test_utils.h>
 
 #include "stage_mockups.h"
 #include "models.h"
 #include "gtest_value_printers.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
 #include <initializer_list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <thread>
+#include <sched.h>
 
 using namespace moveit::task_constructor;
 
@@ -676,6 +697,48 @@ TEST(Task, timeout) {
 // https://github.com/moveit/moveit_task_constructor/pull/597
 // https://github.com/moveit/moveit_task_constructor/pull/598
 // start planning in another thread, then preempt it in this thread
+TEST_F(TaskTestBase, deduplicateStates) {
+	// all states spawned by GeneratorMockup are identical
+	auto gen = add(t, new GeneratorMockup({ 2.0, 1.0, 3.0 }));
+	gen->setDeduplicationTolerance(1e-3);
+	auto fwd = add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	// 1.0 improves on 2.0, but 3.0 duplicates both
+	EXPECT_EQ(gen->solutions().size(), 2u);
+	EXPECT_EQ(fwd->runs_, 2u);
+	ASSERT_EQ(t.numSolutions(), 2u);
+	EXPECT_EQ(t.solutions().front()->cost(), 1.0);
+}
+
+TEST_F(TaskTestBase, solutionDiversity) {
+	// all solutions end in identical states
+	add(t, new GeneratorMockup({ 3.0, 1.0, 2.0 }));
+	add(t, new ForwardMockup());
+	t.setSolutionDiversity(1e-3);
+
+	EXPECT_TRUE(t.plan());
+	// 1.0 evicts 3.0, 2.0 is dropped as near-duplicate of 1.0
+	ASSERT_EQ(t.numSolutions(), 1u);
+	EXPECT_EQ(t.solutions().front()->cost(), 1.0);
+	EXPECT_EQ(t.stages()->failures().size(), 2u);
+	EXPECT_EQ(t.stages()->numEvictedSolutions(), 1u);
+}
+
+TEST_F(TaskTestBase, maxStoredSolutions) {
+	auto gen = add(t, new GeneratorMockup({ 3.0, 4.0, 1.0, 2.0, 5.0 }));
+	gen->setMaxStoredSolutions(2);
+	add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	ASSERT_EQ(gen->solutions().size(), 2u);
+	EXPECT_EQ(gen->solutions().front()->cost(), 1.0);
+	EXPECT_EQ(gen->solutions().back()->cost(), 2.0);
+	// 4.0 and 5.0 were dropped, 3.0 was evicted by 2.0
+	EXPECT_EQ(gen->numEvictedSolutions(), 3u);
+	EXPECT_EQ(gen->failures().back()->comment(), "evicted: exceeding max_stored_solutions");
+}
+
 TEST_F(TaskTestBase, preempt) {
 	moveit::core::MoveItErrorCode ec;
 	resetMockupIds();
@@ -717,3 +780,1386 @@ TEST_F(TaskTestBase, preempt) {
 	EXPECT_EQ(fwd2->runs_, 0u);
 	EXPECT_TRUE(t.plan(1));  // make sure the preempt request has been resetted on the previous call to plan()
 }
+
+TEST_F(TaskTestBase, multi_threaded) {
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup({ 1.0, 2.0, 3.0 }));
+		add(task, new TimedForwardMockup(std::chrono::milliseconds(1)));
+		add(task, new ForwardMockup());
+		add(task, new ConnectMockup());
+		add(task, new GeneratorMockup({ 0.0, 0.0 }));
+	};
+	auto costs = [](const Task& task) {
+		std::vector<double> result;
+		for (const auto& s : task.solutions())
+			result.push_back(s->cost());
+		return result;
+	};
+	const std::vector<double> expected{ 1, 1, 2, 2, 3, 3 };
+
+	t.setNumThreads(4);
+	EXPECT_EQ(t.numThreads(), 4u);
+	build(t);
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(costs(t), expected);
+
+	// single-threaded planning yields the same solutions
+	Task single;
+	single.setNumThreads(0);
+	EXPECT_EQ(single.numThreads(), 1u);
+	build(single);
+	EXPECT_TRUE(single.plan());
+	EXPECT_EQ(costs(single), expected);
+}
+
+TEST_F(TaskTestBase, concurrentConnectPairs) {
+	t.setNumThreads(4);
+	add(t, new GeneratorMockup({ 1.0, 2.0, 3.0 }));
+	auto connect = add(t, new ConnectMockup());
+	connect->setMaxConcurrentPairs(4);
+	add(t, new GeneratorMockup({ 0.0, 10.0 }));
+
+	EXPECT_TRUE(t.plan());
+	std::vector<double> costs;
+	for (const auto& s : t.solutions())
+		costs.push_back(s->cost());
+	EXPECT_EQ(costs, std::vector<double>({ 1, 2, 3, 11, 12, 13 }));
+	EXPECT_EQ(connect->runs_, 6u);
+}
+
+TEST_F(TaskTestBase, lazyConnectCompatibility) {
+	// connect stage counting compatibility checks
+	struct CountingConnect : ConnectMockup
+	{
+		mutable size_t checks_ = 0;
+		bool compatible(const InterfaceState& from, const InterfaceState& to) const override {
+			++checks_;
+			return ConnectMockup::compatible(from, to);
+		}
+	};
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup(PredefinedCosts(std::list<double>(10, 0.0)), 10));
+		auto connect = add(task, new CountingConnect());
+		add(task, new GeneratorMockup(PredefinedCosts(std::list<double>(10, 0.0)), 10));
+		return connect;
+	};
+
+	// pairs are only checked when needed
+	auto connect = build(t);
+	EXPECT_TRUE(t.plan(1));
+	EXPECT_LT(connect->checks_, 100u);
+
+	// ... and at most once
+	Task all;
+	connect = build(all);
+	EXPECT_TRUE(all.plan());
+	EXPECT_EQ(all.solutions().size(), 100u);
+	EXPECT_EQ(connect->runs_, 100u);
+	EXPECT_LE(connect->checks_, 100u);
+}
+
+TEST_F(TaskTestBase, concurrentConnectPairsFailure) {
+	// connect stage failing on the first pair computed concurrently
+	struct FailingConnect : ConnectMockup
+	{
+		std::atomic<bool> failed_{ false };
+		std::function<void()> computeConcurrently(const InterfaceState& from, const InterfaceState& to) override {
+			if (!failed_.exchange(true))
+				throw std::runtime_error("failed");
+			return ConnectMockup::computeConcurrently(from, to);
+		}
+	};
+	t.setNumThreads(4);
+	add(t, new GeneratorMockup({ 1.0, 2.0 }, 2));
+	auto connect = add(t, new FailingConnect());
+	connect->setMaxConcurrentPairs(4);
+	add(t, new GeneratorMockup({ 0.0, 10.0 }, 2));
+
+	EXPECT_THROW(t.plan(), std::runtime_error);
+	// the other pairs of the batch are still finished
+	EXPECT_TRUE(connect->failed_);
+	EXPECT_EQ(connect->runs_, 3u);
+	EXPECT_EQ(t.solutions().size(), 3u);
+}
+
+TEST_F(TaskTestBase, solverThreadPool) {
+	// stage running its solver work concurrently, recording the threads used
+	struct SolverMockup : ForwardMockup
+	{
+		std::mutex mutex_;
+		std::set<std::thread::id> threads_;
+		size_t concurrency_ = 0;
+		void computeForward(const InterfaceState& from) override {
+			concurrency_ = concurrency();
+			std::vector<std::function<void()>> jobs(4, [this] {
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				std::lock_guard<std::mutex> lock(mutex_);
+				threads_.insert(std::this_thread::get_id());
+			});
+			runConcurrently(std::move(jobs));
+			ForwardMockup::computeForward(from);
+		}
+	};
+	const int cpu = sched_getcpu();  // a CPU we are allowed to use
+	ThreadPool::Options options;
+	options.cpus = { static_cast<unsigned int>(cpu) };
+	options.pin = true;
+	options.policy = ThreadPool::Options::BATCH;
+	auto solver_pool = std::make_shared<ThreadPool>(2, options);
+	t.setSolverThreadPool(solver_pool);
+	add(t, new GeneratorMockup({ 1.0 }));
+	auto solver = add(t, new SolverMockup());
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 1u);
+	// single-threaded stage computation, but solver work runs on the solver pool
+	EXPECT_EQ(solver->concurrency_, 3u);
+	EXPECT_GT(solver->threads_.size(), 1u);
+
+	// workers are restricted to the configured CPUs
+	std::vector<int> cpus(4, -1);
+	std::vector<ThreadPool::Job> jobs;
+	for (size_t i = 0; i < cpus.size(); ++i)
+		jobs.emplace_back([&cpus, i, caller = std::this_thread::get_id()] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			if (std::this_thread::get_id() != caller)
+				cpus[i] = sched_getcpu();
+		});
+	solver_pool->run(std::move(jobs));
+	for (int used : cpus)
+		EXPECT_TRUE(used == -1 || used == cpu) << used;
+}
+
+TEST_F(TaskTestBase, priorityScheduler) {
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup({ 1.0, 2.0, 3.0 }));
+		add(task, new ForwardMockup());
+		auto alternatives = std::make_unique<Alternatives>();
+		alternatives->add(Stage::pointer(new ForwardMockup()));
+		alternatives->add(Stage::pointer(new ForwardMockup(PredefinedCosts::constant(1.0))));
+		task.add(std::move(alternatives));
+		add(task, new ConnectMockup());
+		add(task, new GeneratorMockup({ 0.0, 0.0 }));
+	};
+	auto costs = [](const Task& task) {
+		std::vector<double> result;
+		for (const auto& s : task.solutions())
+			result.push_back(s->cost());
+		return result;
+	};
+
+	auto scheduler = std::make_shared<PriorityScheduler>();
+	t.setScheduler(scheduler);
+	build(t);
+	EXPECT_TRUE(t.plan());
+	// Alternatives are flattened into their children
+	EXPECT_EQ(scheduler->units().size(), 6u);
+
+	// the default traversal yields the same solutions
+	Task traversal;
+	build(traversal);
+	EXPECT_TRUE(traversal.plan());
+	EXPECT_EQ(costs(t), costs(traversal));
+}
+
+TEST_F(TaskTestBase, banditScheduler) {
+	auto scheduler = std::make_shared<BanditScheduler>();
+	t.setScheduler(scheduler);
+	t.setRobotModel(getModel());
+	add(t, new GeneratorMockup(PredefinedCosts(std::list<double>(20, 0.0))));
+	auto alternatives = std::make_unique<Alternatives>();
+	auto failing = add(*alternatives, new ForwardMockup(PredefinedCosts::constant(INF)));
+	auto succeeding = add(*alternatives, new ForwardMockup());
+	t.add(std::move(alternatives));
+
+	EXPECT_TRUE(t.plan(5));
+	EXPECT_EQ(t.solutions().size(), 5u);
+	// generator plus one arm per branch
+	ASSERT_EQ(scheduler->arms().size(), 3u);
+	EXPECT_EQ(scheduler->arms()[2].root, succeeding);
+	// compute time shifted towards the productive branch
+	EXPECT_LT(failing->runs_, succeeding->runs_);
+}
+
+TEST_F(TaskTestBase, pipelineScheduler) {
+	auto scheduler = std::make_shared<PipelineScheduler>(2);
+	t.setScheduler(scheduler);
+	t.setNumThreads(2);
+	t.setRobotModel(getModel());
+	add(t, new GeneratorMockup(PredefinedCosts(std::list<double>(10, 0.0))));
+	add(t, new ForwardMockup());
+	add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(scheduler->units().size(), 3u);
+	// backpressure must not lose any states
+	EXPECT_EQ(t.solutions().size(), 10u);
+}
+
+TEST_F(TaskTestBase, pipelineSchedulerNestedBatches) {
+	// pipeline workers occupy all threads of the pool, while stages run their own batches concurrently
+	t.setScheduler(std::make_shared<PipelineScheduler>(4));
+	t.setNumThreads(3);
+	t.setRobotModel(getModel());
+	add(t, new GeneratorMockup(PredefinedCosts(std::list<double>(8, 0.0))));
+	auto forward = add(t, new ForwardMockup());
+	forward->setMaxBatchSize(4);
+	auto connect = add(t, new ConnectMockup());
+	connect->setMaxConcurrentPairs(4);
+	add(t, new GeneratorMockup({ 0.0, 1.0 }));
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.solutions().size(), 16u);
+	EXPECT_EQ(connect->runs_, 16u);
+}
+
+TEST_F(TaskTestBase, demandScheduler) {
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new BackwardMockup());
+		return add(task, new GeneratorMockup(PredefinedCosts::constant(0.0)));
+	};
+
+	auto scheduler = std::make_shared<DemandScheduler>();
+	t.setScheduler(scheduler);
+	auto gen = build(t);
+	EXPECT_TRUE(t.plan(1));
+	EXPECT_EQ(scheduler->units().size(), 2u);
+	// the generator is parked while its state is pending downstream
+	EXPECT_EQ(gen->runs_, 1u);
+
+	// the default traversal keeps generating while the backward stage processes the first state
+	Task traversal;
+	auto traversal_gen = build(traversal);
+	EXPECT_TRUE(traversal.plan(1));
+	EXPECT_GT(traversal_gen->runs_, gen->runs_);
+}
+
+TEST_F(TaskTestBase, compiledScheduler) {
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup({ 1.0, 2.0, 3.0 }));
+		auto alternatives = std::make_unique<Alternatives>();
+		alternatives->add(Stage::pointer(new ForwardMockup()));
+		alternatives->add(Stage::pointer(new ForwardMockup(PredefinedCosts::constant(1.0))));
+		task.add(std::move(alternatives));
+		add(task, new ForwardMockup());
+	};
+	auto costs = [](const Task& task) {
+		std::vector<double> result;
+		for (const auto& s : task.solutions())
+			result.push_back(s->cost());
+		return result;
+	};
+
+	auto scheduler = std::make_shared<CompiledScheduler>();
+	t.setScheduler(scheduler);
+	build(t);
+	EXPECT_TRUE(t.plan());
+	ASSERT_EQ(scheduler->units().size(), 4u);
+	// only the generator is polled, the other units are driven by their input interfaces
+	EXPECT_TRUE(scheduler->units()[0].polled);
+	EXPECT_FALSE(scheduler->units()[3].polled);
+	EXPECT_FALSE(t.canCompute());
+
+	// the default traversal yields the same solutions
+	Task traversal;
+	build(traversal);
+	EXPECT_TRUE(traversal.plan());
+	EXPECT_EQ(costs(t), costs(traversal));
+}
+
+TEST_F(TaskTestBase, nearestCandidates) {
+	// generator spawning all its states at once, at given joint positions
+	struct PositionGenerator : GeneratorMockup
+	{
+		std::list<double> positions_;
+		PositionGenerator(std::initializer_list<double> costs, std::list<double> positions)
+		  : GeneratorMockup(costs, costs.size()), positions_(std::move(positions)) {}
+		void compute() override {
+			++runs_;
+			while (canCompute()) {
+				auto scene = ps_->diff();
+				scene->getCurrentStateNonConst().setVariablePosition(0, positions_.front());
+				positions_.pop_front();
+				spawn(InterfaceState(scene), costs_.cost());
+			}
+		}
+	};
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new PositionGenerator({ 0.0 }, { 0.0 }));
+		auto connect = add(task, new ConnectMockup());
+		add(task, new PositionGenerator({ 0.0, 0.1 }, { 2.0, 0.1 }));
+		return connect;
+	};
+
+	// by priority, the far end state is connected first
+	build(t);
+	EXPECT_TRUE(t.plan(1));
+	EXPECT_EQ(t.solutions().front()->cost(), 0.0);
+
+	// among the two best candidates, the closest end state is connected first
+	Task nearest;
+	build(nearest)->setNearestCandidates(2);
+	EXPECT_TRUE(nearest.plan(1));
+	EXPECT_DOUBLE_EQ(nearest.solutions().front()->cost(), 0.1);
+}
+
+TEST_F(TaskTestBase, stageWatchdog) {
+	// generator hanging until cancelled
+	struct HangingGenerator : GeneratorMockup
+	{
+		using GeneratorMockup::GeneratorMockup;
+		void compute() override {
+			while (!solvers::PlannerCancellation::cancelled())
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			GeneratorMockup::compute();
+		}
+	};
+	t.setStageWatchdog(true);
+	t.setRobotModel(getModel());
+	auto gen = add(t, new HangingGenerator(PredefinedCosts::single(0.0)));
+	gen->setTimeout(0.05);
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(gen->numTimeouts(), 1u);
+	EXPECT_EQ(gen->numFailures(), 1u);
+}
+
+TEST_F(TaskTestBase, hardwareCounters) {
+	t.setHardwareCounters(true);
+	t.setRobotModel(getModel());
+	auto gen = add(t, new GeneratorMockup());
+	auto fwd = add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	if (!PerfCounters::available())
+		return;  // no perf_event support: counters remain zero
+	EXPECT_GT(gen->hardwareCounters().cycles, 0u);
+	EXPECT_GT(fwd->hardwareCounters().instructions, 0u);
+	// containers don't measure on their own
+	EXPECT_EQ(t.stages()->hardwareCounters().cycles, 0u);
+
+	t.reset();
+	EXPECT_EQ(gen->hardwareCounters().cycles, 0u);
+}
+
+TEST_F(TaskTestBase, concurrentCosts) {
+	t.setNumThreads(4);
+	t.setConcurrentCosts(true);
+	std::atomic<size_t> evaluations{ 0 };
+	auto gen = add(t, new GeneratorMockup({ 3.0, 1.0, 2.0 }, 3));
+	gen->setCostTerm([&evaluations](const SubTrajectory& s) {
+		++evaluations;
+		return s.cost() + 10.0;
+	});
+	add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	std::vector<double> costs;
+	for (const auto& s : t.solutions())
+		costs.push_back(s->cost());
+	EXPECT_EQ(costs, std::vector<double>({ 11, 12, 13 }));
+	EXPECT_EQ(evaluations, 3u);
+	EXPECT_EQ(gen->runs_, 1u);
+}
+
+TEST_F(TaskTestBase, diagnostics) {
+	t.enableDiagnostics(1.0, 60.0);
+	add(t, new GeneratorMockup(PredefinedCosts::constant(0.0)));
+	add(t, new ForwardMockup(PredefinedCosts({ INF, 0.0, INF, 0.0 })));
+
+	EXPECT_TRUE(t.plan(1));
+	t.reset();
+	EXPECT_TRUE(t.plan(1));
+	ASSERT_NE(t.diagnostics(), nullptr);
+	EXPECT_EQ(t.diagnostics()->numPlans(), 2u);
+
+	diagnostic_msgs::DiagnosticStatus status;
+	t.diagnostics()->fillStatus(status, *t.stages());
+	EXPECT_EQ(status.level, diagnostic_msgs::DiagnosticStatus::OK);
+	std::map<std::string, std::string> values;
+	for (const auto& kv : status.values)
+		values[kv.key] = kv.value;
+	EXPECT_EQ(values["success ratio"], "1");
+	EXPECT_EQ(values["FWD1: failure ratio"], "0.5");  // infinite costs are failures
+	EXPECT_NE(values.count("GEN1: states/s"), 0u);
+
+	t.enableDiagnostics(0.0);
+	EXPECT_EQ(t.diagnostics(), nullptr);
+}
+
+TEST_F(TaskTestBase, statisticsAggregator) {
+	auto aggregator = std::make_shared<StatisticsAggregator>(0.0);
+	t.setName("first");
+	t.setStatisticsAggregator(aggregator);
+	add(t, new GeneratorMockup({ 2.0, 1.0 }));
+	add(t, new ForwardMockup());
+	EXPECT_TRUE(t.plan());
+
+	{
+		Task other;
+		other.setRobotModel(getModel());
+		other.setName("second");
+		other.setStatisticsAggregator(aggregator);
+		add(other, new GeneratorMockup({ INF }));
+		EXPECT_FALSE(other.plan());
+
+		moveit_task_constructor_msgs::FleetStatistics msg;
+		aggregator->fill(msg);
+		ASSERT_EQ(msg.tasks.size(), 2u);
+		std::map<std::string, moveit_task_constructor_msgs::TaskSummary> summaries;
+		for (const auto& summary : msg.tasks)
+			summaries[summary.name] = summary;
+
+		const auto& first = summaries["first"];
+		EXPECT_FALSE(first.planning);
+		EXPECT_EQ(first.num_solutions, 2u);
+		EXPECT_EQ(first.best_cost, 1.0);
+		EXPECT_GE(first.time_to_first_solution, 0.0);
+		EXPECT_EQ(first.stage_names, std::vector<std::string>({ "first", "GEN1", "FWD1" }));
+		EXPECT_EQ(first.stage_compute_times.size(), 3u);
+
+		const auto& second = summaries["second"];
+		EXPECT_EQ(second.num_solutions, 0u);
+		EXPECT_EQ(second.best_cost, INF);
+		EXPECT_LT(second.time_to_first_solution, 0.0);
+	}
+
+	// destroyed tasks are not reported anymore
+	moveit_task_constructor_msgs::FleetStatistics msg;
+	aggregator->fill(msg);
+	ASSERT_EQ(msg.tasks.size(), 1u);
+	EXPECT_EQ(msg.tasks.front().name, "first");
+}
+
+TEST_F(TaskTestBase, solutionSnapshot) {
+	add(t, new GeneratorMockup({ 3.0, 1.0, 2.0 }));
+	add(t, new ForwardMockup());
+	EXPECT_EQ(t.solutionSnapshot(), nullptr);  // not yet initialized
+
+	std::vector<SolutionSnapshot> snapshots;
+	t.addSolutionCallback([this, &snapshots](const SolutionBase& /*solution*/) {
+		snapshots.push_back(t.solutionSnapshot());
+	});
+	EXPECT_TRUE(t.plan());
+	ASSERT_EQ(snapshots.size(), 3u);
+	// earlier snapshots are not affected by later solutions
+	for (size_t i = 1; i < snapshots.size(); ++i)
+		EXPECT_LE(snapshots[i - 1]->size(), snapshots[i]->size());
+
+	auto snapshot = t.solutionSnapshot();
+	ASSERT_EQ(snapshot->size(), 3u);
+	EXPECT_TRUE(std::equal(snapshot->begin(), snapshot->end(), t.solutions().begin()));
+	EXPECT_EQ(snapshot->front()->cost(), 1.0);
+	EXPECT_EQ(snapshot->back()->cost(), 3.0);
+
+	// snapshots keep their solutions alive beyond reset()
+	t.reset();
+	EXPECT_TRUE(t.solutionSnapshot()->empty());
+	ASSERT_EQ(snapshot->size(), 3u);
+	EXPECT_EQ(snapshot->front()->cost(), 1.0);
+}
+
+TEST_F(TaskTestBase, interfaceInbox) {
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup({ 1.0, 2.0 }));
+		auto alternatives = std::make_unique<Alternatives>();
+		add(*alternatives, new ForwardMockup());
+		add(*alternatives, new ForwardMockup(PredefinedCosts::constant(10.0)));
+		task.add(std::move(alternatives));
+		add(task, new ConnectMockup());
+		add(task, new GeneratorMockup({ 0.0 }));
+	};
+	auto costs = [](const Task& task) {
+		std::vector<double> result;
+		for (const auto& s : task.solutions())
+			result.push_back(s->cost());
+		return result;
+	};
+
+	t.setInterfaceInbox(true);
+	t.setNumThreads(2);
+	build(t);
+	EXPECT_TRUE(t.plan());
+
+	Task direct;
+	build(direct);
+	EXPECT_TRUE(direct.plan());
+	EXPECT_EQ(costs(t), costs(direct));
+	EXPECT_EQ(costs(t), std::vector<double>({ 1, 2, 11, 12 }));
+}
+
+TEST_F(TaskTestBase, concurrentAlternatives) {
+	auto build = [this](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup({ 1.0, 2.0 }));
+		auto alternatives = std::make_unique<Alternatives>();
+		add(*alternatives, new TimedForwardMockup(std::chrono::milliseconds(1)));
+		add(*alternatives, new ForwardMockup(PredefinedCosts::constant(10.0)));
+		task.add(std::move(alternatives));
+	};
+	auto costs = [](const Task& task) {
+		std::vector<double> result;
+		for (const auto& s : task.solutions())
+			result.push_back(s->cost());
+		return result;
+	};
+	const std::vector<double> expected{ 1, 2, 11, 12 };
+
+	t.setNumThreads(2);
+	build(t);
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(costs(t), expected);
+
+	Task single;
+	build(single);
+	EXPECT_TRUE(single.plan());
+	EXPECT_EQ(costs(single), expected);
+}
+
+TEST_F(TaskTestBase, solutionStream) {
+	add(t, new GeneratorMockup({ 1.0, 2.0, 3.0 }));
+	add(t, new ForwardMockup());
+
+	auto stream = t.streamSolutions();
+	std::vector<SolutionBaseConstPtr> streamed;
+	std::thread consumer([&stream, &streamed] {
+		while (auto s = stream->next())
+			streamed.push_back(s);
+	});
+	EXPECT_TRUE(t.plan());
+	consumer.join();
+
+	EXPECT_TRUE(stream->closed());
+	ASSERT_EQ(streamed.size(), 3u);
+	// solutions are streamed in order of discovery
+	EXPECT_EQ(streamed[0]->cost(), 1.0);
+	EXPECT_EQ(streamed[2]->cost(), 3.0);
+	EXPECT_EQ(stream->tryNext(), nullptr);
+}
+
+// generator yielding a single solution per planning request, counting its init() calls
+struct CountingGenerator : public Generator
+{
+	planning_scene::PlanningScenePtr ps_;
+	bool ran_ = false;
+	size_t inits_ = 0;
+
+	CountingGenerator() : Generator("counting generator") {}
+	void init(const moveit::core::RobotModelConstPtr& robot_model) override {
+		++inits_;
+		ps_ = std::make_shared<planning_scene::PlanningScene>(robot_model);
+		Generator::init(robot_model);
+	}
+	void reset() override {
+		ran_ = false;
+		Generator::reset();
+	}
+	bool canCompute() const override { return !ran_; }
+	void compute() override {
+		ran_ = true;
+		spawn(InterfaceState(ps_), 1.0);
+	}
+};
+
+TEST_F(TaskTestBase, softReset) {
+	auto gen = add(t, new CountingGenerator());
+	add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 1u);
+
+	// soft reset clears solutions, but keeps the initialized structure
+	t.softReset();
+	EXPECT_EQ(t.numSolutions(), 0u);
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 1u);
+	EXPECT_EQ(gen->inits_, 1u);
+
+	// full reset requires init() again
+	t.reset();
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 1u);
+	EXPECT_EQ(gen->inits_, 2u);
+}
+
+TEST(TaskTemplate, instantiate) {
+	resetMockupIds();
+	TaskTemplate tmpl(
+	    [](Task& task) {
+		    task.add(std::make_unique<GeneratorMockup>(PredefinedCosts::single(1.0)));
+		    auto fwd = std::make_unique<ForwardMockup>();
+		    fwd->setName("forward");
+		    task.add(std::move(fwd));
+	    },
+	    getModel());
+
+	Task a = tmpl.instantiate("a", { { "forward", "timeout", 1.0 } });
+	Task b = tmpl.instantiate("b", { { "forward", "timeout", 2.0 } });
+	EXPECT_EQ(a.name(), "a");
+	EXPECT_EQ(a.getRobotModel(), b.getRobotModel());
+	EXPECT_EQ(a.findChild("forward")->timeout(), 1.0);
+	EXPECT_EQ(b.findChild("forward")->timeout(), 2.0);
+
+	EXPECT_TRUE(a.plan());
+	EXPECT_EQ(a.numSolutions(), 1u);
+
+	EXPECT_THROW(tmpl.instantiate("c", { { "unknown", "timeout", 1.0 } }), std::runtime_error);
+	EXPECT_THROW(tmpl.instantiate("c", { { "forward", "timeout", std::string("1.0") } }), Property::error);
+}
+
+TEST(TaskDescription, roundtrip) {
+	resetMockupIds();
+	TaskDescription::registerStageType<GeneratorMockup>("GeneratorMockup");
+	TaskDescription::registerStageType<ForwardMockup>("ForwardMockup");
+
+	Task t;
+	t.setRobotModel(getModel());
+	t.setProperty("group", std::string("group"));
+	t.add(std::make_unique<GeneratorMockup>());
+	auto alternatives = std::make_unique<Alternatives>("alternatives");
+	auto fwd = std::make_unique<ForwardMockup>();
+	fwd->setName("forward");
+	fwd->setTimeout(2.0);
+	alternatives->add(std::move(fwd));
+	t.add(std::move(alternatives));
+
+	const std::string path = "/tmp/mtc_task_description_test.bin";
+	TaskDescription::describe(t).save(path);
+	TaskDescription desc = TaskDescription::load(path);
+	std::remove(path.c_str());
+	EXPECT_EQ(desc.numStages(), 3u);
+
+	TaskTemplate tmpl([desc](Task& task) { desc.build(task); }, getModel());
+	Task copy = tmpl.instantiate("copy");
+	EXPECT_EQ(copy.properties().get<std::string>("group"), "group");
+	auto* container = dynamic_cast<Alternatives*>(copy.findChild("alternatives"));
+	ASSERT_TRUE(container);
+	EXPECT_EQ(container->numChildren(), 1u);
+	EXPECT_EQ(container->findChild("forward")->timeout(), 2.0);
+	EXPECT_TRUE(copy.plan());
+	EXPECT_EQ(copy.numSolutions(), 1u);
+
+	// stages of unregistered types cannot be described
+	t.add(std::make_unique<BackwardMockup>());
+	EXPECT_THROW(TaskDescription::describe(t), std::runtime_error);
+	EXPECT_THROW(TaskDescription::load("/nonexistent"), std::runtime_error);
+}
+
+TEST(TaskPool, planAll) {
+	resetMockupIds();
+	std::vector<TaskPtr> tasks;
+	for (size_t i = 0; i < 3; ++i) {
+		auto task = std::make_shared<Task>();
+		task->add(std::make_unique<GeneratorMockup>(PredefinedCosts({ 1.0, 2.0 })));
+		task->add(std::make_unique<ForwardMockup>(PredefinedCosts::constant(0.0), 2));
+		tasks.push_back(task);
+	}
+
+	TaskPool pool(2, 2, getModel());
+	auto results = pool.planAll(tasks);
+	ASSERT_EQ(results.size(), tasks.size());
+	for (size_t i = 0; i < tasks.size(); ++i) {
+		EXPECT_TRUE(results[i]);
+		EXPECT_EQ(tasks[i]->getRobotModel(), pool.getRobotModel());
+		EXPECT_EQ(tasks[i]->numSolutions(), 4u);
+	}
+	EXPECT_EQ(pool.pending(), 0u);
+}
+
+TEST_F(TaskTestBase, replanKeepsValidSolutions) {
+	auto gen = add(t, new GeneratorMockup({ 1.0, 2.0 }));
+	auto fwd = add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 2u);
+	EXPECT_EQ(gen->runs_, 2u);
+	EXPECT_EQ(fwd->runs_, 2u);
+
+	// a scene change not affecting the solutions doesn't require any planning
+	moveit_msgs::PlanningScene diff;
+	diff.is_diff = true;
+	diff.robot_state.is_diff = true;
+	EXPECT_TRUE(t.replan(diff));
+	EXPECT_EQ(t.numSolutions(), 2u);
+	EXPECT_EQ(t.failures().size(), 0u);
+	EXPECT_EQ(gen->runs_, 2u);
+	EXPECT_EQ(fwd->runs_, 2u);
+}
+
+// robot consisting of a single box sliding along the x axis
+moveit::core::RobotModelPtr slidingBoxModel() {
+	geometry_msgs::Pose origin;
+	origin.orientation.w = 1.0;
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->box", "prismatic");
+	builder.addCollisionBox("box", { 0.1, 0.1, 0.1 }, origin);
+	builder.addGroupChain("base", "box", "group");
+	return builder.build();
+}
+
+moveit_msgs::CollisionObject boxObject(const std::string& id, double x) {
+	moveit_msgs::CollisionObject o;
+	o.id = id;
+	o.header.frame_id = "base";
+	o.operation = moveit_msgs::CollisionObject::ADD;
+#if MOVEIT_VERSION_GE(1, 1, 6)
+	o.pose.orientation.w = 1.0;
+#endif
+	o.primitives.resize(1);
+	o.primitives[0].type = shape_msgs::SolidPrimitive::BOX;
+	o.primitives[0].dimensions = { 0.1, 0.1, 0.1 };
+	o.primitive_poses.resize(1);
+	o.primitive_poses[0].position.x = x;
+	o.primitive_poses[0].orientation.w = 1.0;
+	return o;
+}
+
+// generator spawning a state of the sliding box robot per position, optionally holding the "target" object
+struct SlidingBoxGenerator : public Generator
+{
+	std::vector<std::pair<double, bool>> positions_;
+	planning_scene::PlanningScenePtr ps_;
+	size_t runs_ = 0;
+
+	SlidingBoxGenerator(std::vector<std::pair<double, bool>> positions)
+	  : Generator("sliding box"), positions_(std::move(positions)) {}
+	void init(const moveit::core::RobotModelConstPtr& robot_model) override {
+		ps_ = std::make_shared<planning_scene::PlanningScene>(robot_model);
+		ps_->processCollisionObjectMsg(boxObject("target", 5.0));
+		Generator::init(robot_model);
+	}
+	void reset() override {
+		runs_ = 0;
+		Generator::reset();
+	}
+	bool canCompute() const override { return runs_ < positions_.size(); }
+	void compute() override {
+		const auto& position = positions_[runs_];
+		auto scene = ps_->diff();
+		scene->getCurrentStateNonConst().setVariablePosition(0, position.first);
+		scene->getCurrentStateNonConst().update();
+		if (position.second) {  // attach the target
+			moveit_msgs::AttachedCollisionObject aco;
+			aco.link_name = "box";
+			aco.object.id = "target";
+			aco.object.operation = moveit_msgs::CollisionObject::ADD;
+			scene->processAttachedCollisionObjectMsg(aco);
+		}
+		spawn(InterfaceState(scene), runs_++);
+	}
+};
+
+TEST(Task, replanInvalidatesAffectedSolutions) {
+	Task t;
+	t.setRobotModel(slidingBoxModel());
+	auto gen = new SlidingBoxGenerator({ { 0.0, false }, { 1.0, false }, { 2.0, true } });
+	t.add(Stage::pointer(gen));
+	ASSERT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 3u);
+
+	// an obstacle at x = 0 invalidates the first solution, removing the target the one holding it
+	moveit_msgs::PlanningScene diff;
+	diff.is_diff = true;
+	diff.robot_state.is_diff = true;
+	diff.world.collision_objects.push_back(boxObject("obstacle", 0.0));
+	diff.world.collision_objects.push_back(boxObject("target", 5.0));
+	diff.world.collision_objects.back().operation = moveit_msgs::CollisionObject::REMOVE;
+	EXPECT_TRUE(t.replan(diff));
+	ASSERT_EQ(t.numSolutions(), 1u);
+	EXPECT_EQ(t.failures().size(), 2u);
+	EXPECT_EQ(gen->runs_, 3u) << "no planning required";
+
+	// the kept solution reflects the changed world
+	const SolutionBase& kept = *t.solutions().front();
+	EXPECT_EQ(kept.cost(), 1.0);
+	for (const InterfaceState* state : { kept.start(), kept.end() }) {
+		EXPECT_TRUE(state->scene()->getWorld()->hasObject("obstacle"));
+		EXPECT_FALSE(state->scene()->getWorld()->hasObject("target"));
+	}
+}
+
+TEST(Task, replanAppliesSceneDiffToStart) {
+	auto model = slidingBoxModel();
+	auto scene = std::make_shared<planning_scene::PlanningScene>(model);
+	scene->getCurrentStateNonConst().setVariablePosition(0, 0.0);
+	Task t;
+	t.setRobotModel(model);
+	t.add(std::make_unique<stages::FixedState>("start", scene));
+	ASSERT_TRUE(t.plan());
+
+	// moving the robot invalidates all solutions: planning starts from the changed state
+	moveit_msgs::PlanningScene diff;
+	diff.is_diff = true;
+	diff.robot_state.is_diff = true;
+	diff.robot_state.joint_state.name = { model->getVariableNames()[0] };
+	diff.robot_state.joint_state.position = { 1.0 };
+	EXPECT_TRUE(t.replan(diff));
+	ASSERT_EQ(t.numSolutions(), 1u);
+	EXPECT_EQ(t.solutions().front()->end()->scene()->getCurrentState().getVariablePosition(0), 1.0);
+	EXPECT_EQ(scene->getCurrentState().getVariablePosition(0), 0.0) << "FixedState shouldn't modify the given scene";
+
+	// an obstacle at the robot's position invalidates the start state
+	diff = moveit_msgs::PlanningScene();
+	diff.is_diff = true;
+	diff.robot_state.is_diff = true;
+	diff.world.collision_objects.push_back(boxObject("obstacle", 1.0));
+	EXPECT_FALSE(t.replan(diff));
+	EXPECT_EQ(t.numSolutions(), 0u);
+}
+
+// propagator sliding the box by offset, or by -offset if the path is blocked
+struct SlidingBoxMove : public PropagatingForward
+{
+	double offset_;
+	size_t runs_ = 0;
+
+	SlidingBoxMove(double offset) : PropagatingForward("slide"), offset_(offset) {}
+	void reset() override {
+		runs_ = 0;
+		PropagatingForward::reset();
+	}
+	void computeForward(const InterfaceState& from) override {
+		++runs_;
+		for (double offset : { offset_, -offset_ }) {
+			moveit::core::RobotState state = from.scene()->getCurrentState();
+			const double x = state.getVariablePosition(0);
+			auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(state.getRobotModel(), "group");
+			for (double fraction : { 0.0, 0.5, 1.0 }) {
+				state.setVariablePosition(0, x + fraction * offset);
+				state.update();
+				trajectory->addSuffixWayPoint(state, 0.1);
+			}
+			if (!from.scene()->isPathValid(*trajectory))
+				continue;
+			auto scene = from.scene()->diff();
+			scene->setCurrentState(state);
+			sendForward(from, InterfaceState(scene), SubTrajectory(trajectory));
+			return;
+		}
+		silentFailure();
+	}
+};
+
+TEST(Task, replanReusesUnaffectedStates) {
+	Task t;
+	t.setRobotModel(slidingBoxModel());
+	auto gen = new SlidingBoxGenerator({ { 0.0, false }, { 1.0, false } });
+	auto move = new SlidingBoxMove(0.5);
+	t.add(Stage::pointer(gen));
+	t.add(Stage::pointer(move));
+	ASSERT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 2u);
+	EXPECT_EQ(move->runs_, 2u);
+
+	// an obstacle at x = 1.25 only blocks the motion starting at x = 1.0
+	moveit_msgs::PlanningScene diff;
+	diff.is_diff = true;
+	diff.robot_state.is_diff = true;
+	diff.world.collision_objects.push_back(boxObject("obstacle", 1.25));
+	EXPECT_TRUE(t.replan(diff, 2));
+	ASSERT_EQ(t.numSolutions(), 2u);
+	EXPECT_EQ(t.failures().size(), 1u);
+	EXPECT_EQ(gen->runs_, 2u) << "generator states should be reused";
+	EXPECT_EQ(move->runs_, 3u) << "only the affected state should be propagated again";
+	EXPECT_EQ(move->solutions().size(), 2u);
+	EXPECT_EQ(move->failures().size(), 1u);
+
+	// the replanned motion evades the obstacle, starting from the kept generator state
+	std::multiset<double> ends;
+	for (const SolutionBaseConstPtr& solution : t.solutions()) {
+		EXPECT_TRUE(solution->end()->scene()->getWorld()->hasObject("obstacle"));
+		ends.insert(solution->end()->scene()->getCurrentState().getVariablePosition(0));
+	}
+	EXPECT_EQ(ends, std::multiset<double>({ 0.5, 0.5 }));
+	for (const InterfaceState& state : gen->pimpl()->states())
+		EXPECT_TRUE(state.scene()->getWorld()->hasObject("obstacle"));
+}
+
+// propagate trajectories moving a single joint to each of the given positions, using the position as cost
+struct JointMove : public PropagatingForward
+{
+	std::string group_;
+	std::string joint_;
+	std::vector<double> positions_;
+
+	JointMove(const std::string& group, const std::string& joint, std::vector<double> positions)
+	  : PropagatingForward(group), group_(group), joint_(joint), positions_(std::move(positions)) {}
+	void computeForward(const InterfaceState& from) override {
+		for (double position : positions_) {
+			moveit::core::RobotState state = from.scene()->getCurrentState();
+			auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(state.getRobotModel(), group_);
+			trajectory->addSuffixWayPoint(state, 0.0);
+			state.setVariablePosition(joint_, position);
+			state.update();
+			trajectory->addSuffixWayPoint(state, 0.1);
+			auto scene = from.scene()->diff();
+			scene->setCurrentState(state);
+			SubTrajectory solution(trajectory, position);
+			visualization_msgs::Marker marker;
+			marker.ns = group_;  // identifies the child within merged solutions
+			solution.markers().push_back(marker);
+			sendForward(from, InterfaceState(scene), std::move(solution));
+		}
+	}
+};
+
+// Merger enumerates combinations best-first, only merging as many as required for max_solutions
+TEST(Merger, mergesBestCombinationsFirst) {
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->a->b->c", "continuous");
+	builder.addGroupChain("base", "a", "ga");
+	builder.addGroupChain("a", "b", "gb");
+	builder.addGroupChain("b", "c", "gc");
+
+	resetMockupIds();
+	Task t;
+	t.setRobotModel(builder.build());
+	t.add(Stage::pointer(new GeneratorMockup()));
+	auto merger = new Merger();
+	merger->setMaxSolutions(3);
+	// children are computed in order: the solution of the last child triggers merging
+	merger->insert(Stage::pointer(new JointMove("ga", "base-a-joint", { 3.0, 1.0, 2.0 })));
+	merger->insert(Stage::pointer(new JointMove("gb", "a-b-joint", { 0.5, 0.25 })));
+	merger->insert(Stage::pointer(new JointMove("gc", "b-c-joint", { 0.0 })));
+	t.add(Stage::pointer(merger));
+
+	ASSERT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 3u);
+	EXPECT_EQ(merger->solutions().size(), 3u);
+	EXPECT_EQ(merger->failures().size(), 0u);  // no other combination was merged
+
+	std::set<std::pair<double, double>> merged;
+	for (const auto& solution : merger->solutions()) {
+		const auto& trajectory = static_cast<const SubTrajectory&>(*solution).trajectory();
+		ASSERT_TRUE(trajectory);
+		const moveit::core::RobotState& last = trajectory->getLastWayPoint();
+		merged.emplace(last.getVariablePosition("base-a-joint"), last.getVariablePosition("a-b-joint"));
+	}
+	// three cheapest combinations: 1.0 + 0.25, 1.0 + 0.5, 2.0 + 0.25
+	EXPECT_EQ(merged, (std::set<std::pair<double, double>>{ { 1.0, 0.25 }, { 1.0, 0.5 }, { 2.0, 0.25 } }));
+}
+
+// Merger combines children's solutions in insertion order, limiting the number of merged solutions per source state
+TEST(Merger, combinesChildrenInInsertionOrder) {
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->a->b->c", "continuous");
+	builder.addGroupChain("base", "a", "ga");
+	builder.addGroupChain("a", "b", "gb");
+	builder.addGroupChain("b", "c", "gc");
+
+	resetMockupIds();
+	Task t;
+	t.setRobotModel(builder.build());
+	t.add(Stage::pointer(new GeneratorMockup({ 0.0, 0.0 })));  // two source states
+	// created in reverse order, such that allocation order doesn't match insertion order
+	Stage::pointer c(new JointMove("gc", "b-c-joint", { 0.0, 1.0 }));
+	Stage::pointer b(new JointMove("gb", "a-b-joint", { 0.5, 0.25 }));
+	Stage::pointer a(new JointMove("ga", "base-a-joint", { 3.0, 1.0 }));
+	auto merger = new Merger();
+	merger->setMaxSolutions(1);
+	merger->insert(std::move(a));
+	merger->insert(std::move(b));
+	merger->insert(std::move(c));
+	t.add(Stage::pointer(merger));
+
+	ASSERT_TRUE(t.plan());
+	// a single, best merged solution per source state
+	ASSERT_EQ(merger->solutions().size(), 2u);
+	EXPECT_COSTS(merger->solutions(), ::testing::ElementsAre(1.25, 1.25));
+	for (const auto& solution : merger->solutions()) {
+		std::vector<std::string> order;
+		for (const auto& marker : solution->markers())
+			order.push_back(marker.ns);
+		EXPECT_EQ(order, (std::vector<std::string>{ "ga", "gb", "gc" }));
+	}
+}
+
+TEST_F(TaskTestBase, liftsBestSolutionsOnRequest) {
+	add(t, new BackwardMockup(PredefinedCosts({ 3.0, 1.0, 2.0 }), 3));
+	add(t, new GeneratorMockup());
+	add(t, new ForwardMockup(PredefinedCosts({ 2.0, 0.0, 1.0 }), 3));
+
+	// all 9 complete paths are found by a single compute(), but only the best one is lifted
+	EXPECT_TRUE(t.plan(1));
+	EXPECT_COSTS(t.solutions(), ::testing::ElementsAre(1));
+	// the remaining ones are kept pending
+	auto* serial = static_cast<SerialContainerPrivate*>(t.stages()->pimpl());
+	EXPECT_TRUE(serial->hasPendingSolutions());
+	EXPECT_EQ(serial->liftPendingSolutions(), 8u);
+	EXPECT_COSTS(t.solutions(), ::testing::ElementsAre(1, 2, 2, 3, 3, 3, 4, 4, 5));
+}
+
+TEST_F(TaskTestBase, liftsAllSolutionsBestFirst) {
+	add(t, new BackwardMockup(PredefinedCosts({ 3.0, 1.0, 2.0 }), 3));
+	add(t, new GeneratorMockup());
+	add(t, new ForwardMockup(PredefinedCosts({ 2.0, 0.0, 1.0 }), 3));
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_COSTS(t.solutions(), ::testing::ElementsAre(1, 2, 2, 3, 3, 3, 4, 4, 5));
+}
+
+TEST_F(TaskTestBase, parallelChildrenShareStateProperties) {
+	struct PropertyGenerator : GeneratorMockup
+	{
+		void compute() override {
+			++runs_;
+			InterfaceState state(ps_);
+			state.properties().set("marker", 42);
+			spawn(std::move(state), costs_.cost());
+		}
+	};
+	auto* gen = add(t, new PropertyGenerator());
+	auto* alternatives = add(t, new Alternatives());
+	add(*alternatives, new ForwardMockup());
+	add(*alternatives, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	ASSERT_EQ(gen->solutions().size(), 1u);
+	const Property* shared = &gen->solutions().front()->end()->properties().property("marker");
+
+	// the children's copies of the external state share its (copy-on-write) property storage
+	size_t copies = 0;
+	for (const InterfaceState& state : alternatives->pimpl()->states()) {
+		if (!state.properties().hasProperty("marker"))
+			continue;
+		EXPECT_EQ(&state.properties().property("marker"), shared);
+		++copies;
+	}
+	EXPECT_GE(copies, 2u);
+}
+
+TEST_F(TaskTestBase, stablePrefix) {
+	auto gen = add(t, new GeneratorMockup({ 0.0 }));
+	auto fwd1 = add(t, new ForwardMockup());
+	auto fwd2 = add(t, new ForwardMockup());
+	add(t, new ConnectMockup());
+	add(t, new GeneratorMockup({ 0.0, 0.0 }));
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 2u);
+	// prefix ends before Connect, as it yields multiple solutions
+	auto prefix = t.stablePrefix();
+	ASSERT_EQ(prefix.size(), 3u);
+	EXPECT_EQ(prefix[0]->creator(), gen);
+	EXPECT_EQ(prefix[1]->creator(), fwd1);
+	EXPECT_EQ(prefix[2]->creator(), fwd2);
+	EXPECT_EQ(prefix[1]->start(), prefix[0]->end());
+	EXPECT_EQ(prefix[2]->start(), prefix[1]->end());
+}
+
+TEST_F(TaskTestBase, stablePrefixRequiresUniqueStart) {
+	add(t, new GeneratorMockup({ 1.0, 2.0 }));
+	add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_TRUE(t.stablePrefix().empty());
+}
+
+// propagator using the generic compute() interface, counting its runs
+struct CountingPropagator : public PropagatingForward
+{
+	size_t runs_{ 0 };
+	bool compute(const InterfaceState& state, planning_scene::PlanningScenePtr& scene, SubTrajectory& /*trajectory*/,
+	             Interface::Direction /*dir*/) override {
+		++runs_;
+		scene = state.scene()->diff();
+		return true;
+	}
+};
+
+TEST_F(TaskTestBase, solutionCache) {
+	auto cache = std::make_shared<SolutionCache>();
+	auto make_task = [this, &cache](Task& task) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup({ 1.0, 2.0 }));
+		auto prop = add(task, new CountingPropagator());
+		prop->setSolutionCache(cache);
+		return prop;
+	};
+
+	// both generated states are identical: second one is served from cache
+	auto prop = make_task(t);
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 2u);
+	EXPECT_EQ(prop->runs_, 1u);
+	EXPECT_EQ(cache->size(), 1u);
+
+	// the cache can be shared across tasks
+	Task other;
+	prop = make_task(other);
+	EXPECT_TRUE(other.plan());
+	EXPECT_EQ(other.numSolutions(), 2u);
+	EXPECT_EQ(prop->runs_, 0u);
+
+	// changing a property changes the cache key
+	Task modified;
+	prop = make_task(modified);
+	prop->setTimeout(42.0);
+	EXPECT_TRUE(modified.plan());
+	EXPECT_EQ(prop->runs_, 1u);
+	EXPECT_EQ(cache->size(), 2u);
+}
+
+// propagator adding an object to the scene, reporting a (never called) planner
+struct PlanningPropagator : public CountingPropagator
+{
+	solvers::PlannerInterfacePtr planner_;
+	std::vector<solvers::PlannerInterfaceConstPtr> planners() const override { return { planner_ }; }
+	bool compute(const InterfaceState& state, planning_scene::PlanningScenePtr& scene, SubTrajectory& trajectory,
+	             Interface::Direction dir) override {
+		CountingPropagator::compute(state, scene, trajectory, dir);
+		scene->processCollisionObjectMsg(boxObject("box", 1.0));
+		return true;
+	}
+};
+
+TEST_F(TaskTestBase, solutionCacheKey) {
+	auto cache = std::make_shared<SolutionCache>();
+	auto make_task = [this, &cache](Task& task, const solvers::PlannerInterfacePtr& planner) {
+		task.setRobotModel(getModel());
+		add(task, new GeneratorMockup({ 1.0 }));
+		auto prop = add(task, new PlanningPropagator());
+		prop->planner_ = planner;
+		prop->setSolutionCache(cache);
+		return prop;
+	};
+
+	auto planner = std::make_shared<solvers::JointInterpolationPlanner>();
+	auto prop = make_task(t, planner);
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(prop->runs_, 1u);
+
+	// a cached solution restores the full end scene
+	Task same;
+	prop = make_task(same, planner);
+	EXPECT_TRUE(same.plan());
+	EXPECT_EQ(prop->runs_, 0u);
+	ASSERT_EQ(same.numSolutions(), 1u);
+	EXPECT_TRUE(same.solutions().front()->end()->scene()->getWorld()->hasObject("box"));
+
+	// planners of another type or configuration don't share entries
+	auto multi = std::make_shared<solvers::MultiPlanner>();
+	multi->push_back(planner);
+	Task other_type;
+	prop = make_task(other_type, multi);
+	EXPECT_TRUE(other_type.plan());
+	EXPECT_EQ(prop->runs_, 1u);
+
+	auto configured = std::make_shared<solvers::JointInterpolationPlanner>();
+	configured->setProperty("max_step", 0.01);
+	Task other_config;
+	prop = make_task(other_config, configured);
+	EXPECT_TRUE(other_config.plan());
+	EXPECT_EQ(prop->runs_, 1u);
+	EXPECT_EQ(cache->size(), 3u);
+}
+
+TEST(SolutionCache, verifiesInput) {
+	std::string dir = testing::TempDir() + "solution_cache.XXXXXX";
+	ASSERT_TRUE(mkdtemp(&dir[0]));
+
+	auto start = std::make_shared<planning_scene::PlanningScene>(getModel());
+	auto end = start->diff();
+	end->getCurrentStateNonConst().setVariablePosition(0, 1.0);
+	SolutionCache cache(10, dir);
+	const SolutionCache::Key key{ "input", SolutionCache::Key::digestOf("input") };
+	cache.store(key, start, end, SubTrajectory());
+
+	// a key with the same digest, but another input misses, both in memory and on disk
+	const SolutionCache::Key colliding{ "other input", key.digest };
+	planning_scene::PlanningScenePtr restored;
+	SubTrajectory solution;
+	EXPECT_FALSE(cache.lookup(colliding, start, restored, solution));
+	SolutionCache reloaded(10, dir);
+	EXPECT_FALSE(reloaded.lookup(colliding, start, restored, solution));
+
+	ASSERT_TRUE(reloaded.lookup(key, start, restored, solution));
+	EXPECT_EQ(restored->getCurrentState().getVariablePosition(0), 1.0);
+	EXPECT_EQ(SolutionCache::Key::digestOf("input"), 0x1ebbae8f5810b65bull) << "digest should be stable";
+}
+
+TEST_F(TaskTestBase, planRecording) {
+	auto recording = std::make_shared<PlanRecording>(PlanRecording::RECORD);
+	auto make_task = [this, &recording](Task& task) {
+		task.setRobotModel(getModel());
+		task.setPlanRecording(recording);
+		add(task, new GeneratorMockup({ 1.0 }));
+		return add(task, new CountingPropagator());
+	};
+
+	auto prop = make_task(t);
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(prop->runs_, 1u);
+	EXPECT_EQ(recording->size(), 1u);
+	EXPECT_TRUE(recording->hasScene());
+
+	// replay from file without invoking the solver
+	const std::string path = "/tmp/mtc_plan_recording_test.bin";
+	recording->save(path);
+	recording = std::make_shared<PlanRecording>(PlanRecording::REPLAY);
+	recording->load(path);
+	recording->setMockTiming(false);
+	Task replay;
+	prop = make_task(replay);
+	EXPECT_TRUE(replay.plan());
+	EXPECT_EQ(replay.numSolutions(), 1u);
+	EXPECT_EQ(prop->runs_, 0u);
+	EXPECT_EQ(recording->misses(), 0u);
+	std::remove(path.c_str());
+}
+
+TEST_F(TaskTestBase, checkpointResume) {
+	t.setRobotModel(getModel());
+	add(t, new GeneratorMockup({ 1.0 }));
+	auto prop = add(t, new CountingPropagator());
+	EXPECT_THROW(t.checkpoint("/tmp/mtc_checkpoint_test.bin"), std::runtime_error);
+	t.setPlanRecording(std::make_shared<PlanRecording>(PlanRecording::RECORD));
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(prop->runs_, 1u);
+
+	const std::string path = "/tmp/mtc_checkpoint_test.bin";
+	t.checkpoint(path);
+	Task resumed;
+	resumed.setRobotModel(getModel());
+	add(resumed, new GeneratorMockup({ 1.0 }));
+	prop = add(resumed, new CountingPropagator());
+	auto extended = add(resumed, new CountingPropagator());
+	extended->setTimeout(42.0);  // different properties yield a different computation
+	resumed.resume(path);
+	EXPECT_TRUE(resumed.plan());
+	EXPECT_EQ(resumed.numSolutions(), 1u);
+	// only the computation missing in the checkpoint is performed, and recorded for the next one
+	EXPECT_EQ(prop->runs_, 0u);
+	EXPECT_EQ(extended->runs_, 1u);
+	EXPECT_EQ(resumed.planRecording()->size(), 2u);
+	std::remove(path.c_str());
+}
+
+TEST_F(TaskTestBase, concurrentPredicateFilter) {
+	t.setNumThreads(4);
+	auto filter = std::make_unique<stages::PredicateFilter>(
+	    "filter", std::make_unique<GeneratorMockup>(std::initializer_list<double>{ 3.0, 1.0, 2.0 }, 3));
+	filter->setConcurrent(true);
+	filter->setPredicate([](const SolutionBase& s, std::string& comment) {
+		comment = "checked";
+		return s.cost() < 2.5;
+	});
+	t.add(std::move(filter));
+
+	EXPECT_TRUE(t.plan());
+	std::vector<double> costs;
+	for (const auto& s : t.solutions())
+		costs.push_back(s->cost());
+	EXPECT_EQ(costs, std::vector<double>({ 1, 2 }));
+	EXPECT_EQ(t.solutions().front()->comment(), "checked");
+}
+
+TEST_F(TaskTestBase, batchPredicateFilter) {
+	size_t calls = 0;
+	auto filter = std::make_unique<stages::PredicateFilter>(
+	    "filter", std::make_unique<GeneratorMockup>(std::initializer_list<double>{ 3.0, 1.0, 2.0 }, 3));
+	filter->setBatchPredicate(
+	    [&calls](const std::vector<const SolutionBase*>& solutions, std::vector<std::string>& /*comments*/) {
+		    ++calls;
+		    std::vector<bool> result;
+		    for (const SolutionBase* s : solutions)
+			    result.push_back(s->cost() > 1.5);
+		    return result;
+	    });
+	t.add(std::move(filter));
+
+	EXPECT_TRUE(t.plan());
+	std::vector<double> costs;
+	for (const auto& s : t.solutions())
+		costs.push_back(s->cost());
+	EXPECT_EQ(costs, std::vector<double>({ 2, 3 }));
+	EXPECT_EQ(calls, 1u);  // all solutions of a compute() are judged at once
+}
+
+TEST_F(TaskTestBase, nestedWrappers) {
+	auto make_filter = [](const std::string& name, Stage::pointer&& child) {
+		auto filter = std::make_unique<stages::PredicateFilter>(name, std::move(child));
+		filter->setPredicate([name](const SolutionBase& /*s*/, std::string& comment) {
+			comment = name;
+			return true;
+		});
+		return filter;
+	};
+	t.add(make_filter("outer", make_filter("inner", std::make_unique<GeneratorMockup>())));
+
+	EXPECT_TRUE(t.plan());
+	const Stage* outer = t.findChild("outer");
+	ASSERT_EQ(outer->solutions().size(), 1u);
+	const auto* wrapped = dynamic_cast<const WrappedSolution*>(outer->solutions().front().get());
+	ASSERT_TRUE(wrapped);
+	EXPECT_TRUE(dynamic_cast<const SubTrajectory*>(wrapped->innermost()));
+
+	// wrapper infos are listed outermost first
+	moveit_task_constructor_msgs::Solution msg;
+	wrapped->toMsg(msg);
+	ASSERT_EQ(msg.sub_solution.size(), 2u);
+	EXPECT_EQ(msg.sub_solution[0].info.comment, "outer");
+	EXPECT_EQ(msg.sub_solution[1].info.comment, "inner");
+	EXPECT_EQ(msg.sub_trajectory.size(), 1u);
+}
+
+// ForwardMockup counting its batched computations
+struct BatchForwardMockup : public ForwardMockup
+{
+	std::vector<size_t> batches_;
+	void computeForwardBatch(const std::vector<const InterfaceState*>& from) override {
+		batches_.push_back(from.size());
+		ForwardMockup::computeForwardBatch(from);
+	}
+};
+
+TEST_F(TaskTestBase, batchedPropagation) {
+	add(t, new GeneratorMockup({ 3.0, 1.0, 2.0 }, 3));
+	auto fwd = add(t, new BatchForwardMockup());
+	fwd->setMaxBatchSize(2);
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(t.numSolutions(), 3u);
+	EXPECT_EQ(fwd->runs_, 3u);
+	// a pair of states is batched, the remaining one computed individually
+	EXPECT_EQ(fwd->batches_, std::vector<size_t>({ 2 }));
+
+	// INTERFACE-initialized properties prevent batching
+	t.reset();
+	fwd->batches_.clear();
+	fwd->properties().declare<double>("interface_value");
+	fwd->properties().configureInitFrom(Stage::INTERFACE, { "interface_value" });
+	EXPECT_TRUE(t.plan());
+	EXPECT_EQ(fwd->runs_, 3u);
+	EXPECT_TRUE(fwd->batches_.empty());
+}
+
+TEST_F(TaskTestBase, batchedMonitoring) {
+	// monitoring generator recording the size of received batches
+	struct BatchMonitor : MonitoringGeneratorMockup
+	{
+		std::vector<size_t> batches_;
+		using MonitoringGeneratorMockup::MonitoringGeneratorMockup;
+		void onNewSolutions(const std::vector<const SolutionBase*>& solutions) override {
+			batches_.push_back(solutions.size());
+			MonitoringGeneratorMockup::onNewSolutions(solutions);
+		}
+	};
+	auto gen = add(t, new GeneratorMockup({ 0.0, 0.0, 0.0 }, 3));
+	add(t, new ConnectMockup());
+	auto monitor = add(t, new BatchMonitor(gen));
+	monitor->setBatchedMonitoring(true);
+
+	EXPECT_TRUE(t.plan());
+	// all solutions of a single compute() of the monitored stage are handed over at once
+	EXPECT_EQ(monitor->batches_, std::vector<size_t>({ 3 }));
+	EXPECT_EQ(monitor->runs_, 3u);
+	EXPECT_EQ(t.numSolutions(), 9u);
+}
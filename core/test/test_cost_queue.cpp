@@ -123,6 +123,48 @@ TYPED_TEST(OrderedTest, sorting) {
 	this->validatePop();
 }
 
+TEST(OrderedBackends, consistency) {
+	ordered<int> linear;
+	ordered<int, ValueOrPointeeLess<int>, ordered_backend::indexed> indexed;
+	std::vector<decltype(indexed)::iterator> handles;
+	auto validate = [&] {
+		EXPECT_TRUE(std::is_sorted(indexed.begin(), indexed.end()));
+		EXPECT_THAT(indexed, ::testing::ElementsAreArray(linear));
+	};
+
+	for (int cost : { 5, 3, 8, 3, 1, 9, 5, 2 }) {
+		handles.push_back(indexed.insert(cost));
+		linear.insert(cost);
+	}
+	validate();
+
+	// update values in place and resort single items
+	for (int i : { 0, 2, 5 }) {
+		auto lit = std::find(linear.begin(), linear.end(), *handles[i]);
+		*lit = *handles[i] = 10 - *handles[i];
+		indexed.update(handles[i]);
+		linear.update(lit);
+	}
+	validate();
+
+	indexed.erase(handles[1]);
+	linear.erase(std::find(linear.begin(), linear.end(), 3));
+	EXPECT_EQ(indexed.pop(), linear.pop());
+	validate();
+
+	indexed.remove_if([](int v) { return v % 2 == 0; });
+	linear.remove_if([](int v) { return v % 2 == 0; });
+	validate();
+
+	// copies maintain their own index
+	auto copy = indexed;
+	copy.insert(4);
+	indexed.insert(4);
+	linear.insert(4);
+	validate();
+	EXPECT_THAT(copy, ::testing::ElementsAreArray(linear));
+}
+
 template <typename ValueType, typename CostType>
 std::ostream& operator<<(std::ostream& os, const cost_ordered<ValueType, CostType>& queue) {
 	for (const auto& pair : queue.sorted())
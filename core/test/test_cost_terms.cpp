@@ -1,15 +1,26 @@
 #include "models.h"
 
 #include <moveit/task_constructor/cost_terms.h>
+#include <moveit/task_constructor/batch_collision.h>
+#include <moveit/task_constructor/batch_kinematics.h>
+#include <moveit/task_constructor/solvers/joint_interpolation.h>
 #include <moveit/task_constructor/stage_p.h>
 #include <moveit/task_constructor/container_p.h>
 #include <moveit/task_constructor/stages/passthrough.h>
 
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/utils/robot_model_test_utils.h>
 
 #include <geometry_msgs/PoseStamped.h>
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
 
 #include "stage_mockups.h"
 
@@ -347,3 +358,468 @@ TEST(CostTerm, CompositeSolutionsContainerCost) {
 	    << "container cost term overwrites stage costs";
 	EXPECT_EQ(s1_ptr->solutions().front()->cost(), STAGE_COST) << "child cost is not affected";
 }
+
+TEST(CostTerm, CompositeSolutionsCacheSubCosts) {
+	Standalone<SerialContainer> container{ getModel() };
+
+	auto s1{ std::make_unique<ForwardTrajectoryMockup>() };
+	auto s2{ std::make_unique<ForwardTrajectoryMockup>(PredefinedCosts::constant(0.0), 3) };
+
+	size_t evaluations{ 0 };
+	container.setCostTerm([&evaluations](const SubTrajectory& /*s*/) {
+		++evaluations;
+		return TERM_COST;
+	});
+	container.computeWithStages({ std::move(s1), std::move(s2) });
+	ASSERT_EQ(container.solutions().size(), 3u);
+	for (const auto& solution : container.solutions())
+		EXPECT_EQ(solution->cost(), 2 * TERM_COST);
+	EXPECT_EQ(evaluations, 4u) << "shared sub solution should be evaluated only once";
+}
+
+TEST(CostTerm, CachedCostFollowsVersion) {
+	SubTrajectory solution;
+	size_t evaluations{ 0 };
+	cost::Composite term;
+	term.add(std::make_shared<LambdaCostTerm>([&evaluations](const SubTrajectory& /*s*/) {
+		++evaluations;
+		return TERM_COST;
+	}));
+
+	std::string comment;
+	EXPECT_EQ(solution.computeCachedCost(term, comment), TERM_COST);
+	EXPECT_EQ(solution.computeCachedCost(term, comment), TERM_COST);
+	EXPECT_EQ(evaluations, 1u);
+
+	term.add(std::make_shared<cost::Constant>(1.0));
+	EXPECT_EQ(solution.computeCachedCost(term, comment), TERM_COST + 1.0) << "changed terms invalidate the result";
+	EXPECT_EQ(evaluations, 2u);
+
+	auto nested = std::make_shared<cost::Constant>(2.0);
+	term.add(nested);
+	EXPECT_EQ(solution.computeCachedCost(term, comment), TERM_COST + 3.0);
+	nested->cost = 3.0;
+	nested->modified();
+	EXPECT_EQ(solution.computeCachedCost(term, comment), TERM_COST + 4.0) << "nested changes invalidate the result";
+	EXPECT_EQ(evaluations, 4u);
+
+	// a copy is a distinct term, even if allocated at the address of a destroyed one
+	cost::Composite copy(term);
+	EXPECT_NE(copy.id(), term.id());
+	EXPECT_EQ(solution.computeCachedCost(copy, comment), TERM_COST + 4.0);
+	EXPECT_EQ(evaluations, 5u);
+}
+
+TEST(CostTerm, CachedCostConcurrently) {
+	SubTrajectory solution;
+	std::atomic<size_t> evaluations{ 0 };
+	std::vector<std::shared_ptr<CostTerm>> terms;
+	for (size_t i = 0; i < 8; ++i)
+		terms.push_back(std::make_shared<LambdaCostTerm>([&evaluations, i](const SubTrajectory& /*s*/) {
+			++evaluations;
+			return static_cast<double>(i);
+		}));
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < terms.size(); ++i)
+		threads.emplace_back([&solution, &terms, i] {
+			std::string comment;
+			for (size_t j = 0; j < terms.size(); ++j)
+				EXPECT_EQ(solution.computeCachedCost(*terms[(i + j) % terms.size()], comment),
+				          static_cast<double>((i + j) % terms.size()));
+		});
+	for (std::thread& thread : threads)
+		thread.join();
+
+	// concurrent evaluations might be duplicated, but no result is lost
+	const size_t concurrent_evaluations = evaluations.load();
+	EXPECT_GE(concurrent_evaluations, terms.size());
+	std::string comment;
+	for (size_t i = 0; i < terms.size(); ++i)
+		EXPECT_EQ(solution.computeCachedCost(*terms[i], comment), static_cast<double>(i));
+	EXPECT_EQ(evaluations.load(), concurrent_evaluations);
+}
+
+TEST(CostTerm, DeferredCost) {
+	Standalone<SerialContainer> container{ getModel() };
+
+	size_t evaluations{ 0 };
+	auto exact{ std::make_shared<LambdaCostTerm>([&evaluations](const SubTrajectory& /*s*/) {
+		++evaluations;
+		return TRAJECTORY_DURATION;
+	}) };
+	auto deferred{ std::make_shared<cost::Deferred>(exact, std::make_shared<cost::Constant>(TERM_COST)) };
+
+	{
+		auto s1{ std::make_unique<ForwardTrajectoryMockup>() };
+		s1->setCostTerm(deferred);
+		auto s2{ std::make_unique<ForwardCostMockup>() };
+
+		container.computeWithStages({ std::move(s1), std::move(s2) });
+		ASSERT_EQ(container.solutions().size(), 1u);
+		EXPECT_EQ(container.solutions().front()->cost(), TRAJECTORY_DURATION + STAGE_COST)
+		    << "complete solutions use the exact cost";
+		EXPECT_EQ(evaluations, 1u);
+	}
+
+	evaluations = 0;
+	{
+		auto s1{ std::make_unique<ForwardTrajectoryMockup>() };
+		auto s1_ptr{ s1.get() };
+		s1->setCostTerm(deferred);
+		auto s2{ std::make_unique<ForwardMockup>(PredefinedCosts::constant(std::numeric_limits<double>::infinity())) };
+
+		container.computeWithStages({ std::move(s1), std::move(s2) });
+		EXPECT_TRUE(container.solutions().empty());
+		ASSERT_EQ(s1_ptr->solutions().size(), 1u);
+		EXPECT_EQ(s1_ptr->solutions().front()->cost(), TERM_COST) << "incomplete solutions keep the estimate";
+		EXPECT_EQ(evaluations, 0u);
+	}
+
+	container.setPruning(true);
+	{
+		auto infinite{ std::make_shared<LambdaCostTerm>(
+		    [](const SubTrajectory& /*s*/) { return std::numeric_limits<double>::infinity(); }) };
+		auto s1{ std::make_unique<ForwardTrajectoryMockup>() };
+		auto s1_ptr{ s1.get() };
+		s1->setCostTerm(std::make_shared<cost::Deferred>(infinite, std::make_shared<cost::Constant>(TERM_COST)));
+		auto s2{ std::make_unique<ForwardCostMockup>() };
+
+		container.computeWithStages({ std::move(s1), std::move(s2) });
+		EXPECT_TRUE(container.solutions().empty());
+		EXPECT_TRUE(s1_ptr->solutions().empty()) << "an infinite exact cost turns the solution into a failure";
+		ASSERT_EQ(s1_ptr->failures().size(), 1u);
+		EXPECT_TRUE(s1_ptr->failures().front()->isFailure());
+		EXPECT_FALSE(s1_ptr->failures().front()->end()->priority().enabled()) << "its end state is pruned";
+	}
+}
+
+TEST(CostTerm, WaypointCostTerm) {
+	Standalone<SerialContainer> container{ getModel() };
+
+	size_t evaluations{ 0 };
+	auto stage{ std::make_unique<ForwardTrajectoryMockup>() };
+	stage->setCostTerm(std::make_shared<WaypointCostTerm>(
+	    [&evaluations](const WaypointCostTerm::Matrix& positions, const Eigen::VectorXd& times, std::string& comment) {
+		    ++evaluations;
+		    EXPECT_EQ(positions.rows(), 2);
+		    EXPECT_EQ(positions.cols(), static_cast<Eigen::Index>(getModel()->getVariableCount()));
+		    EXPECT_EQ(times.size(), 2);
+		    comment = "waypoints";
+		    return times[times.size() - 1];
+	    }));
+
+	container.computeWithStages({ std::move(stage) });
+	ASSERT_EQ(container.solutions().size(), 1u);
+	EXPECT_EQ(container.solutions().front()->cost(), TRAJECTORY_DURATION);
+	EXPECT_EQ(evaluations, 1u) << "single call per trajectory";
+}
+
+TEST(SubTrajectory, waypoints) {
+	auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(getModel(), "group");
+	moveit::core::RobotState state(getModel());
+	for (size_t i = 0; i < 3; ++i) {
+		state.setToRandomPositions();
+		trajectory->addSuffixWayPoint(state, 0.5);
+	}
+	SubTrajectory solution(trajectory);
+
+	const auto waypoints = solution.waypoints();
+	ASSERT_TRUE(waypoints);
+	EXPECT_EQ(waypoints->group, trajectory->getGroup());
+	ASSERT_EQ(waypoints->positions.rows(), 3);
+	ASSERT_EQ(waypoints->positions.cols(), static_cast<Eigen::Index>(trajectory->getGroup()->getVariableCount()));
+	std::vector<double> expected;
+	trajectory->getWayPoint(2).copyJointGroupPositions(trajectory->getGroup(), expected);
+	for (size_t j = 0; j < expected.size(); ++j)
+		EXPECT_EQ(waypoints->positions(2, j), expected[j]);
+	EXPECT_DOUBLE_EQ(waypoints->times[2], 1.5);
+	EXPECT_EQ(solution.waypoints(), waypoints) << "view is cached";
+
+	solution.setTrajectory(nullptr);
+	EXPECT_FALSE(solution.waypoints());
+}
+
+TEST(CostTerm, Composite) {
+	auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(getModel(), "group");
+	moveit::core::RobotState state(getModel());
+	for (size_t i = 0; i < 5; ++i) {
+		state.setToRandomPositions();
+		state.update();
+		trajectory->addSuffixWayPoint(state, 0.5);
+	}
+	const SubTrajectory solution(trajectory);
+
+	auto path_length = std::make_shared<cost::PathLength>();
+	auto link_motion = std::make_shared<cost::LinkMotion>("tip");
+	auto duration = std::make_shared<cost::TrajectoryDuration>();
+	std::string comment;
+	const double expected = (*path_length)(solution, comment) + 2.0 * (*link_motion)(solution, comment) +
+	                        0.5 * (*duration)(solution, comment);
+
+	cost::Composite composite;
+	composite.add(path_length).add(link_motion, 2.0).add(duration, 0.5);
+	EXPECT_NEAR(composite(solution, comment), expected, 1e-10);
+
+	composite.add(std::make_shared<cost::LinkMotion>("unknown"));
+	comment.clear();
+	EXPECT_EQ(composite(solution, comment), std::numeric_limits<double>::infinity());
+	EXPECT_EQ(comment, "LinkMotionCost: frame 'unknown' unknown in trajectory");
+}
+
+TEST(CostTerm, TrajectoryTermsMatchWaypointwiseEvaluation) {
+	auto model = getModel();
+	auto scene = std::make_shared<PlanningScene>(model);
+	scene->getCurrentStateNonConst().setToDefaultValues();
+	const InterfaceState start(scene);
+
+	auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(model, "group");
+	moveit::core::RobotState state(model);
+	for (size_t i = 0; i < 6; ++i) {
+		state.setToRandomPositions();
+		state.update();
+		trajectory->addSuffixWayPoint(state, 0.5);
+	}
+	SubTrajectory solution(trajectory);
+	solution.setStartState(start);
+	std::string comment;
+
+	// Cartesian path length of the tip frame
+	double motion = 0.0;
+	for (size_t i = 1; i < trajectory->getWayPointCount(); ++i) {
+		const Eigen::Vector3d& from = trajectory->getWayPoint(i - 1).getFrameTransform("tip").translation();
+		motion += (trajectory->getWayPoint(i).getFrameTransform("tip").translation() - from).norm();
+	}
+	EXPECT_NEAR(cost::LinkMotion("tip")(solution, comment), motion, 1e-10);
+
+	// average distance of all waypoints to the reference, w.r.t. all joints or weighted ones
+	const auto& joints = model->getActiveJointModels();
+	ASSERT_GE(joints.size(), 2u);
+	const std::map<std::string, double> reference{ { joints[0]->getName(), 3.0 }, { joints[1]->getName(), -2.0 } };
+	moveit::core::RobotState ref_state(scene->getCurrentState());
+	for (const auto& item : reference)
+		ref_state.setVariablePosition(item.first, item.second);
+
+	double distance = 0.0;
+	double weighted = 0.0;
+	for (size_t i = 0; i < trajectory->getWayPointCount(); ++i) {
+		distance += ref_state.distance(trajectory->getWayPoint(i));
+		weighted += 0.5 * ref_state.distance(trajectory->getWayPoint(i), joints[1]);
+	}
+	const double num_waypoints = trajectory->getWayPointCount();
+	EXPECT_NEAR(cost::DistanceToReference(reference)(solution, comment), distance / num_waypoints, 1e-10);
+	EXPECT_NEAR(cost::DistanceToReference(reference, cost::DistanceToReference::Mode::AUTO,
+	                                      { { joints[1]->getName(), 0.5 } })(solution, comment),
+	            weighted / num_waypoints, 1e-10);
+}
+
+struct CountingCollisionChecker : public ThreadedCollisionChecker
+{
+	mutable size_t calls{ 0 };
+	mutable size_t states{ 0 };
+
+	using ThreadedCollisionChecker::ThreadedCollisionChecker;
+	std::vector<bool> checkCollision(const planning_scene::PlanningScene& scene, const States& batch,
+	                                 const std::string& group, ThreadPool* pool) const override {
+		++calls;
+		states += batch.size();
+		return ThreadedCollisionChecker::checkCollision(scene, batch, group, pool);
+	}
+};
+
+TEST(BatchCollisionChecker, jointInterpolation) {
+	auto checker = std::make_shared<CountingCollisionChecker>(2);
+	BatchCollisionChecker::setActive(checker);
+
+	auto from = std::make_shared<PlanningScene>(getModel());
+	from->getCurrentStateNonConst().setToDefaultValues();
+	auto to = from->diff();
+	to->getCurrentStateNonConst().setVariablePosition(0, 1.0);
+	to->getCurrentStateNonConst().update();
+
+	solvers::JointInterpolationPlanner planner;
+	planner.setProperty("collision_batch_size", 4u);
+	for (bool bisection : { false, true }) {
+		planner.setProperty("bisection", bisection);
+		checker->calls = checker->states = 0;
+		robot_trajectory::RobotTrajectoryPtr result;
+		EXPECT_TRUE(planner.plan(from, to, getModel()->getJointModelGroup("group"), 1.0, result));
+		ASSERT_TRUE(result);
+
+		// all waypoints but the start state are checked in batches of 4
+		const size_t checked = result->getWayPointCount() - 1;
+		EXPECT_EQ(checker->states, checked);
+		EXPECT_EQ(checker->calls, (checked + 3) / 4);
+	}
+	BatchCollisionChecker::setActive(nullptr);
+	EXPECT_NE(BatchCollisionChecker::active(), checker);
+}
+
+// fake backend reporting a scripted distance per waypoint, identified by its first variable (0.1 * index)
+struct ScriptedDistanceChecker : public ThreadedCollisionChecker
+{
+	std::vector<double> distances;
+	mutable std::vector<size_t> checked;  // indices of checked waypoints
+
+	std::vector<collision_detection::DistanceResult> distance(const planning_scene::PlanningScene& /*scene*/,
+	                                                          const States& batch,
+	                                                          const collision_detection::DistanceRequest& /*request*/,
+	                                                          bool /*with_world*/, ThreadPool* /*pool*/) const override {
+		std::vector<collision_detection::DistanceResult> results(batch.size());
+		for (size_t k = 0; k < batch.size(); ++k) {
+			const size_t index = std::lround(batch[k]->getVariablePosition(0) * 10);
+			checked.push_back(index);
+			results[k].minimum_distance.distance = distances.at(index);
+		}
+		return results;
+	}
+};
+
+struct ForwardWaypointsMockup : public ForwardMockup
+{
+	size_t num_waypoints;
+
+	ForwardWaypointsMockup(size_t num_waypoints) : num_waypoints{ num_waypoints } {
+		properties().declare<std::string>("group", "group");
+	}
+
+	void computeForward(const InterfaceState& from) override {
+		auto traj{ std::make_shared<robot_trajectory::RobotTrajectory>(from.scene()->getRobotModel(), nullptr) };
+		moveit::core::RobotState state(from.scene()->getCurrentState());
+		for (size_t i = 0; i < num_waypoints; ++i) {
+			state.setVariablePosition(0, 0.1 * i);
+			state.update();
+			traj->addSuffixWayPoint(state, 0.1);
+		}
+		SubTrajectory solution;
+		solution.setTrajectory(traj);
+		sendForward(from, InterfaceState(from), std::move(solution));
+	}
+};
+
+TEST(CostTerm, ClearanceWaypointStride) {
+	// minimum distance at waypoint 7, which is not a multiple of the stride
+	auto checker = std::make_shared<ScriptedDistanceChecker>();
+	for (int i = 0; i < 10; ++i)
+		checker->distances.push_back(std::abs(i - 7) + 1.0);
+	BatchCollisionChecker::setActive(checker);
+
+	auto clearance{ std::make_shared<cost::Clearance>() };
+	clearance->distance_to_cost = [](double distance) { return distance; };
+	Standalone<SerialContainer> container{ getModel() };
+
+	// all waypoints are checked by default
+	container.computeWithStageCost({ std::make_unique<ForwardWaypointsMockup>(10) }, clearance);
+	ASSERT_EQ(container.solutions().size(), 1u);
+	EXPECT_DOUBLE_EQ(container.solutions().front()->cost(), 41.0 / 10);
+	std::sort(checker->checked.begin(), checker->checked.end());
+	EXPECT_EQ(checker->checked, std::vector<size_t>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+	// every 4th waypoint and the last one, then the neighborhood of the sampled minimum (8)
+	checker->checked.clear();
+	clearance->waypoint_stride = 4;
+	container.computeWithStageCost({ std::make_unique<ForwardWaypointsMockup>(10) }, clearance);
+	ASSERT_EQ(container.solutions().size(), 1u);
+	EXPECT_DOUBLE_EQ(container.solutions().front()->cost(), 23.0 / 7) << "average over checked waypoints";
+	std::sort(checker->checked.begin(), checker->checked.end());
+	EXPECT_EQ(checker->checked, std::vector<size_t>({ 0, 4, 5, 6, 7, 8, 9 })) << "each waypoint is checked once";
+
+	BatchCollisionChecker::setActive(nullptr);
+}
+
+// flags states whose first variable is close to the obstacle as colliding, counting the checked states
+struct ObstacleCollisionChecker : public ThreadedCollisionChecker
+{
+	double obstacle;
+	mutable size_t states{ 0 };
+
+	explicit ObstacleCollisionChecker(double obstacle) : obstacle{ obstacle } {}
+	std::vector<bool> checkCollision(const planning_scene::PlanningScene& /*scene*/, const States& batch,
+	                                 const std::string& /*group*/, ThreadPool* /*pool*/) const override {
+		states += batch.size();
+		std::vector<bool> colliding;
+		for (const moveit::core::RobotState* state : batch)
+			colliding.push_back(std::abs(state->getVariablePosition(0) - obstacle) < 0.01);
+		return colliding;
+	}
+};
+
+TEST(JointInterpolationPlanner, bisectionDetectsCollisionEarly) {
+	auto checker = std::make_shared<ObstacleCollisionChecker>(0.5);
+	BatchCollisionChecker::setActive(checker);
+
+	auto from = std::make_shared<PlanningScene>(getModel());
+	from->getCurrentStateNonConst().setToDefaultValues();
+	from->getCurrentStateNonConst().setVariablePosition(0, 0.0);
+	from->getCurrentStateNonConst().update();
+	auto to = from->diff();
+	to->getCurrentStateNonConst().setVariablePosition(0, 1.0);
+	to->getCurrentStateNonConst().update();
+
+	// waypoints at 0.125, 0.25, ..., 1.0 with the obstacle at the midpoint
+	solvers::JointInterpolationPlanner planner;
+	planner.setProperty("max_step", 0.125);
+	planner.setProperty("collision_batch_size", 1u);
+	for (bool bisection : { false, true }) {
+		planner.setProperty("bisection", bisection);
+		checker->states = 0;
+		robot_trajectory::RobotTrajectoryPtr result;
+		const auto r = planner.plan(from, to, getModel()->getJointModelGroup("group"), 1.0, result);
+		EXPECT_FALSE(r.success);
+		EXPECT_EQ(r.message, "Waypoint is in collision!");
+		// sequential checks walk up to the obstacle, bisection checks goal and midpoint only
+		EXPECT_EQ(checker->states, bisection ? 2u : 4u) << "bisection: " << bisection;
+		// either way, the trajectory ends at the colliding waypoint
+		ASSERT_TRUE(result);
+		EXPECT_EQ(result->getWayPointCount(), 5u) << "bisection: " << bisection;
+		EXPECT_DOUBLE_EQ(result->getLastWayPoint().getVariablePosition(0), 0.5);
+	}
+	BatchCollisionChecker::setActive(nullptr);
+}
+
+TEST(BatchForwardKinematics, matchesRobotState) {
+	auto origin = [](double x, double y, double z, double qx) {
+		geometry_msgs::Pose pose;
+		pose.position.x = x;
+		pose.position.y = y;
+		pose.position.z = z;
+		pose.orientation.x = qx;
+		pose.orientation.w = std::sqrt(1.0 - qx * qx);
+		return pose;
+	};
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->a", "revolute", { origin(0.1, 0.0, 0.2, 0.3) });
+	builder.addChain("a->b", "prismatic", { origin(0.0, 0.3, 0.0, 0.5) }, urdf::Vector3(0.0, 1.0, 0.0));
+	builder.addChain("b->c", "continuous", { origin(0.2, 0.0, 0.1, -0.4) }, urdf::Vector3(0.0, 0.0, 1.0));
+	builder.addChain("c->tip", "fixed", { origin(0.0, 0.0, 0.3, 0.2) });
+	builder.addGroupChain("a", "tip", "group");
+	auto model = builder.build();
+	const auto* group = model->getJointModelGroup("group");
+	const auto* tip = model->getLinkModel("tip");
+
+	moveit::core::RobotState reference(model);
+	reference.setToRandomPositions();
+	reference.update();
+
+	std::vector<moveit::core::RobotState> states(5, reference);
+	std::vector<const moveit::core::RobotState*> pointers;
+	for (auto& state : states) {
+		state.setToRandomPositions(group);
+		state.update();
+		pointers.push_back(&state);
+	}
+
+	const moveit::core::JointModelGroup* all_variables = nullptr;
+	for (const moveit::core::JointModelGroup* g : { group, all_variables }) {
+		BatchForwardKinematics fk(*model, tip, g);
+		BatchForwardKinematics::Transforms transforms;
+		fk.compute(reference, fk.positions(pointers), transforms);
+		ASSERT_EQ(transforms.size(), static_cast<Eigen::Index>(states.size()));
+		for (size_t i = 0; i < states.size(); ++i)
+			EXPECT_TRUE(transforms[i].isApprox(states[i].getGlobalLinkTransform(tip), 1e-10)) << i;
+
+		const Eigen::Vector3d point(0.1, -0.2, 0.3);
+		const Eigen::Matrix3Xd points = transforms.transformPoint(point);
+		EXPECT_TRUE(points.col(0).isApprox(states[0].getGlobalLinkTransform(tip) * point, 1e-10));
+	}
+}
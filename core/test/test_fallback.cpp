@@ -82,6 +82,38 @@ TEST_F(FallbacksFixturePropagate, computeFirstSuccessfulStagePerSolutionOnly) {
 	EXPECT_COSTS(t.solutions(), testing::ElementsAre(113, 124, 212, 221));
 }
 
+TEST_F(FallbacksFixturePropagate, speculativeReleaseOnFailure) {
+	t.setNumThreads(2);
+	t.add(std::make_unique<GeneratorMockup>(PredefinedCosts::single(0.0)));
+
+	auto fallbacks = std::make_unique<Fallbacks>("Fallbacks");
+	fallbacks->setSpeculation(1);
+	fallbacks->add(std::make_unique<ForwardMockup>(PredefinedCosts::constant(INF)));
+	auto second = add(*fallbacks, new ForwardMockup(PredefinedCosts::constant(1.0)));
+	t.add(std::move(fallbacks));
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_COSTS(t.solutions(), testing::ElementsAre(1.0));
+	EXPECT_EQ(second->runs_, 1u);
+}
+
+TEST_F(FallbacksFixturePropagate, speculativeDiscardOnSuccess) {
+	t.setNumThreads(2);
+	t.add(std::make_unique<GeneratorMockup>(PredefinedCosts::single(0.0)));
+
+	auto fallbacks = std::make_unique<Fallbacks>("Fallbacks");
+	fallbacks->setSpeculation(1);
+	auto first = add(*fallbacks, new ForwardMockup(PredefinedCosts::constant(1.0)));
+	auto second = add(*fallbacks, new ForwardMockup(PredefinedCosts::constant(2.0)));
+	t.add(std::move(fallbacks));
+
+	EXPECT_TRUE(t.plan());
+	// the speculatively computed solution of the second child is discarded
+	EXPECT_COSTS(t.solutions(), testing::ElementsAre(1.0));
+	EXPECT_EQ(first->runs_, 1u);
+	EXPECT_EQ(second->runs_, 1u);
+}
+
 // requires individual job control in Fallbacks's children
 TEST_F(FallbacksFixturePropagate, DISABLED_updateSolutionOrder) {
 	t.add(std::make_unique<BackwardMockup>(PredefinedCosts({ 10.0, 0.0 })));
@@ -195,3 +227,36 @@ TEST_F(FallbacksFixtureConnect, connectStageInsideFallbacks) {
 	EXPECT_TRUE(t.plan());
 	EXPECT_COSTS(t.solutions(), testing::ElementsAre(11, 12, 22, 121));
 }
+
+TEST_F(FallbacksFixtureConnect, parkPendingPairsOfDisabledStates) {
+	using Prio = InterfaceState::Priority;
+	add(t, new GeneratorMockup());
+	auto connect = new ConnectMockup();
+	add(t, connect);
+	add(t, new GeneratorMockup());
+	t.init();
+	auto impl = connect->pimpl();
+
+	// explicitly listed pairs, as passed on by Fallbacks, refer to states of another interface
+	auto ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	InterfaceState start(ps), end(ps), pruned(ps, Prio(0, 0.0, InterfaceState::Status::PRUNED));
+	Interface starts, ends;
+	starts.add(start);
+	starts.add(pruned);
+	ends.add(end);
+
+	// pairs of disabled states are parked right away
+	impl->addPendingPair(ConnectingPrivate::StatePair(std::next(starts.begin()), ends.begin()));
+	EXPECT_FALSE(impl->canCompute());
+	impl->addPendingPair(ConnectingPrivate::StatePair(starts.begin(), ends.begin()));
+	EXPECT_TRUE(impl->canCompute());
+
+	starts.updatePriority(&start, Prio(0, 0.0, InterfaceState::Status::ARMED));
+	impl->updatePendingPairs();
+	EXPECT_FALSE(impl->canCompute());
+
+	// parked pairs are restored once their states are enabled again
+	starts.updatePriority(&pruned, Prio(0, 0.0));
+	impl->updatePendingPairs();
+	EXPECT_TRUE(impl->canCompute());
+}
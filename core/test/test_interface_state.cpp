@@ -37,6 +37,17 @@ TEST(InterfaceStatePriority, compare) {
 	EXPECT_TRUE(Prio(0, 10) >= Prio(0, 0));
 }
 
+TEST(InterfaceStatePriority, estimate) {
+	using Status = InterfaceState::Status;
+	// at same depth, order by cost + estimate
+	EXPECT_TRUE(Prio(0, 2, Status::ENABLED, 0) < Prio(0, 1, Status::ENABLED, 5));
+	EXPECT_TRUE(Prio(0, 1, Status::ENABLED, 1) < Prio(0, 2, Status::ENABLED, 0));  // ties resolved by cost
+	EXPECT_TRUE(Prio(1, 10, Status::ENABLED, 10) < Prio(0, 0));  // depth still dominates
+
+	EXPECT_EQ((Prio(1, 1, Status::ENABLED, 2) + Prio(1, 1, Status::ENABLED, 3)).estimate(), 5.0);
+	EXPECT_EQ(Prio(Prio(1, 1, Status::ENABLED, 2), Status::ARMED).estimate(), 2.0);
+}
+
 using Prio = InterfaceState::Priority;
 
 // Interface that also stores passed states
@@ -72,6 +83,199 @@ TEST(Interface, update) {
 	EXPECT_THAT(i.depths(), ::testing::ElementsAreArray({ 3, 6 }));
 }
 
+TEST(Interface, updateAfterReadd) {
+	auto ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	StoringInterface i;
+	i.add(InterfaceState(ps, Prio(1, 0.0)));
+	i.add(InterfaceState(ps, Prio(3, 0.0)));
+
+	// removing and re-adding a state needs to update its position handle
+	InterfaceState* state = *i.begin();
+	auto removed = i.remove(i.begin());
+	EXPECT_EQ(state->owner(), nullptr);
+	i.add(*state);
+	EXPECT_EQ(state->owner(), &i);
+	EXPECT_THAT(i.depths(), ::testing::ElementsAreArray({ 3, 1 }));
+
+	state->updatePriority(Prio(0, 0.0));
+	EXPECT_THAT(i.depths(), ::testing::ElementsAreArray({ 1, 0 }));
+}
+
+TEST(Interface, costToGo) {
+	auto ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	StoringInterface i;
+	// estimate stored as property of the state
+	i.setCostToGo(
+	    [](const InterfaceState& s, Interface::Direction dir) {
+		    EXPECT_EQ(dir, Interface::BACKWARD);
+		    return s.properties().get<double>("estimate");
+	    },
+	    Interface::BACKWARD);
+	for (double estimate : { 1.0, 5.0, 0.0 }) {
+		InterfaceState state(ps, Prio(1, 1.0));
+		state.properties().set("estimate", estimate);
+		i.add(std::move(state));
+	}
+	auto estimates = [&i] {
+		std::vector<double> result;
+		for (const InterfaceState* s : i)
+			result.push_back(s->priority().estimate());
+		return result;
+	};
+	EXPECT_THAT(estimates(), ::testing::ElementsAreArray({ 0.0, 1.0, 5.0 }));
+
+	// estimates are kept across priority updates
+	i.updatePriority(*i.begin(), Prio(1, 10.0));
+	EXPECT_THAT(estimates(), ::testing::ElementsAreArray({ 1.0, 5.0, 0.0 }));
+}
+
+TEST(Interface, inbox) {
+	auto ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	size_t notified = 0;
+	StoringInterface i([&notified](Interface::iterator, Interface::UpdateFlags) { ++notified; });
+	i.setInboxEnabled(true);
+	i.add(InterfaceState(ps, Prio(1, 0.0)));
+	i.add(InterfaceState(ps, Prio(3, 0.0)));
+	EXPECT_TRUE(i.empty());
+	EXPECT_FALSE(i.inboxEmpty());
+	EXPECT_EQ(notified, 0u);
+
+	EXPECT_EQ(i.drain(), 2u);
+	EXPECT_TRUE(i.inboxEmpty());
+	EXPECT_EQ(notified, 2u);
+	EXPECT_THAT(i.depths(), ::testing::ElementsAreArray({ 3, 1 }));
+	EXPECT_EQ(i.drain(), 0u);
+}
+
+TEST(Interface, coalescedUpdates) {
+	auto ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	size_t notified = 0;
+	StoringInterface i([&notified](Interface::iterator, Interface::UpdateFlags) { ++notified; });
+	i.add(InterfaceState(ps, Prio(1, 0.0)));
+	i.add(InterfaceState(ps, Prio(3, 0.0)));
+	notified = 0;
+	InterfaceState* state = *i.rbegin();
+
+	{
+		PriorityUpdateScope outer(nullptr);
+		{
+			PriorityUpdateScope inner(nullptr);
+			for (double cost : { 3.0, 2.0, 1.0 })
+				PriorityUpdateScope::update(*state, Prio(5, cost));
+		}
+		// updates are deferred until the outermost scope ends
+		EXPECT_EQ(notified, 0u);
+		EXPECT_THAT(i.depths(), ::testing::ElementsAreArray({ 3, 1 }));
+		EXPECT_EQ(PriorityUpdateScope::priority(*state), Prio(5, 1.0));
+
+		// status changes are not deferred and kept by the deferred update
+		state->updateStatus(InterfaceState::Status::ARMED);
+		EXPECT_EQ(notified, 1u);
+	}
+	EXPECT_EQ(notified, 2u);
+	EXPECT_EQ(state->priority(), Prio(5, 1.0, InterfaceState::Status::ARMED));
+	EXPECT_EQ(PriorityUpdateScope::priority(*state), state->priority());
+
+	// without a scope, updates are applied immediately
+	PriorityUpdateScope::update(*state, Prio(6, 0.0));
+	EXPECT_EQ(notified, 3u);
+	EXPECT_EQ(state->priority().depth(), 6u);
+}
+
+TEST(Interface, unsorted) {
+	auto ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	std::vector<std::unique_ptr<InterfaceState>> storage;
+	UnsortedInterface i;
+	for (unsigned int depth : { 1, 3, 2 }) {
+		storage.emplace_back(std::make_unique<InterfaceState>(ps, Prio(depth, 0.0)));
+		i.add(*storage.back());
+	}
+	auto depths = [&i] {
+		std::vector<unsigned int> result;
+		for (const InterfaceState* s : i)
+			result.push_back(s->priority().depth());
+		return result;
+	};
+	EXPECT_FALSE(i.sorted());
+	EXPECT_THAT(depths(), ::testing::ElementsAreArray({ 1, 3, 2 }));
+
+	// priority updates keep the position
+	storage[0]->updatePriority(Prio(5, 0.0));
+	EXPECT_THAT(depths(), ::testing::ElementsAreArray({ 5, 3, 2 }));
+
+	auto removed = i.remove(std::next(i.begin()));
+	EXPECT_EQ(storage[1]->owner(), nullptr);
+	EXPECT_THAT(depths(), ::testing::ElementsAreArray({ 5, 2 }));
+}
+
+TEST(Interface, beam) {
+	auto ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	StoringInterface i;
+	i.setBeamWidth(2);
+	for (double cost : { 3.0, 1.0, 4.0, 2.0 })
+		i.add(InterfaceState(ps, Prio(1, cost)));
+	auto enabled = [&i] {
+		std::vector<double> result;
+		for (const InterfaceState* s : i)
+			if (s->priority().enabled())
+				result.push_back(s->priority().cost());
+		return result;
+	};
+	EXPECT_THAT(enabled(), ::testing::ElementsAreArray({ 1.0, 2.0 }));
+	EXPECT_TRUE(i.back()->beamParked());
+
+	// a fetched state keeps its slot until it turns out to be a dead end
+	auto fetched = i.remove(i.begin());
+	EXPECT_THAT(enabled(), ::testing::ElementsAreArray({ 2.0 }));
+	i.releaseBeamSlot();
+	EXPECT_THAT(enabled(), ::testing::ElementsAreArray({ 2.0, 3.0 }));
+
+	// disabling a state re-enables the best parked one
+	i.updatePriority(*i.begin(), Prio(1, 2.0, InterfaceState::Status::PRUNED));
+	EXPECT_THAT(enabled(), ::testing::ElementsAreArray({ 3.0, 4.0 }));
+	EXPECT_EQ(i.widenBeam(), 0u);
+}
+
+TEST(InterfaceState, boundSceneDiffDepth) {
+	planning_scene::PlanningSceneConstPtr ps = std::make_shared<planning_scene::PlanningScene>(getModel());
+	for (int i = 0; i < 5; ++i)
+		ps = ps->diff();
+
+	InterfaceState state(ps);
+	EXPECT_EQ(state.sceneDiffDepth(), 5u);
+	EXPECT_FALSE(state.boundSceneDiffDepth(0));  // unbounded
+	EXPECT_FALSE(state.boundSceneDiffDepth(5));
+	EXPECT_EQ(state.scene(), ps);
+
+	EXPECT_TRUE(state.boundSceneDiffDepth(4));
+	EXPECT_EQ(state.sceneDiffDepth(), 0u);
+	EXPECT_NE(state.scene(), ps);
+}
+
+TEST(InterfaceState, sceneMsg) {
+	auto base = std::make_shared<planning_scene::PlanningScene>(getModel());
+	InterfaceState state(base->diff());
+
+	// messages are converted once and shared afterwards
+	auto full = state.sceneMsg();
+	ASSERT_TRUE(full);
+	EXPECT_EQ(state.sceneMsg(), full);
+	EXPECT_FALSE(full->is_diff);
+	auto diff = state.sceneMsg(true);
+	ASSERT_TRUE(diff);
+	EXPECT_EQ(state.sceneMsg(true), diff);
+	EXPECT_TRUE(diff->is_diff);
+
+	// a replaced scene is converted again
+	InterfaceState deep(base->diff()->diff());
+	auto before = deep.sceneMsg();
+	EXPECT_TRUE(deep.boundSceneDiffDepth(1));
+	EXPECT_NE(deep.sceneMsg(), before);
+
+	deep.evictScene();
+	EXPECT_FALSE(deep.sceneMsg());
+}
+
 using PrioPair = std::pair<Prio, Prio>;
 inline bool operator<(const PrioPair& lhs, const PrioPair& rhs) {
 	return ConnectingPrivate::StatePair::less(lhs.first, lhs.second, rhs.first, rhs.second);
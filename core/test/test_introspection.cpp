@@ -0,0 +1,79 @@
+#include "stage_mockups.h"
+
+#include <moveit/task_constructor/introspection.h>
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace moveit::task_constructor;
+
+struct AsyncIntrospection : public TaskTestBase
+{
+	ros::Subscriber sub;
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<moveit_task_constructor_msgs::SolutionConstPtr> received;
+
+	void subscribe() {
+		ros::NodeHandle nh("~");
+		sub = nh.subscribe(SOLUTION_TOPIC, 10, &AsyncIntrospection::onSolution, this);
+		// wait for the connection to the (latched) publisher
+		for (int i = 0; i < 100 && sub.getNumPublishers() == 0; ++i)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	void onSolution(const moveit_task_constructor_msgs::SolutionConstPtr& msg) {
+		std::lock_guard<std::mutex> lock(mutex);
+		received.push_back(msg);
+		cv.notify_all();
+	}
+
+	moveit_task_constructor_msgs::SolutionConstPtr waitForSolution(std::size_t count) {
+		std::unique_lock<std::mutex> lock(mutex);
+		cv.wait_for(lock, std::chrono::seconds(5), [this, count] { return received.size() >= count; });
+		return received.size() >= count ? received[count - 1] : nullptr;
+	}
+};
+
+// solution msgs are snapshots taken when publishing, even if planning modifies the solution meanwhile
+TEST_F(AsyncIntrospection, publishesSnapshotOfSolution) {
+	add(t, new GeneratorMockup(PredefinedCosts({ 1.0, 2.0, 3.0 })));
+	add(t, new ForwardMockup());
+	EXPECT_TRUE(t.plan());
+	ASSERT_EQ(t.solutions().size(), 3u);
+
+	t.introspection().enableAsyncPublishing();
+	ASSERT_TRUE(t.introspection().asyncPublishingEnabled());
+	t.introspection().publishTaskDescription();  // advertises topics
+	subscribe();
+
+	std::size_t count = 0;
+	for (const SolutionBaseConstPtr& solution : t.solutions()) {
+		const double cost = solution->cost();
+		t.introspection().publishSolution(*solution);
+		// emulate the planning thread invalidating the solution, like Task::replan() does
+		const_cast<SolutionBase&>(*solution).markAsFailure("invalidated");
+
+		auto msg = waitForSolution(++count);
+		ASSERT_TRUE(msg);
+		ASSERT_FALSE(msg->sub_solution.empty());
+		EXPECT_EQ(msg->sub_solution.front().info.cost, static_cast<float>(cost));
+		EXPECT_EQ(msg->sub_solution.front().info.comment, "");
+	}
+	t.introspection().enableAsyncPublishing(false);
+	EXPECT_FALSE(t.introspection().asyncPublishingEnabled());
+}
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	ros::init(argc, argv, "introspection_test");
+	ros::AsyncSpinner spinner(1);
+	spinner.start();
+
+	return RUN_ALL_TESTS();
+}
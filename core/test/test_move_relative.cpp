@@ -6,6 +6,7 @@
 #include <moveit/task_constructor/solvers/cartesian_path.h>
 #include <moveit/task_constructor/solvers/pipeline_planner.h>
 
+#include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
@@ -14,6 +15,10 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #ifndef TYPED_TEST_SUITE  // for Melodic
 #define TYPED_TEST_SUITE(SUITE, TYPES) TYPED_TEST_CASE(SUITE, TYPES)
 #endif
@@ -163,6 +168,58 @@ TEST_F(PandaMoveRelativeCartesian, cartesianRotateAttachedIKFrame) {
 	EXPECT_CONST_POSITION(move->solutions().front(), attached_object);
 }
 
+TEST_F(PandaMoveRelativeCartesian, jacobianFastPath) {
+	const std::string tip = "panda_hand";
+	move->setIKFrame(tip);
+	geometry_msgs::Vector3Stamped v;
+	v.header.frame_id = tip;
+	v.vector.z = 0.02;
+	move->setDirection(v);
+	move->setFastPathDistance(0.05);
+
+	ASSERT_TRUE(t.plan()) << "Failed to plan";
+	const auto& trajectory = *std::dynamic_pointer_cast<const SubTrajectory>(move->solutions().front())->trajectory();
+	// Jacobian integration uses 5mm steps, CartesianPath 1cm steps
+	EXPECT_EQ(trajectory.getWayPointCount(), 5u);
+	const Eigen::Isometry3d& start = trajectory.getFirstWayPoint().getFrameTransform(tip);
+	const Eigen::Isometry3d& end = trajectory.getLastWayPoint().getFrameTransform(tip);
+	EXPECT_NEAR(((start.inverse() * end).translation() - Eigen::Vector3d(0, 0, 0.02)).norm(), 0.0, 1e-3);
+	EXPECT_TRUE(scene->isPathValid(trajectory, group->getName(), false));
+}
+
+TEST_F(PandaMoveRelativeCartesian, adaptiveStepSize) {
+	const std::string tip = "panda_hand";
+	move->setIKFrame(tip);
+	geometry_msgs::Vector3Stamped v;
+	v.header.frame_id = tip;
+	v.vector.z = 0.2;
+	move->setDirection(v);
+
+	auto waypoints = [this] {
+		return std::dynamic_pointer_cast<const SubTrajectory>(move->solutions().front())->trajectory();
+	};
+	ASSERT_TRUE(t.plan()) << "Failed to plan with fixed steps";
+	const size_t fixed_count = waypoints()->getWayPointCount();
+
+	t.reset();
+	planner->setMaxStepSize(0.08);
+	ASSERT_TRUE(t.plan()) << "Failed to plan with adaptive steps";
+	const auto& trajectory = *waypoints();
+	EXPECT_LT(trajectory.getWayPointCount(), fixed_count) << "well-conditioned segments allow for larger steps";
+
+	// all waypoints are on the straight line, at most max_step_size apart
+	const Eigen::Isometry3d start_inv = trajectory.getFirstWayPoint().getFrameTransform(tip).inverse();
+	Eigen::Vector3d previous = Eigen::Vector3d::Zero();
+	for (size_t i = 1; i < trajectory.getWayPointCount(); ++i) {
+		const Eigen::Vector3d position = (start_inv * trajectory.getWayPoint(i).getFrameTransform(tip)).translation();
+		EXPECT_NEAR(position.head<2>().norm(), 0.0, 1e-3) << i;
+		EXPECT_LE((position - previous).norm(), 0.08 + 1e-3) << i;
+		previous = position;
+	}
+	EXPECT_NEAR((previous - Eigen::Vector3d(0, 0, 0.2)).norm(), 0.0, 1e-3);
+	EXPECT_TRUE(scene->isPathValid(trajectory, group->getName(), false));
+}
+
 using PlannerTypes = ::testing::Types<solvers::CartesianPath, solvers::PipelinePlanner>;
 TYPED_TEST_SUITE(PandaMoveRelative, PlannerTypes);
 TYPED_TEST(PandaMoveRelative, cartesianCollisionMinMaxDistance) {
@@ -192,6 +249,44 @@ TYPED_TEST(PandaMoveRelative, cartesianCollisionMinMaxDistance) {
 	EXPECT_TRUE(this->scene->isPathValid(*trajectory->trajectory(), "panda_arm", false));
 }
 
+TEST(PipelinePlannerPool, leasesInstances) {
+	solvers::PipelinePlanner::Specification spec;
+	spec.model = loadModel();
+	spec.pipeline = "pilz_industrial_motion_planner";
+	auto pool = solvers::PipelinePlanner::createPool(spec);
+	EXPECT_EQ(pool, solvers::PipelinePlanner::createPool(spec)) << "pools are shared per model and pipeline";
+	EXPECT_EQ(pool->maxSize(), 1u);
+	EXPECT_EQ(pool->size(), 0u) << "instances are created on demand";
+
+	// the first instance is shared with create()
+	auto first = pool->acquire();
+	ASSERT_TRUE(first);
+	EXPECT_EQ(first.get(), solvers::PipelinePlanner::create(spec).get());
+
+	// concurrent requests get distinct instances, up to maxSize()
+	pool->reserve(2);
+	auto second = pool->acquire();
+	ASSERT_TRUE(second);
+	EXPECT_NE(second.get(), first.get());
+	EXPECT_EQ(pool->size(), 2u);
+
+	// further requests wait for a returned instance
+	std::atomic<planning_pipeline::PlanningPipeline*> third{ nullptr };
+	std::thread waiting([&pool, &third] { third = pool->acquire().get(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(third.load(), nullptr);
+	planning_pipeline::PlanningPipeline* returned = second.get();
+	second.reset();
+	waiting.join();
+	EXPECT_EQ(third.load(), returned);
+	EXPECT_EQ(pool->size(), 2u);
+
+	// a custom pipeline cannot be replicated
+	auto fixed = std::make_shared<solvers::PipelinePlanner::Pool>(solvers::PipelinePlanner::create(spec));
+	fixed->reserve(4);
+	EXPECT_EQ(fixed->maxSize(), 1u);
+}
+
 int main(int argc, char** argv) {
 	testing::InitGoogleTest(&argc, argv);
 	ros::init(argc, argv, "move_relative_test");
@@ -2,13 +2,17 @@
 #include "stage_mockups.h"
 
 #include <moveit/task_constructor/task.h>
+#include <moveit/task_constructor/robot_model_cache.h>
+#include <moveit/task_constructor/kinematics_pool.h>
 #include <moveit/task_constructor/stages/move_to.h>
+#include <moveit/task_constructor/stages/compute_ik.h>
 #include <moveit/task_constructor/stages/connect.h>
 #include <moveit/task_constructor/stages/fixed_state.h>
 #include <moveit/task_constructor/solvers/joint_interpolation.h>
 #include <moveit/task_constructor/solvers/cartesian_path.h>
 
 #include <moveit/planning_scene/planning_scene.h>
+#include <geometric_shapes/shapes.h>
 
 #include <tf2_eigen/tf2_eigen.h>
 
@@ -18,6 +22,8 @@
 #include <ros/console.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+
 using namespace moveit::task_constructor;
 using namespace planning_scene;
 using namespace moveit::core;
@@ -74,6 +80,18 @@ TEST_F(PandaMoveTo, stateTarget) {
 	EXPECT_ONE_SOLUTION;
 }
 
+// the resolved goal is reused across plans, but needs to follow goal changes
+TEST_F(PandaMoveTo, goalChange) {
+	move_to->setGoal("ready");
+	EXPECT_ONE_SOLUTION;
+
+	move_to->setGoal(std::map<std::string, double>{ { "panda_joint1", TAU / 8 } });
+	t.reset();
+	EXPECT_ONE_SOLUTION;
+	const auto& end = t.solutions().front()->end()->scene()->getCurrentState();
+	EXPECT_DOUBLE_EQ(end.getVariablePosition("panda_joint1"), TAU / 8);
+}
+
 geometry_msgs::PoseStamped getFramePoseOfNamedState(RobotState state, const std::string& pose,
                                                     const std::string& frame) {
 	state.setToDefaultValues(state.getRobotModel()->getJointModelGroup("panda_arm"), pose);
@@ -205,6 +223,228 @@ TEST(Task, taskMoveConstructor) {
 	}
 }
 
+TEST(RobotModelCache, sharesModel) {
+	Task a, b;
+	a.loadRobotModel();
+	b.loadRobotModel();
+	ASSERT_TRUE(a.getRobotModel());
+	EXPECT_EQ(a.getRobotModel(), b.getRobotModel());
+
+	RobotModelCache::invalidate();
+	Task c;
+	c.loadRobotModel();
+	EXPECT_NE(a.getRobotModel(), c.getRobotModel());
+}
+
+TEST(KinematicsPool, leasedSolvers) {
+	auto robot_model = loadModel();
+	const JointModelGroup* jmg = robot_model->getJointModelGroup("panda_arm");
+	KinematicsPool pool;
+	// concurrent leases get distinct instances, never the group's own one
+	auto first = pool.solver(jmg);
+	ASSERT_TRUE(first);
+	EXPECT_NE(first, jmg->getSolverInstance());
+	kinematics::KinematicsBasePtr second;
+	std::thread([&] { second = pool.solver(jmg); }).join();
+	ASSERT_TRUE(second);
+	EXPECT_NE(second, first);
+	EXPECT_NE(second, jmg->getSolverInstance());
+
+	// released instances are reused, without allocating more
+	const kinematics::KinematicsBase* released = first.get();
+	first.reset();
+	EXPECT_EQ(pool.solver(jmg).get(), released);
+
+	// IK of a reachable pose, given for a link rigidly attached to the solver's tip
+	RobotState state(robot_model);
+	state.setToDefaultValues(jmg, "ready");
+	state.update();
+	const Eigen::Isometry3d target = state.getGlobalLinkTransform("panda_hand");
+	state.setToDefaultValues(jmg, "extended");
+	ASSERT_TRUE(pool.setFromIK(state, jmg, target, "panda_hand", 1.0));
+	EXPECT_TRUE(state.getGlobalLinkTransform("panda_hand").isApprox(target, 1e-3));
+
+	// leases may outlive the pool
+	kinematics::KinematicsBasePtr lease;
+	{
+		KinematicsPool other;
+		lease = other.solver(jmg);
+	}
+	ASSERT_TRUE(lease);
+	lease.reset();
+}
+
+// ComputeIK of panda_link8, solving the targets spawned by its child
+struct PandaComputeIK : public testing::Test
+{
+	struct Target
+	{
+		PlanningScenePtr scene;
+		geometry_msgs::PoseStamped pose;
+	};
+	// spawns all targets at once, with their index as cost and comment
+	struct TargetGenerator : public Generator
+	{
+		std::vector<Target> targets;
+		bool done = false;
+
+		TargetGenerator(std::vector<Target> targets) : Generator("targets"), targets(std::move(targets)) {}
+		void reset() override {
+			Generator::reset();
+			done = false;
+		}
+		bool canCompute() const override { return !done; }
+		void compute() override {
+			for (size_t i = 0; i < targets.size(); ++i) {
+				InterfaceState state(targets[i].scene);
+				state.properties().set("target_pose", targets[i].pose);
+				SubTrajectory solution;
+				solution.setCost(i);
+				solution.setComment(std::to_string(i));
+				spawn(std::move(state), std::move(solution));
+			}
+			done = true;
+		}
+	};
+
+	Task t;
+	PlanningScenePtr scene;  // panda_arm at "ready"
+	geometry_msgs::PoseStamped ready_pose;  // pose of panda_link8 at "ready"
+
+	PandaComputeIK() {
+		t.setRobotModel(loadModel());
+		scene = std::make_shared<PlanningScene>(t.getRobotModel());
+		scene->getCurrentStateNonConst().setToDefaultValues();
+		scene->getCurrentStateNonConst().setToDefaultValues(t.getRobotModel()->getJointModelGroup("panda_arm"), "ready");
+		ready_pose = getFramePoseOfNamedState(scene->getCurrentState(), "ready", "panda_link8");
+	}
+
+	template <typename IK = stages::ComputeIK>
+	IK* add(std::vector<Target> targets) {
+		auto ik = std::make_unique<IK>("IK", std::make_unique<TargetGenerator>(std::move(targets)));
+		ik->setGroup("panda_arm");
+		ik->setIKFrame("panda_link8");
+		IK* result = ik.get();
+		t.add(std::move(ik));
+		return result;
+	}
+
+	geometry_msgs::PoseStamped shifted(double dx, double dy, double dz) const {
+		geometry_msgs::PoseStamped pose = ready_pose;
+		pose.pose.position.x += dx;
+		pose.pose.position.y += dy;
+		pose.pose.position.z += dz;
+		return pose;
+	}
+
+	static std::vector<double> costs(const Stage& stage) {
+		std::vector<double> result;
+		for (const auto& s : stage.solutions())
+			result.push_back(s->cost());
+		return result;
+	}
+};
+
+TEST_F(PandaComputeIK, batchMatchesSequential) {
+	std::vector<Target> targets;
+	for (double dx : { 0.0, 0.02, 0.04, 0.06 })
+		targets.push_back({ scene, shifted(dx, 0.0, 0.0) });
+	auto ik = add(std::move(targets));
+
+	ik->setMaxBatchSize(1);
+	ASSERT_TRUE(t.plan());
+	const std::vector<double> sequential = costs(*ik);
+	ASSERT_EQ(sequential.size(), 4u);
+	EXPECT_EQ(ik->computeTimeStatistics().count(), 4u);
+
+	// a single compute() call processes all upstream solutions, finding the same solutions
+	t.reset();
+	ik->setMaxBatchSize(4);
+	ASSERT_TRUE(t.plan());
+	const std::vector<double> batched = costs(*ik);
+	ASSERT_EQ(batched.size(), sequential.size());
+	EXPECT_EQ(ik->computeTimeStatistics().count(), 1u);
+	for (size_t i = 0; i < batched.size(); ++i)
+		EXPECT_NEAR(batched[i], sequential[i], 1e-6);
+}
+
+// exposes the seed cache
+struct SeedCacheIK : public stages::ComputeIK
+{
+	using stages::ComputeIK::ComputeIK;
+	using stages::ComputeIK::seed_cache_;
+};
+
+TEST_F(PandaComputeIK, seedCacheReusesSolutions) {
+	auto extended = scene->diff();
+	extended->getCurrentStateNonConst().setToDefaultValues(t.getRobotModel()->getJointModelGroup("panda_arm"),
+	                                                        "extended");
+	// the same target again, but starting from "extended", and a nearby target
+	auto ik = add<SeedCacheIK>({ { scene, ready_pose }, { extended, ready_pose }, { extended, shifted(0.02, 0, 0) } });
+	ik->setSeedCacheSize(1);
+	ASSERT_TRUE(t.plan());
+	ASSERT_EQ(ik->solutions().size(), 3u);
+
+	auto joints = [&](const std::string& comment) {
+		std::vector<double> positions;
+		for (const auto& s : ik->solutions())
+			if (s->comment() == comment)
+				s->end()->scene()->getCurrentState().copyJointGroupPositions("panda_arm", positions);
+		return positions;
+	};
+	// IK of the repeated target is seeded with the cached solution of the first one, instead of "extended"
+	const std::vector<double> first = joints("0");
+	const std::vector<double> repeated = joints("1");
+	ASSERT_EQ(first.size(), 7u);
+	ASSERT_EQ(repeated.size(), first.size());
+	for (size_t i = 0; i < first.size(); ++i)
+		EXPECT_NEAR(repeated[i], first[i], 1e-3);
+
+	// the cache is bounded by seed_cache_size and cleared on reset
+	EXPECT_EQ(ik->seed_cache_.size(), 1u);
+	t.reset();
+	EXPECT_TRUE(ik->seed_cache_.empty());
+}
+
+TEST_F(PandaComputeIK, eefCheckIgnoresSelfCollisions) {
+	// placing the hand close to the robot's base only collides with the robot itself
+	geometry_msgs::PoseStamped close_to_base = ready_pose;
+	close_to_base.pose.position.x = 0.0;
+	close_to_base.pose.position.y = 0.0;
+	close_to_base.pose.position.z = 0.2;
+	// a world object at the target pose is still detected before IK
+	auto obstructed = scene->diff();
+	Eigen::Isometry3d box_pose;
+	tf2::fromMsg(ready_pose.pose, box_pose);
+	obstructed->getWorldNonConst()->addToObject("box", std::make_shared<shapes::Box>(0.2, 0.2, 0.2), box_pose);
+
+	auto ik = add({ { scene, close_to_base }, { obstructed, ready_pose } });
+	EXPECT_FALSE(t.plan());
+	const auto& counts = ik->failureCounts();
+	EXPECT_EQ(counts.count("0 eef in collision"), 0u);
+	ASSERT_EQ(counts.count("1 eef in collision"), 1u);
+	EXPECT_EQ(counts.at("1 eef in collision"), 1u);
+}
+
+TEST_F(PandaComputeIK, diverseSeedsFindDistinctSolutions) {
+	auto ik = add({ { scene, ready_pose } });
+	ik->setMaxIKSolutions(4);
+	ik->setMinSolutionDistance(0.1);
+	ik->setDiverseSeeds(true);
+	ik->setTimeout(1.0);
+	t.setNumThreads(2);
+	ASSERT_TRUE(t.plan());
+
+	// the redundant arm has several solutions, spread over its joint space
+	const auto& solutions = ik->solutions();
+	EXPECT_GE(solutions.size(), 2u);
+	EXPECT_LE(solutions.size(), 4u);
+	const JointModelGroup* jmg = t.getRobotModel()->getJointModelGroup("panda_arm");
+	for (auto a = solutions.begin(); a != solutions.end(); ++a)
+		for (auto b = std::next(a); b != solutions.end(); ++b)
+			EXPECT_GE((*a)->end()->scene()->getCurrentState().distance((*b)->end()->scene()->getCurrentState(), jmg), 0.1);
+}
+
 int main(int argc, char** argv) {
 	testing::InitGoogleTest(&argc, argv);
 	ros::init(argc, argv, "move_to_test");
@@ -0,0 +1,208 @@
+#include <moveit/task_constructor/solvers/multi_planner.h>
+#include <moveit/task_constructor/solvers/path_library.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+#include "models.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <gtest/gtest.h>
+
+using namespace moveit::task_constructor;
+using namespace std::chrono_literals;
+
+// planner succeeding or failing after a given delay, yielding a trajectory of given duration
+struct DelayedPlanner : public solvers::PlannerInterface
+{
+	std::chrono::milliseconds delay;
+	bool success;
+	double duration;
+	std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+
+	DelayedPlanner(std::chrono::milliseconds delay, bool success, double duration = 1.0)
+	  : delay(delay), success(success), duration(duration) {}
+
+	void init(const moveit::core::RobotModelConstPtr& /*robot_model*/) override {}
+
+	Result plan(const planning_scene::PlanningSceneConstPtr& from, robot_trajectory::RobotTrajectoryPtr& result) {
+		auto end = std::chrono::steady_clock::now() + delay;
+		while (std::chrono::steady_clock::now() < end) {
+			if (solvers::PlannerCancellation::cancelled()) {
+				*cancelled = true;
+				return { false, "cancelled" };
+			}
+			std::this_thread::sleep_for(1ms);
+		}
+		result = std::make_shared<robot_trajectory::RobotTrajectory>(from->getRobotModel(), nullptr);
+		result->addSuffixWayPoint(from->getCurrentState(), 0.0);
+		result->addSuffixWayPoint(from->getCurrentState(), duration);
+		return { success, success ? "" : "failure" };
+	}
+
+	Result plan(const planning_scene::PlanningSceneConstPtr& from, const planning_scene::PlanningSceneConstPtr& /*to*/,
+	            const moveit::core::JointModelGroup* /*jmg*/, double /*timeout*/,
+	            robot_trajectory::RobotTrajectoryPtr& result,
+	            const moveit_msgs::Constraints& /*path_constraints*/) override {
+		return plan(from, result);
+	}
+
+	Result plan(const planning_scene::PlanningSceneConstPtr& from, const moveit::core::LinkModel& /*link*/,
+	            const Eigen::Isometry3d& /*offset*/, const Eigen::Isometry3d& /*target*/,
+	            const moveit::core::JointModelGroup* /*jmg*/, double /*timeout*/,
+	            robot_trajectory::RobotTrajectoryPtr& result,
+	            const moveit_msgs::Constraints& /*path_constraints*/) override {
+		return plan(from, result);
+	}
+};
+
+struct MultiPlannerRacing : public testing::Test
+{
+	planning_scene::PlanningScenePtr scene = std::make_shared<planning_scene::PlanningScene>(getModel());
+	solvers::MultiPlanner planner;
+	robot_trajectory::RobotTrajectoryPtr result;
+
+	solvers::PlannerInterface::Result plan() { return planner.plan(scene, scene, nullptr, 10.0, result); }
+};
+
+TEST_F(MultiPlannerRacing, firstSuccessWins) {
+	auto slow = std::make_shared<DelayedPlanner>(5000ms, false);
+	planner.push_back(slow);
+	planner.push_back(std::make_shared<DelayedPlanner>(10ms, true));
+	planner.setRacing(true);
+
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_TRUE(plan());
+	EXPECT_LT(std::chrono::steady_clock::now() - start, 1000ms);
+	ASSERT_TRUE(result);
+
+	// the slow planner got cancelled
+	auto deadline = std::chrono::steady_clock::now() + 1000ms;
+	while (!*slow->cancelled && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(1ms);
+	EXPECT_TRUE(*slow->cancelled);
+}
+
+TEST_F(MultiPlannerRacing, allFailing) {
+	planner.push_back(std::make_shared<DelayedPlanner>(10ms, false));
+	planner.push_back(std::make_shared<DelayedPlanner>(20ms, false));
+	planner.setRacing(true);
+
+	auto r = plan();
+	EXPECT_FALSE(r);
+	EXPECT_EQ(r.message, "failure");
+}
+
+TEST_F(MultiPlannerRacing, gracePeriodPrefersShorterTrajectory) {
+	planner.push_back(std::make_shared<DelayedPlanner>(1ms, true, 10.0));
+	planner.push_back(std::make_shared<DelayedPlanner>(50ms, true, 1.0));
+	planner.setRacing(true, 2.0);
+
+	EXPECT_TRUE(plan());
+	ASSERT_TRUE(result);
+	EXPECT_DOUBLE_EQ(result->getDuration(), 1.0);
+}
+
+TEST_F(MultiPlannerRacing, enclosingCancellation) {
+	planner.push_back(std::make_shared<DelayedPlanner>(5000ms, true));
+	planner.setRacing(true);
+
+	std::atomic<bool> preempt{ false };
+	std::thread preempter([&preempt] {
+		std::this_thread::sleep_for(20ms);
+		preempt = true;
+	});
+	auto start = std::chrono::steady_clock::now();
+	{
+		solvers::PlannerCancellation cancellation(preempt);
+		EXPECT_FALSE(plan());
+	}
+	EXPECT_LT(std::chrono::steady_clock::now() - start, 1000ms);
+	preempter.join();
+}
+
+TEST(PlannerCancellation, nesting) {
+	std::atomic<bool> outer{ false };
+	std::atomic<bool> inner{ false };
+	EXPECT_FALSE(solvers::PlannerCancellation::cancelled());
+	{
+		solvers::PlannerCancellation o(outer);
+		solvers::PlannerCancellation i(inner);
+		EXPECT_FALSE(solvers::PlannerCancellation::cancelled());
+		outer = true;
+		EXPECT_TRUE(solvers::PlannerCancellation::cancelled());
+
+		// forward to another thread
+		bool forwarded = false;
+		std::thread([&forwarded, current = solvers::PlannerCancellation::current()] {
+			solvers::PlannerCancellation forward(current);
+			forwarded = solvers::PlannerCancellation::cancelled();
+		}).join();
+		EXPECT_TRUE(forwarded);
+	}
+	EXPECT_FALSE(solvers::PlannerCancellation::cancelled());
+}
+
+TEST(PlannerCancellation, deadline) {
+	EXPECT_EQ(solvers::PlannerCancellation::remainingTime(), std::numeric_limits<double>::infinity());
+	{
+		solvers::PlannerCancellation cancellation(nullptr, std::chrono::steady_clock::now() + 20ms);
+		EXPECT_LE(solvers::PlannerCancellation::remainingTime(), 0.02);
+		EXPECT_FALSE(solvers::PlannerCancellation::cancelled());
+
+		auto scene = std::make_shared<planning_scene::PlanningScene>(getModel());
+		robot_trajectory::RobotTrajectoryPtr result;
+		DelayedPlanner planner(5000ms, true);
+		auto start = std::chrono::steady_clock::now();
+		EXPECT_FALSE(planner.plan(scene, result));
+		EXPECT_LT(std::chrono::steady_clock::now() - start, 1000ms);
+		EXPECT_TRUE(solvers::PlannerCancellation::cancelled());
+	}
+	EXPECT_FALSE(solvers::PlannerCancellation::cancelled());
+}
+
+TEST(PathLibrary, repairStoredPath) {
+	auto scene = std::make_shared<planning_scene::PlanningScene>(getModel());
+	const moveit::core::JointModelGroup* jmg = scene->getRobotModel()->getJointModelGroup("group");
+	moveit::core::RobotState start(scene->getCurrentState()), goal(start);
+	start.setToDefaultValues();
+	goal.setToDefaultValues();
+	std::vector<double> positions;
+	goal.copyJointGroupPositions(jmg, positions);
+	for (double& p : positions)
+		p += 0.5;
+	goal.setJointGroupPositions(jmg, positions);
+	goal.update();
+
+	robot_trajectory::RobotTrajectory trajectory(scene->getRobotModel(), jmg);
+	trajectory.addSuffixWayPoint(start, 0.0);
+	trajectory.addSuffixWayPoint(goal, 1.0);
+	solvers::PathLibrary library(0.1);
+	library.store(trajectory);
+	EXPECT_EQ(library.size(), 1u);
+
+	// queries within the same regions, in either direction, are served by the repaired path
+	moveit::core::RobotState near_goal(goal);
+	for (double& p : positions)
+		p += 0.01;
+	near_goal.setJointGroupPositions(jmg, positions);
+	near_goal.update();
+	auto path = library.retrieve(scene, start, near_goal, jmg);
+	ASSERT_TRUE(path);
+	EXPECT_EQ(path->getWayPointCount(), 2u);
+	EXPECT_TRUE(path->getLastWayPoint().distance(near_goal, jmg) < 1e-9);
+	EXPECT_TRUE(library.retrieve(scene, near_goal, start, jmg));
+	EXPECT_FALSE(library.retrieve(scene, start, start, jmg));
+
+	const std::string file = "/tmp/mtc_path_library_test.bin";
+	library.save(file);
+	solvers::PathLibrary loaded(0.1);
+	loaded.load(file);
+	EXPECT_EQ(loaded.size(), 1u);
+	EXPECT_TRUE(loaded.retrieve(scene, start, goal, jmg));
+	std::remove(file.c_str());
+}
@@ -1,7 +1,11 @@
 #include <moveit/task_constructor/properties.h>
+#include <geometry_msgs/PoseStamped.h>
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <initializer_list>
+#include <thread>
+#include <vector>
 
 using namespace moveit::task_constructor;
 
@@ -76,6 +80,82 @@ TEST(Property, reset) {
 	EXPECT_EQ(props.get<double>("double1"), 1.0);
 }
 
+TEST(Property, copyOnWrite) {
+	PropertyMap props;
+	props.declare<double>("double1", 1.0);
+
+	PropertyMap copy = props;
+	// const access shares storage
+	const PropertyMap& const_props = props;
+	const PropertyMap& const_copy = copy;
+	EXPECT_EQ(&const_copy.property("double1"), &const_props.property("double1"));
+
+	// writing to the copy doesn't affect the original and vice versa
+	copy.set("double1", 2.0);
+	copy.set("int1", 1);
+	EXPECT_EQ(props.get<double>("double1"), 1.0);
+	EXPECT_FALSE(props.hasProperty("int1"));
+	props.set("double1", 3.0);
+	EXPECT_EQ(copy.get<double>("double1"), 2.0);
+
+	// moved-from maps are empty, but usable
+	PropertyMap moved = std::move(copy);
+	EXPECT_EQ(moved.get<double>("double1"), 2.0);
+	EXPECT_FALSE(copy.hasProperty("double1"));  // NOLINT(bugprone-use-after-move)
+	copy.set("double1", 4.0);
+	EXPECT_EQ(copy.get<double>("double1"), 4.0);
+}
+
+TEST(Property, key) {
+	PropertyMap props;
+	props.declare<double>("double1", 1.0);
+	props.declare<int>("int1");
+
+	const PropertyKey<double> double1("double1");
+	const PropertyKey<int> int1("int1");
+	const PropertyKey<int> unknown("unknown");
+	EXPECT_EQ(double1.get(props), 1.0);
+	EXPECT_THROW(int1.get(props), Property::undefined);
+	EXPECT_EQ(int1.get(props, 42), 42);
+	EXPECT_THROW(unknown.get(props), Property::undeclared);
+
+	// cached handles see value updates
+	props.set("double1", 2.0);
+	props.set("int1", 3);
+	EXPECT_EQ(double1.get(props), 2.0);
+	EXPECT_EQ(int1.get(props), 3);
+
+	// ... and are re-resolved if storage changes
+	PropertyMap copy = props;
+	copy.set("double1", 3.0);
+	EXPECT_EQ(double1.get(copy), 3.0);
+	EXPECT_EQ(double1.get(props), 2.0);
+	props = PropertyMap();
+	EXPECT_THROW(double1.get(props), Property::undeclared);
+	props.set("double1", 4.0);
+	EXPECT_EQ(double1.get(props), 4.0);
+}
+
+TEST(Property, keyConcurrent) {
+	// keys are shared by stages, resolved concurrently against different maps
+	const PropertyKey<double> key("value");
+	std::vector<PropertyMap> maps(4);
+	for (size_t i = 0; i < maps.size(); ++i)
+		maps[i].declare<double>("value", static_cast<double>(i));
+
+	std::atomic<size_t> mismatches{ 0 };
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < maps.size(); ++i)
+		threads.emplace_back([&, i] {
+			for (int k = 0; k < 1000; ++k)
+				if (key.get(maps[i]) != static_cast<double>(i))
+					++mismatches;
+		});
+	for (auto& thread : threads)
+		thread.join();
+	EXPECT_EQ(mismatches, 0u);
+}
+
 TEST(Property, anytype) {
 	PropertyMap props;
 	props.declare<boost::any>("any", "store any type");
@@ -102,11 +182,48 @@ TEST(Property, serialize) {
 	props.set("int", 42);
 	EXPECT_EQ(props.property("int").serialize(), "42");
 
+	// cached serialization follows all kinds of value changes
+	Property& p = props.property("int");
+	p.setCurrentValue(7);
+	EXPECT_EQ(p.serialize(), "7");
+	boost::any_cast<int&>(p.value()) = 8;
+	EXPECT_EQ(p.serialize(), "8");
+	p.reset();
+	EXPECT_EQ(p.serialize(), "42");
+
 	// std::map doesn't provide operator<< serialization
 	props.declare<std::map<int, int>>("map", std::map<int, int>());
 	EXPECT_EQ(props.property("map").serialize(), "");
 }
 
+TEST(Property, encode) {
+	PropertyMap props;
+	props.declare<std::string>("string", "two words");
+	props.declare<double>("double", 0.5);
+	geometry_msgs::PoseStamped pose;
+	pose.header.frame_id = "world";
+	pose.pose.position.x = 1.0;
+	pose.pose.orientation.w = 1.0;
+	props.declare<geometry_msgs::PoseStamped>("pose", pose);
+
+	// round trip via type name, as done for remote stages
+	for (const auto& name : { "string", "double", "pose" }) {
+		const Property& p = props.property(name);
+		boost::any decoded = Property::decode(p.typeName(), Property::encode(p.value()));
+		ASSERT_FALSE(decoded.empty()) << name;
+		EXPECT_EQ(Property::encode(decoded), Property::encode(p.value())) << name;
+	}
+	const std::string string_type = Property::typeName(typeid(std::string));
+	EXPECT_EQ(boost::any_cast<std::string>(Property::decode(string_type, "two words")), "two words");
+	auto decoded = boost::any_cast<geometry_msgs::PoseStamped>(
+	    Property::decode(props.property("pose").typeName(), Property::encode(props.get("pose"))));
+	EXPECT_EQ(decoded.header.frame_id, "world");
+	EXPECT_EQ(decoded.pose.position.x, 1.0);
+
+	// unknown types decode to empty values
+	EXPECT_TRUE(Property::decode("unknown", "42").empty());
+}
+
 class InitFromTest : public ::testing::Test
 {
 protected:
@@ -174,3 +291,68 @@ TEST_F(InitFromTest, function) {
 	slave.performInitFrom(1, master);
 	EXPECT_EQ(slave.get<double>("double3"), 3.0);
 }
+
+TEST_F(InitFromTest, skipUnchanged) {
+	slave.property("double3").configureInitFrom(1, "double1");
+	slave.performInitFrom(1, master);
+	EXPECT_EQ(slave.get<double>("double3"), 1.0);
+	// a skipped initialization doesn't write and thus keeps the generation
+	uint64_t generation = slave.generation();
+	slave.performInitFrom(1, master);  // neither slave nor master changed
+	EXPECT_EQ(slave.generation(), generation);
+	// copies share generation and thus are equally skipped
+	PropertyMap copy = master;
+	slave.performInitFrom(1, copy);
+	EXPECT_EQ(slave.generation(), generation);
+
+	master.set("double1", 4.0);  // source changed
+	slave.performInitFrom(1, master);
+	EXPECT_EQ(slave.get<double>("double3"), 4.0);
+
+	slave.reset();  // target changed
+	generation = slave.generation();
+	slave.performInitFrom(1, master);
+	EXPECT_NE(slave.generation(), generation);
+	EXPECT_EQ(slave.get<double>("double3"), 4.0);
+}
+
+TEST_F(InitFromTest, skipUnchangedHeldProperty) {
+	// modifications via a held reference renew the generation too
+	Property& double1 = master.property("double1");
+	slave.property("double3").configureInitFrom(1, "double1");
+	slave.performInitFrom(1, master);
+	EXPECT_EQ(slave.get<double>("double3"), 1.0);
+
+	uint64_t generation = master.generation();
+	double1.setValue(4.0);
+	EXPECT_NE(master.generation(), generation);
+	slave.performInitFrom(1, master);
+	EXPECT_EQ(slave.get<double>("double3"), 4.0);
+
+	generation = master.generation();
+	double1.setCurrentValue(5.0);
+	EXPECT_NE(master.generation(), generation);
+	slave.performInitFrom(1, master);
+	EXPECT_EQ(slave.get<double>("double3"), 5.0);
+}
+
+TEST_F(InitFromTest, neverSkipCustomInitializer) {
+	// custom initializers might depend on anything, e.g. external state
+	unsigned int calls = 0;
+	slave.property("double3").configureInitFrom(1, [&calls](const PropertyMap& other) -> boost::any {
+		++calls;
+		return other.get<double>("double1");
+	});
+	slave.performInitFrom(1, master);
+	EXPECT_EQ(calls, 1u);
+	slave.performInitFrom(1, master);  // neither slave nor master changed
+	EXPECT_EQ(calls, 2u);
+
+	// reconfiguring by name enables skipping again
+	slave.property("double3").configureInitFrom(1, "double1");
+	slave.performInitFrom(1, master);
+	const uint64_t generation = slave.generation();
+	slave.performInitFrom(1, master);
+	EXPECT_EQ(slave.generation(), generation);
+	EXPECT_EQ(calls, 2u);
+}
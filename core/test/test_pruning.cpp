@@ -1,4 +1,5 @@
 #include <moveit/task_constructor/task.h>
+#include <moveit/task_constructor/stage_p.h>
 
 #include "stage_mockups.h"
 #include "models.h"
@@ -24,6 +25,25 @@ TEST_F(Pruning, PropagatorFailure) {
 	EXPECT_EQ(back->runs_, 0u);
 }
 
+TEST_F(Pruning, PropagatorFailureLongChain) {
+	// pruning walks back all states of a long chain (iteratively, i.e. not limited by the stack size)
+	std::vector<Stage*> chain{ add(t, new GeneratorMockup({ 0 })) };
+	for (int i = 0; i < 1000; ++i)
+		chain.push_back(add(t, new ForwardMockup()));
+	add(t, new ForwardMockup({ INF }));
+
+	EXPECT_FALSE(t.plan());
+	size_t num_states = 0;
+	size_t num_pruned = 0;
+	for (Stage* stage : chain)
+		for (const InterfaceState& state : stage->pimpl()->states()) {
+			++num_states;
+			num_pruned += state.priority().status() == InterfaceState::Status::PRUNED;
+		}
+	EXPECT_EQ(num_states, 1002u);  // generator's start + end, one end per ForwardMockup
+	EXPECT_EQ(num_pruned, num_states);
+}
+
 // Same as the previous test, except pruning is disabled for the whole task
 TEST_F(Pruning, DisabledPruningPropagatorFailure) {
 	t.setPruning(false);
@@ -66,6 +86,29 @@ TEST_F(Pruning, NoPruningIfAlternativesExist) {
 	EXPECT_EQ(t.solutions().size(), 1u);
 }
 
+TEST_F(Pruning, CostBound) {
+	t.setCostPruningSlack(0.0);
+	add(t, new GeneratorMockup({ 1, 5, 0.5, 2 }));
+	auto fw = add(t, new ForwardMockup());
+
+	EXPECT_TRUE(t.plan());
+	// states exceeding the best solution's cost are not extended anymore
+	EXPECT_LT(fw->runs_, 4u);
+	ASSERT_GT(t.solutions().size(), 0u);
+	EXPECT_EQ(t.solutions().front()->cost(), 0.5);
+}
+
+TEST_F(Pruning, BeamReactivatesParkedStates) {
+	t.setBeamWidth(1);
+	add(t, new GeneratorMockup({ 1, 2, 3 }));
+	auto fw = add(t, new ForwardMockup({ INF, INF, 0 }));
+
+	EXPECT_TRUE(t.plan());
+	// parked states are re-enabled when the beam state fails
+	EXPECT_EQ(fw->runs_, 3u);
+	EXPECT_EQ(t.solutions().size(), 1u);
+}
+
 TEST_F(Pruning, ConnectReactivatesPrunedPaths) {
 	add(t, new BackwardMockup);
 	add(t, new GeneratorMockup({ 0 }));
@@ -228,3 +271,47 @@ TEST_F(Pruning, BackPropagateFailure) {
 	EXPECT_EQ(con1->runs_, 2u);
 	EXPECT_EQ(con2->runs_, 3u);  // 100 - 20 is pruned
 }
+
+TEST_F(Pruning, MemoryBudgetEvictsPrunedStates) {
+	auto gen = add(t, new GeneratorMockup(PredefinedCosts(std::list<double>(40, 0.0))));
+	add(t, new ForwardMockup(PredefinedCosts::constant(INF)));
+	t.setMemoryBudget(1);  // evict as much as possible
+
+	EXPECT_FALSE(t.plan());
+
+	size_t num_evicted = 0;
+	for (const InterfaceState& state : gen->pimpl()->states()) {
+		if (state.evicted()) {
+			EXPECT_EQ(state.priority().status(), InterfaceState::Status::PRUNED);
+			++num_evicted;
+		}
+	}
+	EXPECT_GT(num_evicted, 0u);
+	EXPECT_EQ(gen->solutions().size(), 40u);  // tombstones remain
+}
+
+TEST_F(Pruning, ExpiredPrunedStatesAreEvicted) {
+	auto gen = add(t, new GeneratorMockup(PredefinedCosts(std::list<double>(40, 0.0))));
+	add(t, new ForwardMockup(PredefinedCosts::constant(INF)));
+	auto count_evicted = [gen] {
+		size_t num_evicted = 0;
+		for (const InterfaceState& state : gen->pimpl()->states())
+			num_evicted += state.evicted();
+		return num_evicted;
+	};
+
+	// states don't expire within the planning time
+	t.setPrunedStateExpiry(3600.0);
+	EXPECT_FALSE(t.plan());
+	EXPECT_EQ(count_evicted(), 0u);
+
+	// states expire by the next check
+	t.reset();
+	t.setPrunedStateExpiry(1e-9);
+	EXPECT_FALSE(t.plan());
+	EXPECT_GT(count_evicted(), 0u);
+	for (const InterfaceState& state : gen->pimpl()->states())
+		if (state.evicted())
+			EXPECT_EQ(state.priority().status(), InterfaceState::Status::PRUNED);
+	EXPECT_EQ(gen->solutions().size(), 40u);  // tombstones remain
+}
@@ -58,6 +58,17 @@ TEST_F(ConnectConnect, SuccSucc) {
 	EXPECT_COSTS(t.solutions(), ::testing::ElementsAre(11, 12, 13, 21, 22, 23));
 }
 
+TEST_F(ConnectConnect, ConcurrentGroups) {
+	t.setNumThreads(2);
+	add(t, new GeneratorMockup({ 1.0, 2.0 }));
+	auto con = add(t, new Connect());
+	con->setPlanGroupsConcurrently(true);
+	add(t, new GeneratorMockup({ 10.0 }));
+
+	EXPECT_TRUE(t.plan());
+	EXPECT_COSTS(t.solutions(), ::testing::ElementsAre(11, 12));
+}
+
 // https://github.com/moveit/moveit_task_constructor/issues/218
 TEST_F(ConnectConnect, FailSucc) {
 	add(t, new GeneratorMockup());
@@ -1,14 +1,38 @@
 #include "models.h"
 
 #include <moveit/task_constructor/stage_p.h>
+#include <moveit/task_constructor/event_log.h>
+#include <moveit/task_constructor/grasp_database.h>
+#include <moveit/task_constructor/ik_cache.h>
+#include <moveit/task_constructor/merge.h>
+#include <moveit/task_constructor/moveit_compat.h>
+#include <moveit/task_constructor/scene_builder.h>
+#include <moveit/task_constructor/solution_file.h>
+#include <moveit/task_constructor/solution_ring.h>
+#include <moveit/task_constructor/trace.h>
+#include <moveit/task_constructor/solvers/joint_interpolation.h>
 #include <moveit/task_constructor/stages/compute_ik.h>
+#include <moveit/task_constructor/stages/fixed_state.h>
+#include <moveit/task_constructor/stages/generate_grasp_pose.h>
+#include <moveit/task_constructor/stages/generate_place_pose.h>
+#include <moveit/task_constructor/stages/generate_random_pose.h>
 #include <moveit/task_constructor/stages/modify_planning_scene.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
 #include <geometry_msgs/PoseStamped.h>
+#include <tf2_eigen/tf2_eigen.h>
+#include <moveit_msgs/AttachedCollisionObject.h>
+#include <geometric_shapes/shapes.h>
 
 #include "stage_mockups.h"
 #include <ros/console.h>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 using namespace moveit::task_constructor;
 using namespace planning_scene;
@@ -49,6 +73,487 @@ TEST(Stage, registerCallbacks) {
 	EXPECT_EQ(called, 1u);
 }
 
+TEST(Stage, computeTimeStatistics) {
+	ComputeTimeStatistics stats;
+	EXPECT_EQ(stats.count(), 0u);
+	EXPECT_EQ(stats.quantile(0.95), 0.0);
+
+	for (int i = 0; i < 19; ++i)
+		stats.add(1e-3, 0.5e-3);  // 1ms -> bin 9: [512, 1024) us
+	stats.add(1.0);  // 1s -> bin 19
+	EXPECT_EQ(stats.count(), 20u);
+	EXPECT_DOUBLE_EQ(stats.min(), 1e-3);
+	EXPECT_DOUBLE_EQ(stats.max(), 1.0);
+	EXPECT_DOUBLE_EQ(stats.total(), 19 * 1e-3 + 1.0);
+	EXPECT_DOUBLE_EQ(stats.totalPlannerTime(), 19 * 0.5e-3);
+	EXPECT_EQ(stats.histogram()[9], 19u);
+	EXPECT_EQ(stats.histogram()[19], 1u);
+
+	// p95 falls into the lower bin, the maximum is clamped to the observed extremum
+	EXPECT_NEAR(stats.quantile(0.95), 1e-3, 0.1e-3);
+	EXPECT_DOUBLE_EQ(stats.quantile(1.0), 1.0);
+
+	StandaloneGeneratorMockup g{ PredefinedCosts::constant(0.0) };
+	g.init(getModel());
+	g.pimpl()->runCompute();
+	g.pimpl()->runCompute();
+	EXPECT_EQ(g.computeTimeStatistics().count(), 2u);
+	EXPECT_DOUBLE_EQ(g.computeTimeStatistics().total(), g.getTotalComputeTime());
+	g.reset();
+	EXPECT_EQ(g.computeTimeStatistics().count(), 0u);
+}
+
+TEST(SolutionBase, lazyMarkers) {
+	SubTrajectory solution;
+	solution.markers().emplace_back();  // eager marker
+	unsigned int calls = 0;
+	solution.addMarkerGenerator([&calls](SolutionBase::Markers& markers) {
+		++calls;
+		markers.emplace_back();
+	});
+	EXPECT_EQ(calls, 0u);
+	EXPECT_EQ(solution.generatedMarkers().size(), 1u);
+
+	EXPECT_EQ(solution.markers().size(), 2u);
+	EXPECT_EQ(solution.markers().size(), 2u);
+	EXPECT_EQ(calls, 1u);  // generated only once
+
+	// ... also if accessed concurrently
+	std::atomic<unsigned int> concurrent_calls{ 0 };
+	SubTrajectory shared;
+	shared.addMarkerGenerator([&concurrent_calls](SolutionBase::Markers& markers) {
+		++concurrent_calls;
+		markers.emplace_back();
+	});
+	std::atomic<unsigned int> mismatches{ 0 };
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i)
+		threads.emplace_back([&] {
+			if (static_cast<const SubTrajectory&>(shared).markers().size() != 1u)
+				++mismatches;
+		});
+	for (auto& thread : threads)
+		thread.join();
+	EXPECT_EQ(concurrent_calls, 1u);
+	EXPECT_EQ(mismatches, 0u);
+}
+
+TEST(SolutionBase, flattenTrajectory) {
+	auto model = getModel();
+	moveit::core::RobotState state(model);
+	state.setToDefaultValues();
+
+	// two trajectories of 3 waypoints, 1s apart, each starting where the previous ended
+	auto make_trajectory = [&](double start) {
+		auto t = std::make_shared<robot_trajectory::RobotTrajectory>(model, nullptr);
+		for (size_t i = 0; i < 3; ++i) {
+			state.setVariablePosition(0, start + i);
+			t->addSuffixWayPoint(state, i == 0 ? 0.0 : 1.0);
+		}
+		return t;
+	};
+	SubTrajectory first(make_trajectory(0.0));
+	SubTrajectory empty;
+	SubTrajectory second(make_trajectory(2.0));
+	SolutionSequence inner({ &empty, &second });
+	WrappedSolution wrapped(nullptr, &inner);
+	SolutionSequence sequence({ &first, &wrapped });
+
+	FlatTrajectory flat = flattenTrajectory(sequence);
+	ASSERT_EQ(flat.size(), 5u);
+	EXPECT_EQ(flat.variable_names, model->getVariableNames());
+	for (size_t i = 0; i < flat.size(); ++i) {
+		EXPECT_DOUBLE_EQ(flat.times[i], i);
+		EXPECT_DOUBLE_EQ(flat.positionsAt(i)[0], i);
+		EXPECT_DOUBLE_EQ(flat.velocitiesAt(i)[0], 0.0);
+	}
+
+	auto trajectory = concatenateTrajectories(sequence);
+	ASSERT_TRUE(trajectory);
+	EXPECT_EQ(trajectory->getWayPointCount(), 5u);
+	EXPECT_DOUBLE_EQ(trajectory->getDuration(), 4.0);
+
+	EXPECT_FALSE(concatenateTrajectories(empty));
+	EXPECT_EQ(flattenTrajectory(empty).size(), 0u);
+}
+
+TEST(SolutionBase, finalizeDeferredTimeParameterization) {
+	auto model = getModel();
+	auto from = std::make_shared<PlanningScene>(model);
+	from->getCurrentStateNonConst().setToDefaultValues();
+	auto to = from->diff();
+	to->getCurrentStateNonConst().setVariablePosition(0, 1.0);
+
+	solvers::JointInterpolationPlanner planner;
+	planner.setDeferTimeParameterization(true);
+	planner.init(model);
+	robot_trajectory::RobotTrajectoryPtr path;
+	ASSERT_TRUE(planner.plan(from, to, model->getJointModelGroup("group"), 1.0, path));
+	const double path_duration = path->getDuration();
+	EXPECT_GT(solvers::trajectoryDuration(*path), 0.0) << "pending trajectories should be estimated";
+
+	SubTrajectory first(path);
+	SubTrajectory second(path);
+	first.finalizeTimeParameterization();
+	const auto timed = first.trajectory();
+	ASSERT_TRUE(timed);
+	EXPECT_NE(timed, path) << "a time-parameterized copy should replace the trajectory";
+	EXPECT_EQ(path->getDuration(), path_duration) << "the (concurrently read) original shouldn't be modified";
+	EXPECT_EQ(timed->getWayPointCount(), path->getWayPointCount());
+	EXPECT_TRUE(timed->getWayPoint(1).hasVelocities());
+	EXPECT_DOUBLE_EQ(solvers::trajectoryDuration(*path), timed->getDuration());
+
+	// solutions sharing the trajectory receive the same copy
+	second.finalizeTimeParameterization();
+	EXPECT_EQ(second.trajectory(), timed);
+	first.finalizeTimeParameterization();
+	EXPECT_EQ(first.trajectory(), timed);
+}
+
+TEST(SolutionBase, compressTrajectory) {
+	auto model = getModel();
+	const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("group");
+	moveit::core::RobotState state(model);
+	state.setToDefaultValues();
+
+	// linear motion of the first joint, followed by a kink
+	robot_trajectory::RobotTrajectory trajectory(model, jmg);
+	for (size_t i = 0; i <= 20; ++i) {
+		state.setVariablePosition(0, i <= 10 ? 0.01 * i : 0.1 - 0.01 * (i - 10));
+		trajectory.addSuffixWayPoint(state, i == 0 ? 0.0 : 0.1);
+	}
+
+	auto compressed = compressTrajectory(trajectory, 1e-6);
+	ASSERT_EQ(compressed->getWayPointCount(), 3u);
+	EXPECT_DOUBLE_EQ(compressed->getDuration(), trajectory.getDuration());
+	EXPECT_DOUBLE_EQ(compressed->getWayPoint(1).getVariablePosition(0), 0.1);
+	EXPECT_EQ(trajectory.getWayPointCount(), 21u);  // original is kept
+
+	// a loose tolerance allows cutting the kink
+	EXPECT_EQ(compressTrajectory(trajectory, 0.2)->getWayPointCount(), 2u);
+	// disabled checks keep all waypoints
+	EXPECT_EQ(compressTrajectory(trajectory, 0.0)->getWayPointCount(), 21u);
+
+	// compression is applied according to the creator's settings
+	GeneratorMockup creator;
+	SubTrajectory sub(std::make_shared<robot_trajectory::RobotTrajectory>(trajectory));
+	sub.setCreator(&creator);
+	EXPECT_EQ(sub.compressedTrajectory(), sub.trajectory());
+	creator.setTrajectoryCompression(1e-6);
+	auto cached = sub.compressedTrajectory();
+	EXPECT_EQ(cached->getWayPointCount(), 3u);
+	// the compressed copy is cached, unless tolerances change or the trajectory is replaced
+	EXPECT_EQ(sub.compressedTrajectory(), cached);
+	creator.setTrajectoryCompression(0.2);
+	EXPECT_EQ(sub.compressedTrajectory()->getWayPointCount(), 2u);
+	cached = sub.compressedTrajectory();
+	sub.setTrajectory(std::make_shared<robot_trajectory::RobotTrajectory>(trajectory));
+	EXPECT_NE(sub.compressedTrajectory(), cached);
+}
+
+TEST(SolutionFile, roundtrip) {
+	moveit_task_constructor_msgs::Solution solution;
+	solution.task_id = "task";
+	solution.start_scene.name = "start";
+	solution.sub_solution.emplace_back();
+	solution.sub_solution.back().info.cost = 3.0;
+	solution.sub_solution.back().info.comment = "best";
+	for (size_t i = 0; i < 2; ++i) {
+		moveit_task_constructor_msgs::SubTrajectory t;
+		t.info.cost = 1.5;
+		t.info.stage_id = i + 1;
+		t.scene_diff.name = "end";  // identical diffs are stored once
+		t.execution_info.controller_names = { "arm" };
+		auto& jt = t.trajectory.joint_trajectory;
+		jt.joint_names = { "a", "b" };
+		for (size_t w = 0; w < 3; ++w) {
+			trajectory_msgs::JointTrajectoryPoint p;
+			p.positions = { double(w), double(i) };
+			p.velocities = { 1.0, 0.0 };
+			p.time_from_start = ros::Duration(0.5 * w);
+			jt.points.push_back(p);
+		}
+		solution.sub_trajectory.push_back(t);
+	}
+
+	const std::string path = testing::TempDir() + "solutions.mtc";
+	SolutionFile::write(path, { solution, solution });
+
+	SolutionFile file(path);
+	ASSERT_EQ(file.size(), 2u);
+	EXPECT_EQ(file.cost(1), 3.0);
+	EXPECT_EQ(file.comment(1), "best");
+	ASSERT_EQ(file.numSubTrajectories(0), 2u);
+
+	// waypoints are accessed in place
+	SolutionFile::TrajectoryView view = file.trajectory(0, 1);
+	ASSERT_EQ(view.num_waypoints, 3u);
+	ASSERT_EQ(view.num_joints, 2u);
+	EXPECT_EQ(view.times[2], 1.0);
+	EXPECT_EQ(view.positions[2 * 2 + 0], 2.0);
+	EXPECT_EQ(view.positions[2 * 2 + 1], 1.0);
+	EXPECT_TRUE(view.velocities);
+	EXPECT_FALSE(view.accelerations);
+
+	moveit_task_constructor_msgs::Solution loaded = file.solution(1);
+	EXPECT_EQ(loaded.task_id, "task");
+	EXPECT_EQ(loaded.start_scene.name, "start");
+	ASSERT_EQ(loaded.sub_trajectory.size(), 2u);
+	EXPECT_EQ(loaded.sub_trajectory[1].trajectory, solution.sub_trajectory[1].trajectory);
+	EXPECT_EQ(loaded.sub_trajectory[1].scene_diff.name, "end");
+	EXPECT_EQ(loaded.sub_trajectory[1].execution_info, solution.sub_trajectory[1].execution_info);
+	EXPECT_EQ(loaded.sub_trajectory[1].info.stage_id, 2u);
+
+	EXPECT_THROW(file.solution(2), std::out_of_range);
+	EXPECT_THROW(SolutionFile(path + ".missing"), std::runtime_error);
+}
+
+TEST(SolutionRing, readWrite) {
+	moveit_task_constructor_msgs::Solution solution;
+	solution.task_id = "task";
+	solution.sub_trajectory.resize(1);
+	solution.sub_trajectory[0].trajectory.joint_trajectory.joint_names = { "a", "b" };
+
+	const std::string name = "mtc_test_ring_" + std::to_string(getpid());
+	auto writer = SolutionRing::create(name, 4 * ros::serialization::serializationLength(solution));
+	auto reader = SolutionRing::open(name);
+	EXPECT_EQ(reader->instance(), writer->instance());
+
+	moveit_task_constructor_msgs::SolutionHandle first, handle;
+	ASSERT_TRUE(writer->write(solution, first));
+	EXPECT_EQ(first.task_id, "task");
+
+	moveit_task_constructor_msgs::Solution loaded;
+	ASSERT_TRUE(reader->read(first, loaded));
+	EXPECT_EQ(loaded, solution);
+
+	// wrapping around overwrites the first blob
+	for (size_t i = 0; i < 4; ++i)
+		ASSERT_TRUE(writer->write(solution, handle));
+	EXPECT_FALSE(reader->read(first, loaded));
+	EXPECT_TRUE(reader->read(handle, loaded));
+
+	// handles of another ring instance are rejected
+	handle.instance ^= 1;
+	EXPECT_FALSE(reader->read(handle, loaded));
+
+	// blobs exceeding the capacity are refused
+	solution.sub_trajectory.resize(10, solution.sub_trajectory[0]);
+	EXPECT_FALSE(writer->write(solution, handle));
+	EXPECT_THROW(reader->write(solution, handle), std::logic_error);
+
+	writer.reset();  // unlinks the segment
+	EXPECT_THROW(SolutionRing::open(name), std::runtime_error);
+}
+
+TEST(GraspDatabase, lookup) {
+	// grasps 0..2 recorded along a line of object positions, grasp 3 at a rotated object
+	std::vector<GraspDatabase::Entry> entries;
+	for (size_t i = 0; i < 50; ++i) {
+		GraspDatabase::Entry e;
+		e.object_pose = Eigen::Translation3d(0.01 * i, 0.0, 0.0) * Eigen::Isometry3d::Identity();
+		e.grasp_pose = Eigen::Translation3d(0.0, 0.0, 0.1) * Eigen::Isometry3d::Identity();
+		e.joint_positions = { double(i), 0.0 };
+		e.grasp_id = i % 3;
+		e.cost = i;
+		entries.push_back(e);
+	}
+	GraspDatabase::Entry rotated = entries[10];
+	rotated.object_pose = rotated.object_pose * Eigen::AngleAxisd(M_PI_2, Eigen::Vector3d::UnitZ());
+	rotated.grasp_id = 3;
+	entries.push_back(rotated);
+
+	const std::string path = testing::TempDir() + "grasps.mtc";
+	GraspDatabase::write(path, "base", { "a", "b" }, entries);
+	EXPECT_THROW(GraspDatabase::write(path + ".invalid", "base", { "a" }, entries), std::runtime_error);
+
+	GraspDatabase db(path);
+	ASSERT_EQ(db.size(), entries.size());
+	EXPECT_EQ(db.referenceFrame(), "base");
+	EXPECT_EQ(db.jointNames(), (std::vector<std::string>{ "a", "b" }));
+
+	// closest entry per grasp id, ignoring the rotated object
+	std::vector<GraspDatabase::Match> matches =
+	    db.lookup(Eigen::Translation3d(0.101, 0.0, 0.0) * Eigen::Isometry3d::Identity(), 0.015, 0.1);
+	ASSERT_EQ(matches.size(), 3u);
+	EXPECT_EQ(db.jointPositions(matches[0].index)[0], 10.0);
+	EXPECT_EQ(db.graspId(matches[0].index), 1u);
+	EXPECT_EQ(db.cost(matches[0].index), 10.0);
+	EXPECT_TRUE(db.graspPose(matches[0].index).isApprox(entries[0].grasp_pose));
+	for (const auto& m : matches)
+		EXPECT_NEAR(db.objectPose(m.index).translation().x(), 0.1, 0.015);
+
+	// the rotated object is found when allowing for the rotation
+	matches = db.lookup(rotated.object_pose, 0.005, 0.1);
+	ASSERT_EQ(matches.size(), 1u);
+	EXPECT_EQ(db.graspId(matches[0].index), 3u);
+
+	EXPECT_TRUE(db.lookup(Eigen::Translation3d(1.0, 0.0, 0.0) * Eigen::Isometry3d::Identity(), 0.1, 0.1).empty());
+	EXPECT_THROW(GraspDatabase(path + ".missing"), std::runtime_error);
+}
+
+TEST(Stage, memoryUsage) {
+	StandaloneGeneratorMockup g{ PredefinedCosts::constant(0.0) };
+	g.init(getModel());
+	EXPECT_EQ(g.memoryUsage().total(), 0u);
+
+	g.compute();
+	const MemoryUsage usage = g.memoryUsage();
+	EXPECT_GT(usage.states, 0u);
+	EXPECT_GT(usage.scenes, 0u);
+	EXPECT_GT(usage.trajectories, 0u);
+	EXPECT_EQ(usage.failures, 0u);
+
+	g.reset();
+	EXPECT_EQ(g.memoryUsage().total(), 0u);
+}
+
+TEST(Stage, failureCounts) {
+	// generator failing with alternating comments
+	struct FailingGenerator : public StandaloneGeneratorMockup
+	{
+		size_t calls = 0;
+		void compute() override {
+			SubTrajectory trajectory;
+			trajectory.markAsFailure(++calls % 3 ? "collision" : "constraints violated");
+			spawn(InterfaceState(ps_), std::move(trajectory));
+		}
+	} g;
+	g.init(getModel());
+	for (size_t i = 0; i < 6; ++i)
+		g.compute();
+	g.silentFailure();
+
+	// failures are counted, even if not stored
+	EXPECT_TRUE(g.failures().empty());
+	EXPECT_EQ(g.numFailures(), 7u);
+	EXPECT_EQ(g.failureCounts(),
+	          (std::map<std::string, size_t>{ { "", 1 }, { "collision", 4 }, { "constraints violated", 2 } }));
+
+	std::stringstream ss;
+	g.explainFailure(ss);
+	EXPECT_EQ(ss.str(), ": collision (4x), constraints violated (2x)");
+
+	g.reset();
+	EXPECT_TRUE(g.failureCounts().empty());
+}
+
+TEST(Stage, lazyFailureComments) {
+	// generator failing with lazily generated details
+	struct FailingGenerator : public StandaloneGeneratorMockup
+	{
+		size_t generated = 0;
+		void compute() override {
+			SubTrajectory trajectory;
+			trajectory.markAsFailure("collision");
+			trajectory.setCommentGenerator([this] { return " between " + std::to_string(++generated) + " links"; });
+			spawn(InterfaceState(ps_), std::move(trajectory));
+		}
+	} g;
+	g.init(getModel());
+	g.compute();
+	g.compute();
+
+	// dropped failures don't generate details and are counted by their summary
+	EXPECT_EQ(g.generated, 0u);
+	EXPECT_EQ(g.failureCounts(), (std::map<std::string, size_t>{ { "collision", 2 } }));
+
+	SubTrajectory trajectory;
+	trajectory.markAsFailure("collision");
+	trajectory.setCommentGenerator([] { return " between 2 links"; });
+	EXPECT_EQ(trajectory.commentSummary(), "collision");
+	EXPECT_EQ(trajectory.comment(), "collision between 2 links");
+	EXPECT_EQ(trajectory.commentSummary(), trajectory.comment());
+
+	// details are generated once, even if accessed concurrently
+	std::atomic<unsigned int> calls{ 0 };
+	SubTrajectory shared;
+	shared.markAsFailure("collision");
+	shared.setCommentGenerator([&calls] {
+		++calls;
+		return std::string(" between 2 links");
+	});
+	std::atomic<unsigned int> mismatches{ 0 };
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i)
+		threads.emplace_back([&] {
+			if (shared.comment() != "collision between 2 links")
+				++mismatches;
+		});
+	for (auto& thread : threads)
+		thread.join();
+	EXPECT_EQ(calls, 1u);
+	EXPECT_EQ(mismatches, 0u);
+}
+
+TEST(Stage, trace) {
+	StandaloneGeneratorMockup g{ PredefinedCosts::constant(0.0) };
+	g.setName("traced \"generator\"");
+	g.init(getModel());
+
+	g.pimpl()->runCompute();  // not recorded
+	Tracer::instance().start();
+	g.pimpl()->runCompute();
+	Tracer::instance().stop();
+	g.pimpl()->runCompute();  // not recorded
+
+	std::stringstream ss;
+	Tracer::instance().write(ss);
+	const std::string trace = ss.str();
+	EXPECT_NE(trace.find(R"("name":"compute","cat":"stage","ph":"X")"), std::string::npos) << trace;
+	EXPECT_NE(trace.find(R"("stage":"traced \"generator\"")"), std::string::npos) << trace;
+	EXPECT_EQ(trace.find("compute"), trace.rfind("compute")) << "expected a single compute event";
+}
+
+TEST(Stage, eventLog) {
+	StandaloneGeneratorMockup g{ PredefinedCosts::constant(2.0) };
+	g.init(getModel());
+
+	EventLog log(8);
+	log.setStageName(7, "generator");
+	g.pimpl()->setEventLog(&log, 7);
+	g.pimpl()->runCompute();
+
+	auto types = [](const EventLog::Contents& c) {
+		std::vector<int> result;
+		for (const auto& e : c.events)
+			result.push_back(e.type);
+		return result;
+	};
+	EventLog::Contents c = log.contents();
+	EXPECT_EQ(types(c), std::vector<int>({ EventLog::COMPUTE_BEGIN, EventLog::SOLUTION, EventLog::STATE,
+	                                       EventLog::STATE, EventLog::COMPUTE_END }));
+	for (const auto& e : c.events)
+		EXPECT_EQ(e.stage, 7u);
+	EXPECT_EQ(c.events[1].value, 2.0);
+	EXPECT_EQ(c.events[2].detail, Interface::BACKWARD);
+	EXPECT_EQ(c.events[3].detail, Interface::FORWARD);
+
+	// the ring keeps the latest events only
+	g.pimpl()->runCompute();
+	EXPECT_EQ(log.recorded(), 10u);
+	c = log.contents();
+	ASSERT_EQ(c.events.size(), 8u);
+	EXPECT_EQ(c.events.front().type, EventLog::SOLUTION);
+
+	// round trip through the binary format
+	std::stringstream ss;
+	log.write(ss);
+	const EventLog::Contents decoded = EventLog::read(ss);
+	EXPECT_EQ(decoded.recorded, 10u);
+	EXPECT_EQ(decoded.stages.at(7), "generator");
+	EXPECT_EQ(types(decoded), types(c));
+	EXPECT_EQ(decoded.events.back().time, c.events.back().time);
+
+	std::stringstream text;
+	EventLog::print(text, decoded);
+	EXPECT_NE(text.str().find("2 older events were overwritten"), std::string::npos) << text.str();
+	EXPECT_NE(text.str().find("COMPUTE_END 'generator'[7]"), std::string::npos) << text.str();
+
+	std::stringstream garbage("not a log");
+	EXPECT_THROW(EventLog::read(garbage), std::runtime_error);
+}
+
 TEST(ComputeIK, init) {
 	auto g = std::make_unique<GeneratorMockup>();
 	stages::ComputeIK ik("ik", std::move(g));
@@ -77,6 +582,254 @@ TEST(ComputeIK, init) {
 	EXPECT_NO_THROW(ik.init(robot_model));
 }
 
+TEST(GenerateGraspPose, init) {
+	GeneratorMockup monitored;
+	stages::GenerateGraspPose grasp("grasp");
+	grasp.setMonitoredStage(&monitored);
+	grasp.setEndEffector("eef");
+	grasp.setObject("object");
+	moveit_msgs::RobotState pregrasp;
+	pregrasp.is_diff = true;
+	grasp.setPreGraspPose(pregrasp);
+	moveit::core::RobotModelPtr robot_model = getModel();
+	EXPECT_NO_THROW(grasp.init(robot_model));
+
+	// angle_delta determines the number of candidates
+	for (double angle_delta : { 0.0, std::numeric_limits<double>::quiet_NaN(), INF }) {
+		grasp.setAngleDelta(angle_delta);
+		EXPECT_THROW(grasp.init(robot_model), InitStageException) << "angle_delta: " << angle_delta;
+	}
+	grasp.setAngleDelta(-0.1);
+	EXPECT_NO_THROW(grasp.init(robot_model));
+}
+
+// GenerateRandomPose sampling x and y around the origin, recording the positions of spawned target poses
+struct GenerateRandomPoseTest : public testing::Test
+{
+	Task t;
+	stages::GenerateRandomPose* random;
+	std::vector<std::pair<double, double>> positions;  // in order of spawning
+
+	GenerateRandomPoseTest() {
+		t.setRobotModel(getModel());
+		auto ref = new GeneratorMockup();
+		t.add(Stage::pointer(ref));
+		t.add(std::make_unique<ConnectMockup>());
+		random = new stages::GenerateRandomPose("random");
+		t.add(Stage::pointer(random));
+
+		random->setMonitoredStage(ref);
+		geometry_msgs::PoseStamped seed;
+		seed.pose.orientation.w = 1.0;
+		random->setPose(seed);
+		random->sampleDimension<std::uniform_real_distribution>(stages::GenerateRandomPose::X, 0.1);
+		random->sampleDimension<std::uniform_real_distribution>(stages::GenerateRandomPose::Y, 0.1);
+		random->setMaxSolutions(5);
+
+		random->addSolutionCallback([this](const SolutionBase& s) {
+			const auto& p = s.end()->properties().get<geometry_msgs::PoseStamped>("target_pose").pose.position;
+			positions.emplace_back(p.x, p.y);
+		});
+	}
+
+	std::vector<std::pair<double, double>> sample() {
+		positions.clear();
+		t.reset();
+		EXPECT_TRUE(t.plan());
+		return positions;
+	}
+};
+
+TEST_F(GenerateRandomPoseTest, reproducibleSamples) {
+	// seed pose, followed by the Halton sequence of bases 2 and 3, mapped onto the range [-0.05, 0.05]
+	random->setQuasiRandom(true);
+	const auto halton = sample();
+	const std::vector<std::pair<double, double>> unit = {
+		{ 0.5, 0.5 }, { 1. / 2, 1. / 3 }, { 1. / 4, 2. / 3 }, { 3. / 4, 1. / 9 }, { 1. / 8, 4. / 9 }
+	};
+	ASSERT_EQ(halton.size(), unit.size());
+	for (size_t i = 0; i < unit.size(); ++i) {
+		EXPECT_NEAR(halton[i].first, (unit[i].first - 0.5) * 0.1, 1e-9) << "sample " << i;
+		EXPECT_NEAR(halton[i].second, (unit[i].second - 0.5) * 0.1, 1e-9) << "sample " << i;
+	}
+	// the sequence restarts on reset
+	EXPECT_EQ(sample(), halton);
+
+	// pseudo-random samples are reproducible via the seed of the stage's engine
+	random->setQuasiRandom(false);
+	random->setSeed(42);
+	const auto first = sample();
+	EXPECT_EQ(first.size(), unit.size());
+	random->setSeed(42);
+	EXPECT_EQ(sample(), first);
+	EXPECT_NE(first, halton);
+}
+
+TEST_F(GenerateRandomPoseTest, resumableSampling) {
+	random->setSeed(7);
+	const auto all_at_once = sample();
+	ASSERT_EQ(all_at_once.size(), 5u);
+	EXPECT_EQ(random->computeTimeStatistics().count(), 1u);
+
+	// a single pose per compute() call, yielding the same samples
+	random->setResumable(true);
+	random->setSeed(7);
+	EXPECT_EQ(sample(), all_at_once);
+	EXPECT_EQ(random->computeTimeStatistics().count(), 5u);
+}
+
+TEST(Merge, sharedGroupAndWaypoints) {
+	auto model = getModel();
+	const moveit::core::JointModelGroup* group = model->getJointModelGroup("group");
+	const moveit::core::JointModelGroup* eef = model->getJointModelGroup("eef_group");
+
+	// merged groups are shared, independent of the order of groups
+	moveit::core::JointModelGroupPtr merged = mergedGroup({ group, eef });
+	ASSERT_TRUE(merged);
+	EXPECT_EQ(mergedGroup({ eef, group }), merged);
+	EXPECT_EQ(merged->getVariableCount(), group->getVariableCount() + eef->getVariableCount());
+
+	// sub trajectories of 3 and 2 waypoints, the shorter one keeps its final positions
+	moveit::core::RobotState base(model);
+	base.setToDefaultValues();
+	auto trajectory = [&base](const moveit::core::JointModelGroup* jmg, size_t num_waypoints, double step) {
+		auto result = std::make_shared<robot_trajectory::RobotTrajectory>(base.getRobotModel(), jmg);
+		moveit::core::RobotState state(base);
+		for (size_t i = 0; i < num_waypoints; ++i) {
+			state.setJointGroupPositions(jmg, std::vector<double>(jmg->getVariableCount(), step * i));
+			state.update();
+			result->addSuffixWayPoint(state, 0.1);
+		}
+		return result;
+	};
+	moveit::core::JointModelGroup* jmg = merged.get();
+	trajectory_processing::TimeOptimalTrajectoryGeneration timing;
+	auto result = merge({ trajectory(group, 3, 0.1), trajectory(eef, 2, -0.2) }, base, jmg, timing);
+	ASSERT_TRUE(result);
+	EXPECT_EQ(jmg, merged.get()) << "given group is used";
+	ASSERT_EQ(result->getWayPointCount(), 3u);
+	std::vector<double> positions;
+	for (size_t i = 0; i < 3; ++i) {
+		result->getWayPoint(i).copyJointGroupPositions(group, positions);
+		for (double p : positions)
+			EXPECT_NEAR(p, 0.1 * i, 1e-10) << "waypoint " << i;
+		result->getWayPoint(i).copyJointGroupPositions(eef, positions);
+		for (double p : positions)
+			EXPECT_NEAR(p, -0.2 * std::min<size_t>(i, 1), 1e-10) << "waypoint " << i;
+	}
+}
+
+TEST(GeneratePlacePose, sampledPlacements) {
+	Task t;
+	auto model = getModel();
+	t.setRobotModel(model);
+
+	// sphere attached to the robot, and a box next to the nominal place pose (1, 0, 0)
+	constexpr double RADIUS = 0.02;
+	auto scene = std::make_shared<PlanningScene>(model);
+	scene->getCurrentStateNonConst().setToDefaultValues();
+	moveit_msgs::AttachedCollisionObject aco;
+	aco.link_name = "tip";
+	aco.object.id = "object";
+	aco.object.header.frame_id = "tip";
+	aco.object.operation = aco.object.ADD;
+	aco.object.pose.orientation.w = 1.0;
+	aco.object.primitives.resize(1);
+	aco.object.primitives[0].type = shape_msgs::SolidPrimitive::SPHERE;
+	aco.object.primitives[0].dimensions = { RADIUS };
+	aco.object.primitive_poses.resize(1);
+	aco.object.primitive_poses[0].orientation.w = 1.0;
+	scene->processAttachedCollisionObjectMsg(aco);
+	const Eigen::Vector3d box_center(1.06, 0.0, 0.0);
+	const double box_size = 0.06;
+	scene->getWorldNonConst()->addToObject("box", std::make_shared<shapes::Box>(box_size, box_size, box_size),
+	                                       Eigen::Isometry3d(Eigen::Translation3d(box_center)));
+
+	auto start = new stages::FixedState("start", scene);
+	t.add(Stage::pointer(start));
+	t.add(std::make_unique<ConnectMockup>());
+	auto place = new stages::GeneratePlacePose("place");
+	t.add(Stage::pointer(place));
+	place->setMonitoredStage(start);
+	place->setObject("object");
+	geometry_msgs::PoseStamped pose;
+	pose.header.frame_id = model->getModelFrame();
+	pose.pose.position.x = 1.0;
+	pose.pose.orientation.w = 1.0;
+	place->setPose(pose);
+	place->setSampleCount(20);
+	place->setSampleRadius(0.1);
+	place->setClearance(0.05);
+
+	// positions and costs of spawned placements, in order of spawning
+	std::vector<std::pair<Eigen::Vector3d, double>> spawned;
+	place->addSolutionCallback([&spawned](const SolutionBase& s) {
+		if (s.isFailure())
+			return;
+		Eigen::Isometry3d target;
+		tf2::fromMsg(s.end()->properties().get<geometry_msgs::PoseStamped>("target_pose").pose, target);
+		spawned.emplace_back(target.translation(), s.cost());
+	});
+	EXPECT_TRUE(t.plan());
+
+	// 10 rotations about z of the nominal placement and of each of the 20 samples
+	EXPECT_GE(spawned.size(), 10u) << "nominal placements are free";
+	EXPECT_LT(spawned.size(), 210u) << "placements colliding with the box are rejected";
+	for (size_t i = 0; i < spawned.size(); ++i) {
+		// the sphere's hull points don't penetrate the box
+		const Eigen::Vector3d& center = spawned[i].first;
+		for (int axis = 0; axis < 3; ++axis)
+			for (double sign : { -1.0, 1.0 }) {
+				const Eigen::Vector3d point = center + sign * (RADIUS - 0.002) * Eigen::Vector3d::Unit(axis);
+				EXPECT_FALSE(((point - box_center).cwiseAbs().array() < 0.5 * box_size).all()) << "placement " << i;
+			}
+		// placements are spawned in order of cost, penalizing a small clearance
+		if (i > 0)
+			EXPECT_LE(spawned[i - 1].second, spawned[i].second) << "placement " << i;
+	}
+	ASSERT_FALSE(spawned.empty());
+	EXPECT_GT(spawned.back().second, 0.0) << "placements close to the box have a higher cost";
+}
+
+TEST(IKCache, lookup) {
+	moveit::core::RobotModelPtr robot_model = getModel();
+	const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup("group");
+	const moveit::core::LinkModel* link = robot_model->getLinkModel("link2");
+	PlanningScene scene(robot_model);
+	const std::size_t signature = IKCache::collisionSignature(scene, jmg);
+
+	// fresh directory for persisted entries
+	std::string dir = testing::TempDir() + "ik_cache.XXXXXX";
+	ASSERT_TRUE(mkdtemp(&dir[0]));
+
+	IKCache cache(0.01, 0.01, 10, dir);
+	Eigen::Isometry3d target = Eigen::Translation3d(0.501, 0.202, 0.0) * Eigen::Isometry3d::Identity();
+	Eigen::Isometry3d nearby = Eigen::Translation3d(0.502, 0.203, 0.0) * Eigen::Isometry3d::Identity();
+	Eigen::Isometry3d far = Eigen::Translation3d(0.6, 0.2, 0.0) * Eigen::Isometry3d::Identity();
+
+	// poses within the same cell share their key
+	IKCache::Key key = cache.computeKey(jmg, link, target, signature);
+	EXPECT_EQ(key, cache.computeKey(jmg, link, nearby, signature));
+	EXPECT_NE(key, cache.computeKey(jmg, link, far, signature));
+	EXPECT_NE(key, cache.computeKey(jmg, link, target, signature + 1));
+	EXPECT_TRUE(cache.matches(nearby, target));
+	EXPECT_FALSE(cache.matches(far, target));
+
+	IKCache::Solutions solutions;
+	EXPECT_FALSE(cache.lookup(key, solutions));
+	cache.store(key, { { 0.1, -0.2 }, { 0.3, 0.4 } });
+	ASSERT_TRUE(cache.lookup(key, solutions));
+	EXPECT_EQ(solutions, (IKCache::Solutions{ { 0.1, -0.2 }, { 0.3, 0.4 } }));
+
+	// a new cache instance finds persisted entries
+	IKCache reloaded(0.01, 0.01, 10, dir);
+	EXPECT_EQ(reloaded.size(), 0u);
+	ASSERT_TRUE(reloaded.lookup(key, solutions));
+	ASSERT_EQ(solutions.size(), 2u);
+	EXPECT_DOUBLE_EQ(solutions[0][1], -0.2);
+	EXPECT_EQ(reloaded.size(), 1u);
+}
+
 TEST(ModifyPlanningScene, allowCollisions) {
 	auto s = std::make_unique<stages::ModifyPlanningScene>();
 	std::string first = "foo", second = "boom";
@@ -87,6 +840,63 @@ TEST(ModifyPlanningScene, allowCollisions) {
 	s->allowCollisions("foo", std::set<const char*>{ "ab", "abc" }, false);
 }
 
+TEST(SceneBuilder, coalesce) {
+	auto op = [](const std::string& id, int8_t operation) {
+		moveit_msgs::CollisionObject o;
+		o.id = id;
+		o.operation = operation;
+		return o;
+	};
+	using CO = moveit_msgs::CollisionObject;
+	auto result = SceneBuilder::coalesce({ op("a", CO::ADD), op("a", CO::MOVE), op("b", CO::MOVE), op("a", CO::REMOVE),
+	                                       op("b", CO::ADD), op("a", CO::MOVE) });
+	std::vector<std::pair<std::string, int8_t>> ops;
+	for (const auto& o : result)
+		ops.emplace_back(o.id, o.operation);
+	EXPECT_EQ(ops, (std::vector<std::pair<std::string, int8_t>>{
+	                   { "a", CO::REMOVE }, { "b", CO::ADD }, { "a", CO::MOVE } }));
+}
+
+#if MOVEIT_VERSION_GE(1, 1, 6)
+TEST(SceneBuilder, sharedShapes) {
+	auto scene = std::make_shared<PlanningScene>(getModel());
+	moveit_msgs::CollisionObject o;
+	o.id = "box";
+	o.header.frame_id = scene->getPlanningFrame();
+	o.operation = moveit_msgs::CollisionObject::ADD;
+	o.pose.orientation.w = 1.0;
+	o.primitives.resize(1);
+	o.primitives[0].type = shape_msgs::SolidPrimitive::BOX;
+	o.primitives[0].dimensions = { 0.1, 0.2, 0.3 };
+	o.primitive_poses.resize(1);
+	o.primitive_poses[0].orientation.w = 1.0;
+
+	SceneBuilder::ShapeCache cache;
+	SceneBuilder first(scene, &cache);
+	SceneBuilder second(scene, &cache);
+	EXPECT_TRUE(first.processCollisionObject(o));
+	EXPECT_TRUE(second.processCollisionObject(o));
+	auto a = first.scene()->getWorld()->getObject("box");
+	auto b = second.scene()->getWorld()->getObject("box");
+	ASSERT_TRUE(a && b);
+	EXPECT_EQ(a->shapes_[0], b->shapes_[0]) << "diffs should share identical shapes";
+	EXPECT_EQ(cache.size(), 1u);
+	EXPECT_FALSE(scene->getWorld()->hasObject("box")) << "parent scene should be unchanged";
+
+	// shifting keeps shapes
+	second.shiftObject("box", Eigen::Isometry3d(Eigen::Translation3d(0.1, 0, 0)));
+	b = second.scene()->getWorld()->getObject("box");
+	EXPECT_EQ(a->shapes_[0], b->shapes_[0]);
+	EXPECT_DOUBLE_EQ(b->pose_.translation().x(), 0.1);
+
+	// changed geometry is reconstructed
+	o.primitives[0].dimensions = { 0.3, 0.2, 0.1 };
+	SceneBuilder third(scene, &cache);
+	EXPECT_TRUE(third.processCollisionObject(o));
+	EXPECT_NE(third.scene()->getWorld()->getObject("box")->shapes_[0], a->shapes_[0]);
+}
+#endif
+
 void spawnObject(PlanningScene& scene, const std::string& name, int type,
                  const std::vector<double>& pos = { 0, 0, 0 }) {
 	moveit_msgs::CollisionObject o;
@@ -144,6 +954,9 @@ TEST(Connect, compatible) {
 	spawnObject(*other, "object", shape_msgs::SolidPrimitive::CYLINDER);
 	EXPECT_TRUE(connect.compatible(scene, other)) << "same objects";
 
+	spawnObject(*other, "other", shape_msgs::SolidPrimitive::CYLINDER);
+	EXPECT_FALSE(connect.compatible(scene, other)) << "additional object";
+
 	// attached objects
 	other = scene->diff();
 	attachObject(*scene, "object", "tip", true);
@@ -0,0 +1,78 @@
+#include <moveit/task_constructor/thread_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace moveit::task_constructor;
+
+TEST(ThreadPool, runAll) {
+	ThreadPool pool(2);
+	std::atomic<int> sum{ 0 };
+	std::vector<ThreadPool::Job> jobs;
+	for (int i = 1; i <= 10; ++i)
+		jobs.emplace_back([&sum, i] { sum += i; });
+	pool.run(std::move(jobs));
+	EXPECT_EQ(sum, 55);
+}
+
+TEST(ThreadPool, rethrow) {
+	ThreadPool pool(1);
+	std::atomic<int> finished{ 0 };
+	std::vector<ThreadPool::Job> jobs;
+	jobs.emplace_back([] { throw std::runtime_error("failed"); });
+	for (int i = 0; i < 3; ++i)
+		jobs.emplace_back([&finished] { ++finished; });
+	EXPECT_THROW(pool.run(std::move(jobs)), std::runtime_error);
+	EXPECT_EQ(finished, 3);  // all other jobs were still run
+}
+
+TEST(ThreadPool, nested) {
+	ThreadPool pool(1);
+	std::atomic<int> count{ 0 };
+	std::vector<ThreadPool::Job> outer;
+	for (int i = 0; i < 4; ++i)
+		outer.emplace_back([&pool, &count] {
+			std::vector<ThreadPool::Job> inner;
+			for (int j = 0; j < 4; ++j)
+				inner.emplace_back([&count] { ++count; });
+			pool.run(std::move(inner));
+		});
+	pool.run(std::move(outer));
+	EXPECT_EQ(count, 16);
+}
+
+// a thread waiting in run() must not pick up jobs of other batches
+TEST(ThreadPool, onlyHelpOwnBatch) {
+	ThreadPool pool(1);
+	std::mutex mutex;
+	std::vector<std::thread::id> others;  // threads that ran the other batch's jobs
+	std::atomic<bool> queued{ false };
+
+	std::thread other([&] {
+		std::vector<ThreadPool::Job> jobs;
+		for (int i = 0; i < 4; ++i)
+			jobs.emplace_back([&] {
+				queued = true;
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				std::lock_guard<std::mutex> lock(mutex);
+				others.push_back(std::this_thread::get_id());
+			});
+		pool.run(std::move(jobs));
+	});
+	while (!queued)
+		std::this_thread::yield();
+
+	std::atomic<int> own{ 0 };
+	pool.run({ [&own] { ++own; }, [&own] { ++own; } });
+	EXPECT_EQ(own, 2);
+	other.join();
+
+	ASSERT_EQ(others.size(), 4u);
+	for (const auto& id : others)
+		EXPECT_NE(id, std::this_thread::get_id());
+}
@@ -78,6 +78,9 @@ public:
 
 	bool execute();
 
+	/// access the underlying task, e.g. for monitoring
+	const moveit::task_constructor::TaskPtr& task() const { return task_; }
+
 private:
 	void loadParameters();
 
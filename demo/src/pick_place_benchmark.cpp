@@ -0,0 +1,173 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Bielefeld University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Bielefeld University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Benchmark the pick and place demo across randomized object layouts
+*/
+
+// ROS
+#include <ros/ros.h>
+
+// MTC pick/place demo implementation
+#include <moveit_task_constructor_demo/pick_place_task.h>
+
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sys/resource.h>
+
+constexpr char LOGNAME[] = "pick_place_benchmark";
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct RunResult
+{
+	std::vector<double> object_pose;
+	bool success = false;
+	size_t num_solutions = 0;
+	double time_to_first = -1.0;  // seconds, -1 if nothing was found
+	double time_to_k = -1.0;
+	double total_time = 0.0;
+	long peak_rss_kb = 0;
+	std::vector<std::pair<std::string, double>> stage_times;  // total compute time per stage
+};
+
+long peakMemory() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+RunResult runLayout(ros::NodeHandle& pnh, const std::vector<double>& object_pose, size_t k) {
+	RunResult result;
+	result.object_pose = object_pose;
+	pnh.setParam("object_pose", object_pose);
+	moveit_task_constructor_demo::setupDemoScene(pnh);
+
+	moveit_task_constructor_demo::PickPlaceTask pick_place_task("pick_place_task", pnh);
+	if (!pick_place_task.init())
+		return result;
+
+	moveit::task_constructor::Task& task = *pick_place_task.task();
+	const auto start = Clock::now();
+	auto elapsed = [&start]() { return std::chrono::duration<double>(Clock::now() - start).count(); };
+	task.addTaskCallback([&](const moveit::task_constructor::Task& t) {
+		if (result.time_to_first < 0 && t.numSolutions() > 0)
+			result.time_to_first = elapsed();
+		if (result.time_to_k < 0 && t.numSolutions() >= k)
+			result.time_to_k = elapsed();
+	});
+
+	result.success = pick_place_task.plan();
+	result.total_time = elapsed();
+	result.num_solutions = task.numSolutions();
+	result.peak_rss_kb = peakMemory();
+	task.stages()->traverseRecursively([&result](const moveit::task_constructor::Stage& stage, unsigned int /*depth*/) {
+		result.stage_times.emplace_back(stage.name(), stage.getTotalComputeTime());
+		return true;
+	});
+	return result;
+}
+
+void writeCSV(const std::string& file, const std::vector<RunResult>& results) {
+	std::ofstream os(file);
+	os << "run,object_x,object_y,success,num_solutions,time_to_first,time_to_k,total_time,peak_rss_kb";
+	if (!results.empty())
+		for (const auto& stage : results.front().stage_times)
+			os << "," << stage.first;
+	os << "\n";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const RunResult& r = results[i];
+		os << i << "," << r.object_pose[0] << "," << r.object_pose[1] << "," << r.success << "," << r.num_solutions
+		   << "," << r.time_to_first << "," << r.time_to_k << "," << r.total_time << "," << r.peak_rss_kb;
+		for (const auto& stage : r.stage_times)
+			os << "," << stage.second;
+		os << "\n";
+	}
+}
+
+void writeJSON(const std::string& file, const std::vector<RunResult>& results) {
+	std::ofstream os(file);
+	os << "[\n";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const RunResult& r = results[i];
+		os << "  {\"run\": " << i << ", \"object_pose\": [";
+		for (size_t j = 0; j < r.object_pose.size(); ++j)
+			os << (j ? ", " : "") << r.object_pose[j];
+		os << "], \"success\": " << (r.success ? "true" : "false") << ", \"num_solutions\": " << r.num_solutions
+		   << ", \"time_to_first\": " << r.time_to_first << ", \"time_to_k\": " << r.time_to_k
+		   << ", \"total_time\": " << r.total_time << ", \"peak_rss_kb\": " << r.peak_rss_kb << ", \"stage_times\": {";
+		for (size_t j = 0; j < r.stage_times.size(); ++j)
+			os << (j ? ", " : "") << "\"" << r.stage_times[j].first << "\": " << r.stage_times[j].second;
+		os << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	os << "]\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+	ros::init(argc, argv, "pick_place_benchmark");
+	ros::NodeHandle nh, pnh("~");
+
+	ros::AsyncSpinner spinner(1);
+	spinner.start();
+
+	const int runs = pnh.param("runs", 10);
+	const int k = pnh.param("max_solutions", 10);
+	std::mt19937 rng(pnh.param("seed", 42));
+
+	// sample object positions on the table, keeping a margin to its border
+	std::vector<double> table_pose, table_dimensions, object_pose;
+	pnh.getParam("table_pose", table_pose);
+	pnh.getParam("table_dimensions", table_dimensions);
+	pnh.getParam("object_pose", object_pose);
+	const double margin = pnh.param("margin", 0.1);
+	std::uniform_real_distribution<double> dx(-0.5 * table_dimensions[0] + margin, 0.5 * table_dimensions[0] - margin);
+	std::uniform_real_distribution<double> dy(-0.5 * table_dimensions[1] + margin, 0.5 * table_dimensions[1] - margin);
+
+	std::vector<RunResult> results;
+	for (int i = 0; i < runs && ros::ok(); ++i) {
+		std::vector<double> pose = object_pose;
+		pose[0] = table_pose[0] + dx(rng);
+		pose[1] = table_pose[1] + dy(rng);
+		results.push_back(runLayout(pnh, pose, k));
+		const RunResult& r = results.back();
+		ROS_INFO_NAMED(LOGNAME, "run %d: %zu solutions, first after %.3fs, total %.3fs", i, r.num_solutions,
+		               r.time_to_first, r.total_time);
+	}
+
+	writeCSV(pnh.param<std::string>("csv_file", "pick_place_benchmark.csv"), results);
+	writeJSON(pnh.param<std::string>("json_file", "pick_place_benchmark.json"), results);
+	return 0;
+}
@@ -4,6 +4,7 @@
 #include <geometry_msgs/PoseStamped.h>
 #include <std_msgs/ColorRGBA.h>
 #include <visualization_msgs/Marker.h>
+#include <vector>
 
 namespace urdf {
 class Geometry;
@@ -79,6 +80,14 @@ visualization_msgs::Marker& makeText(visualization_msgs::Marker& m, const std::s
 /// create marker from urdf::Geom
 visualization_msgs::Marker& makeFromGeometry(visualization_msgs::Marker& m, const urdf::Geometry& geom);
 
+/** create a single LINE_LIST marker showing the (red, green, blue) axes of all given frames
+ *
+ * Frames are specified relative to the marker's pose. Rendering a single line list is much cheaper
+ * than rendering three cylinders per frame as created by appendFrame().
+ */
+visualization_msgs::Marker& makeFrames(visualization_msgs::Marker& m, const std::vector<geometry_msgs::Pose>& frames,
+                                       double scale = 1.0, double line_width_fraction = 0.05);
+
 template <typename T>
 void appendFrame(T& container, const geometry_msgs::PoseStamped& pose, double scale = 1.0,
                  const std::string& ns = "frame", double diameter_fraction = 0.1) {
@@ -105,4 +114,17 @@ void appendFrame(T& container, const geometry_msgs::PoseStamped& pose, double sc
 	container.push_back(m);
 }
 
+/// append frame markers for all given poses (sharing a common header), reserving space once
+template <typename T>
+void appendFrames(T& container, const std_msgs::Header& header, const std::vector<geometry_msgs::Pose>& poses,
+                  double scale = 1.0, const std::string& ns = "frame", double diameter_fraction = 0.1) {
+	container.reserve(container.size() + 3 * poses.size());
+	geometry_msgs::PoseStamped pose;
+	pose.header = header;
+	for (const auto& p : poses) {
+		pose.pose = p;
+		appendFrame(container, pose, scale, ns, diameter_fraction);
+	}
+}
+
 }  // namespace rviz_marker_tools
@@ -328,4 +328,27 @@ vm::Marker& makeFromGeometry(vm::Marker& m, const urdf::Geometry& geom) {
 	return m;
 }
 
+vm::Marker& makeFrames(vm::Marker& m, const std::vector<geometry_msgs::Pose>& frames, double scale,
+                       double line_width_fraction) {
+	m.scale.x = scale * line_width_fraction;
+	m.scale.y = m.scale.z = 0.0;
+	prepareMarker(m, vm::Marker::LINE_LIST);
+	m.points.reserve(6 * frames.size());
+	m.colors.reserve(6 * frames.size());
+
+	const std_msgs::ColorRGBA axis_colors[3] = { getColor(RED), getColor(GREEN), getColor(BLUE) };
+	Eigen::Isometry3d frame;
+	for (const auto& f : frames) {
+		tf2::fromMsg(f, frame);
+		const geometry_msgs::Point origin = tf2::toMsg(Eigen::Vector3d(frame.translation()));
+		for (int axis = 0; axis < 3; ++axis) {
+			m.points.push_back(origin);
+			m.points.push_back(tf2::toMsg(Eigen::Vector3d(frame * (scale * Eigen::Vector3d::Unit(axis)))));
+			m.colors.push_back(axis_colors[axis]);
+			m.colors.push_back(axis_colors[axis]);
+		}
+	}
+	return m;
+}
+
 }  // namespace rviz_marker_tools
@@ -36,46 +36,88 @@
 
 #include "job_queue.h"
 #include <ros/console.h>
+#include <unordered_set>
 
 namespace moveit {
 namespace tools {
 
 JobQueue::JobQueue(QObject* parent) : QObject(parent) {}
 
-void JobQueue::addJob(const std::function<void()>& job) {
-	boost::unique_lock<boost::mutex> ulock(jobs_mutex_);
-	jobs_.push_back(job);
+JobQueue::~JobQueue() {
+	clear();
+}
+
+void JobQueue::addJob(const std::function<void()>& job, size_t key) {
+	Job* j = new Job{ job, key, head_.load(std::memory_order_relaxed) };
+	while (!head_.compare_exchange_weak(j->next, j, std::memory_order_release, std::memory_order_relaxed))
+		;
+	++pending_;
+}
+
+JobQueue::Job* JobQueue::takeJobs() {
+	Job* stack = head_.exchange(nullptr, std::memory_order_acquire);
+
+	// reverse order, starting from the most recent job, which supersedes older ones with the same key
+	std::unordered_set<size_t> keys;
+	Job* fifo = nullptr;
+	size_t dropped = 0;
+	while (stack) {
+		Job* next = stack->next;
+		if (stack->key && !keys.insert(stack->key).second) {
+			delete stack;
+			++dropped;
+		} else {
+			stack->next = fifo;
+			fifo = stack;
+		}
+		stack = next;
+	}
+	if (dropped)
+		finished(dropped);
+	return fifo;
+}
+
+void JobQueue::finished(size_t num) {
+	if ((pending_ -= num) == 0) {
+		boost::unique_lock<boost::mutex> ulock(idle_mutex_);
+		idle_condition_.notify_all();
+	}
 }
 
 void JobQueue::clear() {
-	jobs_.clear();
+	size_t num = 0;
+	for (Job* j = takeJobs(); j; ++num) {
+		Job* next = j->next;
+		delete j;
+		j = next;
+	}
+	finished(num);
 }
 
 size_t JobQueue::numPending() {
-	boost::unique_lock<boost::mutex> ulock(jobs_mutex_);
-	return jobs_.size();
+	return pending_;
 }
 
 void JobQueue::waitForAllJobs() {
-	boost::unique_lock<boost::mutex> ulock(jobs_mutex_);
-	while (!jobs_.empty())
+	boost::unique_lock<boost::mutex> ulock(idle_mutex_);
+	while (pending_ > 0)
 		idle_condition_.wait(ulock);
 }
 
 void JobQueue::executeJobs() {
-	boost::unique_lock<boost::mutex> ulock(jobs_mutex_);
-	while (!jobs_.empty()) {
-		std::function<void()> fn = jobs_.front();
-		jobs_.pop_front();
-		ulock.unlock();
+	// only execute jobs pending at this time, jobs added meanwhile are handled in the next batch
+	size_t num = 0;
+	for (Job* j = takeJobs(); j; ++num) {
 		try {
-			fn();
+			j->fn();
 		} catch (std::exception& ex) {
 			ROS_ERROR("Exception caught executing main loop job: %s", ex.what());
 		}
-		ulock.lock();
+		Job* next = j->next;
+		delete j;
+		j = next;
 	}
-	idle_condition_.notify_all();
+	finished(num);
 }
 }  // namespace tools
 }  // namespace moveit
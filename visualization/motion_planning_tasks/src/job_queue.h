@@ -37,8 +37,7 @@
 #pragma once
 #include <QObject>
 
-#include <QObject>
-#include <deque>
+#include <atomic>
 #include <functional>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
@@ -46,17 +45,38 @@
 namespace moveit {
 namespace tools {
 
-/** Job Queue (of std::functions) */
+/** Job Queue (of std::functions)
+ *
+ * Arbitrary threads can add jobs without locking, while a single consumer thread
+ * (usually the GUI thread) executes all pending jobs in a batch via executeJobs().
+ * Jobs added with a non-zero key supersede all pending jobs with the same key,
+ * e.g. to skip outdated updates of the same item.
+ */
 class JobQueue : public QObject
 {
 	Q_OBJECT
-	boost::mutex jobs_mutex_;
-	std::deque<std::function<void()> > jobs_;
+	struct Job
+	{
+		std::function<void()> fn;
+		size_t key;
+		Job* next;
+	};
+	// LIFO stack of pending jobs, reversed to FIFO order when executing them
+	std::atomic<Job*> head_{ nullptr };
+	std::atomic<size_t> pending_{ 0 };
+
+	boost::mutex idle_mutex_;
 	boost::condition_variable idle_condition_;
 
+	// take all pending jobs in FIFO order, dropping superseded ones
+	Job* takeJobs();
+	void finished(size_t num);
+
 public:
 	explicit JobQueue(QObject* parent = nullptr);
-	void addJob(const std::function<void()>& job);
+	~JobQueue() override;
+
+	void addJob(const std::function<void()>& job, size_t key = 0);
 	void clear();
 	size_t numPending();
 
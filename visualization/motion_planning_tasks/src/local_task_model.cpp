@@ -37,12 +37,17 @@
 #include "local_task_model.h"
 #include "factory_model.h"
 #include "properties/property_factory.h"
+#include <moveit/task_constructor/introspection.h>
+#include <moveit/task_constructor/storage.h>
 #include <rviz/properties/property_tree_model.h>
 
 #include <ros/console.h>
 
+#include <QLocale>
 #include <QMimeData>
 
+#include <algorithm>
+
 using namespace moveit::task_constructor;
 
 namespace moveit_rviz_plugin {
@@ -153,7 +158,9 @@ QVariant LocalTaskModel::data(const QModelIndex& index, int role) const {
 				case 1:
 					return static_cast<uint>(n->solutions().size());
 				case 2:
-					return 0;
+					return static_cast<uint>(n->numFailures());
+				case 3:
+					return QLocale().toString(n->getTotalComputeTime(), 'f', 4);
 			}
 			break;
 	}
@@ -220,19 +227,73 @@ bool LocalTaskModel::dropMimeData(const QMimeData* mime, Qt::DropAction /*action
 	return true;
 }
 
-QModelIndex LocalTaskModel::indexFromStageId(size_t /*id*/) const {
-	// TODO implement
-	return QModelIndex();
+QModelIndex LocalTaskModel::indexFromStageId(size_t id) const {
+	const Introspection& introspection = const_cast<LocalTaskModel*>(this)->introspection();
+	Node* result = nullptr;
+	stages()->traverseRecursively([&](const Stage& stage, int /* depth */) -> bool {
+		if (introspection.stageId(&stage) != id)
+			return true;
+		result = const_cast<Node*>(&stage);
+		return false;
+	});
+	return result ? index(result) : QModelIndex();
 }
 
-QAbstractItemModel* LocalTaskModel::getSolutionModel(const QModelIndex& /*index*/) {
-	// TODO implement
-	return nullptr;
+void LocalTaskModel::updateSolutionModel(const Node& n, RemoteSolutionModel& model) {
+	Introspection& introspection = this->introspection();
+	std::vector<uint32_t> successful, failed;
+	successful.reserve(n.solutions().size());
+	for (const auto& s : n.solutions())
+		successful.push_back(introspection.solutionId(*s));
+	for (const auto& s : n.failures())
+		failed.push_back(introspection.solutionId(*s));
+	model.processSolutionIDs(successful, failed, n.numFailures(), n.getTotalComputeTime());
+
+	auto set_data = [&](const SolutionBaseConstPtr& s) {
+		model.setSolutionData(introspection.solutionId(*s), s->cost(), QString::fromStdString(s->comment()));
+	};
+	std::for_each(n.solutions().begin(), n.solutions().end(), set_data);
+	std::for_each(n.failures().begin(), n.failures().end(), set_data);
 }
 
-DisplaySolutionPtr LocalTaskModel::getSolution(const QModelIndex& /*index*/) {
-	// TODO implement
-	return DisplaySolutionPtr();
+QAbstractItemModel* LocalTaskModel::getSolutionModel(const QModelIndex& index) {
+	Node* n = node(index);
+	if (!n)
+		return nullptr;
+	auto it_inserted = solutions_.insert(std::make_pair(n, nullptr));
+	if (it_inserted.second)  // newly inserted, create new model
+		it_inserted.first->second = new RemoteSolutionModel(this);
+	updateSolutionModel(*n, *it_inserted.first->second);
+	return it_inserted.first->second;
+}
+
+const SolutionBase* LocalTaskModel::solution(uint32_t id) {
+	Introspection& introspection = this->introspection();
+	const SolutionBase* result = nullptr;
+	auto find = [&](const SolutionBaseConstPtr& s) {
+		if (!result && introspection.solutionId(*s) == id)
+			result = s.get();
+	};
+	// look up the solution in the stages themselves: a cached pointer could refer to a removed stage
+	stages()->traverseRecursively([&](const Stage& stage, int /* depth */) -> bool {
+		std::for_each(stage.solutions().begin(), stage.solutions().end(), find);
+		std::for_each(stage.failures().begin(), stage.failures().end(), find);
+		return !result;
+	});
+	return result;
+}
+
+DisplaySolutionPtr LocalTaskModel::getSolution(const QModelIndex& index) {
+	Q_ASSERT(index.isValid());
+
+	uint32_t id = index.sibling(index.row(), 0).data(Qt::UserRole).toUInt();
+	const SolutionBase* s = solution(id);
+	if (!s)
+		return DisplaySolutionPtr();
+
+	DisplaySolutionPtr result(new DisplaySolution);
+	result->setFromSolution(*s, &introspection());
+	return result;
 }
 
 rviz::PropertyTreeModel* LocalTaskModel::getPropertyModel(const QModelIndex& index) {
@@ -37,10 +37,16 @@
 #pragma once
 
 #include "task_list_model.h"
+#include "remote_task_model.h"
 #include <moveit/task_constructor/task.h>
 
 namespace moveit_rviz_plugin {
 
+/** Model representing an in-process task
+ *
+ *  Solutions and statistics are directly read from the task's stages, without any msg conversion.
+ *  The task is only accessed from the GUI thread, such that no locking is required.
+ */
 class LocalTaskModel : public BaseTaskModel, public moveit::task_constructor::Task
 {
 	Q_OBJECT
@@ -48,10 +54,16 @@ class LocalTaskModel : public BaseTaskModel, public moveit::task_constructor::Ta
 	Node* root_;
 	StageFactoryPtr stage_factory_;
 	std::map<Node*, rviz::PropertyTreeModel*> properties_;
+	std::map<Node*, RemoteSolutionModel*> solutions_;
 
 	inline Node* node(const QModelIndex& index) const;
 	QModelIndex index(Node* n) const;
 
+	/// update model from the stage's current solutions and statistics
+	void updateSolutionModel(const Node& n, RemoteSolutionModel& model);
+	/// find solution with given (introspection) id among the in-process stages
+	const moveit::task_constructor::SolutionBase* solution(uint32_t id);
+
 public:
 	LocalTaskModel(ContainerBase::pointer&& container, const planning_scene::PlanningSceneConstPtr& scene,
 	               rviz::DisplayContext* display_context, QObject* parent = nullptr);
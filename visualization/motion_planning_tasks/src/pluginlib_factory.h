@@ -48,6 +48,8 @@
 #include <pluginlib/class_loader.hpp>
 #include <rviz/load_resource.h>
 #include <functional>
+#include <memory>
+#include <mutex>
 #endif
 
 #include <rviz/factory.h>
@@ -56,6 +58,10 @@ namespace moveit_rviz_plugin {
 
 /** Templated factory to create objects of a given pluginlib base class type.
  *  This is a slightly modified version of rviz::PluginlibFactory, providing a custom mime type.
+ *
+ *  The pluginlib::ClassLoader, crawling all packages for plugin descriptions, is only created
+ *  when class information is requested for the first time. Plugin libraries are only loaded
+ *  when a class is instantiated via makeRaw().
  */
 template <class Type>
 class PluginlibFactory : public rviz::Factory
@@ -72,10 +78,9 @@ private:
 
 public:
 	PluginlibFactory(const QString& package, const QString& base_class_type)
-	  : mime_type_(QString("application/%1/%2").arg(package, base_class_type)) {
-		class_loader_ = new pluginlib::ClassLoader<Type>(package.toStdString(), base_class_type.toStdString());
-	}
-	~PluginlibFactory() override { delete class_loader_; }
+	  : mime_type_(QString("application/%1/%2").arg(package, base_class_type))
+	  , package_(package.toStdString())
+	  , base_class_type_(base_class_type.toStdString()) {}
 
 	/// retrieve mime type used for given factory
 	QString mimeType() const { return mime_type_; }
@@ -84,7 +89,10 @@ public:
 		QStringList ids;
 		for (const auto& record : built_ins_)
 			ids.push_back(record.class_id_);
-		for (const auto& id : class_loader_->getDeclaredClasses()) {
+		pluginlib::ClassLoader<Type>* class_loader = loader();
+		if (!class_loader)
+			return ids;
+		for (const auto& id : class_loader->getDeclaredClasses()) {
 			QString sid = QString::fromStdString(id);
 			if (ids.contains(sid))
 				continue;  // built_in take precedence
@@ -98,7 +106,8 @@ public:
 		if (it != built_ins_.end()) {
 			return it->description_;
 		}
-		return QString::fromStdString(class_loader_->getClassDescription(class_id.toStdString()));
+		pluginlib::ClassLoader<Type>* class_loader = loader();
+		return class_loader ? QString::fromStdString(class_loader->getClassDescription(class_id.toStdString())) : "";
 	}
 
 	QString getClassName(const QString& class_id) const override {
@@ -106,7 +115,8 @@ public:
 		if (it != built_ins_.end()) {
 			return it->name_;
 		}
-		return QString::fromStdString(class_loader_->getName(class_id.toStdString()));
+		pluginlib::ClassLoader<Type>* class_loader = loader();
+		return class_loader ? QString::fromStdString(class_loader->getName(class_id.toStdString())) : "";
 	}
 
 	QString getClassPackage(const QString& class_id) const override {
@@ -114,7 +124,8 @@ public:
 		if (it != built_ins_.end()) {
 			return it->package_;
 		}
-		return QString::fromStdString(class_loader_->getClassPackage(class_id.toStdString()));
+		pluginlib::ClassLoader<Type>* class_loader = loader();
+		return class_loader ? QString::fromStdString(class_loader->getClassPackage(class_id.toStdString())) : "";
 	}
 
 	virtual QString getPluginManifestPath(const QString& class_id) const {
@@ -122,7 +133,8 @@ public:
 		if (it != built_ins_.end()) {
 			return "";
 		}
-		return QString::fromStdString(class_loader_->getPluginManifestPath(class_id.toStdString()));
+		pluginlib::ClassLoader<Type>* class_loader = loader();
+		return class_loader ? QString::fromStdString(class_loader->getPluginManifestPath(class_id.toStdString())) : "";
 	}
 
 	QIcon getIcon(const QString& class_id) const override {
@@ -172,8 +184,14 @@ public:
 			}
 			return instance;
 		}
+		pluginlib::ClassLoader<Type>* class_loader = loader();
+		if (!class_loader) {
+			if (error_return)
+				*error_return = "Failed to create plugin loader for class '" + class_id + "'.";
+			return nullptr;
+		}
 		try {
-			return class_loader_->createUnmanagedInstance(class_id.toStdString());
+			return class_loader->createUnmanagedInstance(class_id.toStdString());
 		} catch (pluginlib::PluginlibException& ex) {
 			ROS_ERROR("PluginlibFactory: The plugin for class '%s' failed to load.  Error: %s", qPrintable(class_id),
 			          ex.what());
@@ -185,8 +203,24 @@ public:
 	}
 
 private:
+	/// create the class loader on first use (nullptr if this failed)
+	pluginlib::ClassLoader<Type>* loader() const {
+		std::call_once(loader_once_, [this] {
+			try {
+				class_loader_ = std::make_unique<pluginlib::ClassLoader<Type>>(package_, base_class_type_);
+			} catch (const pluginlib::PluginlibException& ex) {
+				ROS_ERROR("PluginlibFactory: Failed to create class loader for '%s'.  Error: %s", base_class_type_.c_str(),
+				          ex.what());
+			}
+		});
+		return class_loader_.get();
+	}
+
 	const QString mime_type_;
-	pluginlib::ClassLoader<Type>* class_loader_;
+	const std::string package_;
+	const std::string base_class_type_;
+	mutable std::once_flag loader_once_;
+	mutable std::unique_ptr<pluginlib::ClassLoader<Type>> class_loader_;
 	QHash<QString, BuiltInClassRecord> built_ins_;
 };
 }  // namespace moveit_rviz_plugin
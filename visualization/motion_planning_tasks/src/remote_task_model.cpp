@@ -42,9 +42,15 @@
 #include <moveit/task_constructor/properties.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit_task_constructor_msgs/GetSolution.h>
+#include <moveit_task_constructor_msgs/GetSolutions.h>
 #include <rviz/properties/property_tree_model.h>
 #include <rviz/properties/string_property.h>
 #include <ros/console.h>
+#include <ros/serialization.h>
+
+#include <QApplication>
+#include <QPointer>
+#include <thread>
 
 #include <QApplication>
 #include <QPalette>
@@ -54,6 +60,21 @@ using namespace moveit::task_constructor;
 
 namespace moveit_rviz_plugin {
 
+// number of best top-level solutions to retrieve in advance
+static const size_t PREFETCH_SOLUTIONS = 3;
+// default memory limit for cached solutions
+static const size_t DEFAULT_SOLUTION_CACHE_LIMIT = 256 << 20;
+
+// human-readable size of given number of bytes
+static QString formatBytes(uint64_t bytes) {
+	static const char* units[] = { "B", "KiB", "MiB", "GiB" };
+	double value = bytes;
+	int unit = 0;
+	for (; value >= 1024.0 && unit < 3; ++unit)
+		value /= 1024.0;
+	return unit == 0 ? QString("%1 B").arg(bytes) : QString("%1 %2").arg(QLocale().toString(value, 'f', 1), units[unit]);
+}
+
 enum NodeFlag
 {
 	WAS_VISITED = 0x01,  // indicate that model should emit change notifications
@@ -64,17 +85,22 @@ using NodeFlags = QFlags<NodeFlag>;
 struct RemoteTaskModel::Node
 {
 	Node* parent_;
+	int row_;  // index in parent's children_
 	std::vector<std::unique_ptr<Node>> children_;
 	QString name_;
 	InterfaceFlags interface_flags_;
 	NodeFlags node_flags_;
 	std::unique_ptr<RemoteSolutionModel> solutions_;
-	std::unique_ptr<rviz::PropertyTreeModel> property_tree_;
+	double p95_compute_time_ = 0.0;
+	uint64_t memory_ = 0;
+	bool on_critical_path_ = false;
+	std::unique_ptr<rviz::PropertyTreeModel> property_tree_;  // created on first request only
 	std::map<std::string, Property> properties_;
+	// reported properties, not yet parsed as long as property_tree_ wasn't requested
+	std::vector<moveit_task_constructor_msgs::Property> pending_properties_;
 
-	inline Node(Node* parent) : parent_(parent) {
+	inline Node(Node* parent) : parent_(parent), row_(parent ? parent->children_.size() : 0) {
 		solutions_.reset(new RemoteSolutionModel());
-		property_tree_.reset(new rviz::PropertyTreeModel(new rviz::Property()));
 	}
 
 	bool setName(const QString& name) {
@@ -89,11 +115,19 @@ struct RemoteTaskModel::Node
 	rviz::Property* createProperty(const moveit_task_constructor_msgs::Property& prop, rviz::Property* old,
 	                               const planning_scene::PlanningSceneConstPtr& scene_,
 	                               rviz::DisplayContext* display_context_);
+	rviz::PropertyTreeModel* propertyTree(const planning_scene::PlanningSceneConstPtr& scene_,
+	                                      rviz::DisplayContext* display_context_);
 };
 
 void RemoteTaskModel::Node::setProperties(const std::vector<moveit_task_constructor_msgs::Property>& props,
                                           const planning_scene::PlanningSceneConstPtr& scene_,
                                           rviz::DisplayContext* display_context_) {
+	// defer (YAML) parsing and widget creation until the properties are actually shown
+	if (!property_tree_) {
+		pending_properties_ = props;
+		return;
+	}
+
 	// insert properties in same order as reported in description
 	rviz::Property* root = property_tree_->getRoot();
 	int index = 0;  // current child index in root
@@ -126,8 +160,12 @@ rviz::Property* RemoteTaskModel::Node::createProperty(const moveit_task_construc
                                                       const planning_scene::PlanningSceneConstPtr& scene_,
                                                       rviz::DisplayContext* display_context_) {
 	auto& factory = PropertyFactory::instance();
-	// try to deserialize from msg (using registered functions)
-	boost::any value = Property::deserialize(prop.type, prop.value);
+	// try to decode binary value or deserialize string value from msg (using registered functions)
+	boost::any value;
+	if (!prop.value_binary.empty())
+		value = Property::decode(prop.type, std::string(prop.value_binary.begin(), prop.value_binary.end()));
+	if (value.empty())
+		value = Property::deserialize(prop.type, prop.value);
 	if (!value.empty()) {  // if successful, create rviz::Property from mtc::Property using factory methods
 		auto it = properties_.insert(std::make_pair(prop.name, Property())).first;
 		it->second.setDescription(prop.description);
@@ -143,6 +181,17 @@ rviz::Property* RemoteTaskModel::Node::createProperty(const moveit_task_construc
 	return factory.createDefault(prop.name, prop.type, prop.description, prop.value, old);
 }
 
+rviz::PropertyTreeModel* RemoteTaskModel::Node::propertyTree(const planning_scene::PlanningSceneConstPtr& scene_,
+                                                              rviz::DisplayContext* display_context_) {
+	if (!property_tree_) {
+		property_tree_.reset(new rviz::PropertyTreeModel(new rviz::Property()));
+		std::vector<moveit_task_constructor_msgs::Property> props;
+		props.swap(pending_properties_);
+		setProperties(props, scene_, display_context_);
+	}
+	return property_tree_.get();
+}
+
 // return Node* corresponding to index
 RemoteTaskModel::Node* RemoteTaskModel::node(const QModelIndex& index) const {
 	if (!index.isValid())
@@ -170,23 +219,38 @@ QModelIndex RemoteTaskModel::index(const Node* n) const {
 	if (n == root_)
 		return QModelIndex();
 
-	Node* parent = n->parent_;
-
 	// the internal pointer refers to the parent node of n
-	for (int row = 0, end = parent->children_.size(); row != end; ++row)
-		if (parent->children_.at(row).get() == n)
-			return createIndex(row, 0, parent);
-	Q_ASSERT(false);
-	return QModelIndex();
+	Q_ASSERT(n->parent_->children_.at(n->row_).get() == n);
+	return createIndex(n->row_, 0, n->parent_);
+}
+
+// emit a single dataChanged() signal per parent, covering all rows of the given nodes
+void RemoteTaskModel::notifyChanged(const std::vector<Node*>& nodes, int first_column, int last_column) {
+	std::map<Node*, std::pair<int, int>> ranges;  // parent -> (first row, last row)
+	for (const Node* n : nodes) {
+		if (n == root_)
+			continue;
+		auto it = ranges.insert(std::make_pair(n->parent_, std::make_pair(n->row_, n->row_))).first;
+		it->second.first = std::min(it->second.first, n->row_);
+		it->second.second = std::max(it->second.second, n->row_);
+	}
+	for (const auto& range : ranges) {
+		QModelIndex parent = index(range.first);
+		dataChanged(index(range.second.first, first_column, parent), index(range.second.second, last_column, parent));
+	}
 }
 
 RemoteTaskModel::RemoteTaskModel(ros::NodeHandle& nh, const std::string& service_name,
+                                 const std::string& batch_service_name,
                                  const planning_scene::PlanningSceneConstPtr& scene,
                                  rviz::DisplayContext* display_context, QObject* parent)
-  : BaseTaskModel(scene, display_context, parent), root_(new Node(nullptr)) {
+  : BaseTaskModel(scene, display_context, parent)
+  , root_(new Node(nullptr))
+  , cache_limit_(DEFAULT_SOLUTION_CACHE_LIMIT) {
 	id_to_stage_[0] = root_;  // root node has ID 0
 	// service to request solutions
 	get_solution_client_ = nh.serviceClient<moveit_task_constructor_msgs::GetSolution>(service_name);
+	get_solutions_client_ = nh.serviceClient<moveit_task_constructor_msgs::GetSolutions>(batch_service_name);
 }
 
 RemoteTaskModel::~RemoteTaskModel() {
@@ -257,6 +321,19 @@ QVariant RemoteTaskModel::data(const QModelIndex& index, int role) const {
 			if (index.column() == 0 && index.parent().isValid())
 				return flowIcon(n->interface_flags_);
 			break;
+		case Qt::BackgroundRole:
+			if (heatmap_ != HEATMAP_NONE) {
+				double value = heatmapValue(*n);
+				if (value >= 0.0)
+					return heatmapColor(value);
+			}
+			break;
+		case Qt::ToolTipRole:
+			if (index.column() == 0 && !n->solutions_->memoryDetails().isEmpty())
+				return n->solutions_->memoryDetails();
+			if (index.column() == 3 && !n->solutions_->computeTimeDetails().isEmpty())
+				return n->solutions_->computeTimeDetails();
+			break;
 	}
 
 	return BaseTaskModel::data(index, role);
@@ -278,33 +355,47 @@ QModelIndex RemoteTaskModel::indexFromStageId(size_t id) const {
 }
 
 void RemoteTaskModel::processStageDescriptions(const moveit_task_constructor_msgs::TaskDescription::_stages_type& msg) {
-	// iterate over descriptions and create new / update existing nodes where needed
-	for (const auto& s : msg) {
+	// create new nodes first, inserting consecutive siblings with a single row insertion
+	for (auto it = msg.begin(), end = msg.end(); it != end;) {
+		if (id_to_stage_.count(it->id)) {
+			++it;
+			continue;
+		}
 		// find parent node for stage s, this should always exist
-		auto parent_it = id_to_stage_.find(s.parent_id);
+		auto parent_it = id_to_stage_.find(it->parent_id);
 		if (parent_it == id_to_stage_.end()) {
-			ROS_ERROR_NAMED("TaskListModel", "No parent found for stage %d (%s)", s.id, s.name.c_str());
+			ROS_ERROR_NAMED("TaskListModel", "No parent found for stage %d (%s)", it->id, it->name.c_str());
+			++it;
 			continue;
 		}
 		Node* parent = parent_it->second;
 
-		Node*& n = id_to_stage_[s.id];
-		if (!n) {  // create a new Node if neccessary
-			// only emit notify signal if parent node was ever visited
-			bool notify = parent->node_flags_ & WAS_VISITED;
-			QModelIndex parent_idx = index(parent);
-			int row = parent->children_.size();
-
-			if (notify)
-				beginInsertRows(parent_idx, row, row);
+		// collect the run of new stages sharing this parent
+		auto run_end = it;
+		while (run_end != end && run_end->parent_id == it->parent_id && !id_to_stage_.count(run_end->id))
+			++run_end;
+
+		// only emit notify signal if parent node was ever visited
+		bool notify = parent->node_flags_ & WAS_VISITED;
+		int row = parent->children_.size();
+		if (notify)
+			beginInsertRows(index(parent), row, row + (run_end - it) - 1);
+		for (; it != run_end; ++it) {
 			parent->children_.push_back(std::make_unique<Node>(parent));
-			if (notify)
-				endInsertRows();
-
 			// store Node* in id_to_stage_
-			n = parent->children_.back().get();
+			id_to_stage_[it->id] = parent->children_.back().get();
 		}
-		Q_ASSERT(n->parent_ == parent);
+		if (notify)
+			endInsertRows();
+	}
+
+	// update content of nodes, collecting changed ones for a batched notification
+	std::vector<Node*> changed_nodes;
+	for (const auto& s : msg) {
+		Node* n = node(s.id);
+		if (!n)
+			continue;  // missing parent, reported above
+		Q_ASSERT(n->parent_ == node(s.parent_id));
 
 		// set content of stage
 		bool changed = false;
@@ -324,20 +415,24 @@ void RemoteTaskModel::processStageDescriptions(const moveit_task_constructor_msg
 		changed |= (n->interface_flags_ != old_flags);
 
 		// emit notify about model changes when node was already visited
-		if (changed && (n->node_flags_ & WAS_VISITED)) {
-			QModelIndex idx = index(n);
-			dataChanged(idx, idx.sibling(idx.row(), 2));
-		}
+		if (changed && (n->node_flags_ & WAS_VISITED))
+			changed_nodes.push_back(n);
 	}
+	notifyChanged(changed_nodes, 0, 2);
 
 	if (msg.empty()) {
 		flags_ |= IS_DESTROYED;
+		// ids of streamed data are reused after a reset
+		streamed_trajectories_.clear();
+		streamed_scenes_.clear();
 		dataChanged(index(0, 0), index(0, 2));
 	}
 }
 
-void RemoteTaskModel::processStageStatistics(const moveit_task_constructor_msgs::TaskStatistics::_stages_type& msg) {
+void RemoteTaskModel::processStageStatistics(const moveit_task_constructor_msgs::TaskStatistics::_stages_type& msg,
+                                             bool incremental) {
 	// iterate over statistics and update node's solutions where needed
+	std::vector<Node*> changed_nodes;
 	for (const auto& s : msg) {
 		// find node for stage s, this should always exist
 		auto it = id_to_stage_.find(s.id);
@@ -346,14 +441,108 @@ void RemoteTaskModel::processStageStatistics(const moveit_task_constructor_msgs:
 			continue;
 		}
 		Node* n = it->second;
-		n->solutions_->processSolutionIDs(s.solved, s.failed, s.num_failed, s.total_compute_time);
+		n->solutions_->processSolutionIDs(s.solved, s.failed, s.num_failed, s.total_compute_time, incremental);
+		if (s.num_computes > 0) {
+			const QLocale locale;
+			auto ms = [&locale](double seconds) { return locale.toString(1000. * seconds, 'f', 2); };
+			n->solutions_->setComputeTimeDetails(
+			    tr("%1 computes, time [ms]: min %2, mean %3, p95 %4, max %5\nplanner: %6 s")
+			        .arg(s.num_computes)
+			        .arg(ms(s.min_compute_time), ms(s.mean_compute_time), ms(s.p95_compute_time), ms(s.max_compute_time))
+			        .arg(locale.toString(s.total_planner_time, 'f', 4)));
+		} else
+			n->solutions_->setComputeTimeDetails(QString());
+		n->p95_compute_time_ = s.p95_compute_time;
+
+		const uint64_t memory =
+		    s.memory_states + s.memory_scenes + s.memory_trajectories + s.memory_markers + s.memory_failures;
+		n->memory_ = memory;
+		if (memory > 0) {
+			n->solutions_->setMemoryDetails(
+			    tr("memory: %1\nstates: %2, scenes: %3\ntrajectories: %4, markers: %5\nfailures: %6")
+			        .arg(formatBytes(memory))
+			        .arg(formatBytes(s.memory_states), formatBytes(s.memory_scenes), formatBytes(s.memory_trajectories),
+			             formatBytes(s.memory_markers), formatBytes(s.memory_failures)));
+		} else
+			n->solutions_->setMemoryDetails(QString());
+
+		// retrieve the best top-level solutions in advance
+		if (s.id == 1)
+			prefetchSolutions(std::vector<uint32_t>(s.solved.begin(),
+			                                        s.solved.begin() + std::min<size_t>(s.solved.size(), PREFETCH_SOLUTIONS)));
 
 		// emit notify about model changes when node was already visited
-		if (n->node_flags_ & WAS_VISITED) {
-			QModelIndex idx = index(n);
-			dataChanged(idx.sibling(idx.row(), 1), idx.sibling(idx.row(), 3));
+		if (n->node_flags_ & WAS_VISITED)
+			changed_nodes.push_back(n);
+	}
+
+	max_p95_compute_time_ = 0.0;
+	max_memory_ = 0;
+	for (const auto& pair : id_to_stage_) {
+		max_p95_compute_time_ = std::max(max_p95_compute_time_, pair.second->p95_compute_time_);
+		max_memory_ = std::max(max_memory_, pair.second->memory_);
+	}
+
+	if (heatmap_ == HEATMAP_NONE)
+		notifyChanged(changed_nodes, 1, 3);
+	else {  // colors are relative to all stages
+		if (heatmap_ == HEATMAP_CRITICAL_PATH)
+			updateCriticalPath();
+		notifyHeatmapChanged();
+	}
+}
+
+double RemoteTaskModel::heatmapValue(const Node& n) const {
+	if (heatmap_ == HEATMAP_CRITICAL_PATH && !n.on_critical_path_)
+		return -1.0;
+
+	switch (heatmap_) {
+		case HEATMAP_CRITICAL_PATH:  // stages on the path are colored by their time share
+		case HEATMAP_TIME_SHARE: {
+			const Node* task = node(1);
+			const double total = task ? task->solutions_->totalComputeTime() : 0.0;
+			return total > 0.0 ? n.solutions_->totalComputeTime() / total : -1.0;
 		}
+		case HEATMAP_P95_TIME:
+			return max_p95_compute_time_ > 0.0 ? n.p95_compute_time_ / max_p95_compute_time_ : -1.0;
+		case HEATMAP_MEMORY:
+			return max_memory_ > 0 ? static_cast<double>(n.memory_) / max_memory_ : -1.0;
 	}
+	return -1.0;
+}
+
+void RemoteTaskModel::updateCriticalPath() {
+	for (const auto& pair : id_to_stage_)
+		pair.second->on_critical_path_ = false;
+
+	const Node* task = node(1);
+	auto it = task ? id_to_solution_.find(task->solutions_->bestSolutionId()) : id_to_solution_.end();
+	if (it == id_to_solution_.end())
+		return;  // best solution not (yet) available, it is prefetched on arrival of statistics
+
+	// mark creators of all sub trajectories and their ancestors
+	const DisplaySolution& solution = *it->second.solution;
+	for (size_t i = 0; i < solution.numSubSolutions(); ++i)
+		for (Node* n = node(solution.creatorId(DisplaySolution::IndexPair(i, 0))); n && !n->on_critical_path_;
+		     n = n->parent_)
+			n->on_critical_path_ = true;
+}
+
+void RemoteTaskModel::notifyHeatmapChanged() {
+	std::vector<Node*> nodes;
+	for (const auto& pair : id_to_stage_)
+		if (pair.second->node_flags_ & WAS_VISITED)
+			nodes.push_back(pair.second);
+	notifyChanged(nodes, 0, 3);
+}
+
+void RemoteTaskModel::setHeatmap(int mode) {
+	if (mode == heatmap_)
+		return;
+	heatmap_ = mode;
+	if (heatmap_ == HEATMAP_CRITICAL_PATH)
+		updateCriticalPath();
+	notifyHeatmapChanged();
 }
 
 void RemoteTaskModel::setSolutionData(const moveit_task_constructor_msgs::SolutionInfo& info) {
@@ -363,7 +552,8 @@ void RemoteTaskModel::setSolutionData(const moveit_task_constructor_msgs::Soluti
 		m->setSolutionData(info.id, info.cost, QString::fromStdString(info.comment));
 }
 
-DisplaySolutionPtr RemoteTaskModel::processSolutionMessage(const moveit_task_constructor_msgs::Solution& msg) {
+DisplaySolutionPtr RemoteTaskModel::processSolutionMessage(const moveit_task_constructor_msgs::Solution& msg,
+                                                           uint32_t id) {
 	DisplaySolutionPtr s(new DisplaySolution);
 	s->setFromMessage(scene_->diff(), msg);
 
@@ -373,29 +563,165 @@ DisplaySolutionPtr RemoteTaskModel::processSolutionMessage(const moveit_task_con
 	for (const auto& sub : msg.sub_trajectory)
 		setSolutionData(sub.info);
 
-	// caching is only enabled for top-level solutions (stage_id == 1)
+	// sub trajectories are only cached for top-level solutions (stage_id == 1)
 	// otherwise we would store PlanningScenes over and over
+	std::vector<std::pair<uint32_t, DisplaySolutionPtr>> solutions;
 	if (!msg.sub_solution.empty() && msg.sub_solution.front().info.stage_id == 1 &&
 	    msg.sub_solution.front().info.id != 0) {
 		// cache solution for future use
-		id_to_solution_[msg.sub_solution.front().info.id] = s;
+		solutions.emplace_back(msg.sub_solution.front().info.id, s);
 
 		// cache DisplaySolutions for all individual sub trajectories
 		uint i = 0;
 		for (const auto& t : msg.sub_trajectory) {
 			if (t.info.id == 0)
 				continue;  // invalid id
-			DisplaySolutionPtr& sub =
-			    id_to_solution_.insert(std::make_pair(t.info.id, DisplaySolutionPtr())).first->second;
-			if (!sub)
-				sub.reset(new DisplaySolution(*s, i));
+			if (!id_to_solution_.count(t.info.id))
+				solutions.emplace_back(t.info.id, std::make_shared<DisplaySolution>(*s, i));
 			i++;
 		}
-	}
+	} else if (id != 0)
+		solutions.emplace_back(id, s);
 
+	if (!solutions.empty())
+		cacheSolutions(solutions, ros::serialization::serializationLength(msg));
 	return s;
 }
 
+bool RemoteTaskModel::decodeSolutionStream(const moveit_task_constructor_msgs::SolutionStream& msg,
+                                           moveit_task_constructor_msgs::Solution& solution) {
+	// new trajectories are listed in the order their ids first appear
+	auto next = msg.sub_trajectory.begin();
+	for (uint32_t id : msg.sub_trajectory_id) {
+		if (streamed_trajectories_.count(id))
+			continue;
+		if (next == msg.sub_trajectory.end())
+			return false;  // missed a previous msg
+		streamed_trajectories_.emplace(id, *next++);
+	}
+	if (next != msg.sub_trajectory.end())
+		return false;  // trajectories not referenced: inconsistent with the data received before
+
+	auto scene = streamed_scenes_.find(msg.start_scene_id);
+	if (scene == streamed_scenes_.end()) {
+		if (msg.start_scene_base_id == 0)
+			scene = streamed_scenes_.emplace(msg.start_scene_id, msg.start_scene).first;
+		else {
+			auto base = streamed_scenes_.find(msg.start_scene_base_id);
+			if (base == streamed_scenes_.end())
+				return false;
+			// apply diff to the base scene
+			planning_scene::PlanningScenePtr ps = scene_->diff();
+			ps->setPlanningSceneMsg(base->second);
+			ps->setPlanningSceneDiffMsg(msg.start_scene);
+			scene = streamed_scenes_.emplace(msg.start_scene_id, moveit_msgs::PlanningScene()).first;
+			ps->getPlanningSceneMsg(scene->second);
+		}
+	}
+
+	solution.task_id = msg.task_id;
+	solution.start_scene = scene->second;
+	solution.sub_solution = msg.sub_solution;
+	solution.sub_trajectory.clear();
+	solution.sub_trajectory.reserve(msg.sub_trajectory_id.size());
+	for (uint32_t id : msg.sub_trajectory_id)
+		solution.sub_trajectory.push_back(streamed_trajectories_.at(id));
+	return true;
+}
+
+DisplaySolutionPtr
+RemoteTaskModel::processSolutionStreamMessage(const moveit_task_constructor_msgs::SolutionStream& msg) {
+	moveit_task_constructor_msgs::Solution solution;
+	if (decodeSolutionStream(msg, solution))
+		return processSolutionMessage(solution);
+
+	// fall back to requesting the full solution
+	uint32_t id = !msg.sub_solution.empty() ? msg.sub_solution.front().info.id :
+	                                          (msg.sub_trajectory_id.size() == 1 ? msg.sub_trajectory_id.front() : 0);
+	ROS_WARN_STREAM_NAMED("TaskListModel", "Failed to decode streamed solution " << id);
+	if (id == 0 || (flags_ & IS_DESTROYED))
+		return DisplaySolutionPtr();
+	moveit_task_constructor_msgs::GetSolution srv;
+	srv.request.solution_id = id;
+	if (get_solution_client_.call(srv))
+		return processSolutionMessage(srv.response.solution, id);
+	return DisplaySolutionPtr();
+}
+
+// insert solutions created from a single message into the cache
+void RemoteTaskModel::cacheSolutions(const std::vector<std::pair<uint32_t, DisplaySolutionPtr>>& solutions,
+                                     size_t bytes) {
+	uint32_t key = solutions.front().first;
+	if (id_to_solution_.count(key))
+		return;  // already cached
+	CacheGroup& group = cache_groups_[key];
+	cache_lru_.push_front(key);
+	group.lru = cache_lru_.begin();
+
+	for (const auto& s : solutions)
+		if (id_to_solution_.emplace(s.first, CachedSolution{ s.second, key }).second)
+			group.ids.push_back(s.first);
+	group.bytes += bytes;
+	cache_bytes_ += bytes;
+	shrinkCache();
+
+	// the best solution might have arrived
+	if (heatmap_ == HEATMAP_CRITICAL_PATH) {
+		updateCriticalPath();
+		notifyHeatmapChanged();
+	}
+}
+
+// evict least recently used groups until the cache fits its limit, always keeping the most recent one
+void RemoteTaskModel::shrinkCache() {
+	while (cache_bytes_ > cache_limit_ && cache_lru_.size() > 1) {
+		auto it = cache_groups_.find(cache_lru_.back());
+		for (uint32_t id : it->second.ids)
+			id_to_solution_.erase(id);
+		cache_bytes_ -= it->second.bytes;
+		cache_groups_.erase(it);
+		cache_lru_.pop_back();
+	}
+}
+
+void RemoteTaskModel::setSolutionCacheLimit(size_t bytes) {
+	cache_limit_ = bytes;
+	shrinkCache();
+}
+
+void RemoteTaskModel::prefetchSolutions(const std::vector<uint32_t>& ids) {
+	if (flags_ & IS_DESTROYED)
+		return;
+
+	moveit_task_constructor_msgs::GetSolutions srv;
+	for (uint32_t id : ids)
+		if (!id_to_solution_.count(id) && pending_solutions_.insert(id).second)
+			srv.request.solution_ids.push_back(id);
+	if (srv.request.solution_ids.empty())
+		return;
+
+	// call service in a background thread and process the response in the GUI thread
+	QPointer<RemoteTaskModel> self(this);
+	std::thread([self, client = get_solutions_client_, srv]() mutable {
+		bool success = client.exists() && client.call(srv);
+		QMetaObject::invokeMethod(
+		    qApp,
+		    [self, success, srv = std::move(srv)]() {
+			    if (!self)
+				    return;  // model was destroyed in the meantime
+			    for (size_t i = 0; i < srv.request.solution_ids.size(); ++i) {
+				    uint32_t id = srv.request.solution_ids[i];
+				    self->pending_solutions_.erase(id);
+				    const auto& msg = srv.response.solutions[i];
+				    if (success && !(msg.sub_solution.empty() && msg.sub_trajectory.empty()) &&
+				        !self->id_to_solution_.count(id))
+					    self->processSolutionMessage(msg, id);
+			    }
+		    },
+		    Qt::QueuedConnection);
+	}).detach();
+}
+
 RemoteSolutionModel* RemoteTaskModel::getSolutionModel(uint32_t stage_id) const {
 	Node* n = node(stage_id);
 	return n ? n->solutions_.get() : nullptr;
@@ -422,44 +748,26 @@ DisplaySolutionPtr RemoteTaskModel::getSolution(const QModelIndex& index) {
 			// request solution via service
 			moveit_task_constructor_msgs::GetSolution srv;
 			srv.request.solution_id = id;
-			if (get_solution_client_.call(srv)) {
-				id_to_solution_[id] = result = processSolutionMessage(srv.response.solution);
-				return result;
-			}
+			if (get_solution_client_.call(srv))
+				return processSolutionMessage(srv.response.solution, id);
 			// on failure mark remote task as destroyed: don't retrieve more solutions
 			get_solution_client_.shutdown();
 			flags_ |= IS_DESTROYED;
 		}
 		return result;
 	}
-	return it->second;
+	// mark as most recently used
+	cache_lru_.splice(cache_lru_.begin(), cache_lru_, cache_groups_.at(it->second.group).lru);
+	return it->second.solution;
 }
 
 rviz::PropertyTreeModel* RemoteTaskModel::getPropertyModel(const QModelIndex& index) {
 	Node* n = node(index);
 	if (!n)
 		return nullptr;
-	return n->property_tree_.get();
+	return n->propertyTree(scene_, display_context_);
 }
 
-namespace detail {
-// method used by sorted_ container (requiring an additional dereference to access id)
-template <class T>
-typename T::iterator findById(T& c, decltype((*c.cbegin())->id) id) {
-	return std::find_if(c.begin(), c.end(), [id](const typename T::value_type& item) { return item->id == id; });
-}
-
-// insert new Data item into data_ container
-template <class T>
-typename T::iterator insert(T& c, typename T::value_type&& item) {
-	auto p = std::equal_range(c.begin(), c.end(), item);
-	if (p.first == p.second)  // new item
-		return c.insert(p.second, std::move(item));
-	else
-		return p.first;
-}
-}  // namespace detail
-
 RemoteSolutionModel::RemoteSolutionModel(QObject* parent) : QAbstractTableModel(parent) {}
 
 int RemoteSolutionModel::rowCount(const QModelIndex& /*parent*/) const {
@@ -494,7 +802,7 @@ QVariant RemoteSolutionModel::data(const QModelIndex& index, int role) const {
 	Q_ASSERT(index.isValid());
 	Q_ASSERT(!index.parent().isValid());
 
-	const Data& item = *sorted_[index.row()];
+	const Data& item = sorted_[index.row()]->second;
 
 	switch (role) {
 		case Qt::UserRole:
@@ -537,12 +845,20 @@ QVariant RemoteSolutionModel::data(const QModelIndex& index, int role) const {
 
 void RemoteSolutionModel::setSolutionData(uint32_t id, float cost, const QString& comment) {
 	// retrieve iterator and row corresponding to id
-	auto sit = detail::findById(sorted_, id);
-	int row = (sit != sorted_.end()) ? sit - sorted_.begin() : -1;
-	auto it = (sit != sorted_.end()) ? *sit : detail::insert(data_, Data(id, cost, 0, comment));
+	auto it = data_.find(id);
+	int row = (it != data_.end()) ? rowOf(it) : -1;
+	bool renumbered = false;
+	if (it == data_.end()) {
+		it = data_.emplace(id, Data(id, cost, 0, comment)).first;
+		// assign creation rank, renumbering subsequent items
+		renumbered = std::next(it) != data_.end();
+		uint32_t rank = (it == data_.begin()) ? 0 : std::prev(it)->second.creation_rank;
+		for (auto next = it; next != data_.end(); ++next)
+			next->second.creation_rank = ++rank;
+	}
 
 	QModelIndex tl, br;
-	Data& item = *it;
+	Data& item = it->second;
 	if (item.cost != cost) {
 		item.cost = cost;
 		tl = br = index(row, 1);
@@ -556,8 +872,12 @@ void RemoteSolutionModel::setSolutionData(uint32_t id, float cost, const QString
 	if (tl.isValid())
 		Q_EMIT dataChanged(tl, br);
 
-	if (row < 0 && isVisible(*it))  // item was newly created: inform views
+	if (renumbered || (row >= 0 && sort_column_ == 2 && br.column() == 2))  // order changed
 		sortInternal();
+	else if (row < 0 && isVisible(item)) {  // item was newly created: inform views
+		std::vector<DataMap::iterator> items{ it };
+		insertSorted(items);
+	}
 }
 
 void RemoteSolutionModel::sort(int column, Qt::SortOrder order) {
@@ -573,34 +893,17 @@ void RemoteSolutionModel::sort(int column, Qt::SortOrder order) {
 void RemoteSolutionModel::sortInternal() {
 	Q_EMIT layoutAboutToBeChanged();
 	QModelIndexList old_indexes = persistentIndexList();
-	std::vector<DataList::iterator> old_sorted;
+	std::vector<DataMap::iterator> old_sorted;
 	std::swap(sorted_, old_sorted);
 
 	// create new order in sorted_
 	for (auto it = data_.begin(), end = data_.end(); it != end; ++it)
-		if (isVisible(*it))
+		if (isVisible(it->second))
 			sorted_.push_back(it);
 
-	if (sort_column_ >= 0) {
+	if (sort_column_ >= 0)
 		std::sort(sorted_.begin(), sorted_.end(),
-		          [this](const DataList::iterator& left, const DataList::iterator& right) {
-			          int comp = 0;
-			          switch (sort_column_) {
-				          case 1:  // cost order
-					          if (left->cost_rank < right->cost_rank)
-						          comp = -1;
-					          else if (left->cost_rank > right->cost_rank)
-						          comp = 1;
-					          break;
-				          case 2:  // comment
-					          comp = left->comment.compare(right->comment);
-					          break;
-			          }
-			          if (comp == 0)  // if still undecided, id decides
-				          comp = (left->id < right->id ? -1 : 1);
-			          return (sort_order_ == Qt::AscendingOrder) ? (comp < 0) : (comp >= 0);
-		          });
-	}
+		          [this](const DataMap::iterator& left, const DataMap::iterator& right) { return lessThan(left, right); });
 
 	// map old indexes to new ones
 	std::map<int, int> old_to_new_row;
@@ -608,11 +911,8 @@ void RemoteSolutionModel::sortInternal() {
 	for (int i = 0, end = old_indexes.count(); i != end; ++i) {
 		int old_row = old_indexes[i].row();
 		auto it_inserted = old_to_new_row.insert(std::make_pair(old_row, -1));
-		if (it_inserted.second) {  // newly inserted: find new row index
-			auto it = detail::findById(sorted_, old_sorted[old_row]->id);
-			if (it != sorted_.cend())
-				it_inserted.first->second = it - sorted_.begin();
-		}
+		if (it_inserted.second)  // newly inserted: find new row index
+			it_inserted.first->second = rowOf(old_sorted[old_row]);
 		new_indexes.append(index(it_inserted.first->second, old_indexes[i].column()));
 	}
 
@@ -620,42 +920,115 @@ void RemoteSolutionModel::sortInternal() {
 	Q_EMIT layoutChanged();
 }
 
+bool RemoteSolutionModel::lessThan(const DataMap::iterator& left, const DataMap::iterator& right) const {
+	const Data& l = left->second;
+	const Data& r = right->second;
+	int comp = 0;
+	switch (sort_column_) {
+		case 1:  // cost order
+			if (l.cost_rank < r.cost_rank)
+				comp = -1;
+			else if (l.cost_rank > r.cost_rank)
+				comp = 1;
+			break;
+		case 2:  // comment
+			comp = l.comment.compare(r.comment);
+			break;
+	}
+	if (comp == 0)  // if still undecided, id decides
+		comp = (l.id < r.id ? -1 : (l.id > r.id ? 1 : 0));
+	if (sort_column_ < 0)  // unsorted: keep creation order
+		return comp < 0;
+	return (sort_order_ == Qt::AscendingOrder) ? (comp < 0) : (comp > 0);
+}
+
+int RemoteSolutionModel::rowOf(const DataMap::iterator& it) const {
+	auto pos = std::lower_bound(sorted_.begin(), sorted_.end(), it,
+	                            [this](const DataMap::iterator& left, const DataMap::iterator& right) {
+		                            return lessThan(left, right);
+	                            });
+	return (pos != sorted_.end() && *pos == it) ? pos - sorted_.begin() : -1;
+}
+
+void RemoteSolutionModel::insertSorted(std::vector<DataMap::iterator>& items) {
+	auto less = [this](const DataMap::iterator& left, const DataMap::iterator& right) { return lessThan(left, right); };
+	std::sort(items.begin(), items.end(), less);
+
+	auto pos = sorted_.begin();
+	for (auto first = items.begin(), end = items.end(); first != end;) {
+		// find the gap for *first and all following items fitting into the same gap
+		pos = std::upper_bound(pos, sorted_.end(), *first, less);
+		auto last = (pos == sorted_.end()) ?
+		                end :
+		                std::partition_point(first, end, [&](const DataMap::iterator& item) { return less(item, *pos); });
+
+		int row = pos - sorted_.begin();
+		beginInsertRows(QModelIndex(), row, row + (last - first) - 1);
+		pos = sorted_.insert(pos, first, last) + (last - first);
+		endInsertRows();
+		first = last;
+	}
+}
+
 // process solution ids received in stage statistics
 void RemoteSolutionModel::processSolutionIDs(const std::vector<uint32_t>& successful,
                                              const std::vector<uint32_t>& failed, size_t num_failed,
-                                             double total_compute_time) {
-	// append new items to the end of data_
-	processSolutionIDs(successful, true);
-	processSolutionIDs(failed, false);
-
-	// assign consecutive creation ranks
-	uint32_t rank = 0;
-	for (auto& item : data_)
-		item.creation_rank = ++rank;
+                                             double total_compute_time, bool incremental) {
+	// insert new items into data_, usually at the end
+	const uint32_t last_id = data_.empty() ? 0 : data_.rbegin()->first;
+	std::vector<DataMap::iterator> added;
+	processSolutionIDs(successful, true, added);
+	processSolutionIDs(failed, false, added);
+
+	// assign consecutive creation ranks: if new items were only appended, existing ranks remain valid
+	bool reordered = std::any_of(added.begin(), added.end(),
+	                             [last_id](const DataMap::iterator& it) { return it->first < last_id; });
+	uint32_t rank = reordered ? 0 : data_.size() - added.size();
+	for (auto it = reordered ? data_.begin() : std::prev(data_.end(), added.size()); it != data_.end(); ++it)
+		it->second.creation_rank = ++rank;
 
 	// the task may not report failure ids (in failed),
 	// but it may report the overall number of failures
-	num_failed_data_ = failed.size();  // needed to compute number of successes
+	// incremental messages only list new failures
+	num_failed_data_ = incremental ? num_failed_data_ + failed.size() : failed.size();
 	num_failed_ = std::max(num_failed, num_failed_data_);
 	total_compute_time_ = total_compute_time;
 
-	sortInternal();
+	// changed ranks of existing items might have invalidated their order, e.g. due to updated costs
+	auto less = [this](const DataMap::iterator& left, const DataMap::iterator& right) { return lessThan(left, right); };
+	if (reordered || !std::is_sorted(sorted_.begin(), sorted_.end(), less)) {
+		sortInternal();
+		return;
+	}
+	// otherwise only insert the new visible items
+	added.erase(std::remove_if(added.begin(), added.end(),
+	                           [this](const DataMap::iterator& it) { return !isVisible(it->second); }),
+	            added.end());
+	insertSorted(added);
 }
 
-void RemoteSolutionModel::processSolutionIDs(const std::vector<uint32_t>& ids, bool successful) {
+// insert ids into data_ (sorted by id), collecting new items in added
+void RemoteSolutionModel::processSolutionIDs(const std::vector<uint32_t>& ids, bool successful,
+                                             std::vector<DataMap::iterator>& added) {
 	// Interface axiom: ids are sorted by cost
-	// insert them into data_ list sorted by id
 	double default_cost =
 	    successful ? std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::infinity();
 	uint32_t cost_rank = 0;
 	for (const uint32_t id : ids) {
 		uint32_t rank = successful ? ++cost_rank : std::numeric_limits<uint32_t>::max();
-		auto it = detail::insert(data_, Data(id, default_cost, rank));
-		Q_ASSERT(it->id == id);
-		it->cost_rank = rank;
+		auto inserted = data_.emplace(id, Data(id, default_cost, rank));
+		if (inserted.second)
+			added.push_back(inserted.first);
+		inserted.first->second.cost_rank = rank;
 	}
 }
 
+uint32_t RemoteSolutionModel::bestSolutionId() const {
+	// successful solutions are ranked by cost, starting from 1
+	auto it = std::find_if(data_.begin(), data_.end(), [](const auto& pair) { return pair.second.cost_rank == 1; });
+	return it == data_.end() ? 0 : it->first;
+}
+
 bool RemoteSolutionModel::isVisible(const RemoteSolutionModel::Data& item) const {
 	return std::isnan(item.cost) || item.cost <= max_cost_;
 }
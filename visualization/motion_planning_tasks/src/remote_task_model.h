@@ -38,9 +38,13 @@
 
 #include "task_list_model.h"
 #include <moveit/visualization_tools/display_solution.h>
+#include <moveit_task_constructor_msgs/SolutionStream.h>
 #include <ros/service_client.h>
 #include <memory>
 #include <limits>
+#include <list>
+#include <map>
+#include <set>
 
 namespace moveit_rviz_plugin {
 
@@ -55,9 +59,38 @@ class RemoteTaskModel : public BaseTaskModel
 	struct Node;
 	Node* const root_;
 	ros::ServiceClient get_solution_client_;
+	ros::ServiceClient get_solutions_client_;
+	/// solution ids requested via prefetchSolutions(), but not yet received
+	std::set<uint32_t> pending_solutions_;
 
 	std::map<uint32_t, Node*> id_to_stage_;
-	std::map<uint32_t, DisplaySolutionPtr> id_to_solution_;
+
+	/// LRU cache of DisplaySolutions, bounded by the serialized size of the originating solution messages
+	struct CachedSolution
+	{
+		DisplaySolutionPtr solution;
+		uint32_t group;  // key of the cache group the solution belongs to
+	};
+	/// all solutions created from a single message, evicted together
+	struct CacheGroup
+	{
+		std::vector<uint32_t> ids;
+		size_t bytes = 0;
+		std::list<uint32_t>::iterator lru;
+	};
+	std::map<uint32_t, CachedSolution> id_to_solution_;
+	std::map<uint32_t, CacheGroup> cache_groups_;
+	std::list<uint32_t> cache_lru_;  // group keys, most recently used first
+	size_t cache_bytes_ = 0;
+	size_t cache_limit_;
+
+	/// data received via SOLUTION_STREAM_TOPIC, referenced by later stream msgs
+	std::map<uint32_t, moveit_task_constructor_msgs::SubTrajectory> streamed_trajectories_;
+	std::map<uint32_t, moveit_msgs::PlanningScene> streamed_scenes_;  // complete scenes
+
+	/// maxima over all stages, normalizing HEATMAP_P95_TIME and HEATMAP_MEMORY
+	double max_p95_compute_time_ = 0.0;
+	uint64_t max_memory_ = 0;
 
 	inline Node* node(const QModelIndex& index) const;
 	QModelIndex index(const Node* n) const;
@@ -65,9 +98,18 @@ class RemoteTaskModel : public BaseTaskModel
 	Node* node(uint32_t stage_id) const;
 	inline RemoteSolutionModel* getSolutionModel(uint32_t stage_id) const;
 	void setSolutionData(const moveit_task_constructor_msgs::SolutionInfo& info);
+	void notifyChanged(const std::vector<Node*>& nodes, int first_column, int last_column);
+	void cacheSolutions(const std::vector<std::pair<uint32_t, DisplaySolutionPtr>>& solutions, size_t bytes);
+	void shrinkCache();
+	/// heatmap value of given node in [0, 1], negative if not colored
+	double heatmapValue(const Node& n) const;
+	/// mark the stages contributing to the best (cached) top-level solution
+	void updateCriticalPath();
+	/// notify about changed colors of all visited nodes
+	void notifyHeatmapChanged();
 
 public:
-	RemoteTaskModel(ros::NodeHandle& nh, const std::string& service_name,
+	RemoteTaskModel(ros::NodeHandle& nh, const std::string& service_name, const std::string& batch_service_name,
 	                const planning_scene::PlanningSceneConstPtr& scene, rviz::DisplayContext* display_context,
 	                QObject* parent = nullptr);
 	~RemoteTaskModel() override;
@@ -82,8 +124,25 @@ public:
 
 	QModelIndex indexFromStageId(size_t id) const override;
 	void processStageDescriptions(const moveit_task_constructor_msgs::TaskDescription::_stages_type& msg);
-	void processStageStatistics(const moveit_task_constructor_msgs::TaskStatistics::_stages_type& msg);
-	DisplaySolutionPtr processSolutionMessage(const moveit_task_constructor_msgs::Solution& msg);
+	void processStageStatistics(const moveit_task_constructor_msgs::TaskStatistics::_stages_type& msg,
+	                            bool incremental = false);
+	/// create DisplaySolution from msg and cache it, as well as its sub trajectories (for top-level solutions)
+	/// id identifies non-top-level solutions for caching
+	DisplaySolutionPtr processSolutionMessage(const moveit_task_constructor_msgs::Solution& msg, uint32_t id = 0);
+	/** reassemble the complete Solution msg from a delta-encoded SolutionStream msg
+	 *
+	 * Stream msgs need to be decoded in sequence. Returns false if msg refers to data not received before.
+	 */
+	bool decodeSolutionStream(const moveit_task_constructor_msgs::SolutionStream& msg,
+	                          moveit_task_constructor_msgs::Solution& solution);
+	/// decode stream msg and process it like processSolutionMessage(), requesting undecodable solutions via service
+	DisplaySolutionPtr processSolutionStreamMessage(const moveit_task_constructor_msgs::SolutionStream& msg);
+	/// asynchronously retrieve solutions not yet known, without blocking the GUI thread
+	void prefetchSolutions(const std::vector<uint32_t>& ids);
+	/// limit memory used for cached solutions, evicting least recently used ones
+	void setSolutionCacheLimit(size_t bytes);
+	void setHeatmap(int mode) override;
+	size_t solutionCacheSize() const { return cache_bytes_; }
 
 	QAbstractItemModel* getSolutionModel(const QModelIndex& index) override;
 	DisplaySolutionPtr getSolution(const QModelIndex& index) override;
@@ -105,32 +164,45 @@ class RemoteSolutionModel : public QAbstractTableModel
 
 		Data(uint32_t id, float cost, uint32_t cost_rank, const QString& name = QString())
 		  : id(id), cost(cost), comment(name), creation_rank(0), cost_rank(cost_rank) {}
-
-		inline bool operator<(const Data& other) const { return this->id < other.id; }
 	};
 	// successful and failed solutions ordered by id / creation
-	using DataList = std::list<Data>;
-	DataList data_;
+	using DataMap = std::map<uint32_t, Data>;
+	DataMap data_;
 	size_t num_failed_data_ = 0;  // number of failed solutions in data_
 	size_t num_failed_ = 0;  // number of reported failures
 	double total_compute_time_ = 0.0;
+	QString compute_time_details_;  // summary of compute time statistics
+	QString memory_details_;  // summary of memory usage
 
 	// solutions ordered (by default according to cost)
 	int sort_column_ = -1;
 	Qt::SortOrder sort_order_ = Qt::AscendingOrder;
 	double max_cost_ = std::numeric_limits<double>::infinity();
-	std::vector<DataList::iterator> sorted_;
+	std::vector<DataMap::iterator> sorted_;
 
 	inline bool isVisible(const Data& item) const;
-	void processSolutionIDs(const std::vector<uint32_t>& ids, bool successful);
+	/// order of items in sorted_ according to sort_column_ and sort_order_
+	bool lessThan(const DataMap::iterator& left, const DataMap::iterator& right) const;
+	/// row of item in sorted_ or -1 if not visible
+	int rowOf(const DataMap::iterator& it) const;
+	/// insert given items into sorted_, emitting a single beginInsertRows() per contiguous range
+	void insertSorted(std::vector<DataMap::iterator>& items);
+	void processSolutionIDs(const std::vector<uint32_t>& ids, bool successful, std::vector<DataMap::iterator>& added);
 	void sortInternal();
 
 public:
 	RemoteSolutionModel(QObject* parent = nullptr);
 
+	/// id of the successful solution with lowest cost, 0 if there is none
+	uint32_t bestSolutionId() const;
+
 	uint numSuccessful() const { return data_.size() - num_failed_data_; }
 	uint numFailed() const { return num_failed_; }
 	double totalComputeTime() const { return total_compute_time_; }
+	const QString& computeTimeDetails() const { return compute_time_details_; }
+	void setComputeTimeDetails(const QString& details) { compute_time_details_ = details; }
+	const QString& memoryDetails() const { return memory_details_; }
+	void setMemoryDetails(const QString& details) { memory_details_ = details; }
 
 	int rowCount(const QModelIndex& parent = QModelIndex()) const override;
 	int columnCount(const QModelIndex& parent = QModelIndex()) const override;
@@ -140,6 +212,6 @@ public:
 
 	void setSolutionData(uint32_t id, float cost, const QString& comment);
 	void processSolutionIDs(const std::vector<uint32_t>& successful, const std::vector<uint32_t>& failed,
-	                        size_t num_failed, double total_compute_time);
+	                        size_t num_failed, double total_compute_time, bool incremental = false);
 };
 }  // namespace moveit_rviz_plugin
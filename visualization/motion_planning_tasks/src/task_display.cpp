@@ -50,12 +50,14 @@
 #include <moveit/robot_model/robot_model.h>
 
 #include <rviz/display_context.h>
+#include <rviz/properties/bool_property.h>
 #include <rviz/properties/string_property.h>
 #include <rviz/properties/ros_topic_property.h>
 #include <rviz/properties/status_property.h>
 #include <rviz/frame_manager.h>
 #include <OgreSceneNode.h>
 #include <QTimer>
+#include <boost/make_shared.hpp>
 
 namespace moveit_rviz_plugin {
 
@@ -79,6 +81,11 @@ TaskDisplay::TaskDisplay() : Display(), panel_requested_(false), received_task_d
 	    "Task Solution Topic", "", ros::message_traits::datatype<moveit_task_constructor_msgs::Solution>(),
 	    "The topic on which task solutions (moveit_msgs::Solution messages) are received", this,
 	    SLOT(changedTaskSolutionTopic()), this);
+	shared_memory_property_ =
+	    new rviz::BoolProperty("Shared Memory", false,
+	                           "Receive solutions of planners running on this host via shared memory. "
+	                           "Requires Introspection::enableSharedMemory() on the planner side.",
+	                           this, SLOT(changedTaskSolutionTopic()), this);
 
 	trajectory_visual_.reset(new TaskSolutionVisualization(this, this));
 	connect(trajectory_visual_.get(), SIGNAL(activeStageChanged(size_t)), task_list_model_.get(),
@@ -88,6 +95,13 @@ TaskDisplay::TaskDisplay() : Display(), panel_requested_(false), received_task_d
 }
 
 TaskDisplay::~TaskDisplay() {
+	// stop receiving messages before discarding pending jobs
+	task_description_sub.shutdown();
+	task_statistics_sub.shutdown();
+	task_solution_sub.shutdown();
+	task_solution_stream_sub.shutdown();
+	jobs_.clear();
+
 	if (panel_requested_)
 		TaskPanel::release();  // Indicate that we don't need a TaskPanel anymore
 }
@@ -179,6 +193,7 @@ void TaskDisplay::calculateOffsetPosition() {
 void TaskDisplay::update(float wall_dt, float ros_dt) {
 	requestPanel();
 	Display::update(wall_dt, ros_dt);
+	jobs_.executeJobs();
 	calculateOffsetPosition();
 	trajectory_visual_->update(wall_dt, ros_dt);
 }
@@ -195,40 +210,113 @@ void TaskDisplay::changedRobotDescription() {
 		loadRobotModel();
 }
 
+namespace {
+// key identifying messages superseding each other: full descriptions / statistics of the same task
+size_t messageKey(char type, const std::string& task_id) {
+	size_t key = std::hash<std::string>{}(std::string(1, type) + task_id);
+	return key ? key : 1;  // 0 indicates unkeyed jobs
+}
+}  // namespace
+
 void TaskDisplay::taskDescriptionCB(const moveit_task_constructor_msgs::TaskDescriptionConstPtr& msg) {
+	// incremental descriptions need to be applied in sequence
+	jobs_.addJob([this, msg] { processTaskDescription(msg); }, msg->incremental ? 0 : messageKey('d', msg->task_id));
+}
+
+void TaskDisplay::taskStatisticsCB(const moveit_task_constructor_msgs::TaskStatisticsConstPtr& msg) {
+	// incremental statistics need to be applied in sequence
+	jobs_.addJob([this, msg] { processTaskStatistics(msg); }, msg->incremental ? 0 : messageKey('s', msg->task_id));
+}
+
+void TaskDisplay::taskSolutionCB(const moveit_task_constructor_msgs::SolutionConstPtr& msg) {
+	jobs_.addJob([this, msg] { processTaskSolution(msg); });
+}
+
+void TaskDisplay::taskSolutionStreamCB(const moveit_task_constructor_msgs::SolutionStreamConstPtr& msg) {
+	// stream msgs refer to their predecessors, thus never drop them
+	jobs_.addJob([this, msg] { processTaskSolutionStream(msg); });
+}
+
+void TaskDisplay::taskSolutionHandleCB(const moveit_task_constructor_msgs::SolutionHandleConstPtr& msg) {
+	// deserialize directly from the mapped segment, still in the background thread
+	auto solution = boost::make_shared<moveit_task_constructor_msgs::Solution>();
+	moveit::task_constructor::SolutionRingPtr& ring = solution_rings_[msg->segment];
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (!ring) {
+			try {
+				ring = moveit::task_constructor::SolutionRing::open(msg->segment);
+			} catch (const std::runtime_error& e) {
+				ROS_ERROR_STREAM_THROTTLE(1.0, e.what());
+				return;
+			}
+		}
+		if (ring->read(*msg, *solution)) {
+			jobs_.addJob([this, solution] { processTaskSolution(solution); });
+			return;
+		}
+		if (ring->instance() == msg->instance)
+			break;  // overwritten meanwhile
+		ring.reset();  // segment was re-created: map it again
+	}
+	ROS_WARN_STREAM_THROTTLE(1.0, "Missed solution in shared memory '" << msg->segment << "'");
+}
+
+void TaskDisplay::processTaskDescription(const moveit_task_constructor_msgs::TaskDescriptionConstPtr& msg) {
 	setStatus(rviz::StatusProperty::Ok, "Task Monitor", "OK");
 	requestPanel();
 	task_list_model_->processTaskDescriptionMessage(*msg, update_nh_,
-	                                                base_ns_ + GET_SOLUTION_SERVICE "_" + msg->task_id);
+	                                                base_ns_ + GET_SOLUTION_SERVICE "_" + msg->task_id,
+	                                                base_ns_ + GET_SOLUTIONS_SERVICE "_" + msg->task_id);
 
 	// Start listening to other topics if this is the first description
 	// Waiting for the description ensures we do not receive data that cannot be interpreted yet
 	if (!received_task_description_ && !msg->stages.empty()) {
 		received_task_description_ = true;
-		task_statistics_sub = update_nh_.subscribe(base_ns_ + STATISTICS_TOPIC, 2, &TaskDisplay::taskStatisticsCB, this);
-		task_solution_sub = update_nh_.subscribe(base_ns_ + SOLUTION_TOPIC, 2, &TaskDisplay::taskSolutionCB, this);
+		task_statistics_sub =
+		    threaded_nh_.subscribe(base_ns_ + STATISTICS_TOPIC, 2, &TaskDisplay::taskStatisticsCB, this);
+		if (shared_memory_property_->getBool())
+			task_solution_sub =
+			    threaded_nh_.subscribe(base_ns_ + SOLUTION_HANDLE_TOPIC, 10, &TaskDisplay::taskSolutionHandleCB, this);
+		else
+			task_solution_sub = threaded_nh_.subscribe(base_ns_ + SOLUTION_TOPIC, 2, &TaskDisplay::taskSolutionCB, this);
+		// replaces SOLUTION_TOPIC if the task enabled streaming
+		task_solution_stream_sub = threaded_nh_.subscribe(base_ns_ + SOLUTION_STREAM_TOPIC, 100,
+		                                                  &TaskDisplay::taskSolutionStreamCB, this);
 	}
 }
 
-void TaskDisplay::taskStatisticsCB(const moveit_task_constructor_msgs::TaskStatisticsConstPtr& msg) {
+void TaskDisplay::processTaskStatistics(const moveit_task_constructor_msgs::TaskStatisticsConstPtr& msg) {
 	setStatus(rviz::StatusProperty::Ok, "Task Monitor", "OK");
 	task_list_model_->processTaskStatisticsMessage(*msg);
 }
 
-void TaskDisplay::taskSolutionCB(const moveit_task_constructor_msgs::SolutionConstPtr& msg) {
+void TaskDisplay::processTaskSolution(const moveit_task_constructor_msgs::SolutionConstPtr& msg) {
 	setStatus(rviz::StatusProperty::Ok, "Task Monitor", "OK");
 	try {
-		const DisplaySolutionPtr& s = task_list_model_->processSolutionMessage(*msg);
-		if (s)
-			trajectory_visual_->showTrajectory(s, false);
-		else
-			setSolutionStatus(false);
+		showTaskSolution(task_list_model_->processSolutionMessage(*msg));
 	} catch (const std::invalid_argument& e) {
 		ROS_ERROR_STREAM(e.what());
 		setSolutionStatus(false, e.what());
 	}
 }
 
+void TaskDisplay::processTaskSolutionStream(const moveit_task_constructor_msgs::SolutionStreamConstPtr& msg) {
+	setStatus(rviz::StatusProperty::Ok, "Task Monitor", "OK");
+	try {
+		showTaskSolution(task_list_model_->processSolutionStreamMessage(*msg));
+	} catch (const std::invalid_argument& e) {
+		ROS_ERROR_STREAM(e.what());
+		setSolutionStatus(false, e.what());
+	}
+}
+
+void TaskDisplay::showTaskSolution(const DisplaySolutionPtr& s) {
+	if (s)
+		trajectory_visual_->showTrajectory(s, false);
+	else
+		setSolutionStatus(false);
+}
+
 void TaskDisplay::changedTaskSolutionTopic() {
 	// postpone setup until scene is well-defined
 	if (!trajectory_visual_->getScene())
@@ -237,6 +325,8 @@ void TaskDisplay::changedTaskSolutionTopic() {
 	task_description_sub.shutdown();
 	task_statistics_sub.shutdown();
 	task_solution_sub.shutdown();
+	task_solution_stream_sub.shutdown();
+	jobs_.clear();  // drop messages from previous topics
 
 	received_task_description_ = false;
 
@@ -251,7 +341,8 @@ void TaskDisplay::changedTaskSolutionTopic() {
 	base_ns_ = solution_topic.toStdString().substr(0, solution_topic.length() - strlen(SOLUTION_TOPIC));
 
 	// listen to task descriptions updates
-	task_description_sub = update_nh_.subscribe(base_ns_ + DESCRIPTION_TOPIC, 10, &TaskDisplay::taskDescriptionCB, this);
+	task_description_sub =
+	    threaded_nh_.subscribe(base_ns_ + DESCRIPTION_TOPIC, 10, &TaskDisplay::taskDescriptionCB, this);
 
 	setStatus(rviz::StatusProperty::Warn, "Task Monitor", "No messages received");
 }
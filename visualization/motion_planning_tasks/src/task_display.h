@@ -45,12 +45,17 @@
 #include "job_queue.h"
 #include <moveit/macros/class_forward.h>
 #include <ros/subscriber.h>
+#include <map>
 #include <moveit_task_constructor_msgs/TaskDescription.h>
 #include <moveit_task_constructor_msgs/TaskStatistics.h>
 #include <moveit_task_constructor_msgs/Solution.h>
+#include <moveit_task_constructor_msgs/SolutionHandle.h>
+#include <moveit_task_constructor_msgs/SolutionStream.h>
+#include <moveit/task_constructor/solution_ring.h>
 #endif
 
 namespace rviz {
+class BoolProperty;
 class StringProperty;
 class RosTopicProperty;
 }  // namespace rviz
@@ -116,9 +121,21 @@ private Q_SLOTS:
 	void taskDescriptionCB(const moveit_task_constructor_msgs::TaskDescriptionConstPtr& msg);
 	void taskStatisticsCB(const moveit_task_constructor_msgs::TaskStatisticsConstPtr& msg);
 	void taskSolutionCB(const moveit_task_constructor_msgs::SolutionConstPtr& msg);
+	void taskSolutionHandleCB(const moveit_task_constructor_msgs::SolutionHandleConstPtr& msg);
+	void taskSolutionStreamCB(const moveit_task_constructor_msgs::SolutionStreamConstPtr& msg);
+
+	// process received messages in the GUI thread
+	void processTaskDescription(const moveit_task_constructor_msgs::TaskDescriptionConstPtr& msg);
+	void processTaskStatistics(const moveit_task_constructor_msgs::TaskStatisticsConstPtr& msg);
+	void processTaskSolution(const moveit_task_constructor_msgs::SolutionConstPtr& msg);
+	void processTaskSolutionStream(const moveit_task_constructor_msgs::SolutionStreamConstPtr& msg);
+	void showTaskSolution(const DisplaySolutionPtr& s);
 
 protected:
+	// messages are received in rviz' background thread and queued here for processing in update()
+	moveit::tools::JobQueue jobs_;
 	ros::Subscriber task_solution_sub;
+	ros::Subscriber task_solution_stream_sub;
 	ros::Subscriber task_description_sub;
 	ros::Subscriber task_statistics_sub;
 
@@ -134,12 +151,15 @@ protected:
 
 	// topic namespace for ROS interfaces of task
 	std::string base_ns_;
+	// shared-memory rings of local planners, accessed from rviz' (single) background thread only
+	std::map<std::string, moveit::task_constructor::SolutionRingPtr> solution_rings_;
 	// Indicates whether description was received for current task
 	bool received_task_description_;
 
 	// Properties
 	rviz::StringProperty* robot_description_property_;
 	rviz::RosTopicProperty* task_solution_topic_property_;
+	rviz::BoolProperty* shared_memory_property_;
 	rviz::Property* tasks_property_;
 };
 
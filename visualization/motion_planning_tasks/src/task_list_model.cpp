@@ -44,10 +44,12 @@
 
 #include <ros/console.h>
 
+#include <QColor>
 #include <QMimeData>
 #include <QHeaderView>
 #include <QScrollBar>
 #include <qevent.h>
+#include <algorithm>
 #include <numeric>
 
 using namespace moveit::task_constructor;
@@ -114,6 +116,12 @@ QVariant BaseTaskModel::data(const QModelIndex& index, int role) const {
 	return QVariant();
 }
 
+QVariant BaseTaskModel::heatmapColor(double value) {
+	// hue from green (cold) to red (hot), semi-transparent to keep the text readable
+	value = std::min(std::max(value, 0.0), 1.0);
+	return QColor::fromHsvF((1.0 - value) / 3.0, 0.8, 1.0, 0.5);
+}
+
 QVariant BaseTaskModel::flowIcon(moveit::task_constructor::InterfaceFlags f) {
 	static const QIcon CONNECT_ICON = icons::CONNECT.icon();
 	static const QIcon FORWARD_ICON = icons::FORWARD.icon();
@@ -163,7 +171,10 @@ void TaskListModel::onRemoveModel(QAbstractItemModel* model) {
 }
 
 TaskListModel::TaskListModel(QObject* parent)
-  : FlatMergeProxyModel(parent), old_task_handling_(TaskView::OLD_TASK_REPLACE) {
+  : FlatMergeProxyModel(parent)
+  , old_task_handling_(TaskView::OLD_TASK_REPLACE)
+  , solution_cache_limit_(256 << 20)
+  , heatmap_(BaseTaskModel::HEATMAP_NONE) {
 	ROS_DEBUG_NAMED(LOGNAME, "created TaskListModel: %p", this);
 	setStageFactory(getStageFactory());
 }
@@ -207,6 +218,20 @@ void TaskListModel::setOldTaskHandling(int mode) {
 	old_task_handling_ = mode;
 }
 
+void TaskListModel::setSolutionCacheSize(int megabytes) {
+	solution_cache_limit_ = static_cast<size_t>(megabytes) << 20;
+	for (const auto& task : remote_tasks_)
+		if (task.second)
+			task.second->setSolutionCacheLimit(solution_cache_limit_);
+}
+
+void TaskListModel::setHeatmap(int mode) {
+	heatmap_ = mode;
+	for (const auto& task : remote_tasks_)
+		if (task.second)
+			task.second->setHeatmap(heatmap_);
+}
+
 void TaskListModel::highlightStage(size_t id) {
 	if (!active_task_model_)
 		return;
@@ -242,12 +267,21 @@ QVariant TaskListModel::data(const QModelIndex& index, int role) const {
 // process a task description message:
 // update existing RemoteTask, create a new one, or (if msg.stages is empty) delete an existing one
 void TaskListModel::processTaskDescriptionMessage(const moveit_task_constructor_msgs::TaskDescription& msg,
-                                                  ros::NodeHandle& nh, const std::string& service_name) {
+                                                  ros::NodeHandle& nh, const std::string& service_name,
+                                                  const std::string& batch_service_name) {
 	// retrieve existing or insert new remote task for given task id
 	auto it_inserted = remote_tasks_.insert(std::make_pair(msg.task_id, nullptr));
 	const auto& task_it = it_inserted.first;
 	RemoteTaskModel*& remote_task = task_it->second;
 
+	// incremental descriptions only update a known task
+	if (msg.incremental && (!remote_task || (remote_task->taskFlags() & BaseTaskModel::IS_DESTROYED))) {
+		if (!remote_task)
+			remote_tasks_.erase(task_it);
+		ROS_WARN_NAMED(LOGNAME, "ignoring incremental description of unknown task: %s", msg.task_id.c_str());
+		return;
+	}
+
 	if (!msg.stages.empty() && remote_task && (remote_task->taskFlags() & BaseTaskModel::IS_DESTROYED)) {
 		// task overriding previous one that was already marked destroyed, but not yet removed from model
 		if (old_task_handling_ != TaskView::OLD_TASK_KEEP)
@@ -267,7 +301,9 @@ void TaskListModel::processTaskDescriptionMessage(const moveit_task_constructor_
 			remote_task->processStageDescriptions(msg.stages);
 	} else if (!remote_task) {  // create new task model, if ID was not known before
 		// the model is managed by this instance via Qt's parent-child mechanism
-		remote_task = new RemoteTaskModel(nh, service_name, scene_, display_context_, this);
+		remote_task = new RemoteTaskModel(nh, service_name, batch_service_name, scene_, display_context_, this);
+		remote_task->setSolutionCacheLimit(solution_cache_limit_);
+		remote_task->setHeatmap(heatmap_);
 		remote_task->processStageDescriptions(msg.stages);
 		ROS_DEBUG_NAMED(LOGNAME, "received new task: %s (%s)", msg.stages[0].name.c_str(), msg.task_id.c_str());
 		// insert newly created model into this' model instance
@@ -291,7 +327,7 @@ void TaskListModel::processTaskStatisticsMessage(const moveit_task_constructor_m
 	if (!remote_task || (remote_task->taskFlags() & RemoteTaskModel::IS_DESTROYED))
 		return;  // task is not in use anymore
 
-	remote_task->processStageStatistics(msg.stages);
+	remote_task->processStageStatistics(msg.stages, msg.incremental);
 }
 
 DisplaySolutionPtr TaskListModel::processSolutionMessage(const moveit_task_constructor_msgs::Solution& msg) {
@@ -306,6 +342,15 @@ DisplaySolutionPtr TaskListModel::processSolutionMessage(const moveit_task_const
 	return remote_task->processSolutionMessage(msg);
 }
 
+DisplaySolutionPtr
+TaskListModel::processSolutionStreamMessage(const moveit_task_constructor_msgs::SolutionStream& msg) {
+	auto it = remote_tasks_.find(msg.task_id);
+	if (it == remote_tasks_.cend() || !it->second)
+		return DisplaySolutionPtr();  // unknown task or not in use anymore
+
+	return it->second->processSolutionStreamMessage(msg);
+}
+
 bool TaskListModel::insertModel(BaseTaskModel* model, int pos) {
 	Q_ASSERT(model && model->columnCount() == columnCount());
 	// pass on stage factory
@@ -46,6 +46,7 @@
 #include <moveit_task_constructor_msgs/TaskDescription.h>
 #include <moveit_task_constructor_msgs/TaskStatistics.h>
 #include <moveit_task_constructor_msgs/Solution.h>
+#include <moveit_task_constructor_msgs/SolutionStream.h>
 
 #include <QAbstractItemModel>
 #include <QTreeView>
@@ -73,6 +74,7 @@ class BaseTaskModel : public QAbstractItemModel
 	Q_OBJECT
 protected:
 	unsigned int flags_ = 0;
+	int heatmap_ = HEATMAP_NONE;
 	planning_scene::PlanningSceneConstPtr scene_;
 	rviz::DisplayContext* display_context_;
 
@@ -85,6 +87,16 @@ public:
 		IS_RUNNING = 0x08,
 	};
 
+	/// color-coding of the stage tree
+	enum Heatmap
+	{
+		HEATMAP_NONE = 1,
+		HEATMAP_TIME_SHARE,  // share of the task's total compute time
+		HEATMAP_P95_TIME,  // p95 compute() duration, relative to the maximum of all stages
+		HEATMAP_MEMORY,  // memory usage, relative to the maximum of all stages
+		HEATMAP_CRITICAL_PATH,  // time share of stages contributing to the best solution
+	};
+
 	BaseTaskModel(const planning_scene::PlanningSceneConstPtr& scene, rviz::DisplayContext* display_context,
 	              QObject* parent = nullptr)
 	  : QAbstractItemModel(parent), scene_(scene), display_context_(display_context) {}
@@ -96,6 +108,9 @@ public:
 	virtual void setStageFactory(const StageFactoryPtr& /*factory*/) {}
 	unsigned int taskFlags() const { return flags_; }
 	static QVariant flowIcon(moveit::task_constructor::InterfaceFlags f);
+	/// background color for a heatmap value in [0, 1]
+	static QVariant heatmapColor(double value);
+	virtual void setHeatmap(int mode) { heatmap_ = mode; }
 
 	/// retrieve model index associated with given stage id
 	virtual QModelIndex indexFromStageId(size_t id) const = 0;
@@ -132,6 +147,10 @@ class TaskListModel : public utils::FlatMergeProxyModel
 	std::map<std::string, RemoteTaskModel*> remote_tasks_;
 	// mode reflecting the "Old task handling" setting
 	int old_task_handling_;
+	// memory limit for cached solutions of each remote task, reflecting the "Solution Cache Size" setting
+	size_t solution_cache_limit_;
+	// color-coding of remote tasks, reflecting the "Heatmap" setting
+	int heatmap_;
 
 	// factory used to create stages
 	StageFactoryPtr stage_factory_;
@@ -156,11 +175,13 @@ public:
 
 	/// process an incoming task description message - only call in Qt's main loop
 	void processTaskDescriptionMessage(const moveit_task_constructor_msgs::TaskDescription& msg, ros::NodeHandle& nh,
-	                                   const std::string& service_name);
+	                                   const std::string& service_name, const std::string& batch_service_name);
 	/// process an incoming task description message - only call in Qt's main loop
 	void processTaskStatisticsMessage(const moveit_task_constructor_msgs::TaskStatistics& msg);
 	/// process an incoming solution message - only call in Qt's main loop
 	DisplaySolutionPtr processSolutionMessage(const moveit_task_constructor_msgs::Solution& msg);
+	/// process an incoming solution stream message - only call in Qt's main loop, in order of reception
+	DisplaySolutionPtr processSolutionStreamMessage(const moveit_task_constructor_msgs::SolutionStream& msg);
 
 	/// insert a TaskModel, pos is relative to modelCount()
 	bool insertModel(BaseTaskModel* model, int pos = -1);
@@ -176,6 +197,8 @@ public:
 
 public Q_SLOTS:
 	void setOldTaskHandling(int mode);
+	void setSolutionCacheSize(int megabytes);
+	void setHeatmap(int mode);
 
 protected Q_SLOTS:
 	void highlightStage(size_t id);
@@ -50,6 +50,7 @@
 
 #include <rviz/properties/property.h>
 #include <rviz/properties/enum_property.h>
+#include <rviz/properties/int_property.h>
 #include <rviz/display_group.h>
 #include <rviz/visualization_manager.h>
 #include <rviz/window_manager_interface.h>
@@ -258,6 +259,10 @@ std::pair<BaseTaskModel*, QModelIndex> TaskViewPrivate::getTaskModel(const QMode
 void TaskViewPrivate::configureTaskListModel(TaskListModel* model) {
 	QObject::connect(q_ptr, &TaskView::oldTaskHandlingChanged, model, &TaskListModel::setOldTaskHandling);
 	model->setOldTaskHandling(q_ptr->old_task_handling->getOptionInt());
+	QObject::connect(q_ptr, &TaskView::solutionCacheSizeChanged, model, &TaskListModel::setSolutionCacheSize);
+	model->setSolutionCacheSize(q_ptr->solution_cache_size->getInt());
+	QObject::connect(q_ptr, &TaskView::heatmapChanged, model, &TaskListModel::setHeatmap);
+	model->setHeatmap(q_ptr->heatmap->getOptionInt());
 }
 
 void TaskViewPrivate::configureExistingModels() {
@@ -341,6 +346,24 @@ TaskView::TaskView(moveit_rviz_plugin::TaskPanel* parent, rviz::Property* root)
 	show_time_column = new rviz::BoolProperty("Show Computation Times", true, "Show the 'time' column", configs);
 	connect(show_time_column, &rviz::Property::changed, this, &TaskView::onShowTimeChanged);
 
+	solution_cache_size = new rviz::IntProperty("Solution Cache Size", 256,
+	                                            "Memory [MiB] used to cache solutions of each task. "
+	                                            "Least recently viewed solutions are evicted first.",
+	                                            configs);
+	solution_cache_size->setMin(1);
+	connect(solution_cache_size, &rviz::Property::changed, this, &TaskView::onSolutionCacheSizeChanged);
+
+	heatmap = new rviz::EnumProperty("Heatmap", "None",
+	                                 "Color-code stages to reveal where planning time and memory go. "
+	                                 "'Critical Path' highlights the stages of the best solution by their time share.",
+	                                 configs);
+	heatmap->addOption("None", BaseTaskModel::HEATMAP_NONE);
+	heatmap->addOption("Compute Time Share", BaseTaskModel::HEATMAP_TIME_SHARE);
+	heatmap->addOption("p95 Compute Time", BaseTaskModel::HEATMAP_P95_TIME);
+	heatmap->addOption("Memory", BaseTaskModel::HEATMAP_MEMORY);
+	heatmap->addOption("Critical Path", BaseTaskModel::HEATMAP_CRITICAL_PATH);
+	connect(heatmap, &rviz::Property::changed, this, &TaskView::onHeatmapChanged);
+
 	d_ptr->configureExistingModels();
 }
 
@@ -555,6 +578,14 @@ void TaskView::onOldTaskHandlingChanged() {
 	Q_EMIT oldTaskHandlingChanged(old_task_handling->getOptionInt());
 }
 
+void TaskView::onSolutionCacheSizeChanged() {
+	Q_EMIT solutionCacheSizeChanged(solution_cache_size->getInt());
+}
+
+void TaskView::onHeatmapChanged() {
+	Q_EMIT heatmapChanged(heatmap->getOptionInt());
+}
+
 GlobalSettingsWidgetPrivate::GlobalSettingsWidgetPrivate(GlobalSettingsWidget* widget, rviz::Property* root)
   : q_ptr(widget) {
 	setupUi(widget);
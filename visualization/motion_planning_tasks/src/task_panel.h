@@ -49,6 +49,7 @@ class WindowManagerInterface;
 class Property;
 class BoolProperty;
 class EnumProperty;
+class IntProperty;
 }  // namespace rviz
 
 namespace moveit_rviz_plugin {
@@ -128,6 +129,8 @@ protected:
 	rviz::EnumProperty* initial_task_expand;
 	rviz::EnumProperty* old_task_handling;
 	rviz::BoolProperty* show_time_column;
+	rviz::IntProperty* solution_cache_size;
+	rviz::EnumProperty* heatmap;
 
 public:
 	enum OldTaskHandling
@@ -154,12 +157,16 @@ protected Q_SLOTS:
 	void onExecCurrentSolution() const;
 	void onShowTimeChanged();
 	void onOldTaskHandlingChanged();
+	void onSolutionCacheSizeChanged();
+	void onHeatmapChanged();
 
 private:
 	Q_PRIVATE_SLOT(d_ptr, void configureInsertedModels(QModelIndex, int, int));
 
 Q_SIGNALS:
 	void oldTaskHandlingChanged(int old_task_handling);
+	void solutionCacheSizeChanged(int megabytes);
+	void heatmapChanged(int mode);
 };
 
 class GlobalSettingsWidgetPrivate;
@@ -222,3 +222,35 @@ TEST_F(FlatMergeModelRemove, remove4) {
 	EXPECT_TRUE(flat.removeRows(2, 2));
 	EXPECT_EQ(flat.rowCount(), 1 + 1 + 2);
 }
+
+TEST(FlatMergeModel, manyModels) {
+	FlatMergeProxyModel flat;
+	std::vector<QAbstractItemModel*> models;
+	for (int i = 0; i < 20; ++i) {
+		models.push_back(createStandardModel(&flat, 1 + i % 3, 3, 1));
+		flat.insertModel(models.back());
+	}
+	int rows = 0;
+	for (auto* m : models) {
+		EXPECT_EQ(flat.getModel(flat.index(rows, 1)), std::make_pair(m, m->index(0, 1)));
+		rows += m->rowCount();
+	}
+	EXPECT_EQ(flat.rowCount(), rows);
+	EXPECT_FALSE(flat.index(rows, 0).isValid());
+
+	// row offsets of subsequent models are updated on insertion and removal of source rows
+	auto* first = static_cast<QStandardItemModel*>(models.front());
+	first->appendRow(new QStandardItem("new"));
+	EXPECT_EQ(flat.rowCount(), rows + 1);
+	EXPECT_EQ(flat.index(first->rowCount() - 1, 0).data().toString(), "new");
+	EXPECT_EQ(flat.getModel(flat.index(first->rowCount(), 0)), std::make_pair(models[1], models[1]->index(0, 0)));
+
+	first->removeRows(0, 1);
+	EXPECT_EQ(flat.rowCount(), rows);
+	EXPECT_EQ(flat.getModel(flat.index(first->rowCount(), 0)), std::make_pair(models[1], models[1]->index(0, 0)));
+
+	// removing a model shifts all subsequent ones
+	EXPECT_TRUE(flat.removeModel(models[1]));
+	EXPECT_EQ(flat.rowCount(), rows - models[1]->rowCount());
+	EXPECT_EQ(flat.getModel(flat.index(first->rowCount(), 0)), std::make_pair(models[2], models[2]->index(0, 0)));
+}
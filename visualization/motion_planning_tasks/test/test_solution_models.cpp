@@ -55,3 +55,28 @@ TEST_F(SolutionModelTest, sorting) {
 	processAndValidate({ 1, 3 }, { 2 });
 	processAndValidate({ 4, 1, 6, 3 }, { 5, 2 });
 }
+
+TEST_F(SolutionModelTest, incrementalInsertion) {
+	RemoteSolutionModel model;
+	model.sort(1, Qt::AscendingOrder);
+	processAndValidate({ 1, 3 }, { 2 });
+	model.sort(1, Qt::AscendingOrder);
+
+	int num_inserts = 0, num_layouts = 0;
+	QObject::connect(&model, &QAbstractItemModel::rowsInserted, [&num_inserts]() { ++num_inserts; });
+	QObject::connect(&model, &QAbstractItemModel::layoutChanged, [&num_layouts]() { ++num_layouts; });
+
+	// new solutions are inserted at their sorted position without relayout
+	model.processSolutionIDs({ 4, 1, 3 }, {}, 1, 0.0, true);
+	EXPECT_EQ(num_inserts, 1);
+	EXPECT_EQ(num_layouts, 0);
+	model.processSolutionIDs({ 4, 1, 3, 5, 6 }, {}, 1, 0.0, true);
+	EXPECT_EQ(num_inserts, 2) << "consecutive rows are inserted at once";
+	EXPECT_EQ(num_layouts, 0);
+	validateSorting(model, 1, Qt::AscendingOrder, { 4, 1, 3, 5, 6, 2 });
+
+	// changed cost order requires a relayout
+	model.processSolutionIDs({ 1, 4, 3, 5, 6 }, {}, 1, 0.0, true);
+	EXPECT_EQ(num_layouts, 1);
+	validateSorting(model, 1, Qt::AscendingOrder, { 1, 4, 3, 5, 6, 2 });
+}
@@ -38,7 +38,16 @@
 #include <src/local_task_model.h>
 #include <src/remote_task_model.h>
 #include <moveit/task_constructor/container.h>
+#include <moveit/task_constructor/task.h>
+#include <moveit/task_constructor/introspection.h>
+#include <moveit/task_constructor/storage.h>
 #include <moveit/task_constructor/stages/current_state.h>
+#include <moveit/task_constructor/stages/fixed_state.h>
+#include <moveit/task_constructor/stages/move_relative.h>
+#include <moveit/task_constructor/solvers/joint_interpolation.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <moveit/visualization_tools/display_solution.h>
 
 #include <ros/init.h>
 #include <gtest/gtest.h>
@@ -130,7 +139,7 @@ protected:
 			SCOPED_TRACE("first i=" + std::to_string(i));
 			num_inserts = 0;
 			num_updates = 0;
-			model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution");
+			model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution", "get_solutions");
 
 			if (i == 0)
 				EXPECT_EQ(num_inserts, 1);  // 1 notify for inserted task
@@ -144,7 +153,7 @@ protected:
 			SCOPED_TRACE("second i=" + std::to_string(i));
 			num_inserts = 0;
 			num_updates = 0;
-			model.processTaskDescriptionMessage(genMsg("second"), nh, "get_solution");  // 1 notify for inserted task
+			model.processTaskDescriptionMessage(genMsg("second"), nh, "get_solution", "get_solutions");  // 1 notify for inserted task
 
 			if (i == 0)
 				EXPECT_EQ(num_inserts, 1);
@@ -166,12 +175,77 @@ protected:
 TEST_F(TaskListModelTest, remoteTaskModel) {
 	children = 3;
 	planning_scene::PlanningSceneConstPtr scene;
-	moveit_rviz_plugin::RemoteTaskModel m(nh, "get_solution", scene, nullptr);
+	moveit_rviz_plugin::RemoteTaskModel m(nh, "get_solution", "get_solutions", scene, nullptr);
 	m.processStageDescriptions(genMsg("first").stages);
 	SCOPED_TRACE("first");
 	validate(m, { "first" });
 }
 
+// stages are color-coded by their statistics, relative to the task or the maximum of all stages
+TEST_F(TaskListModelTest, heatmap) {
+	using moveit_rviz_plugin::BaseTaskModel;
+	children = 3;  // stage ids 2, 3, 4
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->link1", "continuous");
+	auto scene = std::make_shared<planning_scene::PlanningScene>(builder.build());
+	moveit_rviz_plugin::RemoteTaskModel m(nh, "get_solution", "get_solutions", scene, nullptr);
+	m.processStageDescriptions(genMsg("task").stages);
+
+	// best solution, composed of sub trajectories of the first and last child
+	moveit_task_constructor_msgs::Solution solution;
+	scene->getPlanningSceneMsg(solution.start_scene);
+	solution.sub_solution.resize(1);
+	solution.sub_solution[0].info.stage_id = 1;
+	solution.sub_solution[0].info.id = 100;
+	for (uint32_t stage_id : { 2, 4 }) {
+		moveit_task_constructor_msgs::SubTrajectory sub;
+		sub.info.stage_id = stage_id;
+		sub.info.id = 100 + stage_id;
+		sub.scene_diff.is_diff = true;
+		solution.sub_trajectory.push_back(sub);
+	}
+	m.processSolutionMessage(solution);
+
+	moveit_task_constructor_msgs::TaskStatistics stats;
+	stats.stages.resize(4);
+	const double total[] = { 4.0, 1.0, 3.0, 0.0 };
+	const double p95[] = { 0.0, 0.5, 0.25, 0.0 };
+	const uint64_t memory[] = { 0, 100, 400, 0 };
+	for (size_t i = 0; i != 4; ++i) {
+		stats.stages[i].id = i + 1;
+		stats.stages[i].total_compute_time = total[i];
+		stats.stages[i].p95_compute_time = p95[i];
+		stats.stages[i].memory_states = memory[i];
+	}
+	stats.stages[0].solved = { 100 };
+	m.processStageStatistics(stats.stages);
+
+	const QModelIndex root = m.index(0, 0);
+	auto color = [&](int child) { return m.data(child < 0 ? root : m.index(child, 0, root), Qt::BackgroundRole); };
+	auto expect = [&](const std::initializer_list<double>& values) {
+		int child = -1;  // root first
+		for (double value : values) {
+			SCOPED_TRACE("child " + std::to_string(child));
+			if (value < 0.0)
+				EXPECT_FALSE(color(child).isValid());
+			else
+				EXPECT_EQ(color(child), BaseTaskModel::heatmapColor(value));
+			++child;
+		}
+	};
+
+	expect({ -1, -1, -1, -1 });  // no heatmap by default
+	m.setHeatmap(BaseTaskModel::HEATMAP_TIME_SHARE);
+	expect({ 1.0, 0.25, 0.75, 0.0 });
+	m.setHeatmap(BaseTaskModel::HEATMAP_P95_TIME);
+	expect({ 0.0, 1.0, 0.5, 0.0 });
+	m.setHeatmap(BaseTaskModel::HEATMAP_MEMORY);
+	expect({ 0.0, 0.25, 1.0, 0.0 });
+	// only the task and creators of the best solution's sub trajectories are colored
+	m.setHeatmap(BaseTaskModel::HEATMAP_CRITICAL_PATH);
+	expect({ 1.0, 0.25, -1, 0.0 });
+}
+
 TEST_F(TaskListModelTest, localTaskModel) {
 	int argc = 0;
 	char* argv = nullptr;
@@ -190,6 +264,173 @@ TEST_F(TaskListModelTest, localTaskModel) {
 	}
 }
 
+// solutions of a local task are read from its stages, sharing scenes and trajectories for display
+TEST_F(TaskListModelTest, localTaskModelSolutions) {
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->link1->link2", "continuous");
+	builder.addGroupChain("base", "link2", "group");
+	auto robot_model = builder.build();
+	auto scene = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+	moveit_rviz_plugin::LocalTaskModel m(std::make_unique<SerialContainer>("task"), scene, nullptr);
+	m.setRobotModel(robot_model);
+	auto fixed = std::make_unique<stages::FixedState>();
+	fixed->setState(scene);
+	m.add(std::move(fixed));
+	auto move = std::make_unique<stages::MoveRelative>("move", std::make_shared<solvers::JointInterpolationPlanner>());
+	move->setGroup("group");
+	move->setDirection(std::map<std::string, double>{ { "link1-link2-joint", 0.1 } });
+	Stage* move_stage = move.get();
+	m.add(std::move(move));
+	ASSERT_TRUE(m.plan());
+
+	QModelIndex move_idx = m.index(1, 0, m.index(0, 0));
+	EXPECT_EQ(m.data(move_idx.sibling(1, 1)).toUInt(), 1u);
+	EXPECT_EQ(m.indexFromStageId(m.introspection().stageId(move_stage)), move_idx);
+
+	QAbstractItemModel* solutions = m.getSolutionModel(move_idx);
+	ASSERT_NE(solutions, nullptr);
+	ASSERT_EQ(solutions->rowCount(), 1);
+	EXPECT_EQ(m.getSolutionModel(move_idx), solutions);  // model is reused
+
+	moveit_rviz_plugin::DisplaySolutionPtr display = m.getSolution(solutions->index(0, 0));
+	ASSERT_TRUE(display);
+	const auto& solution = static_cast<const SubTrajectory&>(*move_stage->solutions().front());
+	ASSERT_EQ(display->getWayPointCount(), solution.trajectory()->getWayPointCount());
+	// no msg conversion: scenes and waypoints are shared with the in-process solution
+	EXPECT_EQ(display->startScene(), solution.start()->scene());
+	EXPECT_EQ(display->scene(display->getWayPointCount()), solution.end()->scene());
+	EXPECT_EQ(display->getWayPointPtr(1), solution.trajectory()->getWayPointPtr(1));
+}
+
+// solutions streamed by the Introspection are reassembled by the RemoteTaskModel
+TEST_F(TaskListModelTest, decodeSolutionStream) {
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->link1->link2", "continuous");
+	builder.addGroupChain("base", "link2", "group");
+	auto robot_model = builder.build();
+	auto scene = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+	Task t;
+	t.setRobotModel(robot_model);
+	auto fixed = std::make_unique<stages::FixedState>();
+	fixed->setState(scene);
+	t.add(std::move(fixed));
+	auto alternatives = std::make_unique<Alternatives>();
+	for (double delta : { 0.1, 0.2 }) {
+		auto move = std::make_unique<stages::MoveRelative>("move " + std::to_string(delta),
+		                                                   std::make_shared<solvers::JointInterpolationPlanner>());
+		move->setGroup("group");
+		move->setDirection(std::map<std::string, double>{ { "link1-link2-joint", delta } });
+		alternatives->add(std::move(move));
+	}
+	t.add(std::move(alternatives));
+	ASSERT_TRUE(t.plan());
+	ASSERT_EQ(t.solutions().size(), 2u);
+
+	moveit_rviz_plugin::RemoteTaskModel m(nh, "get_solution", "get_solutions", scene, nullptr);
+	Introspection& introspection = t.introspection();
+	size_t num_streamed = 0;
+	for (const auto& solution : t.solutions()) {
+		moveit_task_constructor_msgs::SolutionStream stream;
+		introspection.fillSolutionStream(stream, *solution);
+		EXPECT_EQ(stream.start_scene_id, 1u);
+		num_streamed += stream.sub_trajectory.size();
+
+		moveit_task_constructor_msgs::Solution decoded, expected;
+		ASSERT_TRUE(m.decodeSolutionStream(stream, decoded));
+		solution->toMsg(expected, &introspection);
+		expected.task_id = stream.task_id;
+		EXPECT_EQ(decoded, expected);
+	}
+	// the FixedState's sub trajectory is shared and thus streamed only once
+	EXPECT_EQ(num_streamed, 3u);
+
+	// a stream msg referring to unknown trajectories cannot be decoded
+	moveit_task_constructor_msgs::SolutionStream unknown;
+	unknown.start_scene_id = 1;
+	unknown.sub_trajectory_id.push_back(1000);
+	moveit_task_constructor_msgs::Solution decoded;
+	EXPECT_FALSE(m.decodeSolutionStream(unknown, decoded));
+}
+
+// sub trajectories of a received solution are converted on access, sharing scenes that are not modified
+TEST_F(TaskListModelTest, displaySolutionFromMessage) {
+	moveit::core::RobotModelBuilder builder("robot", "base");
+	builder.addChain("base->link1->link2", "continuous");
+	auto robot_model = builder.build();
+	auto scene = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+	moveit_task_constructor_msgs::Solution msg;
+	scene->getPlanningSceneMsg(msg.start_scene);
+	using SubTrajectoryMsg = moveit_task_constructor_msgs::SubTrajectory;
+	auto add_sub = [&msg](size_t num_points, uint32_t stage_id) -> SubTrajectoryMsg& {
+		SubTrajectoryMsg sub;
+		sub.info.stage_id = stage_id;
+		sub.info.comment = "sub " + std::to_string(msg.sub_trajectory.size());
+		sub.trajectory.joint_trajectory.joint_names = { "link1-link2-joint" };
+		for (size_t i = 0; i != num_points; ++i) {
+			trajectory_msgs::JointTrajectoryPoint p;
+			p.positions = { 0.1 * (i + 1) };
+			p.time_from_start = ros::Duration(0.1 * i);
+			sub.trajectory.joint_trajectory.points.push_back(p);
+		}
+		sub.scene_diff.is_diff = true;
+		sub.scene_diff.robot_state.is_diff = true;
+		msg.sub_trajectory.push_back(sub);
+		return msg.sub_trajectory.back();
+	};
+	add_sub(3, 1);  // empty scene diff
+	moveit_msgs::CollisionObject box;
+	box.id = "box";
+	box.header.frame_id = "base";
+	box.operation = moveit_msgs::CollisionObject::ADD;
+	box.primitives.resize(1);
+	box.primitives[0].type = shape_msgs::SolidPrimitive::BOX;
+	box.primitives[0].dimensions = { 0.1, 0.1, 0.1 };
+	box.primitive_poses.resize(1);
+	box.primitive_poses[0].orientation.w = 1.0;
+	add_sub(2, 2).scene_diff.world.collision_objects.push_back(box);
+	// empty scene diff stored in the scene table
+	msg.scene_table.push_back(add_sub(1, 3).scene_diff);
+	msg.sub_trajectory.back().scene_diff = moveit_msgs::PlanningScene();
+	msg.sub_trajectory.back().scene_diff_index = 1;
+
+	moveit_rviz_plugin::DisplaySolution solution;
+	solution.setFromMessage(scene->diff(), msg);
+	ASSERT_EQ(solution.numSubSolutions(), 3u);
+	ASSERT_EQ(solution.getWayPointCount(), 6u);
+	EXPECT_EQ(solution.indexPair(4), std::make_pair(size_t(1), size_t(1)));
+	EXPECT_EQ(solution.comment(4), "sub 1");
+	EXPECT_EQ(solution.creatorId(solution.indexPair(5)), 3u);
+	EXPECT_DOUBLE_EQ(solution.getWayPointPtr(4)->getVariablePosition("link1-link2-joint"), 0.2);
+
+	// the empty diff of the first sub trajectory reuses the start scene
+	const auto& start = solution.startScene();
+	EXPECT_EQ(solution.scene(0), start);
+	EXPECT_EQ(solution.scene(3), start);
+	// the box is only added by the second sub trajectory, whose scene is shared by the third one
+	const auto& scene_with_box = solution.scene(5);
+	EXPECT_NE(scene_with_box, start);
+	EXPECT_FALSE(start->getWorld()->hasObject("box"));
+	EXPECT_TRUE(scene_with_box->getWorld()->hasObject("box"));
+	EXPECT_EQ(solution.scene(6), scene_with_box);
+
+	// a display solution of a single sub trajectory shares the lazy state of its master
+	moveit_rviz_plugin::DisplaySolution sub(solution, 2);
+	EXPECT_EQ(sub.getWayPointCount(), 1u);
+	EXPECT_EQ(sub.startScene(), scene_with_box);
+
+	// msgs are passed on unchanged, with resolved scene diffs
+	moveit_task_constructor_msgs::Solution filled;
+	solution.fillMessage(filled);
+	ASSERT_EQ(filled.sub_trajectory.size(), 3u);
+	for (size_t i = 0; i != 3; ++i)
+		EXPECT_EQ(filled.sub_trajectory[i].trajectory, msg.sub_trajectory[i].trajectory);
+	ASSERT_EQ(filled.sub_trajectory[1].scene_diff.world.collision_objects.size(), 1u);
+	EXPECT_EQ(filled.sub_trajectory[1].scene_diff.world.collision_objects[0].id, "box");
+}
+
 TEST_F(TaskListModelTest, noChildren) {
 	children = 0;
 	populateAndValidate();
@@ -203,22 +444,22 @@ TEST_F(TaskListModelTest, threeChildren) {
 TEST_F(TaskListModelTest, visitedPopulate) {
 	// first population without children
 	children = 0;
-	model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution");
+	model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution", "get_solutions");
 	validate(model, { "first" });  // validation visits root node
 	EXPECT_EQ(num_inserts, 1);
 
 	children = 3;
 	num_inserts = 0;
-	model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution");
+	model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution", "get_solutions");
 	validate(model, { "first" });
-	// second population with children should emit insert notifies for them
-	EXPECT_EQ(num_inserts, 3);
+	// second population with children should emit a single insert notify for all of them
+	EXPECT_EQ(num_inserts, 1);
 	EXPECT_EQ(num_updates, 0);
 }
 
 TEST_F(TaskListModelTest, deletion) {
 	children = 3;
-	model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution");
+	model.processTaskDescriptionMessage(genMsg("first"), nh, "get_solution", "get_solutions");
 	auto m = model.getModel(model.index(0, 0)).first;
 	int num_deletes = 0;
 	QObject::connect(m, &QObject::destroyed, [&num_deletes]() { ++num_deletes; });
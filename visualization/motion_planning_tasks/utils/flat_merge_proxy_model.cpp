@@ -35,8 +35,9 @@
 /* Author: Robert Haschke */
 
 #include "flat_merge_proxy_model.h"
+#include <algorithm>
+#include <unordered_map>
 #include <vector>
-#include <numeric>
 
 namespace moveit_rviz_plugin {
 namespace utils {
@@ -93,11 +94,13 @@ public:
 			}
 			return !invalidated_mappings_.empty();
 		}
-		bool rowsRemoved() {
+		bool rowsRemoved(std::unordered_map<void*, const QAbstractItemModel*>& owners) {
 			bool affected = !invalidated_mappings_.empty();
 			// remove invalidated mappings
-			for (auto it : invalidated_mappings_)
+			for (auto it : invalidated_mappings_) {
+				owners.erase(it->first);
 				proxy_to_source_mapping_.erase(it);
+			}
 			invalidated_mappings_.clear();
 			return affected;
 		}
@@ -105,28 +108,53 @@ public:
 
 	// top-level items
 	std::vector<ModelData> data_;
+	// position of each model in data_
+	std::unordered_map<const QObject*, size_t> positions_;
+	// prefix sums of the models' top-level row counts: data_[i]'s rows start at row_offsets_[i], total at back()
+	std::vector<int> row_offsets_{ 0 };
+	// source model of all mapped internal pointers, avoiding to search the mappings of all models
+	mutable std::unordered_map<void*, const QAbstractItemModel*> owners_;
 
 public:
 	FlatMergeProxyModelPrivate(FlatMergeProxyModel* model) : q_ptr(model) {}
 
 	std::vector<ModelData>::iterator find(const QObject* model) {
 		Q_ASSERT(model);
-		return std::find_if(data_.begin(), data_.end(), [model](const auto& data) { return data.model_ == model; });
+		auto it = positions_.find(model);
+		return it == positions_.end() ? data_.end() : data_.begin() + it->second;
 	}
-
-	int accumulatedRowCount(std::vector<ModelData>::const_iterator start,
-	                        std::vector<ModelData>::const_iterator end) const {
-		return std::accumulate(start, end, 0, [](int acc, const auto& d) { return acc + d.model_->rowCount(); });
+	ModelData& modelData(const QObject* model) const {
+		Q_ASSERT(positions_.count(model));
+		return const_cast<ModelData&>(data_[positions_.at(model)]);
 	}
-	int rowOffset(QObject* model) {
-		int result = 0;
-		for (const ModelData& d : data_) {
-			if (d.model_ == model)
-				return result;
-			result += d.model_->rowCount();
+
+	// rebuild positions_ and row_offsets_ after changes to data_
+	void updateIndex() {
+		positions_.clear();
+		row_offsets_.resize(data_.size() + 1);
+		for (size_t i = 0; i < data_.size(); ++i) {
+			positions_[data_[i].model_] = i;
+			row_offsets_[i + 1] = row_offsets_[i] + data_[i].model_->rowCount();
 		}
-		Q_ASSERT(false);
-		return 0;
+	}
+	// account for top-level rows inserted into (delta > 0) or removed from (delta < 0) model
+	void shiftRowOffsets(const QObject* model, int delta) {
+		for (size_t i = positions_.at(model) + 1; i < row_offsets_.size(); ++i)
+			row_offsets_[i] += delta;
+	}
+	int totalRowCount() const { return row_offsets_.back(); }
+	int rowOffset(const QObject* model) const { return row_offsets_[positions_.at(model)]; }
+	// position in data_ of the model providing the given top-level row, data_.size() if out of range
+	size_t modelAtRow(int row) const {
+		if (row >= totalRowCount())
+			return data_.size();
+		// last model starting at or before row, skipping empty ones
+		return std::upper_bound(row_offsets_.begin(), row_offsets_.end(), row) - row_offsets_.begin() - 1;
+	}
+
+	void storeMapping(ModelData& data, void* src_internal_pointer, const QModelIndex& src_parent) const {
+		data.storeMapping(src_internal_pointer, src_parent);
+		owners_[src_internal_pointer] = data.model_;
 	}
 
 	// retrieve the source_index corresponding to proxy_index
@@ -134,24 +162,22 @@ public:
 		Q_ASSERT(proxy_index.isValid());
 		Q_ASSERT(proxy_index.model() == q_ptr);
 
-		int prev_rows = 0;  // accumulated rows from previous models
-		for (const ModelData& d : data_) {
-			// internal_pointer points to source parent
-			auto it = d.proxy_to_source_mapping_.find(proxy_index.internalPointer());
-			if (it != d.proxy_to_source_mapping_.end()) {
-				data = const_cast<ModelData*>(&d);
-				const QModelIndex& src_index = it->second;
-				int row = proxy_index.row();
+		// internal_pointer points to source parent
+		auto owner = owners_.find(proxy_index.internalPointer());
+		if (owner == owners_.end()) {
+			Q_ASSERT(false);
+			return QModelIndex();
+		}
+		data = &modelData(owner->second);
+		auto it = data->proxy_to_source_mapping_.find(proxy_index.internalPointer());
+		Q_ASSERT(it != data->proxy_to_source_mapping_.end());
+		const QModelIndex& src_index = it->second;
+		int row = proxy_index.row();
 
-				if (!src_index.isValid())  // top-level item of embedded model
-					row -= prev_rows;  // need to reduce row by number of previous' models rows
+		if (!src_index.isValid())  // top-level item of embedded model
+			row -= rowOffset(data->model_);  // need to reduce row by number of previous' models rows
 
-				return d.model_->index(row, proxy_index.column(), src_index);
-			}
-			prev_rows += d.model_->rowCount();
-		}
-		Q_ASSERT(false);
-		return QModelIndex();
+		return data->model_->index(row, proxy_index.column(), src_index);
 	}
 
 	QModelIndex mapFromSource(const QModelIndex& src, ModelData* data = nullptr) const {
@@ -161,20 +187,13 @@ public:
 		QModelIndex src_parent = src.parent();
 		int prev_rows = 0;
 		if (!src_parent.isValid()) {  // src is top-level item
-			auto it = data_.begin(), end = data_.end();
-			for (; it != end; ++it) {
-				if (it->model_ == src.model()) {
-					data = &const_cast<ModelData&>(*it);
-					break;
-				}
-				prev_rows += it->model_->rowCount();
-			}
-			Q_ASSERT(it != end);
+			data = &modelData(src.model());
+			prev_rows = rowOffset(src.model());
 		}
 
 		// store source index in mapping: easy, if we already know the correspondig model (coming top-down)
 		if (data)
-			data->storeMapping(src.internalPointer(), src_parent);
+			storeMapping(*data, src.internalPointer(), src_parent);
 		// coming bottom-up, we need to climb the tree until we reach root and can lookup the model
 		else
 			mapSourceIndexes(src, data);
@@ -189,20 +208,15 @@ public:
 		const QModelIndex& src_parent = src.parent();
 		if (!src_parent.isValid()) {  // reached root
 			// figure out corresponding ModelData from src.model()
-			for (const ModelData& d : data_) {
-				if (d.model_ == src.model()) {
-					data = const_cast<ModelData*>(&d);
-					data->storeMapping(src.internalPointer(), src_parent);
-					return;
-				}
-			}
-			Q_ASSERT(false);  // src should be part of our model!
+			data = &modelData(src.model());
+			storeMapping(*data, src.internalPointer(), src_parent);
+			return;
 		}
 
 		// recursively climb the tree
 		mapSourceIndexes(src_parent, data);
 		// now data should be well-defined
-		data->storeMapping(src.internalPointer(), src_parent);
+		storeMapping(*data, src.internalPointer(), src_parent);
 	}
 
 	// remove model referenced by it, call indicates that onRemoveModel() should be called
@@ -251,7 +265,7 @@ int FlatMergeProxyModel::rowCount(const QModelIndex& parent) const {
 		return 0;
 
 	if (!parent.isValid())  // root
-		return d_ptr->accumulatedRowCount(d_ptr->data_.begin(), d_ptr->data_.end());
+		return d_ptr->totalRowCount();
 
 	FlatMergeProxyModelPrivate::ModelData* data = nullptr;
 	QModelIndex src_parent = d_ptr->mapToSource(parent, data);
@@ -275,18 +289,15 @@ QModelIndex FlatMergeProxyModel::index(int row, int column, const QModelIndex& p
 		return QModelIndex();
 
 	if (!parent.isValid()) {  // top-level items
-		int prev_rows = 0;
-		for (FlatMergeProxyModelPrivate::ModelData& d : const_cast<FlatMergeProxyModelPrivate*>(d_ptr)->data_) {
-			int rows = d.model_->rowCount();
-			if (row - prev_rows < rows) {
-				const QModelIndex& src_index = d.model_->index(row - prev_rows, column, QModelIndex());
-				// for top-level item, internal pointer refers to model
-				d.storeMapping(src_index.internalPointer(), QModelIndex());
-				return createIndex(row, column, src_index.internalPointer());
-			}
-			prev_rows += rows;
-		}
-		return QModelIndex();  // row is too large
+		const size_t pos = d_ptr->modelAtRow(row);
+		if (pos >= d_ptr->data_.size())
+			return QModelIndex();  // row is too large
+
+		auto& d = const_cast<FlatMergeProxyModelPrivate::ModelData&>(d_ptr->data_[pos]);
+		const QModelIndex& src_index = d.model_->index(row - d_ptr->row_offsets_[pos], column, QModelIndex());
+		// for top-level item, internal pointer refers to model
+		d_ptr->storeMapping(d, src_index.internalPointer(), QModelIndex());
+		return createIndex(row, column, src_index.internalPointer());
 	}
 
 	// other items need to refer to operation on source model
@@ -415,20 +426,15 @@ bool FlatMergeProxyModel::insertModel(QAbstractItemModel* model, int pos) {
 	if (pos < 0)
 		pos = modelCount() + std::max<int>(pos + 1, -modelCount());
 	Q_ASSERT(pos >= 0 && pos <= static_cast<int>(modelCount()));
+	if (d_ptr->positions_.count(model))
+		return false;  // model can only inserted once
 	auto it = d_ptr->data_.begin();
 	std::advance(it, pos);
 
-	int row = 0;
-	for (const auto& d : d_ptr->data_) {
-		if (d.model_ == model)
-			return false;  // model can only inserted once
-		// accumulate rowCount() of models before pos
-		if (--pos >= 0)
-			row += d.model_->rowCount();
-	}
-
+	int row = d_ptr->row_offsets_[pos];
 	beginInsertRows(QModelIndex(), row, row + model->rowCount() - 1);
 	d_ptr->data_.insert(it, FlatMergeProxyModelPrivate::ModelData(model));
+	d_ptr->updateIndex();
 	endInsertRows();
 
 	connect(model, SIGNAL(destroyed(QObject*)), this, SLOT(_q_sourceDestroyed(QObject*)));
@@ -502,11 +508,15 @@ bool FlatMergeProxyModelPrivate::removeModel(std::vector<ModelData>::iterator it
 	if (it == data_.end())
 		return false;
 
-	int row = accumulatedRowCount(data_.begin(), it);
-	q_ptr->beginRemoveRows(QModelIndex(), row, row + it->model_->rowCount() - 1);
+	// use cached row counts: the model might be destroyed already
+	const size_t pos = it - data_.begin();
+	q_ptr->beginRemoveRows(QModelIndex(), row_offsets_[pos], row_offsets_[pos + 1] - 1);
 	if (call)
 		q_ptr->onRemoveModel(it->model_);
+	for (const auto& mapping : it->proxy_to_source_mapping_)
+		owners_.erase(mapping.first);
 	it = data_.erase(it);
+	updateIndex();
 	q_ptr->endRemoveRows();
 	return true;
 }
@@ -543,32 +553,29 @@ void FlatMergeProxyModelPrivate::_q_sourceRowsAboutToBeRemoved(const QModelIndex
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 void FlatMergeProxyModelPrivate::_q_sourceRowsInserted(const QModelIndex& parent, int start, int end) {
-	Q_UNUSED(parent)
-	Q_UNUSED(start)
-	Q_UNUSED(end)
+	if (!parent.isValid())
+		shiftRowOffsets(q_ptr->sender(), end - start + 1);
 	q_ptr->endInsertRows();
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 void FlatMergeProxyModelPrivate::_q_sourceRowsMoved(const QModelIndex& sourceParent, int sourceStart, int sourceEnd,
                                                     const QModelIndex& destParent, int dest) {
-	Q_UNUSED(sourceParent)
 	Q_UNUSED(sourceStart)
 	Q_UNUSED(sourceEnd)
-	Q_UNUSED(destParent)
 	Q_UNUSED(dest)
+	if (sourceParent.isValid() != destParent.isValid())  // top-level row count changed
+		updateIndex();
 	q_ptr->endMoveRows();
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 void FlatMergeProxyModelPrivate::_q_sourceRowsRemoved(const QModelIndex& parent, int start, int end) {
-	Q_UNUSED(parent)
-	Q_UNUSED(start)
-	Q_UNUSED(end)
-
 	auto it = find(q_ptr->sender());
 	Q_ASSERT(it != data_.end());
-	if (it->rowsRemoved())
+	if (!parent.isValid())
+		shiftRowOffsets(it->model_, start - end - 1);
+	if (it->rowsRemoved(owners_))
 		q_ptr->endRemoveRows();
 }
 
@@ -35,6 +35,7 @@
 /* Author: Robert Haschke */
 
 #include "tree_merge_proxy_model.h"
+#include <unordered_map>
 #include <vector>
 
 namespace moveit_rviz_plugin {
@@ -94,11 +95,13 @@ public:
 			}
 			return !invalidated_mappings_.empty();
 		}
-		bool rowsRemoved() {
+		bool rowsRemoved(std::unordered_map<void*, const QAbstractItemModel*>& owners) {
 			bool affected = !invalidated_mappings_.empty();
 			// remove invalidated mappings
-			for (auto it : invalidated_mappings_)
+			for (auto it : invalidated_mappings_) {
+				owners.erase(it->first);
 				proxy_to_source_mapping_.erase(it);
+			}
 			invalidated_mappings_.clear();
 			return affected;
 		}
@@ -106,13 +109,39 @@ public:
 
 	// top-level items
 	std::vector<ModelData> data_;
+	// position of each model in data_, i.e. row of its group item
+	std::unordered_map<const QObject*, size_t> positions_;
+	// source model of all mapped internal pointers, avoiding to search the mappings of all models
+	mutable std::unordered_map<void*, const QAbstractItemModel*> owners_;
 
 public:
 	TreeMergeProxyModelPrivate(TreeMergeProxyModel* model) : q_ptr(model) {}
 
 	std::vector<ModelData>::iterator find(const QObject* model) {
 		Q_ASSERT(model);
-		return std::find_if(data_.begin(), data_.end(), [model](const auto& data) { return data.model_ == model; });
+		auto it = positions_.find(model);
+		return it == positions_.end() ? data_.end() : data_.begin() + it->second;
+	}
+	ModelData& modelData(const QObject* model) const {
+		Q_ASSERT(positions_.count(model));
+		return const_cast<ModelData&>(data_[positions_.at(model)]);
+	}
+
+	// rebuild positions_ after changes to data_
+	void updateIndex() {
+		positions_.clear();
+		for (size_t i = 0; i < data_.size(); ++i)
+			positions_[data_[i].model_] = i;
+	}
+
+	void storeMapping(ModelData& data, void* src_internal_pointer, const QModelIndex& src_parent) const {
+		data.storeMapping(src_internal_pointer, src_parent);
+		owners_[src_internal_pointer] = data.model_;
+	}
+	// forget all mappings of given model
+	void eraseMappings(const ModelData& data) {
+		for (const auto& mapping : data.proxy_to_source_mapping_)
+			owners_.erase(mapping.first);
 	}
 
 	// retrieve the source_index corresponding to proxy_index
@@ -125,35 +154,31 @@ public:
 			return QModelIndex();
 		}
 
-		for (const ModelData& d : data_) {
-			// internal_pointer points to source parent
-			auto it = d.proxy_to_source_mapping_.find(proxy_index.internalPointer());
-			if (it != d.proxy_to_source_mapping_.end()) {
-				data = const_cast<ModelData*>(&d);
-				return d.model_->index(proxy_index.row(), proxy_index.column(), it->second);
-			}
+		// internal_pointer points to source parent
+		auto owner = owners_.find(proxy_index.internalPointer());
+		if (owner == owners_.end()) {
+			Q_ASSERT(false);
+			return QModelIndex();
 		}
-		Q_ASSERT(false);
-		return QModelIndex();
+		data = &modelData(owner->second);
+		auto it = data->proxy_to_source_mapping_.find(proxy_index.internalPointer());
+		Q_ASSERT(it != data->proxy_to_source_mapping_.end());
+		return data->model_->index(proxy_index.row(), proxy_index.column(), it->second);
 	}
 
 	QModelIndex mapFromSource(const QModelIndex& src, ModelData* data = nullptr) const {
 		if (!src.isValid()) {  // root src index: map to group item
 			QObject* model = data ? data->model_ : q_ptr->sender();
-			Q_ASSERT(model);
-			for (int row = 0, end = data_.size(); row != end; ++row) {
-				if (data_.at(row).model_ == model)
-					// for top-level items, internal pointer refers to this model
-					return q_ptr->createIndex(row, 0, q_ptr);
-			}
-			Q_ASSERT(false);
+			Q_ASSERT(model && positions_.count(model));
+			// for top-level items, internal pointer refers to this model
+			return q_ptr->createIndex(positions_.at(model), 0, q_ptr);
 		}
 
 		QModelIndex src_parent = src.parent();
 
 		// store source index in mapping: easy, if we already know the correspondig model (coming top-down)
 		if (data)
-			data->storeMapping(src.internalPointer(), src_parent);
+			storeMapping(*data, src.internalPointer(), src_parent);
 		// coming bottom-up, we need to climb the tree until we reach root and can lookup the model
 		else
 			mapSourceIndexes(src, data);
@@ -168,27 +193,20 @@ public:
 		const QModelIndex& src_parent = src.parent();
 		if (!src_parent.isValid()) {  // reached root
 			// figure out corresponding ModelData from src.model()
-			for (const ModelData& d : data_) {
-				if (d.model_ == src.model()) {
-					data = const_cast<ModelData*>(&d);
-					data->storeMapping(src.internalPointer(), src_parent);
-					return;
-				}
-			}
-			Q_ASSERT(false);  // src should be part of our model!
+			data = &modelData(src.model());
+			storeMapping(*data, src.internalPointer(), src_parent);
+			return;
 		}
 
 		// recursively climb the tree
 		mapSourceIndexes(src_parent, data);
 		// now data should be well-defined
-		data->storeMapping(src.internalPointer(), src_parent);
+		storeMapping(*data, src.internalPointer(), src_parent);
 	}
 
 	std::vector<ModelData>::iterator getModelIterator(const QAbstractItemModel* model) {
-		for (auto it = data_.begin(), end = data_.end(); it != end; ++it)
-			if (it->model_ == model)
-				return it;
-		return data_.end();
+		auto it = positions_.find(model);
+		return it == positions_.end() ? data_.end() : data_.begin() + it->second;
 	}
 
 	bool removeModel(std::vector<ModelData>::iterator it, bool call);
@@ -371,8 +389,12 @@ bool TreeMergeProxyModel::removeRows(int row, int count, const QModelIndex& pare
 		std::advance(last, count);
 
 		beginRemoveRows(QModelIndex(), row, row + count - 1);
-		std::for_each(first, last, [this](const auto& data) { this->onRemoveModel(data.model_); });
+		std::for_each(first, last, [this](const auto& data) {
+			this->onRemoveModel(data.model_);
+			d_ptr->eraseMappings(data);
+		});
 		d_ptr->data_.erase(first, last);
+		d_ptr->updateIndex();
 		endRemoveRows();
 		return true;
 	} else {
@@ -387,9 +409,8 @@ bool TreeMergeProxyModel::insertModel(const QString& name, QAbstractItemModel* m
 		return false;  // invalid model
 	if (!d_ptr->data_.empty() && model->columnCount() != columnCount())
 		return false;  // all models must have same column count
-	for (const auto& d : d_ptr->data_)
-		if (d.model_ == model)
-			return false;  // model can only inserted once
+	if (d_ptr->positions_.count(model))
+		return false;  // model can only inserted once
 
 	// limit pos to range [0, modelCount()]
 	if (pos > 0 && pos > static_cast<int>(modelCount()))
@@ -402,6 +423,7 @@ bool TreeMergeProxyModel::insertModel(const QString& name, QAbstractItemModel* m
 
 	beginInsertRows(QModelIndex(), pos, pos);
 	d_ptr->data_.insert(it, TreeMergeProxyModelPrivate::ModelData(name, model));
+	d_ptr->updateIndex();
 	endInsertRows();
 
 	connect(model, SIGNAL(destroyed(QObject*)), this, SLOT(_q_sourceDestroyed(QObject*)));
@@ -484,7 +506,9 @@ bool TreeMergeProxyModelPrivate::removeModel(std::vector<ModelData>::iterator it
 	q_ptr->beginRemoveRows(QModelIndex(), row, row);
 	if (call)
 		q_ptr->onRemoveModel(it->model_);
+	eraseMappings(*it);
 	data_.erase(it);
+	updateIndex();
 	q_ptr->endRemoveRows();
 	return true;
 }
@@ -540,7 +564,7 @@ void TreeMergeProxyModelPrivate::_q_sourceRowsRemoved(const QModelIndex& parent,
 
 	auto it = find(q_ptr->sender());
 	Q_ASSERT(it != data_.end());
-	if (it->rowsRemoved())
+	if (it->rowsRemoved(owners_))
 		q_ptr->endRemoveRows();
 }
 
@@ -38,6 +38,7 @@
 
 #include <moveit_task_constructor_msgs/Solution.h>
 #include <moveit/macros/class_forward.h>
+#include <memory>
 
 namespace moveit {
 namespace core {
@@ -47,6 +48,12 @@ MOVEIT_CLASS_FORWARD(RobotState);
 namespace planning_scene {
 MOVEIT_CLASS_FORWARD(PlanningScene);
 }
+namespace moveit {
+namespace task_constructor {
+class SolutionBase;
+class Introspection;
+}  // namespace task_constructor
+}  // namespace moveit
 namespace robot_trajectory {
 MOVEIT_CLASS_FORWARD(RobotTrajectory);
 }
@@ -62,7 +69,11 @@ namespace moveit_rviz_plugin {
 MOVEIT_CLASS_FORWARD(DisplaySolution);
 MOVEIT_CLASS_FORWARD(MarkerVisualization);
 
-/** Class representing a task solution for display */
+/** Class representing a task solution for display
+ *
+ * Scenes, trajectories, and markers of sub trajectories are only created from their msgs when first accessed.
+ * Solutions of an in-process task share their scenes and trajectories directly.
+ */
 class DisplaySolution
 {
 	/// number of overall steps
@@ -70,22 +81,9 @@ class DisplaySolution
 	/// start scene
 	planning_scene::PlanningSceneConstPtr start_scene_;
 
-	struct Data
-	{
-		/// end scene for each sub trajectory
-		planning_scene::PlanningSceneConstPtr scene_;
-		/// sub trajectories, might be empty
-		robot_trajectory::RobotTrajectoryPtr trajectory_;
-		/// joints involved in the trajectory
-		std::vector<std::string> joints_;
-		/// comment of the trajectory
-		std::string comment_;
-		/// id of creating stage
-		uint32_t creator_id_;
-		/// rviz markers
-		MarkerVisualizationPtr markers_;
-	};
-	std::vector<Data> data_;
+	/// sub trajectory, lazily converted from its msg
+	class Data;
+	std::vector<std::shared_ptr<Data>> data_;
 
 public:
 	DisplaySolution() = default;
@@ -109,23 +107,22 @@ public:
 	}
 	const moveit::core::RobotStatePtr& getWayPointPtr(const IndexPair& idx_pair) const;
 	const moveit::core::RobotStatePtr& getWayPointPtr(size_t index) const { return getWayPointPtr(indexPair(index)); }
-	const planning_scene::PlanningSceneConstPtr& startScene() const { return start_scene_; }
+	const planning_scene::PlanningSceneConstPtr& startScene() const;
 	const planning_scene::PlanningSceneConstPtr& scene(const IndexPair& idx_pair) const;
-	const planning_scene::PlanningSceneConstPtr& scene(size_t index) const {
-		if (index >= steps_)
-			return data_.back().scene_;
-		return scene(indexPair(index));
-	}
+	const planning_scene::PlanningSceneConstPtr& scene(size_t index) const;
 	const std::string& comment(const IndexPair& idx_pair) const;
 	const std::string& comment(size_t index) const { return comment(indexPair(index)); }
 	uint32_t creatorId(const IndexPair& idx_pair) const;
 
 	const MarkerVisualizationPtr markers(const IndexPair& idx_pair) const;
 	const MarkerVisualizationPtr markers(size_t index) const { return markers(indexPair(index)); }
-	const MarkerVisualizationPtr markersOfSubTrajectory(size_t index) const { return data_.at(index).markers_; }
+	const MarkerVisualizationPtr markersOfSubTrajectory(size_t index) const;
 
 	void setFromMessage(const planning_scene::PlanningScenePtr& start_scene,
 	                    const moveit_task_constructor_msgs::Solution& msg);
+	/// share scenes and trajectories of an in-process solution, skipping msg conversion
+	void setFromSolution(const moveit::task_constructor::SolutionBase& solution,
+	                     moveit::task_constructor::Introspection* introspection = nullptr);
 	void fillMessage(moveit_task_constructor_msgs::Solution& msg) const;
 };
 }  // namespace moveit_rviz_plugin
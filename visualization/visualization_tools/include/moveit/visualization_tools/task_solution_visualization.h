@@ -144,6 +144,8 @@ protected:
 	void setVisibility(Ogre::SceneNode* node, Ogre::SceneNode* parent, bool visible);
 	float getStateDisplayTime();
 	void clearTrail();
+	void releaseTrail();
+	int nextWayPoint(int index) const;
 	void renderCurrentWayPoint();
 	void renderWayPoint(size_t index, int previous_index);
 	void renderPlanningScene(const planning_scene::PlanningSceneConstPtr& scene);
@@ -161,7 +163,8 @@ protected:
 
 	DisplaySolutionPtr displaying_solution_;
 	DisplaySolutionPtr next_solution_to_display_;
-	std::vector<rviz::Robot*> trail_;
+	std::vector<rviz::Robot*> trail_;  // pool of trail robots, reused across solutions
+	std::vector<int> trail_waypoints_;  // waypoint indexes shown by the first trail_ robots
 	bool animating_ = false;  // auto-progressing the current waypoint?
 	bool drop_displaying_solution_ = false;
 	bool locked_ = false;
@@ -194,6 +197,8 @@ protected:
 	rviz::BoolProperty* trail_display_property_;
 	rviz::BoolProperty* interrupt_display_property_;
 	rviz::IntProperty* trail_step_size_property_;
+	rviz::IntProperty* trail_max_robots_property_;
+	rviz::FloatProperty* waypoint_min_distance_property_;
 
 	// PlanningScene Properties
 	rviz::BoolProperty* scene_enabled_property_;
@@ -36,54 +36,185 @@
 
 #include <moveit/visualization_tools/display_solution.h>
 #include <moveit/visualization_tools/marker_visualization.h>
+#include <moveit/task_constructor/storage.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <ros/console.h>
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <mutex>
+
 namespace moveit_rviz_plugin {
 
+namespace {
+// whether applying the diff leaves a scene unchanged for display (ignoring its name)
+bool isEmptyDiff(const moveit_msgs::PlanningScene& diff) {
+	const auto& state = diff.robot_state;
+	const auto& world = diff.world;
+	return diff.is_diff && diff.fixed_frame_transforms.empty() &&
+	       diff.allowed_collision_matrix.entry_names.empty() && diff.allowed_collision_matrix.default_entry_names.empty() &&
+	       diff.link_padding.empty() && diff.link_scale.empty() && diff.object_colors.empty() &&
+	       state.joint_state.name.empty() && state.multi_dof_joint_state.joint_names.empty() &&
+	       state.attached_collision_objects.empty() && world.collision_objects.empty() &&
+	       world.octomap.octomap.id.empty() && world.octomap.octomap.data.empty();
+}
+}  // namespace
+
+class DisplaySolution::Data
+{
+	/// previous sub trajectory, providing the start scene
+	const std::shared_ptr<Data> prev_;
+	/// start scene of the first sub trajectory
+	const planning_scene::PlanningSceneConstPtr start_scene_;
+	/// sub trajectory msg with resolved scene diff
+	moveit_task_constructor_msgs::SubTrajectory msg_;
+	size_t waypoints_;
+	/// msg_ only holds the info, scene_ and trajectory_ are set from the start
+	const bool in_process_ = false;
+
+	// created on first access
+	std::mutex mutex_;
+	planning_scene::PlanningSceneConstPtr scene_;
+	robot_trajectory::RobotTrajectoryPtr trajectory_;
+	MarkerVisualizationPtr markers_;
+
+public:
+	Data(const std::shared_ptr<Data>& prev, const planning_scene::PlanningSceneConstPtr& start_scene,
+	     const moveit_task_constructor_msgs::SubTrajectory& sub, const moveit_msgs::PlanningScene& scene_diff)
+	  : prev_(prev), start_scene_(start_scene) {
+		msg_.info = sub.info;
+		msg_.trajectory = sub.trajectory;
+		msg_.scene_diff = scene_diff;
+		// as counted by RobotTrajectory::setRobotTrajectoryMsg()
+		waypoints_ = std::max(sub.trajectory.joint_trajectory.points.size(),
+		                      sub.trajectory.multi_dof_joint_trajectory.points.size());
+	}
+
+	/// in-process sub trajectory: scene and trajectory are shared, msgs are only created by fillMessage()
+	Data(const std::shared_ptr<Data>& prev, const moveit::task_constructor::SubTrajectory& sub,
+	     moveit::task_constructor::Introspection* introspection)
+	  : prev_(prev), start_scene_(sub.start()->scene()), in_process_(true) {
+		sub.fillInfo(msg_.info, introspection);
+		scene_ = sub.end()->scene() ? sub.end()->scene() : startScene();  // scene might be evicted
+		if (sub.trajectory())  // shallow copy, sharing the waypoints
+			trajectory_.reset(new robot_trajectory::RobotTrajectory(*sub.trajectory()));
+		else
+			trajectory_.reset(new robot_trajectory::RobotTrajectory(scene_->getRobotModel(), nullptr));
+		waypoints_ = trajectory_->getWayPointCount();
+	}
+
+	const moveit_task_constructor_msgs::SubTrajectory& msg() const { return msg_; }
+	size_t waypointCount() const { return waypoints_; }
+
+	const planning_scene::PlanningSceneConstPtr& startScene() { return prev_ ? prev_->endScene() : start_scene_; }
+
+	const planning_scene::PlanningSceneConstPtr& endScene() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!scene_) {
+			const planning_scene::PlanningSceneConstPtr& start = startScene();
+			if (isEmptyDiff(msg_.scene_diff))
+				scene_ = start;  // share unchanged scenes
+			else {
+				planning_scene::PlanningScenePtr scene = start->diff();
+				scene->setPlanningSceneDiffMsg(msg_.scene_diff);
+				scene_ = scene;
+			}
+		}
+		return scene_;
+	}
+
+	const robot_trajectory::RobotTrajectoryPtr& trajectory() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!trajectory_) {
+			const planning_scene::PlanningSceneConstPtr& start = startScene();
+			trajectory_.reset(new robot_trajectory::RobotTrajectory(start->getRobotModel(), nullptr));
+			trajectory_->setRobotTrajectoryMsg(start->getCurrentState(), msg_.trajectory);
+		}
+		return trajectory_;
+	}
+
+	void fillMessage(moveit_task_constructor_msgs::SubTrajectory& msg) {
+		if (!in_process_) {
+			msg.scene_diff = msg_.scene_diff;
+			msg.trajectory = msg_.trajectory;
+			return;
+		}
+		trajectory()->getRobotTrajectoryMsg(msg.trajectory);
+		const planning_scene::PlanningSceneConstPtr& end = endScene();
+		if (end->getParent() == startScene())
+			end->getPlanningSceneDiffMsg(msg.scene_diff);
+		else if (end != startScene())
+			end->getPlanningSceneMsg(msg.scene_diff);
+		else
+			msg.scene_diff.is_diff = true;
+	}
+
+	MarkerVisualizationPtr markers() {
+		if (msg_.info.markers.empty())
+			return MarkerVisualizationPtr();
+		const planning_scene::PlanningSceneConstPtr& scene = endScene();
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!markers_)
+			markers_.reset(new MarkerVisualization(msg_.info.markers, *scene));
+		return markers_;
+	}
+};
+
 std::pair<size_t, size_t> DisplaySolution::indexPair(size_t index) const {
 	size_t part = 0;
 	for (const auto& d : data_) {
-		if (index < d.trajectory_->getWayPointCount())
+		if (index < d->waypointCount())
 			break;
-		index -= d.trajectory_->getWayPointCount();
+		index -= d->waypointCount();
 		++part;
 	}
 	assert(part < data_.size());
-	assert(index < data_[part].trajectory_->getWayPointCount());
+	assert(index < data_[part]->waypointCount());
 	return std::make_pair(part, index);
 }
 
 DisplaySolution::DisplaySolution(const DisplaySolution& master, uint32_t sub)
-  : start_scene_(sub == 0 ? master.start_scene_ : master.data_[sub - 1].scene_), data_({ master.data_[sub] }) {
-	steps_ = data_.front().trajectory_->getWayPointCount();
+  : start_scene_(master.start_scene_), data_({ master.data_[sub] }) {
+	steps_ = data_.front()->waypointCount();
 }
 
 float DisplaySolution::getWayPointDurationFromPrevious(const IndexPair& idx_pair) const {
-	return data_[idx_pair.first].trajectory_->getWayPointDurationFromPrevious(idx_pair.second);
+	return data_[idx_pair.first]->trajectory()->getWayPointDurationFromPrevious(idx_pair.second);
 }
 
 const moveit::core::RobotStatePtr& DisplaySolution::getWayPointPtr(const IndexPair& idx_pair) const {
-	return data_[idx_pair.first].trajectory_->getWayPointPtr(idx_pair.second);
+	return data_[idx_pair.first]->trajectory()->getWayPointPtr(idx_pair.second);
+}
+
+const planning_scene::PlanningSceneConstPtr& DisplaySolution::startScene() const {
+	return data_.empty() ? start_scene_ : data_.front()->startScene();
 }
 
 const planning_scene::PlanningSceneConstPtr& DisplaySolution::scene(const IndexPair& idx_pair) const {
-	// start scene is parent of end scene
-	return data_[idx_pair.first].scene_->getParent();
+	return data_[idx_pair.first]->startScene();
+}
+
+const planning_scene::PlanningSceneConstPtr& DisplaySolution::scene(size_t index) const {
+	if (index >= steps_)
+		return data_.back()->endScene();
+	return scene(indexPair(index));
 }
 
 const std::string& DisplaySolution::comment(const IndexPair& idx_pair) const {
-	return data_[idx_pair.first].comment_;
+	return data_[idx_pair.first]->msg().info.comment;
 }
 
 uint32_t DisplaySolution::creatorId(const DisplaySolution::IndexPair& idx_pair) const {
-	return data_[idx_pair.first].creator_id_;
+	return data_[idx_pair.first]->msg().info.stage_id;
 }
 
 const MarkerVisualizationPtr DisplaySolution::markers(const DisplaySolution::IndexPair& idx_pair) const {
-	return data_[idx_pair.first].markers_;
+	return data_[idx_pair.first]->markers();
+}
+
+const MarkerVisualizationPtr DisplaySolution::markersOfSubTrajectory(size_t index) const {
+	return data_.at(index)->markers();
 }
 
 void DisplaySolution::setFromMessage(const planning_scene::PlanningScenePtr& start_scene,
@@ -96,44 +227,45 @@ void DisplaySolution::setFromMessage(const planning_scene::PlanningScenePtr& sta
 	// initialize parent scene from solution's start scene
 	start_scene->setPlanningSceneMsg(msg.start_scene);
 	start_scene_ = start_scene;
-	planning_scene::PlanningScenePtr ref_scene = start_scene_->diff();
-
-	data_.resize(msg.sub_trajectory.size());
 
+	data_.clear();
+	data_.reserve(msg.sub_trajectory.size());
 	steps_ = 0;
-	size_t i = 0;
+	std::shared_ptr<Data> prev;
 	for (const auto& sub : msg.sub_trajectory) {
-		data_[i].trajectory_.reset(new robot_trajectory::RobotTrajectory(ref_scene->getRobotModel(), nullptr));
-		data_[i].trajectory_->setRobotTrajectoryMsg(ref_scene->getCurrentState(), sub.trajectory);
-		data_[i].joints_ = sub.trajectory.joint_trajectory.joint_names;
-		data_[i].joints_.insert(data_[i].joints_.end(), sub.trajectory.multi_dof_joint_trajectory.joint_names.begin(),
-		                        sub.trajectory.multi_dof_joint_trajectory.joint_names.end());
-		data_[i].comment_ = sub.info.comment;
-		data_[i].creator_id_ = sub.info.stage_id;
-		steps_ += data_[i].trajectory_->getWayPointCount();
-
-		ref_scene->setPlanningSceneDiffMsg(sub.scene_diff);
-		data_[i].scene_ = ref_scene;
-
-		// create new reference scene for next iteration
-		ref_scene = ref_scene->diff();
-
-		if (!sub.info.markers.empty())
-			data_[i].markers_.reset(new MarkerVisualization(sub.info.markers, *ref_scene));
-		else
-			data_[i].markers_.reset();
-		++i;
+		// scene diffs might be stored in the scene table
+		const moveit_msgs::PlanningScene& diff =
+		    (sub.scene_diff_index > 0 && sub.scene_diff_index <= msg.scene_table.size()) ?
+		        msg.scene_table[sub.scene_diff_index - 1] :
+		        sub.scene_diff;
+		prev = std::make_shared<Data>(prev, start_scene_, sub, diff);
+		data_.push_back(prev);
+		steps_ += prev->waypointCount();
 	}
 }
 
 void DisplaySolution::fillMessage(moveit_task_constructor_msgs::Solution& msg) const {
-	start_scene_->getPlanningSceneMsg(msg.start_scene);
+	startScene()->getPlanningSceneMsg(msg.start_scene);
 	msg.sub_trajectory.resize(data_.size());
 	auto traj_it = msg.sub_trajectory.begin();
-	for (const auto& sub : data_) {
-		sub.scene_->getPlanningSceneDiffMsg(traj_it->scene_diff);
-		sub.trajectory_->getRobotTrajectoryMsg(traj_it->trajectory, sub.joints_);
-		++traj_it;
+	for (const auto& sub : data_)
+		sub->fillMessage(*traj_it++);
+}
+
+void DisplaySolution::setFromSolution(const moveit::task_constructor::SolutionBase& solution,
+                                      moveit::task_constructor::Introspection* introspection) {
+	std::vector<const moveit::task_constructor::SubTrajectory*> subs;
+	moveit::task_constructor::flatten(solution, subs);
+
+	start_scene_ = solution.start() ? solution.start()->scene() : planning_scene::PlanningSceneConstPtr();
+	data_.clear();
+	data_.reserve(subs.size());
+	steps_ = 0;
+	std::shared_ptr<Data> prev;
+	for (const auto* sub : subs) {
+		prev = std::make_shared<Data>(prev, *sub, introspection);
+		data_.push_back(prev);
+		steps_ += prev->waypointCount();
 	}
 }
 
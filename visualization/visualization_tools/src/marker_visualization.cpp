@@ -9,9 +9,119 @@
 #include <OgreSceneNode.h>
 #include <tf2_msgs/TF2Error.h>
 #include <ros/console.h>
+#include <Eigen/Geometry>
+#include <tuple>
 
 namespace moveit_rviz_plugin {
 
+namespace {
+namespace vm = visualization_msgs;
+
+// type of list marker that can hold the given marker, -1 if none
+int listType(const vm::Marker& m) {
+	if (m.action != vm::Marker::ADD)
+		return -1;
+	switch (m.type) {
+		case vm::Marker::SPHERE:  // sphere lists don't support non-uniform scaling
+			return (m.scale.x == m.scale.y && m.scale.x == m.scale.z) ? vm::Marker::SPHERE_LIST : -1;
+		case vm::Marker::CUBE:
+			return vm::Marker::CUBE_LIST;
+		case vm::Marker::TRIANGLE_LIST:  // triangle lists scale their points
+			return (m.scale.x == 1.0 && m.scale.y == 1.0 && m.scale.z == 1.0) ? m.type : -1;
+		case vm::Marker::POINTS:
+		case vm::Marker::LINE_LIST:
+		case vm::Marker::SPHERE_LIST:
+		case vm::Marker::CUBE_LIST:
+			return m.type;
+	}
+	return -1;
+}
+
+Eigen::Quaterniond orientation(const geometry_msgs::Quaternion& q) {
+	if (q.w == 0.0 && q.x == 0.0 && q.y == 0.0 && q.z == 0.0)
+		return Eigen::Quaterniond::Identity();
+	return Eigen::Quaterniond(q.w, q.x, q.y, q.z).normalized();
+}
+
+/** Merge markers sharing namespace, frame, shape, scale, and orientation into a single list marker
+ *
+ * Many same-shape markers, e.g. spheres or cubes of grasp visualizations, are rendered much cheaper
+ * as a single rviz list marker than as individual Ogre objects. All other markers are kept as they are.
+ */
+std::vector<vm::Marker> mergeMarkers(const std::vector<vm::Marker>& markers) {
+	using Key = std::tuple<std::string, std::string, int, double, double, double, double, double, double, double>;
+	std::map<Key, std::vector<const vm::Marker*>> groups;
+	std::vector<std::pair<const vm::Marker*, const std::vector<const vm::Marker*>*>> order;
+
+	for (const auto& m : markers) {
+		int type = listType(m);
+		if (type < 0) {
+			order.emplace_back(&m, nullptr);
+			continue;
+		}
+		const Eigen::Quaterniond q = orientation(m.pose.orientation);
+		Key key{ m.ns, m.header.frame_id, type, m.scale.x, m.scale.y, m.scale.z, q.w(), q.x(), q.y(), q.z() };
+		auto& group = groups[key];
+		if (group.empty())
+			order.emplace_back(&m, &group);
+		group.push_back(&m);
+	}
+	if (order.size() == markers.size())
+		return markers;  // nothing to merge
+
+	std::vector<vm::Marker> result;
+	result.reserve(order.size());
+	for (const auto& item : order) {
+		if (!item.second || item.second->size() == 1) {
+			result.push_back(*item.first);
+			continue;
+		}
+
+		const vm::Marker& first = *item.first;
+		vm::Marker merged;
+		merged.header = first.header;
+		merged.ns = first.ns;
+		merged.id = first.id;
+		merged.action = vm::Marker::ADD;
+		merged.type = listType(first);
+		merged.scale = first.scale;
+		merged.color = first.color;
+		const Eigen::Quaterniond q = orientation(first.pose.orientation);
+		merged.pose.orientation.w = q.w();
+		merged.pose.orientation.x = q.x();
+		merged.pose.orientation.y = q.y();
+		merged.pose.orientation.z = q.z();
+
+		// all merged markers share the orientation: express their positions in the rotated frame
+		const Eigen::Quaterniond q_inv = q.inverse();
+		for (const vm::Marker* m : *item.second) {
+			const auto& p = m->pose.position;
+			const Eigen::Vector3d offset = q_inv * Eigen::Vector3d(p.x, p.y, p.z);
+			if (m->type == vm::Marker::SPHERE || m->type == vm::Marker::CUBE) {
+				geometry_msgs::Point point;
+				point.x = offset.x();
+				point.y = offset.y();
+				point.z = offset.z();
+				merged.points.push_back(point);
+				merged.colors.push_back(m->color);
+				continue;
+			}
+			const bool vertex_colors = m->colors.size() == m->points.size();
+			for (size_t i = 0; i < m->points.size(); ++i) {
+				geometry_msgs::Point point = m->points[i];
+				point.x += offset.x();
+				point.y += offset.y();
+				point.z += offset.z();
+				merged.points.push_back(point);
+				merged.colors.push_back(vertex_colors ? m->colors[i] : m->color);
+			}
+		}
+		result.push_back(std::move(merged));
+	}
+	return result;
+}
+}  // namespace
+
 // create MarkerData with nil marker_ pointer, just with a copy of message
 MarkerVisualization::MarkerData::MarkerData(const visualization_msgs::Marker& marker) {
 	msg_.reset(new visualization_msgs::Marker(marker));
@@ -23,7 +133,7 @@ MarkerVisualization::MarkerVisualization(const std::vector<visualization_msgs::M
                                          const planning_scene::PlanningScene& end_scene) {
 	planning_frame_ = end_scene.getPlanningFrame();
 	// remember marker message, postpone rviz::MarkerBase creation until later
-	for (const auto& marker : markers) {
+	for (const auto& marker : mergeMarkers(markers)) {
 		if (!end_scene.knowsFrameTransform(marker.header.frame_id)) {
 			ROS_WARN_ONCE("unknown frame '%s' for solution marker in namespace '%s'", marker.header.frame_id.c_str(),
 			              marker.ns.c_str());
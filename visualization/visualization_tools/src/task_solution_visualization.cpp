@@ -99,6 +99,19 @@ TaskSolutionVisualization::TaskSolutionVisualization(rviz::Property* parent, rvi
 	    SLOT(changedTrail()), this);
 	trail_step_size_property_->setMin(1);
 
+	trail_max_robots_property_ =
+	    new rviz::IntProperty("Trail Max Robots", 100,
+	                          "Maximum number of robots shown in the trajectory trail, evenly sampled along the path.",
+	                          parent, SLOT(changedTrail()), this);
+	trail_max_robots_property_->setMin(1);
+
+	waypoint_min_distance_property_ =
+	    new rviz::FloatProperty("Waypoint Min Distance", 0.01,
+	                            "Skip waypoints closer than this joint-space distance to the previously shown one, "
+	                            "both in the animation and the trail (0 shows all waypoints).",
+	                            parent, SLOT(changedTrail()), this);
+	waypoint_min_distance_property_->setMin(0.0);
+
 	// robot properties
 	robot_property_ = new rviz::Property("Robot", QString(), QString(), parent);
 	robot_visual_enabled_property_ = new rviz::BoolProperty("Show Robot Visual", true,
@@ -161,7 +174,7 @@ TaskSolutionVisualization::TaskSolutionVisualization(rviz::Property* parent, rvi
 }
 
 TaskSolutionVisualization::~TaskSolutionVisualization() {
-	clearTrail();
+	releaseTrail();
 	next_solution_to_display_.reset();
 	displaying_solution_.reset();
 
@@ -217,6 +230,7 @@ void TaskSolutionVisualization::onRobotModelLoaded(const moveit::core::RobotMode
 	}
 
 	scene_.reset(new planning_scene::PlanningScene(robot_model));
+	releaseTrail();  // trail robots were loaded for the previous model
 
 	robot_render_->load(*robot_model->getURDF());  // load rviz robot
 	enabledRobotColor();  // force-refresh to account for saved display configuration
@@ -238,9 +252,36 @@ void TaskSolutionVisualization::reset() {
 		parent_scene_node_->removeChild(main_scene_node_);
 }
 
+// hide all trail robots, keeping them for reuse
 void TaskSolutionVisualization::clearTrail() {
+	for (rviz::Robot* r : trail_)
+		r->setVisible(false);
+	trail_waypoints_.clear();
+}
+
+void TaskSolutionVisualization::releaseTrail() {
 	qDeleteAll(trail_);
 	trail_.clear();
+	trail_waypoints_.clear();
+}
+
+// next waypoint after index to display, skipping waypoints too close to index (within the same sub trajectory)
+int TaskSolutionVisualization::nextWayPoint(int index) const {
+	const double min_distance = waypoint_min_distance_property_->getFloat();
+	const int count = displaying_solution_->getWayPointCount();
+	if (min_distance <= 0.0 || index < 0 || index + 2 >= count)
+		return index + 1;
+
+	const auto idx_pair = displaying_solution_->indexPair(index);
+	const moveit::core::RobotState& state = *displaying_solution_->getWayPointPtr(idx_pair);
+	int next = index + 1;
+	for (; next + 1 < count; ++next) {  // always show the last waypoint
+		const auto next_pair = displaying_solution_->indexPair(next);
+		if (next_pair.first != idx_pair.first ||
+		    state.distance(*displaying_solution_->getWayPointPtr(next_pair)) >= min_distance)
+			break;
+	}
+	return next;
 }
 
 void TaskSolutionVisualization::changedLoopDisplay() {
@@ -264,21 +305,47 @@ void TaskSolutionVisualization::changedTrail() {
 	setVisibility(main_scene_node_, parent_scene_node_, true);
 	setVisibility(trail_scene_node_, main_scene_node_, true);
 
-	int stepsize = trail_step_size_property_->getInt();
-	trail_.resize(t->getWayPointCount() / stepsize);
-	for (std::size_t i = 0; i < trail_.size(); i++) {
-		int waypoint_i = std::min(i * stepsize, t->getWayPointCount() - 1);  // limit to last trajectory point
+	// sample every stepsize-th waypoint, skipping those too close to the previous sample
+	const std::size_t stepsize = trail_step_size_property_->getInt();
+	const double min_distance = waypoint_min_distance_property_->getFloat();
+	moveit::core::RobotStateConstPtr last;
+	for (std::size_t i = 0, end = t->getWayPointCount() / stepsize; i < end; ++i) {
+		const moveit::core::RobotStateConstPtr& state = t->getWayPointPtr(i * stepsize);
+		if (last && min_distance > 0.0 && last->distance(*state) < min_distance)
+			continue;
+		trail_waypoints_.push_back(i * stepsize);
+		last = state;
+	}
+
+	// limit number of robots, evenly subsampling the trail (keeping first and last sample)
+	const std::size_t max_robots = trail_max_robots_property_->getInt();
+	if (trail_waypoints_.size() > max_robots) {
+		std::vector<int> subsampled(max_robots);
+		for (std::size_t i = 0; i < max_robots; ++i)
+			subsampled[i] = trail_waypoints_[max_robots > 1 ? i * (trail_waypoints_.size() - 1) / (max_robots - 1) : 0];
+		trail_waypoints_.swap(subsampled);
+	}
+
+	// create additional robots as needed
+	for (std::size_t i = trail_.size(); i < trail_waypoints_.size(); ++i) {
 		rviz::Robot* r =
 		    new rviz::Robot(trail_scene_node_, context_, "Trail Robot " + boost::lexical_cast<std::string>(i), nullptr);
 		r->load(*scene_->getRobotModel()->getURDF());
 		r->setVisualVisible(robot_visual_enabled_property_->getBool());
 		r->setCollisionVisible(robot_collision_enabled_property_->getBool());
 		r->setAlpha(robot_alpha_property_->getFloat());
-		r->update(PlanningLinkUpdater(t->getWayPointPtr(waypoint_i)));
+		r->setVisible(false);
+		trail_.push_back(r);
+	}
+
+	for (std::size_t i = 0; i < trail_waypoints_.size(); ++i) {
+		rviz::Robot* r = trail_[i];
+		r->update(PlanningLinkUpdater(t->getWayPointPtr(trail_waypoints_[i])));
 		if (enable_robot_color_property_->getBool())
 			setRobotColor(r, robot_color_property_->getColor());
-		r->setVisible(waypoint_i <= current_state_);
-		trail_[i] = r;
+		else
+			unsetRobotColor(r);
+		r->setVisible(trail_waypoints_[i] <= current_state_);
 	}
 }
 
@@ -412,7 +479,7 @@ void TaskSolutionVisualization::update(float wall_dt, float /*ros_dt*/) {
 				current_state_time_ -= tm;
 			}
 		} else if (current_state_time_ > tm) {  // fixed display time per state
-			++current_state_;
+			current_state_ = nextWayPoint(current_state_);
 			current_state_time_ = 0.0;
 		}
 	} else if (current_state_ != previous_state) {  // current_state_ changed from slider
@@ -436,16 +503,12 @@ void TaskSolutionVisualization::update(float wall_dt, float /*ros_dt*/) {
 
 	renderWayPoint(current_state_, previous_state);
 
-	// show / hide trail between start .. end
-	int stepsize = trail_step_size_property_->getInt();
-	int start = std::max(0, previous_state / stepsize);
-	int end = current_state_ / stepsize;
-	bool show = start <= end;
-	if (!show)
-		std::swap(start, end);
-	end = std::min<int>(end, trail_.size());
-	for (; start < end; ++start)
-		trail_[start]->setVisible(show);
+	// show / hide trail robots of waypoints in range (previous_state, current_state_]
+	auto first = std::upper_bound(trail_waypoints_.begin(), trail_waypoints_.end(),
+	                              std::min(previous_state, current_state_));
+	auto last = std::upper_bound(first, trail_waypoints_.end(), std::max(previous_state, current_state_));
+	for (; first != last; ++first)
+		trail_[first - trail_waypoints_.begin()]->setVisible(*first <= current_state_);
 
 	setVisibility();
 }